@@ -0,0 +1,203 @@
+// bench_memory_query: tool_memory_query latency over synthetic corpora
+// across modes {keyword, semantic, hybrid} x rerank {none, mmr}.
+//
+// Corpora are generated with a skewed (Zipf-like) vocabulary so term
+// frequencies resemble real memory streams, mirrored into vectordb so the
+// semantic/hybrid paths do real work. The first query per corpus builds the
+// inverted index and embedding sidecars and is reported separately as
+// index_build_ms; the measured queries then exercise the steady state.
+//
+// Emits one JSON object per cell on stdout (JSONL):
+//   {"bench":"memory_query","lines":10000,"mode":"hybrid","rerank":"mmr",
+//    "queries":30,"p50_ms":...,"p95_ms":...,"allocs_per_query":...}
+//
+// Allocation counts come from a counting operator new in this binary.
+
+#include "machina/tools.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// from tools/tier0
+namespace machina {
+ToolResult tool_memory_query(const std::string& input_json, DSState& ds_tmp);
+bool vectordb_upsert_batch(const std::string& stream, const std::vector<std::string>& texts,
+                           size_t* count_out, std::string* err);
+}
+
+static std::atomic<uint64_t> g_allocs{0};
+
+void* operator new(size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+namespace fs = std::filesystem;
+using clock_type = std::chrono::steady_clock;
+
+void setenv_str(const char* k, const std::string& v) {
+#if !defined(_WIN32)
+    ::setenv(k, v.c_str(), 1);
+#else
+    (void)k; (void)v;
+#endif
+}
+
+// Zipf-ish draw: u^skew concentrates mass on the low word ids.
+std::string skewed_word(std::mt19937& rng, size_t vocab, double skew) {
+    double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    size_t id = (size_t)((double)vocab * std::pow(u, skew));
+    if (id >= vocab) id = vocab - 1;
+    return "word" + std::to_string(id);
+}
+
+std::string make_text(std::mt19937& rng, size_t tokens, size_t vocab, double skew) {
+    std::string t;
+    for (size_t i = 0; i < tokens; i++) {
+        if (i) t.push_back(' ');
+        t += skewed_word(rng, vocab, skew);
+    }
+    return t;
+}
+
+double percentile_ms(std::vector<uint64_t>& ns, double p) {
+    if (ns.empty()) return 0.0;
+    size_t idx = (size_t)((double)(ns.size() - 1) * p);
+    std::nth_element(ns.begin(), ns.begin() + (long)idx, ns.end());
+    return (double)ns[idx] / 1e6;
+}
+
+void run_corpus(const fs::path& memdir, size_t lines, size_t tokens,
+                size_t vocab, double skew, size_t queries) {
+    std::mt19937 rng(1234);
+    std::string stream = "b" + std::to_string(lines);
+
+    std::vector<std::string> texts;
+    texts.reserve(lines);
+    {
+        std::ofstream out(memdir / (stream + ".jsonl"));
+        for (size_t i = 0; i < lines; i++) {
+            std::string text = make_text(rng, tokens, vocab, skew);
+            out << "{\"ts_ms\":" << (1000000 + i) << ",\"stream\":\"" << stream
+                << "\",\"text\":\"" << text << "\"}\n";
+            texts.push_back(std::move(text));
+        }
+    }
+    std::string verr;
+    size_t upserted = 0;
+    if (!machina::vectordb_upsert_batch(stream, texts, &upserted, &verr)) {
+        std::fprintf(stderr, "bench_memory_query: vecdb mirror failed: %s\n", verr.c_str());
+    }
+
+    // First query builds the index + embedding sidecars.
+    machina::DSState tmp;
+    auto b0 = clock_type::now();
+    machina::tool_memory_query(
+        "{\"stream\":\"" + stream + "\",\"query\":\"word1 word2\",\"top_k\":5}", tmp);
+    auto b1 = clock_type::now();
+    double build_ms =
+        (double)std::chrono::duration_cast<std::chrono::microseconds>(b1 - b0).count() / 1000.0;
+    std::printf("{\"bench\":\"memory_query\",\"lines\":%zu,\"index_build_ms\":%.3f}\n",
+                lines, build_ms);
+
+    const char* modes[] = {"keyword", "semantic", "hybrid"};
+    const char* reranks[] = {"none", "mmr"};
+    for (const char* mode : modes) {
+        for (const char* rerank : reranks) {
+            std::vector<uint64_t> lat;
+            lat.reserve(queries);
+            uint64_t a0 = g_allocs.load(std::memory_order_relaxed);
+            for (size_t q = 0; q < queries; q++) {
+                std::string query = skewed_word(rng, vocab, skew) + " " +
+                                    skewed_word(rng, vocab, skew) + " " +
+                                    skewed_word(rng, vocab, skew);
+                std::string in = "{\"stream\":\"" + stream + "\",\"query\":\"" + query +
+                                 "\",\"mode\":\"" + mode + "\",\"rerank\":\"" + rerank +
+                                 "\",\"top_k\":10}";
+                auto t0 = clock_type::now();
+                auto r = machina::tool_memory_query(in, tmp);
+                auto t1 = clock_type::now();
+                if (r.status != machina::StepStatus::OK) {
+                    std::fprintf(stderr, "bench_memory_query: query failed: %s\n",
+                                 r.error.c_str());
+                    std::exit(1);
+                }
+                lat.push_back((uint64_t)std::chrono::duration_cast<
+                              std::chrono::nanoseconds>(t1 - t0).count());
+            }
+            uint64_t a1 = g_allocs.load(std::memory_order_relaxed);
+            double p50 = percentile_ms(lat, 0.50);
+            double p95 = percentile_ms(lat, 0.95);
+            std::printf("{\"bench\":\"memory_query\",\"lines\":%zu,\"mode\":\"%s\","
+                        "\"rerank\":\"%s\",\"queries\":%zu,\"p50_ms\":%.3f,"
+                        "\"p95_ms\":%.3f,\"allocs_per_query\":%.0f}\n",
+                        lines, mode, rerank, queries, p50, p95,
+                        (double)(a1 - a0) / (double)queries);
+            std::fflush(stdout);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> line_counts = {1000, 10000, 100000};
+    size_t tokens = 24;
+    size_t vocab = 5000;
+    double skew = 1.2;
+    size_t queries = 30;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--lines") == 0 && i + 1 < argc) {
+            line_counts = {(size_t)std::strtoull(argv[++i], nullptr, 10)};
+        } else if (std::strcmp(argv[i], "--tokens") == 0 && i + 1 < argc) {
+            tokens = (size_t)std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--skew") == 0 && i + 1 < argc) {
+            skew = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--queries") == 0 && i + 1 < argc) {
+            queries = (size_t)std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr,
+                         "usage: bench_memory_query [--lines N] [--tokens N] "
+                         "[--skew F] [--queries N]\n");
+            return 2;
+        }
+    }
+
+    fs::path root = fs::temp_directory_path() / "machina_bench_memory_query";
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    fs::create_directories(root, ec);
+    setenv_str("MACHINA_ROOT", root.string());
+    fs::path memdir = root / "work" / "memory";
+    fs::create_directories(memdir, ec);
+
+    for (size_t lines : line_counts) {
+        run_corpus(memdir, lines, tokens, vocab, skew, queries);
+    }
+
+    fs::remove_all(root, ec);
+    return 0;
+}
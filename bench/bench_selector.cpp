@@ -0,0 +1,166 @@
+// bench_selector: selection throughput and latency across the selector
+// backends {heuristic, external (fallback path), gpu_centroid} for synthetic
+// menus of 10..2000 items and embedding dims 64..1024.
+//
+// Emits one JSON object per cell on stdout (JSONL), machine-readable for
+// regression tracking:
+//   {"bench":"selector_select","backend":"gpu_centroid","items":500,
+//    "dim":256,"selects":200,"cold_us":...,"elapsed_ms":...,
+//    "selects_per_sec":...,"warm_p50_us":...,"warm_p99_us":...}
+//
+// "cold_us" is the first selection against a fresh menu (for gpu_centroid
+// that includes building the centroid matrix); the warm loop then issues
+// distinct goal digests so it measures embed+score with a hot centroid
+// cache, matching autopilot fan-out traffic. Disk persistence of the
+// centroid cache is disabled so cold cells stay cold across reruns.
+//
+// ExternalProcessSelector is benchmarked in FALLBACK_ONLY mode (no policy
+// process is spawned), i.e. it measures the wrapper overhead on top of the
+// heuristic path.
+
+#include "machina/selector.h"
+#include "machina/selector_gpu.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+int main() {
+    std::fprintf(stderr, "bench_selector is not supported on Windows build in this snapshot\n");
+    return 1;
+}
+#else
+
+namespace {
+
+namespace fs = std::filesystem;
+using clock_type = std::chrono::steady_clock;
+
+machina::Menu make_menu(size_t n, const std::string& label) {
+    machina::Menu menu;
+    menu.items.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        machina::MenuItem it;
+        it.sid.value = (uint16_t)(i + 1);
+        it.aid = "bench.act." + label + "." + std::to_string(i);
+        it.name = "act_" + label + "_" + std::to_string(i);
+        it.tags = {"bench"};
+        menu.items.push_back(std::move(it));
+    }
+    menu.buildIndex();
+    return menu;
+}
+
+double percentile_us(std::vector<uint64_t>& ns, double p) {
+    if (ns.empty()) return 0.0;
+    size_t idx = (size_t)((double)(ns.size() - 1) * p);
+    std::nth_element(ns.begin(), ns.begin() + (long)idx, ns.end());
+    return (double)ns[idx] / 1000.0;
+}
+
+void run_cell(machina::ISelector& sel, const char* backend, size_t items,
+              size_t dim, const std::string& label, size_t selects) {
+    machina::Menu menu = make_menu(items, label);
+    const std::string state_digest = "bench_state";
+    const std::string inputs_json = "{}";
+
+    auto c0 = clock_type::now();
+    machina::Selection first = sel.select(menu, "goal_cold_" + label,
+                                          state_digest,
+                                          machina::ControlMode::FALLBACK_ONLY,
+                                          inputs_json);
+    auto c1 = clock_type::now();
+    if (first.kind == machina::Selection::Kind::INVALID) {
+        std::fprintf(stderr, "bench_selector: %s returned INVALID\n", backend);
+        std::exit(1);
+    }
+    double cold_us =
+        (double)std::chrono::duration_cast<std::chrono::nanoseconds>(c1 - c0).count() / 1000.0;
+
+    std::vector<uint64_t> lat;
+    lat.reserve(selects);
+    auto t0 = clock_type::now();
+    for (size_t i = 0; i < selects; i++) {
+        auto a = clock_type::now();
+        sel.select(menu, "goal_" + label + "_" + std::to_string(i),
+                   state_digest, machina::ControlMode::FALLBACK_ONLY,
+                   inputs_json);
+        auto b = clock_type::now();
+        lat.push_back((uint64_t)std::chrono::duration_cast<
+                      std::chrono::nanoseconds>(b - a).count());
+    }
+    auto t1 = clock_type::now();
+
+    double elapsed_ms =
+        (double)std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1000.0;
+    double per_sec = elapsed_ms > 0.0 ? (double)selects / (elapsed_ms / 1000.0) : 0.0;
+    double p50 = percentile_us(lat, 0.50);
+    double p99 = percentile_us(lat, 0.99);
+
+    std::printf("{\"bench\":\"selector_select\",\"backend\":\"%s\","
+                "\"items\":%zu,\"dim\":%zu,\"selects\":%zu,"
+                "\"cold_us\":%.2f,\"elapsed_ms\":%.3f,"
+                "\"selects_per_sec\":%.1f,\"warm_p50_us\":%.2f,"
+                "\"warm_p99_us\":%.2f}\n",
+                backend, items, dim, selects, cold_us, elapsed_ms, per_sec,
+                p50, p99);
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t selects = 200;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--selects") == 0 && i + 1 < argc) {
+            selects = (size_t)std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: bench_selector [--selects N]\n");
+            return 2;
+        }
+    }
+
+    fs::path root = fs::temp_directory_path() / "machina_bench_selector";
+    std::error_code ec;
+    fs::create_directories(root, ec);
+    ::setenv("MACHINA_ROOT", root.string().c_str(), 1);
+    // Keep cold cells cold across reruns and avoid leaving blobs in tmp.
+    ::setenv("MACHINA_SELECTOR_CACHE_PERSIST", "0", 1);
+
+    const size_t item_counts[] = {10, 100, 500, 2000};
+    const size_t dims[] = {64, 256, 1024};
+
+    // Heuristic and external selectors do not embed, so dim is reported as 0
+    // and each runs once per menu size.
+    machina::HeuristicSelector heuristic;
+    machina::ExternalProcessSelector external(
+        std::make_unique<machina::HeuristicSelector>(), root, "");
+    for (size_t items : item_counts) {
+        run_cell(heuristic, "heuristic", items, 0,
+                 "h" + std::to_string(items), selects);
+        run_cell(external, "external_fallback", items, 0,
+                 "x" + std::to_string(items), selects);
+    }
+
+    machina::GpuCentroidSelector gpu;
+    for (size_t items : item_counts) {
+        for (size_t dim : dims) {
+            ::setenv("MACHINA_GPU_DIM", std::to_string(dim).c_str(), 1);
+            run_cell(gpu, "gpu_centroid", items, dim,
+                     "g" + std::to_string(items) + "d" + std::to_string(dim),
+                     selects);
+        }
+    }
+
+    fs::remove_all(root, ec);
+    return 0;
+}
+
+#endif // !_WIN32
@@ -0,0 +1,270 @@
+// bench_serve: serve-mode HTTP throughput and latency under a mixed
+// workload (health probes, /stats reads, HMAC-signed enqueues) driven
+// over persistent keep-alive connections.
+//
+// Spawns its own `machina_cli serve` instance on a scratch queue, so a
+// run regression-tests the whole request path: accept loop, parser,
+// executor pool, auth and rate-limit checks, and the queue write.
+//
+// Emits one JSON object per endpoint on stdout (JSONL), machine-readable
+// for regression tracking:
+//   {"bench":"serve_http","endpoint":"/enqueue","conns":8,"body_bytes":256,
+//    "seconds":5,"requests":...,"rps":...,"p50_us":...,"p99_us":...}
+//
+// Usage:
+//   bench_serve [--bin path/to/machina_cli] [--port 18990] [--conns 8]
+//               [--seconds 5] [--body-bytes 256] [--enqueue-pct 30]
+
+#include "machina/crypto.h"
+#include "machina/hash.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+int main() {
+    std::fprintf(stderr, "bench_serve is not supported on Windows build in this snapshot\n");
+    return 1;
+}
+#else
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+namespace fs = std::filesystem;
+using clock_t_ = std::chrono::steady_clock;
+
+constexpr const char* kSecret = "bench-serve-secret";
+
+double percentile_us(std::vector<uint64_t>& ns, double p) {
+    if (ns.empty()) return 0.0;
+    size_t idx = (size_t)((double)(ns.size() - 1) * p);
+    std::nth_element(ns.begin(), ns.begin() + (long)idx, ns.end());
+    return (double)ns[idx] / 1000.0;
+}
+
+int connect_once(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Minimal keep-alive client: write the request, read headers, then read
+// Content-Length body bytes. Returns the status code, or -1 on error.
+int roundtrip(int fd, const std::string& req, std::string& buf) {
+    const char* p = req.data();
+    size_t left = req.size();
+    while (left > 0) {
+        ssize_t w = ::send(fd, p, left, MSG_NOSIGNAL);
+        if (w <= 0) return -1;
+        p += w;
+        left -= (size_t)w;
+    }
+    buf.clear();
+    size_t hdr_end = std::string::npos;
+    char tmp[8192];
+    while (hdr_end == std::string::npos) {
+        ssize_t n = ::recv(fd, tmp, sizeof(tmp), 0);
+        if (n <= 0) return -1;
+        buf.append(tmp, (size_t)n);
+        hdr_end = buf.find("\r\n\r\n");
+        if (buf.size() > 1 << 20) return -1;
+    }
+    size_t cl = 0;
+    size_t cp = buf.find("Content-Length:");
+    if (cp != std::string::npos && cp < hdr_end) cl = (size_t)std::strtoull(buf.c_str() + cp + 15, nullptr, 10);
+    size_t want = hdr_end + 4 + cl;
+    while (buf.size() < want) {
+        ssize_t n = ::recv(fd, tmp, sizeof(tmp), 0);
+        if (n <= 0) return -1;
+        buf.append(tmp, (size_t)n);
+    }
+    if (buf.size() < 12) return -1;
+    return std::atoi(buf.c_str() + 9);
+}
+
+std::string signed_enqueue(int port, const std::string& body, uint64_t nonce_id) {
+    long long ts = (long long)std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string ts_s = std::to_string(ts);
+    std::string nonce = "bench-" + std::to_string(nonce_id);
+    std::string canon = ts_s + "\n" + nonce + "\n" + "POST" + "\n" + "/enqueue" + "\n" +
+                        machina::sha256_hex(body) + "\n";
+    std::string sig = machina::hmac_sha256_hex(kSecret, canon);
+    std::string req = "POST /enqueue HTTP/1.1\r\nHost: 127.0.0.1:" + std::to_string(port) +
+                      "\r\nContent-Type: application/json\r\n"
+                      "x-machina-ts: " + ts_s + "\r\n"
+                      "x-machina-nonce: " + nonce + "\r\n"
+                      "x-machina-signature: " + sig + "\r\n"
+                      "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    return req;
+}
+
+struct EndpointStats {
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> errors{0};
+    std::mutex mu;
+    std::vector<uint64_t> lat_ns;
+
+    void add(std::vector<uint64_t>& local) {
+        std::lock_guard<std::mutex> lk(mu);
+        lat_ns.insert(lat_ns.end(), local.begin(), local.end());
+    }
+};
+
+void report(const char* endpoint, EndpointStats& st, int conns, size_t body_bytes, int seconds) {
+    double rps = seconds > 0 ? (double)st.requests.load() / seconds : 0.0;
+    std::printf("{\"bench\":\"serve_http\",\"endpoint\":\"%s\",\"conns\":%d,"
+                "\"body_bytes\":%zu,\"seconds\":%d,\"requests\":%llu,\"errors\":%llu,"
+                "\"rps\":%.1f,\"p50_us\":%.1f,\"p99_us\":%.1f}\n",
+                endpoint, conns, body_bytes, seconds,
+                (unsigned long long)st.requests.load(), (unsigned long long)st.errors.load(),
+                rps, percentile_us(st.lat_ns, 0.50), percentile_us(st.lat_ns, 0.99));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string bin = "./machina_cli";
+    if (const char* e = std::getenv("MACHINA_CLI_BIN")) bin = e;
+    int port = 18990;
+    int conns = 8;
+    int seconds = 5;
+    size_t body_bytes = 256;
+    int enqueue_pct = 30;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "--bin" && i + 1 < argc) bin = argv[++i];
+        else if (a == "--port" && i + 1 < argc) port = std::atoi(argv[++i]);
+        else if (a == "--conns" && i + 1 < argc) conns = std::atoi(argv[++i]);
+        else if (a == "--seconds" && i + 1 < argc) seconds = std::atoi(argv[++i]);
+        else if (a == "--body-bytes" && i + 1 < argc) body_bytes = (size_t)std::strtoull(argv[++i], nullptr, 10);
+        else if (a == "--enqueue-pct" && i + 1 < argc) enqueue_pct = std::atoi(argv[++i]);
+    }
+    if (conns < 1) conns = 1;
+    if (conns > 28) conns = 28; // serve caps concurrent connections at 32
+
+    std::error_code ec;
+    fs::path qdir = fs::temp_directory_path(ec) / ("bench_serve_q_" + std::to_string(::getpid()));
+    fs::create_directories(qdir, ec);
+
+    ::setenv("MACHINA_API_HMAC_SECRET", kSecret, 1);
+    ::setenv("MACHINA_API_RPM", "-1", 1); // throughput run: no rate limit
+
+    pid_t serve_pid = ::fork();
+    if (serve_pid == 0) {
+        std::string port_s = std::to_string(port);
+        std::string q_s = qdir.string();
+        ::execl(bin.c_str(), bin.c_str(), "serve", "--port", port_s.c_str(),
+                "--queue", q_s.c_str(), "--workers", "0", (char*)nullptr);
+        std::fprintf(stderr, "bench_serve: exec %s failed\n", bin.c_str());
+        ::_exit(127);
+    }
+    if (serve_pid < 0) {
+        std::fprintf(stderr, "bench_serve: fork failed\n");
+        return 1;
+    }
+
+    // Wait for the server to come up.
+    int probe = -1;
+    for (int i = 0; i < 100 && probe < 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        probe = connect_once(port);
+    }
+    if (probe < 0) {
+        std::fprintf(stderr, "bench_serve: server did not come up on port %d\n", port);
+        ::kill(serve_pid, SIGKILL);
+        return 1;
+    }
+    ::close(probe);
+
+    EndpointStats st_health, st_stats, st_enqueue;
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> nonce_seq{1};
+
+    const std::string pad(body_bytes > 32 ? body_bytes - 32 : 1, 'a');
+    const std::string health_req = "GET /health HTTP/1.1\r\nHost: b\r\n\r\n";
+    const std::string stats_req = "GET /stats HTTP/1.1\r\nHost: b\r\n\r\n";
+
+    std::vector<std::thread> threads;
+    threads.reserve((size_t)conns);
+    for (int t = 0; t < conns; t++) {
+        threads.emplace_back([&, t]() {
+            int fd = connect_once(port);
+            std::string buf;
+            std::vector<uint64_t> l_health, l_stats, l_enqueue;
+            uint64_t i = (uint64_t)t;
+            while (!stop.load(std::memory_order_relaxed) && fd >= 0) {
+                EndpointStats* st;
+                std::vector<uint64_t>* lat;
+                std::string req;
+                const int pick = (int)(i % 100);
+                if (pick < enqueue_pct) {
+                    std::string body = "{\"goal_id\":\"G.BENCH\",\"pad\":\"" + pad + "\"}";
+                    req = signed_enqueue(port, body, nonce_seq.fetch_add(1));
+                    st = &st_enqueue; lat = &l_enqueue;
+                } else if (pick < enqueue_pct + (100 - enqueue_pct) / 2) {
+                    req = stats_req;
+                    st = &st_stats; lat = &l_stats;
+                } else {
+                    req = health_req;
+                    st = &st_health; lat = &l_health;
+                }
+                auto t0 = clock_t_::now();
+                int code = roundtrip(fd, req, buf);
+                auto t1 = clock_t_::now();
+                if (code < 0) { ::close(fd); fd = connect_once(port); continue; }
+                st->requests.fetch_add(1, std::memory_order_relaxed);
+                if (code >= 400) st->errors.fetch_add(1, std::memory_order_relaxed);
+                lat->push_back((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+                i += 7; // co-prime stride so connections interleave endpoint picks
+            }
+            if (fd >= 0) ::close(fd);
+            st_health.add(l_health);
+            st_stats.add(l_stats);
+            st_enqueue.add(l_enqueue);
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop.store(true);
+    for (auto& th : threads) th.join();
+
+    report("/health", st_health, conns, body_bytes, seconds);
+    report("/stats", st_stats, conns, body_bytes, seconds);
+    report("/enqueue", st_enqueue, conns, body_bytes, seconds);
+
+    ::kill(serve_pid, SIGTERM);
+    int status = 0;
+    ::waitpid(serve_pid, &status, 0);
+    fs::remove_all(qdir, ec);
+    return 0;
+}
+
+#endif
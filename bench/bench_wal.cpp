@@ -0,0 +1,189 @@
+// bench_wal: WAL append throughput and latency across the configuration
+// matrix {fsync on/off, framed on/off, record size, writer threads}.
+//
+// Emits one JSON object per cell on stdout (JSONL), machine-readable for
+// regression tracking:
+//   {"bench":"wal_append","fsync":0,"framed":0,"record_bytes":128,
+//    "threads":4,"records":50000,"elapsed_ms":...,"appends_per_sec":...,
+//    "p50_us":...,"p99_us":...}
+//
+// The framed format is selected by MACHINA_WAL_FRAMED, which the WAL caches
+// in a static on first use, so each framed setting runs in a forked child
+// that sets the env before touching the WAL.
+
+#include "machina/wal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+int main() {
+    std::fprintf(stderr, "bench_wal is not supported on Windows build in this snapshot\n");
+    return 1;
+}
+#else
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+struct Cell {
+    bool fsync;
+    bool framed;
+    size_t record_bytes;
+    int threads;
+};
+
+std::string make_record(size_t bytes) {
+    // {"pad":"aaa..."} padded to the requested size (incl. trailing newline
+    // added by the WAL).
+    const std::string pre = "{\"pad\":\"";
+    const std::string post = "\"}";
+    size_t body = bytes > pre.size() + post.size() + 1
+                      ? bytes - pre.size() - post.size() - 1
+                      : 1;
+    return pre + std::string(body, 'a') + post;
+}
+
+double percentile_us(std::vector<uint64_t>& ns, double p) {
+    if (ns.empty()) return 0.0;
+    size_t idx = (size_t)((double)(ns.size() - 1) * p);
+    std::nth_element(ns.begin(), ns.begin() + (long)idx, ns.end());
+    return (double)ns[idx] / 1000.0;
+}
+
+void run_cell(const Cell& c, const fs::path& dir, size_t total_records) {
+    using clock = std::chrono::steady_clock;
+
+    fs::path wp = dir / "bench.jsonl";
+    std::error_code ec;
+    fs::remove(wp, ec);
+
+    machina::Wal wal(wp);
+    machina::WalPolicy pol;
+    pol.max_segment_bytes = 1LL << 40;  // no rotation during the run
+    pol.max_segment_age_sec = 0;
+    wal.set_policy(pol);
+    wal.set_fsync(c.fsync);
+    std::string err = wal.open(true);
+    if (!err.empty()) {
+        std::fprintf(stderr, "bench_wal: open failed: %s\n", err.c_str());
+        std::exit(1);
+    }
+
+    const std::string record = make_record(c.record_bytes);
+    size_t per_thread = total_records / (size_t)c.threads;
+    if (per_thread == 0) per_thread = 1;
+
+    std::vector<std::vector<uint64_t>> lat((size_t)c.threads);
+    std::vector<std::thread> workers;
+    auto t0 = clock::now();
+    for (int t = 0; t < c.threads; t++) {
+        workers.emplace_back([&, t] {
+            auto& mine = lat[(size_t)t];
+            mine.reserve(per_thread);
+            for (size_t i = 0; i < per_thread; i++) {
+                auto a = clock::now();
+                wal.append_json_line(record);
+                auto b = clock::now();
+                mine.push_back((uint64_t)std::chrono::duration_cast<
+                               std::chrono::nanoseconds>(b - a).count());
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    auto t1 = clock::now();
+
+    std::vector<uint64_t> all;
+    for (auto& v : lat) all.insert(all.end(), v.begin(), v.end());
+    double elapsed_ms =
+        (double)std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1000.0;
+    double per_sec = elapsed_ms > 0.0 ? (double)all.size() / (elapsed_ms / 1000.0) : 0.0;
+    double p50 = percentile_us(all, 0.50);
+    double p99 = percentile_us(all, 0.99);
+
+    std::printf("{\"bench\":\"wal_append\",\"fsync\":%d,\"framed\":%d,"
+                "\"record_bytes\":%zu,\"threads\":%d,\"records\":%zu,"
+                "\"elapsed_ms\":%.3f,\"appends_per_sec\":%.1f,"
+                "\"p50_us\":%.2f,\"p99_us\":%.2f}\n",
+                c.fsync ? 1 : 0, c.framed ? 1 : 0, c.record_bytes, c.threads,
+                all.size(), elapsed_ms, per_sec, p50, p99);
+    std::fflush(stdout);
+
+    fs::remove(wp, ec);
+}
+
+void run_matrix(bool framed, const fs::path& dir, size_t records_nofsync,
+                size_t records_fsync) {
+    const size_t sizes[] = {128, 1024, 16384};
+    const int threads[] = {1, 4, 16};
+    for (bool fsync : {false, true}) {
+        for (size_t sz : sizes) {
+            for (int th : threads) {
+                size_t total = fsync ? records_fsync : records_nofsync;
+                // Cap total bytes per cell so large records don't flood tmp.
+                const size_t byte_cap = 64ULL * 1024 * 1024;
+                if (total * sz > byte_cap) total = byte_cap / sz;
+                run_cell(Cell{fsync, framed, sz, th}, dir, total);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t records_nofsync = 50000;
+    size_t records_fsync = 2000;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--records") == 0 && i + 1 < argc) {
+            records_nofsync = (size_t)std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--fsync-records") == 0 && i + 1 < argc) {
+            records_fsync = (size_t)std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr,
+                         "usage: bench_wal [--records N] [--fsync-records N]\n");
+            return 2;
+        }
+    }
+
+    fs::path dir = fs::temp_directory_path() / "machina_bench_wal";
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+
+    for (bool framed : {false, true}) {
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            std::fprintf(stderr, "bench_wal: fork failed\n");
+            return 1;
+        }
+        if (pid == 0) {
+            ::setenv("MACHINA_WAL_FRAMED", framed ? "1" : "0", 1);
+            run_matrix(framed, dir, records_nofsync, records_fsync);
+            std::fflush(stdout);
+            ::_exit(0);
+        }
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::fprintf(stderr, "bench_wal: child for framed=%d failed\n",
+                         framed ? 1 : 0);
+            return 1;
+        }
+    }
+
+    fs::remove_all(dir, ec);
+    return 0;
+}
+
+#endif // !_WIN32
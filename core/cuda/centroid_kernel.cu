@@ -1,6 +1,10 @@
 #ifdef MACHINA_USE_CUDA
 #include <cuda_runtime.h>
 #include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
 
 // Simple batched dot product kernel.
 __global__ void dot_kernel(const float* goal, const float* centroids, int n, int dim, float* out_scores) {
@@ -76,4 +80,232 @@ extern "C" void machina_cuda_batched_dot(const float* goal, const float* centroi
         cudaMemcpy(out_scores, d_scores, score_bytes, cudaMemcpyDeviceToHost);
     }
 }
+
+namespace {
+
+// Device-resident centroid matrices keyed by the selector's cache key
+// (menu digest + dim), mirroring the host-side g_centroid_cache. Steady-state
+// selection then uploads only the goal vector and launches one kernel.
+struct CentBuf {
+    float* d = nullptr;
+    size_t cap_bytes = 0;
+    int n = 0;
+    int dim = 0;
+};
+
+std::mutex g_cent_mu;
+std::map<std::string, CentBuf> g_cent_bufs;
+
+// Pinned host staging for the tiny per-call transfers; falls back to the
+// caller's buffers when pinned allocation is unavailable.
+bool ensure_pinned(float** hptr, size_t* cap_bytes, size_t need_bytes) {
+    if (*hptr != nullptr && *cap_bytes >= need_bytes) return true;
+    if (*hptr != nullptr) cudaFreeHost(*hptr);
+    if (cudaHostAlloc((void**)hptr, need_bytes, cudaHostAllocDefault) != cudaSuccess) {
+        *hptr = nullptr;
+        *cap_bytes = 0;
+        return false;
+    }
+    *cap_bytes = need_bytes;
+    return true;
+}
+
+} // namespace
+
+// Drops the resident centroid matrix for a key (called when the host-side
+// centroid cache evicts the entry).
+extern "C" void machina_cuda_centroid_invalidate(const char* key) {
+    if (!key) return;
+    std::lock_guard<std::mutex> lk(g_cent_mu);
+    auto it = g_cent_bufs.find(key);
+    if (it == g_cent_bufs.end()) return;
+    if (it->second.d) cudaFree(it->second.d);
+    g_cent_bufs.erase(it);
+}
+
+// Scores n centroids against goal using the resident device copy for key,
+// uploading centroids_host only when the copy is missing or its shape
+// changed. Returns 0 on success; nonzero means use the CPU path.
+extern "C" int machina_cuda_centroid_select(const char* key, const float* goal,
+                                            const float* centroids_host, int n, int dim,
+                                            float* out_scores) {
+    if (!key || !goal || !out_scores || n <= 0 || dim <= 0) return 1;
+
+    static cudaStream_t stream = nullptr;
+    static bool stream_inited = false;
+    static float* d_goal = nullptr;
+    static float* d_scores = nullptr;
+    static size_t cap_goal = 0;
+    static size_t cap_scores = 0;
+    static float* h_goal = nullptr;
+    static float* h_scores = nullptr;
+    static size_t cap_h_goal = 0;
+    static size_t cap_h_scores = 0;
+
+    size_t goal_bytes = (size_t)dim * sizeof(float);
+    size_t cent_bytes = (size_t)n * (size_t)dim * sizeof(float);
+    size_t score_bytes = (size_t)n * sizeof(float);
+
+    std::lock_guard<std::mutex> lk(g_cent_mu);
+
+    if (!stream_inited) {
+        if (cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking) != cudaSuccess) {
+            stream = nullptr;
+        }
+        stream_inited = true;
+    }
+
+    CentBuf& buf = g_cent_bufs[key];
+    bool need_upload = (buf.d == nullptr || buf.n != n || buf.dim != dim);
+    if (need_upload) {
+        if (!centroids_host) {
+            g_cent_bufs.erase(key);
+            return 1;
+        }
+        if (buf.cap_bytes < cent_bytes) {
+            if (buf.d) { cudaFree(buf.d); buf.d = nullptr; buf.cap_bytes = 0; }
+            if (cudaMalloc((void**)&buf.d, cent_bytes) != cudaSuccess) {
+                buf.d = nullptr;
+                g_cent_bufs.erase(key);
+                return 1;
+            }
+            buf.cap_bytes = cent_bytes;
+        }
+        if (cudaMemcpy(buf.d, centroids_host, cent_bytes, cudaMemcpyHostToDevice) != cudaSuccess) {
+            cudaFree(buf.d);
+            g_cent_bufs.erase(key);
+            return 1;
+        }
+        buf.n = n;
+        buf.dim = dim;
+    }
+
+    if (!ensure_capacity(&d_goal, &cap_goal, goal_bytes)) return 1;
+    if (!ensure_capacity(&d_scores, &cap_scores, score_bytes)) return 1;
+
+    const float* goal_src = goal;
+    if (ensure_pinned(&h_goal, &cap_h_goal, goal_bytes)) {
+        std::memcpy(h_goal, goal, goal_bytes);
+        goal_src = h_goal;
+    }
+    float* score_dst = out_scores;
+    if (ensure_pinned(&h_scores, &cap_h_scores, score_bytes)) {
+        score_dst = h_scores;
+    }
+
+    int threads = 128;
+    int blocks = (n + threads - 1) / threads;
+    int rc = 0;
+    if (stream) {
+        cudaMemcpyAsync(d_goal, goal_src, goal_bytes, cudaMemcpyHostToDevice, stream);
+        dot_kernel<<<blocks, threads, 0, stream>>>(d_goal, buf.d, n, dim, d_scores);
+        cudaMemcpyAsync(score_dst, d_scores, score_bytes, cudaMemcpyDeviceToHost, stream);
+        if (cudaStreamSynchronize(stream) != cudaSuccess) rc = 1;
+    } else {
+        if (cudaMemcpy(d_goal, goal_src, goal_bytes, cudaMemcpyHostToDevice) != cudaSuccess) rc = 1;
+        if (rc == 0) {
+            dot_kernel<<<blocks, threads>>>(d_goal, buf.d, n, dim, d_scores);
+            if (cudaDeviceSynchronize() != cudaSuccess) rc = 1;
+        }
+        if (rc == 0 &&
+            cudaMemcpy(score_dst, d_scores, score_bytes, cudaMemcpyDeviceToHost) != cudaSuccess) {
+            rc = 1;
+        }
+    }
+    if (rc == 0 && score_dst != out_scores) {
+        std::memcpy(out_scores, score_dst, score_bytes);
+    }
+    return rc;
+}
+
+// GEMM-style variant: g stacked goal vectors against the same resident
+// centroid matrix, one thread per (goal, centroid) pair.
+__global__ void dot_kernel_multi(const float* goals, const float* centroids, int g, int n,
+                                 int dim, float* out_scores) {
+    int i = blockIdx.x * blockDim.x + threadIdx.x;  // centroid
+    int j = blockIdx.y;                             // goal
+    if (i >= n || j >= g) return;
+    float s = 0.0f;
+    const float* row = centroids + (size_t)i * (size_t)dim;
+    const float* q = goals + (size_t)j * (size_t)dim;
+    for (int d = 0; d < dim; d++) s += q[d] * row[d];
+    out_scores[(size_t)j * (size_t)n + i] = s;
+}
+
+// Scores g goals x n centroids in one launch, writing g*n floats to
+// out_scores (goal-major). Same residency/invalidation contract as
+// machina_cuda_centroid_select. Returns 0 on success.
+extern "C" int machina_cuda_centroid_select_multi(const char* key, const float* goals, int g,
+                                                  const float* centroids_host, int n, int dim,
+                                                  float* out_scores) {
+    if (!key || !goals || !out_scores || g <= 0 || n <= 0 || dim <= 0) return 1;
+
+    static cudaStream_t stream = nullptr;
+    static bool stream_inited = false;
+    static float* d_goals = nullptr;
+    static float* d_scores = nullptr;
+    static size_t cap_goals = 0;
+    static size_t cap_scores = 0;
+
+    size_t goal_bytes = (size_t)g * (size_t)dim * sizeof(float);
+    size_t cent_bytes = (size_t)n * (size_t)dim * sizeof(float);
+    size_t score_bytes = (size_t)g * (size_t)n * sizeof(float);
+
+    std::lock_guard<std::mutex> lk(g_cent_mu);
+
+    if (!stream_inited) {
+        if (cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking) != cudaSuccess) {
+            stream = nullptr;
+        }
+        stream_inited = true;
+    }
+
+    CentBuf& buf = g_cent_bufs[key];
+    if (buf.d == nullptr || buf.n != n || buf.dim != dim) {
+        if (!centroids_host) {
+            g_cent_bufs.erase(key);
+            return 1;
+        }
+        if (buf.cap_bytes < cent_bytes) {
+            if (buf.d) { cudaFree(buf.d); buf.d = nullptr; buf.cap_bytes = 0; }
+            if (cudaMalloc((void**)&buf.d, cent_bytes) != cudaSuccess) {
+                buf.d = nullptr;
+                g_cent_bufs.erase(key);
+                return 1;
+            }
+            buf.cap_bytes = cent_bytes;
+        }
+        if (cudaMemcpy(buf.d, centroids_host, cent_bytes, cudaMemcpyHostToDevice) != cudaSuccess) {
+            cudaFree(buf.d);
+            g_cent_bufs.erase(key);
+            return 1;
+        }
+        buf.n = n;
+        buf.dim = dim;
+    }
+
+    if (!ensure_capacity(&d_goals, &cap_goals, goal_bytes)) return 1;
+    if (!ensure_capacity(&d_scores, &cap_scores, score_bytes)) return 1;
+
+    int threads = 128;
+    dim3 grid((unsigned)((n + threads - 1) / threads), (unsigned)g);
+    int rc = 0;
+    if (stream) {
+        cudaMemcpyAsync(d_goals, goals, goal_bytes, cudaMemcpyHostToDevice, stream);
+        dot_kernel_multi<<<grid, threads, 0, stream>>>(d_goals, buf.d, g, n, dim, d_scores);
+        cudaMemcpyAsync(out_scores, d_scores, score_bytes, cudaMemcpyDeviceToHost, stream);
+        if (cudaStreamSynchronize(stream) != cudaSuccess) rc = 1;
+    } else {
+        if (cudaMemcpy(d_goals, goals, goal_bytes, cudaMemcpyHostToDevice) != cudaSuccess) rc = 1;
+        if (rc == 0) {
+            dot_kernel_multi<<<grid, threads>>>(d_goals, buf.d, g, n, dim, d_scores);
+            if (cudaDeviceSynchronize() != cudaSuccess) rc = 1;
+        }
+        if (rc == 0 &&
+            cudaMemcpy(out_scores, d_scores, score_bytes, cudaMemcpyDeviceToHost) != cudaSuccess) {
+            rc = 1;
+        }
+    }
+    return rc;
+}
 #endif
@@ -0,0 +1,114 @@
+#ifdef MACHINA_USE_CUDA
+#include <cuda_runtime.h>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Brute-force vecdb scan: one thread per stored vector.
+__global__ void vecdb_dot_kernel(const float* query, const float* vecs, long long n, int dim, float* out_scores) {
+    long long i = (long long)blockIdx.x * blockDim.x + threadIdx.x;
+    if (i >= n) return;
+    float s = 0.0f;
+    const float* row = vecs + (size_t)i * (size_t)dim;
+    for (int d = 0; d < dim; d++) s += query[d] * row[d];
+    out_scores[i] = s;
+}
+
+namespace {
+
+// Per-stream resident device copies of embeddings.f32, keyed by stream name.
+// Uploaded once and reused across queries; invalidated on upsert or growth.
+struct StreamBuf {
+    float* d_vecs = nullptr;
+    size_t cap_bytes = 0;
+    long long n = 0;
+    int dim = 0;
+};
+
+std::mutex g_buf_mu;
+std::map<std::string, StreamBuf> g_bufs;
+
+bool fits_in_vram(size_t need_bytes) {
+    size_t free_b = 0, total_b = 0;
+    if (cudaMemGetInfo(&free_b, &total_b) != cudaSuccess) return false;
+    // Leave headroom for the query/score buffers and everyone else.
+    return need_bytes + (64u << 20) < free_b;
+}
+
+} // namespace
+
+// Drops the resident copy for a stream (called on upsert).
+extern "C" void machina_cuda_vecdb_invalidate(const char* stream_key) {
+    if (!stream_key) return;
+    std::lock_guard<std::mutex> lk(g_buf_mu);
+    auto it = g_bufs.find(stream_key);
+    if (it == g_bufs.end()) return;
+    if (it->second.d_vecs) cudaFree(it->second.d_vecs);
+    g_bufs.erase(it);
+}
+
+// Scores all n vectors against query, writing n floats to out_scores.
+// host_vecs is only read when the resident copy is missing or stale.
+// Returns 0 on success; nonzero means the caller should use the CPU path
+// (no device, stream exceeds VRAM, or a CUDA call failed).
+extern "C" int machina_cuda_vecdb_scan(const char* stream_key, const float* host_vecs,
+                                       long long n, int dim, const float* query,
+                                       float* out_scores) {
+    if (!stream_key || !host_vecs || !query || !out_scores || n <= 0 || dim <= 0) return 1;
+
+    int count = 0;
+    if (cudaGetDeviceCount(&count) != cudaSuccess || count <= 0) return 1;
+
+    size_t vec_bytes = (size_t)n * (size_t)dim * sizeof(float);
+
+    std::lock_guard<std::mutex> lk(g_buf_mu);
+    StreamBuf& buf = g_bufs[stream_key];
+    if (buf.d_vecs == nullptr || buf.n != n || buf.dim != dim) {
+        if (buf.cap_bytes < vec_bytes) {
+            if (buf.d_vecs) { cudaFree(buf.d_vecs); buf.d_vecs = nullptr; buf.cap_bytes = 0; }
+            if (!fits_in_vram(vec_bytes)) return 1;
+            if (cudaMalloc((void**)&buf.d_vecs, vec_bytes) != cudaSuccess) {
+                buf.d_vecs = nullptr;
+                return 1;
+            }
+            buf.cap_bytes = vec_bytes;
+        }
+        if (cudaMemcpy(buf.d_vecs, host_vecs, vec_bytes, cudaMemcpyHostToDevice) != cudaSuccess) {
+            cudaFree(buf.d_vecs);
+            g_bufs.erase(stream_key);
+            return 1;
+        }
+        buf.n = n;
+        buf.dim = dim;
+    }
+
+    float* d_query = nullptr;
+    float* d_scores = nullptr;
+    size_t query_bytes = (size_t)dim * sizeof(float);
+    size_t score_bytes = (size_t)n * sizeof(float);
+    if (cudaMalloc((void**)&d_query, query_bytes) != cudaSuccess) return 1;
+    if (cudaMalloc((void**)&d_scores, score_bytes) != cudaSuccess) {
+        cudaFree(d_query);
+        return 1;
+    }
+
+    int rc = 0;
+    if (cudaMemcpy(d_query, query, query_bytes, cudaMemcpyHostToDevice) != cudaSuccess) rc = 1;
+    if (rc == 0) {
+        int threads = 128;
+        long long blocks = (n + threads - 1) / threads;
+        vecdb_dot_kernel<<<(unsigned)blocks, threads>>>(d_query, buf.d_vecs, n, dim, d_scores);
+        if (cudaDeviceSynchronize() != cudaSuccess) rc = 1;
+    }
+    if (rc == 0 &&
+        cudaMemcpy(out_scores, d_scores, score_bytes, cudaMemcpyDeviceToHost) != cudaSuccess) {
+        rc = 1;
+    }
+
+    cudaFree(d_query);
+    cudaFree(d_scores);
+    return rc;
+}
+#endif
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace machina {
+
+// Multi-pattern substring matcher (Aho-Corasick).
+//
+// Add patterns with integer ids, build() once, then every scan is a single
+// pass over the input regardless of how many patterns are loaded — the
+// alternative cascade of string::find calls grows linearly with the
+// pattern count. Patterns are matched as raw bytes, so UTF-8 sequences
+// work as-is; callers wanting case-insensitive matching lower-case both
+// sides. After build() the trie is frozen; add() must not be called again.
+class AhoCorasick {
+public:
+    void add(std::string_view pattern, int id) {
+        if (pattern.empty()) return;
+        int s = 0;
+        for (unsigned char c : pattern) {
+            if (nodes_[(size_t)s].next[c] < 0) {
+                nodes_[(size_t)s].next[c] = (int)nodes_.size();
+                nodes_.emplace_back();
+            }
+            s = nodes_[(size_t)s].next[c];
+        }
+        nodes_[(size_t)s].out.push_back(id);
+        pattern_count_++;
+    }
+
+    // Computes failure links breadth-first and flattens them into the goto
+    // table, merging each node's output list with its suffix chain so scan()
+    // never walks fail links.
+    void build() {
+        std::vector<int> queue;
+        queue.reserve(nodes_.size());
+        for (int c = 0; c < 256; c++) {
+            int v = nodes_[0].next[c];
+            if (v < 0) {
+                nodes_[0].next[c] = 0;
+            } else {
+                nodes_[(size_t)v].fail = 0;
+                queue.push_back(v);
+            }
+        }
+        for (size_t qi = 0; qi < queue.size(); qi++) {
+            int u = queue[qi];
+            Node& un = nodes_[(size_t)u];
+            const auto& fail_out = nodes_[(size_t)un.fail].out;
+            un.out.insert(un.out.end(), fail_out.begin(), fail_out.end());
+            for (int c = 0; c < 256; c++) {
+                int v = un.next[c];
+                if (v < 0) {
+                    un.next[c] = nodes_[(size_t)un.fail].next[c];
+                } else {
+                    nodes_[(size_t)v].fail = nodes_[(size_t)un.fail].next[c];
+                    queue.push_back(v);
+                }
+            }
+        }
+        built_ = true;
+    }
+
+    // Calls fn(id, end_pos) for every occurrence of every pattern, in input
+    // order (end_pos is the index one past the match).
+    void scan(std::string_view text,
+              const std::function<void(int, size_t)>& fn) const {
+        int s = 0;
+        for (size_t i = 0; i < text.size(); i++) {
+            s = nodes_[(size_t)s].next[(unsigned char)text[i]];
+            for (int id : nodes_[(size_t)s].out) fn(id, i + 1);
+        }
+    }
+
+    // Lowest id occurring anywhere in text, or -1 if nothing matches.
+    // Stops early once id 0 (the best possible) is seen.
+    int match_min_id(std::string_view text) const {
+        int best = -1;
+        int s = 0;
+        for (size_t i = 0; i < text.size(); i++) {
+            s = nodes_[(size_t)s].next[(unsigned char)text[i]];
+            for (int id : nodes_[(size_t)s].out) {
+                if (best < 0 || id < best) best = id;
+                if (best == 0) return 0;
+            }
+        }
+        return best;
+    }
+
+    size_t pattern_count() const { return pattern_count_; }
+    bool built() const { return built_; }
+
+private:
+    struct Node {
+        std::array<int, 256> next;
+        int fail{0};
+        std::vector<int> out;
+        Node() { next.fill(-1); }
+    };
+
+    std::vector<Node> nodes_{Node{}};
+    size_t pattern_count_{0};
+    bool built_{false};
+};
+
+} // namespace machina
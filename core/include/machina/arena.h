@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace machina {
+
+// Monotonic bump allocator for per-request scratch data.
+//
+// Hands out pointers from a chain of fixed-size blocks and frees everything
+// at once on reset()/destruction, so hot loops that would otherwise make
+// thousands of small heap allocations (tokens, temporary buffers) pay one
+// pointer bump each instead. Nothing is ever freed individually — only use
+// it for trivially destructible data whose lifetime ends with the request.
+class Arena {
+public:
+    explicit Arena(size_t block_bytes = 64 * 1024) : block_bytes_(block_bytes) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* alloc(size_t n, size_t align = alignof(std::max_align_t)) {
+        if (n == 0) n = 1;
+        if (!blocks_.empty()) {
+            Block& b = blocks_.back();
+            size_t used = (b.used + align - 1) & ~(align - 1);
+            if (used + n <= b.cap) {
+                b.used = used + n;
+                return b.data.get() + used;
+            }
+        }
+        size_t cap = n > block_bytes_ ? n : block_bytes_;
+        blocks_.push_back(Block{std::make_unique<char[]>(cap), cap, n});
+        return blocks_.back().data.get();
+    }
+
+    // Copies the bytes into the arena; the returned view stays valid until
+    // reset()/destruction.
+    std::string_view copy(std::string_view s) {
+        char* p = static_cast<char*>(alloc(s.size(), 1));
+        std::memcpy(p, s.data(), s.size());
+        return std::string_view(p, s.size());
+    }
+
+    // Discards all allocations, keeping the first block for reuse.
+    void reset() {
+        if (blocks_.size() > 1) blocks_.resize(1);
+        if (!blocks_.empty()) blocks_.front().used = 0;
+    }
+
+    // Total bytes currently handed out (diagnostics).
+    size_t allocated() const {
+        size_t n = 0;
+        for (const Block& b : blocks_) n += b.used;
+        return n;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t cap{0};
+        size_t used{0};
+    };
+    std::vector<Block> blocks_;
+    size_t block_bytes_;
+};
+
+} // namespace machina
@@ -0,0 +1,45 @@
+#pragma once
+
+// Shared circuit breaker — one memory-mapped table for every breaker key.
+//
+// Two breakers grew independently: ExternalProcessSelector kept per-instance
+// counters (so each serve worker rediscovered a broken policy command on its
+// own), and genesis kept one JSON file per key, re-read and rewritten on
+// every generated-tool call. Both collapse onto a fixed table of slots in a
+// small file under $MACHINA_ROOT/work, mapped shared into every process that
+// asks: a breaker check is a hash, a probe, and a few relaxed atomic loads —
+// no file I/O — and a trip in one process (toolhost, serve worker, runner)
+// is immediately visible to the rest.
+//
+// Semantics per key: failures within window_ms accumulate; reaching
+// threshold blocks the key until now + cooldown_ms; a success clears it.
+// Counters are advisory (relaxed atomics, no cross-field locking) — a racing
+// pair of failures may count as one, which a breaker can afford.
+
+#include <cstdint>
+#include <string>
+
+namespace machina {
+
+// Snapshot of one key's slot, for diagnostics in error messages.
+struct BreakerState {
+    int fail_count{0};
+    int64_t first_fail_ms{0};
+    int64_t last_fail_ms{0};
+    int64_t block_until_ms{0};
+};
+
+// True while the key is tripped (block_until in the future). out, when
+// non-null, receives the current slot snapshot either way.
+bool breaker_is_blocked(const std::string& key, int64_t now_ms,
+                        BreakerState* out = nullptr);
+
+// Records one failure; trips the key for cooldown_ms once threshold
+// failures land within window_ms of the first.
+void breaker_record_fail(const std::string& key, int64_t now_ms,
+                         int threshold, int64_t window_ms, int64_t cooldown_ms);
+
+// Clears the key's counters and any block.
+void breaker_record_success(const std::string& key);
+
+} // namespace machina
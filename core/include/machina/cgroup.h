@@ -0,0 +1,46 @@
+#pragma once
+
+// cgroup v2 transient-scope resource limiting (Linux only).
+//
+// RLIMIT_AS counts address space, not resident memory, which false-positives
+// on CUDA/PyTorch children that map tens of GB of device and reserved virtual
+// memory — embedding providers end up running with no memory limit at all.
+// A transient cgroup gives real accounting instead: the parent creates a
+// child group under a delegated cgroup v2 directory, writes memory.max /
+// pids.max (and cpu.max when requested), the forked child joins it before
+// exec, and the parent removes the group after reaping.
+//
+// Opt-in via ProcLimits.enable_cgroup or MACHINA_PROC_CGROUP=1. The base
+// directory comes from MACHINA_PROC_CGROUP_DIR, falling back to the calling
+// process's own cgroup from /proc/self/cgroup. Controller delegation is
+// attempted best-effort; when memory.max cannot be written (no delegation),
+// creation fails and callers fall back to plain rlimits.
+
+#include "machina/proc.h"
+
+#include <string>
+
+namespace machina {
+
+#ifdef __linux__
+
+// True when cgroup limiting is requested (lim.enable_cgroup or
+// MACHINA_PROC_CGROUP=1) and a writable cgroup v2 base directory exists.
+bool cgroup_available(const ProcLimits& lim);
+
+// Create a transient child cgroup with memory.max / pids.max / cpu.max
+// derived from lim. Returns the cgroup directory path, or "" on failure
+// (err filled when non-null).
+std::string cgroup_create_transient(const ProcLimits& lim, std::string* err);
+
+// Move the calling process into the cgroup. Called by spawn children
+// between fork and exec.
+bool cgroup_join(const std::string& dir);
+
+// Remove a transient cgroup once it is empty (retries briefly — membership
+// clears asynchronously after the child is reaped).
+void cgroup_remove(const std::string& dir);
+
+#endif
+
+} // namespace machina
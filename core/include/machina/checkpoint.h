@@ -0,0 +1,41 @@
+#pragma once
+
+#include "state.h"
+#include "wal.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace machina {
+
+// Snapshot + WAL-truncate checkpointing for DSState.
+//
+// Recovering state by replaying an entire WAL gets slower the longer a
+// daemon runs. A checkpoint pins the full DSState (dsstate_to_json) to a
+// snapshot file together with the WAL position it covers; recovery loads
+// the snapshot and replays only the suffix appended after it, and segments
+// older than the last checkpoint can be deleted safely.
+
+struct CheckpointInfo {
+    int64_t created_ms{0};
+    uint64_t wal_seq{0};  // WAL records covered by this snapshot
+};
+
+// Atomically writes a snapshot of `ds` covering `wal_seq` appended records
+// (tmp file + rename + fsync). Returns empty string on success.
+std::string checkpoint_write(const std::filesystem::path& file, const DSState& ds,
+                             uint64_t wal_seq);
+
+// Loads a snapshot written by checkpoint_write. Returns empty string on
+// success; `info` is optional.
+std::string checkpoint_load(const std::filesystem::path& file, DSState* out,
+                            CheckpointInfo* info);
+
+// Snapshot + truncate in one step: writes the snapshot, then truncates the
+// active WAL segment and deletes rotated segments, so everything remaining
+// in the WAL is the post-checkpoint suffix. Returns empty string on success.
+std::string checkpoint_and_truncate(const std::filesystem::path& file,
+                                    const DSState& ds, Wal& wal);
+
+} // namespace machina
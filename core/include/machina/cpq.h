@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <cstdint>
 #include <mutex>
@@ -13,6 +15,16 @@ namespace machina {
 // - Thread-safe push/pop
 // - Blocking pop with shutdown()
 // - Lower priority value => higher priority
+// - Optionally sharded: construct with shards > 1 to split the heap across
+//   that many independently locked sub-queues. push touches one shard's
+//   lock; pop peeks every shard and takes the globally best item. With one
+//   shard (the default) ordering is exact; with several, priority order is
+//   exact per shard and best-effort across shards while pushes race a pop's
+//   peek — fine for work scheduling, where a momentarily second-best item
+//   costs nothing.
+// - size()/closed() are lock-free reads either way.
+// - try_pop / try_pop_batch for non-blocking callers; pop_batch drains up
+//   to N items with one lock hold per shard for bursty consumers.
 //
 // Intent: fast in-proc scheduling (daemon mode) while preserving file-queue safety as the source of truth.
 
@@ -35,48 +47,143 @@ private:
         }
     };
 
+    // Padded out so neighbouring shard locks don't share a cache line.
+    struct alignas(64) Shard {
+        std::mutex mu;
+        std::priority_queue<Item, std::vector<Item>, Cmp> q;
+    };
+
 public:
-    ConcurrentPriorityQueue() = default;
+    ConcurrentPriorityQueue() : ConcurrentPriorityQueue(1) {}
+
+    explicit ConcurrentPriorityQueue(size_t shards)
+        : shards_(shards > 0 ? (shards > 64 ? 64 : shards) : 1) {}
 
     void push(int32_t priority, T value) {
-        std::lock_guard<std::mutex> lk(mu_);
-        if (closed_) return;
-        q_.push(Item{priority, seq_++, std::move(value)});
-        cv_.notify_one();
+        if (closed_.load()) return;
+        const uint64_t seq = seq_.fetch_add(1);
+        {
+            Shard& s = shards_[seq % shards_.size()];
+            std::lock_guard<std::mutex> lk(s.mu);
+            s.q.push(Item{priority, seq, std::move(value)});
+        }
+        size_.fetch_add(1);
+        // seq_cst ordering of the size increment against the waiter's
+        // re-check makes this test-then-notify race-free: either we see the
+        // waiter, or the waiter sees the new size before sleeping.
+        if (waiters_.load() > 0) {
+            std::lock_guard<std::mutex> lk(sleep_mu_);
+            sleep_cv_.notify_one();
+        }
     }
 
     // Returns false when shut down.
     bool pop(Item& out) {
-        std::unique_lock<std::mutex> lk(mu_);
-        cv_.wait(lk, [&]{ return closed_ || !q_.empty(); });
-        if (q_.empty()) return false;
-        out = q_.top();  // copy (const ref from priority_queue::top)
-        q_.pop();
-        return true;
+        for (;;) {
+            if (try_pop(out)) return true;
+            if (closed_.load() && size_.load() == 0) return false;
+            std::unique_lock<std::mutex> lk(sleep_mu_);
+            waiters_.fetch_add(1);
+            sleep_cv_.wait(lk, [&] { return closed_.load() || size_.load() > 0; });
+            waiters_.fetch_sub(1);
+        }
     }
 
-    void shutdown() {
-        std::lock_guard<std::mutex> lk(mu_);
-        closed_ = true;
-        cv_.notify_all();
+    // Non-blocking: pops the best item across shards, false when empty.
+    bool try_pop(Item& out) {
+        if (size_.load() == 0) return false;
+        // Peek every shard, then pop from the one holding the best top.
+        // Between the peek and the pop another thread may push a better
+        // item elsewhere; we still pop a top element, just possibly not
+        // the global best of that instant (see header comment).
+        for (;;) {
+            int best = -1;
+            int32_t best_prio = 0;
+            uint64_t best_seq = 0;
+            for (size_t i = 0; i < shards_.size(); i++) {
+                std::lock_guard<std::mutex> lk(shards_[i].mu);
+                if (shards_[i].q.empty()) continue;
+                const Item& t = shards_[i].q.top();
+                if (best < 0 || t.priority < best_prio ||
+                    (t.priority == best_prio && t.seq < best_seq)) {
+                    best = (int)i;
+                    best_prio = t.priority;
+                    best_seq = t.seq;
+                }
+            }
+            if (best < 0) return false;
+            Shard& s = shards_[(size_t)best];
+            std::lock_guard<std::mutex> lk(s.mu);
+            if (s.q.empty()) continue; // raced another popper, rescan
+            // top() is const-ref only; moving out before pop() is safe
+            // because the element is removed immediately after.
+            out = std::move(const_cast<Item&>(s.q.top()));
+            s.q.pop();
+            size_.fetch_sub(1);
+            return true;
+        }
     }
 
-    size_t size() const {
-        std::lock_guard<std::mutex> lk(mu_);
-        return q_.size();
+    // Blocking batch pop: waits like pop(), then drains up to max_n items —
+    // one lock hold per shard instead of one per item. Appends to `out` in
+    // priority order (batch-local) and returns the number popped; 0 means
+    // the queue was shut down and is empty.
+    size_t pop_batch(std::vector<Item>& out, size_t max_n) {
+        if (max_n == 0) return 0;
+        for (;;) {
+            size_t got = try_pop_batch(out, max_n);
+            if (got > 0) return got;
+            if (closed_.load() && size_.load() == 0) return 0;
+            std::unique_lock<std::mutex> lk(sleep_mu_);
+            waiters_.fetch_add(1);
+            sleep_cv_.wait(lk, [&] { return closed_.load() || size_.load() > 0; });
+            waiters_.fetch_sub(1);
+        }
     }
 
-    bool closed() const {
-        std::lock_guard<std::mutex> lk(mu_);
-        return closed_;
+    // Non-blocking batch drain; same contract as pop_batch minus the wait.
+    size_t try_pop_batch(std::vector<Item>& out, size_t max_n) {
+        if (max_n == 0 || size_.load() == 0) return 0;
+        const size_t start = out.size();
+        size_t got = 0;
+        for (size_t i = 0; i < shards_.size() && got < max_n; i++) {
+            Shard& s = shards_[i];
+            std::lock_guard<std::mutex> lk(s.mu);
+            while (!s.q.empty() && got < max_n) {
+                out.push_back(std::move(const_cast<Item&>(s.q.top())));
+                s.q.pop();
+                got++;
+            }
+        }
+        if (got == 0) return 0;
+        size_.fetch_sub(got);
+        // Shard-by-shard draining interleaves priorities; restore order
+        // within the batch (cheap relative to the saved lock traffic).
+        std::sort(out.begin() + (long)start, out.end(), [](const Item& a, const Item& b) {
+            if (a.priority != b.priority) return a.priority < b.priority;
+            return a.seq < b.seq;
+        });
+        return got;
     }
 
+    void shutdown() {
+        closed_.store(true);
+        std::lock_guard<std::mutex> lk(sleep_mu_);
+        sleep_cv_.notify_all();
+    }
+
+    size_t size() const { return size_.load(); }
+
+    bool closed() const { return closed_.load(); }
+
 private:
-    mutable std::mutex mu_;
-    std::condition_variable cv_;
-    std::priority_queue<Item, std::vector<Item>, Cmp> q_;
-    uint64_t seq_{0};
-    bool closed_{false};
+    std::vector<Shard> shards_;
+    std::atomic<uint64_t> seq_{0};
+    std::atomic<size_t> size_{0};
+    std::atomic<int> waiters_{0};
+    std::atomic<bool> closed_{false};
+    std::mutex sleep_mu_;
+    std::condition_variable sleep_cv_;
 };
 
 } // namespace machina
@@ -14,18 +14,73 @@ inline std::string sha256_hex(const std::string& s) {
     return sha256_hex(reinterpret_cast<const uint8_t*>(s.data()), s.size());
 }
 
+// Streaming SHA256: feed data in pieces, finalize once. Lets callers hash
+// large inputs (request bodies, plugin .so files) without materializing a
+// single contiguous buffer. final()/final_hex() consume the context.
+class Sha256Ctx {
+public:
+    Sha256Ctx();
+    void update(const uint8_t* data, size_t n);
+    void update(const std::string& s) {
+        update(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+    }
+    std::vector<uint8_t> final();
+    std::string final_hex();
+
+private:
+    friend class HmacKey;
+    uint32_t state_[8];
+    uint64_t total_{0};  // bytes absorbed, including the buffered tail
+    uint8_t buf_[64];
+    size_t buflen_{0};
+};
+
 // HMAC-SHA256 (hex)
 std::string hmac_sha256_hex(const std::string& key, const uint8_t* data, size_t n);
 inline std::string hmac_sha256_hex(const std::string& key, const std::string& s) {
     return hmac_sha256_hex(key, reinterpret_cast<const uint8_t*>(s.data()), s.size());
 }
 
+// Precomputed HMAC-SHA256 key schedule. Construction folds the ipad/opad
+// blocks into midstates once; each sign_hex() then costs only the message
+// hash plus one outer block, instead of redoing the key schedule per call.
+// Build one per secret when verifying many signatures (serve request auth).
+class HmacKey {
+public:
+    explicit HmacKey(const std::string& secret);
+    std::string sign_hex(const uint8_t* data, size_t n) const;
+    std::string sign_hex(const std::string& s) const {
+        return sign_hex(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+    }
+
+private:
+    uint32_t inner_state_[8];  // IV advanced over (key ^ ipad)
+    uint32_t outer_state_[8];  // IV advanced over (key ^ opad)
+};
+
 // Constant-time string equality (for comparing hex signatures)
 bool constant_time_eq(const std::string& a, const std::string& b);
 
 // SHA256 of a file's contents (empty string on error)
 std::string sha256_hex_file(const std::filesystem::path& path);
 
+// ---------- chunked tree hash ----------
+// Digests fixed-size chunks independently — in parallel on the shared
+// ThreadPool when there is more than one — then hashes the concatenated
+// chunk digests into a root. The result is self-describing
+// ("tree:v1:<chunk_bytes>:<root_hex>") so a verifier recomputes with the
+// same chunking. Used for plugin integrity checks, where genesis-built
+// shared objects reach tens of MB and load-time verification is serial
+// cold-start cost otherwise. Not interchangeable with the flat sha256 of
+// the same bytes.
+std::string sha256_tree_hex(const uint8_t* data, size_t n, size_t chunk_bytes = 4u << 20);
+std::string sha256_tree_hex_file(const std::filesystem::path& path, size_t chunk_bytes = 4u << 20);
+
+// Recompute path's digest in the same format as `expected` (plain hex or
+// tree:v1), so the caller can compare like with like. Empty string on I/O
+// error or a malformed tree spec.
+std::string sha256_hex_file_matching(const std::filesystem::path& path, const std::string& expected);
+
 // Cryptographically secure 32-bit random
 uint32_t secure_rand32();
 
@@ -10,6 +10,11 @@ namespace machina {
 // - Produces a fixed-dim vector suitable for centroid scoring.
 std::vector<float> hash_embedding(const std::string& text, size_t dim);
 
+// Batched variant: one embedding per text, bit-identical to hash_embedding.
+// Large batches are spread across the shared worker pool.
+std::vector<std::vector<float>> hash_embedding_many(const std::vector<std::string>& texts,
+                                                    size_t dim);
+
 float dot(const std::vector<float>& a, const std::vector<float>& b);
 
 } // namespace machina
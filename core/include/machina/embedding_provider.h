@@ -20,6 +20,13 @@ struct EmbedResult {
 //   Config:
 //     MACHINA_EMBED_CMD="python3 tools/embed/embed_cmd_stub.py"
 //     MACHINA_EMBED_TIMEOUT_MS=5000
+//     MACHINA_EMBED_PERSIST=1  keep one provider process warm and speak
+//       newline-delimited JSON over its stdin/stdout (same request/response
+//       shapes, one line each); falls back to one-shot spawns on any failure
+//     MACHINA_EMBED_CACHE_MAX=4096  LRU cache of cmd results keyed by
+//       sha256(text)+dim+provider config (0 disables)
+//     MACHINA_EMBED_CACHE_PERSIST=1  mirror cache entries under
+//       MACHINA_ROOT/work/embed_cache so warm caches survive restarts
 //
 // Contract for cmd provider:
 // - stdin: JSON {"text":"...","dim":384}
@@ -31,6 +38,10 @@ EmbedResult embed_text_best_effort(const std::string& text, size_t dim);
 // Contract for cmd provider batch mode:
 // - stdin:  {"texts":["a","b",...],"dim":384}
 // - stdout: {"embeddings":[[...],[...],...],"provider":"..."}
+// Batches of MACHINA_EMBED_STREAM_MIN texts or more (default 1024, 0
+// disables) are streamed: stdin is written incrementally and each inner
+// embedding array is parsed as it closes, so batch size is not bounded by
+// MACHINA_EMBED_STDOUT_MAX or pipe capacity.
 std::vector<EmbedResult> embed_texts_batch(const std::vector<std::string>& texts, size_t dim);
 
 // Normalize vector in-place (L2). If zero norm, leaves vector unchanged.
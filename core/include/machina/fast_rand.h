@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "crypto.h"
+
+namespace machina {
+
+// Fast non-blocking randomness for id generation.
+//
+// std::random_device costs a kernel entropy read per construction; on hot
+// enqueue paths that shows up. Here each thread seeds a xoshiro256++ state
+// once from secure_rand32() (getrandom/urandom) and every subsequent draw
+// is a few register ops. The stream is unpredictable without reading
+// process memory, which is the trust boundary for run ids, queue job
+// names and lease tokens; anything answering to an external attacker
+// model should keep using secure_rand32() directly.
+
+namespace fast_rand_detail {
+
+inline uint64_t rotl64(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+struct Xoshiro256 {
+    uint64_t s[4];
+
+    Xoshiro256() {
+        for (auto& w : s) w = ((uint64_t)secure_rand32() << 32) | secure_rand32();
+        s[0] |= 1; // the all-zero state is the one forbidden seed
+    }
+
+    uint64_t next() {
+        const uint64_t result = rotl64(s[0] + s[3], 23) + s[0];
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl64(s[3], 45);
+        return result;
+    }
+};
+
+} // namespace fast_rand_detail
+
+inline uint64_t fast_rand64() {
+    thread_local fast_rand_detail::Xoshiro256 rng;
+    return rng.next();
+}
+
+inline uint32_t fast_rand32() { return (uint32_t)fast_rand64(); }
+
+// `bytes` random bytes as lowercase hex (2*bytes characters).
+inline std::string fast_rand_hex(size_t bytes) {
+    static const char* kHex = "0123456789abcdef";
+    std::string out;
+    out.reserve(bytes * 2);
+    uint64_t v = 0;
+    size_t have = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        if (have == 0) { v = fast_rand64(); have = 8; }
+        unsigned char b = (unsigned char)(v & 0xFF);
+        v >>= 8;
+        have--;
+        out.push_back(kHex[b >> 4]);
+        out.push_back(kHex[b & 0xF]);
+    }
+    return out;
+}
+
+} // namespace machina
@@ -34,8 +34,13 @@ public:
     // Get all registered goal IDs.
     std::vector<std::string> allGoalIds() const;
 
+    // Bumped on every mutation; lets callers cache derived data (serialized
+    // goal lists) and invalidate only when the registry actually changed.
+    uint64_t generation() const { return generation_; }
+
 private:
     std::unordered_map<std::string, GoalDesc> goals_;
+    uint64_t generation_{0};
 
     // Prefix scan: find the best matching GoalDesc for a goal_id.
     const GoalDesc* findByPrefix(const std::string& goal_id) const;
@@ -11,6 +11,11 @@ class GpuContext {
 public:
     static GpuContext create();
 
+    // Long-lived process-wide context: the device probe and cudaSetDevice run
+    // once instead of per selection. Prefer this on hot paths; create() stays
+    // for callers that want a fresh probe.
+    static GpuContext& shared();
+
     bool available() const { return available_; }
     int device_index() const { return device_index_; }
     int device_count() const { return device_count_; }
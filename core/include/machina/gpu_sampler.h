@@ -0,0 +1,57 @@
+#pragma once
+
+// Shared-memory GPU metrics snapshot.
+//
+// Querying GPU state on demand pays a full NVML dlopen/init/shutdown per
+// call (tool_gpu_metrics) or a fresh device probe (gpu_signature), and the
+// autonomic loop polls every few seconds. Instead, one background sampler
+// holds a persistent NVML session and publishes a fixed-layout snapshot
+// into $MACHINA_ROOT/work/gpu_metrics.shm behind a seqlock, so any reader
+// in any process sharing the root — tool_gpu_metrics, proc metrics, the
+// serve /metrics endpoint — gets current numbers with two atomic loads and
+// a memcpy, no subprocess and no NVML round trip. The mapping degrades to
+// a process-local heap snapshot when the file cannot be mapped, same as
+// the breaker table.
+
+#include <cstdint>
+
+namespace machina {
+
+struct GpuSnapshot {
+    int64_t sample_ms{0};      // wall-clock publish time; 0 = never sampled
+    uint32_t available{0};
+    int32_t device_count{0};
+    int32_t device_index{-1};
+    uint32_t temp_c{0};
+    uint32_t power_mw{0};
+    uint32_t pad{0};
+    uint64_t memory_total_mb{0};
+    uint64_t memory_used_mb{0};
+    uint64_t memory_free_mb{0};
+    char backend[24]{};
+    char name[96]{};
+};
+
+// One NVML query through the persistent per-process session (dlopen and
+// nvmlInit happen once, not per call). Always fills *out; available=0 with
+// backend NVML_UNAVAILABLE/NVML_PARTIAL/NVML_INIT_FAIL when the library
+// is missing or broken.
+void gpu_sample_direct(GpuSnapshot* out);
+
+// Seqlock read of the shared snapshot. False when no sampler has published
+// yet (or a torn write could not be avoided after a few retries).
+bool gpu_snapshot_read(GpuSnapshot* out);
+
+// True when the snapshot was published within max_age_ms of now_ms.
+bool gpu_snapshot_fresh(const GpuSnapshot& s, int64_t now_ms, int64_t max_age_ms);
+
+// Publishes *s into the shared snapshot (seqlock write). Exposed for the
+// sampler thread and for tests; normal callers only read.
+void gpu_snapshot_publish(const GpuSnapshot& s);
+
+// Background sampler: samples and publishes every interval_ms. Idempotent;
+// interval_ms <= 0 is a no-op. stop() joins the thread.
+void gpu_sampler_start(int interval_ms);
+void gpu_sampler_stop();
+
+} // namespace machina
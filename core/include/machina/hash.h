@@ -23,6 +23,10 @@ inline std::string hex64(uint64_t v) {
     return oss.str();
 }
 
+// ---------- CRC32 (ISO 3309 / zlib polynomial, non-crypto) ----------
+// Purpose: torn-write / corruption detection for WAL framing and blocks.
+uint32_t crc32(const void* data, size_t n);
+
 // ---------- SHA-256 (crypto hash) ----------
 // Purpose: tamper-evident digests for logs/state/menu.
 // NOTE: Implementation lives in core/src/hash.cpp to keep compile time low.
@@ -32,4 +36,11 @@ inline std::string hex64(uint64_t v) {
 std::array<uint8_t, 32> sha256_bytes(const uint8_t* data, size_t n);
 std::string sha256_hex(const std::string& s);
 
+// Low-level SHA-256 compression: folds nblocks 64-byte blocks into state
+// (the eight working words, host byte order). Runtime-dispatched to x86
+// SHA-NI or the ARMv8 crypto extension when the CPU has them, scalar
+// otherwise; resolved once like the vec_simd kernels. Shared by this
+// namespace and machina::crypto so both front ends get the hardware path.
+void sha256_compress(uint32_t state[8], const uint8_t* blocks, size_t nblocks);
+
 } // namespace machina::hash
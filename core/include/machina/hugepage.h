@@ -0,0 +1,75 @@
+#pragma once
+
+// 2MB huge-page backing for large, long-lived, sequentially scanned
+// buffers (centroid matrices, vecdb read paths).
+//
+// Big flat float matrices walked front to back burn one TLB entry per 4KB
+// page; perf counters on the serve boxes show scan loops stalling on TLB
+// misses well before memory bandwidth. A 2MB page covers 512x the reach,
+// and buffers of a few MB or more recover 10-20% of scan throughput.
+//
+// Allocation order: mmap with MAP_HUGETLB (explicit huge pages, fails fast
+// when none are reserved), then an anonymous mmap tagged MADV_HUGEPAGE so
+// transparent huge pages can promote it, then plain operator new. Buffers
+// below one huge page never take the mmap path — they cannot be promoted
+// and would waste most of the page. MACHINA_HUGEPAGES=0 is the kill
+// switch; non-Linux builds always use the plain path.
+
+#include <cstddef>
+#include <new>
+
+namespace machina {
+
+// One explicit huge page; also the promotion granule for THP on x86-64.
+inline constexpr size_t kHugePageBytes = 2u * 1024u * 1024u;
+
+// True unless disabled via MACHINA_HUGEPAGES=0 (or a non-Linux build).
+bool hugepage_enabled();
+
+// Maps at least `len` bytes of zeroed memory backed (or promotable) by
+// huge pages; nullptr when both mmap paths fail. Release via
+// hugepage_free with the same len.
+void* hugepage_alloc(size_t len);
+
+// Unmaps a pointer from hugepage_alloc; returns false (doing nothing)
+// for pointers it does not own, so callers that mix in heap fallbacks
+// can safely try here first.
+bool hugepage_free(void* p, size_t len);
+
+// Tags an existing mapping for huge-page promotion (MADV_HUGEPAGE);
+// best-effort — file-backed maps only promote on kernels built with
+// read-only file THP.
+bool hugepage_advise(void* p, size_t len);
+
+// std allocator that puts huge-page-sized allocations on the mmap path
+// and delegates the rest to operator new. Stateless, so containers using
+// it compare and swap freely.
+template <class T>
+struct HugePageAllocator {
+    using value_type = T;
+
+    HugePageAllocator() = default;
+    template <class U>
+    HugePageAllocator(const HugePageAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (bytes >= kHugePageBytes && hugepage_enabled()) {
+            if (void* p = hugepage_alloc(bytes)) return static_cast<T*>(p);
+        }
+        return static_cast<T*>(::operator new(bytes));
+    }
+
+    void deallocate(T* p, size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (bytes >= kHugePageBytes && hugepage_free(p, bytes)) return;
+        ::operator delete(p);
+    }
+
+    template <class U>
+    bool operator==(const HugePageAllocator<U>&) const { return true; }
+    template <class U>
+    bool operator!=(const HugePageAllocator<U>&) const { return false; }
+};
+
+} // namespace machina
@@ -1,5 +1,6 @@
 #pragma once
 #include "types.h"
+#include <map>
 #include <unordered_map>
 #include <vector>
 #include <string>
@@ -20,8 +21,30 @@ struct Menu {
 
     void buildIndex();
     const MenuItem* resolve(const SID& sid) const;
+
+    // Incremental mutation: keeps sid_index and the digest memo in step, so
+    // single-item edits on a large menu cost one piece, not a full rehash.
+    // Direct edits to `items` stay allowed but must be followed by
+    // buildIndex(), which drops the memo wholesale.
+    void addItem(MenuItem item);
+    bool removeItem(const SID& sid); // false when the SID is not present
+
     std::string digest_raw() const; // deterministic canonical menu representation
     std::string digest() const;     // SHA-256 of digest_raw() (compact)
+
+private:
+    void rebuildCanon() const;
+
+    // Digest memo: canonical per-item pieces keyed (and thus ordered) by
+    // SID, plus the finished hash. The selector path asks for digest() on
+    // every step against a menu that rarely changes, so the hash is computed
+    // once and single-item edits only touch their own piece. Mutable keeps
+    // the accessors const; like sid_index there is no synchronization —
+    // menus are per-run objects.
+    mutable std::multimap<uint16_t, std::string> canon_;
+    mutable bool canon_valid_{false};
+    mutable std::string digest_cache_;
+    mutable bool digest_valid_{false};
 };
 
 } // namespace machina
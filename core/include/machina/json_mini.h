@@ -9,11 +9,14 @@
 
 #include <climits>
 #include <cstdint>
+#include <cstdio>
 #include <optional>
-#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "machina/str_simd.h"
+
 namespace machina::json_mini {
 
 struct Doc {
@@ -55,92 +58,155 @@ inline Doc parse(const std::string& json) {
     return Doc{obj};
 }
 
+// Cursor: parse once, extract many.
+//
+// Every free get_* below re-parses the whole document, so pulling N
+// fields costs N parses. A Cursor holds the parsed tree and answers any
+// number of lookups against it; use it whenever more than one field is
+// read from the same document.
+class Cursor {
+public:
+    explicit Cursor(const std::string& json) : d_(parse(json)) {}
+    explicit Cursor(Doc d) : d_(std::move(d)) {}
+
+    // True when the document parsed and is a JSON object.
+    bool ok() const { return d_.root && json_object_is_type(d_.root, json_type_object); }
+
+    bool has_key(const std::string& key) const {
+        json_object* v = nullptr;
+        return find(key, &v);
+    }
+
+    std::optional<std::string> get_string(const std::string& key) const {
+        json_object* v = nullptr;
+        if (!find(key, &v) || !json_object_is_type(v, json_type_string)) return std::nullopt;
+        return std::string(json_object_get_string(v));
+    }
+
+    std::optional<int64_t> get_int(const std::string& key) const {
+        json_object* v = nullptr;
+        if (!find(key, &v) || !json_object_is_type(v, json_type_int)) return std::nullopt;
+        return static_cast<int64_t>(json_object_get_int64(v));
+    }
+
+    std::optional<double> get_double(const std::string& key) const {
+        json_object* v = nullptr;
+        if (!find(key, &v) || !v) return std::nullopt;
+        if (!(json_object_is_type(v, json_type_double) || json_object_is_type(v, json_type_int))) return std::nullopt;
+        return json_object_get_double(v);
+    }
+
+    std::optional<bool> get_bool(const std::string& key) const {
+        json_object* v = nullptr;
+        if (!find(key, &v) || !json_object_is_type(v, json_type_boolean)) return std::nullopt;
+        return json_object_get_boolean(v) != 0;
+    }
+
+    std::vector<std::string> get_array_strings(const std::string& key) const {
+        std::vector<std::string> out;
+        json_object* arr = nullptr;
+        if (!find(key, &arr) || !json_object_is_type(arr, json_type_array)) return out;
+        const size_t n = json_object_array_length(arr);
+        out.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            json_object* el = json_object_array_get_idx(arr, static_cast<int>(i));
+            if (el && json_object_is_type(el, json_type_string)) {
+                out.emplace_back(json_object_get_string(el));
+            }
+        }
+        return out;
+    }
+
+    std::optional<std::string> get_object_raw(const std::string& key) const {
+        json_object* v = nullptr;
+        if (!find(key, &v) || !v) return std::nullopt;
+        return std::string(json_object_to_json_string_ext(v, JSON_C_TO_STRING_PLAIN));
+    }
+
+    std::optional<std::string> get_array_raw(const std::string& key) const {
+        json_object* v = nullptr;
+        if (!find(key, &v) || !json_object_is_type(v, json_type_array)) return std::nullopt;
+        return std::string(json_object_to_json_string_ext(v, JSON_C_TO_STRING_PLAIN));
+    }
+
+    // Binding helpers for the "extract these N fields" pattern: assign
+    // into `out` when the key is present with the right type, leaving the
+    // caller's default in place otherwise. Return whether they assigned.
+    bool bind(const std::string& key, std::string& out) const {
+        auto v = get_string(key);
+        if (v) out = std::move(*v);
+        return v.has_value();
+    }
+    bool bind(const std::string& key, int64_t& out) const {
+        auto v = get_int(key);
+        if (v) out = *v;
+        return v.has_value();
+    }
+    bool bind(const std::string& key, int& out) const {
+        auto v = get_int(key);
+        if (v) out = static_cast<int>(*v);
+        return v.has_value();
+    }
+    bool bind(const std::string& key, size_t& out) const {
+        auto v = get_int(key);
+        if (v && *v >= 0) out = static_cast<size_t>(*v);
+        return v.has_value() && *v >= 0;
+    }
+    bool bind(const std::string& key, double& out) const {
+        auto v = get_double(key);
+        if (v) out = *v;
+        return v.has_value();
+    }
+    bool bind(const std::string& key, bool& out) const {
+        auto v = get_bool(key);
+        if (v) out = *v;
+        return v.has_value();
+    }
+    bool bind(const std::string& key, std::vector<std::string>& out) const {
+        if (!has_key(key)) return false;
+        out = get_array_strings(key);
+        return true;
+    }
+
+private:
+    bool find(const std::string& key, json_object** out) const {
+        if (!ok()) return false;
+        return json_object_object_get_ex(d_.root, key.c_str(), out);
+    }
+
+    Doc d_;
+};
+
 inline bool has_key(const std::string& json, const std::string& key) {
-    Doc d = parse(json);
-    if (!d) return false;
-    if (!json_object_is_type(d.root, json_type_object)) return false;
-    json_object* v = nullptr;
-    return json_object_object_get_ex(d.root, key.c_str(), &v);
+    return Cursor(json).has_key(key);
 }
 
 inline std::optional<std::string> get_string(const std::string& json, const std::string& key) {
-    Doc d = parse(json);
-    if (!d) return std::nullopt;
-    if (!json_object_is_type(d.root, json_type_object)) return std::nullopt;
-    json_object* v = nullptr;
-    if (!json_object_object_get_ex(d.root, key.c_str(), &v)) return std::nullopt;
-    if (!json_object_is_type(v, json_type_string)) return std::nullopt;
-    return std::string(json_object_get_string(v));
+    return Cursor(json).get_string(key);
 }
 
 inline std::optional<int64_t> get_int(const std::string& json, const std::string& key) {
-    Doc d = parse(json);
-    if (!d) return std::nullopt;
-    if (!json_object_is_type(d.root, json_type_object)) return std::nullopt;
-    json_object* v = nullptr;
-    if (!json_object_object_get_ex(d.root, key.c_str(), &v)) return std::nullopt;
-    if (!json_object_is_type(v, json_type_int)) return std::nullopt;
-    return static_cast<int64_t>(json_object_get_int64(v));
+    return Cursor(json).get_int(key);
 }
 
 inline std::optional<double> get_double(const std::string& json, const std::string& key) {
-    Doc d = parse(json);
-    if (!d) return std::nullopt;
-    if (!json_object_is_type(d.root, json_type_object)) return std::nullopt;
-    json_object* v = nullptr;
-    if (!json_object_object_get_ex(d.root, key.c_str(), &v)) return std::nullopt;
-    if (!v) return std::nullopt;
-    if (!(json_object_is_type(v, json_type_double) || json_object_is_type(v, json_type_int))) return std::nullopt;
-    return json_object_get_double(v);
+    return Cursor(json).get_double(key);
 }
 
 inline std::optional<bool> get_bool(const std::string& json, const std::string& key) {
-    Doc d = parse(json);
-    if (!d) return std::nullopt;
-    if (!json_object_is_type(d.root, json_type_object)) return std::nullopt;
-    json_object* v = nullptr;
-    if (!json_object_object_get_ex(d.root, key.c_str(), &v)) return std::nullopt;
-    if (!json_object_is_type(v, json_type_boolean)) return std::nullopt;
-    return json_object_get_boolean(v) != 0;
+    return Cursor(json).get_bool(key);
 }
 
 inline std::vector<std::string> get_array_strings(const std::string& json, const std::string& key) {
-    std::vector<std::string> out;
-    Doc d = parse(json);
-    if (!d) return out;
-    if (!json_object_is_type(d.root, json_type_object)) return out;
-    json_object* arr = nullptr;
-    if (!json_object_object_get_ex(d.root, key.c_str(), &arr)) return out;
-    if (!json_object_is_type(arr, json_type_array)) return out;
-    const size_t n = json_object_array_length(arr);
-    out.reserve(n);
-    for (size_t i = 0; i < n; i++) {
-        json_object* el = json_object_array_get_idx(arr, static_cast<int>(i));
-        if (el && json_object_is_type(el, json_type_string)) {
-            out.emplace_back(json_object_get_string(el));
-        }
-    }
-    return out;
+    return Cursor(json).get_array_strings(key);
 }
 
 inline std::optional<std::string> get_object_raw(const std::string& json, const std::string& key) {
-    Doc d = parse(json);
-    if (!d) return std::nullopt;
-    if (!json_object_is_type(d.root, json_type_object)) return std::nullopt;
-    json_object* v = nullptr;
-    if (!json_object_object_get_ex(d.root, key.c_str(), &v)) return std::nullopt;
-    if (!v) return std::nullopt;
-    return std::string(json_object_to_json_string_ext(v, JSON_C_TO_STRING_PLAIN));
+    return Cursor(json).get_object_raw(key);
 }
 
 inline std::optional<std::string> get_array_raw(const std::string& json, const std::string& key) {
-    Doc d = parse(json);
-    if (!d) return std::nullopt;
-    if (!json_object_is_type(d.root, json_type_object)) return std::nullopt;
-    json_object* v = nullptr;
-    if (!json_object_object_get_ex(d.root, key.c_str(), &v)) return std::nullopt;
-    if (!json_object_is_type(v, json_type_array)) return std::nullopt;
-    return std::string(json_object_to_json_string_ext(v, JSON_C_TO_STRING_PLAIN));
+    return Cursor(json).get_array_raw(key);
 }
 
 inline std::vector<std::string> parse_array_objects_raw(const std::string& array_json_raw) {
@@ -177,30 +243,42 @@ inline std::vector<double> parse_array_numbers(const std::string& array_json_raw
     return out;
 }
 
-// Escape a string for embedding inside a JSON string literal (no surrounding quotes).
-inline std::string json_escape(const std::string& s) {
-    std::ostringstream oss;
-    for (char c : s) {
+// Append s escaped for a JSON string literal onto out (no surrounding quotes).
+// Clean runs (no '"', '\\', no control bytes) are located with the SIMD
+// scanner from str_simd and appended in bulk; the common all-clean case is
+// a single scan plus one copy.
+inline void json_escape_append(std::string& out, const char* s, size_t n) {
+    size_t i = 0;
+    while (i < n) {
+        size_t run = machina::str::json_escape_scan(s + i, n - i);
+        out.append(s + i, run);
+        i += run;
+        if (i >= n) break;
+        const char c = s[i++];
         switch (c) {
-            case '\\': oss << "\\\\"; break;
-            case '"':  oss << "\\\""; break;
-            case '\b': oss << "\\b"; break;
-            case '\f': oss << "\\f"; break;
-            case '\n': oss << "\\n"; break;
-            case '\r': oss << "\\r"; break;
-            case '\t': oss << "\\t"; break;
-            default:
-                if (static_cast<unsigned char>(c) < 0x20) {
-                    char buf[8];
-                    std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)(unsigned char)c);
-                    oss << buf;
-                } else {
-                    oss << c;
-                }
+            case '\\': out += "\\\\"; break;
+            case '"':  out += "\\\""; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)(unsigned char)c);
+                out += buf;
                 break;
+            }
         }
     }
-    return oss.str();
+}
+
+// Escape a string for embedding inside a JSON string literal (no surrounding quotes).
+inline std::string json_escape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    json_escape_append(out, s.data(), s.size());
+    return out;
 }
 
 } // namespace machina::json_mini
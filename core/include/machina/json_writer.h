@@ -0,0 +1,152 @@
+#pragma once
+
+// JsonWriter: append-only JSON document builder.
+//
+// Replaces the ostringstream pattern for response building: everything goes
+// into one flat std::string (reserved up front, grown geometrically),
+// numbers are formatted with std::to_chars instead of iostream locale
+// machinery, and strings are escaped on write via the SIMD scanner shared
+// with json_mini::json_escape. Structure is tracked with a small depth
+// stack so commas between siblings are emitted automatically.
+//
+// Usage:
+//     JsonWriter w;
+//     w.begin_object();
+//     w.kv("ok", true);
+//     w.key("hits").begin_array();
+//     ... w.begin_object(); w.kv("i", idx); w.kv("score", s); w.end_object();
+//     w.end_array();
+//     w.end_object();
+//     std::string body = w.take();
+//
+// Notes:
+//   - Doubles use shortest round-trip formatting (to_chars); kv_fixed gives
+//     fixed decimal places where the wire format is pinned. Non-finite
+//     values serialize as null (JSON has no inf/nan).
+//   - raw() splices pre-serialized JSON verbatim; the caller vouches for it.
+//   - The writer does not validate call order beyond the comma bookkeeping;
+//     it is a serializer, not a schema checker.
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "machina/json_mini.h"
+
+namespace machina {
+
+class JsonWriter {
+public:
+    explicit JsonWriter(size_t reserve_bytes = 256) { buf_.reserve(reserve_bytes); }
+
+    JsonWriter& begin_object() { open('{'); return *this; }
+    JsonWriter& end_object() { close('}'); return *this; }
+    JsonWriter& begin_array() { open('['); return *this; }
+    JsonWriter& end_array() { close(']'); return *this; }
+
+    // Object key; the following value/begin_* call supplies its value.
+    JsonWriter& key(std::string_view k) {
+        comma();
+        append_quoted(k);
+        buf_ += ':';
+        after_key_ = true;
+        return *this;
+    }
+
+    JsonWriter& value(std::string_view v) { comma(); append_quoted(v); return *this; }
+    JsonWriter& value(const char* v) { return value(std::string_view(v)); }
+    JsonWriter& value(const std::string& v) { return value(std::string_view(v)); }
+
+    JsonWriter& value(bool v) { comma(); buf_ += v ? "true" : "false"; return *this; }
+
+    // One template covers every integer width/signedness; to_chars does the
+    // formatting. bool is excluded so it keeps its true/false overload.
+    template <typename T,
+              std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    JsonWriter& value(T v) { comma(); append_number(v); return *this; }
+
+    JsonWriter& value(double v) {
+        comma();
+        if (!std::isfinite(v)) { buf_ += "null"; return *this; }
+        append_number(v);
+        return *this;
+    }
+    // float goes through to_chars directly so the shortest representation
+    // is computed at float precision (<= 9 digits), not the double widening.
+    JsonWriter& value(float v) {
+        comma();
+        if (!std::isfinite(v)) { buf_ += "null"; return *this; }
+        append_number(v);
+        return *this;
+    }
+
+    // Fixed decimal places, matching "fixed << setprecision(p)" output.
+    JsonWriter& value_fixed(double v, int precision) {
+        comma();
+        if (!std::isfinite(v)) { buf_ += "null"; return *this; }
+        char tmp[64];
+        auto res = std::to_chars(tmp, tmp + sizeof(tmp), v, std::chars_format::fixed, precision);
+        buf_.append(tmp, res.ptr);
+        return *this;
+    }
+
+    JsonWriter& null() { comma(); buf_ += "null"; return *this; }
+
+    // Splice pre-serialized JSON (an object/array raw, a canonical line, ...).
+    JsonWriter& raw(std::string_view json) { comma(); buf_.append(json); return *this; }
+
+    // key + value in one call; the common shape in tool responses.
+    template <typename T>
+    JsonWriter& kv(std::string_view k, const T& v) { return key(k).value(v); }
+    JsonWriter& kv_fixed(std::string_view k, double v, int precision) {
+        return key(k).value_fixed(v, precision);
+    }
+    JsonWriter& kv_raw(std::string_view k, std::string_view json) { return key(k).raw(json); }
+
+    const std::string& str() const { return buf_; }
+    std::string take() { return std::move(buf_); }
+    size_t size() const { return buf_.size(); }
+
+private:
+    void open(char c) {
+        comma();
+        buf_ += c;
+        first_.push_back(true);
+    }
+    void close(char c) {
+        if (!first_.empty()) first_.pop_back();
+        buf_ += c;
+    }
+    // Emit the separating comma before a sibling; a value right after key()
+    // or the first element of a container takes none.
+    void comma() {
+        if (after_key_) { after_key_ = false; return; }
+        if (first_.empty()) return;
+        if (first_.back()) {
+            first_.back() = false;
+        } else {
+            buf_ += ',';
+        }
+    }
+    void append_quoted(std::string_view s) {
+        buf_ += '"';
+        json_mini::json_escape_append(buf_, s.data(), s.size());
+        buf_ += '"';
+    }
+    template <typename T>
+    void append_number(T v) {
+        char tmp[32];
+        auto res = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        buf_.append(tmp, res.ptr);
+    }
+
+    std::string buf_;
+    std::vector<bool> first_;
+    bool after_key_ = false;
+};
+
+} // namespace machina
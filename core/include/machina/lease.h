@@ -12,7 +12,10 @@
 // Flow: LLM requests tier-N tool → runner checks lease → if valid, execute + consume
 //       If no lease → reject with "lease_required" status
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -42,8 +45,13 @@ enum class ToolTier : int {
 ToolTier classify_tool_tier(const std::string& aid,
                             const std::vector<std::string>& side_effects);
 
+class HmacKey;
+
 class LeaseManager {
 public:
+    LeaseManager();
+    ~LeaseManager();
+
     // Issue a new lease for a specific tool or tier.
     // ttl_ms: how long the lease is valid (default 60s, max 300s).
     // Returns the token. The caller is responsible for WAL-logging.
@@ -52,9 +60,24 @@ public:
                            int64_t ttl_ms = 60000,
                            const std::string& issuer = "operator");
 
+    // Stateless variant: the token carries (tool_aid, tier, expiry, nonce)
+    // plus an HMAC over them, so verification recomputes the signature
+    // instead of looking up issuance state. Nothing is written to the
+    // shard maps — only a small spent-nonce filter enforces single use —
+    // which lets issuing and consuming happen in different threads or
+    // toolhost processes that share nothing but the signing secret
+    // (MACHINA_LEASE_SECRET; falls back to a per-process random secret,
+    // which confines tokens to this process). Not counted by
+    // active_count, since there is no table entry to count.
+    LeaseToken issue_lease_stateless(const std::string& tool_aid,
+                                     int tier,
+                                     int64_t ttl_ms = 60000,
+                                     const std::string& issuer = "operator");
+
     // Verify and consume a lease. Returns true if valid.
     // On success, the lease is marked consumed (single-use).
     // On failure, reason is set.
+    // Accepts both map-backed tokens and stateless HMAC tokens.
     bool verify_and_consume(const std::string& token_id,
                             const std::string& tool_aid,
                             std::string* reason = nullptr);
@@ -63,21 +86,47 @@ public:
     bool requires_lease(const std::string& aid,
                         const std::vector<std::string>& side_effects) const;
 
-    // Garbage-collect expired leases.
+    // Garbage-collect expired leases. Sweeps shard by shard under the
+    // per-shard lock, so concurrent issue/verify on other shards proceed.
+    // Shards also self-sweep opportunistically during issue_lease, so
+    // calling this is optional housekeeping rather than a requirement.
     void gc();
 
-    // Stats
-    size_t active_count() const;
-    size_t total_issued() const { return total_issued_; }
-    size_t total_consumed() const { return total_consumed_; }
-    size_t total_rejected() const { return total_rejected_; }
+    // Stats. active_count is the number of unconsumed leases still in the
+    // table — O(1), no lock; expired leases drop out when a verify or a
+    // sweep touches them.
+    size_t active_count() const { return active_count_.load(std::memory_order_relaxed); }
+    size_t total_issued() const { return total_issued_.load(std::memory_order_relaxed); }
+    size_t total_consumed() const { return total_consumed_.load(std::memory_order_relaxed); }
+    size_t total_rejected() const { return total_rejected_.load(std::memory_order_relaxed); }
 
 private:
-    mutable std::mutex mu_;
-    std::unordered_map<std::string, LeaseToken> leases_;
-    size_t total_issued_{0};
-    size_t total_consumed_{0};
-    size_t total_rejected_{0};
+    // Token-id-hash sharded table: parallel executors doing
+    // issue_lease/verify_and_consume for independent tools only contend
+    // when their tokens land on the same shard.
+    static constexpr size_t kShards = 16;
+    struct Shard {
+        std::mutex mu;
+        std::unordered_map<std::string, LeaseToken> leases;
+        // Consumed stateless nonces -> token expiry; replay protection.
+        // Entries purge themselves at expiry during sweeps.
+        std::unordered_map<std::string, int64_t> spent_nonces;
+        int64_t last_gc_ms{0};
+    };
+
+    Shard& shard_for(const std::string& token_id) const;
+    // Erase expired/consumed leases in one shard. Caller holds sh.mu.
+    void sweep_locked(Shard& sh, int64_t now);
+    bool verify_stateless(const std::string& token_id,
+                          const std::string& tool_aid,
+                          std::string* reason);
+
+    mutable std::array<Shard, kShards> shards_;
+    std::unique_ptr<HmacKey> stateless_key_;  // precomputed signing schedule
+    std::atomic<size_t> active_count_{0};
+    std::atomic<size_t> total_issued_{0};
+    std::atomic<size_t> total_consumed_{0};
+    std::atomic<size_t> total_rejected_{0};
 };
 
 } // namespace machina
@@ -1,21 +1,91 @@
 #pragma once
 #include "types.h"
-#include <string>
+#include <condition_variable>
+#include <cstdint>
 #include <fstream>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace machina {
 
+// Typed field for JsonlLogger::step_event. Named factories avoid the
+// const char* -> bool conversion trap a constructor overload set would
+// have. Views must outlive the step_event call that consumes them
+// (building fields inline in the call expression is always safe).
+struct LogField {
+    enum class Kind { Str, Int, Dbl, Bool, Raw };
+    std::string_view key;
+    Kind kind{Kind::Str};
+    std::string_view sv;
+    int64_t i{0};
+    double d{0};
+    bool b{false};
+
+    static LogField str(std::string_view k, std::string_view v) { return {k, Kind::Str, v, 0, 0, false}; }
+    static LogField i64(std::string_view k, int64_t v) { return {k, Kind::Int, {}, v, 0, false}; }
+    static LogField f64(std::string_view k, double v) { return {k, Kind::Dbl, {}, 0, v, false}; }
+    static LogField boolean(std::string_view k, bool v) { return {k, Kind::Bool, {}, 0, 0, v}; }
+    // Pre-serialized JSON spliced verbatim (object/array raws, tx patches).
+    static LogField raw(std::string_view k, std::string_view v) { return {k, Kind::Raw, v, 0, 0, false}; }
+};
+
 class JsonlLogger {
 public:
     JsonlLogger(const RunHeader& hdr, const std::string& path);
-    void event(int step, const std::string& name, const std::string& payload_json);
+    // Appends one hash-chained event line. payload_json is canonicalized
+    // (parsed, keys sorted) before hashing; pass payload_is_canonical=true
+    // when the payload was built with sorted keys and json_escape-compatible
+    // string escaping (e.g. via JsonWriter) to skip that parse entirely.
+    void event(int step, const std::string& name, const std::string& payload_json,
+               bool payload_is_canonical = false);
+    // Typed event: serializes the payload canonically in one pass (fields
+    // sorted by key, escape-on-write) with no string build + reparse round
+    // trip. Raw fields are spliced verbatim, so canonical key ordering holds
+    // up to their contents; the written line is the hash chain's source of
+    // truth either way.
+    void step_event(int step, const std::string& name, std::initializer_list<LogField> fields);
+    // Blocks until every enqueued line has reached the file. The destructor
+    // drains implicitly; call this only when the file is read back while the
+    // logger is still alive.
+    void flush();
     const std::string& path() const { return path_; }
+    ~JsonlLogger();
 
 private:
+    void writer_loop();
+
     RunHeader hdr_;
     std::string path_;
     std::ofstream out_;
+    // Sidecar index ("<path>.idx"): one "event step offset len" row per
+    // log line, appended as we log, so event-filtered consumers (queue
+    // metrics, pulse probes) seek instead of scanning (see runlog_index.h).
+    std::ofstream idx_out_;
+    long long offset_{0};
     std::string chain_prev_;
+    // Memoized canonicalization: many payloads repeat verbatim across steps
+    // ("{}", fixed breaker reasons, ...); reuse their canonical form instead
+    // of re-parsing. Cleared wholesale when it outgrows its cap.
+    struct CanonEntry { std::string text; bool is_json; };
+    std::unordered_map<std::string, CanonEntry> canon_cache_;
+    // Async writer lane: event() serializes and chains the line on the
+    // caller's thread (so ordering and the hash chain are untouched), then
+    // hands {line, idx row} to a writer thread for the actual appends. The
+    // caller — typically the run loop about to block on a tool subprocess —
+    // never waits on disk, and the step's events persist while the tool runs.
+    std::thread writer_;
+    std::mutex q_mu_;
+    std::condition_variable q_cv_;
+    std::condition_variable drain_cv_;
+    std::vector<std::pair<std::string, std::string>> q_;
+    bool q_busy_{false};
+    bool stop_{false};
 };
 
 } // namespace machina
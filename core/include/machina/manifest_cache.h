@@ -0,0 +1,38 @@
+#pragma once
+#include "cts.h"
+#include "goal_registry.h"
+#include "registry.h"
+
+#include <string>
+#include <vector>
+
+namespace machina::manifest_cache {
+
+// Binary cache for parsed manifest artifacts, keyed by manifest content
+// hash. First startup parses JSON (and runs CTS) as before and writes a
+// compact blob under MACHINA_ROOT/work/manifest_cache/; later startups
+// match the content hash and deserialize straight into descriptors,
+// skipping json_mini entirely. Serve deploys reload dozens of manifests
+// on restart, and the repeated parse was pure cold-start cost.
+// Format: "MMFC" v1, kind byte, the full key (to rule out filename hash
+// collisions), then length-prefixed records. Blobs are only written
+// after a successful parse, so a hit is as validated as a fresh parse.
+// MACHINA_MANIFEST_CACHE=0 disables both reads and writes.
+
+bool enabled();
+
+// Cache key for a manifest's raw bytes (sha256 hex).
+std::string content_key(const std::string& manifest_json);
+
+bool load_tooldescs(const std::string& key, std::vector<ToolDesc>* out);
+void save_tooldescs(const std::string& key, const std::vector<ToolDesc>& v);
+
+bool load_goaldescs(const std::string& key, std::vector<GoalDesc>* out);
+void save_goaldescs(const std::string& key, const std::vector<GoalDesc>& v);
+
+// CTS issue lists, one namespace per manifest kind ("tp" / "gp") so a
+// toolpack and goalpack with identical bytes cannot cross-hit.
+bool load_issues(const std::string& kind, const std::string& key, std::vector<CtsIssue>* out);
+void save_issues(const std::string& kind, const std::string& key, const std::vector<CtsIssue>& v);
+
+} // namespace machina::manifest_cache
@@ -0,0 +1,80 @@
+#pragma once
+
+// Async batched webhook notification dispatcher.
+//
+// Run-event notifications must never add latency to job execution: a slow
+// or wedged endpoint stalls delivery, not the worker. publish() copies the
+// event into a bounded in-memory queue and returns; a dedicated sender
+// thread drains it in batches and delivers one HTTP POST per destination
+// per batch (a JSON array of the batched events), so a burst of step
+// events rides one connection instead of one request each. Under
+// backpressure the oldest pending events are dropped and counted rather
+// than blocking the publisher.
+//
+// Destinations come from MACHINA_NOTIFY_WEBHOOKS (comma-separated).
+// http(s):// URLs are delivered through the same sandboxed curl child the
+// HTTP tools use; file:// paths append one batch per line to a local file
+// (cheap audit sink, and what the tests point at). Knobs:
+//   MACHINA_NOTIFY_RING        pending-event capacity (default 1024)
+//   MACHINA_NOTIFY_BATCH       max events per delivery (default 64)
+//   MACHINA_NOTIFY_TIMEOUT_MS  per-delivery budget (default 3000)
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace machina {
+
+class NotifyDispatcher {
+public:
+    NotifyDispatcher() = default;
+    explicit NotifyDispatcher(std::vector<std::string> urls);
+    ~NotifyDispatcher();
+
+    NotifyDispatcher(const NotifyDispatcher&) = delete;
+    NotifyDispatcher& operator=(const NotifyDispatcher&) = delete;
+
+    // Parses MACHINA_NOTIFY_WEBHOOKS; empty when unset.
+    static std::vector<std::string> urls_from_env();
+
+    bool enabled() const { return !urls_.empty(); }
+
+    // Non-blocking. event_json must be a complete JSON object; it is
+    // dropped silently when the dispatcher is disabled.
+    void publish(std::string event_json);
+
+    // Waits until everything published so far has been handed to delivery
+    // (or the deadline passes). Delivery itself is still best-effort.
+    void flush(int timeout_ms = 2000);
+
+    uint64_t dropped() const;
+    uint64_t sent_batches() const;
+    uint64_t failed_batches() const;
+
+private:
+    void sender_loop();
+    bool deliver(const std::string& url, const std::string& body_json);
+
+    std::vector<std::string> urls_;
+    size_t ring_cap_{1024};
+    size_t batch_max_{64};
+    int timeout_ms_{3000};
+
+    std::thread sender_;
+    mutable std::mutex mu_;
+    std::condition_variable cv_;
+    std::condition_variable drain_cv_;
+    std::deque<std::string> q_;
+    bool busy_{false};
+    bool stop_{false};
+
+    uint64_t dropped_{0};
+    uint64_t sent_batches_{0};
+    uint64_t failed_batches_{0};
+};
+
+} // namespace machina
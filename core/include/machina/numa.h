@@ -0,0 +1,44 @@
+#pragma once
+
+// NUMA placement helpers for the worker pool and large mappings (Linux
+// only, raw syscalls — no libnuma dependency).
+//
+// On dual-socket serve boxes a vecdb scan touching remote-node pages runs
+// at roughly 60% of local throughput, so placement matters for the shared
+// pool and for big shared regions (embeddings.f32 maps, WAL segments).
+// Topology comes from /sys/devices/system/node; memory policy goes through
+// the mbind/get_mempolicy syscalls directly.
+//
+// Opt-in via MACHINA_NUMA=1 on hosts with more than one online node —
+// single-node boxes and non-Linux builds report numa_enabled() == false
+// and every helper degrades to a no-op. All calls are best-effort: a
+// failed pin or bind never fails the caller's operation.
+
+#include <cstddef>
+
+namespace machina {
+
+// Number of online NUMA nodes; 1 when topology is unreadable.
+int numa_node_count();
+
+// True when MACHINA_NUMA=1 and more than one node is online.
+bool numa_enabled();
+
+// Pins the calling thread to the CPUs of `node` (modulo the online node
+// count). Heap the thread touches afterwards lands node-locally via
+// first-touch, which is what makes per-worker arenas node-local.
+bool numa_pin_thread(int node);
+
+// Interleaves the pages of [addr, addr+len) across all online nodes and
+// asks the kernel to move already-faulted pages. For large shared maps
+// scanned from every node this trades best-case local latency for a
+// uniform average instead of a 1.6x local/remote split.
+bool numa_interleave_memory(void* addr, size_t len);
+
+// Binds [addr, addr+len) to prefer allocation on `node`.
+bool numa_bind_memory(void* addr, size_t len, int node);
+
+// Node currently holding the page under `addr`, or -1 when unknown.
+int numa_node_of(const void* addr);
+
+} // namespace machina
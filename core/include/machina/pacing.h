@@ -0,0 +1,66 @@
+#pragma once
+
+// Adaptive budget pacing for runner loops.
+//
+// Budget limits used to act only as hard cutoffs: every step ran at full
+// cost until max_steps (or the wall clock) hit, so runs near the edge did
+// expensive work and then died mid-goal — wasted work plus a queue retry.
+// The pacer tracks spend as the run progresses and, once pressure builds,
+// tightens what later steps are allowed to cost: subprocess timeouts get
+// capped to a share of the remaining wall clock and scan-style tools get a
+// k_scale hint (via the _system_budget input key) to shrink candidate and
+// top-k counts. Runs degrade to cheaper steps instead of failing.
+//
+// Pressure is the larger of steps-used and time-used fractions, nudged by
+// an EMA of recent step cost so one slow step raises pressure before the
+// clock actually runs out. Below kPressureFloor nothing is touched.
+
+#include "machina/types.h"
+
+#include <cstdint>
+#include <string>
+
+namespace machina {
+
+class BudgetPacer {
+public:
+    // Pacing engages above this pressure; below it every knob is identity.
+    static constexpr double kPressureFloor = 0.5;
+    // Subprocess timeouts are never squeezed below this.
+    static constexpr int kMinTimeoutMs = 250;
+    // k_scale bottoms out here at pressure 1.0.
+    static constexpr double kMinKScale = 0.25;
+
+    // Starts the wall clock. budget.max_ms == 0 means no time budget.
+    explicit BudgetPacer(const Budget& budget);
+
+    // Records one completed step's wall cost.
+    void note_step(int dur_ms);
+
+    // True once the wall-clock budget is spent (never true without one).
+    bool exhausted() const;
+
+    // 0 with plenty of budget left, approaching 1 as steps or time run out.
+    double pressure() const;
+
+    // Cap for subprocess timeouts, in ms; 0 means "leave the default".
+    // Under pressure this is half the remaining wall clock, floored.
+    int timeout_cap_ms() const;
+
+    // Multiplier for candidate_k/top_k style parameters in [kMinKScale, 1].
+    double k_scale() const;
+
+    // Compact JSON snapshot for logging and _system_budget injection:
+    // {"pressure":..,"k_scale":..,"remaining_ms":..,"remaining_steps":..}
+    std::string hints_json() const;
+
+private:
+    int64_t elapsed_ms() const;
+
+    Budget budget_;
+    int64_t start_ms_{0};
+    int steps_used_{0};
+    double ema_step_ms_{0.0};
+};
+
+} // namespace machina
@@ -0,0 +1,47 @@
+#pragma once
+
+// Cached path-policy checks.
+//
+// Every sandboxed file operation funnels through a containment check
+// (weakly_canonical on both the candidate and the policy root), and
+// file-heavy goals issue thousands of them per run — each canonicalization
+// costing one stat per path component. The helpers here keep the syscalls
+// off the hot path: policy roots are canonicalized once per process, and
+// candidate paths reuse a canonical form of their parent directory cached
+// by (parent, parent mtime) — a renamed, added, or removed entry bumps the
+// parent's mtime and invalidates the entry. A retargeted symlink further up
+// the tree does not touch the parent's mtime, so such changes can be served
+// stale until the parent next changes; symlink leaves are always resolved
+// fresh, so a planted link can never widen containment.
+
+#include <filesystem>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace machina {
+
+// weakly_canonical with the parent-directory cache described above.
+// Falls back to the full resolution for cache misses, symlink leaves, and
+// parentless paths. Returns an empty path when resolution fails.
+std::filesystem::path path_canon_cached(const std::filesystem::path& p);
+
+// True when p resolves to root or below it. root is canonicalized once and
+// remembered; p goes through path_canon_cached. Any resolution failure is
+// treated as "not contained".
+bool path_is_under(const std::filesystem::path& p, const std::filesystem::path& root);
+
+// Basename allowlist compiled to a hash set at construction; lookups are
+// case-insensitive (entries and probes are lowered).
+class BasenameAllowlist {
+public:
+    BasenameAllowlist() = default;
+    explicit BasenameAllowlist(const std::vector<std::string>& names);
+    bool contains(const std::string& basename) const;
+    bool empty() const { return set_.empty(); }
+
+private:
+    std::unordered_set<std::string> set_;
+};
+
+} // namespace machina
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -7,6 +9,7 @@
 #include <filesystem>
 
 #include "machina/plugin_api.h"
+#include "machina/toolhost_client.h"
 
 namespace machina {
 
@@ -31,6 +34,13 @@ public:
     bool is_loaded(const std::filesystem::path& path) const;
     size_t loaded_count() const { return handles_.size(); }
 
+    // Warm the page cache for every shared object in dir on the shared
+    // worker pool (mmap + touch one byte per page). Fire-and-forget: by
+    // the time load_plugin() hashes and dlopens them, the file pages are
+    // resident and the first-call relocation cost shrinks to CPU work.
+    // No-op for missing directories.
+    void prefault_dir_async(const std::filesystem::path& dir);
+
     // Set expected SHA256 hash for a plugin path (optional).
     // If set, load_plugin() verifies before dlopen.
     void set_expected_hash(const std::string& canonical_path, const std::string& sha256_hex);
@@ -41,6 +51,12 @@ public:
     void set_allowed_capabilities(uint32_t cap_mask) { allowed_caps_ = cap_mask; }
     uint32_t allowed_capabilities() const { return allowed_caps_; }
 
+    // Out-of-process mode counterpart to the dlopen handles above: one
+    // long-lived machina_toolhost --serve pool per plugin, keyed by the
+    // plugin's canonical path. Created on first request, reused across
+    // loads, and shut down (serve children killed) with the manager.
+    std::shared_ptr<ToolHostPool> serve_pool(const ToolHostConfig& cfg);
+
 private:
     struct Handle {
         std::string canonical;
@@ -49,8 +65,14 @@ private:
 
     std::vector<Handle> handles_;
     std::unordered_set<std::string> loaded_;
+    // Dir mtime at the last fully successful load_new_from_dir scan;
+    // unchanged dirs skip re-enumeration on the per-step rescan.
+    std::unordered_map<std::string, std::filesystem::file_time_type> dir_mtimes_;
     std::unordered_map<std::string, std::string> expected_hashes_;
     uint32_t allowed_caps_{0xFFFFFFFFu}; // default: CAP_ALL
+
+    std::mutex pools_mu_;
+    std::unordered_map<std::string, std::shared_ptr<ToolHostPool>> serve_pools_;
 };
 
 } // namespace machina
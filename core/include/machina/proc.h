@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 #include <optional>
@@ -21,6 +23,14 @@ struct ProcLimits {
     // seccomp-BPF syscall allowlist (Linux only, requires no_new_privs).
     // Opt-in: set to true or MACHINA_SECCOMP_ENABLE=1.
     bool enable_seccomp{false};
+
+    // cgroup v2 transient-group limits (Linux only, see cgroup.h).
+    // Opt-in: set to true or MACHINA_PROC_CGROUP=1. When the child is placed
+    // in a cgroup, memory.max replaces RLIMIT_AS — real memory accounting
+    // instead of address space, which false-positives on CUDA children.
+    bool enable_cgroup{false};
+    size_t cgroup_memory_max_mb{0}; // 0 = use rlimit_as_mb
+    int cgroup_cpu_max_pct{0};      // cpu.max as % of one CPU; 0 = unlimited
 };
 
 struct ProcResult {
@@ -47,6 +57,60 @@ bool proc_run_capture_sandboxed_stdin(const std::vector<std::string>& argv,
                                      ProcResult* res);
 
 
+// Run a process with streamed stdin/stdout: next_stdin_chunk is called
+// whenever the stdin pipe can accept more data (return false when exhausted;
+// its chunk is written and the pipe closed on false with a non-empty chunk
+// still pending is not supported — return the last chunk with true, then
+// false with nothing). Every stdout/stderr chunk is handed to on_stdout as it
+// arrives instead of being buffered, so neither side is bounded by
+// stdout_max_bytes (which is ignored here) or pipe capacity. Timeout and
+// rlimits behave as in the capture variants; res->output stays empty.
+// Returns true if the process started.
+bool proc_run_stream_sandboxed(const std::vector<std::string>& argv,
+                               const std::string& cwd,
+                               const std::function<bool(std::string*)>& next_stdin_chunk,
+                               const std::function<void(const char*, size_t)>& on_stdout,
+                               const ProcLimits& lim,
+                               ProcResult* res);
+
+// Handle for an in-flight async child; 0 is invalid. Each handle must be
+// consumed exactly once via proc_async_wait (or proc_async_poll returning
+// true) — the slot is reclaimed when the result is taken.
+using ProcAsyncHandle = uint64_t;
+
+// Spawn without blocking the caller: the child is registered with a
+// process-wide reactor thread that multiplexes every async child's stdout
+// pipe, stdin writes, and timeout kills over one poll loop, so N tools can
+// fan out concurrently without N blocked threads. Per-child semantics match
+// proc_run_capture_sandboxed_stdin (merged stdout+stderr, stdout_max_bytes
+// cap, rlimits, timeout, wrapper env). Returns 0 on spawn failure (err
+// filled when non-null).
+ProcAsyncHandle proc_spawn_async(const std::vector<std::string>& argv,
+                                 const std::string& cwd,
+                                 const ProcLimits& lim,
+                                 const std::string& stdin_data = std::string(),
+                                 std::string* err = nullptr);
+
+// Non-blocking check: true once the child finished (fills *res, consumes the
+// handle); false while it is still running or for unknown handles.
+bool proc_async_poll(ProcAsyncHandle h, ProcResult* res);
+
+// Block until the child finishes, fill *res and consume the handle.
+// Returns false only for unknown or already-consumed handles.
+bool proc_async_wait(ProcAsyncHandle h, ProcResult* res);
+
+#ifndef _WIN32
+// Apply lim's rlimits to the calling process (best-effort). Called by spawn
+// children between fork/clone and exec, and by zygote workers after they
+// receive their limits over the socket.
+void proc_apply_rlimits(const ProcLimits& lim);
+
+// Resolve an executable name against PATH like execvp would, but in the
+// caller — spawn children that must not allocate exec a pre-resolved path.
+// Names containing '/' are returned as-is; "" when nothing matches.
+std::string proc_resolve_exe_path(const std::string& name);
+#endif
+
 // Small helper: split a command string into argv tokens.
 // Supports basic quotes (single/double) and backslash escaping inside double quotes.
 // Returns empty vector on parse error.
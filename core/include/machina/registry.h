@@ -29,12 +29,32 @@ public:
     // If allow_override is false, duplicate AIDs throw.
     void registerToolDesc(const ToolDesc& d, bool allow_override=false);
 
+    // Drop a descriptor and its tag postings (manifest hot-reload removing
+    // a tool). No-op for unknown AIDs; bumps generation() when it removes.
+    void removeToolDesc(const AID& aid);
+
     const ToolDesc* getTool(const AID& aid) const;
     std::vector<ToolDesc> queryByTags(const std::vector<std::string>& tags) const;
     std::vector<ToolDesc> allToolDescs() const;
 
+    // Monotonic registration counter. Bumped on every registerToolDesc, so
+    // callers caching derived structures (menus) can detect staleness cheaply.
+    uint64_t generation() const { return generation_; }
+
 private:
     std::unordered_map<std::string, ToolDesc> tools_;
+    // Inverted index: tag -> sorted AIDs carrying it. Maintained by
+    // registerToolDesc so queryByTags unions postings instead of scanning
+    // every descriptor (menus are rebuilt per step; toolpacks run to
+    // hundreds of tools).
+    std::unordered_map<std::string, std::vector<std::string>> tag_index_;
+    uint64_t generation_{0};
 };
 
+// Parses a toolpack manifest into descriptors without touching any
+// registry (descriptors with an empty aid are dropped). Shares the
+// manifest_cache fast path with loadToolPackManifest; throws on missing
+// files or structurally invalid manifests.
+std::vector<ToolDesc> parse_toolpack_manifest(const std::string& manifest_path);
+
 } // namespace machina
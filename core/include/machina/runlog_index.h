@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace machina {
+namespace runlog_index {
+
+// Sidecar index for run JSONL logs ("<log>.idx"), written line-by-line by
+// JsonlLogger as it logs: one "event step offset len" row per log line
+// (event names are identifiers, never contain spaces). Consumers that
+// only want a few event types — queue metrics extraction, pulse/status
+// probes — seek straight to the matching lines instead of scanning the
+// whole multi-MB log. Logs written before the index existed simply have
+// no sidecar and callers fall back to a scan.
+
+struct Entry {
+    std::string event;
+    int step{0};
+    long long offset{0};
+    long long len{0};
+};
+
+// Sidecar path for a given log path.
+std::string index_path(const std::string& log_path);
+
+// Loads the sidecar. Returns false when it is absent, malformed, or
+// inconsistent with the log (an entry pointing past the end of the file —
+// e.g. a crash left the index ahead of the data it describes).
+bool load(const std::string& log_path, std::vector<Entry>* out);
+
+// Reads the raw log lines (without trailing newline) whose event is in
+// `events`, in log order, via seek + read. Returns false when there is no
+// usable index — the caller should fall back to a full scan. A true
+// return with an empty `lines` means the index is fine and the log simply
+// has no such events.
+bool read_event_lines(const std::string& log_path,
+                      const std::vector<std::string>& events,
+                      std::vector<std::string>* lines);
+
+} // namespace runlog_index
+} // namespace machina
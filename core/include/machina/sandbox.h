@@ -32,6 +32,15 @@ namespace machina {
 // On non-Linux platforms, returns success (no-op).
 std::string install_seccomp_filter();
 
+// Compile the BPF program into its process-lifetime static buffer without
+// installing it. The program depends only on the allowlist and the
+// MACHINA_SECCOMP_* profile env vars, so parents call this once before
+// forking and install_seccomp_filter in the child becomes a single prctl on
+// read-only memory — no allocation between fork and exec. Returns the
+// compile error ("" on success); install reports the same error later
+// either way.
+std::string seccomp_filter_precompile();
+
 // Check if seccomp is available on this system.
 bool seccomp_available();
 
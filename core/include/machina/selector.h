@@ -2,7 +2,7 @@
 #include "types.h"
 #include "ids.h"
 #include "proc.h"
-#include <atomic>
+#include "path_guard.h"
 #include <string>
 #include <memory>
 #include <filesystem>
@@ -27,6 +27,16 @@ public:
                              const std::string& state_digest,
                              ControlMode mode,
                              const std::string& inputs_json) = 0;
+
+    // Batched variant for autopilot-style fan-out: one Selection per goal
+    // digest against the same menu. The default loops over select();
+    // implementations may override to amortize cache lookups, embedding,
+    // and kernel launches across goals.
+    virtual std::vector<Selection> select_batch(const Menu& menu,
+                                                const std::vector<std::string>& goal_digests,
+                                                const std::string& state_digest,
+                                                ControlMode mode,
+                                                const std::string& inputs_json);
 };
 
 // Profile A default selector: deterministic heuristic / stub
@@ -50,6 +60,7 @@ public:
     ExternalProcessSelector(std::unique_ptr<ISelector> fallback,
                             std::filesystem::path repo_root,
                             std::string policy_cmd);
+    ~ExternalProcessSelector() override;
     Selection select(const Menu& menu,
                      const std::string& goal_digest,
                      const std::string& state_digest,
@@ -61,14 +72,21 @@ private:
     std::string policy_cmd_;
     std::vector<std::string> argv_;
     ProcLimits lim_;
-    std::vector<std::string> allowed_exec_basenames_;
+    BasenameAllowlist allowed_exec_basenames_;
     std::filesystem::path allowed_script_root_;
     bool allow_unsafe_{false};
-    // Ops hardening: circuit breaker for policy crashes/timeouts.
+    // Ops hardening: circuit breaker for policy crashes/timeouts. Counters
+    // live in the shared breaker table (machina/breaker.h) keyed by the
+    // policy command, so all instances and processes trip together.
     int policy_fail_threshold_{5};
     int64_t policy_cooldown_ms_{30000};
-    std::atomic<int> consecutive_policy_fail_{0};
-    std::atomic<int64_t> policy_disabled_until_ms_{0};
+    // Content-addressed menu payload: the menu array is written to a side
+    // file once per menu digest and the per-step payload carries only the
+    // small varying fields plus a menu_file pointer. MACHINA_POLICY_MENU_INLINE=1
+    // restores the legacy inline "menu" for drivers that predate the split.
+    bool menu_inline_{false};
+    std::string menu_cache_digest_;
+    std::filesystem::path menu_cache_path_;
 };
 Selection parse_selector_output(const std::string& s);
 
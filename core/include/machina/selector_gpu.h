@@ -4,6 +4,20 @@
 
 namespace machina {
 
+// Counters for the selector-side caches (centroid matrices and goal
+// embeddings), surfaced through the serve-mode /stats endpoint.
+struct SelectorCacheStats {
+    uint64_t centroid_hits{0};
+    uint64_t centroid_misses{0};
+    uint64_t centroid_evictions{0};
+    size_t centroid_entries{0};
+    uint64_t goal_hits{0};
+    uint64_t goal_misses{0};
+    uint64_t goal_evictions{0};
+    size_t goal_entries{0};
+};
+SelectorCacheStats selector_cache_stats();
+
 // Single-GPU centroid selector (MVP-ready):
 // - CPU fallback always available.
 // - If built with CUDA and MACHINA_USE_GPU=1, uses GPU for batched dot products (optional).
@@ -15,6 +29,14 @@ public:
                      ControlMode mode,
                      const std::string& inputs_json) override;
 
+    // Batched fan-out: embeds goal misses in one batch, then scores every
+    // goal against the cached centroid matrix (single kernel launch on CUDA).
+    std::vector<Selection> select_batch(const Menu& menu,
+                                        const std::vector<std::string>& goal_digests,
+                                        const std::string& state_digest,
+                                        ControlMode mode,
+                                        const std::string& inputs_json) override;
+
     // Human-readable backend used for the last selection (for logging).
     std::string last_backend() const { return last_backend_; }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "json_writer.h"
 #include "state.h"
 #include "types.h"
 
@@ -23,6 +24,14 @@ std::vector<std::string> json_get_string_array(json_object* o, const char* k);
 json_object* artifact_to_json(const Artifact& a);
 bool artifact_from_json(json_object* o, Artifact* out);
 
+// JsonWriter counterparts for the hot serialization paths: no json-c
+// tree is built or torn down, the record goes straight into the writer's
+// buffer. json-c stays in use for parsing (untrusted input) and for call
+// sites that need a live json_object to compose or apply.
+void artifact_write(JsonWriter& w, const Artifact& a);
+std::string dsstate_to_json_str(const DSState& ds);
+std::string dsstate_to_json_delta_str(const DSState& current, const DSState* base);
+
 // --- DSState serialization ---
 
 json_object* dsstate_to_json(const DSState& ds);
@@ -38,6 +47,13 @@ json_object* dsstate_to_json_delta(const DSState& current, const DSState* base);
 bool dsstate_apply_delta(json_object* delta, DSState* state);
 bool dsstate_apply_tx_patch(json_object* patch, DSState* state);
 
+// Batched patch application: validates every op across all patches first,
+// then mutates the state in one traversal. All-or-nothing — a malformed op
+// anywhere leaves the state untouched, unlike sequential single-patch
+// application which could stop halfway. Later patches win on slot
+// collisions, matching sequential apply order.
+bool dsstate_apply_tx_patches(const std::vector<json_object*>& patches, DSState* state);
+
 // --- StepStatus conversion ---
 
 StepStatus stepstatus_from_str(const std::string& s);
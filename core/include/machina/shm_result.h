@@ -0,0 +1,40 @@
+#pragma once
+
+// Shared-memory lane for large toolhost results.
+//
+// Out-of-process tool outputs travel as JSON strings over the NDJSON pipe:
+// the toolhost serializes output_json into the reply line and the parent
+// re-parses it, which for multi-MB genesis artifacts means two copies, a
+// json-c escape/unescape of the whole payload, and a collision with the
+// serve client's 1MB response-line cap. Payloads over a threshold are
+// instead written to a tmpfs segment (/dev/shm) and the reply carries only
+// {path, len, fnv} — the parent reads the segment back, verifies it, and
+// unlinks it. The pipe channel cannot carry fds (no SCM_RIGHTS on plain
+// pipes), so segments are addressed by name; tmpfs keeps them memory-only.
+//
+// Threshold via MACHINA_SHM_RESULT_MIN bytes (default 256KB, 0 disables).
+// Readers refuse paths outside the expected directory/prefix and anything
+// failing the length or checksum test, so a corrupt or foreign path can
+// never be silently absorbed as tool output.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace machina {
+
+// Spill threshold in bytes; 0 means the lane is disabled.
+size_t shm_result_threshold();
+
+// Writes payload to a fresh private segment and returns its path and
+// FNV-1a64 checksum. False (with *err) when the segment cannot be created;
+// callers then fall back to inline output_json.
+bool shm_result_write(const std::string& payload, std::string* path,
+                      uint64_t* fnv, std::string* err);
+
+// Reads a segment written by shm_result_write, verifying location, length,
+// and checksum, and unlinks it on success. False leaves *out untouched.
+bool shm_result_read(const std::string& path, size_t expect_len,
+                     uint64_t expect_fnv, std::string* out, std::string* err);
+
+} // namespace machina
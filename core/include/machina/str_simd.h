@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+
+namespace machina::str {
+
+// ---------- JSON escape scanning (runtime-dispatched SIMD) ----------
+// Returns the length of the longest prefix of s[0..n) containing no byte
+// that needs escaping inside a JSON string literal (i.e. no '"', '\\' or
+// control byte < 0x20). Callers copy that clean run in bulk, handle the
+// one offending byte, and rescan from there.
+// Picks AVX2 on x86 (via __builtin_cpu_supports, resolved once) with an
+// SSE2 fallback, or NEON on AArch64, with a scalar fallback elsewhere.
+// NOTE: Implementation lives in core/src/str_simd.cpp so the wide-register
+// kernels can be compiled with per-function target attributes.
+size_t json_escape_scan(const char* s, size_t n);
+
+} // namespace machina::str
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace machina {
+
+// Small fixed-size worker pool for embarrassingly parallel scans.
+//
+// One process-wide instance (shared()) is meant to be reused by every
+// caller instead of spinning up per-request threads; sized from
+// MACHINA_POOL_THREADS or hardware_concurrency. parallel_for blocks the
+// calling thread until all chunks are done and also runs chunks inline,
+// so it makes progress even when the pool is saturated.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    // Enqueues one task for the workers.
+    void submit(std::function<void()> fn);
+
+    // Splits [begin, end) into roughly pool-size chunks, runs
+    // fn(chunk_begin, chunk_end) across the workers and the calling
+    // thread, and returns when every chunk has finished.
+    void parallel_for(size_t begin, size_t end,
+                      const std::function<void(size_t, size_t)>& fn);
+
+    // Process-wide pool, created on first use.
+    static ThreadPool& shared();
+
+private:
+    void worker_loop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool stop_{false};
+};
+
+} // namespace machina
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace machina {
+
+// TimerWheel
+// - Bucketed timing wheel: schedule(due_ms, value), advance(now_ms) pops due entries
+// - O(1) schedule, advance cost proportional to elapsed ticks + entries that fire
+// - Far-future entries park in an overflow list and cascade in when they come
+//   within the wheel horizon (slots * tick_ms)
+// - NOT thread-safe: callers that share a wheel across threads hold their own
+//   mutex (they typically guard a dedup set with the same lock anyway)
+//
+// Intent: in-memory retry scheduling (daemon mode) without re-scanning the
+// retry set on every pass; durable state stays wherever the caller keeps it.
+
+template <typename T>
+class TimerWheel {
+public:
+    // `now_ms` anchors the wheel; entries due at or before it fire on the
+    // next advance(). Granularity is `tick_ms`: an entry may fire up to one
+    // tick late, never early relative to the tick grid.
+    explicit TimerWheel(int64_t now_ms, int64_t tick_ms = 256, size_t slots = 256)
+        : tick_ms_(tick_ms > 0 ? tick_ms : 1),
+          slots_(slots > 1 ? slots : 2),
+          cur_tick_(now_ms / (tick_ms > 0 ? tick_ms : 1)) {
+        wheel_.resize(slots_);
+    }
+
+    void schedule(int64_t due_ms, T value) {
+        int64_t tick = due_ms / tick_ms_;
+        size_++;
+        if (tick > cur_tick_ && (uint64_t)(tick - cur_tick_) >= (uint64_t)slots_) {
+            if (overflow_.empty() || due_ms < overflow_min_due_) overflow_min_due_ = due_ms;
+            overflow_.push_back(Entry{due_ms, std::move(value)});
+            return;
+        }
+        if (tick < cur_tick_) tick = cur_tick_;
+        wheel_[(size_t)(tick % (int64_t)slots_)].push_back(Entry{due_ms, std::move(value)});
+    }
+
+    // Moves every entry with due_ms <= now_ms into `out` (append, unsorted).
+    void advance(int64_t now_ms, std::vector<T>& out) {
+        int64_t target = now_ms / tick_ms_;
+        if (target < cur_tick_) target = cur_tick_;
+
+        // Cascade overflow entries that are now within the horizon.
+        if (!overflow_.empty() && overflow_min_due_ < (target + (int64_t)slots_) * tick_ms_) {
+            std::vector<Entry> keep;
+            int64_t new_min = 0;
+            bool have_min = false;
+            for (auto& e : overflow_) {
+                int64_t tick = e.due_ms / tick_ms_;
+                if (tick <= target || (uint64_t)(tick - target) < (uint64_t)slots_) {
+                    if (tick < cur_tick_) tick = cur_tick_;
+                    wheel_[(size_t)(tick % (int64_t)slots_)].push_back(std::move(e));
+                } else {
+                    if (!have_min || e.due_ms < new_min) { new_min = e.due_ms; have_min = true; }
+                    keep.push_back(std::move(e));
+                }
+            }
+            overflow_.swap(keep);
+            overflow_min_due_ = new_min;
+        }
+
+        // Sweep at most one full revolution: further ticks alias slots
+        // already visited, so a longer jump adds nothing.
+        int64_t steps = target - cur_tick_;
+        if (steps > (int64_t)slots_ - 1) steps = (int64_t)slots_ - 1;
+        for (int64_t t = cur_tick_; t <= cur_tick_ + steps; t++) {
+            auto& slot = wheel_[(size_t)(t % (int64_t)slots_)];
+            size_t w = 0;
+            for (size_t r = 0; r < slot.size(); r++) {
+                if (slot[r].due_ms <= now_ms) {
+                    out.push_back(std::move(slot[r].value));
+                    size_--;
+                } else {
+                    if (w != r) slot[w] = std::move(slot[r]);
+                    w++;
+                }
+            }
+            slot.resize(w);
+        }
+        cur_tick_ = target;
+    }
+
+    // Earliest due time at tick granularity, or -1 when empty. A hint for
+    // sleep computation: the true earliest entry is never later than this
+    // value plus one tick.
+    int64_t next_due_hint() const {
+        if (size_ == 0) return -1;
+        int64_t best = -1;
+        for (size_t i = 0; i < slots_; i++) {
+            int64_t t = cur_tick_ + (int64_t)i;
+            for (const auto& e : wheel_[(size_t)(t % (int64_t)slots_)]) {
+                if (best < 0 || e.due_ms < best) best = e.due_ms;
+            }
+            if (best >= 0 && best < (t + 1) * tick_ms_) return best;
+        }
+        if (!overflow_.empty() && (best < 0 || overflow_min_due_ < best)) best = overflow_min_due_;
+        return best;
+    }
+
+    // Visits every pending entry as (due_ms, value). Order is unspecified.
+    template <typename F>
+    void for_each(F&& f) const {
+        for (const auto& slot : wheel_)
+            for (const auto& e : slot) f(e.due_ms, e.value);
+        for (const auto& e : overflow_) f(e.due_ms, e.value);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    struct Entry {
+        int64_t due_ms{0};
+        T value;
+    };
+
+    int64_t tick_ms_;
+    size_t slots_;
+    int64_t cur_tick_;
+    size_t size_{0};
+    std::vector<std::vector<Entry>> wheel_;
+    std::vector<Entry> overflow_;
+    int64_t overflow_min_due_{0};
+};
+
+} // namespace machina
@@ -0,0 +1,46 @@
+#pragma once
+
+// Per-tool execution metrics.
+//
+// ToolRunner (and the toolhost serve loop) record one sample per execution:
+// per-AID call/error/timeout counters and a log2-scale latency histogram,
+// all relaxed atomics — a recorded call costs a handful of uncontended
+// increments, and with MACHINA_TOOL_METRICS=0 nothing is touched at all.
+// Snapshots come out of tool_metrics_json(), surfaced as the
+// AID.TOOL.METRICS.v1 query and the toolhost "_metrics" serve command,
+// so slow tools show up without grepping run logs for failures.
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace machina {
+
+// Bucket i counts latencies in [2^i, 2^(i+1)) microseconds; bucket 0 also
+// absorbs sub-microsecond calls, the last bucket everything >= ~2.3 hours.
+struct ToolMetricsEntry {
+    static constexpr int kBuckets = 24;
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> total_us{0};
+    std::atomic<uint64_t> max_us{0};
+    std::atomic<uint64_t> hist[kBuckets]{};
+};
+
+// True unless MACHINA_TOOL_METRICS=0 (checked once per process).
+bool tool_metrics_enabled();
+
+// Stable pointer for the AID's entry, created on first use and never freed;
+// nullptr when metrics are disabled so callers skip recording entirely.
+ToolMetricsEntry* tool_metrics_entry(const std::string& aid);
+
+// Record one execution. Safe from any thread; relaxed atomics throughout.
+void tool_metrics_record(ToolMetricsEntry* e, int64_t us, bool error, bool timeout);
+
+// JSON snapshot: per-AID counters, mean/max and approximate p50/p95 from the
+// histogram, plus process rusage (self and reaped children — the only child
+// rss/cpu the kernel exposes is that aggregate).
+std::string tool_metrics_json();
+
+} // namespace machina
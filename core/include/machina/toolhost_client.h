@@ -0,0 +1,112 @@
+#pragma once
+
+// Client side of the machina_toolhost --serve NDJSON protocol.
+//
+// ToolHostSession holds one long-lived serve child for a plugin and
+// multiplexes requests over its stdin/stdout; ToolHostPool keeps N sessions
+// per plugin behind exclusive leases so concurrent tool calls don't
+// interleave on one pipe. Callers restart a dead session via start() (capped
+// by fail_count) and fall back to fork-per-call --run mode when that fails.
+// Originally grew inside the genesis tool; hoisted here so PluginManager can
+// own the pools for out-of-process plugin mode.
+
+#include "machina/proc.h"
+#include "machina/state.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+  #include <sys/types.h>
+#endif
+
+namespace machina {
+
+struct ToolHostConfig {
+    std::string toolhost_bin;  // machina_toolhost executable
+    std::string plugin;        // plugin path handed to --serve / --run
+    ProcLimits limits;         // applied to the serve child (CPU limit skipped
+                               // — the process is long-lived); timeout_ms
+                               // bounds each send_receive
+    int pool_size{2};
+};
+
+// One persistent --serve child. Not internally synchronized — the pool's
+// Lease provides exclusive access.
+struct ToolHostSession {
+    ToolHostConfig cfg;
+#ifndef _WIN32
+    pid_t pid{-1};
+#else
+    long long pid{-1};
+#endif
+    int to_child{-1};    // write end: parent -> child stdin
+    int from_child{-1};  // read end:  child stdout -> parent
+    DSState base_ds;     // delta tracking base
+    int fail_count{0};
+
+    // (Re)start the serve child. Returns false on non-POSIX platforms or
+    // spawn failure.
+    bool start();
+
+    // Send one NDJSON request line, read one response line. Returns "" on
+    // error (dead child, timeout, oversized response) — callers shut the
+    // session down and fall back.
+    std::string send_receive(const std::string& request, int timeout_ms);
+
+    void shutdown();
+
+    ~ToolHostSession() { shutdown(); }
+    ToolHostSession() = default;
+    ToolHostSession(const ToolHostSession&) = delete;
+    ToolHostSession& operator=(const ToolHostSession&) = delete;
+};
+
+// Fixed-size session pool with lease-based exclusive access; acquire()
+// blocks until a session frees up.
+struct ToolHostPool {
+    struct Lease {
+        ToolHostPool* pool{nullptr};
+        int idx{-1};
+        ToolHostSession* session{nullptr};
+
+        Lease() = default;
+        Lease(ToolHostPool* p, int i, ToolHostSession* s) : pool(p), idx(i), session(s) {}
+        ~Lease() { if (pool && idx >= 0) pool->release(idx); }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease(Lease&& o) noexcept : pool(o.pool), idx(o.idx), session(o.session) {
+            o.pool = nullptr; o.idx = -1; o.session = nullptr;
+        }
+        Lease& operator=(Lease&& o) noexcept {
+            if (this != &o) {
+                if (pool && idx >= 0) pool->release(idx);
+                pool = o.pool; idx = o.idx; session = o.session;
+                o.pool = nullptr; o.idx = -1; o.session = nullptr;
+            }
+            return *this;
+        }
+    };
+
+    explicit ToolHostPool(const ToolHostConfig& cfg);
+
+    // Block until a session is available, then return exclusive lease.
+    Lease acquire();
+    void release(int idx);
+
+    ToolHostPool(const ToolHostPool&) = delete;
+    ToolHostPool& operator=(const ToolHostPool&) = delete;
+
+private:
+    int pool_size_;
+    std::vector<std::unique_ptr<ToolHostSession>> sessions_;
+    std::vector<bool> in_use_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+};
+
+} // namespace machina
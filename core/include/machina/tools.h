@@ -2,6 +2,7 @@
 #include "types.h"
 #include "state.h"
 #include <string>
+#include <cstdint>
 #include <unordered_map>
 #include <unordered_set>
 #include <functional>
@@ -12,8 +13,25 @@ struct ToolResult {
     StepStatus status{StepStatus::OK};
     std::string output_json; // for DS_TMP write or ViewSpec
     std::string error;
+
+    // Copy-audited: multi-MB outputs must move, not copy, between tool
+    // return and WAL/serve consumers. The copy constructor bumps a global
+    // counter (see tool_result_copy_count) so a regression that reintroduces
+    // a copy on the dispatch path shows up in tests instead of in perf.
+    ToolResult() = default;
+    ToolResult(StepStatus s, std::string out, std::string err)
+        : status(s), output_json(std::move(out)), error(std::move(err)) {}
+    ToolResult(const ToolResult& o);
+    ToolResult& operator=(const ToolResult& o);
+    ToolResult(ToolResult&&) = default;
+    ToolResult& operator=(ToolResult&&) = default;
 };
 
+// Process-wide count of ToolResult copy constructions/assignments. The
+// dispatch path (tool return -> runner -> consumers) is expected to hold
+// this flat; deliberate copies (idempotency cache, retries) do count.
+int64_t tool_result_copy_count();
+
 using ToolFn = std::function<ToolResult(const std::string& input_json, DSState& ds_tmp)>;
 
 class ToolRunner {
@@ -30,11 +48,16 @@ public:
 
     bool isIsolated(const AID& aid) const { return isolated_.count(aid) > 0; }
 
+    // Upper bound applied to subprocess timeouts (budget pacing); 0 clears
+    // it and restores the configured default.
+    void setTimeoutCapMs(int ms) { timeout_cap_ms_ = ms; }
+
 private:
     std::unordered_map<std::string, ToolFn> fns_;
 
     // Isolation routing state
     bool isolation_enabled_{false};
+    int timeout_cap_ms_{0};
     std::string toolhost_bin_;
     std::unordered_set<std::string> isolated_;
 
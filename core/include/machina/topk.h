@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace machina {
+
+// Bounded top-k selection over a stream of items.
+//
+// Keeps the k best items seen so far in a min-heap keyed by the Better
+// comparator (better(a, b) == true when a ranks ahead of b), so each offer
+// is O(log k) instead of the O(k) linear worst-scan it replaces. Typical
+// use: scoring loops in vectordb and memory_query that only ever surface
+// top_k <= 50 results out of very large candidate sets.
+template <typename T, typename Better = std::greater<T>>
+class TopK {
+public:
+    explicit TopK(size_t k, Better better = Better{})
+        : k_(k), better_(std::move(better)) {
+        heap_.reserve(k_);
+    }
+
+    // Offers one item; returns true if it was kept.
+    bool offer(T v) {
+        if (k_ == 0) return false;
+        if (heap_.size() < k_) {
+            heap_.push_back(std::move(v));
+            std::push_heap(heap_.begin(), heap_.end(), better_);
+            return true;
+        }
+        if (!better_(v, heap_.front())) return false;
+        std::pop_heap(heap_.begin(), heap_.end(), better_);
+        heap_.back() = std::move(v);
+        std::push_heap(heap_.begin(), heap_.end(), better_);
+        return true;
+    }
+
+    size_t size() const { return heap_.size(); }
+    bool full() const { return heap_.size() >= k_; }
+
+    // Worst item currently kept (only valid when size() > 0).
+    const T& worst() const { return heap_.front(); }
+
+    // Consumes the selection, best first.
+    std::vector<T> take_sorted() {
+        std::vector<T> out = std::move(heap_);
+        heap_.clear();
+        std::sort(out.begin(), out.end(), better_);
+        return out;
+    }
+
+private:
+    // Heaped with better_ directly, which makes heap_.front() the worst of
+    // the kept items (the eviction bar), like std::greater makes a min-heap.
+    size_t k_;
+    Better better_;
+    std::vector<T> heap_;
+};
+
+} // namespace machina
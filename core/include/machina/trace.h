@@ -0,0 +1,87 @@
+#pragma once
+
+// Lightweight tracing for the step execution hot path.
+//
+// MACHINA_TRACE_SPAN("stage") drops a scoped span that accumulates into a
+// per-stage log2 latency histogram (same shape as tool_metrics) and, when
+// Chrome emission is on, appends one complete event to a per-process
+// chrome://tracing file. Stages are the places every latency hunt starts:
+// menu build, selector select, lease issue, proc spawn, tool execution,
+// tx commit, WAL append — so the answer to "where does step time go" is a
+// trace_json() snapshot instead of printf archaeology.
+//
+// Config (all checked once per process):
+//   MACHINA_TRACE=1             enable span recording (default off; when
+//     off each span site costs a static-init guard and a null check)
+//   MACHINA_TRACE_CHROME=1      also write Chrome-trace JSON to
+//     MACHINA_ROOT/work/trace/chrome_<pid>.json
+//   MACHINA_TRACE_SAMPLE=N      Chrome emission for ~1-in-N processes
+//     (default 1 = every traced process; histograms are always recorded)
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace machina {
+
+// Bucket i counts span durations in [2^i, 2^(i+1)) microseconds, matching
+// ToolMetricsEntry so the two histograms read the same way.
+struct TraceStage {
+    static constexpr int kBuckets = 24;
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> total_us{0};
+    std::atomic<uint64_t> max_us{0};
+    std::atomic<uint64_t> hist[kBuckets]{};
+};
+
+// True only when MACHINA_TRACE=1 (checked once per process).
+bool trace_enabled();
+
+// Stable pointer for the stage's entry, created on first use and never
+// freed; nullptr when tracing is disabled so span sites record nothing.
+TraceStage* trace_stage(const std::string& name);
+
+// Record one span. Safe from any thread; relaxed atomics throughout.
+// Also appends the Chrome event when emission is on for this process.
+void trace_record(TraceStage* e, const char* name, int64_t start_us, int64_t dur_us);
+
+// Microseconds since the process trace epoch (first use).
+int64_t trace_now_us();
+
+// JSON snapshot: per-stage counters, mean/max and approximate p50/p95,
+// plus the Chrome file path when one is being written.
+std::string trace_json();
+
+// Scoped span. Constructed with the cached stage pointer (null when
+// tracing is off), so the disabled path is a branch on a null member.
+class TraceSpan {
+public:
+    TraceSpan(TraceStage* e, const char* name) : e_(e), name_(name) {
+        if (e_) start_us_ = trace_now_us();
+    }
+    ~TraceSpan() {
+        if (e_) trace_record(e_, name_, start_us_, trace_now_us() - start_us_);
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    TraceStage* e_;
+    const char* name_;
+    int64_t start_us_{0};
+};
+
+#define MACHINA_TRACE_CAT2(a, b) a##b
+#define MACHINA_TRACE_CAT(a, b) MACHINA_TRACE_CAT2(a, b)
+
+// Scoped span over the rest of the enclosing block. The stage lookup runs
+// once per site (function-local static); every later pass is guard check +
+// null test when tracing is off.
+#define MACHINA_TRACE_SPAN(name)                                               \
+    static ::machina::TraceStage* MACHINA_TRACE_CAT(trace_stage_, __LINE__) =  \
+        ::machina::trace_stage(name);                                          \
+    ::machina::TraceSpan MACHINA_TRACE_CAT(trace_span_, __LINE__)(             \
+        MACHINA_TRACE_CAT(trace_stage_, __LINE__), name)
+
+} // namespace machina
@@ -2,8 +2,18 @@
 #include "state.h"
 #include "types.h"
 
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace machina {
 
+struct StateSnapshot;
+
 // Transaction: DS -> DS_TMP -> commit/rollback
 // Thread-safety: Tx is NOT thread-safe. The caller must hold an exclusive lock
 // on the target DSState when calling commit(). Tx is non-copyable/non-movable
@@ -11,6 +21,9 @@ namespace machina {
 class Tx {
 public:
     explicit Tx(const DSState& base);
+    // Seeds DS_TMP from a StateCell snapshot: one artifact copy total
+    // (the same cost as Tx(const DSState&)), no intermediate DSState.
+    explicit Tx(const StateSnapshot& base);
 
     // Non-copyable, non-movable
     Tx(const Tx&) = delete;
@@ -19,20 +32,82 @@ public:
     Tx& operator=(Tx&&) = delete;
 
     DSState& tmp();           // DS_TMP
-    const DSState& base() const;
 
     // REQUIRES: caller must hold exclusive lock on target
+    // Moves DS_TMP into target; the Tx is inactive afterwards.
     void commit(DSState& target);
     void rollback();
 
     // RFC6902-like patch describing changes from base -> tmp (computed on commit)
     const std::string& patch_json() const { return patch_json_; }
 
+    // Slots whose content differs from the base snapshot (add, remove, or
+    // replace), by fingerprint comparison. Only valid while active; this
+    // is what StateCell::try_commit validates against per-slot versions.
+    std::vector<uint8_t> changed_slots() const;
+
 private:
-    DSState base_;
+    // Snapshot of the base state as per-slot content fingerprints rather
+    // than a second deep copy: the patch only ever emits artifacts from
+    // DS_TMP, so presence + fingerprint is all commit() needs from the
+    // base. Large artifacts (genesis source blobs) used to be memcpy'd
+    // twice per tool call here.
+    std::unordered_map<uint8_t, std::string> base_fps_;
     DSState tmp_;
     bool active_{true};
     std::string patch_json_{};
 };
 
+// Merges the patch arrays of several sequential transactions into one
+// patch describing their net effect, so a step that committed multiple
+// times (diag writes, compile-stage updates) logs a single tx_patch to
+// the WAL instead of one per commit. Ops collapse per slot to the last
+// one, which dsstate_apply_tx_patches replays identically. Returns "[]"
+// on no input, empty string if any patch fails to parse.
+std::string merge_tx_patches(const std::vector<std::string>& patches);
+
+// Snapshot of a StateCell: immutable per-slot artifacts plus the version
+// numbers they were published at. Taking one is a handful of refcount
+// bumps; the cell never mutates a published artifact, so a snapshot stays
+// stable while later commits land. materialize() builds a plain DSState
+// copy for callers that need one (digests, goal-completion checks).
+struct StateSnapshot {
+    std::array<std::shared_ptr<const Artifact>, 8> slots{};
+    std::array<uint64_t, 8> slot_versions{};
+    uint64_t version{0};
+
+    DSState materialize() const;
+};
+
+// Shared DSState with snapshot isolation for concurrent goal runs.
+// Each run takes a snapshot, builds a Tx against it, and commits through
+// try_commit(), which validates only the slots the Tx actually changed
+// against per-slot version counters: runs touching disjoint slots commit
+// in either order, while a run whose written slot moved underneath it
+// gets false back and re-snapshots before retrying. Commits serialize on
+// a short critical section; version numbers increase in commit order,
+// which is the order their patches reach the WAL. Unchanged slots are
+// shared between versions by refcount, never copied.
+class StateCell {
+public:
+    StateCell() = default;
+    explicit StateCell(DSState initial);
+
+    StateSnapshot snapshot() const;
+
+    // Commits tx (which must have been built from base) unless a slot the
+    // tx changed has been republished since base was taken. On success the
+    // tx is committed — patch_json() is available and ordered by the
+    // version written to out_version (when non-null).
+    bool try_commit(Tx& tx, const StateSnapshot& base, uint64_t* out_version = nullptr);
+
+    uint64_t version() const;
+
+private:
+    mutable std::mutex mu_;
+    std::array<std::shared_ptr<const Artifact>, 8> slots_{};
+    std::array<uint64_t, 8> slot_versions_{};
+    uint64_t version_{0};
+};
+
 } // namespace machina
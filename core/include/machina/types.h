@@ -35,6 +35,7 @@ struct RunHeader {
 struct Budget {
     int max_steps{64};
     int max_invalid_picks{8};
+    int max_ms{0}; // wall-clock budget for the whole run; 0 = unlimited
 };
 
 // A single step outcome
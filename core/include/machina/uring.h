@@ -0,0 +1,38 @@
+#pragma once
+
+// Minimal io_uring backend for the durability hot paths (raw syscalls, no
+// liburing dependency). On NVMe boxes small-record durability throughput is
+// bounded by syscall count, not device latency; a linked SQE chain lands
+// write+fsync (WAL group commits) or write+fsync+rename (atomic queue
+// files) in a single io_uring_enter instead of two or three syscalls.
+//
+// Opt-in: MACHINA_URING=1 plus a successful runtime probe (a real linked
+// write+fsync against a temp file — kernels or seccomp policies that lack
+// the ops fail the probe and everything stays on the blocking path). Any
+// "operation not supported" completion latches the backend off for the
+// rest of the process; plain I/O errors are just returned.
+
+#include <cstddef>
+#include <string>
+
+namespace machina {
+
+// True when the backend is requested, probed, and not latched off.
+bool uring_enabled();
+
+// Linked write(fd, buf, len) + fsync(fd), one submission. Short writes and
+// fsync-after-successful-write failures are completed with blocking calls
+// internally, so a false return means NOTHING was written and the caller
+// can safely retry with plain syscalls.
+bool uring_write_fsync(int fd, const void* buf, size_t len, std::string* err);
+
+// Linked write(tmp_fd) + fsync(tmp_fd) + rename(tmp_path -> dst_path).
+// Same write guarantee as above; a failed rename leaves the tmp file
+// durable on disk, so the caller's blocking fallback (rewrite tmp, rename)
+// is idempotent.
+bool uring_write_fsync_rename(int tmp_fd, const void* buf, size_t len,
+                              const std::string& tmp_path,
+                              const std::string& dst_path,
+                              std::string* err);
+
+} // namespace machina
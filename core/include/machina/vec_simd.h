@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace machina::vec {
+
+// ---------- float32 dot product (runtime-dispatched SIMD) ----------
+// Purpose: brute-force similarity scans over embeddings.f32 streams.
+// Picks AVX-512F / AVX2+FMA on x86 (via __builtin_cpu_supports, resolved
+// once) or NEON on AArch64, with a scalar fallback. Both inputs are plain
+// float arrays of length n; no alignment requirement.
+// NOTE: Implementation lives in core/src/vec_simd.cpp so the wide-register
+// kernels can be compiled with per-function target attributes.
+float dot_f32(const float* a, const float* b, size_t n);
+
+// ---------- quantized dot products ----------
+// Mixed-precision kernels for quantized embedding storage: the query stays
+// float32 and the stored vector is dequantized inside the kernel.
+// dot_f16: b is IEEE half-precision (uses F16C on x86 when available).
+// dot_i8:  b is symmetric int8; the caller applies its per-vector scale to
+//          the returned raw integer-weighted sum.
+float dot_f16(const float* a, const uint16_t* b, size_t n);
+float dot_i8(const float* a, const int8_t* b, size_t n);
+
+// Scalar IEEE 754 half-precision conversions (round-to-nearest-even on
+// encode), used by the quantized storage encode/decode paths.
+uint16_t f32_to_f16(float v);
+float f16_to_f32(uint16_t h);
+
+} // namespace machina::vec
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <condition_variable>
 #include <cstdint>
 #include <filesystem>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace machina {
@@ -14,6 +16,15 @@ struct WalPolicy {
     int max_segment_age_sec{3600};                  // 1 hour max age
     int max_segments{10};                            // keep last N segments
     int64_t max_total_bytes{256 * 1024 * 1024};    // 256 MB total cap
+
+    // >0 enables the block-compressed binary segment format: records are
+    // accumulated into blocks of roughly this many raw bytes, each deflated
+    // and written as [magic][raw_len][comp_len][crc32][bytes]. Repetitive
+    // JSON payloads typically shrink 5-10x, stretching the retention caps
+    // above by the same factor. WalReader decompresses transparently.
+    // Best combined with group commit: per-append fsync forces a (small)
+    // block flush per record.
+    int64_t compress_block_bytes{0};
 };
 
 // Wal: append-only JSONL log with automatic segment rotation.
@@ -45,9 +56,50 @@ public:
 
     // Appends one JSON record line (json + '\n').
     // Automatically rotates the segment if policy limits are exceeded.
-    // Returns empty string on success.
+    // With group commit enabled the record is only buffered; durability is
+    // deferred to the commit thread. Returns empty string on success.
     std::string append_json_line(const std::string& json);
 
+    // Like append_json_line, but with group commit enabled blocks until the
+    // batch containing this record has been written and fsynced.
+    // Returns the flush error of that batch, empty string on success.
+    std::string append_json_line_sync(const std::string& json);
+
+    // Group-commit batching: appends land in an in-memory buffer and a
+    // background commit thread flushes + fsyncs once per max_batch_records
+    // or max_delay_ms, whichever comes first. Amortizes fsync cost across
+    // a batch without giving up durability for _sync callers.
+    void enable_group_commit(int max_batch_records = 64, int max_delay_ms = 5);
+
+    // Stops the commit thread, flushing any buffered records first.
+    void disable_group_commit();
+
+    // In-memory tail ring: keeps the last `capacity` appended records in
+    // RAM so recent-event queries (dashboards, runlog tools) are served
+    // without file I/O. 0 disables (the default).
+    void set_tail_ring(size_t capacity);
+
+    // Last n records from the ring, oldest first.
+    std::vector<std::string> tail(size_t n) const;
+
+    // Polling subscription: returns records with sequence >= *cursor and
+    // advances *cursor past them. A cursor that has fallen off the ring
+    // resumes from the oldest retained record. max_records 0 = no limit.
+    std::vector<std::string> tail_since(uint64_t* cursor, size_t max_records = 0) const;
+
+    // Sequence that will be stamped on the next appended record
+    // (i.e. total appends observed by the ring so far).
+    uint64_t tail_seq() const;
+
+    // Background maintenance: rotation and retention move to a thread
+    // owned by the Wal. The append that crosses a policy limit only flips
+    // to a pre-opened fresh segment fd; the rename of the old segment and
+    // retention sweeps happen asynchronously, off the append path.
+    void enable_maintenance(int interval_ms = 500);
+
+    // Stops the maintenance thread, completing any pending rotation.
+    void disable_maintenance();
+
     // Truncates the file to empty (keeps it open).
     std::string truncate();
 
@@ -66,6 +118,9 @@ public:
     // List all segment files (including current) sorted oldest-first.
     std::vector<std::filesystem::path> list_segments() const;
 
+    // Base path of the active segment.
+    const std::filesystem::path& path() const { return path_; }
+
 private:
     std::filesystem::path path_;       // base path (active segment)
     int fd_ = -1;
@@ -75,10 +130,65 @@ private:
     int64_t segment_open_time_{0};     // epoch seconds when current segment opened
     int64_t current_size_{0};          // tracked to avoid frequent stat() calls
 
+    // Group-commit state (guarded by gc_mu_, not mu_)
+    bool gc_enabled_{false};
+    bool gc_stop_{false};
+    int gc_max_batch_{64};
+    int gc_max_delay_ms_{5};
+    uint64_t gc_seq_head_{0};      // seq of the newest buffered record
+    uint64_t gc_seq_durable_{0};   // seq through which records are fsynced
+    std::vector<std::string> gc_pending_;  // encoded payloads awaiting flush
+    std::string gc_last_error_;    // error of the most recent flush
+    std::thread gc_thread_;
+    std::mutex gc_mu_;
+    std::condition_variable gc_cv_;       // wakes the commit thread
+    std::condition_variable gc_done_cv_;  // wakes _sync waiters
+
     // Internal: rotate under lock
     std::string rotate_locked();
     // Internal: check if rotation is needed
     bool needs_rotation_locked() const;
+    std::string block_buf_;  // pending raw bytes for the compressed format
+
+    // Maintenance state (guarded by mu_ except the thread handle)
+    bool mt_enabled_{false};
+    bool mt_stop_{false};
+    int mt_interval_ms_{500};
+    int spare_fd_{-1};           // pre-opened fd on <base>.next
+    bool rotate_pending_{false}; // segment swapped out, rename outstanding
+    int old_fd_{-1};             // fd of the swapped-out segment
+    std::thread mt_thread_;
+    std::mutex mt_mu_;
+    std::condition_variable mt_cv_;
+
+    // Tail ring state (guarded by ring_mu_)
+    mutable std::mutex ring_mu_;
+    std::vector<std::string> ring_;  // circular, indexed by seq % capacity
+    size_t ring_cap_{0};
+    uint64_t ring_next_seq_{0};
+
+    // Internal: encode one record (plain or framed) as raw segment bytes
+    static std::string encode_record(const std::string& json);
+    // Internal: write pre-encoded bytes to the segment under mu_ (no fsync)
+    std::string write_encoded_locked(const std::string& payload);
+    // Internal: raw write to fd_ under mu_, updates current_size_
+    std::string write_raw_locked(const void* data, size_t len);
+    // Internal: deflate and write the pending block, if any
+    std::string flush_block_locked();
+    // Internal: land a concatenated group-commit batch durably under mu_:
+    // one linked write+fsync submission on the io_uring backend, else one
+    // write plus one fsync
+    std::string write_batch_durable_locked(const std::string& payload);
+    // Internal: commit thread main loop
+    void group_commit_loop();
+    // Internal: record one append into the tail ring (no-op when disabled)
+    void tail_ring_push(const std::string& json);
+    // Internal: maintenance thread main loop
+    void maintenance_loop();
+    // Internal: finish a pending rotation (rename old + next segments)
+    void complete_rotation();
+    // Internal: path of the pre-opened spare segment
+    std::filesystem::path spare_path() const;
 };
 
 } // namespace machina
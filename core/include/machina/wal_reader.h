@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace machina {
+
+// WalReader: memory-mapped, read-only view over one WAL segment.
+//
+// On first open the segment is scanned once to build a sparse index of
+// (record ordinal → byte offset), which is persisted next to the segment
+// as <segment>.idx. Subsequent opens load the index and skip the scan, so
+// seeking to an arbitrary record is O(stride) instead of O(file size).
+//
+// Records are exposed as std::string_view into the mapping (zero copy,
+// trailing newline stripped). Views are valid until close()/destruction.
+// Handles both the plain JSONL and the framed ([len][line][crc]) formats,
+// following the same MACHINA_WAL_FRAMED switch as the writer. Segments
+// written with WalPolicy::compress_block_bytes are detected by block magic
+// and decompressed transparently on open (views then point into the
+// decompressed buffer).
+class WalReader {
+public:
+    explicit WalReader(std::filesystem::path segment);
+    ~WalReader();
+
+    WalReader(const WalReader&) = delete;
+    WalReader& operator=(const WalReader&) = delete;
+
+    // Maps the segment and loads or (re)builds the record index.
+    // A stale index (segment grew or shrank since it was written) is
+    // rebuilt transparently. Index persistence failures are non-fatal.
+    // Returns empty string on success.
+    std::string open(bool persist_index = true);
+
+    bool is_open() const;
+
+    void close();
+
+    // Number of complete records in the segment.
+    size_t record_count() const;
+
+    // Zero-copy view of record `ordinal` (0-based, newline stripped).
+    // Returns an empty view if ordinal is out of range.
+    std::string_view record(size_t ordinal) const;
+
+    // Byte offset of record `ordinal` within the segment, -1 if out of range.
+    int64_t offset_of(size_t ordinal) const;
+
+private:
+    // One index entry every kIndexStride records keeps the index tiny
+    // (8 bytes per 64 records) while bounding the seek scan.
+    static constexpr size_t kIndexStride = 64;
+
+    std::filesystem::path path_;
+    const char* map_ = nullptr;
+    size_t map_size_ = 0;
+    bool open_ = false;
+    bool framed_ = false;
+    bool compressed_ = false;
+    std::string decompressed_;  // logical stream for block-compressed segments
+    size_t record_count_ = 0;
+    std::vector<uint64_t> sparse_offsets_;  // offset of record i*kIndexStride
+
+    std::filesystem::path index_path() const;
+    std::string build_index();
+    bool load_index();
+    void save_index() const;
+    // Detects block-compressed segments and inflates them on open
+    void decompress_blocks();
+    // Logical record stream (the mapping, or the decompressed buffer)
+    const char* data() const;
+    size_t data_size() const;
+    // Advance one record from `off`; returns false at end of valid data.
+    bool next_record(size_t& off, std::string_view& out) const;
+};
+
+} // namespace machina
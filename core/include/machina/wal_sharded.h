@@ -0,0 +1,65 @@
+#pragma once
+
+#include "machina/wal.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace machina {
+
+// ShardedWal: N independent segment writers behind one append API.
+//
+// Wal serializes every append under a single mutex; with many concurrent
+// tool executions threads queue on it. ShardedWal spreads appends across
+// per-thread shard writers (<base>.shard<k>.jsonl), so parallel appenders
+// contend only within their shard. Each record is stamped with a
+// process-wide monotonic "_wseq" so merge-on-read can restore total order.
+//
+// Read side: for_each_ordered() k-way merges all shards by "_wseq";
+// list_segments() returns every shard's segments oldest-first.
+class ShardedWal {
+public:
+    // shards <= 1 degrades gracefully to a single writer.
+    ShardedWal(std::filesystem::path base, int shards);
+
+    ShardedWal(const ShardedWal&) = delete;
+    ShardedWal& operator=(const ShardedWal&) = delete;
+
+    // Applied to every shard (policy caps are per shard).
+    void set_fsync(bool enable);
+    void set_policy(const WalPolicy& policy);
+
+    // Opens all shard writers. Returns first error, empty string on success.
+    std::string open(bool truncate = false);
+
+    // Appends to the calling thread's shard, stamping "_wseq" into the
+    // record (objects get the key injected; other payloads are wrapped).
+    std::string append_json_line(const std::string& json);
+
+    int shard_count() const;
+
+    // All segments across shards, oldest-first within each shard.
+    std::vector<std::filesystem::path> list_segments() const;
+
+    // Merge-on-read: invokes fn for every record across all shards in
+    // ascending "_wseq" order. Records without a parseable stamp are
+    // delivered first in shard order. Returns empty string on success.
+    std::string for_each_ordered(
+        const std::function<void(uint64_t seq, std::string_view record)>& fn) const;
+
+private:
+    std::filesystem::path base_;
+    std::vector<std::unique_ptr<Wal>> shards_;
+    std::atomic<uint64_t> seq_{0};
+    std::atomic<uint32_t> next_shard_{0};  // round-robin thread → shard binding
+
+    Wal& shard_for_this_thread();
+};
+
+} // namespace machina
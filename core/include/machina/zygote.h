@@ -0,0 +1,45 @@
+#pragma once
+
+// Machina Zygote — pre-forked worker pool for tool subprocess execution.
+//
+// Every external tool call (policy selector, embed provider, shell_exec,
+// toolhost) pays full process spawn; at autopilot call rates that overhead is
+// a visible fraction of step latency. The zygote amortizes it: the first
+// spawn forks one small master process, and the master keeps a pool of idle
+// pre-forked workers. A caller picks up a worker over a unix socket, sends it
+// (argv, cwd, limits) plus its stdio pipe fds via SCM_RIGHTS, and the worker
+// applies the sandbox and execs the target. Workers are cloned with
+// CLONE_PARENT so they are children of the caller's process — timeout kill
+// and waitpid work exactly as with directly forked children.
+//
+// Linux-only; opt-in via MACHINA_ZYGOTE_ENABLE=1 (pool size via
+// MACHINA_ZYGOTE_POOL, default 4). seccomp runs stay on the fork path: the
+// master is forked from a potentially multi-threaded process, so everything
+// after that fork must stay allocation-free, and the BPF filter builder is
+// not. proc_run_capture_sandboxed* route through the pool automatically when
+// it is enabled.
+
+#include "machina/proc.h"
+
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+
+namespace machina {
+
+// True when MACHINA_ZYGOTE_ENABLE is set truthy (Linux only).
+bool zygote_enabled();
+
+// Spawn argv through the worker pool: the returned pid is a direct child of
+// the calling process with stdout_fd wired to the child's stdout+stderr and
+// stdin_fd (when >= 0) to its stdin. Returns -1 when the pool is disabled or
+// unavailable — callers fall back to their fork/clone path.
+pid_t zygote_spawn(const std::vector<std::string>& argv,
+                   const std::string& cwd,
+                   const ProcLimits& lim,
+                   int stdin_fd, int stdout_fd);
+
+} // namespace machina
+
+#endif // !_WIN32
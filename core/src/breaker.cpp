@@ -0,0 +1,171 @@
+#include "machina/breaker.h"
+
+#include "machina/hash.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace machina {
+
+namespace {
+
+// 64-byte slots: one cache line each, no false sharing between keys.
+struct Slot {
+    uint64_t key{0}; // fnv1a64 of the key string; 0 = empty
+    int32_t fail_count{0};
+    int32_t pad{0};
+    int64_t first_fail_ms{0};
+    int64_t last_fail_ms{0};
+    int64_t block_until_ms{0};
+    int64_t reserved[3]{0, 0, 0};
+};
+static_assert(sizeof(Slot) == 64, "slot is one cache line");
+
+constexpr uint64_t kMagic = 0x316d68736b72626dULL; // "mbrkshm1"
+constexpr size_t kSlots = 256;
+constexpr size_t kProbes = 16;
+
+struct Header {
+    uint64_t magic{0};
+    uint64_t nslots{0};
+    uint64_t reserved[6]{0, 0, 0, 0, 0, 0};
+};
+
+// Maps (creating on first use) the shared table. Falls back to a private
+// heap table when the file cannot be mapped — breaker still works, just
+// process-local, mirroring how other opt-in lanes degrade.
+Slot* table() {
+    static Slot* slots = [] {
+#ifndef _WIN32
+        std::filesystem::path p;
+        if (const char* root = std::getenv("MACHINA_ROOT")) {
+            std::error_code ec;
+            auto dir = std::filesystem::path(root) / "work";
+            std::filesystem::create_directories(dir, ec);
+            if (!ec) p = dir / "breaker.shm";
+        }
+        if (p.empty()) {
+            std::error_code ec;
+            p = std::filesystem::temp_directory_path(ec) / "machina_breaker.shm";
+            if (ec) p.clear();
+        }
+        if (!p.empty()) {
+            int fd = ::open(p.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd >= 0) {
+                size_t len = sizeof(Header) + kSlots * sizeof(Slot);
+                struct stat st{};
+                bool sized = ::fstat(fd, &st) == 0 &&
+                             ((size_t)st.st_size == len || ::ftruncate(fd, (off_t)len) == 0);
+                if (sized) {
+                    void* m = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                    if (m != MAP_FAILED) {
+                        ::close(fd);
+                        auto* hdr = (Header*)m;
+                        uint64_t expect = 0;
+                        // First process in stamps the header; a stale file
+                        // from an older layout is wiped rather than trusted.
+                        if (!std::atomic_ref<uint64_t>(hdr->magic)
+                                 .compare_exchange_strong(expect, kMagic,
+                                                          std::memory_order_acq_rel) &&
+                            expect != kMagic) {
+                            std::memset(m, 0, len);
+                            std::atomic_ref<uint64_t>(hdr->magic)
+                                .store(kMagic, std::memory_order_release);
+                        }
+                        std::atomic_ref<uint64_t>(hdr->nslots)
+                            .store(kSlots, std::memory_order_release);
+                        return (Slot*)((char*)m + sizeof(Header));
+                    }
+                }
+                ::close(fd);
+            }
+        }
+#endif
+        return new Slot[kSlots]();
+    }();
+    return slots;
+}
+
+// Finds (or claims) the slot for a key hash. When the probe run is full of
+// other keys, the first probed slot is stolen — losing an unrelated key's
+// counters is acceptable for an advisory breaker, unbounded growth is not.
+Slot* slot_for(uint64_t kh) {
+    if (kh == 0) kh = 1;
+    Slot* slots = table();
+    size_t start = (size_t)(kh % kSlots);
+    for (size_t i = 0; i < kProbes; i++) {
+        Slot& s = slots[(start + i) % kSlots];
+        uint64_t cur = std::atomic_ref<uint64_t>(s.key).load(std::memory_order_relaxed);
+        if (cur == kh) return &s;
+        if (cur == 0) {
+            uint64_t expect = 0;
+            if (std::atomic_ref<uint64_t>(s.key)
+                    .compare_exchange_strong(expect, kh, std::memory_order_relaxed)) {
+                return &s;
+            }
+            if (expect == kh) return &s;
+        }
+    }
+    Slot& s = slots[start];
+    std::atomic_ref<int32_t>(s.fail_count).store(0, std::memory_order_relaxed);
+    std::atomic_ref<int64_t>(s.first_fail_ms).store(0, std::memory_order_relaxed);
+    std::atomic_ref<int64_t>(s.last_fail_ms).store(0, std::memory_order_relaxed);
+    std::atomic_ref<int64_t>(s.block_until_ms).store(0, std::memory_order_relaxed);
+    std::atomic_ref<uint64_t>(s.key).store(kh, std::memory_order_relaxed);
+    return &s;
+}
+
+} // namespace
+
+bool breaker_is_blocked(const std::string& key, int64_t now_ms, BreakerState* out) {
+    Slot* s = slot_for(hash::fnv1a64(key));
+    int64_t until = std::atomic_ref<int64_t>(s->block_until_ms).load(std::memory_order_relaxed);
+    if (out) {
+        out->fail_count = std::atomic_ref<int32_t>(s->fail_count).load(std::memory_order_relaxed);
+        out->first_fail_ms = std::atomic_ref<int64_t>(s->first_fail_ms).load(std::memory_order_relaxed);
+        out->last_fail_ms = std::atomic_ref<int64_t>(s->last_fail_ms).load(std::memory_order_relaxed);
+        out->block_until_ms = until;
+    }
+    return until > 0 && now_ms < until;
+}
+
+void breaker_record_fail(const std::string& key, int64_t now_ms,
+                         int threshold, int64_t window_ms, int64_t cooldown_ms) {
+    Slot* s = slot_for(hash::fnv1a64(key));
+    std::atomic_ref<int64_t> first(s->first_fail_ms);
+    std::atomic_ref<int32_t> count(s->fail_count);
+
+    int64_t f = first.load(std::memory_order_relaxed);
+    int32_t c;
+    if (f == 0 || (now_ms - f) > window_ms) {
+        first.store(now_ms, std::memory_order_relaxed);
+        count.store(1, std::memory_order_relaxed);
+        c = 1;
+    } else {
+        c = count.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    std::atomic_ref<int64_t>(s->last_fail_ms).store(now_ms, std::memory_order_relaxed);
+    if (c >= threshold) {
+        std::atomic_ref<int64_t>(s->block_until_ms)
+            .store(now_ms + cooldown_ms, std::memory_order_relaxed);
+    }
+}
+
+void breaker_record_success(const std::string& key) {
+    Slot* s = slot_for(hash::fnv1a64(key));
+    std::atomic_ref<int32_t>(s->fail_count).store(0, std::memory_order_relaxed);
+    std::atomic_ref<int64_t>(s->first_fail_ms).store(0, std::memory_order_relaxed);
+    std::atomic_ref<int64_t>(s->last_fail_ms).store(0, std::memory_order_relaxed);
+    std::atomic_ref<int64_t>(s->block_until_ms).store(0, std::memory_order_relaxed);
+}
+
+} // namespace machina
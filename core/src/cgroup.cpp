@@ -0,0 +1,120 @@
+#include "machina/cgroup.h"
+
+#ifdef __linux__
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace machina {
+
+namespace {
+
+bool write_cg_file(const std::string& path, const std::string& data) {
+    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    ssize_t n = write(fd, data.data(), data.size());
+    close(fd);
+    return n == (ssize_t)data.size();
+}
+
+// Operator-provided delegated dir wins; otherwise fall back to the group the
+// calling process already sits in (writable under systemd user delegation).
+std::string cgroup_base_dir() {
+    if (const char* d = std::getenv("MACHINA_PROC_CGROUP_DIR")) {
+        if (*d) return d;
+    }
+    std::ifstream in("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("0::", 0) == 0) {
+            std::string rel = line.substr(3);
+            if (rel == "/") rel.clear();
+            return "/sys/fs/cgroup" + rel;
+        }
+    }
+    return {};
+}
+
+bool cgroup_requested(const ProcLimits& lim) {
+    if (lim.enable_cgroup) return true;
+    const char* v = std::getenv("MACHINA_PROC_CGROUP");
+    return v && (std::strcmp(v, "1") == 0 || std::strcmp(v, "true") == 0);
+}
+
+} // namespace
+
+bool cgroup_available(const ProcLimits& lim) {
+    if (!cgroup_requested(lim)) return false;
+    std::string base = cgroup_base_dir();
+    if (base.empty()) return false;
+    return access((base + "/cgroup.procs").c_str(), W_OK) == 0;
+}
+
+std::string cgroup_create_transient(const ProcLimits& lim, std::string* err) {
+    std::string base = cgroup_base_dir();
+    if (base.empty()) {
+        if (err) *err = "no cgroup v2 base directory";
+        return "";
+    }
+
+    // Delegate controllers to children (best-effort, one per write — a
+    // missing controller must not veto the others). Fails when the base
+    // group still hosts processes; operator-prepared dirs won't.
+    (void)write_cg_file(base + "/cgroup.subtree_control", "+memory");
+    (void)write_cg_file(base + "/cgroup.subtree_control", "+pids");
+    (void)write_cg_file(base + "/cgroup.subtree_control", "+cpu");
+
+    static std::atomic<uint64_t> seq{0};
+    std::string dir = base + "/machina-" + std::to_string(getpid())
+                    + "-" + std::to_string(seq.fetch_add(1));
+    if (mkdir(dir.c_str(), 0755) != 0) {
+        if (err) *err = std::string("mkdir(") + dir + ") failed: " + std::strerror(errno);
+        return "";
+    }
+
+    size_t mem_mb = lim.cgroup_memory_max_mb > 0 ? lim.cgroup_memory_max_mb
+                                                 : lim.rlimit_as_mb;
+    if (mem_mb > 0) {
+        if (!write_cg_file(dir + "/memory.max",
+                           std::to_string(mem_mb * 1024ULL * 1024ULL))) {
+            // No memory controller means no point — the whole reason to be
+            // here is real memory accounting. Fall back to rlimits.
+            if (err) *err = "memory.max not writable (controller not delegated?)";
+            (void)rmdir(dir.c_str());
+            return "";
+        }
+    }
+    if (lim.rlimit_nproc > 0) {
+        (void)write_cg_file(dir + "/pids.max", std::to_string(lim.rlimit_nproc));
+    }
+    if (lim.cgroup_cpu_max_pct > 0) {
+        // quota/period in usec; 100 == one full CPU
+        (void)write_cg_file(dir + "/cpu.max",
+                            std::to_string((int64_t)lim.cgroup_cpu_max_pct * 1000)
+                            + " 100000");
+    }
+    return dir;
+}
+
+bool cgroup_join(const std::string& dir) {
+    // "0" means the writing process itself
+    return write_cg_file(dir + "/cgroup.procs", "0");
+}
+
+void cgroup_remove(const std::string& dir) {
+    for (int i = 0; i < 50; i++) {
+        if (rmdir(dir.c_str()) == 0 || errno == ENOENT) return;
+        usleep(2000);
+    }
+}
+
+} // namespace machina
+
+#endif // __linux__
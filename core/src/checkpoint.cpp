@@ -0,0 +1,141 @@
+#include "machina/checkpoint.h"
+
+#include "machina/serialization.h"
+
+#include <json-c/json.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace machina {
+
+static int64_t ckpt_now_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+std::string checkpoint_write(const std::filesystem::path& file, const DSState& ds,
+                             uint64_t wal_seq) {
+#if defined(_WIN32)
+    (void)file; (void)ds; (void)wal_seq;
+    return "checkpointing is not supported on Windows build in this snapshot";
+#else
+    std::error_code ec;
+    auto parent = file.parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+        if (ec) return std::string("create_directories: ") + ec.message();
+    }
+
+    json_object* root = json_object_new_object();
+    json_object_object_add(root, "version", json_object_new_int(1));
+    json_object_object_add(root, "created_ms", json_object_new_int64(ckpt_now_ms()));
+    json_object_object_add(root, "wal_seq", json_object_new_int64((int64_t)wal_seq));
+    json_object_object_add(root, "state", dsstate_to_json(ds));
+    const char* text = json_object_to_json_string_ext(root, JSON_C_TO_STRING_PLAIN);
+    std::string payload = text ? text : "{}";
+    json_object_put(root);
+
+    // tmp + write + fsync + rename: a crash never leaves a torn snapshot.
+    auto tmp = std::filesystem::path(file.string() + ".tmp");
+    int fd = ::open(tmp.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd < 0) return std::string("open: ") + std::strerror(errno);
+    size_t off = 0;
+    while (off < payload.size()) {
+        ssize_t w = ::write(fd, payload.data() + off, payload.size() - off);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            std::string err = std::string("write: ") + std::strerror(errno);
+            ::close(fd);
+            return err;
+        }
+        off += (size_t)w;
+    }
+    if (::fsync(fd) != 0) {
+        std::string err = std::string("fsync: ") + std::strerror(errno);
+        ::close(fd);
+        return err;
+    }
+    ::close(fd);
+
+    std::filesystem::rename(tmp, file, ec);
+    if (ec) return std::string("rename: ") + ec.message();
+
+    if (parent.empty()) parent = ".";
+    int dir_fd = ::open(parent.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir_fd >= 0) { ::fsync(dir_fd); ::close(dir_fd); }
+
+    return "";
+#endif
+}
+
+std::string checkpoint_load(const std::filesystem::path& file, DSState* out,
+                            CheckpointInfo* info) {
+    if (!out) return "checkpoint_load: null output state";
+
+    std::ifstream in(file, std::ios::binary);
+    if (!in) return "cannot open snapshot: " + file.string();
+    std::ostringstream buf;
+    buf << in.rdbuf();
+    std::string text = buf.str();
+
+    json_object* root = json_tokener_parse(text.c_str());
+    if (!root || !json_object_is_type(root, json_type_object)) {
+        if (root) json_object_put(root);
+        return "snapshot is not a JSON object";
+    }
+
+    json_object* state = nullptr;
+    if (!json_object_object_get_ex(root, "state", &state)) {
+        json_object_put(root);
+        return "snapshot missing state";
+    }
+    if (!dsstate_from_json(state, out)) {
+        json_object_put(root);
+        return "snapshot state did not parse";
+    }
+
+    if (info) {
+        *info = CheckpointInfo{};
+        json_object* v = nullptr;
+        if (json_object_object_get_ex(root, "created_ms", &v))
+            info->created_ms = json_object_get_int64(v);
+        if (json_object_object_get_ex(root, "wal_seq", &v))
+            info->wal_seq = (uint64_t)json_object_get_int64(v);
+    }
+
+    json_object_put(root);
+    return "";
+}
+
+std::string checkpoint_and_truncate(const std::filesystem::path& file,
+                                    const DSState& ds, Wal& wal) {
+    // Snapshot first: until the rename lands, the full WAL still recovers
+    // the state, so a crash anywhere in here loses nothing.
+    std::string err = checkpoint_write(file, ds, wal.tail_seq());
+    if (!err.empty()) return err;
+
+    // Everything up to here is covered by the snapshot: drop the active
+    // segment's contents and the rotated history.
+    err = wal.truncate();
+    if (!err.empty()) return err;
+
+    std::error_code ec;
+    auto active = wal.path().filename();
+    for (const auto& seg : wal.list_segments()) {
+        if (seg.filename() == active) continue;
+        std::filesystem::remove(seg, ec);
+        std::filesystem::remove(seg.string() + ".idx", ec);
+    }
+    return "";
+}
+
+} // namespace machina
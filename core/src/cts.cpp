@@ -1,5 +1,6 @@
 #include "machina/cts.h"
 #include "machina/json_mini.h"
+#include "machina/manifest_cache.h"
 
 #include <fstream>
 #include <sstream>
@@ -16,6 +17,14 @@ std::vector<CtsIssue> cts_check_toolpack(const std::string& manifest_path) {
     std::vector<CtsIssue> issues;
     auto j = slurp(manifest_path);
 
+    // Issue lists are pure functions of the manifest bytes; reuse the
+    // cached result from a previous run of this exact content.
+    std::string cache_key;
+    if (manifest_cache::enabled()) {
+        cache_key = manifest_cache::content_key(j);
+        if (manifest_cache::load_issues("tp", cache_key, &issues)) return issues;
+    }
+
     if (!json_mini::has_key(j, "toolpack_id")) issues.push_back({"TP-01","missing toolpack_id"});
     if (!json_mini::has_key(j, "tools")) issues.push_back({"TP-02","missing tools[]"});
 
@@ -51,6 +60,7 @@ std::vector<CtsIssue> cts_check_toolpack(const std::string& manifest_path) {
         if (json_mini::has_key(j, "tools")) issues.push_back({"TP-04","tools is not an array"});
     }
 
+    if (!cache_key.empty()) manifest_cache::save_issues("tp", cache_key, issues);
     return issues;
 }
 
@@ -58,6 +68,12 @@ std::vector<CtsIssue> cts_check_goalpack(const std::string& manifest_path) {
     std::vector<CtsIssue> issues;
     auto j = slurp(manifest_path);
 
+    std::string cache_key;
+    if (manifest_cache::enabled()) {
+        cache_key = manifest_cache::content_key(j);
+        if (manifest_cache::load_issues("gp", cache_key, &issues)) return issues;
+    }
+
     if (!json_mini::has_key(j, "goalpack_id")) issues.push_back({"GP-01","missing goalpack_id"});
     if (!json_mini::has_key(j, "goals")) issues.push_back({"GP-02","missing goals[]"});
 
@@ -77,6 +93,7 @@ std::vector<CtsIssue> cts_check_goalpack(const std::string& manifest_path) {
         if (json_mini::has_key(j, "goals")) issues.push_back({"GP-05","goals is not an array"});
     }
 
+    if (!cache_key.empty()) manifest_cache::save_issues("gp", cache_key, issues);
     return issues;
 }
 
@@ -1,5 +1,6 @@
 #include "machina/embedding.h"
 #include "machina/hash.h"
+#include "machina/thread_pool.h"
 #include <cmath>
 #include <stdexcept>
 
@@ -11,24 +12,22 @@ std::vector<float> hash_embedding(const std::string& text, size_t dim) {
     // We avoid std::random_device and platform RNG to keep determinism tight.
     std::vector<float> v(dim, 0.0f);
 
-    // Seed with SHA-256 then mix into 64-bit chunks.
+    // Seed with SHA-256 then mix into 64-bit chunks: 16 hex chars -> 64 bits
+    // at a time, parsed in place (the old substr-per-chunk version allocated
+    // on every iteration and dominated the expansion cost).
     std::string h = hash::sha256_hex(text);
-    // Use 16 hex chars -> 64-bit at a time, step through h.
-    auto hex_to_u64 = [](const std::string& s)->uint64_t{
-        uint64_t out = 0;
-        for (char c : s) {
-            out <<= 4;
-            if (c >= '0' && c <= '9') out |= uint64_t(c - '0');
-            else if (c >= 'a' && c <= 'f') out |= uint64_t(10 + (c - 'a'));
-            else if (c >= 'A' && c <= 'F') out |= uint64_t(10 + (c - 'A'));
-        }
-        return out;
+    auto hex_nibble = [](char c)->uint64_t{
+        if (c >= '0' && c <= '9') return uint64_t(c - '0');
+        if (c >= 'a' && c <= 'f') return uint64_t(10 + (c - 'a'));
+        if (c >= 'A' && c <= 'F') return uint64_t(10 + (c - 'A'));
+        return 0;
     };
 
     size_t chunks = (dim + 1) / 2; // two floats per 64-bit chunk
     for (size_t i=0;i<chunks;i++){
         size_t off = (i*16) % (h.size() - 16);
-        uint64_t x = hex_to_u64(h.substr(off,16));
+        uint64_t x = 0;
+        for (size_t j = 0; j < 16; j++) x = (x << 4) | hex_nibble(h[off + j]);
         // Split to two 32-bit lanes, map to float [-1,1]
         uint32_t lo = uint32_t(x & 0xffffffffULL);
         uint32_t hi = uint32_t((x >> 32) & 0xffffffffULL);
@@ -50,6 +49,23 @@ std::vector<float> hash_embedding(const std::string& text, size_t dim) {
     return v;
 }
 
+std::vector<std::vector<float>> hash_embedding_many(const std::vector<std::string>& texts,
+                                                    size_t dim) {
+    std::vector<std::vector<float>> out(texts.size());
+    if (texts.empty() || dim == 0) return out;
+    // Documents are independent, so large corpora (memory_query re-embeds its
+    // whole candidate set per query) fan out across the shared worker pool.
+    // Each result is bit-identical to a hash_embedding() call.
+    if (texts.size() >= 64) {
+        ThreadPool::shared().parallel_for(0, texts.size(), [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++) out[i] = hash_embedding(texts[i], dim);
+        });
+    } else {
+        for (size_t i = 0; i < texts.size(); i++) out[i] = hash_embedding(texts[i], dim);
+    }
+    return out;
+}
+
 float dot(const std::vector<float>& a, const std::vector<float>& b) {
     if (a.size() != b.size()) throw std::runtime_error("dot: dimension mismatch");
     double s = 0.0;
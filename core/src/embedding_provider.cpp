@@ -1,14 +1,37 @@
 #include "machina/embedding_provider.h"
 #include "machina/embedding.h"
+#include "machina/hash.h"
 #include "machina/json_mini.h"
 #include "machina/proc.h"
+#include "machina/vec_simd.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#ifndef _WIN32
+  #include <unistd.h>
+  #include <fcntl.h>
+  #include <poll.h>
+  #include <signal.h>
+  #include <sys/resource.h>
+  #include <sys/wait.h>
+  #ifdef __linux__
+    #include <sys/prctl.h>
+  #endif
+#endif
+
 namespace machina {
 
 static int getenv_int(const char* k, int defv) {
@@ -24,8 +47,10 @@ static std::string getenv_str(const char* k, const std::string& defv="") {
 }
 
 void l2_normalize(std::vector<float>& v) {
-    double ss = 0.0;
-    for (float x : v) ss += (double)x * (double)x;
+    if (v.empty()) return;
+    // Sum of squares via the runtime-dispatched SIMD dot kernel
+    // (AVX-512/AVX2/NEON); the scale loop below auto-vectorizes.
+    double ss = (double)vec::dot_f32(v.data(), v.data(), v.size());
     double n = std::sqrt(ss);
     if (n <= 0.0) return;
     float inv = (float)(1.0 / n);
@@ -91,6 +116,372 @@ static ProcLimits make_embed_limits() {
     return lim;
 }
 
+// Parses {"embedding":[...],"provider":"..."} into r (zero-padded to dim).
+static bool parse_single_response(const std::string& js, size_t dim, EmbedResult* r) {
+    auto emb_raw = json_mini::get_array_raw(js, "embedding");
+    if (!emb_raw) return false;
+    auto vals = json_mini::parse_array_numbers(*emb_raw);
+    if (vals.empty()) return false;
+    r->embedding.assign(dim, 0.0f);
+    size_t n = std::min(vals.size(), dim);
+    for (size_t i = 0; i < n; i++) r->embedding[i] = (float)vals[i];
+    r->provider = json_mini::get_string(js, "provider").value_or("cmd");
+    return true;
+}
+
+// Fills results from {"embeddings":[[...],...],"provider":"..."}, hash-filling
+// any entry the provider skipped or mangled. Returns false only when the
+// response carries no "embeddings" array at all.
+static bool parse_batch_response(const std::string& js,
+                                 const std::vector<std::string>& texts, size_t dim,
+                                 std::vector<EmbedResult>* results) {
+    auto embs_raw = json_mini::get_array_raw(js, "embeddings");
+    if (!embs_raw) return false;
+    std::string prov = json_mini::get_string(js, "provider").value_or("cmd");
+
+    // Parse array of arrays: get_array_raw returns "[[...],[...],...]"
+    // (outer brackets included). Track bracket depth; inner arrays
+    // start/end at depth 1→2→1.
+    const std::string& arr = *embs_raw;
+    std::vector<std::string> sub_arrays;
+    int depth = 0;
+    size_t start = 0;
+    for (size_t p = 0; p < arr.size(); p++) {
+        char c = arr[p];
+        if (c == '[') {
+            if (depth == 1) start = p;  // inner array start
+            depth++;
+        } else if (c == ']') {
+            depth--;
+            if (depth == 1) {  // inner array end
+                // Keep brackets — parse_array_numbers expects "[...]".
+                sub_arrays.push_back(arr.substr(start, p - start + 1));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < std::min(sub_arrays.size(), texts.size()); i++) {
+        auto vals = json_mini::parse_array_numbers(sub_arrays[i]);
+        if (!vals.empty()) {
+            (*results)[i].embedding.assign(dim, 0.0f);
+            size_t n = std::min(vals.size(), dim);
+            for (size_t j = 0; j < n; j++) (*results)[i].embedding[j] = (float)vals[j];
+            (*results)[i].provider = prov;
+        } else {
+            (*results)[i].provider = "cmd_fallback_hash";
+            (*results)[i].embedding = hash_embedding(texts[i], dim);
+        }
+    }
+    // Fill remaining (if the provider returned fewer than requested).
+    for (size_t i = sub_arrays.size(); i < texts.size(); i++) {
+        (*results)[i].provider = "cmd_fallback_hash";
+        (*results)[i].embedding = hash_embedding(texts[i], dim);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Cross-call result cache for the cmd provider. Menus and queries repeat the
+// same strings constantly, so identical (text, dim, provider config) requests
+// are served from an LRU instead of hitting the subprocess again. Hash
+// embeddings are never cached (recomputing is cheaper than the lookup), and
+// neither are fallback results — that would pin a transient failure.
+//
+// MACHINA_EMBED_CACHE_MAX caps the in-memory entries (0 disables the cache).
+// MACHINA_EMBED_CACHE_PERSIST=1 additionally mirrors entries as JSON files
+// under MACHINA_ROOT/work/embed_cache so warm caches survive restarts.
+
+namespace {
+
+struct EmbedCacheEntry {
+    std::list<std::string>::iterator lru_it;
+    EmbedResult result;
+};
+
+std::mutex g_embed_cache_mu;
+std::list<std::string> g_embed_cache_lru;  // front = most recently used
+std::unordered_map<std::string, EmbedCacheEntry> g_embed_cache;
+
+size_t embed_cache_cap() {
+    int v = getenv_int("MACHINA_EMBED_CACHE_MAX", 4096);
+    return v > 0 ? (size_t)v : 0;
+}
+
+bool embed_cache_persist() {
+    const char* e = std::getenv("MACHINA_EMBED_CACHE_PERSIST");
+    return e && (std::string(e) == "1" || std::string(e) == "true");
+}
+
+std::filesystem::path embed_cache_dir() {
+    const char* mr = std::getenv("MACHINA_ROOT");
+    std::filesystem::path root = mr ? std::filesystem::path(mr) : std::filesystem::current_path();
+    return root / "work" / "embed_cache";
+}
+
+std::string embed_cache_key(const std::string& text, size_t dim) {
+    // Fold the provider config in so switching models invalidates old entries.
+    std::string cfg = getenv_str("MACHINA_EMBED_PROVIDER", "hash") + "|" +
+                      getenv_str("MACHINA_EMBED_CMD", "");
+    return hash::sha256_hex(text) + "." + std::to_string(dim) + "." +
+           hash::hex64(hash::fnv1a64(cfg));
+}
+
+void embed_cache_put_mem(const std::string& key, const EmbedResult& r) {
+    size_t cap = embed_cache_cap();
+    if (cap == 0) return;
+    std::lock_guard<std::mutex> lk(g_embed_cache_mu);
+    auto it = g_embed_cache.find(key);
+    if (it != g_embed_cache.end()) {
+        g_embed_cache_lru.splice(g_embed_cache_lru.begin(), g_embed_cache_lru,
+                                 it->second.lru_it);
+        it->second.result = r;
+        return;
+    }
+    g_embed_cache_lru.push_front(key);
+    g_embed_cache[key] = {g_embed_cache_lru.begin(), r};
+    while (g_embed_cache.size() > cap) {
+        g_embed_cache.erase(g_embed_cache_lru.back());
+        g_embed_cache_lru.pop_back();
+    }
+}
+
+void embed_cache_put(const std::string& key, const EmbedResult& r) {
+    if (embed_cache_cap() == 0) return;
+    if (r.provider == "hash" || r.provider == "cmd_fallback_hash") return;
+    embed_cache_put_mem(key, r);
+    if (!embed_cache_persist()) return;
+
+    // Atomic write so a concurrent reader never sees a torn entry.
+    std::error_code ec;
+    auto dir = embed_cache_dir();
+    std::filesystem::create_directories(dir, ec);
+    auto final_path = dir / (key + ".json");
+    auto tmp = std::filesystem::path(final_path.string() + ".tmp");
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out.good()) return;
+        out << "{\"provider\":\"" << json_mini::json_escape(r.provider)
+            << "\",\"embedding\":[";
+        for (size_t i = 0; i < r.embedding.size(); i++) {
+            if (i) out << ",";
+            out << r.embedding[i];
+        }
+        out << "]}";
+        if (!out.good()) return;
+    }
+    std::filesystem::rename(tmp, final_path, ec);
+}
+
+bool embed_cache_get(const std::string& key, size_t dim, EmbedResult* r) {
+    if (embed_cache_cap() == 0) return false;
+    {
+        std::lock_guard<std::mutex> lk(g_embed_cache_mu);
+        auto it = g_embed_cache.find(key);
+        if (it != g_embed_cache.end()) {
+            g_embed_cache_lru.splice(g_embed_cache_lru.begin(), g_embed_cache_lru,
+                                     it->second.lru_it);
+            *r = it->second.result;
+            return true;
+        }
+    }
+    if (!embed_cache_persist()) return false;
+    std::ifstream in(embed_cache_dir() / (key + ".json"));
+    if (!in.good()) return false;
+    std::string js((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EmbedResult tmp;
+    if (!parse_single_response(js, dim, &tmp)) return false;
+    embed_cache_put_mem(key, tmp);  // promote to the memory tier
+    *r = tmp;
+    return true;
+}
+
+} // namespace
+
+#ifndef _WIN32
+// ---------------------------------------------------------------------------
+// Persistent sidecar (MACHINA_EMBED_PERSIST=1): the embed command is spawned
+// once and kept alive, speaking one JSON line per request/response over its
+// stdin/stdout like the toolhost --serve protocol. A warm model process
+// answers in milliseconds where a cold spawn pays interpreter and model load
+// on every call. The child's stderr stays attached to ours so provider logs
+// cannot corrupt the protocol stream. Any failure (dead child, timeout,
+// garbage line) falls back to the one-shot subprocess path below.
+
+namespace {
+
+struct EmbedSidecar {
+    pid_t pid{-1};
+    int in_fd{-1};   // our write end -> child stdin
+    int out_fd{-1};  // our read end  <- child stdout
+    std::string cmd; // command line the child was spawned from
+    std::string buf; // bytes read past the last complete response line
+};
+
+std::mutex g_sidecar_mu;
+EmbedSidecar g_sidecar;
+
+bool sidecar_enabled() {
+    const char* e = std::getenv("MACHINA_EMBED_PERSIST");
+    return e && (std::string(e) == "1" || std::string(e) == "true");
+}
+
+void sidecar_stop_locked() {
+    if (g_sidecar.in_fd >= 0) close(g_sidecar.in_fd);
+    if (g_sidecar.out_fd >= 0) close(g_sidecar.out_fd);
+    if (g_sidecar.pid > 0) {
+        (void)kill(g_sidecar.pid, SIGKILL);
+        (void)waitpid(g_sidecar.pid, nullptr, 0);
+    }
+    g_sidecar = EmbedSidecar{};
+}
+
+bool sidecar_start_locked(const std::string& cmd) {
+    sidecar_stop_locked();
+
+    std::vector<std::string> argv = split_argv_quoted(cmd);
+    if (argv.empty()) return false;
+
+    // Writes to a dead child must surface as EPIPE, not kill the process.
+    (void)signal(SIGPIPE, SIG_IGN);
+
+    int in_pipe[2], out_pipe[2];
+    if (pipe(in_pipe) != 0) return false;
+    if (pipe(out_pipe) != 0) {
+        close(in_pipe[0]); close(in_pipe[1]);
+        return false;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(in_pipe[0]); close(in_pipe[1]);
+        close(out_pipe[0]); close(out_pipe[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        // child
+        (void)dup2(in_pipe[0], STDIN_FILENO);
+        (void)dup2(out_pipe[1], STDOUT_FILENO);
+        // stderr stays inherited: logs bypass the protocol stream.
+        close(in_pipe[0]); close(in_pipe[1]);
+        close(out_pipe[0]); close(out_pipe[1]);
+
+        (void)setpgid(0, 0);
+
+        long maxfd = sysconf(_SC_OPEN_MAX);
+        if (maxfd < 256) maxfd = 256;
+        for (int fd = 3; fd < maxfd; fd++) (void)close(fd);
+
+        unsetenv("LD_PRELOAD");
+        unsetenv("LD_LIBRARY_PATH");
+
+#ifdef __linux__
+        (void)prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+        (void)prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+
+        // Memory cap follows the one-shot limits; no CPU rlimit because the
+        // whole point is a process that lives for the run.
+        ProcLimits lim = make_embed_limits();
+        if (lim.rlimit_as_mb > 0) {
+            struct rlimit rl;
+            rl.rlim_cur = rl.rlim_max = (rlim_t)lim.rlimit_as_mb * 1024ULL * 1024ULL;
+            (void)setrlimit(RLIMIT_AS, &rl);
+        }
+
+        std::vector<char*> cargv;
+        cargv.reserve(argv.size() + 1);
+        for (const auto& s : argv) cargv.push_back(const_cast<char*>(s.c_str()));
+        cargv.push_back(nullptr);
+        execvp(cargv[0], cargv.data());
+        _exit(127);
+    }
+
+    // parent
+    (void)setpgid(pid, pid);
+    close(in_pipe[0]);
+    close(out_pipe[1]);
+    g_sidecar.pid = pid;
+    g_sidecar.in_fd = in_pipe[1];
+    g_sidecar.out_fd = out_pipe[0];
+    g_sidecar.cmd = cmd;
+    return true;
+}
+
+// One request line out, one response line back. Returns false when the child
+// looks unhealthy (broken pipe, EOF, timeout); the caller decides on restart.
+bool sidecar_roundtrip_locked(const std::string& req, int timeout_ms, std::string* line) {
+    std::string payload = req;
+    payload.push_back('\n');
+    size_t off = 0;
+    while (off < payload.size()) {
+        ssize_t n = write(g_sidecar.in_fd, payload.data() + off, payload.size() - off);
+        if (n > 0) { off += (size_t)n; continue; }
+        if (n == -1 && errno == EINTR) continue;
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        auto nl = g_sidecar.buf.find('\n');
+        if (nl != std::string::npos) {
+            *line = g_sidecar.buf.substr(0, nl);
+            g_sidecar.buf.erase(0, nl + 1);
+            return true;
+        }
+
+        int elapsed_ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        if (timeout_ms > 0 && elapsed_ms >= timeout_ms) return false;
+
+        struct pollfd pfd;
+        pfd.fd = g_sidecar.out_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int slice = 100;
+        if (timeout_ms > 0) slice = std::min(slice, timeout_ms - elapsed_ms);
+        int pr = poll(&pfd, 1, slice);
+        if (pr < 0 && errno == EINTR) continue;
+        if (pr <= 0) continue;
+
+        char buf[4096];
+        ssize_t n = read(g_sidecar.out_fd, buf, sizeof(buf));
+        if (n > 0) { g_sidecar.buf.append(buf, buf + (size_t)n); continue; }
+        if (n == -1 && errno == EINTR) continue;
+        return false; // EOF or read error: the child is gone
+    }
+}
+
+// Sends one request to the warm child, restarting it once if it has died or
+// stalled. Returns false when even a fresh child cannot answer.
+bool sidecar_request(const std::string& cmd, const std::string& req, std::string* line) {
+    std::lock_guard<std::mutex> lk(g_sidecar_mu);
+    int timeout_ms = getenv_int("MACHINA_EMBED_TIMEOUT_MS", 5000);
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        // Reap a child that exited between calls so we restart instead of
+        // writing into a broken pipe.
+        if (g_sidecar.pid > 0 &&
+            waitpid(g_sidecar.pid, nullptr, WNOHANG) == g_sidecar.pid) {
+            if (g_sidecar.in_fd >= 0) close(g_sidecar.in_fd);
+            if (g_sidecar.out_fd >= 0) close(g_sidecar.out_fd);
+            g_sidecar = EmbedSidecar{};
+        }
+        if (g_sidecar.pid <= 0 || g_sidecar.cmd != cmd) {
+            if (!sidecar_start_locked(cmd)) return false;
+        }
+        // A stale partial line can only belong to a call that already failed.
+        g_sidecar.buf.clear();
+
+        if (sidecar_roundtrip_locked(req, timeout_ms, line)) return true;
+        sidecar_stop_locked();
+    }
+    return false;
+}
+
+} // namespace
+#endif // !_WIN32
+
 EmbedResult embed_text_best_effort(const std::string& text, size_t dim) {
     EmbedResult r;
     if (dim == 0) {
@@ -104,34 +495,39 @@ EmbedResult embed_text_best_effort(const std::string& text, size_t dim) {
     if (provider == "cmd") {
         std::string cmd = getenv_str("MACHINA_EMBED_CMD", "");
         if (!cmd.empty()) {
-            ProcLimits lim = make_embed_limits();
+            std::string ck = embed_cache_key(text, dim);
+            if (embed_cache_get(ck, dim, &r)) return r;
+
+            std::ostringstream in;
+            in << "{";
+            in << "\"text\":\"" << json_mini::json_escape(text) << "\",";
+            in << "\"dim\":" << dim;
+            in << "}";
+
+#ifndef _WIN32
+            // Warm sidecar first; any failure falls through to a cold spawn.
+            if (sidecar_enabled()) {
+                std::string js;
+                if (sidecar_request(cmd, in.str(), &js) &&
+                    parse_single_response(js, dim, &r)) {
+                    embed_cache_put(ck, r);
+                    return r;
+                }
+            }
+#endif
 
+            ProcLimits lim = make_embed_limits();
             std::vector<std::string> argv = split_argv_quoted(cmd);
             if (!argv.empty()) {
-                std::ostringstream in;
-                in << "{";
-                in << "\"text\":\"" << json_mini::json_escape(text) << "\",";
-                in << "\"dim\":" << dim;
-                in << "}";
-
                 ProcResult pr;
                 bool ok = proc_run_capture_sandboxed_stdin(argv, "", in.str(), lim, &pr);
 
                 if (ok && pr.exit_code == 0) {
                     std::string js = extract_json_object_best_effort(pr.output);
                     if (js.empty()) js = pr.output;
-
-                    auto emb_raw = json_mini::get_array_raw(js, "embedding");
-                    if (emb_raw) {
-                        auto vals = json_mini::parse_array_numbers(*emb_raw);
-                        if (!vals.empty()) {
-                            r.embedding.resize(dim, 0.0f);
-                            size_t n = vals.size();
-                            if (n > dim) n = dim;
-                            for (size_t i = 0; i < n; i++) r.embedding[i] = (float)vals[i];
-                            r.provider = json_mini::get_string(js, "provider").value_or("cmd");
-                            return r;
-                        }
+                    if (parse_single_response(js, dim, &r)) {
+                        embed_cache_put(ck, r);
+                        return r;
                     }
                     r.error = "embed cmd returned no/invalid embedding";
                 } else {
@@ -161,6 +557,168 @@ EmbedResult embed_text_best_effort(const std::string& text, size_t dim) {
     return r;
 }
 
+// Streams a large batch through the provider without materializing either the
+// full request or the full reply: texts are written to the child's stdin in
+// small chunks while inner embedding arrays are parsed off its stdout the
+// moment they close, so batch size is bounded by neither the stdin buffer nor
+// stdout_max_bytes. Returns false when the child failed outright and the
+// caller should retry via the buffered path.
+static bool embed_texts_batch_streamed(const std::vector<std::string>& texts, size_t dim,
+                                       const std::vector<std::string>& argv,
+                                       std::vector<EmbedResult>* results) {
+    ProcLimits lim = make_embed_limits();
+    // Streamed batches are meant for tens of thousands of texts; scale the
+    // wall and CPU budgets with the batch instead of the per-call defaults.
+    int per_text_ms = getenv_int("MACHINA_EMBED_STREAM_MS_PER_TEXT", 50);
+    lim.timeout_ms = std::max(lim.timeout_ms, (int)std::min<size_t>(texts.size() * (size_t)per_text_ms,
+                                                                    (size_t)600000));
+    lim.rlimit_cpu_sec = std::max(lim.rlimit_cpu_sec, (lim.timeout_ms + 999) / 1000);
+
+    // stdin generator: header, then a few escaped texts per chunk, then trailer.
+    size_t wi = 0;
+    int wstate = 0;  // 0=header, 1=texts, 2=trailer, 3=done
+    auto writer = [&](std::string* chunk) -> bool {
+        switch (wstate) {
+        case 0:
+            *chunk = "{\"texts\":[";
+            wstate = texts.empty() ? 2 : 1;
+            return true;
+        case 1: {
+            std::ostringstream o;
+            for (int k = 0; k < 64 && wi < texts.size(); k++, wi++) {
+                if (wi) o << ",";
+                o << "\"" << json_mini::json_escape(texts[wi]) << "\"";
+            }
+            *chunk = o.str();
+            if (wi >= texts.size()) wstate = 2;
+            return true;
+        }
+        case 2:
+            *chunk = "],\"dim\":" + std::to_string(dim) + "}";
+            wstate = 3;
+            return true;
+        default:
+            return false;
+        }
+    };
+
+    // stdout parser: bracket depth outside strings, inner arrays live at
+    // depth 2. Bytes outside the arrays (provider field, log noise) go to a
+    // small bounded side buffer scanned for "provider" afterwards.
+    size_t ri = 0;
+    std::string cur;
+    std::string outer;
+    int depth = 0;
+    bool in_str = false, esc = false;
+    auto on_out = [&](const char* b, size_t n) {
+        for (size_t p = 0; p < n; p++) {
+            char c = b[p];
+            if (in_str) {
+                if (esc) esc = false;
+                else if (c == '\\') esc = true;
+                else if (c == '"') in_str = false;
+            } else if (c == '"') {
+                in_str = true;
+            } else if (c == '[') {
+                depth++;
+                if (depth >= 2) cur.push_back(c);
+                continue;
+            } else if (c == ']') {
+                if (depth >= 2) cur.push_back(c);
+                depth--;
+                if (depth == 1) {
+                    if (ri < results->size()) {
+                        auto vals = json_mini::parse_array_numbers(cur);
+                        if (!vals.empty()) {
+                            (*results)[ri].embedding.assign(dim, 0.0f);
+                            size_t nv = std::min(vals.size(), dim);
+                            for (size_t j = 0; j < nv; j++) {
+                                (*results)[ri].embedding[j] = (float)vals[j];
+                            }
+                        }
+                        ri++;
+                    }
+                    cur.clear();
+                }
+                continue;
+            }
+            if (depth >= 2) cur.push_back(c);
+            else if (outer.size() < 8192) outer.push_back(c);
+        }
+    };
+
+    ProcResult pr;
+    bool ok = proc_run_stream_sandboxed(argv, "", writer, on_out, lim, &pr);
+    if (!ok || pr.exit_code != 0 || ri == 0) return false;
+
+    std::string prov = json_mini::get_string(outer, "provider").value_or("cmd");
+    for (size_t i = 0; i < texts.size(); i++) {
+        if (i < ri && !(*results)[i].embedding.empty()) {
+            (*results)[i].provider = prov;
+        } else {
+            (*results)[i].provider = "cmd_fallback_hash";
+            (*results)[i].embedding = hash_embedding(texts[i], dim);
+        }
+    }
+    return true;
+}
+
+// Runs one cmd-provider batch call (sidecar or cold spawn) for texts that
+// missed the cache. Returns one result per text, hash-filling failures.
+static std::vector<EmbedResult> embed_texts_batch_cmd(const std::vector<std::string>& texts,
+                                                      size_t dim, const std::string& cmd,
+                                                      const std::vector<std::string>& argv) {
+    std::vector<EmbedResult> results(texts.size());
+
+    // Big batches stream through the child instead of buffering both sides;
+    // MACHINA_EMBED_STREAM_MIN sets the cutover (0 disables streaming).
+    int stream_min = getenv_int("MACHINA_EMBED_STREAM_MIN", 1024);
+    if (stream_min > 0 && texts.size() >= (size_t)stream_min) {
+        if (embed_texts_batch_streamed(texts, dim, argv, &results)) return results;
+        results.assign(texts.size(), EmbedResult{});
+    }
+
+    // Build batch JSON: {"texts":["a","b",...], "dim":384}
+    std::ostringstream in;
+    in << "{\"texts\":[";
+    for (size_t i = 0; i < texts.size(); i++) {
+        if (i > 0) in << ",";
+        in << "\"" << json_mini::json_escape(texts[i]) << "\"";
+    }
+    in << "],\"dim\":" << dim << "}";
+
+#ifndef _WIN32
+    // Warm sidecar first; any failure falls through to a cold spawn.
+    if (sidecar_enabled()) {
+        std::string js;
+        if (sidecar_request(cmd, in.str(), &js) &&
+            parse_batch_response(js, texts, dim, &results)) {
+            return results;
+        }
+    }
+#endif
+
+    ProcLimits lim = make_embed_limits();
+    // Batch needs more stdout space: ~10KB per embedding × N.
+    lim.stdout_max_bytes = std::max(lim.stdout_max_bytes, texts.size() * 16 * 1024);
+
+    ProcResult pr;
+    bool ok = proc_run_capture_sandboxed_stdin(argv, "", in.str(), lim, &pr);
+
+    if (ok && pr.exit_code == 0) {
+        std::string js = extract_json_object_best_effort(pr.output);
+        if (js.empty()) js = pr.output;
+        if (parse_batch_response(js, texts, dim, &results)) return results;
+    }
+
+    // Batch failed — fall back to hash for all.
+    for (size_t i = 0; i < texts.size(); i++) {
+        results[i].provider = "cmd_fallback_hash";
+        results[i].embedding = hash_embedding(texts[i], dim);
+    }
+    return results;
+}
+
 std::vector<EmbedResult> embed_texts_batch(const std::vector<std::string>& texts, size_t dim) {
     std::vector<EmbedResult> results(texts.size());
     if (texts.empty() || dim == 0) return results;
@@ -194,77 +752,23 @@ std::vector<EmbedResult> embed_texts_batch(const std::vector<std::string>& texts
         return results;
     }
 
-    ProcLimits lim = make_embed_limits();
-    // Batch needs more stdout space: ~10KB per embedding × N.
-    lim.stdout_max_bytes = std::max(lim.stdout_max_bytes, texts.size() * 16 * 1024);
-
-    // Build batch JSON: {"texts":["a","b",...], "dim":384}
-    std::ostringstream in;
-    in << "{\"texts\":[";
+    // Serve repeats from the cache and only embed the misses.
+    std::vector<std::string> keys(texts.size());
+    std::vector<size_t> miss;
+    std::vector<std::string> miss_texts;
     for (size_t i = 0; i < texts.size(); i++) {
-        if (i > 0) in << ",";
-        in << "\"" << json_mini::json_escape(texts[i]) << "\"";
-    }
-    in << "],\"dim\":" << dim << "}";
-
-    ProcResult pr;
-    bool ok = proc_run_capture_sandboxed_stdin(argv, "", in.str(), lim, &pr);
-
-    if (ok && pr.exit_code == 0) {
-        std::string js = extract_json_object_best_effort(pr.output);
-        if (js.empty()) js = pr.output;
-
-        // Parse: {"embeddings":[[...],[...],...], "provider":"..."}
-        auto embs_raw = json_mini::get_array_raw(js, "embeddings");
-        std::string prov = json_mini::get_string(js, "provider").value_or("cmd");
-
-        if (embs_raw) {
-            // Parse array of arrays: get_array_raw returns "[[...],[...],...]"
-            // (outer brackets included). Track bracket depth; inner arrays
-            // start/end at depth 1→2→1.
-            const std::string& arr = *embs_raw;
-            std::vector<std::string> sub_arrays;
-            int depth = 0;
-            size_t start = 0;
-            for (size_t p = 0; p < arr.size(); p++) {
-                char c = arr[p];
-                if (c == '[') {
-                    if (depth == 1) start = p;  // inner array start
-                    depth++;
-                } else if (c == ']') {
-                    depth--;
-                    if (depth == 1) {  // inner array end
-                        // Keep brackets — parse_array_numbers expects "[...]".
-                        sub_arrays.push_back(arr.substr(start, p - start + 1));
-                    }
-                }
-            }
-
-            for (size_t i = 0; i < std::min(sub_arrays.size(), texts.size()); i++) {
-                auto vals = json_mini::parse_array_numbers(sub_arrays[i]);
-                if (!vals.empty()) {
-                    results[i].embedding.resize(dim, 0.0f);
-                    size_t n = std::min(vals.size(), dim);
-                    for (size_t j = 0; j < n; j++) results[i].embedding[j] = (float)vals[j];
-                    results[i].provider = prov;
-                } else {
-                    results[i].provider = "cmd_fallback_hash";
-                    results[i].embedding = hash_embedding(texts[i], dim);
-                }
-            }
-            // Fill remaining (if subprocess returned fewer than requested).
-            for (size_t i = sub_arrays.size(); i < texts.size(); i++) {
-                results[i].provider = "cmd_fallback_hash";
-                results[i].embedding = hash_embedding(texts[i], dim);
-            }
-            return results;
+        keys[i] = embed_cache_key(texts[i], dim);
+        if (!embed_cache_get(keys[i], dim, &results[i])) {
+            miss.push_back(i);
+            miss_texts.push_back(texts[i]);
         }
     }
+    if (miss.empty()) return results;
 
-    // Batch failed — fall back to hash for all.
-    for (size_t i = 0; i < texts.size(); i++) {
-        results[i].provider = "cmd_fallback_hash";
-        results[i].embedding = hash_embedding(texts[i], dim);
+    auto miss_results = embed_texts_batch_cmd(miss_texts, dim, cmd, argv);
+    for (size_t m = 0; m < miss.size(); m++) {
+        results[miss[m]] = std::move(miss_results[m]);
+        embed_cache_put(keys[miss[m]], results[miss[m]]);
     }
     return results;
 }
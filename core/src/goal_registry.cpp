@@ -1,5 +1,6 @@
 #include "machina/goal_registry.h"
 #include "machina/json_mini.h"
+#include "machina/manifest_cache.h"
 
 #include <algorithm>
 #include <fstream>
@@ -15,10 +16,26 @@ void GoalRegistry::loadGoalPackManifest(const std::string& path) {
     ss << f.rdbuf();
     std::string json = ss.str();
 
+    // Fast path: goal descriptors cached from an earlier parse of these
+    // exact bytes (see manifest_cache.h).
+    std::string cache_key;
+    if (manifest_cache::enabled()) {
+        cache_key = manifest_cache::content_key(json);
+        std::vector<GoalDesc> cached;
+        if (manifest_cache::load_goaldescs(cache_key, &cached) && !cached.empty()) {
+            for (auto& g : cached) {
+                goals_[g.goal_id] = std::move(g);
+            }
+            generation_++;
+            return;
+        }
+    }
+
     auto goals_raw = json_mini::get_array_raw(json, "goals");
     if (!goals_raw) return;
 
     auto goal_objs = json_mini::parse_array_objects_raw(*goals_raw);
+    std::vector<GoalDesc> parsed;
     for (const auto& gj : goal_objs) {
         GoalDesc desc;
         desc.goal_id = json_mini::get_string(gj, "goal_id").value_or("");
@@ -39,7 +56,13 @@ void GoalRegistry::loadGoalPackManifest(const std::string& path) {
 
         desc.any_slot_sufficient = json_mini::get_bool(gj, "any_slot_sufficient").value_or(false);
 
+        parsed.push_back(desc);
         goals_[desc.goal_id] = std::move(desc);
+        generation_++;
+    }
+
+    if (!cache_key.empty() && !parsed.empty()) {
+        manifest_cache::save_goaldescs(cache_key, parsed);
     }
 }
 
@@ -50,6 +73,7 @@ void GoalRegistry::registerGoal(const GoalDesc& desc, bool allow_override) {
         throw std::runtime_error("GoalRegistry: duplicate goal_id: " + desc.goal_id);
     }
     goals_[desc.goal_id] = desc;
+    generation_++;
 }
 
 const GoalDesc* GoalRegistry::getGoal(const std::string& goal_id) const {
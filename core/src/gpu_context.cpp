@@ -45,4 +45,9 @@ GpuContext GpuContext::create() {
     return ctx;
 }
 
+GpuContext& GpuContext::shared() {
+    static GpuContext ctx = create();
+    return ctx;
+}
+
 } // namespace machina
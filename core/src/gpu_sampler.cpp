@@ -0,0 +1,266 @@
+#include "machina/gpu_sampler.h"
+
+#include "machina/gpu_context.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace machina {
+
+namespace {
+
+constexpr uint64_t kMagic = 0x316d68737570676dULL; // "mgpushm1"
+
+struct Shm {
+    uint64_t magic{0};
+    uint32_t seq{0}; // seqlock: odd while a write is in flight
+    uint32_t pad{0};
+    GpuSnapshot snap{};
+};
+
+// Maps (creating on first use) the shared snapshot; heap fallback keeps
+// everything working process-locally, mirroring the breaker table.
+Shm* shm() {
+    static Shm* s = [] {
+#ifndef _WIN32
+        std::filesystem::path p;
+        if (const char* root = std::getenv("MACHINA_ROOT")) {
+            std::error_code ec;
+            auto dir = std::filesystem::path(root) / "work";
+            std::filesystem::create_directories(dir, ec);
+            if (!ec) p = dir / "gpu_metrics.shm";
+        }
+        if (p.empty()) {
+            std::error_code ec;
+            p = std::filesystem::temp_directory_path(ec) / "machina_gpu_metrics.shm";
+            if (ec) p.clear();
+        }
+        if (!p.empty()) {
+            int fd = ::open(p.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd >= 0) {
+                size_t len = sizeof(Shm);
+                struct stat st{};
+                bool sized = ::fstat(fd, &st) == 0 &&
+                             ((size_t)st.st_size == len || ::ftruncate(fd, (off_t)len) == 0);
+                if (sized) {
+                    void* m = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                    if (m != MAP_FAILED) {
+                        ::close(fd);
+                        auto* hdr = (Shm*)m;
+                        uint64_t expect = 0;
+                        if (!std::atomic_ref<uint64_t>(hdr->magic)
+                                 .compare_exchange_strong(expect, kMagic,
+                                                          std::memory_order_acq_rel) &&
+                            expect != kMagic) {
+                            std::memset(m, 0, len);
+                            std::atomic_ref<uint64_t>(hdr->magic)
+                                .store(kMagic, std::memory_order_release);
+                        }
+                        return hdr;
+                    }
+                }
+                ::close(fd);
+            }
+        }
+#endif
+        return new Shm();
+    }();
+    return s;
+}
+
+int64_t now_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+void set_str(char* dst, size_t cap, const char* src) {
+    std::strncpy(dst, src, cap - 1);
+    dst[cap - 1] = '\0';
+}
+
+#ifndef _WIN32
+// Persistent NVML session: dlopen + nvmlInit once per process, queries per
+// sample. The library stays loaded for the process lifetime (same policy
+// as every other latched runtime dependency here).
+struct Nvml {
+    using nvmlReturn_t = int;
+    using nvmlDevice_t = struct nvmlDevice_st*;
+    struct nvmlMemory_t {
+        unsigned long long total;
+        unsigned long long free;
+        unsigned long long used;
+    };
+
+    nvmlReturn_t (*init)(){nullptr};
+    nvmlReturn_t (*device_count)(unsigned int*){nullptr};
+    nvmlReturn_t (*handle_by_index)(unsigned int, nvmlDevice_t*){nullptr};
+    nvmlReturn_t (*get_name)(nvmlDevice_t, char*, unsigned int){nullptr};
+    nvmlReturn_t (*get_memory)(nvmlDevice_t, nvmlMemory_t*){nullptr};
+    nvmlReturn_t (*get_temp)(nvmlDevice_t, unsigned int, unsigned int*){nullptr};
+    nvmlReturn_t (*get_power)(nvmlDevice_t, unsigned int*){nullptr};
+    const char* status{"NVML_UNAVAILABLE"};
+    bool ready{false};
+};
+
+const Nvml& nvml() {
+    static Nvml n = [] {
+        Nvml v;
+        void* h = dlopen("libnvidia-ml.so.1", RTLD_NOW | RTLD_LOCAL);
+        if (!h) h = dlopen("libnvidia-ml.so", RTLD_NOW | RTLD_LOCAL);
+        if (!h) return v;
+        v.init = (Nvml::nvmlReturn_t(*)())dlsym(h, "nvmlInit_v2");
+        v.device_count = (Nvml::nvmlReturn_t(*)(unsigned int*))dlsym(h, "nvmlDeviceGetCount_v2");
+        v.handle_by_index = (Nvml::nvmlReturn_t(*)(unsigned int, Nvml::nvmlDevice_t*))
+            dlsym(h, "nvmlDeviceGetHandleByIndex_v2");
+        v.get_name = (Nvml::nvmlReturn_t(*)(Nvml::nvmlDevice_t, char*, unsigned int))
+            dlsym(h, "nvmlDeviceGetName");
+        v.get_memory = (Nvml::nvmlReturn_t(*)(Nvml::nvmlDevice_t, Nvml::nvmlMemory_t*))
+            dlsym(h, "nvmlDeviceGetMemoryInfo");
+        v.get_temp = (Nvml::nvmlReturn_t(*)(Nvml::nvmlDevice_t, unsigned int, unsigned int*))
+            dlsym(h, "nvmlDeviceGetTemperature");
+        v.get_power = (Nvml::nvmlReturn_t(*)(Nvml::nvmlDevice_t, unsigned int*))
+            dlsym(h, "nvmlDeviceGetPowerUsage");
+        if (!(v.init && v.device_count && v.handle_by_index && v.get_memory &&
+              v.get_temp && v.get_power)) {
+            v.status = "NVML_PARTIAL";
+            return v;
+        }
+        if (v.init() != 0) {
+            v.status = "NVML_INIT_FAIL";
+            return v;
+        }
+        v.status = "NVML";
+        v.ready = true;
+        return v;
+    }();
+    return n;
+}
+#endif
+
+std::mutex g_sampler_mu;
+std::thread g_sampler;
+std::condition_variable g_sampler_cv;
+bool g_sampler_stop = false;
+
+} // namespace
+
+void gpu_sample_direct(GpuSnapshot* out) {
+    *out = GpuSnapshot{};
+    out->sample_ms = now_ms();
+    GpuContext& ctx = GpuContext::shared();
+    out->device_count = ctx.device_count();
+    out->device_index = ctx.device_index();
+
+#ifdef _WIN32
+    set_str(out->backend, sizeof(out->backend), "WIN_UNSUPPORTED");
+#else
+    const Nvml& n = nvml();
+    set_str(out->backend, sizeof(out->backend), n.status);
+    if (!n.ready) return;
+
+    unsigned int count = 0;
+    int rc = n.device_count(&count);
+    out->device_count = (int32_t)count;
+
+    unsigned int idx = 0;
+    if (ctx.device_index() >= 0) idx = (unsigned int)ctx.device_index();
+    out->device_index = (int32_t)idx;
+
+    Nvml::nvmlDevice_t dev = nullptr;
+    if (rc == 0) rc = n.handle_by_index(idx, &dev);
+    if (rc != 0 || !dev) return;
+
+    Nvml::nvmlMemory_t mem{};
+    unsigned int temp = 0, power_mw = 0;
+    char name[96];
+    name[0] = '\0';
+    (void)n.get_memory(dev, &mem);
+    (void)n.get_temp(dev, 0u /*NVML_TEMPERATURE_GPU*/, &temp);
+    (void)n.get_power(dev, &power_mw);
+    if (n.get_name) (void)n.get_name(dev, name, sizeof(name));
+
+    out->available = 1;
+    out->temp_c = temp;
+    out->power_mw = power_mw;
+    out->memory_total_mb = mem.total / (1024ULL * 1024ULL);
+    out->memory_used_mb = mem.used / (1024ULL * 1024ULL);
+    out->memory_free_mb = mem.free / (1024ULL * 1024ULL);
+    set_str(out->name, sizeof(out->name), name);
+#endif
+}
+
+void gpu_snapshot_publish(const GpuSnapshot& s) {
+    Shm* m = shm();
+    std::atomic_ref<uint32_t> seq(m->seq);
+    uint32_t v = seq.load(std::memory_order_relaxed);
+    seq.store(v + 1, std::memory_order_release); // odd: write in flight
+    std::atomic_thread_fence(std::memory_order_release);
+    m->snap = s;
+    std::atomic_thread_fence(std::memory_order_release);
+    seq.store(v + 2, std::memory_order_release);
+}
+
+bool gpu_snapshot_read(GpuSnapshot* out) {
+    Shm* m = shm();
+    std::atomic_ref<uint32_t> seq(m->seq);
+    for (int attempt = 0; attempt < 4; attempt++) {
+        uint32_t s1 = seq.load(std::memory_order_acquire);
+        if (s1 == 0 || (s1 & 1u)) continue;
+        *out = m->snap;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t s2 = seq.load(std::memory_order_acquire);
+        if (s1 == s2) return out->sample_ms != 0;
+    }
+    return false;
+}
+
+bool gpu_snapshot_fresh(const GpuSnapshot& s, int64_t now, int64_t max_age_ms) {
+    return s.sample_ms != 0 && now >= s.sample_ms && (now - s.sample_ms) <= max_age_ms;
+}
+
+void gpu_sampler_start(int interval_ms) {
+    if (interval_ms <= 0) return;
+    std::lock_guard<std::mutex> lk(g_sampler_mu);
+    if (g_sampler.joinable()) return;
+    g_sampler_stop = false;
+    g_sampler = std::thread([interval_ms]() {
+        for (;;) {
+            GpuSnapshot s;
+            gpu_sample_direct(&s);
+            gpu_snapshot_publish(s);
+            std::unique_lock<std::mutex> wait_lk(g_sampler_mu);
+            if (g_sampler_cv.wait_for(wait_lk, std::chrono::milliseconds(interval_ms),
+                                      []() { return g_sampler_stop; })) {
+                return;
+            }
+        }
+    });
+}
+
+void gpu_sampler_stop() {
+    std::thread t;
+    {
+        std::lock_guard<std::mutex> lk(g_sampler_mu);
+        if (!g_sampler.joinable()) return;
+        g_sampler_stop = true;
+        t = std::move(g_sampler);
+    }
+    g_sampler_cv.notify_all();
+    t.join();
+}
+
+} // namespace machina
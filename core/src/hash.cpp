@@ -2,6 +2,15 @@
 
 #include <cstring>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
 namespace machina::hash {
 
 namespace detail {
@@ -42,8 +51,275 @@ static void process_block(const uint8_t block[64], uint32_t H[8]) {
     }
     H[0]+=a; H[1]+=b; H[2]+=c; H[3]+=d; H[4]+=e; H[5]+=f; H[6]+=g; H[7]+=h;
 }
+
+static void compress_scalar(uint32_t H[8], const uint8_t* blocks, size_t nblocks) {
+    for (size_t i = 0; i < nblocks; i++) process_block(blocks + i * 64, H);
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+
+static bool cpu_has_shani() {
+    // SHA extensions: CPUID.(EAX=7,ECX=0):EBX bit 29. Not exposed through
+    // __builtin_cpu_supports on all toolchains, so query cpuid directly.
+    unsigned a = 0, b = 0, c = 0, d = 0;
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return false;
+    return (b & (1u << 29)) != 0 && __builtin_cpu_supports("sse4.1");
+}
+
+// Intel SHA-NI two-rounds-per-instruction kernel. The STATE0/STATE1
+// registers hold the working variables in the ABEF/CDGH layout the
+// sha256rnds2 instruction expects.
+__attribute__((target("sha,sse4.1")))
+static void compress_shani(uint32_t H[8], const uint8_t* blocks, size_t nblocks) {
+    const __m128i MASK = _mm_set_epi64x((int64_t)0x0c0d0e0f08090a0bULL,
+                                        (int64_t)0x0405060700010203ULL);
+
+    __m128i TMP = _mm_loadu_si128((const __m128i*)&H[0]);
+    __m128i STATE1 = _mm_loadu_si128((const __m128i*)&H[4]);
+    TMP = _mm_shuffle_epi32(TMP, 0xB1);       // CDAB
+    STATE1 = _mm_shuffle_epi32(STATE1, 0x1B); // EFGH
+    __m128i STATE0 = _mm_alignr_epi8(TMP, STATE1, 8);  // ABEF
+    STATE1 = _mm_blend_epi16(STATE1, TMP, 0xF0);       // CDGH
+
+    while (nblocks--) {
+        const __m128i ABEF_SAVE = STATE0;
+        const __m128i CDGH_SAVE = STATE1;
+        __m128i MSG, TMSG0, TMSG1, TMSG2, TMSG3;
+
+        // Rounds 0-3
+        MSG = _mm_loadu_si128((const __m128i*)(blocks + 0));
+        TMSG0 = _mm_shuffle_epi8(MSG, MASK);
+        MSG = _mm_add_epi32(TMSG0, _mm_set_epi64x((int64_t)0xE9B5DBA5B5C0FBCFULL, (int64_t)0x71374491428A2F98ULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+
+        // Rounds 4-7
+        TMSG1 = _mm_loadu_si128((const __m128i*)(blocks + 16));
+        TMSG1 = _mm_shuffle_epi8(TMSG1, MASK);
+        MSG = _mm_add_epi32(TMSG1, _mm_set_epi64x((int64_t)0xAB1C5ED5923F82A4ULL, (int64_t)0x59F111F13956C25BULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+        TMSG0 = _mm_sha256msg1_epu32(TMSG0, TMSG1);
+
+        // Rounds 8-11
+        TMSG2 = _mm_loadu_si128((const __m128i*)(blocks + 32));
+        TMSG2 = _mm_shuffle_epi8(TMSG2, MASK);
+        MSG = _mm_add_epi32(TMSG2, _mm_set_epi64x((int64_t)0x550C7DC3243185BEULL, (int64_t)0x12835B01D807AA98ULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+        TMSG1 = _mm_sha256msg1_epu32(TMSG1, TMSG2);
+
+        // Rounds 12-15
+        TMSG3 = _mm_loadu_si128((const __m128i*)(blocks + 48));
+        TMSG3 = _mm_shuffle_epi8(TMSG3, MASK);
+        MSG = _mm_add_epi32(TMSG3, _mm_set_epi64x((int64_t)0xC19BF1749BDC06A7ULL, (int64_t)0x80DEB1FE72BE5D74ULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        TMP = _mm_alignr_epi8(TMSG3, TMSG2, 4);
+        TMSG0 = _mm_add_epi32(TMSG0, TMP);
+        TMSG0 = _mm_sha256msg2_epu32(TMSG0, TMSG3);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+        TMSG2 = _mm_sha256msg1_epu32(TMSG2, TMSG3);
+
+        // Rounds 16-19
+        MSG = _mm_add_epi32(TMSG0, _mm_set_epi64x((int64_t)0x240CA1CC0FC19DC6ULL, (int64_t)0xEFBE4786E49B69C1ULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        TMP = _mm_alignr_epi8(TMSG0, TMSG3, 4);
+        TMSG1 = _mm_add_epi32(TMSG1, TMP);
+        TMSG1 = _mm_sha256msg2_epu32(TMSG1, TMSG0);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+        TMSG3 = _mm_sha256msg1_epu32(TMSG3, TMSG0);
+
+        // Rounds 20-23
+        MSG = _mm_add_epi32(TMSG1, _mm_set_epi64x((int64_t)0x76F988DA5CB0A9DCULL, (int64_t)0x4A7484AA2DE92C6FULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        TMP = _mm_alignr_epi8(TMSG1, TMSG0, 4);
+        TMSG2 = _mm_add_epi32(TMSG2, TMP);
+        TMSG2 = _mm_sha256msg2_epu32(TMSG2, TMSG1);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+        TMSG0 = _mm_sha256msg1_epu32(TMSG0, TMSG1);
+
+        // Rounds 24-27
+        MSG = _mm_add_epi32(TMSG2, _mm_set_epi64x((int64_t)0xBF597FC7B00327C8ULL, (int64_t)0xA831C66D983E5152ULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        TMP = _mm_alignr_epi8(TMSG2, TMSG1, 4);
+        TMSG3 = _mm_add_epi32(TMSG3, TMP);
+        TMSG3 = _mm_sha256msg2_epu32(TMSG3, TMSG2);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+        TMSG1 = _mm_sha256msg1_epu32(TMSG1, TMSG2);
+
+        // Rounds 28-31
+        MSG = _mm_add_epi32(TMSG3, _mm_set_epi64x((int64_t)0x1429296706CA6351ULL, (int64_t)0xD5A79147C6E00BF3ULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        TMP = _mm_alignr_epi8(TMSG3, TMSG2, 4);
+        TMSG0 = _mm_add_epi32(TMSG0, TMP);
+        TMSG0 = _mm_sha256msg2_epu32(TMSG0, TMSG3);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+        TMSG2 = _mm_sha256msg1_epu32(TMSG2, TMSG3);
+
+        // Rounds 32-35
+        MSG = _mm_add_epi32(TMSG0, _mm_set_epi64x((int64_t)0x53380D134D2C6DFCULL, (int64_t)0x2E1B213827B70A85ULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        TMP = _mm_alignr_epi8(TMSG0, TMSG3, 4);
+        TMSG1 = _mm_add_epi32(TMSG1, TMP);
+        TMSG1 = _mm_sha256msg2_epu32(TMSG1, TMSG0);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+        TMSG3 = _mm_sha256msg1_epu32(TMSG3, TMSG0);
+
+        // Rounds 36-39
+        MSG = _mm_add_epi32(TMSG1, _mm_set_epi64x((int64_t)0x92722C8581C2C92EULL, (int64_t)0x766A0ABB650A7354ULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        TMP = _mm_alignr_epi8(TMSG1, TMSG0, 4);
+        TMSG2 = _mm_add_epi32(TMSG2, TMP);
+        TMSG2 = _mm_sha256msg2_epu32(TMSG2, TMSG1);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+        TMSG0 = _mm_sha256msg1_epu32(TMSG0, TMSG1);
+
+        // Rounds 40-43
+        MSG = _mm_add_epi32(TMSG2, _mm_set_epi64x((int64_t)0xC76C51A3C24B8B70ULL, (int64_t)0xA81A664BA2BFE8A1ULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        TMP = _mm_alignr_epi8(TMSG2, TMSG1, 4);
+        TMSG3 = _mm_add_epi32(TMSG3, TMP);
+        TMSG3 = _mm_sha256msg2_epu32(TMSG3, TMSG2);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+        TMSG1 = _mm_sha256msg1_epu32(TMSG1, TMSG2);
+
+        // Rounds 44-47
+        MSG = _mm_add_epi32(TMSG3, _mm_set_epi64x((int64_t)0x106AA070F40E3585ULL, (int64_t)0xD6990624D192E819ULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        TMP = _mm_alignr_epi8(TMSG3, TMSG2, 4);
+        TMSG0 = _mm_add_epi32(TMSG0, TMP);
+        TMSG0 = _mm_sha256msg2_epu32(TMSG0, TMSG3);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+        TMSG2 = _mm_sha256msg1_epu32(TMSG2, TMSG3);
+
+        // Rounds 48-51
+        MSG = _mm_add_epi32(TMSG0, _mm_set_epi64x((int64_t)0x34B0BCB52748774CULL, (int64_t)0x1E376C0819A4C116ULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        TMP = _mm_alignr_epi8(TMSG0, TMSG3, 4);
+        TMSG1 = _mm_add_epi32(TMSG1, TMP);
+        TMSG1 = _mm_sha256msg2_epu32(TMSG1, TMSG0);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+        TMSG3 = _mm_sha256msg1_epu32(TMSG3, TMSG0);
+
+        // Rounds 52-55
+        MSG = _mm_add_epi32(TMSG1, _mm_set_epi64x((int64_t)0x682E6FF35B9CCA4FULL, (int64_t)0x4ED8AA4A391C0CB3ULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        TMP = _mm_alignr_epi8(TMSG1, TMSG0, 4);
+        TMSG2 = _mm_add_epi32(TMSG2, TMP);
+        TMSG2 = _mm_sha256msg2_epu32(TMSG2, TMSG1);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+
+        // Rounds 56-59
+        MSG = _mm_add_epi32(TMSG2, _mm_set_epi64x((int64_t)0x8CC7020884C87814ULL, (int64_t)0x78A5636F748F82EEULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        TMP = _mm_alignr_epi8(TMSG2, TMSG1, 4);
+        TMSG3 = _mm_add_epi32(TMSG3, TMP);
+        TMSG3 = _mm_sha256msg2_epu32(TMSG3, TMSG2);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+
+        // Rounds 60-63
+        MSG = _mm_add_epi32(TMSG3, _mm_set_epi64x((int64_t)0xC67178F2BEF9A3F7ULL, (int64_t)0xA4506CEB90BEFFFAULL));
+        STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+        MSG = _mm_shuffle_epi32(MSG, 0x0E);
+        STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+
+        STATE0 = _mm_add_epi32(STATE0, ABEF_SAVE);
+        STATE1 = _mm_add_epi32(STATE1, CDGH_SAVE);
+        blocks += 64;
+    }
+
+    TMP = _mm_shuffle_epi32(STATE0, 0x1B);    // FEBA
+    STATE1 = _mm_shuffle_epi32(STATE1, 0xB1); // DCHG
+    STATE0 = _mm_blend_epi16(TMP, STATE1, 0xF0); // DCBA
+    STATE1 = _mm_alignr_epi8(STATE1, TMP, 8);    // HGFE
+    _mm_storeu_si128((__m128i*)&H[0], STATE0);
+    _mm_storeu_si128((__m128i*)&H[4], STATE1);
+}
+
+#elif defined(__aarch64__)
+
+// ARMv8 crypto-extension kernel (sha256h/sha256h2/sha256su0/sha256su1).
+__attribute__((target("arch=armv8-a+crypto")))
+static void compress_armv8(uint32_t H[8], const uint8_t* blocks, size_t nblocks) {
+    uint32x4_t STATE0 = vld1q_u32(&H[0]);
+    uint32x4_t STATE1 = vld1q_u32(&H[4]);
+
+    while (nblocks--) {
+        const uint32x4_t ABCD_SAVE = STATE0;
+        const uint32x4_t EFGH_SAVE = STATE1;
+
+        uint32x4_t MSG0 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + 0)));
+        uint32x4_t MSG1 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + 16)));
+        uint32x4_t MSG2 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + 32)));
+        uint32x4_t MSG3 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + 48)));
+        uint32x4_t TMP0, TMP2;
+
+        // Twelve schedule-updating groups of four rounds, then four plain.
+        for (int r = 0; r < 12; r++) {
+            TMP0 = vaddq_u32(MSG0, vld1q_u32(&K[(size_t)r * 4]));
+            TMP2 = STATE0;
+            MSG0 = vsha256su0q_u32(MSG0, MSG1);
+            STATE0 = vsha256hq_u32(STATE0, STATE1, TMP0);
+            STATE1 = vsha256h2q_u32(STATE1, TMP2, TMP0);
+            MSG0 = vsha256su1q_u32(MSG0, MSG2, MSG3);
+            // Rotate the message registers: MSG0 <- MSG1 <- MSG2 <- MSG3 <- W'.
+            uint32x4_t next = MSG0;
+            MSG0 = MSG1; MSG1 = MSG2; MSG2 = MSG3; MSG3 = next;
+        }
+        for (int r = 12; r < 16; r++) {
+            TMP0 = vaddq_u32(MSG0, vld1q_u32(&K[(size_t)r * 4]));
+            TMP2 = STATE0;
+            STATE0 = vsha256hq_u32(STATE0, STATE1, TMP0);
+            STATE1 = vsha256h2q_u32(STATE1, TMP2, TMP0);
+            MSG0 = MSG1; MSG1 = MSG2; MSG2 = MSG3;
+        }
+
+        STATE0 = vaddq_u32(STATE0, ABCD_SAVE);
+        STATE1 = vaddq_u32(STATE1, EFGH_SAVE);
+        blocks += 64;
+    }
+
+    vst1q_u32(&H[0], STATE0);
+    vst1q_u32(&H[4], STATE1);
+}
+
+#endif
+
+using compress_fn = void (*)(uint32_t*, const uint8_t*, size_t);
+
+static compress_fn pick_compress() {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    if (cpu_has_shani()) return compress_shani;
+    return compress_scalar;
+#elif defined(__aarch64__)
+    if (getauxval(AT_HWCAP) & HWCAP_SHA2) return compress_armv8;
+    return compress_scalar;
+#else
+    return compress_scalar;
+#endif
+}
 } // namespace detail
 
+void sha256_compress(uint32_t state[8], const uint8_t* blocks, size_t nblocks) {
+    static const detail::compress_fn fn = detail::pick_compress();
+    fn(state, blocks, nblocks);
+}
+
 std::array<uint8_t, 32> sha256_bytes(const uint8_t* data, size_t n) {
     uint32_t H[8] = {
         0x6a09e667u,0xbb67ae85u,0x3c6ef372u,0xa54ff53au,0x510e527fu,0x9b05688cu,0x1f83d9abu,0x5be0cd19u
@@ -51,9 +327,7 @@ std::array<uint8_t, 32> sha256_bytes(const uint8_t* data, size_t n) {
 
     // process full blocks
     size_t full = n / 64;
-    for (size_t i=0;i<full;i++){
-        detail::process_block(data + i*64, H);
-    }
+    if (full) sha256_compress(H, data, full);
 
     // final block(s) with padding
     uint8_t block[128];
@@ -76,8 +350,7 @@ std::array<uint8_t, 32> sha256_bytes(const uint8_t* data, size_t n) {
     block[off+6] = uint8_t((bitlen >>  8) & 0xff);
     block[off+7] = uint8_t((bitlen >>  0) & 0xff);
 
-    detail::process_block(block, H);
-    if (pad_block_len == 128) detail::process_block(block + 64, H);
+    sha256_compress(H, block, pad_block_len / 64);
 
     std::array<uint8_t, 32> out{};
     for (int i=0;i<8;i++){
@@ -91,9 +364,78 @@ std::array<uint8_t, 32> sha256_bytes(const uint8_t* data, size_t n) {
 
 std::string sha256_hex(const std::string& s) {
     auto b = sha256_bytes(reinterpret_cast<const uint8_t*>(s.data()), s.size());
-    std::ostringstream oss;
-    for (auto v : b) oss << std::hex << std::setw(2) << std::setfill('0') << int(v);
-    return oss.str();
+    static const char* hx = "0123456789abcdef";
+    std::string out(64, '0');
+    for (size_t i = 0; i < b.size(); i++) {
+        out[i*2+0] = hx[(b[i] >> 4) & 0xF];
+        out[i*2+1] = hx[b[i] & 0xF];
+    }
+    return out;
+}
+
+// The AArch64 crc32 instructions implement exactly this polynomial, so the
+// hardware path is format-compatible with segments written in software.
+// x86 SSE4.2 crc32 computes CRC32-C (Castagnoli) — a different polynomial —
+// so x86 uses slice-by-8 instead, which processes 8 bytes per iteration.
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+
+uint32_t crc32(const void* data, size_t n) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    uint32_t crc = 0xFFFFFFFFu;
+    while (n >= 8) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        crc = __crc32d(crc, v);
+        p += 8;
+        n -= 8;
+    }
+    while (n--) crc = __crc32b(crc, *p++);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+#else  // slice-by-8 software kernel
+
+uint32_t crc32(const void* data, size_t n) {
+    static const std::array<std::array<uint32_t, 256>, 8> tables = [] {
+        std::array<std::array<uint32_t, 256>, 8> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int j = 0; j < 8; j++) {
+                if (c & 1) c = 0xEDB88320u ^ (c >> 1);
+                else       c = c >> 1;
+            }
+            t[0][i] = c;
+        }
+        for (int k = 1; k < 8; k++) {
+            for (uint32_t i = 0; i < 256; i++) {
+                t[k][i] = t[0][t[k - 1][i] & 0xFF] ^ (t[k - 1][i] >> 8);
+            }
+        }
+        return t;
+    }();
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    uint32_t crc = 0xFFFFFFFFu;
+
+    while (n >= 8) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, p, 4);
+        std::memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = tables[7][lo & 0xFF] ^ tables[6][(lo >> 8) & 0xFF] ^
+              tables[5][(lo >> 16) & 0xFF] ^ tables[4][lo >> 24] ^
+              tables[3][hi & 0xFF] ^ tables[2][(hi >> 8) & 0xFF] ^
+              tables[1][(hi >> 16) & 0xFF] ^ tables[0][hi >> 24];
+        p += 8;
+        n -= 8;
+    }
+    while (n--) {
+        crc = tables[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
 }
 
+#endif
+
 } // namespace machina::hash
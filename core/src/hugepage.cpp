@@ -0,0 +1,98 @@
+#include "machina/hugepage.h"
+
+#include <cstdlib>
+#include <string>
+
+#ifdef __linux__
+#include <mutex>
+#include <sys/mman.h>
+#include <unordered_map>
+#endif
+
+namespace machina {
+
+#ifdef __linux__
+
+namespace {
+
+// Ownership registry: deallocation must know whether a pointer came from
+// the mmap path or the operator-new fallback, and the allocator cannot
+// tell after the fact. Entries are huge (>= 2MB) and rare, so a locked
+// map costs nothing measurable.
+std::mutex g_map_mu;
+std::unordered_map<void*, size_t>& mapped_ptrs() {
+    static auto* m = new std::unordered_map<void*, size_t>();
+    return *m;
+}
+
+size_t round_huge(size_t len) {
+    return (len + kHugePageBytes - 1) & ~(kHugePageBytes - 1);
+}
+
+} // namespace
+
+bool hugepage_enabled() {
+    static const bool enabled = [] {
+        const char* v = std::getenv("MACHINA_HUGEPAGES");
+        return !(v && std::string(v) == "0");
+    }();
+    return enabled;
+}
+
+void* hugepage_alloc(size_t len) {
+    if (len == 0 || !hugepage_enabled()) return nullptr;
+    size_t mapped = round_huge(len);
+
+    // Explicit huge pages first: fails fast (ENOMEM) unless the operator
+    // reserved them via vm.nr_hugepages, in which case they are guaranteed.
+    void* p = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p == MAP_FAILED) {
+        // Transparent fallback: a 2MB-rounded anonymous map tagged for THP
+        // promotion. khugepaged collapses it once the pages are touched.
+        p = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return nullptr;
+        (void)::madvise(p, mapped, MADV_HUGEPAGE);
+    }
+    {
+        std::lock_guard<std::mutex> lk(g_map_mu);
+        mapped_ptrs()[p] = mapped;
+    }
+    return p;
+}
+
+bool hugepage_free(void* p, size_t len) {
+    (void)len;
+    if (!p) return false;
+    size_t mapped = 0;
+    {
+        std::lock_guard<std::mutex> lk(g_map_mu);
+        auto& m = mapped_ptrs();
+        auto it = m.find(p);
+        if (it == m.end()) return false;
+        mapped = it->second;
+        m.erase(it);
+    }
+    (void)::munmap(p, mapped);
+    return true;
+}
+
+bool hugepage_advise(void* p, size_t len) {
+    if (!p || len == 0 || !hugepage_enabled()) return false;
+    return ::madvise(p, len, MADV_HUGEPAGE) == 0;
+}
+
+#else // !__linux__
+
+bool hugepage_enabled() { return false; }
+
+void* hugepage_alloc(size_t) { return nullptr; }
+
+bool hugepage_free(void*, size_t) { return false; }
+
+bool hugepage_advise(void*, size_t) { return false; }
+
+#endif
+
+} // namespace machina
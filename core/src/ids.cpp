@@ -10,6 +10,9 @@ void Menu::buildIndex() {
     for (size_t i=0;i<items.size();i++) {
         sid_index[items[i].sid.value] = i;
     }
+    // items may have been edited directly; drop the digest memo.
+    canon_valid_ = false;
+    digest_valid_ = false;
 }
 
 const MenuItem* Menu::resolve(const SID& sid) const {
@@ -29,20 +32,65 @@ static std::string join_tags(const std::vector<std::string>& tags) {
     return oss.str();
 }
 
+// Canonical digest piece for one item: "SID0001=AID...:tag,tag".
+static std::string canon_item(const MenuItem& it) {
+    return it.sid.toString() + "=" + it.aid + ":" + join_tags(it.tags);
+}
+
+void Menu::addItem(MenuItem item) {
+    if (canon_valid_) canon_.emplace(item.sid.value, canon_item(item));
+    digest_valid_ = false;
+    sid_index[item.sid.value] = items.size();
+    items.push_back(std::move(item));
+}
+
+bool Menu::removeItem(const SID& sid) {
+    auto it = sid_index.find(sid.value);
+    if (it == sid_index.end()) return false;
+    size_t pos = it->second;
+    if (canon_valid_) {
+        // Duplicate SIDs share a key in the memo; drop the matching piece.
+        std::string piece = canon_item(items[pos]);
+        auto range = canon_.equal_range(sid.value);
+        for (auto c = range.first; c != range.second; ++c) {
+            if (c->second == piece) { canon_.erase(c); break; }
+        }
+    }
+    digest_valid_ = false;
+    items.erase(items.begin() + (ptrdiff_t)pos);
+    sid_index.erase(it);
+    for (auto& kv : sid_index) {
+        if (kv.second > pos) kv.second--;
+    }
+    return true;
+}
+
+void Menu::rebuildCanon() const {
+    canon_.clear();
+    for (const auto& it : items) {
+        canon_.emplace(it.sid.value, canon_item(it));
+    }
+    canon_valid_ = true;
+}
+
 std::string Menu::digest_raw() const {
-    // deterministic digest: "SID0001=AID....|SID0002=AID...."
-    std::vector<MenuItem> tmp = items;
-    std::sort(tmp.begin(), tmp.end(), [](const MenuItem& a, const MenuItem& b){ return a.sid.value < b.sid.value; });
-    std::ostringstream oss;
-    for (size_t i=0;i<tmp.size();i++) {
-        if (i) oss << "|";
-        oss << tmp[i].sid.toString() << "=" << tmp[i].aid << ":" << join_tags(tmp[i].tags);
+    // deterministic digest: "SID0001=AID....|SID0002=AID...."; the multimap
+    // keeps pieces in sid order, matching the historical sorted join.
+    if (!canon_valid_) rebuildCanon();
+    std::string out;
+    for (auto it = canon_.begin(); it != canon_.end(); ++it) {
+        if (it != canon_.begin()) out += "|";
+        out += it->second;
     }
-    return oss.str();
+    return out;
 }
 
 std::string Menu::digest() const {
-    return hash::sha256_hex(digest_raw());
+    if (!digest_valid_) {
+        digest_cache_ = hash::sha256_hex(digest_raw());
+        digest_valid_ = true;
+    }
+    return digest_cache_;
 }
 
 } // namespace machina
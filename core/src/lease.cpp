@@ -1,8 +1,12 @@
 #include "machina/lease.h"
+#include "machina/trace.h"
 #include "machina/crypto.h"
+#include "machina/fast_rand.h"
 
 #include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <vector>
 #include <sstream>
 #include <iomanip>
 
@@ -14,18 +18,9 @@ static int64_t now_ms() {
 }
 
 static std::string random_hex(size_t bytes = 16) {
-    // Use cryptographically secure random from crypto.h
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
-    for (size_t i = 0; i < bytes; i += 4) {
-        uint32_t r = secure_rand32();
-        size_t remain = bytes - i;
-        size_t use = remain < 4 ? remain : 4;
-        for (size_t j = 0; j < use; j++) {
-            oss << std::setw(2) << ((r >> (j * 8)) & 0xFF);
-        }
-    }
-    return oss.str();
+    // Per-thread PRNG seeded once from the secure source: lease churn no
+    // longer pays an entropy read per token.
+    return fast_rand_hex(bytes);
 }
 
 // --- Tool Tier Classification ---
@@ -66,10 +61,67 @@ ToolTier classify_tool_tier(const std::string& aid,
 
 // --- LeaseManager ---
 
+// How long a shard goes without a sweep before issue_lease does one
+// inline. Keeps dead entries bounded without a dedicated GC caller.
+static constexpr int64_t kShardGcIntervalMs = 5000;
+
+// Stateless token layout: kStatelessPrefix|tool_aid|tier|expires_ms|nonce|sig.
+// '|' never appears in AIDs, and the HMAC canon uses newlines so a field
+// cannot smear into its neighbour.
+static const char kStatelessPrefix[] = "slease1";
+
+static std::string stateless_canon(const std::string& tool_aid, int tier,
+                                   int64_t expires_ms, const std::string& nonce) {
+    return tool_aid + "\n" + std::to_string(tier) + "\n" +
+           std::to_string(expires_ms) + "\n" + nonce;
+}
+
+LeaseManager::LeaseManager() {
+    std::string secret;
+    if (const char* e = std::getenv("MACHINA_LEASE_SECRET")) secret = e;
+    if (secret.empty()) {
+        // Per-process secret: stateless tokens stay valid within this
+        // process only. Set MACHINA_LEASE_SECRET to share them across a
+        // toolhost pool.
+        secret = random_hex(32);
+    }
+    stateless_key_ = std::make_unique<HmacKey>(secret);
+}
+
+LeaseManager::~LeaseManager() = default;
+
+LeaseManager::Shard& LeaseManager::shard_for(const std::string& token_id) const {
+    return shards_[std::hash<std::string>{}(token_id) % kShards];
+}
+
+void LeaseManager::sweep_locked(Shard& sh, int64_t now) {
+    for (auto it = sh.leases.begin(); it != sh.leases.end(); ) {
+        if (it->second.expires_ms < now || it->second.consumed) {
+            if (!it->second.consumed) {
+                active_count_.fetch_sub(1, std::memory_order_relaxed);
+            }
+            it = sh.leases.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = sh.spent_nonces.begin(); it != sh.spent_nonces.end(); ) {
+        // A replayed token past its expiry fails the expiry check anyway,
+        // so the nonce no longer needs remembering.
+        if (it->second < now) {
+            it = sh.spent_nonces.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    sh.last_gc_ms = now;
+}
+
 LeaseToken LeaseManager::issue_lease(const std::string& tool_aid,
                                      int tier,
                                      int64_t ttl_ms,
                                      const std::string& issuer) {
+    MACHINA_TRACE_SPAN("lease_issue");
     // Clamp TTL: minimum 1s, maximum 300s
     if (ttl_ms < 1000) ttl_ms = 1000;
     if (ttl_ms > 300000) ttl_ms = 300000;
@@ -83,21 +135,121 @@ LeaseToken LeaseManager::issue_lease(const std::string& tool_aid,
     tok.consumed = false;
     tok.issuer = issuer;
 
-    std::lock_guard<std::mutex> lk(mu_);
-    leases_[tok.token_id] = tok;
-    total_issued_++;
+    Shard& sh = shard_for(tok.token_id);
+    std::lock_guard<std::mutex> lk(sh.mu);
+    if (tok.issued_ms - sh.last_gc_ms > kShardGcIntervalMs) {
+        sweep_locked(sh, tok.issued_ms);
+    }
+    sh.leases[tok.token_id] = tok;
+    total_issued_.fetch_add(1, std::memory_order_relaxed);
+    active_count_.fetch_add(1, std::memory_order_relaxed);
+    return tok;
+}
+
+LeaseToken LeaseManager::issue_lease_stateless(const std::string& tool_aid,
+                                               int tier,
+                                               int64_t ttl_ms,
+                                               const std::string& issuer) {
+    MACHINA_TRACE_SPAN("lease_issue");
+    // Clamp TTL: minimum 1s, maximum 300s (same policy as map-backed leases)
+    if (ttl_ms < 1000) ttl_ms = 1000;
+    if (ttl_ms > 300000) ttl_ms = 300000;
+
+    LeaseToken tok;
+    tok.tool_aid = tool_aid;
+    tok.tier = tier;
+    tok.issued_ms = now_ms();
+    tok.expires_ms = tok.issued_ms + ttl_ms;
+    tok.consumed = false;
+    tok.issuer = issuer;
+
+    std::string nonce = random_hex(16);
+    std::string sig = stateless_key_->sign_hex(
+        stateless_canon(tool_aid, tier, tok.expires_ms, nonce));
+    tok.token_id = std::string(kStatelessPrefix) + "|" + tool_aid + "|" +
+                   std::to_string(tier) + "|" + std::to_string(tok.expires_ms) +
+                   "|" + nonce + "|" + sig;
+    total_issued_.fetch_add(1, std::memory_order_relaxed);
     return tok;
 }
 
+bool LeaseManager::verify_stateless(const std::string& token_id,
+                                    const std::string& tool_aid,
+                                    std::string* reason) {
+    // Split the five '|'-separated fields after the prefix.
+    std::vector<std::string> parts;
+    size_t start = 0;
+    for (size_t i = 0; i <= token_id.size(); i++) {
+        if (i == token_id.size() || token_id[i] == '|') {
+            parts.push_back(token_id.substr(start, i - start));
+            start = i + 1;
+        }
+    }
+    if (parts.size() != 6) {
+        if (reason) *reason = "malformed stateless lease";
+        return false;
+    }
+    const std::string& aid = parts[1];
+    int tier = 0;
+    int64_t expires_ms = 0;
+    try {
+        tier = std::stoi(parts[2]);
+        expires_ms = std::stoll(parts[3]);
+    } catch (...) {
+        if (reason) *reason = "malformed stateless lease";
+        return false;
+    }
+    const std::string& nonce = parts[4];
+    const std::string& sig = parts[5];
+
+    // Signature first: nothing below is trustworthy until it checks out.
+    std::string expected = stateless_key_->sign_hex(
+        stateless_canon(aid, tier, expires_ms, nonce));
+    if (!constant_time_eq(sig, expected)) {
+        if (reason) *reason = "lease signature invalid";
+        return false;
+    }
+
+    if (now_ms() > expires_ms) {
+        if (reason) *reason = "lease expired";
+        return false;
+    }
+
+    if (aid != "*" && aid != tool_aid) {
+        if (reason) *reason = "lease tool mismatch: expected=" + aid + " got=" + tool_aid;
+        return false;
+    }
+
+    // Single-use: record the nonce; a second verify finds it spent.
+    Shard& sh = shard_for(nonce);
+    std::lock_guard<std::mutex> lk(sh.mu);
+    auto ins = sh.spent_nonces.emplace(nonce, expires_ms);
+    if (!ins.second) {
+        if (reason) *reason = "lease already consumed";
+        return false;
+    }
+    return true;
+}
+
 bool LeaseManager::verify_and_consume(const std::string& token_id,
                                       const std::string& tool_aid,
                                       std::string* reason) {
-    std::lock_guard<std::mutex> lk(mu_);
+    if (token_id.rfind(std::string(kStatelessPrefix) + "|", 0) == 0) {
+        if (verify_stateless(token_id, tool_aid, reason)) {
+            total_consumed_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        total_rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Shard& sh = shard_for(token_id);
+    std::lock_guard<std::mutex> lk(sh.mu);
 
-    auto it = leases_.find(token_id);
-    if (it == leases_.end()) {
+    auto it = sh.leases.find(token_id);
+    if (it == sh.leases.end()) {
         if (reason) *reason = "lease not found";
-        total_rejected_++;
+        total_rejected_.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
 
@@ -106,28 +258,30 @@ bool LeaseManager::verify_and_consume(const std::string& token_id,
     // Check expiry
     if (now_ms() > tok.expires_ms) {
         if (reason) *reason = "lease expired";
-        leases_.erase(it);
-        total_rejected_++;
+        if (!tok.consumed) active_count_.fetch_sub(1, std::memory_order_relaxed);
+        sh.leases.erase(it);
+        total_rejected_.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
 
     // Check single-use
     if (tok.consumed) {
         if (reason) *reason = "lease already consumed";
-        total_rejected_++;
+        total_rejected_.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
 
     // Check tool match (wildcard "*" matches anything at the right tier)
     if (tok.tool_aid != "*" && tok.tool_aid != tool_aid) {
         if (reason) *reason = "lease tool mismatch: expected=" + tok.tool_aid + " got=" + tool_aid;
-        total_rejected_++;
+        total_rejected_.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
 
     // All checks passed — consume the lease
     tok.consumed = true;
-    total_consumed_++;
+    total_consumed_.fetch_add(1, std::memory_order_relaxed);
+    active_count_.fetch_sub(1, std::memory_order_relaxed);
     return true;
 }
 
@@ -137,27 +291,11 @@ bool LeaseManager::requires_lease(const std::string& aid,
 }
 
 void LeaseManager::gc() {
-    std::lock_guard<std::mutex> lk(mu_);
     int64_t now = now_ms();
-    for (auto it = leases_.begin(); it != leases_.end(); ) {
-        if (it->second.expires_ms < now || it->second.consumed) {
-            it = leases_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
-size_t LeaseManager::active_count() const {
-    std::lock_guard<std::mutex> lk(mu_);
-    int64_t now = now_ms();
-    size_t count = 0;
-    for (const auto& kv : leases_) {
-        if (!kv.second.consumed && kv.second.expires_ms > now) {
-            count++;
-        }
+    for (auto& sh : shards_) {
+        std::lock_guard<std::mutex> lk(sh.mu);
+        sweep_locked(sh, now);
     }
-    return count;
 }
 
 } // namespace machina
@@ -1,5 +1,6 @@
 #include "machina/log.h"
 #include "machina/hash.h"
+#include "machina/json_writer.h"
 
 #include <json-c/json.h>
 
@@ -59,7 +60,7 @@ static void canonical_serialize(json_object* obj, std::ostringstream& out) {
     }
     case json_type_array: {
         out << "[";
-        int len = json_object_array_length(obj);
+        int len = (int)json_object_array_length(obj);
         for (int i = 0; i < len; i++) {
             if (i > 0) out << ",";
             canonical_serialize(json_object_array_get_idx(obj, i), out);
@@ -76,74 +77,160 @@ static void canonical_serialize(json_object* obj, std::ostringstream& out) {
 }
 
 // Canonical JSON: parse then re-serialize with sorted keys.
-// Returns input unchanged if parsing fails (best-effort).
-static std::string canonicalize_json(const std::string& raw) {
+// Returns input unchanged (and clears *valid) if parsing fails (best-effort).
+static std::string canonicalize_json(const std::string& raw, bool* valid) {
     json_object* obj = json_tokener_parse(raw.c_str());
-    if (!obj) return raw;
+    if (!obj) { if (valid) *valid = false; return raw; }
     std::ostringstream out;
     canonical_serialize(obj, out);
     json_object_put(obj);
+    if (valid) *valid = true;
     return out.str();
 }
 
 JsonlLogger::JsonlLogger(const RunHeader& hdr, const std::string& path)
-    : hdr_(hdr), path_(path), out_(path, std::ios::out | std::ios::trunc), chain_prev_(std::string(64, '0')) {}
+    : hdr_(hdr), path_(path), out_(path, std::ios::out | std::ios::trunc),
+      idx_out_(path + ".idx", std::ios::out | std::ios::trunc),
+      chain_prev_(std::string(64, '0')) {
+    if (idx_out_) idx_out_ << "mrlidx1\n";
+    writer_ = std::thread([this] { writer_loop(); });
+}
 
-void JsonlLogger::event(int step, const std::string& name, const std::string& payload_json) {
-    std::string ts = iso_now();
+JsonlLogger::~JsonlLogger() {
+    {
+        std::lock_guard<std::mutex> lk(q_mu_);
+        stop_ = true;
+    }
+    q_cv_.notify_all();
+    if (writer_.joinable()) writer_.join();
+}
 
-    // Canonicalize payload for deterministic hashing
-    std::string canonical_payload = canonicalize_json(payload_json);
+void JsonlLogger::writer_loop() {
+    std::vector<std::pair<std::string, std::string>> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(q_mu_);
+            q_cv_.wait(lk, [this] { return stop_ || !q_.empty(); });
+            if (q_.empty()) break; // stop_ set and drained
+            batch.swap(q_);
+            q_busy_ = true;
+        }
+        for (const auto& e : batch) {
+            out_ << e.first;
+            if (idx_out_ && !e.second.empty()) idx_out_ << e.second;
+        }
+        // One flush per drained batch instead of per line; burst steps pay
+        // a single syscall for their whole event group.
+        out_.flush();
+        if (idx_out_) idx_out_.flush();
+        batch.clear();
+        {
+            std::lock_guard<std::mutex> lk(q_mu_);
+            q_busy_ = false;
+            if (q_.empty()) drain_cv_.notify_all();
+        }
+    }
+}
 
-    // Build record as json-c object, then canonicalize for hash chain
-    json_object* rec = json_object_new_object();
-    json_object_object_add(rec, "event", json_object_new_string(name.c_str()));
+void JsonlLogger::flush() {
+    std::unique_lock<std::mutex> lk(q_mu_);
+    drain_cv_.wait(lk, [this] { return q_.empty() && !q_busy_; });
+}
 
-    json_object* pobj = json_tokener_parse(canonical_payload.c_str());
-    json_object_object_add(rec, "payload", pobj ? pobj : json_object_new_string(canonical_payload.c_str()));
+void JsonlLogger::event(int step, const std::string& name, const std::string& payload_json,
+                        bool payload_is_canonical) {
+    std::string ts = iso_now();
 
-    json_object_object_add(rec, "profile_id", json_object_new_string(hdr_.profile_id.c_str()));
-    if (!hdr_.request_id.empty())
-        json_object_object_add(rec, "request_id", json_object_new_string(hdr_.request_id.c_str()));
-    json_object_object_add(rec, "run_id", json_object_new_string(hdr_.run_id.c_str()));
-    json_object_object_add(rec, "spec_version", json_object_new_string(hdr_.spec_version.c_str()));
-    json_object_object_add(rec, "step", json_object_new_int(step));
-    json_object_object_add(rec, "ts", json_object_new_string(ts.c_str()));
+    // Canonical payload for deterministic hashing: the caller's marker wins,
+    // then the memo cache, then the full parse + sorted re-serialize.
+    static constexpr size_t kCanonCacheCap = 128;
+    const std::string* canonical_payload = &payload_json;
+    bool payload_is_json = true;
+    std::string canon_tmp;
+    if (!payload_is_canonical) {
+        auto it = canon_cache_.find(payload_json);
+        if (it == canon_cache_.end()) {
+            canon_tmp = canonicalize_json(payload_json, &payload_is_json);
+            if (canon_cache_.size() >= kCanonCacheCap) canon_cache_.clear();
+            it = canon_cache_.emplace(payload_json, CanonEntry{canon_tmp, payload_is_json}).first;
+        }
+        canonical_payload = &it->second.text;
+        payload_is_json = it->second.is_json;
+    }
 
-    // Canonical serialization for deterministic hash
-    std::ostringstream rec_out;
-    canonical_serialize(rec, rec_out);
-    std::string record = rec_out.str();
-    json_object_put(rec);
+    // The record's fixed field names already sort canonically (event <
+    // payload < profile_id < request_id < run_id < spec_version < step < ts),
+    // so the canonical record can be assembled directly — no json-c tree
+    // build, no re-parse of the payload, no recursive key sort.
+    JsonWriter rec(canonical_payload->size() + 256);
+    rec.begin_object();
+    rec.kv("event", name);
+    if (payload_is_json) rec.kv_raw("payload", *canonical_payload);
+    else rec.kv("payload", *canonical_payload);
+    rec.kv("profile_id", hdr_.profile_id);
+    if (!hdr_.request_id.empty()) rec.kv("request_id", hdr_.request_id);
+    rec.kv("run_id", hdr_.run_id);
+    rec.kv("spec_version", hdr_.spec_version);
+    rec.kv("step", step);
+    rec.kv("ts", ts);
+    rec.end_object();
+    std::string record = rec.take();
 
     // Tamper-evident hash chain: chain_hash = SHA256(chain_prev || record)
     std::string chain_hash = machina::hash::sha256_hex(chain_prev_ + record);
 
-    // Final output line: chain fields + canonical record fields
-    json_object* line = json_object_new_object();
-    json_object_object_add(line, "chain_hash", json_object_new_string(chain_hash.c_str()));
-    json_object_object_add(line, "chain_prev", json_object_new_string(chain_prev_.c_str()));
-    json_object_object_add(line, "event", json_object_new_string(name.c_str()));
-
-    json_object* pobj2 = json_tokener_parse(canonical_payload.c_str());
-    json_object_object_add(line, "payload", pobj2 ? pobj2 : json_object_new_string(canonical_payload.c_str()));
-
-    json_object_object_add(line, "profile_id", json_object_new_string(hdr_.profile_id.c_str()));
-    if (!hdr_.request_id.empty())
-        json_object_object_add(line, "request_id", json_object_new_string(hdr_.request_id.c_str()));
-    json_object_object_add(line, "run_id", json_object_new_string(hdr_.run_id.c_str()));
-    json_object_object_add(line, "spec_version", json_object_new_string(hdr_.spec_version.c_str()));
-    json_object_object_add(line, "step", json_object_new_int(step));
-    json_object_object_add(line, "ts", json_object_new_string(ts.c_str()));
-
-    // Output line also canonical
-    std::ostringstream line_out;
-    canonical_serialize(line, line_out);
-    out_ << line_out.str() << "\n";
-    out_.flush();
-
-    json_object_put(line);
+    // Final output line: the chain fields sort before every record field
+    // (chain_hash < chain_prev < event), and both values are hex, so the
+    // line is the record with the chain pair spliced in after the '{'.
+    std::string line;
+    line.reserve(record.size() + 160);
+    line += "{\"chain_hash\":\"";
+    line += chain_hash;
+    line += "\",\"chain_prev\":\"";
+    line += chain_prev_;
+    line += "\",";
+    line.append(record, 1, std::string::npos);
+    line += "\n";
+
+    std::string idx_row;
+    if (idx_out_) {
+        idx_row = name + ' ' + std::to_string(step) + ' ' + std::to_string(offset_) +
+                  ' ' + std::to_string(line.size()) + '\n';
+    }
+    offset_ += (long long)line.size();
     chain_prev_ = chain_hash;
+
+    {
+        std::lock_guard<std::mutex> lk(q_mu_);
+        q_.emplace_back(std::move(line), std::move(idx_row));
+    }
+    q_cv_.notify_one();
+}
+
+void JsonlLogger::step_event(int step, const std::string& name,
+                             std::initializer_list<LogField> fields) {
+    // Sort a small index rather than the fields themselves; event payloads
+    // carry a handful of keys, so this is a few comparisons.
+    std::vector<const LogField*> order;
+    order.reserve(fields.size());
+    for (const auto& f : fields) order.push_back(&f);
+    std::sort(order.begin(), order.end(),
+              [](const LogField* a, const LogField* b) { return a->key < b->key; });
+
+    JsonWriter payload(256);
+    payload.begin_object();
+    for (const LogField* f : order) {
+        switch (f->kind) {
+        case LogField::Kind::Str:  payload.kv(f->key, f->sv); break;
+        case LogField::Kind::Int:  payload.kv(f->key, f->i); break;
+        case LogField::Kind::Dbl:  payload.kv(f->key, f->d); break;
+        case LogField::Kind::Bool: payload.kv(f->key, f->b); break;
+        case LogField::Kind::Raw:  payload.kv_raw(f->key, f->sv); break;
+        }
+    }
+    payload.end_object();
+
+    event(step, name, payload.take(), /*payload_is_canonical=*/true);
 }
 
 } // namespace machina
@@ -0,0 +1,235 @@
+#include "machina/manifest_cache.h"
+#include "machina/crypto.h"
+#include "machina/hash.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace machina::manifest_cache {
+
+namespace {
+
+// Blob kinds; stored in the header so a renamed file cannot deserialize
+// as the wrong record type.
+constexpr uint8_t kKindToolDescs = 1;
+constexpr uint8_t kKindGoalDescs = 2;
+constexpr uint8_t kKindIssues = 3;
+
+std::filesystem::path blob_path(uint8_t kind, const std::string& key) {
+    const char* mr = std::getenv("MACHINA_ROOT");
+    std::filesystem::path root = mr ? std::filesystem::path(mr) : std::filesystem::current_path();
+    std::string fname = hash::hex64(hash::fnv1a64(std::to_string(kind) + ":" + key)) + ".mfc";
+    return root / "work" / "manifest_cache" / fname;
+}
+
+// ---- primitive readers/writers (little-endian host assumed, same as the
+// selector centroid cache — these blobs never move between machines) ----
+
+void put_u32(std::ofstream& out, uint32_t v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+void put_u8(std::ofstream& out, uint8_t v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+void put_str(std::ofstream& out, const std::string& s) {
+    put_u32(out, (uint32_t)s.size());
+    out.write(s.data(), (std::streamsize)s.size());
+}
+void put_vec(std::ofstream& out, const std::vector<std::string>& v) {
+    put_u32(out, (uint32_t)v.size());
+    for (const auto& s : v) put_str(out, s);
+}
+
+bool get_u32(std::ifstream& in, uint32_t* v) {
+    in.read(reinterpret_cast<char*>(v), sizeof(*v));
+    return in.gcount() == (std::streamsize)sizeof(*v);
+}
+bool get_u8(std::ifstream& in, uint8_t* v) {
+    in.read(reinterpret_cast<char*>(v), sizeof(*v));
+    return in.gcount() == (std::streamsize)sizeof(*v);
+}
+bool get_str(std::ifstream& in, std::string* s) {
+    uint32_t n = 0;
+    if (!get_u32(in, &n) || n > (16u << 20)) return false;
+    s->resize(n);
+    in.read(s->data(), (std::streamsize)n);
+    return in.gcount() == (std::streamsize)n;
+}
+bool get_vec(std::ifstream& in, std::vector<std::string>* v) {
+    uint32_t n = 0;
+    if (!get_u32(in, &n) || n > (1u << 20)) return false;
+    v->resize(n);
+    for (auto& s : *v) {
+        if (!get_str(in, &s)) return false;
+    }
+    return true;
+}
+
+// Header check on read; returns the record count, or false on any
+// mismatch (stale version, wrong kind, filename hash collision).
+bool open_blob(std::ifstream& in, uint8_t kind, const std::string& key, uint32_t* count) {
+    char magic[4];
+    in.read(magic, 4);
+    if (in.gcount() != 4 || std::memcmp(magic, "MMFC", 4) != 0) return false;
+    uint32_t version = 0;
+    if (!get_u32(in, &version) || version != 1) return false;
+    uint8_t k = 0;
+    if (!get_u8(in, &k) || k != kind) return false;
+    std::string stored_key;
+    if (!get_str(in, &stored_key) || stored_key != key) return false;
+    return get_u32(in, count) && *count <= (1u << 20);
+}
+
+// Atomic publish: write next to the final path, rename over it.
+class BlobWriter {
+public:
+    BlobWriter(uint8_t kind, const std::string& key)
+        : final_path_(blob_path(kind, key)), tmp_(final_path_.string() + ".tmp") {
+        std::error_code ec;
+        std::filesystem::create_directories(final_path_.parent_path(), ec);
+        out_.open(tmp_, std::ios::binary | std::ios::trunc);
+        if (!out_.good()) return;
+        out_.write("MMFC", 4);
+        put_u32(out_, 1);
+        put_u8(out_, kind);
+        put_str(out_, key);
+    }
+    std::ofstream& stream() { return out_; }
+    bool good() const { return out_.good(); }
+    void publish() {
+        if (!out_.good()) return;
+        out_.close();
+        std::error_code ec;
+        std::filesystem::rename(tmp_, final_path_, ec);
+    }
+
+private:
+    std::filesystem::path final_path_;
+    std::filesystem::path tmp_;
+    std::ofstream out_;
+};
+
+} // namespace
+
+bool enabled() {
+    const char* e = std::getenv("MACHINA_MANIFEST_CACHE");
+    return !(e && (std::string(e) == "0" || std::string(e) == "false"));
+}
+
+std::string content_key(const std::string& manifest_json) {
+    return sha256_hex(manifest_json);
+}
+
+bool load_tooldescs(const std::string& key, std::vector<ToolDesc>* out) {
+    if (!enabled()) return false;
+    std::ifstream in(blob_path(kKindToolDescs, key), std::ios::binary);
+    if (!in.good()) return false;
+    uint32_t count = 0;
+    if (!open_blob(in, kKindToolDescs, key, &count)) return false;
+    out->resize(count);
+    for (auto& d : *out) {
+        uint8_t det = 1;
+        if (!get_str(in, &d.aid) || !get_str(in, &d.name) || !get_u8(in, &det) ||
+            !get_vec(in, &d.tags) || !get_vec(in, &d.side_effects) ||
+            !get_vec(in, &d.replay_inputs)) {
+            out->clear();
+            return false;
+        }
+        d.deterministic = det != 0;
+    }
+    return true;
+}
+
+void save_tooldescs(const std::string& key, const std::vector<ToolDesc>& v) {
+    if (!enabled()) return;
+    BlobWriter w(kKindToolDescs, key);
+    if (!w.good()) return;
+    put_u32(w.stream(), (uint32_t)v.size());
+    for (const auto& d : v) {
+        put_str(w.stream(), d.aid);
+        put_str(w.stream(), d.name);
+        put_u8(w.stream(), d.deterministic ? 1 : 0);
+        put_vec(w.stream(), d.tags);
+        put_vec(w.stream(), d.side_effects);
+        put_vec(w.stream(), d.replay_inputs);
+    }
+    w.publish();
+}
+
+bool load_goaldescs(const std::string& key, std::vector<GoalDesc>* out) {
+    if (!enabled()) return false;
+    std::ifstream in(blob_path(kKindGoalDescs, key), std::ios::binary);
+    if (!in.good()) return false;
+    uint32_t count = 0;
+    if (!open_blob(in, kKindGoalDescs, key, &count)) return false;
+    out->resize(count);
+    for (auto& g : *out) {
+        uint32_t nslots = 0;
+        uint8_t any = 0;
+        if (!get_str(in, &g.goal_id) || !get_vec(in, &g.candidate_tags) ||
+            !get_vec(in, &g.required_tools) || !get_u32(in, &nslots) || nslots > 8) {
+            out->clear();
+            return false;
+        }
+        g.required_slots.resize(nslots);
+        in.read(reinterpret_cast<char*>(g.required_slots.data()), (std::streamsize)nslots);
+        if (in.gcount() != (std::streamsize)nslots || !get_u8(in, &any)) {
+            out->clear();
+            return false;
+        }
+        g.any_slot_sufficient = any != 0;
+    }
+    return true;
+}
+
+void save_goaldescs(const std::string& key, const std::vector<GoalDesc>& v) {
+    if (!enabled()) return;
+    BlobWriter w(kKindGoalDescs, key);
+    if (!w.good()) return;
+    put_u32(w.stream(), (uint32_t)v.size());
+    for (const auto& g : v) {
+        put_str(w.stream(), g.goal_id);
+        put_vec(w.stream(), g.candidate_tags);
+        put_vec(w.stream(), g.required_tools);
+        put_u32(w.stream(), (uint32_t)g.required_slots.size());
+        w.stream().write(reinterpret_cast<const char*>(g.required_slots.data()),
+                         (std::streamsize)g.required_slots.size());
+        put_u8(w.stream(), g.any_slot_sufficient ? 1 : 0);
+    }
+    w.publish();
+}
+
+bool load_issues(const std::string& kind, const std::string& key, std::vector<CtsIssue>* out) {
+    if (!enabled()) return false;
+    const std::string k = kind + ":" + key;
+    std::ifstream in(blob_path(kKindIssues, k), std::ios::binary);
+    if (!in.good()) return false;
+    uint32_t count = 0;
+    if (!open_blob(in, kKindIssues, k, &count)) return false;
+    out->resize(count);
+    for (auto& i : *out) {
+        if (!get_str(in, &i.code) || !get_str(in, &i.message)) {
+            out->clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+void save_issues(const std::string& kind, const std::string& key, const std::vector<CtsIssue>& v) {
+    if (!enabled()) return;
+    const std::string k = kind + ":" + key;
+    BlobWriter w(kKindIssues, k);
+    if (!w.good()) return;
+    put_u32(w.stream(), (uint32_t)v.size());
+    for (const auto& i : v) {
+        put_str(w.stream(), i.code);
+        put_str(w.stream(), i.message);
+    }
+    w.publish();
+}
+
+} // namespace machina::manifest_cache
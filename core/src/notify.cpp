@@ -0,0 +1,180 @@
+#include "machina/notify.h"
+#include "machina/proc.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+
+namespace machina {
+
+static size_t env_size(const char* name, size_t defv) {
+    if (const char* v = std::getenv(name)) {
+        try { return (size_t)std::stoull(v); } catch (...) { return defv; }
+    }
+    return defv;
+}
+
+static int env_int(const char* name, int defv) {
+    if (const char* v = std::getenv(name)) {
+        try { return std::stoi(v); } catch (...) { return defv; }
+    }
+    return defv;
+}
+
+std::vector<std::string> NotifyDispatcher::urls_from_env() {
+    std::vector<std::string> out;
+    const char* v = std::getenv("MACHINA_NOTIFY_WEBHOOKS");
+    if (!v) return out;
+    std::string cur;
+    for (const char* p = v;; p++) {
+        if (*p == ',' || *p == '\0') {
+            while (!cur.empty() && (cur.front() == ' ' || cur.front() == '\t')) cur.erase(0, 1);
+            while (!cur.empty() && (cur.back() == ' ' || cur.back() == '\t')) cur.pop_back();
+            if (!cur.empty()) out.push_back(cur);
+            cur.clear();
+            if (*p == '\0') break;
+        } else {
+            cur.push_back(*p);
+        }
+    }
+    return out;
+}
+
+NotifyDispatcher::NotifyDispatcher(std::vector<std::string> urls)
+    : urls_(std::move(urls)) {
+    if (urls_.empty()) return;
+    ring_cap_ = env_size("MACHINA_NOTIFY_RING", 1024);
+    if (ring_cap_ < 8) ring_cap_ = 8;
+    batch_max_ = env_size("MACHINA_NOTIFY_BATCH", 64);
+    if (batch_max_ < 1) batch_max_ = 1;
+    timeout_ms_ = env_int("MACHINA_NOTIFY_TIMEOUT_MS", 3000);
+    if (timeout_ms_ < 100) timeout_ms_ = 100;
+    sender_ = std::thread([this]() { sender_loop(); });
+}
+
+NotifyDispatcher::~NotifyDispatcher() {
+    if (!sender_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        stop_ = true;
+        // Events still queued at teardown are dropped, not waited for: a
+        // wedged endpoint must not block shutdown. The in-flight batch
+        // finishes inside its own delivery budget.
+        dropped_ += q_.size();
+        q_.clear();
+    }
+    cv_.notify_all();
+    sender_.join();
+}
+
+void NotifyDispatcher::publish(std::string event_json) {
+    if (urls_.empty() || event_json.empty()) return;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (stop_) return;
+        while (q_.size() >= ring_cap_) {
+            q_.pop_front();
+            dropped_++;
+        }
+        q_.push_back(std::move(event_json));
+    }
+    cv_.notify_one();
+}
+
+void NotifyDispatcher::flush(int timeout_ms) {
+    if (urls_.empty()) return;
+    std::unique_lock<std::mutex> lk(mu_);
+    drain_cv_.wait_for(lk, std::chrono::milliseconds(timeout_ms),
+                       [this]() { return (q_.empty() && !busy_) || stop_; });
+}
+
+uint64_t NotifyDispatcher::dropped() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return dropped_;
+}
+
+uint64_t NotifyDispatcher::sent_batches() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return sent_batches_;
+}
+
+uint64_t NotifyDispatcher::failed_batches() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return failed_batches_;
+}
+
+bool NotifyDispatcher::deliver(const std::string& url, const std::string& body_json) {
+    // Local audit sink: one batch per line. Also what the tests point at.
+    if (url.rfind("file://", 0) == 0) {
+        std::ofstream f(url.substr(7), std::ios::app);
+        if (!f) return false;
+        f << body_json << "\n";
+        return f.good();
+    }
+
+#ifdef _WIN32
+    (void)body_json;
+    return false;
+#else
+    // Same sandboxed curl child as the HTTP tools; the whole batch goes
+    // out as one POST, so a burst shares one connection per destination.
+    ProcLimits lim;
+    lim.timeout_ms = timeout_ms_;
+    lim.stdout_max_bytes = 4096;
+    lim.rlimit_cpu_sec = 2;
+    lim.rlimit_as_mb = 512;
+    lim.rlimit_fsize_mb = 1;
+    lim.rlimit_nofile = 32;
+    lim.rlimit_nproc = 16;
+
+    int max_time_sec = timeout_ms_ / 1000;
+    if (max_time_sec < 1) max_time_sec = 1;
+    std::vector<std::string> argv = {
+        "curl", "-sS", "-o", "/dev/null",
+        "--max-time", std::to_string(max_time_sec),
+        "--max-redirs", "0",
+        "-X", "POST",
+        "-H", "Content-Type: application/json",
+        "--data-binary", "@-",
+        "--", url,
+    };
+    ProcResult pr;
+    bool started = proc_run_capture_sandboxed_stdin(argv, ".", body_json, lim, &pr);
+    return started && pr.exit_code == 0 && !pr.timed_out;
+#endif
+}
+
+void NotifyDispatcher::sender_loop() {
+    for (;;) {
+        std::vector<std::string> batch;
+        {
+            std::unique_lock<std::mutex> lk(mu_);
+            busy_ = false;
+            drain_cv_.notify_all();
+            cv_.wait(lk, [this]() { return stop_ || !q_.empty(); });
+            if (stop_ && q_.empty()) return;
+            while (!q_.empty() && batch.size() < batch_max_) {
+                batch.push_back(std::move(q_.front()));
+                q_.pop_front();
+            }
+            busy_ = true;
+        }
+
+        std::string body;
+        body.reserve(64 * batch.size());
+        body.push_back('[');
+        for (size_t i = 0; i < batch.size(); i++) {
+            if (i) body.push_back(',');
+            body += batch[i];
+        }
+        body.push_back(']');
+
+        for (const auto& url : urls_) {
+            const bool ok = deliver(url, body);
+            std::lock_guard<std::mutex> lk(mu_);
+            if (ok) sent_batches_++; else failed_batches_++;
+        }
+    }
+}
+
+} // namespace machina
@@ -0,0 +1,142 @@
+#include "machina/numa.h"
+
+#include <cstdlib>
+#include <string>
+
+#if defined(__linux__) && __has_include(<linux/mempolicy.h>)
+#define MACHINA_HAVE_NUMA 1
+#include <linux/mempolicy.h>
+#include <fstream>
+#include <sched.h>
+#include <sstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+#endif
+
+namespace machina {
+
+#ifdef MACHINA_HAVE_NUMA
+
+namespace {
+
+long sys_mbind(void* addr, unsigned long len, int mode,
+               const unsigned long* nodemask, unsigned long maxnode,
+               unsigned flags) {
+    return syscall(__NR_mbind, addr, len, mode, nodemask, maxnode, flags);
+}
+
+long sys_get_mempolicy(int* mode, unsigned long* nodemask, unsigned long maxnode,
+                       void* addr, unsigned long flags) {
+    return syscall(__NR_get_mempolicy, mode, nodemask, maxnode, addr, flags);
+}
+
+// Parses a /sys cpulist/nodelist range string ("0-3,8-11") into ids.
+std::vector<int> parse_id_list(const std::string& s) {
+    std::vector<int> out;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        size_t dash = part.find('-');
+        try {
+            if (dash == std::string::npos) {
+                out.push_back(std::stoi(part));
+            } else {
+                int lo = std::stoi(part.substr(0, dash));
+                int hi = std::stoi(part.substr(dash + 1));
+                for (int i = lo; i <= hi && i - lo < 4096; i++) out.push_back(i);
+            }
+        } catch (...) {}
+    }
+    return out;
+}
+
+std::vector<int> read_id_list(const std::string& path) {
+    std::ifstream f(path);
+    if (!f) return {};
+    std::string line;
+    std::getline(f, line);
+    return parse_id_list(line);
+}
+
+const std::vector<int>& online_nodes() {
+    static const std::vector<int> nodes = [] {
+        auto n = read_id_list("/sys/devices/system/node/online");
+        if (n.empty()) n.push_back(0);
+        return n;
+    }();
+    return nodes;
+}
+
+} // namespace
+
+int numa_node_count() { return (int)online_nodes().size(); }
+
+bool numa_enabled() {
+    static const bool enabled = [] {
+        const char* v = std::getenv("MACHINA_NUMA");
+        if (!v || std::string(v) != "1") return false;
+        return online_nodes().size() > 1;
+    }();
+    return enabled;
+}
+
+bool numa_pin_thread(int node) {
+    const auto& nodes = online_nodes();
+    int id = nodes[(size_t)(node < 0 ? 0 : node) % nodes.size()];
+    auto cpus = read_id_list("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus) {
+        if (c >= 0 && c < CPU_SETSIZE) CPU_SET(c, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+bool numa_interleave_memory(void* addr, size_t len) {
+    if (!addr || len == 0) return false;
+    unsigned long mask = 0;
+    for (int id : online_nodes()) {
+        if (id >= 0 && id < 64) mask |= 1ul << id;
+    }
+    // MPOL_MF_MOVE migrates pages already faulted in; best-effort, so a
+    // partial move (EIO on pinned pages) is still a success for our use.
+    long rc = sys_mbind(addr, len, MPOL_INTERLEAVE, &mask, 64, MPOL_MF_MOVE);
+    return rc == 0;
+}
+
+bool numa_bind_memory(void* addr, size_t len, int node) {
+    if (!addr || len == 0) return false;
+    const auto& nodes = online_nodes();
+    int id = nodes[(size_t)(node < 0 ? 0 : node) % nodes.size()];
+    if (id < 0 || id >= 64) return false;
+    unsigned long mask = 1ul << id;
+    long rc = sys_mbind(addr, len, MPOL_PREFERRED, &mask, 64, 0);
+    return rc == 0;
+}
+
+int numa_node_of(const void* addr) {
+    int node = -1;
+    long rc = sys_get_mempolicy(&node, nullptr, 0, const_cast<void*>(addr),
+                                MPOL_F_NODE | MPOL_F_ADDR);
+    return rc == 0 ? node : -1;
+}
+
+#else // !MACHINA_HAVE_NUMA
+
+int numa_node_count() { return 1; }
+
+bool numa_enabled() { return false; }
+
+bool numa_pin_thread(int) { return false; }
+
+bool numa_interleave_memory(void*, size_t) { return false; }
+
+bool numa_bind_memory(void*, size_t, int) { return false; }
+
+int numa_node_of(const void*) { return -1; }
+
+#endif
+
+} // namespace machina
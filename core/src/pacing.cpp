@@ -0,0 +1,83 @@
+#include "machina/pacing.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace machina {
+
+namespace {
+
+int64_t steady_now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+BudgetPacer::BudgetPacer(const Budget& budget)
+    : budget_(budget), start_ms_(steady_now_ms()) {}
+
+void BudgetPacer::note_step(int dur_ms) {
+    if (dur_ms < 0) dur_ms = 0;
+    steps_used_++;
+    // EMA over recent steps: responsive to a sudden slow phase without one
+    // outlier dominating the projection.
+    ema_step_ms_ = ema_step_ms_ == 0.0
+                       ? (double)dur_ms
+                       : 0.7 * ema_step_ms_ + 0.3 * (double)dur_ms;
+}
+
+int64_t BudgetPacer::elapsed_ms() const { return steady_now_ms() - start_ms_; }
+
+bool BudgetPacer::exhausted() const {
+    return budget_.max_ms > 0 && elapsed_ms() >= (int64_t)budget_.max_ms;
+}
+
+double BudgetPacer::pressure() const {
+    double p = 0.0;
+    if (budget_.max_steps > 0) {
+        double f = (double)steps_used_ / (double)budget_.max_steps;
+        if (f > p) p = f;
+    }
+    if (budget_.max_ms > 0) {
+        // Project one more average-cost step so pressure leads the clock.
+        double f = ((double)elapsed_ms() + ema_step_ms_) / (double)budget_.max_ms;
+        if (f > p) p = f;
+    }
+    return p > 1.0 ? 1.0 : p;
+}
+
+int BudgetPacer::timeout_cap_ms() const {
+    if (budget_.max_ms <= 0 || pressure() < kPressureFloor) return 0;
+    int64_t remaining = (int64_t)budget_.max_ms - elapsed_ms();
+    if (remaining < 0) remaining = 0;
+    int64_t cap = remaining / 2;
+    if (cap < kMinTimeoutMs) cap = kMinTimeoutMs;
+    return (int)cap;
+}
+
+double BudgetPacer::k_scale() const {
+    double p = pressure();
+    if (p < kPressureFloor) return 1.0;
+    // Linear from 1.0 at the floor down to kMinKScale at pressure 1.0.
+    double t = (p - kPressureFloor) / (1.0 - kPressureFloor);
+    return 1.0 - t * (1.0 - kMinKScale);
+}
+
+std::string BudgetPacer::hints_json() const {
+    int64_t remaining_ms =
+        budget_.max_ms > 0 ? (int64_t)budget_.max_ms - elapsed_ms() : -1;
+    if (budget_.max_ms > 0 && remaining_ms < 0) remaining_ms = 0;
+    int remaining_steps = budget_.max_steps - steps_used_;
+    if (remaining_steps < 0) remaining_steps = 0;
+    char buf[160];
+    std::snprintf(buf, sizeof(buf),
+                  "{\"pressure\":%.3f,\"k_scale\":%.3f,\"remaining_ms\":%lld,"
+                  "\"remaining_steps\":%d}",
+                  pressure(), k_scale(), (long long)remaining_ms,
+                  remaining_steps);
+    return std::string(buf);
+}
+
+} // namespace machina
@@ -0,0 +1,113 @@
+#include "machina/path_guard.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace machina {
+
+namespace {
+
+int64_t mtime_of(const std::filesystem::path& p) {
+    std::error_code ec;
+    auto t = std::filesystem::last_write_time(p, ec);
+    if (ec) return 0;
+    return (int64_t)t.time_since_epoch().count();
+}
+
+struct ParentEntry {
+    int64_t mtime{0};
+    std::filesystem::path canon;
+};
+
+std::mutex g_mu;
+std::unordered_map<std::string, ParentEntry> g_parents;
+std::unordered_map<std::string, std::filesystem::path> g_roots;
+
+constexpr size_t kParentCap = 256;
+constexpr size_t kRootCap = 32;
+
+// Canonical form of a policy root, computed once per distinct spelling.
+// Roots are few and stable (repo root, work dirs), so no invalidation.
+std::filesystem::path root_canon(const std::filesystem::path& root) {
+    std::string key = root.generic_string();
+    {
+        std::lock_guard<std::mutex> lk(g_mu);
+        auto it = g_roots.find(key);
+        if (it != g_roots.end()) return it->second;
+    }
+    std::error_code ec;
+    auto rc = std::filesystem::weakly_canonical(root.lexically_normal(), ec);
+    if (ec) return {};
+    std::lock_guard<std::mutex> lk(g_mu);
+    if (g_roots.size() >= kRootCap) g_roots.clear();
+    g_roots.emplace(key, rc);
+    return rc;
+}
+
+} // namespace
+
+std::filesystem::path path_canon_cached(const std::filesystem::path& p) {
+    std::error_code ec;
+    auto pn = p.lexically_normal();
+    auto parent = pn.parent_path();
+    auto leaf = pn.filename();
+
+    // Symlink leaves bypass the cache entirely: the link target decides
+    // containment and may change without touching the parent's mtime.
+    bool full = parent.empty() || leaf.empty() || leaf == "." || leaf == ".." ||
+                std::filesystem::is_symlink(pn, ec);
+    if (full) {
+        auto r = std::filesystem::weakly_canonical(pn, ec);
+        return ec ? std::filesystem::path{} : r;
+    }
+
+    std::string key = parent.generic_string();
+    int64_t mt = mtime_of(parent);
+    {
+        std::lock_guard<std::mutex> lk(g_mu);
+        auto it = g_parents.find(key);
+        if (it != g_parents.end() && it->second.mtime == mt && mt != 0) {
+            return it->second.canon / leaf;
+        }
+    }
+    auto pc = std::filesystem::weakly_canonical(parent, ec);
+    if (ec) return {};
+    {
+        std::lock_guard<std::mutex> lk(g_mu);
+        if (g_parents.size() >= kParentCap) g_parents.clear();
+        g_parents[key] = ParentEntry{mt, pc};
+    }
+    return pc / leaf;
+}
+
+bool path_is_under(const std::filesystem::path& p, const std::filesystem::path& root) {
+    auto rp = path_canon_cached(p);
+    if (rp.empty()) return false;
+    auto rr = root_canon(root);
+    if (rr.empty()) return false;
+    auto ps = rp.generic_string();
+    auto rs = rr.generic_string();
+    if (ps == rs) return true;
+    if (!rs.empty() && rs.back() != '/') rs.push_back('/');
+    return ps.rfind(rs, 0) == 0;
+}
+
+BasenameAllowlist::BasenameAllowlist(const std::vector<std::string>& names) {
+    for (const auto& n : names) {
+        std::string s = n;
+        for (char& c : s) {
+            if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+        }
+        set_.insert(std::move(s));
+    }
+}
+
+bool BasenameAllowlist::contains(const std::string& basename) const {
+    std::string s = basename;
+    for (char& c : s) {
+        if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+    }
+    return set_.find(s) != set_.end();
+}
+
+} // namespace machina
@@ -9,11 +9,22 @@
   #include <windows.h>
 #else
   #include <dlfcn.h>
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
 #endif
 
+#include "machina/thread_pool.h"
+
 namespace machina {
 
 PluginManager::~PluginManager() {
+    {
+        // drop pools first so serve children die before their plugin handles
+        std::lock_guard<std::mutex> lk(pools_mu_);
+        serve_pools_.clear();
+    }
     for (auto& h : handles_) {
         if (!h.handle) continue;
 #ifdef _WIN32
@@ -44,6 +55,16 @@ void PluginManager::set_expected_hash(const std::string& canonical_path, const s
     expected_hashes_[canonical_path] = sha256_hex;
 }
 
+std::shared_ptr<ToolHostPool> PluginManager::serve_pool(const ToolHostConfig& cfg) {
+    auto key = canonical_str(cfg.plugin);
+    std::lock_guard<std::mutex> lk(pools_mu_);
+    auto it = serve_pools_.find(key);
+    if (it != serve_pools_.end()) return it->second;
+    auto pool = std::make_shared<ToolHostPool>(cfg);
+    serve_pools_[key] = pool;
+    return pool;
+}
+
 bool PluginManager::load_plugin(const std::filesystem::path& path,
                                 IToolRegistrar* registrar,
                                 std::string* err) {
@@ -62,11 +83,13 @@ bool PluginManager::load_plugin(const std::filesystem::path& path,
         return false;
     }
 
-    // Verify SHA256 hash if one was registered for this plugin
+    // Verify SHA256 hash if one was registered for this plugin. Recompute
+    // in the format the expectation was recorded in (plain hex or the
+    // chunked tree:v1 form, which parallelizes over the shared pool).
     {
         auto it = expected_hashes_.find(canonical);
         if (it != expected_hashes_.end()) {
-            std::string actual = sha256_hex_file(path);
+            std::string actual = sha256_hex_file_matching(path, it->second);
             if (actual.empty()) {
                 if (err) *err = "failed to compute hash for: " + path.string();
                 return false;
@@ -168,12 +191,75 @@ bool PluginManager::load_plugin(const std::filesystem::path& path,
 #endif
 }
 
+#ifndef _WIN32
+// Touches one byte per page of an mmap'd file so the kernel faults the
+// whole thing into the page cache ahead of dlopen.
+static void prefault_file(const std::filesystem::path& p) {
+    int fd = ::open(p.string().c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return;
+    }
+    size_t len = (size_t)st.st_size;
+    void* m = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) return;
+    ::madvise(m, len, MADV_WILLNEED);
+    const long page = ::sysconf(_SC_PAGESIZE);
+    const size_t step = page > 0 ? (size_t)page : 4096;
+    volatile unsigned char sink = 0;
+    for (size_t off = 0; off < len; off += step) {
+        sink ^= static_cast<const unsigned char*>(m)[off];
+    }
+    (void)sink;
+    ::munmap(m, len);
+}
+#endif
+
+void PluginManager::prefault_dir_async(const std::filesystem::path& dir) {
+#ifdef _WIN32
+    (void)dir;
+#else
+    std::error_code ec;
+    if (!std::filesystem::is_directory(dir, ec)) return;
+    std::vector<std::filesystem::path> files;
+    for (const auto& ent : std::filesystem::directory_iterator(dir, ec)) {
+        if (!ent.is_regular_file()) continue;
+#if defined(__APPLE__)
+        if (ent.path().extension() != ".dylib" && ent.path().extension() != ".so") continue;
+#else
+        if (ent.path().extension() != ".so") continue;
+#endif
+        files.push_back(ent.path());
+    }
+    if (files.empty()) return;
+    ThreadPool::shared().submit([files = std::move(files)] {
+        for (const auto& f : files) prefault_file(f);
+    });
+#endif
+}
+
 size_t PluginManager::load_new_from_dir(const std::filesystem::path& dir,
                                         IToolRegistrar* registrar,
                                         std::string* err) {
     size_t loaded = 0;
     if (!std::filesystem::exists(dir) || !std::filesystem::is_directory(dir)) return 0;
 
+    // Run-loop callers rescan this directory every step looking for plugins
+    // genesis dropped mid-run. Skip the enumeration (and the per-file
+    // canonicalization inside is_loaded) when the directory hasn't changed
+    // since the last fully successful scan; adding or replacing a file
+    // bumps the dir mtime.
+    std::error_code mtime_ec;
+    auto dir_mtime = std::filesystem::last_write_time(dir, mtime_ec);
+    std::string dir_key = canonical_str(dir);
+    if (!mtime_ec) {
+        auto it = dir_mtimes_.find(dir_key);
+        if (it != dir_mtimes_.end() && it->second == dir_mtime) return 0;
+    }
+
     std::vector<std::filesystem::path> candidates;
     for (const auto& ent : std::filesystem::directory_iterator(dir)) {
         if (!ent.is_regular_file()) continue;
@@ -189,6 +275,7 @@ size_t PluginManager::load_new_from_dir(const std::filesystem::path& dir,
     }
     std::sort(candidates.begin(), candidates.end());
 
+    bool any_failed = false;
     for (const auto& p : candidates) {
         if (is_loaded(p)) continue;
         std::string e;
@@ -196,9 +283,16 @@ size_t PluginManager::load_new_from_dir(const std::filesystem::path& dir,
             loaded++;
         } else {
             // Best-effort: keep going, but report first error.
+            any_failed = true;
             if (err && err->empty()) *err = e;
         }
     }
+    // Only remember the mtime when everything loaded, so a failed plugin
+    // is retried on the next scan instead of being skipped until the
+    // directory changes again.
+    if (!mtime_ec && !any_failed) {
+        dir_mtimes_[dir_key] = dir_mtime;
+    }
     return loaded;
 }
 
@@ -1,11 +1,19 @@
+#include "machina/cgroup.h"
 #include "machina/proc.h"
+#include "machina/trace.h"
 #include "machina/sandbox.h"
+#include "machina/zygote.h"
 
 #include <cerrno>
 #include <cstring>
 #include <cctype>
 #include <chrono>
+#include <condition_variable>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #ifndef _WIN32
   #include <unistd.h>
@@ -17,6 +25,9 @@
   #include <poll.h>
   #ifdef __linux__
     #include <sys/prctl.h>
+    #include <sched.h>
+    #include <sys/syscall.h>
+    extern char** environ;
   #endif
 #endif
 
@@ -72,7 +83,210 @@ static void set_rlimit(int resource, rlim_t soft, rlim_t hard) {
     (void)setrlimit(resource, &rl);
 }
 
+void proc_apply_rlimits(const ProcLimits& lim) {
+    if (lim.rlimit_cpu_sec > 0) {
+        set_rlimit(RLIMIT_CPU, (rlim_t)lim.rlimit_cpu_sec, (rlim_t)lim.rlimit_cpu_sec);
+    }
+    if (lim.rlimit_as_mb > 0) {
+        rlim_t bytes = (rlim_t)lim.rlimit_as_mb * 1024ULL * 1024ULL;
+        set_rlimit(RLIMIT_AS, bytes, bytes);
+    }
+    if (lim.rlimit_fsize_mb > 0) {
+        rlim_t bytes = (rlim_t)lim.rlimit_fsize_mb * 1024ULL * 1024ULL;
+        set_rlimit(RLIMIT_FSIZE, bytes, bytes);
+    }
+    if (lim.rlimit_nofile > 0) {
+        set_rlimit(RLIMIT_NOFILE, (rlim_t)lim.rlimit_nofile, (rlim_t)lim.rlimit_nofile);
+    }
+#ifdef RLIMIT_NPROC
+    if (lim.rlimit_nproc > 0) {
+        set_rlimit(RLIMIT_NPROC, (rlim_t)lim.rlimit_nproc, (rlim_t)lim.rlimit_nproc);
+    }
 #endif
+}
+
+std::string proc_resolve_exe_path(const std::string& name) {
+    if (name.find('/') != std::string::npos) return name;
+    const char* path = std::getenv("PATH");
+    if (!path) return {};
+    std::string p = path;
+    size_t pos = 0;
+    while (pos <= p.size()) {
+        size_t end = p.find(':', pos);
+        if (end == std::string::npos) end = p.size();
+        std::string dir = p.substr(pos, end - pos);
+        if (dir.empty()) dir = ".";
+        std::string cand = dir + "/" + name;
+        if (access(cand.c_str(), X_OK) == 0) return cand;
+        pos = end + 1;
+    }
+    return {};
+}
+
+// Optional operator-provided wrapper (e.g., nsjail/firejail/bwrap).
+// Disabled by default; enable explicitly to avoid surprising behavior.
+static std::vector<std::string> apply_proc_wrapper(const std::vector<std::string>& argv) {
+    std::vector<std::string> eff = argv;
+    const char* en = std::getenv("MACHINA_PROC_WRAPPER_ENABLE");
+    bool on = false;
+    if (en) {
+        std::string s = en;
+        for (auto& c : s) c = (char)std::tolower((unsigned char)c);
+        on = (s == "1" || s == "true" || s == "yes" || s == "on");
+    }
+    if (!on) return eff;
+    const char* w = std::getenv("MACHINA_PROC_WRAPPER");
+    if (!w) return eff;
+    auto toks = split_argv_quoted(w);
+    if (toks.empty()) return eff;
+    // Prepend wrapper tokens to argv.
+    std::vector<std::string> merged;
+    merged.reserve(toks.size() + eff.size());
+    merged.insert(merged.end(), toks.begin(), toks.end());
+    merged.insert(merged.end(), eff.begin(), eff.end());
+    return merged;
+}
+
+// Capture loops read in 64 KiB chunks directly into the tail of the output
+// string — no intermediate stack buffer, no extra copy per chunk.
+static constexpr size_t kCaptureChunk = 64 * 1024;
+
+// Enlarge the capture pipe beyond the 64 KiB default (best-effort; subject
+// to /proc/sys/fs/pipe-max-size) so a bursty child can keep writing between
+// parent polls instead of blocking every page.
+static void widen_capture_pipe(int fd, size_t want_bytes) {
+#ifdef F_SETPIPE_SZ
+    size_t want = std::min<size_t>(want_bytes, 1024 * 1024);
+    if (want > kCaptureChunk) (void)fcntl(fd, F_SETPIPE_SZ, (int)want);
+#else
+    (void)fd; (void)want_bytes;
+#endif
+}
+
+// One read() into the tail of `out`, capped at max_bytes total; bytes past
+// the cap are discarded (the pipe still drains) and *truncated is set.
+// Returns read()'s result so callers keep their EOF/EAGAIN handling.
+static ssize_t read_capture_chunk(int fd, std::string& out, size_t max_bytes, bool* truncated) {
+    size_t old = out.size();
+    out.resize(old + kCaptureChunk);
+    ssize_t n = read(fd, &out[old], kCaptureChunk);
+    if (n <= 0) {
+        out.resize(old);
+        return n;
+    }
+    size_t take = (size_t)n;
+    size_t can = max_bytes > old ? max_bytes - old : 0;
+    if (take > can) {
+        take = can;
+        *truncated = true;
+    }
+    out.resize(old + take);
+    return n;
+}
+#endif
+
+#ifdef __linux__
+// Fast spawn path: fork() copies the parent's page tables, which is
+// measurably slow (and an overcommit hazard) once the daemon carries multi-GB
+// of mmapped vector streams and caches. glibc's posix_spawn avoids that via
+// clone(CLONE_VM|CLONE_VFORK) but cannot express rlimits, so we use the same
+// mechanism directly: everything the child needs (resolved path, argv, envp,
+// limits) is assembled in the parent, and the child function only performs
+// async-signal-safe syscalls before execve. CLONE_VFORK suspends the parent
+// until exec, so the borrowed context stays valid. seccomp runs keep the
+// full fork path.
+struct FastSpawnCtx {
+    const char* path;
+    char* const* argv;
+    char* const* envp;
+    const ProcLimits* lim;
+    const char* cwd;   // nullptr when no chdir wanted
+    int stdin_fd;      // dup2'd onto 0 when >= 0
+    int stdout_fd;     // dup2'd onto 1 and 2
+};
+
+static int fast_spawn_child(void* p) {
+    const auto* c = static_cast<const FastSpawnCtx*>(p);
+    if (c->stdin_fd >= 0) (void)dup2(c->stdin_fd, STDIN_FILENO);
+    (void)dup2(c->stdout_fd, STDOUT_FILENO);
+    (void)dup2(c->stdout_fd, STDERR_FILENO);
+
+    (void)setpgid(0, 0);
+    (void)umask(077); // fs attributes are copied (no CLONE_FS); parent unaffected
+
+    // close inherited fds beyond stdin/stdout/stderr
+#ifdef SYS_close_range
+    if (syscall(SYS_close_range, 3, ~0u, 0) != 0)
+#endif
+    {
+        long maxfd = sysconf(_SC_OPEN_MAX);
+        if (maxfd < 256) maxfd = 256;
+        for (int fd = 3; fd < maxfd; fd++) (void)close(fd);
+    }
+
+    if (c->cwd) (void)chdir(c->cwd);
+
+    if (c->lim->no_new_privs) {
+        (void)prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+    }
+    (void)prctl(PR_SET_PDEATHSIG, SIGKILL);
+
+    proc_apply_rlimits(*c->lim);
+
+    execve(c->path, c->argv, c->envp);
+    _exit(127);
+}
+
+static bool fast_spawn_enabled() {
+    const char* v = std::getenv("MACHINA_PROC_FAST_SPAWN");
+    if (!v) return true;
+    std::string s = v;
+    for (auto& ch : s) ch = (char)std::tolower((unsigned char)ch);
+    return !(s == "0" || s == "false" || s == "no" || s == "off");
+}
+
+// Returns the child pid, or -1 when the fast path is disabled or failed —
+// callers fall back to the fork path.
+static pid_t proc_fast_spawn(const std::vector<std::string>& eff_argv,
+                             const std::string& cwd,
+                             const ProcLimits& lim,
+                             int stdin_fd, int stdout_fd) {
+    if (!fast_spawn_enabled()) return -1;
+    // execvp resolves PATH lazily but allocates, which the CLONE_VM child
+    // must not do — resolve here instead.
+    std::string path = proc_resolve_exe_path(eff_argv[0]);
+    if (path.empty()) return -1;
+
+    std::vector<char*> cargv;
+    cargv.reserve(eff_argv.size() + 1);
+    for (const auto& s : eff_argv) cargv.push_back(const_cast<char*>(s.c_str()));
+    cargv.push_back(nullptr);
+
+    // scrub dangerous loader env vars (the fork path unsetenv()s in the
+    // child; with a shared VM that would corrupt the parent environ)
+    std::vector<char*> cenv;
+    for (char** e = environ; e && *e; e++) {
+        if (std::strncmp(*e, "LD_PRELOAD=", 11) == 0) continue;
+        if (std::strncmp(*e, "LD_LIBRARY_PATH=", 16) == 0) continue;
+        cenv.push_back(*e);
+    }
+    cenv.push_back(nullptr);
+
+    FastSpawnCtx ctx;
+    ctx.path = path.c_str();
+    ctx.argv = cargv.data();
+    ctx.envp = cenv.data();
+    ctx.lim = &lim;
+    ctx.cwd = cwd.empty() ? nullptr : cwd.c_str();
+    ctx.stdin_fd = stdin_fd;
+    ctx.stdout_fd = stdout_fd;
+
+    std::vector<char> stack(64 * 1024);
+    char* top = stack.data() + stack.size();
+    top = (char*)((uintptr_t)top & ~(uintptr_t)15);
+    return clone(fast_spawn_child, top, CLONE_VM | CLONE_VFORK | SIGCHLD, &ctx);
+}
+#endif // __linux__
 
 bool proc_run_capture_sandboxed(const std::vector<std::string>& argv,
                                const std::string& cwd,
@@ -90,30 +304,7 @@ bool proc_run_capture_sandboxed(const std::vector<std::string>& argv,
         return false;
     }
 
-    // Optional operator-provided wrapper (e.g., nsjail/firejail/bwrap).
-    // Disabled by default; enable explicitly to avoid surprising behavior.
-    auto env_true = [](const char* key) -> bool {
-        const char* v = std::getenv(key);
-        if (!v) return false;
-        std::string s = v;
-        for (auto& c : s) c = (char)std::tolower((unsigned char)c);
-        return (s == "1" || s == "true" || s == "yes" || s == "on");
-    };
-
-    std::vector<std::string> eff_argv = argv;
-    if (env_true("MACHINA_PROC_WRAPPER_ENABLE")) {
-        if (const char* w = std::getenv("MACHINA_PROC_WRAPPER")) {
-            auto toks = split_argv_quoted(w);
-            if (!toks.empty()) {
-                // Prepend wrapper tokens to argv.
-                std::vector<std::string> merged;
-                merged.reserve(toks.size() + eff_argv.size());
-                merged.insert(merged.end(), toks.begin(), toks.end());
-                merged.insert(merged.end(), eff_argv.begin(), eff_argv.end());
-                eff_argv.swap(merged);
-            }
-        }
-    }
+    std::vector<std::string> eff_argv = apply_proc_wrapper(argv);
 
     int pipefd[2];
     if (pipe(pipefd) != 0) {
@@ -124,8 +315,42 @@ bool proc_run_capture_sandboxed(const std::vector<std::string>& argv,
     // Make read end non-blocking
     int flags = fcntl(pipefd[0], F_GETFL, 0);
     if (flags >= 0) (void)fcntl(pipefd[0], F_SETFL, flags | O_NONBLOCK);
+    widen_capture_pipe(pipefd[0], lim.stdout_max_bytes);
+
+    // compile the filter pre-fork so the child's install is one prctl
+    if (lim.enable_seccomp) (void)seccomp_filter_precompile();
 
-    pid_t pid = fork();
+    // cgroup v2 limits (opt-in): the parent creates a transient group up
+    // front, the child joins it before exec, and the parent removes it after
+    // reaping. When creation fails (no delegation), rlimits stand alone.
+    std::string cg_dir;
+#ifdef __linux__
+    if (cgroup_available(lim)) {
+        std::string cg_err;
+        cg_dir = cgroup_create_transient(lim, &cg_err);
+    }
+#endif
+
+    // Spawn span is recorded manually: a scoped span would also unwind in
+    // the forked child before its exec, double-counting (and racing the
+    // Chrome sink fd). Only the parent (pid > 0) records.
+    static TraceStage* spawn_stage = trace_stage("proc_spawn");
+    int64_t spawn_t0 = spawn_stage ? trace_now_us() : 0;
+
+    pid_t pid = -1;
+#ifdef __linux__
+    // seccomp installation and cgroup joins keep the fork path, so only the
+    // plain rlimit+fd case takes the zygote/clone fast paths; -1 falls
+    // through to fork.
+    if (!lim.enable_seccomp && cg_dir.empty()) {
+        pid = zygote_spawn(eff_argv, cwd, lim, -1, pipefd[1]);
+        if (pid < 0) pid = proc_fast_spawn(eff_argv, cwd, lim, -1, pipefd[1]);
+    }
+#endif
+    if (pid < 0) pid = fork();
+    if (pid > 0 && spawn_stage) {
+        trace_record(spawn_stage, "proc_spawn", spawn_t0, trace_now_us() - spawn_t0);
+    }
     if (pid < 0) {
         close(pipefd[0]); close(pipefd[1]);
         res->error = std::string("fork failed: ") + std::strerror(errno);
@@ -168,25 +393,13 @@ bool proc_run_capture_sandboxed(const std::vector<std::string>& argv,
         (void)prctl(PR_SET_PDEATHSIG, SIGKILL);
 #endif
 
-        if (lim.rlimit_cpu_sec > 0) {
-            set_rlimit(RLIMIT_CPU, (rlim_t)lim.rlimit_cpu_sec, (rlim_t)lim.rlimit_cpu_sec);
-        }
-        if (lim.rlimit_as_mb > 0) {
-            rlim_t bytes = (rlim_t)lim.rlimit_as_mb * 1024ULL * 1024ULL;
-            set_rlimit(RLIMIT_AS, bytes, bytes);
-        }
-        if (lim.rlimit_fsize_mb > 0) {
-            rlim_t bytes = (rlim_t)lim.rlimit_fsize_mb * 1024ULL * 1024ULL;
-            set_rlimit(RLIMIT_FSIZE, bytes, bytes);
-        }
-        if (lim.rlimit_nofile > 0) {
-            set_rlimit(RLIMIT_NOFILE, (rlim_t)lim.rlimit_nofile, (rlim_t)lim.rlimit_nofile);
-        }
-#ifdef RLIMIT_NPROC
-        if (lim.rlimit_nproc > 0) {
-            set_rlimit(RLIMIT_NPROC, (rlim_t)lim.rlimit_nproc, (rlim_t)lim.rlimit_nproc);
+        ProcLimits child_lim = lim;
+#ifdef __linux__
+        if (!cg_dir.empty() && cgroup_join(cg_dir)) {
+            child_lim.rlimit_as_mb = 0; // memory.max governs; AS would false-positive
         }
 #endif
+        proc_apply_rlimits(child_lim);
 
         // seccomp-BPF: install syscall allowlist (must come after no_new_privs)
         if (lim.enable_seccomp) {
@@ -211,30 +424,16 @@ bool proc_run_capture_sandboxed(const std::vector<std::string>& argv,
 
     auto start = std::chrono::steady_clock::now();
     std::string out;
-    out.reserve(std::min<size_t>(lim.stdout_max_bytes, 64 * 1024));
+    out.reserve(std::min<size_t>(lim.stdout_max_bytes + kCaptureChunk, 1024 * 1024));
 
     bool child_exited = false;
     int status = 0;
 
     while (true) {
         // read available output
-        char buf[4096];
         while (true) {
-            ssize_t n = read(pipefd[0], buf, sizeof(buf));
-            if (n > 0) {
-                size_t can = lim.stdout_max_bytes > out.size() ? (lim.stdout_max_bytes - out.size()) : 0;
-                if (can > 0) {
-                    size_t take = (size_t)n;
-                    if (take > can) {
-                        take = can;
-                        res->output_truncated = true;
-                    }
-                    out.append(buf, buf + take);
-                } else {
-                    res->output_truncated = true;
-                }
-                continue;
-            }
+            ssize_t n = read_capture_chunk(pipefd[0], out, lim.stdout_max_bytes, &res->output_truncated);
+            if (n > 0) continue;
             if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
             if (n == 0) break; // EOF
             break;
@@ -274,26 +473,16 @@ bool proc_run_capture_sandboxed(const std::vector<std::string>& argv,
 
     // drain any remaining output
     while (true) {
-        char buf[4096];
-        ssize_t n = read(pipefd[0], buf, sizeof(buf));
-        if (n > 0) {
-            size_t can = lim.stdout_max_bytes > out.size() ? (lim.stdout_max_bytes - out.size()) : 0;
-            if (can > 0) {
-                size_t take = (size_t)n;
-                if (take > can) {
-                    take = can;
-                    res->output_truncated = true;
-                }
-                out.append(buf, buf + take);
-            } else {
-                res->output_truncated = true;
-            }
-            continue;
-        }
+        ssize_t n = read_capture_chunk(pipefd[0], out, lim.stdout_max_bytes, &res->output_truncated);
+        if (n > 0) continue;
         break;
     }
     close(pipefd[0]);
 
+#ifdef __linux__
+    if (!cg_dir.empty()) cgroup_remove(cg_dir);
+#endif
+
     res->output = std::move(out);
     if (!child_exited) {
         res->exit_code = 128;
@@ -328,28 +517,7 @@ bool proc_run_capture_sandboxed_stdin(const std::vector<std::string>& argv,
         return false;
     }
 
-    // Optional operator-provided wrapper (e.g., nsjail/firejail/bwrap).
-    auto env_true = [](const char* key) -> bool {
-        const char* v = std::getenv(key);
-        if (!v) return false;
-        std::string s = v;
-        for (auto& c : s) c = (char)std::tolower((unsigned char)c);
-        return (s == "1" || s == "true" || s == "yes" || s == "on");
-    };
-
-    std::vector<std::string> eff_argv = argv;
-    if (env_true("MACHINA_PROC_WRAPPER_ENABLE")) {
-        if (const char* w = std::getenv("MACHINA_PROC_WRAPPER")) {
-            auto toks = split_argv_quoted(w);
-            if (!toks.empty()) {
-                std::vector<std::string> merged;
-                merged.reserve(toks.size() + eff_argv.size());
-                merged.insert(merged.end(), toks.begin(), toks.end());
-                merged.insert(merged.end(), eff_argv.begin(), eff_argv.end());
-                eff_argv.swap(merged);
-            }
-        }
-    }
+    std::vector<std::string> eff_argv = apply_proc_wrapper(argv);
 
     int out_pipe[2];
     if (pipe(out_pipe) != 0) {
@@ -367,8 +535,18 @@ bool proc_run_capture_sandboxed_stdin(const std::vector<std::string>& argv,
     // Make read end non-blocking
     int flags = fcntl(out_pipe[0], F_GETFL, 0);
     if (flags >= 0) (void)fcntl(out_pipe[0], F_SETFL, flags | O_NONBLOCK);
+    widen_capture_pipe(out_pipe[0], lim.stdout_max_bytes);
 
-    pid_t pid = fork();
+    if (lim.enable_seccomp) (void)seccomp_filter_precompile();
+
+    pid_t pid = -1;
+#ifdef __linux__
+    if (!lim.enable_seccomp) {
+        pid = zygote_spawn(eff_argv, cwd, lim, in_pipe[0], out_pipe[1]);
+        if (pid < 0) pid = proc_fast_spawn(eff_argv, cwd, lim, in_pipe[0], out_pipe[1]);
+    }
+#endif
+    if (pid < 0) pid = fork();
     if (pid < 0) {
         close(out_pipe[0]); close(out_pipe[1]);
         close(in_pipe[0]); close(in_pipe[1]);
@@ -410,25 +588,7 @@ bool proc_run_capture_sandboxed_stdin(const std::vector<std::string>& argv,
         (void)prctl(PR_SET_PDEATHSIG, SIGKILL);
 #endif
 
-        if (lim.rlimit_cpu_sec > 0) {
-            set_rlimit(RLIMIT_CPU, (rlim_t)lim.rlimit_cpu_sec, (rlim_t)lim.rlimit_cpu_sec);
-        }
-        if (lim.rlimit_as_mb > 0) {
-            rlim_t bytes = (rlim_t)lim.rlimit_as_mb * 1024ULL * 1024ULL;
-            set_rlimit(RLIMIT_AS, bytes, bytes);
-        }
-        if (lim.rlimit_fsize_mb > 0) {
-            rlim_t bytes = (rlim_t)lim.rlimit_fsize_mb * 1024ULL * 1024ULL;
-            set_rlimit(RLIMIT_FSIZE, bytes, bytes);
-        }
-        if (lim.rlimit_nofile > 0) {
-            set_rlimit(RLIMIT_NOFILE, (rlim_t)lim.rlimit_nofile, (rlim_t)lim.rlimit_nofile);
-        }
-#ifdef RLIMIT_NPROC
-        if (lim.rlimit_nproc > 0) {
-            set_rlimit(RLIMIT_NPROC, (rlim_t)lim.rlimit_nproc, (rlim_t)lim.rlimit_nproc);
-        }
-#endif
+        proc_apply_rlimits(lim);
 
         // seccomp-BPF: install syscall allowlist (must come after no_new_privs)
         if (lim.enable_seccomp) {
@@ -465,22 +625,11 @@ bool proc_run_capture_sandboxed_stdin(const std::vector<std::string>& argv,
 
     auto start = std::chrono::steady_clock::now();
     std::string out;
-    out.reserve(std::min<size_t>(lim.stdout_max_bytes, 64 * 1024));
+    out.reserve(std::min<size_t>(lim.stdout_max_bytes + kCaptureChunk, 1024 * 1024));
 
     bool child_exited = false;
     int status = 0;
 
-    auto append_stdout = [&](const char* buf, ssize_t n) {
-        size_t can = lim.stdout_max_bytes > out.size() ? (lim.stdout_max_bytes - out.size()) : 0;
-        if (can > 0) {
-            size_t take = (size_t)n;
-            if (take > can) { take = can; res->output_truncated = true; }
-            out.append(buf, buf + take);
-        } else {
-            res->output_truncated = true;
-        }
-    };
-
     while (true) {
         struct pollfd fds[2];
         int nfds = 0;
@@ -533,16 +682,13 @@ bool proc_run_capture_sandboxed_stdin(const std::vector<std::string>& argv,
 
         // Handle stdout read
         if (fds[out_idx].revents & POLLIN) {
-            char buf[4096];
-            ssize_t n = read(out_pipe[0], buf, sizeof(buf));
-            if (n > 0) append_stdout(buf, n);
+            (void)read_capture_chunk(out_pipe[0], out, lim.stdout_max_bytes, &res->output_truncated);
         }
         if (fds[out_idx].revents & (POLLERR | POLLHUP)) {
             // Pipe closed — drain remaining
-            char buf[4096];
             while (true) {
-                ssize_t n = read(out_pipe[0], buf, sizeof(buf));
-                if (n > 0) { append_stdout(buf, n); continue; }
+                ssize_t n = read_capture_chunk(out_pipe[0], out, lim.stdout_max_bytes, &res->output_truncated);
+                if (n > 0) continue;
                 break;
             }
         }
@@ -560,14 +706,236 @@ bool proc_run_capture_sandboxed_stdin(const std::vector<std::string>& argv,
 
     // Drain any remaining output after child exits
     while (true) {
-        char buf[4096];
+        ssize_t n = read_capture_chunk(out_pipe[0], out, lim.stdout_max_bytes, &res->output_truncated);
+        if (n > 0) continue;
+        break;
+    }
+    close(out_pipe[0]);
+
+    res->output = std::move(out);
+    if (child_exited) {
+        if (WIFEXITED(status)) res->exit_code = WEXITSTATUS(status);
+        else if (WIFSIGNALED(status)) res->exit_code = 128 + WTERMSIG(status);
+        else res->exit_code = 127;
+    } else {
+        res->exit_code = 127;
+    }
+
+    return true;
+#endif
+}
+
+bool proc_run_stream_sandboxed(const std::vector<std::string>& argv,
+                               const std::string& cwd,
+                               const std::function<bool(std::string*)>& next_stdin_chunk,
+                               const std::function<void(const char*, size_t)>& on_stdout,
+                               const ProcLimits& lim,
+                               ProcResult* res) {
+    if (!res) return false;
+    *res = ProcResult{};
+
+#ifdef _WIN32
+    (void)argv; (void)cwd; (void)next_stdin_chunk; (void)on_stdout; (void)lim;
+    res->error = "proc_run_stream_sandboxed: not supported on Windows in this snapshot";
+    return false;
+#else
+    if (argv.empty() || argv[0].empty()) {
+        res->error = "empty argv";
+        return false;
+    }
+
+    int out_pipe[2];
+    if (pipe(out_pipe) != 0) {
+        res->error = std::string("pipe(out) failed: ") + std::strerror(errno);
+        return false;
+    }
+
+    int in_pipe[2];
+    if (pipe(in_pipe) != 0) {
+        close(out_pipe[0]); close(out_pipe[1]);
+        res->error = std::string("pipe(in) failed: ") + std::strerror(errno);
+        return false;
+    }
+
+    int flags = fcntl(out_pipe[0], F_GETFL, 0);
+    if (flags >= 0) (void)fcntl(out_pipe[0], F_SETFL, flags | O_NONBLOCK);
+
+    if (lim.enable_seccomp) (void)seccomp_filter_precompile();
+
+    pid_t pid = -1;
+#ifdef __linux__
+    if (!lim.enable_seccomp) {
+        pid = zygote_spawn(argv, cwd, lim, in_pipe[0], out_pipe[1]);
+        if (pid < 0) pid = proc_fast_spawn(argv, cwd, lim, in_pipe[0], out_pipe[1]);
+    }
+#endif
+    if (pid < 0) pid = fork();
+    if (pid < 0) {
+        close(out_pipe[0]); close(out_pipe[1]);
+        close(in_pipe[0]); close(in_pipe[1]);
+        res->error = std::string("fork failed: ") + std::strerror(errno);
+        return false;
+    }
+
+    if (pid == 0) {
+        // child — identical setup to the stdin-capture variant
+        (void)dup2(in_pipe[0], STDIN_FILENO);
+        (void)dup2(out_pipe[1], STDOUT_FILENO);
+        (void)dup2(out_pipe[1], STDERR_FILENO);
+
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        close(in_pipe[0]);
+        close(in_pipe[1]);
+
+        (void)setpgid(0, 0);
+        (void)umask(077);
+
+        long maxfd = sysconf(_SC_OPEN_MAX);
+        if (maxfd < 256) maxfd = 256;
+        for (int fd = 3; fd < maxfd; fd++) {
+            (void)close(fd);
+        }
+
+        if (!cwd.empty()) {
+            (void)chdir(cwd.c_str());
+        }
+
+        unsetenv("LD_PRELOAD");
+        unsetenv("LD_LIBRARY_PATH");
+
+#ifdef __linux__
+        if (lim.no_new_privs) {
+            (void)prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+        }
+        (void)prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+
+        proc_apply_rlimits(lim);
+
+        if (lim.enable_seccomp) {
+            (void)install_seccomp_filter();
+        }
+
+        std::vector<char*> cargv;
+        cargv.reserve(argv.size() + 1);
+        for (const auto& ss : argv) cargv.push_back(const_cast<char*>(ss.c_str()));
+        cargv.push_back(nullptr);
+
+        execvp(cargv[0], cargv.data());
+        _exit(127);
+    }
+
+    // parent
+    (void)setpgid(pid, pid);
+    close(out_pipe[1]);
+    close(in_pipe[0]);
+
+    int in_fd = in_pipe[1];
+    {
+        int f = fcntl(in_fd, F_GETFL, 0);
+        if (f >= 0) fcntl(in_fd, F_SETFL, f | O_NONBLOCK);
+    }
+
+    std::string pending;   // current stdin chunk, partially written
+    size_t pend_off = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    bool child_exited = false;
+    int status = 0;
+
+    while (true) {
+        // Refill the pending chunk from the generator before deciding what
+        // to poll for; close stdin when the generator is exhausted.
+        if (in_fd >= 0 && pend_off >= pending.size()) {
+            pending.clear();
+            pend_off = 0;
+            while (pending.empty()) {
+                if (!next_stdin_chunk(&pending)) {
+                    close(in_fd);
+                    in_fd = -1;
+                    break;
+                }
+            }
+        }
+
+        struct pollfd fds[2];
+        int nfds = 0;
+        int in_idx = -1, out_idx = -1;
+        if (in_fd >= 0) {
+            in_idx = nfds;
+            fds[nfds].fd = in_fd;
+            fds[nfds].events = POLLOUT;
+            nfds++;
+        }
+        out_idx = nfds;
+        fds[nfds].fd = out_pipe[0];
+        fds[nfds].events = POLLIN;
+        nfds++;
+
+        int elapsed_ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        int slice = 100;
+        if (lim.timeout_ms > 0) {
+            int remaining = lim.timeout_ms - elapsed_ms;
+            if (remaining <= 0) {
+                res->timed_out = true;
+                (void)kill(-pid, SIGKILL);
+                (void)kill(pid, SIGKILL);
+                (void)waitpid(pid, &status, 0);
+                child_exited = true;
+                break;
+            }
+            if (remaining < slice) slice = remaining;
+        }
+
+        int pr = poll(fds, (nfds_t)nfds, slice);
+        if (pr < 0 && errno == EINTR) continue;
+
+        if (in_idx >= 0 && (fds[in_idx].revents & (POLLOUT | POLLERR | POLLHUP))) {
+            while (pend_off < pending.size()) {
+                ssize_t n = write(in_fd, pending.data() + pend_off, pending.size() - pend_off);
+                if (n > 0) { pend_off += (size_t)n; continue; }
+                if (n == -1 && errno == EINTR) continue;
+                if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                // write error (child likely gone) — stop feeding stdin
+                close(in_fd);
+                in_fd = -1;
+                break;
+            }
+        }
+
+        if (fds[out_idx].revents & POLLIN) {
+            char buf[8192];
+            ssize_t n = read(out_pipe[0], buf, sizeof(buf));
+            if (n > 0) on_stdout(buf, (size_t)n);
+        }
+        if (fds[out_idx].revents & (POLLERR | POLLHUP)) {
+            char buf[8192];
+            while (true) {
+                ssize_t n = read(out_pipe[0], buf, sizeof(buf));
+                if (n > 0) { on_stdout(buf, (size_t)n); continue; }
+                break;
+            }
+        }
+
+        pid_t w = waitpid(pid, &status, WNOHANG);
+        if (w == pid) {
+            child_exited = true;
+            break;
+        }
+    }
+    if (in_fd >= 0) close(in_fd);
+
+    // Drain any remaining output after child exit.
+    while (true) {
+        char buf[8192];
         ssize_t n = read(out_pipe[0], buf, sizeof(buf));
-        if (n > 0) { append_stdout(buf, n); continue; }
+        if (n > 0) { on_stdout(buf, (size_t)n); continue; }
         break;
     }
     close(out_pipe[0]);
 
-    res->output = out;
     if (child_exited) {
         if (WIFEXITED(status)) res->exit_code = WEXITSTATUS(status);
         else if (WIFSIGNALED(status)) res->exit_code = 128 + WTERMSIG(status);
@@ -580,4 +948,377 @@ bool proc_run_capture_sandboxed_stdin(const std::vector<std::string>& argv,
 #endif
 }
 
+// --- Async execution --------------------------------------------------------
+// One detached reactor thread multiplexes every async child: it polls all
+// stdout pipes and pending stdin writes in a single loop, reaps children
+// with WNOHANG, and enforces per-child timeouts, so fanning out N tools
+// costs N children plus one thread instead of N blocked threads.
+
+#ifndef _WIN32
+
+namespace {
+
+struct AsyncJob {
+    pid_t pid{-1};
+    int out_fd{-1};
+    int in_fd{-1};
+    std::string stdin_data;
+    size_t write_off{0};
+    ProcLimits lim;
+    std::chrono::steady_clock::time_point start;
+    std::string out;
+    ProcResult res;
+    int status{0};
+    bool child_exited{false};
+    bool done{false};
+};
+
+class ProcReactor {
+public:
+    static ProcReactor& instance() {
+        static ProcReactor r;
+        return r;
+    }
+
+    uint64_t add(std::unique_ptr<AsyncJob> job) {
+        uint64_t id;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            id = next_id_++;
+            jobs_[id] = std::move(job);
+        }
+        wake();
+        return id;
+    }
+
+    // Fetch a finished job's result; with block, sleep until it finishes.
+    // Consumes the handle on success.
+    bool take(uint64_t id, ProcResult* res, bool block) {
+        std::unique_lock<std::mutex> lk(mu_);
+        auto it = jobs_.find(id);
+        if (it == jobs_.end()) return false;
+        if (!it->second->done) {
+            if (!block) return false;
+            // Job objects are stable behind unique_ptr, but concurrent add()
+            // can rehash the map — re-find after the wait.
+            AsyncJob* j = it->second.get();
+            cv_.wait(lk, [j] { return j->done; });
+            it = jobs_.find(id);
+            if (it == jobs_.end()) return false;
+        }
+        if (res) *res = std::move(it->second->res);
+        jobs_.erase(it);
+        return true;
+    }
+
+private:
+    ProcReactor() {
+        if (pipe(wake_fd_) != 0) {
+            wake_fd_[0] = wake_fd_[1] = -1;
+        } else {
+            for (int i = 0; i < 2; i++) {
+                int f = fcntl(wake_fd_[i], F_GETFL, 0);
+                if (f >= 0) (void)fcntl(wake_fd_[i], F_SETFL, f | O_NONBLOCK);
+                (void)fcntl(wake_fd_[i], F_SETFD, FD_CLOEXEC);
+            }
+        }
+        std::thread([this] { run(); }).detach();
+    }
+
+    void wake() {
+        if (wake_fd_[1] >= 0) {
+            ssize_t w = write(wake_fd_[1], "w", 1);
+            (void)w;
+        }
+    }
+
+    static int job_elapsed_ms(const AsyncJob& j) {
+        return (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - j.start).count();
+    }
+
+    // Caller holds mu_.
+    void finalize(AsyncJob& j) {
+        j.res.output = std::move(j.out);
+        if (j.child_exited) {
+            if (WIFEXITED(j.status)) j.res.exit_code = WEXITSTATUS(j.status);
+            else if (WIFSIGNALED(j.status)) j.res.exit_code = 128 + WTERMSIG(j.status);
+            else j.res.exit_code = 128;
+        } else {
+            j.res.exit_code = 128;
+            j.res.error = "child did not exit";
+        }
+        j.done = true;
+        cv_.notify_all();
+    }
+
+    // Caller holds mu_. Pipes are non-blocking, so every loop is bounded.
+    void service(AsyncJob& j, short out_rev, short in_rev) {
+        if (j.in_fd >= 0 && (in_rev & (POLLOUT | POLLERR | POLLHUP))) {
+            while (j.write_off < j.stdin_data.size()) {
+                ssize_t n = write(j.in_fd, j.stdin_data.data() + j.write_off,
+                                  j.stdin_data.size() - j.write_off);
+                if (n > 0) { j.write_off += (size_t)n; continue; }
+                if (n == -1 && errno == EINTR) continue;
+                if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                j.write_off = j.stdin_data.size(); // error — stop writing
+                break;
+            }
+            if (j.write_off >= j.stdin_data.size()) {
+                close(j.in_fd);
+                j.in_fd = -1;
+            }
+        }
+
+        if (j.out_fd >= 0 && (out_rev & (POLLIN | POLLERR | POLLHUP))) {
+            while (true) {
+                ssize_t n = read_capture_chunk(j.out_fd, j.out, j.lim.stdout_max_bytes,
+                                               &j.res.output_truncated);
+                if (n > 0) continue;
+                if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                close(j.out_fd); // EOF or read error
+                j.out_fd = -1;
+                break;
+            }
+        }
+
+        if (!j.child_exited) {
+            pid_t w = waitpid(j.pid, &j.status, WNOHANG);
+            if (w == j.pid) {
+                j.child_exited = true;
+            } else if (j.lim.timeout_ms > 0 && !j.res.timed_out
+                       && job_elapsed_ms(j) > j.lim.timeout_ms) {
+                j.res.timed_out = true;
+                (void)kill(-j.pid, SIGKILL);
+                (void)kill(j.pid, SIGKILL); // reaped with WNOHANG on a later pass
+            }
+        }
+
+        if (j.child_exited) {
+            if (j.out_fd >= 0) {
+                // drain whatever the child flushed before exiting
+                while (true) {
+                    ssize_t n = read_capture_chunk(j.out_fd, j.out, j.lim.stdout_max_bytes,
+                                                   &j.res.output_truncated);
+                    if (n > 0) continue;
+                    break;
+                }
+                close(j.out_fd);
+                j.out_fd = -1;
+            }
+            if (j.in_fd >= 0) {
+                close(j.in_fd);
+                j.in_fd = -1;
+            }
+            finalize(j);
+        }
+    }
+
+    void run() {
+        std::vector<struct pollfd> fds;
+        std::vector<uint64_t> owners; // job id per fds entry (wake fd excluded)
+        while (true) {
+            fds.clear();
+            owners.clear();
+            int slice = 1000;
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                for (auto& kv : jobs_) {
+                    AsyncJob& j = *kv.second;
+                    if (j.done) continue;
+                    slice = 50; // active child: short slices for timeouts and reaping
+                    if (j.out_fd >= 0) {
+                        fds.push_back({j.out_fd, POLLIN, 0});
+                        owners.push_back(kv.first);
+                    }
+                    if (j.in_fd >= 0) {
+                        fds.push_back({j.in_fd, POLLOUT, 0});
+                        owners.push_back(kv.first);
+                    }
+                }
+            }
+            if (wake_fd_[0] >= 0) fds.push_back({wake_fd_[0], POLLIN, 0});
+            (void)poll(fds.data(), (nfds_t)fds.size(), slice);
+            if (wake_fd_[0] >= 0) {
+                char buf[64];
+                while (read(wake_fd_[0], buf, sizeof(buf)) > 0) {}
+            }
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                // Fold revents back onto the surviving jobs; entries whose job
+                // was consumed between the snapshot and now are just skipped.
+                std::unordered_map<uint64_t, std::pair<short, short>> rev;
+                for (size_t i = 0; i < owners.size(); i++) {
+                    auto& pr = rev[owners[i]];
+                    if (fds[i].events == POLLIN) pr.first = (short)(pr.first | fds[i].revents);
+                    else pr.second = (short)(pr.second | fds[i].revents);
+                }
+                for (auto& kv : jobs_) {
+                    if (kv.second->done) continue;
+                    auto it = rev.find(kv.first);
+                    short orv = (it != rev.end()) ? it->second.first : 0;
+                    short irv = (it != rev.end()) ? it->second.second : 0;
+                    service(*kv.second, orv, irv);
+                }
+            }
+        }
+    }
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::unordered_map<uint64_t, std::unique_ptr<AsyncJob>> jobs_;
+    uint64_t next_id_{1};
+    int wake_fd_[2]{-1, -1};
+};
+
+} // namespace
+
+ProcAsyncHandle proc_spawn_async(const std::vector<std::string>& argv,
+                                 const std::string& cwd,
+                                 const ProcLimits& lim,
+                                 const std::string& stdin_data,
+                                 std::string* err) {
+    if (argv.empty() || argv[0].empty()) {
+        if (err) *err = "empty argv";
+        return 0;
+    }
+
+    std::vector<std::string> eff_argv = apply_proc_wrapper(argv);
+
+    int out_pipe[2];
+    if (pipe(out_pipe) != 0) {
+        if (err) *err = std::string("pipe(out) failed: ") + std::strerror(errno);
+        return 0;
+    }
+    bool want_stdin = !stdin_data.empty();
+    int in_pipe[2] = {-1, -1};
+    if (want_stdin && pipe(in_pipe) != 0) {
+        close(out_pipe[0]); close(out_pipe[1]);
+        if (err) *err = std::string("pipe(in) failed: ") + std::strerror(errno);
+        return 0;
+    }
+
+    int flags = fcntl(out_pipe[0], F_GETFL, 0);
+    if (flags >= 0) (void)fcntl(out_pipe[0], F_SETFL, flags | O_NONBLOCK);
+    widen_capture_pipe(out_pipe[0], lim.stdout_max_bytes);
+    if (want_stdin) {
+        flags = fcntl(in_pipe[1], F_GETFL, 0);
+        if (flags >= 0) (void)fcntl(in_pipe[1], F_SETFL, flags | O_NONBLOCK);
+    }
+
+    if (lim.enable_seccomp) (void)seccomp_filter_precompile();
+
+    pid_t pid = -1;
+#ifdef __linux__
+    if (!lim.enable_seccomp) {
+        pid = zygote_spawn(eff_argv, cwd, lim, want_stdin ? in_pipe[0] : -1, out_pipe[1]);
+        if (pid < 0) pid = proc_fast_spawn(eff_argv, cwd, lim, want_stdin ? in_pipe[0] : -1, out_pipe[1]);
+    }
+#endif
+    if (pid < 0) pid = fork();
+    if (pid < 0) {
+        close(out_pipe[0]); close(out_pipe[1]);
+        if (want_stdin) { close(in_pipe[0]); close(in_pipe[1]); }
+        if (err) *err = std::string("fork failed: ") + std::strerror(errno);
+        return 0;
+    }
+
+    if (pid == 0) {
+        // child (fork fallback) — mirrors proc_run_capture_sandboxed_stdin
+        if (want_stdin) (void)dup2(in_pipe[0], STDIN_FILENO);
+        (void)dup2(out_pipe[1], STDOUT_FILENO);
+        (void)dup2(out_pipe[1], STDERR_FILENO);
+
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        if (want_stdin) { close(in_pipe[0]); close(in_pipe[1]); }
+
+        (void)setpgid(0, 0);
+        (void)umask(077);
+
+        long maxfd = sysconf(_SC_OPEN_MAX);
+        if (maxfd < 256) maxfd = 256;
+        for (int fd = 3; fd < maxfd; fd++) {
+            (void)close(fd);
+        }
+
+        if (!cwd.empty()) {
+            (void)chdir(cwd.c_str());
+        }
+
+        unsetenv("LD_PRELOAD");
+        unsetenv("LD_LIBRARY_PATH");
+
+#ifdef __linux__
+        if (lim.no_new_privs) {
+            (void)prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+        }
+        (void)prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+
+        proc_apply_rlimits(lim);
+
+        if (lim.enable_seccomp) {
+            (void)install_seccomp_filter();
+        }
+
+        std::vector<char*> cargv;
+        cargv.reserve(eff_argv.size() + 1);
+        for (const auto& ss : eff_argv) cargv.push_back(const_cast<char*>(ss.c_str()));
+        cargv.push_back(nullptr);
+
+        execvp(cargv[0], cargv.data());
+        _exit(127);
+    }
+
+    // parent
+    (void)setpgid(pid, pid);
+    close(out_pipe[1]);
+    if (want_stdin) close(in_pipe[0]);
+
+    auto job = std::make_unique<AsyncJob>();
+    job->pid = pid;
+    job->out_fd = out_pipe[0];
+    job->in_fd = want_stdin ? in_pipe[1] : -1;
+    job->stdin_data = stdin_data;
+    job->lim = lim;
+    job->start = std::chrono::steady_clock::now();
+    job->out.reserve(std::min<size_t>(lim.stdout_max_bytes + kCaptureChunk, 1024 * 1024));
+    return ProcReactor::instance().add(std::move(job));
+}
+
+bool proc_async_poll(ProcAsyncHandle h, ProcResult* res) {
+    if (h == 0) return false;
+    return ProcReactor::instance().take(h, res, /*block=*/false);
+}
+
+bool proc_async_wait(ProcAsyncHandle h, ProcResult* res) {
+    if (h == 0) return false;
+    return ProcReactor::instance().take(h, res, /*block=*/true);
+}
+
+#else // _WIN32
+
+ProcAsyncHandle proc_spawn_async(const std::vector<std::string>& argv,
+                                 const std::string& cwd,
+                                 const ProcLimits& lim,
+                                 const std::string& stdin_data,
+                                 std::string* err) {
+    (void)argv; (void)cwd; (void)lim; (void)stdin_data;
+    if (err) *err = "proc_spawn_async: not supported on Windows in this snapshot";
+    return 0;
+}
+
+bool proc_async_poll(ProcAsyncHandle h, ProcResult* res) {
+    (void)h; (void)res;
+    return false;
+}
+
+bool proc_async_wait(ProcAsyncHandle h, ProcResult* res) {
+    (void)h; (void)res;
+    return false;
+}
+
+#endif
+
 } // namespace machina
@@ -1,5 +1,6 @@
 #include "machina/registry.h"
 #include "machina/json_mini.h"
+#include "machina/manifest_cache.h"
 
 #include <fstream>
 #include <sstream>
@@ -15,9 +16,21 @@ static std::string slurp(const std::string& path) {
     return ss.str();
 }
 
-void Registry::loadToolPackManifest(const std::string& manifest_path) {
+std::vector<ToolDesc> parse_toolpack_manifest(const std::string& manifest_path) {
     std::string j = slurp(manifest_path);
 
+    // Fast path: descriptors cached from an earlier parse of these exact
+    // bytes. The blob is only written after a successful parse, so a hit
+    // carries the same validation guarantees as the slow path below.
+    std::string cache_key;
+    if (manifest_cache::enabled()) {
+        cache_key = manifest_cache::content_key(j);
+        std::vector<ToolDesc> cached;
+        if (manifest_cache::load_tooldescs(cache_key, &cached) && !cached.empty()) {
+            return cached;
+        }
+    }
+
     // Parse minimal fields from the toolpack manifest.
     // We intentionally avoid validating/processing full schemas in RC1.
     if (!json_mini::has_key(j, "toolpack_id") || !json_mini::has_key(j, "tools")) {
@@ -30,6 +43,7 @@ void Registry::loadToolPackManifest(const std::string& manifest_path) {
     }
 
     auto tool_objs = json_mini::parse_array_objects_raw(*tools_raw);
+    std::vector<ToolDesc> parsed;
     for (const auto& obj : tool_objs) {
         ToolDesc d;
         d.aid = json_mini::get_string(obj, "aid").value_or("");
@@ -46,9 +60,19 @@ void Registry::loadToolPackManifest(const std::string& manifest_path) {
         if (d.aid.empty()) {
             continue;
         }
-        registerToolDesc(d, /*allow_override=*/false);
+        parsed.push_back(std::move(d));
     }
 
+    if (!cache_key.empty() && !parsed.empty()) {
+        manifest_cache::save_tooldescs(cache_key, parsed);
+    }
+    return parsed;
+}
+
+void Registry::loadToolPackManifest(const std::string& manifest_path) {
+    for (const auto& d : parse_toolpack_manifest(manifest_path)) {
+        registerToolDesc(d, /*allow_override=*/false);
+    }
     if (tools_.empty()) {
         throw std::runtime_error("toolpack parse produced 0 tools");
     }
@@ -62,7 +86,38 @@ void Registry::registerToolDesc(const ToolDesc& d, bool allow_override) {
     if (it != tools_.end() && !allow_override) {
         throw std::runtime_error("duplicate aid in registry: " + key);
     }
+    // Overrides may change the tag set; drop the old postings first.
+    if (it != tools_.end()) {
+        for (const auto& t : it->second.tags) {
+            auto ti = tag_index_.find(t);
+            if (ti == tag_index_.end()) continue;
+            auto& post = ti->second;
+            auto pos = std::lower_bound(post.begin(), post.end(), key);
+            if (pos != post.end() && *pos == key) post.erase(pos);
+        }
+    }
+    for (const auto& t : d.tags) {
+        auto& post = tag_index_[t];
+        auto pos = std::lower_bound(post.begin(), post.end(), key);
+        if (pos == post.end() || *pos != key) post.insert(pos, key);
+    }
     tools_[key] = d;
+    generation_++;
+}
+
+void Registry::removeToolDesc(const AID& aid) {
+    auto it = tools_.find(aid);
+    if (it == tools_.end()) return;
+    for (const auto& t : it->second.tags) {
+        auto ti = tag_index_.find(t);
+        if (ti == tag_index_.end()) continue;
+        auto& post = ti->second;
+        auto pos = std::lower_bound(post.begin(), post.end(), aid);
+        if (pos != post.end() && *pos == aid) post.erase(pos);
+        if (post.empty()) tag_index_.erase(ti);
+    }
+    tools_.erase(it);
+    generation_++;
 }
 
 const ToolDesc* Registry::getTool(const AID& aid) const {
@@ -72,24 +127,36 @@ const ToolDesc* Registry::getTool(const AID& aid) const {
 }
 
 std::vector<ToolDesc> Registry::queryByTags(const std::vector<std::string>& tags) const {
-    std::vector<ToolDesc> res;
     // RC2+ change: treat candidate tags as a UNION (OR), not an INTERSECTION (AND).
     // Rationale: in Profile A we want a compact, resilient menu. AND semantics makes
     // menus accidentally empty as tags accumulate across steps.
-    for (const auto& kv : tools_) {
-        const auto& d = kv.second;
-        if (tags.empty()) {
-            res.push_back(d);
-            continue;
-        }
-        bool any = false;
-        for (const auto& t : tags) {
-            if (std::find(d.tags.begin(), d.tags.end(), t) != d.tags.end()) { any = true; break; }
+    if (tags.empty()) return allToolDescs();
+
+    // Union the per-tag postings from the inverted index; each list is
+    // already sorted by AID, so merging keeps the deterministic order
+    // without rescanning descriptors.
+    std::vector<std::string> aids;
+    for (const auto& t : tags) {
+        auto ti = tag_index_.find(t);
+        if (ti == tag_index_.end()) continue;
+        if (aids.empty()) {
+            aids = ti->second;
+        } else {
+            std::vector<std::string> merged;
+            merged.reserve(aids.size() + ti->second.size());
+            std::set_union(aids.begin(), aids.end(),
+                           ti->second.begin(), ti->second.end(),
+                           std::back_inserter(merged));
+            aids.swap(merged);
         }
-        if (any) res.push_back(d);
     }
-    // deterministic order by AID
-    std::sort(res.begin(), res.end(), [](const ToolDesc& a, const ToolDesc& b){ return a.aid < b.aid; });
+
+    std::vector<ToolDesc> res;
+    res.reserve(aids.size());
+    for (const auto& aid : aids) {
+        auto it = tools_.find(aid);
+        if (it != tools_.end()) res.push_back(it->second);
+    }
     return res;
 }
 
@@ -0,0 +1,72 @@
+#include "machina/runlog_index.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace machina {
+namespace runlog_index {
+
+static const char* kMagic = "mrlidx1";
+
+std::string index_path(const std::string& log_path) {
+    return log_path + ".idx";
+}
+
+bool load(const std::string& log_path, std::vector<Entry>* out) {
+    std::ifstream f(index_path(log_path));
+    if (!f) return false;
+
+    std::string magic;
+    if (!std::getline(f, magic) || magic != kMagic) return false;
+
+    std::error_code ec;
+    auto log_size = std::filesystem::file_size(log_path, ec);
+    if (ec) return false;
+
+    std::vector<Entry> entries;
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.empty()) continue;
+        std::istringstream ss(line);
+        Entry e;
+        if (!(ss >> e.event >> e.step >> e.offset >> e.len)) return false;
+        if (e.offset < 0 || e.len <= 0) return false;
+        // Stale index (crash after the index write but before the log
+        // flush, or a truncated log): refuse the whole thing rather than
+        // serve lines that are not there.
+        if ((unsigned long long)(e.offset + e.len) > (unsigned long long)log_size) return false;
+        entries.push_back(std::move(e));
+    }
+    *out = std::move(entries);
+    return true;
+}
+
+bool read_event_lines(const std::string& log_path,
+                      const std::vector<std::string>& events,
+                      std::vector<std::string>* lines) {
+    std::vector<Entry> entries;
+    if (!load(log_path, &entries)) return false;
+
+    std::ifstream f(log_path, std::ios::binary);
+    if (!f) return false;
+
+    lines->clear();
+    std::string buf;
+    for (const auto& e : entries) {
+        if (std::find(events.begin(), events.end(), e.event) == events.end()) continue;
+        buf.resize((size_t)e.len);
+        f.seekg(e.offset);
+        if (!f.read(buf.data(), e.len)) return false;
+        // Framing check: every indexed line is a newline-terminated JSON
+        // object; anything else means the offsets drifted.
+        if (buf.empty() || buf.front() != '{' || buf.back() != '\n') return false;
+        buf.pop_back();
+        lines->push_back(buf);
+    }
+    return true;
+}
+
+} // namespace runlog_index
+} // namespace machina
@@ -4,6 +4,7 @@
 
 #include <cstring>
 #include <cerrno>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <vector>
@@ -29,9 +30,21 @@
 
 namespace machina {
 
-std::string install_seccomp_filter() {
+namespace {
+
+// Compiled program, built once per process (the allowlist and the
+// MACHINA_SECCOMP_* profile env vars are fixed for the process lifetime).
+// Children installing the filter between fork and exec only read this.
+struct SeccompProg {
+    std::vector<struct sock_filter> insns;
+    std::string err; // non-empty when compilation failed
+};
+
+SeccompProg build_seccomp_prog() {
+    SeccompProg out;
 #if MACHINA_AUDIT_ARCH == 0
-    return "seccomp: unsupported architecture";
+    out.err = "seccomp: unsupported architecture";
+    return out;
 #else
     // Syscall allowlist — architecture-specific numbers.
     // We use the raw syscall numbers for the target arch.
@@ -268,48 +281,21 @@ std::string install_seccomp_filter() {
 
     const size_t n_allowed = allowlist.size();
 
-    // BPF program structure:
-    // [0]   Load arch from seccomp_data
-    // [1]   Check arch == MACHINA_AUDIT_ARCH; if not → KILL
-    // [2]   Load syscall number
-    // [3..] For each allowed syscall: JEQ → ALLOW
-    // [N]   Default: KILL_PROCESS
-
-    const size_t n_insns = 3 + n_allowed + 1; // header(3) + checks + default
-    auto* filter = new struct sock_filter[n_insns];
-
-    size_t i = 0;
-
-    // [0] Load architecture
-    filter[i++] = BPF_STMT_SC(BPF_LD | BPF_W | BPF_ABS,
-                               offsetof(struct seccomp_data, arch));
-
-    // [1] Verify architecture
-    filter[i++] = BPF_JUMP_SC(BPF_JMP | BPF_JEQ | BPF_K,
-                               MACHINA_AUDIT_ARCH, 1, 0);
-
-    // Architecture mismatch → kill
-    filter[i++] = BPF_STMT_SC(BPF_RET | BPF_K, SECCOMP_RET_KILL_PROCESS);
-
-    // [3] Load syscall number (only reached if arch matched)
-    // Wait — we need to re-layout. After arch check passes, we jump over the kill.
-    // Let me restructure:
-
-    // Actually the layout should be:
+    // BPF program layout:
     // [0] Load arch
     // [1] JEQ arch → skip kill (jt=1, jf=0)
     // [2] KILL (arch mismatch)
     // [3] Load syscall nr
     // [4..N+3] JEQ allowed[i] → ALLOW (jump to last+1)
     // [N+4] KILL (default deny)
-    // [N+5] ALLOW
+    // then the mprotect PROT_EXEC check block and the shared ALLOW.
 
-    delete[] filter;
-    // 4 header + N checks + 1 kill(default) + 4 mprotect_check + 1 allow(general) = N+10
+    // 4 header + N checks + 1 kill(default) + 4 mprotect_check + 1 allow(general)
     const size_t total_insns = 4 + n_allowed + 6;
-    filter = new struct sock_filter[total_insns];
+    out.insns.resize(total_insns);
+    struct sock_filter* filter = out.insns.data();
 
-    i = 0;
+    size_t i = 0;
 
     // [0] Load arch
     filter[i++] = BPF_STMT_SC(BPF_LD | BPF_W | BPF_ABS,
@@ -383,19 +369,33 @@ std::string install_seccomp_filter() {
     // ALLOW (for all other matched syscalls)
     filter[i++] = BPF_STMT_SC(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
 
-    struct sock_fprog prog = {};
-    prog.len = (unsigned short)total_insns;
-    prog.filter = filter;
+    return out;
+#endif
+}
+
+const SeccompProg& compiled_seccomp_prog() {
+    static SeccompProg prog = build_seccomp_prog();
+    return prog;
+}
+
+} // namespace
+
+std::string seccomp_filter_precompile() {
+    return compiled_seccomp_prog().err;
+}
 
-    int ret = prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &prog, 0, 0);
-    delete[] filter;
+std::string install_seccomp_filter() {
+    const SeccompProg& p = compiled_seccomp_prog();
+    if (!p.err.empty()) return p.err;
+
+    struct sock_fprog prog = {};
+    prog.len = (unsigned short)p.insns.size();
+    prog.filter = const_cast<struct sock_filter*>(p.insns.data());
 
-    if (ret != 0) {
+    if (prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &prog, 0, 0) != 0) {
         return std::string("seccomp install failed: ") + std::strerror(errno);
     }
-
     return "";
-#endif
 }
 
 bool seccomp_available() {
@@ -418,6 +418,10 @@ std::string install_seccomp_filter() {
     return "";
 }
 
+std::string seccomp_filter_precompile() {
+    return "";
+}
+
 bool seccomp_available() {
     return false;
 }
@@ -273,4 +273,17 @@ Selection HeuristicSelector::select(const Menu& menu,
     return parse_selector_output("<NOOP><END>");
 }
 
+std::vector<Selection> ISelector::select_batch(const Menu& menu,
+                                               const std::vector<std::string>& goal_digests,
+                                               const std::string& state_digest,
+                                               ControlMode mode,
+                                               const std::string& inputs_json) {
+    std::vector<Selection> out;
+    out.reserve(goal_digests.size());
+    for (const auto& g : goal_digests) {
+        out.push_back(select(menu, g, state_digest, mode, inputs_json));
+    }
+    return out;
+}
+
 } // namespace machina
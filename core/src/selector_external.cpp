@@ -1,4 +1,6 @@
 #include "machina/selector.h"
+#include "machina/breaker.h"
+#include "machina/path_guard.h"
 #include "machina/proc.h"
 #include "machina/crypto.h"
 
@@ -8,6 +10,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <chrono>
 #include <fstream>
@@ -18,6 +21,9 @@
 #if defined(__linux__)
   #include <sys/random.h>
 #endif
+#ifndef _WIN32
+  #include <unistd.h>
+#endif
 
 namespace machina {
 
@@ -63,16 +69,8 @@ static std::vector<std::string> split_csv(const std::string& s) {
 }
 
 static bool is_path_under(const std::filesystem::path& p, const std::filesystem::path& root) {
-    std::error_code ec;
-    auto rp = std::filesystem::weakly_canonical(p, ec);
-    if (ec) return false;
-    auto rr = std::filesystem::weakly_canonical(root, ec);
-    if (ec) return false;
-    auto ps = rp.generic_string();
-    auto rs = rr.generic_string();
-    if (ps == rs) return true;
-    if (!rs.empty() && rs.back() != '/') rs.push_back('/');
-    return ps.rfind(rs, 0) == 0;
+    // Cached canonicalization; see machina/path_guard.h.
+    return machina::path_is_under(p, root);
 }
 
 static int64_t now_ms() {
@@ -101,12 +99,13 @@ ExternalProcessSelector::ExternalProcessSelector(std::unique_ptr<ISelector> fall
 
     argv_ = split_argv_quoted(policy_cmd_);
 
-    // defaults
-    allowed_exec_basenames_ = {"python3", "python", "bash", "sh", "node"};
+    // defaults; compiled into a hash set once so the per-call check is a
+    // single lookup.
+    std::vector<std::string> allowed_exes = {"python3", "python", "bash", "sh", "node"};
     if (const char* al = std::getenv("MACHINA_POLICY_ALLOWED_EXE")) {
-        allowed_exec_basenames_.clear();
-        for (auto& t : split_csv(al)) allowed_exec_basenames_.push_back(lower_ascii(t));
+        allowed_exes = split_csv(al);
     }
+    allowed_exec_basenames_ = BasenameAllowlist(allowed_exes);
 
     allowed_script_root_ = repo_root_ / "policies";
     if (const char* sr = std::getenv("MACHINA_POLICY_ALLOWED_SCRIPT_ROOT")) {
@@ -130,6 +129,17 @@ ExternalProcessSelector::ExternalProcessSelector(std::unique_ptr<ISelector> fall
     if (policy_fail_threshold_ < 1) policy_fail_threshold_ = 1;
     policy_cooldown_ms_ = (int64_t)getenv_int("MACHINA_POLICY_COOLDOWN_MS", 30000);
     if (policy_cooldown_ms_ < 0) policy_cooldown_ms_ = 0;
+
+    if (const char* mi = std::getenv("MACHINA_POLICY_MENU_INLINE")) {
+        menu_inline_ = (std::string(mi) == "1");
+    }
+}
+
+ExternalProcessSelector::~ExternalProcessSelector() {
+    if (!menu_cache_path_.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(menu_cache_path_, ec);
+    }
 }
 
 Selection ExternalProcessSelector::select(const Menu& menu,
@@ -143,14 +153,18 @@ Selection ExternalProcessSelector::select(const Menu& menu,
 
     // Circuit breaker: if policy is flapping (timeouts/crashes), temporarily disable it.
     // Design intent:
-    //   Trip threshold: MACHINA_POLICY_FAIL_THRESHOLD consecutive failures (default 5).
+    //   Trip threshold: MACHINA_POLICY_FAIL_THRESHOLD failures within the cooldown
+    //                   window (default 5).
     //   Cooldown:       MACHINA_POLICY_COOLDOWN_MS milliseconds (default 30 000 ms / 30 s).
     //   Behavior:       When tripped the selector auto-switches to FALLBACK_ONLY
     //                   for the cooldown period, then auto-recovers (next call retries
     //                   the external policy). This prevents a broken/slow policy from
     //                   stalling the entire run loop while still allowing self-healing.
-    const int64_t now = now_ms();
-    if (policy_disabled_until_ms_ > now) {
+    // State lives in the shared breaker table (machina/breaker.h) keyed by the
+    // policy command, so every selector instance — and every process sharing
+    // MACHINA_ROOT — sees a trip the moment one worker discovers it.
+    const std::string breaker_key = "policy:" + policy_cmd_;
+    if (breaker_is_blocked(breaker_key, now_ms())) {
         return fallback_->select(menu, goal_digest, state_digest, ControlMode::FALLBACK_ONLY, inputs_json);
     }
 
@@ -162,11 +176,7 @@ Selection ExternalProcessSelector::select(const Menu& menu,
     if (!allow_unsafe_) {
         std::filesystem::path exe(argv_[0]);
         std::string exe_base = lower_ascii(exe.filename().string());
-        bool ok = false;
-        for (const auto& a : allowed_exec_basenames_) {
-            if (exe_base == lower_ascii(a)) { ok = true; break; }
-        }
-        if (!ok) {
+        if (!allowed_exec_basenames_.contains(exe_base)) {
             Selection invalid; invalid.kind = Selection::Kind::INVALID; invalid.raw = "policy exe not allowed: " + exe_base;
             return invalid;
         }
@@ -187,7 +197,62 @@ Selection ExternalProcessSelector::select(const Menu& menu,
         }
     }
 
-    // Build payload JSON
+    // Build payload JSON. The menu is by far the largest part and repeats
+    // verbatim step after step, so it lives in a content-addressed side file
+    // (one write per menu digest, reused until the menu changes); the
+    // per-step payload carries only the small varying fields plus the
+    // menu_file pointer. MACHINA_POLICY_MENU_INLINE=1 keeps the full inline
+    // "menu" for drivers that predate the split.
+    auto build_menu_array = [&]() -> json_object* {
+        json_object* arr = json_object_new_array();
+        for (const auto& it : menu.items) {
+            json_object* o = json_object_new_object();
+            std::string sid = it.sid.toString();
+            json_object_object_add(o, "sid", json_object_new_string(sid.c_str()));
+            json_object_object_add(o, "aid", json_object_new_string(it.aid.c_str()));
+            json_object_object_add(o, "name", json_object_new_string(it.name.c_str()));
+            json_object* tags = json_object_new_array();
+            for (const auto& t : it.tags) json_object_array_add(tags, json_object_new_string(t.c_str()));
+            json_object_object_add(o, "tags", tags);
+            json_object_array_add(arr, o);
+        }
+        return arr;
+    };
+
+    bool menu_by_file = false;
+    if (!menu_inline_) {
+        std::string mdg = menu.digest();
+        if (mdg == menu_cache_digest_ && !menu_cache_path_.empty()) {
+            menu_by_file = true;
+        } else {
+            try {
+                std::ostringstream fname;
+                fname << "machina_policy_menu_" << (unsigned long long)::getpid()
+                      << "_" << mdg.substr(0, 16) << ".json";
+                auto mp = std::filesystem::temp_directory_path() / fname.str();
+                json_object* arr = build_menu_array();
+                const char* mc = json_object_to_json_string_ext(arr, JSON_C_TO_STRING_PLAIN);
+                std::ofstream mf(mp, std::ios::binary | std::ios::trunc);
+                if (mf && mc) {
+                    mf.write(mc, (std::streamsize)strlen(mc));
+                    mf.flush();
+                    menu_by_file = mf.good();
+                }
+                json_object_put(arr);
+                if (menu_by_file) {
+                    if (!menu_cache_path_.empty() && menu_cache_path_ != mp) {
+                        std::error_code rec;
+                        std::filesystem::remove(menu_cache_path_, rec);
+                    }
+                    menu_cache_digest_ = mdg;
+                    menu_cache_path_ = mp;
+                }
+            } catch (...) {
+                menu_by_file = false; // fall back to the inline menu below
+            }
+        }
+    }
+
     json_object* root = json_object_new_object();
     json_object_object_add(root, "goal_digest", json_object_new_string_len(goal_digest.c_str(), (int)goal_digest.size()));
     json_object_object_add(root, "state_digest", json_object_new_string_len(state_digest.c_str(), (int)state_digest.size()));
@@ -203,19 +268,12 @@ Selection ExternalProcessSelector::select(const Menu& menu,
         }
     }
 
-    json_object* arr = json_object_new_array();
-    for (const auto& it : menu.items) {
-        json_object* o = json_object_new_object();
-        std::string sid = it.sid.toString();
-        json_object_object_add(o, "sid", json_object_new_string(sid.c_str()));
-        json_object_object_add(o, "aid", json_object_new_string(it.aid.c_str()));
-        json_object_object_add(o, "name", json_object_new_string(it.name.c_str()));
-        json_object* tags = json_object_new_array();
-        for (const auto& t : it.tags) json_object_array_add(tags, json_object_new_string(t.c_str()));
-        json_object_object_add(o, "tags", tags);
-        json_object_array_add(arr, o);
+    if (menu_by_file) {
+        json_object_object_add(root, "menu_digest", json_object_new_string(menu_cache_digest_.c_str()));
+        json_object_object_add(root, "menu_file", json_object_new_string(menu_cache_path_.string().c_str()));
+    } else {
+        json_object_object_add(root, "menu", build_menu_array());
     }
-    json_object_object_add(root, "menu", arr);
 
     const char* payload_c = json_object_to_json_string_ext(root, JSON_C_TO_STRING_PLAIN);
     std::string payload = payload_c ? payload_c : "{}";
@@ -255,10 +313,8 @@ Selection ExternalProcessSelector::select(const Menu& menu,
     std::filesystem::remove(payload_path, ec);
 
     auto mark_failure = [&](const std::string& why) -> Selection {
-        consecutive_policy_fail_ += 1;
-        if (consecutive_policy_fail_ >= policy_fail_threshold_) {
-            policy_disabled_until_ms_ = now_ms() + policy_cooldown_ms_;
-        }
+        breaker_record_fail(breaker_key, now_ms(), policy_fail_threshold_,
+                            policy_cooldown_ms_, policy_cooldown_ms_);
         // If policy is used in POLICY_ONLY mode, we still return fallback selection rather than INVALID,
         // because INVALID would hard-fail the whole run. We preserve the policy error in raw.
         Selection fb = fallback_->select(menu, goal_digest, state_digest, ControlMode::FALLBACK_ONLY, inputs_json);
@@ -294,8 +350,7 @@ Selection ExternalProcessSelector::select(const Menu& menu,
     }
 
     // policy OK: clear breaker
-    consecutive_policy_fail_ = 0;
-    policy_disabled_until_ms_ = 0;
+    breaker_record_success(breaker_key);
     return parsed;
 #endif
 }
@@ -2,10 +2,17 @@
 #include "machina/embedding.h"
 #include "machina/embedding_provider.h"
 #include "machina/hash.h"
+#include "machina/hugepage.h"
+#include "machina/vec_simd.h"
 
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <list>
 #include <iomanip>
 #include <memory>
 #include <mutex>
@@ -17,6 +24,13 @@
 #ifdef MACHINA_USE_CUDA
 // GPU kernels are optional; build only when CUDA is enabled in CMake.
 extern "C" void machina_cuda_batched_dot(const float* goal, const float* centroids, int n, int dim, float* out_scores);
+extern "C" int machina_cuda_centroid_select(const char* key, const float* goal,
+                                            const float* centroids_host, int n, int dim,
+                                            float* out_scores);
+extern "C" int machina_cuda_centroid_select_multi(const char* key, const float* goals, int g,
+                                                  const float* centroids_host, int n, int dim,
+                                                  float* out_scores);
+extern "C" void machina_cuda_centroid_invalidate(const char* key);
 #endif
 
 namespace machina {
@@ -53,12 +67,6 @@ static bool env_falsy(const char* v) {
 }
 #endif
 
-static float dot_ptr(const std::vector<float>& a, const float* b, size_t dim) {
-    double s = 0.0;
-    for (size_t i = 0; i < dim; i++) s += (double)a[i] * (double)b[i];
-    return (float)s;
-}
-
 // Embed a text string using embed_text_best_effort (real model when available,
 // hash fallback otherwise).  The result is L2-normalized.
 static std::vector<float> smart_embed(const std::string& text, size_t dim) {
@@ -74,18 +82,70 @@ static std::vector<float> smart_embed(const std::string& text, size_t dim) {
 
 // Cache centroid matrices by (menu_digest, dim) to avoid recomputing per step.
 // When using real embeddings the cache prevents repeated subprocess calls.
+// Centroid matrices are large, long-lived, and scanned row by row every
+// selection, so the vector is backed by the huge-page allocator once it
+// crosses one huge page (small menus stay on the heap).
+using CentroidVec = std::vector<float, HugePageAllocator<float>>;
+
 struct CentroidCacheEntry {
     size_t dim{0};
     size_t n{0};
-    std::shared_ptr<std::vector<float>> centroids; // row-major: n x dim
+    std::shared_ptr<CentroidVec> centroids; // row-major: n x dim
+};
+
+// Small string-keyed LRU with hit/miss/eviction counters. Earlier versions
+// evicted an arbitrary unordered_map bucket (centroids) or cleared the whole
+// map (goals); both caused periodic re-embedding storms against the
+// subprocess provider. Evicted keys are reported so callers can release
+// device-resident copies.
+template <typename V>
+struct LruCache {
+    explicit LruCache(size_t cap) : cap_(cap) {}
+
+    V* get(const std::string& k) {
+        auto it = map_.find(k);
+        if (it == map_.end()) { misses++; return nullptr; }
+        hits++;
+        lru_.splice(lru_.begin(), lru_, it->second.first);
+        return &it->second.second;
+    }
+
+    void put(const std::string& k, V v, std::vector<std::string>* evicted) {
+        auto it = map_.find(k);
+        if (it != map_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.first);
+            it->second.second = std::move(v);
+            return;
+        }
+        lru_.push_front(k);
+        map_.emplace(k, std::make_pair(lru_.begin(), std::move(v)));
+        while (map_.size() > cap_) {
+            if (evicted) evicted->push_back(lru_.back());
+            map_.erase(lru_.back());
+            lru_.pop_back();
+            evictions++;
+        }
+    }
+
+    size_t size() const { return map_.size(); }
+
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t evictions{0};
+
+private:
+    size_t cap_;
+    std::list<std::string> lru_;  // front = most recently used
+    std::unordered_map<std::string,
+                       std::pair<std::list<std::string>::iterator, V>> map_;
 };
 
 static std::mutex g_centroid_mu;
-static std::unordered_map<std::string, CentroidCacheEntry> g_centroid_cache;
+static LruCache<CentroidCacheEntry> g_centroid_cache(128);
 
 // Goal embedding cache: avoids re-embedding the same goal_digest string.
 static std::mutex g_goal_mu;
-static std::unordered_map<std::string, std::vector<float>> g_goal_cache;
+static LruCache<std::vector<float>> g_goal_cache(256);
 
 static std::string cache_key(const Menu& menu, size_t dim) {
     return menu.digest() + "|dim=" + std::to_string(dim);
@@ -95,7 +155,7 @@ static CentroidCacheEntry build_centroids(const Menu& menu, size_t dim) {
     CentroidCacheEntry e;
     e.dim = dim;
     e.n = menu.items.size();
-    e.centroids = std::make_shared<std::vector<float>>();
+    e.centroids = std::make_shared<CentroidVec>();
     e.centroids->resize(e.n * dim);
 
     // Collect all seed strings, then embed in a single batch subprocess call.
@@ -123,6 +183,118 @@ static CentroidCacheEntry build_centroids(const Menu& menu, size_t dim) {
     return e;
 }
 
+// ---------------------------------------------------------------------------
+// Disk-persisted centroid matrices (MACHINA_SELECTOR_CACHE_PERSIST=0 to
+// disable). The cache key is already a content digest of the menu plus dim,
+// so a blob built before a restart is still valid afterwards; without this
+// the first selections after every deploy re-embed whole menus through the
+// subprocess provider. Format: "MCEN" v1, the full key (to rule out filename
+// hash collisions), then the raw n x dim f32 matrix.
+
+static bool selector_cache_persist_enabled() {
+    const char* e = std::getenv("MACHINA_SELECTOR_CACHE_PERSIST");
+    return !(e && (std::string(e) == "0" || std::string(e) == "false"));
+}
+
+static std::filesystem::path selector_cache_path(const std::string& ck) {
+    const char* mr = std::getenv("MACHINA_ROOT");
+    std::filesystem::path root = mr ? std::filesystem::path(mr) : std::filesystem::current_path();
+    return root / "work" / "selector_cache" / (hash::hex64(hash::fnv1a64(ck)) + ".cent");
+}
+
+static bool load_centroids_disk(const std::string& ck, size_t dim, size_t n,
+                                CentroidCacheEntry* out) {
+    std::ifstream in(selector_cache_path(ck), std::ios::binary);
+    if (!in.good()) return false;
+
+    char magic[4];
+    in.read(magic, 4);
+    if (in.gcount() != 4 || std::memcmp(magic, "MCEN", 4) != 0) return false;
+    uint32_t version = 0, key_len = 0, dim32 = 0, n32 = 0;
+    auto read_u32 = [&](uint32_t* v) {
+        in.read(reinterpret_cast<char*>(v), sizeof(*v));
+        return in.gcount() == (std::streamsize)sizeof(*v);
+    };
+    if (!read_u32(&version) || version != 1) return false;
+    if (!read_u32(&key_len) || key_len == 0 || key_len > 4096) return false;
+    std::string key(key_len, '\0');
+    in.read(key.data(), (std::streamsize)key_len);
+    if (in.gcount() != (std::streamsize)key_len || key != ck) return false;
+    if (!read_u32(&dim32) || (size_t)dim32 != dim) return false;
+    if (!read_u32(&n32) || (size_t)n32 != n) return false;
+
+    out->dim = dim;
+    out->n = n;
+    out->centroids = std::make_shared<CentroidVec>(n * dim);
+    in.read(reinterpret_cast<char*>(out->centroids->data()),
+            (std::streamsize)(n * dim * sizeof(float)));
+    return in.gcount() == (std::streamsize)(n * dim * sizeof(float));
+}
+
+static void save_centroids_disk(const std::string& ck, const CentroidCacheEntry& e) {
+    if (!e.centroids || e.centroids->empty()) return;
+    std::error_code ec;
+    auto final_path = selector_cache_path(ck);
+    std::filesystem::create_directories(final_path.parent_path(), ec);
+    auto tmp = std::filesystem::path(final_path.string() + ".tmp");
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.good()) return;
+        out.write("MCEN", 4);
+        uint32_t version = 1;
+        uint32_t key_len = (uint32_t)ck.size();
+        uint32_t dim32 = (uint32_t)e.dim;
+        uint32_t n32 = (uint32_t)e.n;
+        out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char*>(&key_len), sizeof(key_len));
+        out.write(ck.data(), (std::streamsize)ck.size());
+        out.write(reinterpret_cast<const char*>(&dim32), sizeof(dim32));
+        out.write(reinterpret_cast<const char*>(&n32), sizeof(n32));
+        out.write(reinterpret_cast<const char*>(e.centroids->data()),
+                  (std::streamsize)(e.centroids->size() * sizeof(float)));
+        if (!out.good()) return;
+    }
+    std::filesystem::rename(tmp, final_path, ec);
+}
+
+// Fetches (or builds) the centroid entry for a cache key. LRU eviction keeps
+// long-running daemons bounded without a thundering-herd rebuild; misses try
+// the on-disk blob before re-embedding the menu.
+static CentroidCacheEntry get_centroids(const Menu& menu, size_t dim, const std::string& ck) {
+    std::lock_guard<std::mutex> lk(g_centroid_mu);
+    if (auto* e = g_centroid_cache.get(ck)) return *e; // shared_ptr copy (cheap)
+    CentroidCacheEntry built;
+    bool persist = selector_cache_persist_enabled();
+    if (!persist || !load_centroids_disk(ck, dim, menu.items.size(), &built)) {
+        built = build_centroids(menu, dim);
+        if (persist) save_centroids_disk(ck, built);
+    }
+    std::vector<std::string> evicted;
+    g_centroid_cache.put(ck, built, &evicted);
+#ifdef MACHINA_USE_CUDA
+    // Keep device-resident copies in step with the host cache.
+    for (const auto& k : evicted) machina_cuda_centroid_invalidate(k.c_str());
+#else
+    (void)evicted;
+#endif
+    return built;
+}
+
+// Highest score wins; ties break toward the lower SID.
+static Selection pick_best(const Menu& menu, const float* scores, size_t n) {
+    float best_score = -1e30f;
+    uint16_t best_sid = menu.items[0].sid.value;
+    for (size_t i = 0; i < n; i++) {
+        float sc = scores[i];
+        uint16_t sid = menu.items[i].sid.value;
+        if (sc > best_score || (sc == best_score && sid < best_sid)) {
+            best_score = sc;
+            best_sid = sid;
+        }
+    }
+    return parse_selector_output(sid_to_pick(best_sid));
+}
+
 #ifdef MACHINA_USE_CUDA
 static bool want_gpu_for_this_run() {
     // default: auto (use GPU if available when compiled with CUDA)
@@ -150,38 +322,23 @@ Selection GpuCentroidSelector::select(const Menu& menu,
 
     const size_t dim = parse_dim_env();
 
-    // Goal embedding (cached per goal_digest string).
+    // Goal embedding (cached per goal_digest string). Embedding happens
+    // outside the lock so a slow provider never stalls other selections.
     std::vector<float> goal_vec;
+    std::string gk = goal_digest + "|dim=" + std::to_string(dim);
     {
-        std::string gk = goal_digest + "|dim=" + std::to_string(dim);
         std::lock_guard<std::mutex> lk(g_goal_mu);
-        if (g_goal_cache.size() > 256) g_goal_cache.clear();
-        auto git = g_goal_cache.find(gk);
-        if (git != g_goal_cache.end()) {
-            goal_vec = git->second;
-        } else {
-            goal_vec = smart_embed(goal_digest, dim);
-            g_goal_cache.emplace(gk, goal_vec);
-        }
+        if (auto* v = g_goal_cache.get(gk)) goal_vec = *v;
+    }
+    if (goal_vec.empty()) {
+        goal_vec = smart_embed(goal_digest, dim);
+        std::lock_guard<std::mutex> lk(g_goal_mu);
+        g_goal_cache.put(gk, goal_vec, nullptr);
     }
 
     // Obtain (or build) cached centroids
     const std::string ck = cache_key(menu, dim);
-    CentroidCacheEntry entry;
-    {
-        std::lock_guard<std::mutex> lk(g_centroid_mu);
-        // Cap cache size to prevent unbounded growth in long-running daemons.
-        // Evict oldest-ish entry instead of clearing all (avoids thundering herd rebuild).
-        if (g_centroid_cache.size() > 128) {
-            g_centroid_cache.erase(g_centroid_cache.begin());
-        }
-        auto it = g_centroid_cache.find(ck);
-        if (it == g_centroid_cache.end()) {
-            g_centroid_cache.emplace(ck, build_centroids(menu, dim));
-            it = g_centroid_cache.find(ck);
-        }
-        entry = it->second; // shared_ptr copy (cheap)
-    }
+    CentroidCacheEntry entry = get_centroids(menu, dim, ck);
     if (!entry.centroids || entry.centroids->empty()) {
         last_backend_ = "CPU";
         return parse_selector_output("<NOOP><END>");
@@ -189,33 +346,30 @@ Selection GpuCentroidSelector::select(const Menu& menu,
 
 #ifdef MACHINA_USE_CUDA
     if (want_gpu_for_this_run()) {
-        GpuContext ctx = GpuContext::create();
+        // Shared context: device probe and selection happen once per process.
+        GpuContext& ctx = GpuContext::shared();
         if (ctx.available()) {
+            // Centroids stay resident on the device under the same cache key
+            // as g_centroid_cache; steady state uploads only the goal vector.
             std::vector<float> scores(entry.n, 0.0f);
-            machina_cuda_batched_dot(goal_vec.data(), entry.centroids->data(), (int)entry.n, (int)dim, scores.data());
-
-            float best_score = -1e30f;
-            uint16_t best_sid = menu.items[0].sid.value;
-            for (size_t i = 0; i < entry.n; i++) {
-                float sc = scores[i];
-                uint16_t sid = menu.items[i].sid.value;
-                if (sc > best_score || (sc == best_score && sid < best_sid)) {
-                    best_score = sc;
-                    best_sid = sid;
-                }
+            if (machina_cuda_centroid_select(ck.c_str(), goal_vec.data(),
+                                             entry.centroids->data(), (int)entry.n,
+                                             (int)dim, scores.data()) == 0) {
+                last_backend_ = "CUDA";
+                return pick_best(menu, scores.data(), entry.n);
             }
-            last_backend_ = "CUDA";
-            return parse_selector_output(sid_to_pick(best_sid));
+            // Resident path unavailable — fall through to the CPU scorer.
         }
     }
 #endif
 
-    // CPU path (always available) — uses cached centroids.
+    // CPU path (always available) — cached centroids scored with the
+    // runtime-dispatched SIMD dot kernel shared with the vecdb scan.
     float best_score = -1e30f;
     uint16_t best_sid = menu.items[0].sid.value;
     for (size_t i = 0; i < entry.n; i++) {
         const float* c = &(*entry.centroids)[i * dim];
-        float sc = dot_ptr(goal_vec, c, dim);
+        float sc = vec::dot_f32(goal_vec.data(), c, dim);
         uint16_t sid = menu.items[i].sid.value;
         if (sc > best_score || (sc == best_score && sid < best_sid)) {
             best_score = sc;
@@ -226,4 +380,115 @@ Selection GpuCentroidSelector::select(const Menu& menu,
     return parse_selector_output(sid_to_pick(best_sid));
 }
 
+SelectorCacheStats selector_cache_stats() {
+    SelectorCacheStats s;
+    {
+        std::lock_guard<std::mutex> lk(g_centroid_mu);
+        s.centroid_hits = g_centroid_cache.hits;
+        s.centroid_misses = g_centroid_cache.misses;
+        s.centroid_evictions = g_centroid_cache.evictions;
+        s.centroid_entries = g_centroid_cache.size();
+    }
+    {
+        std::lock_guard<std::mutex> lk(g_goal_mu);
+        s.goal_hits = g_goal_cache.hits;
+        s.goal_misses = g_goal_cache.misses;
+        s.goal_evictions = g_goal_cache.evictions;
+        s.goal_entries = g_goal_cache.size();
+    }
+    return s;
+}
+
+std::vector<Selection> GpuCentroidSelector::select_batch(const Menu& menu,
+                                                         const std::vector<std::string>& goal_digests,
+                                                         const std::string& /*state_digest*/,
+                                                         ControlMode /*mode*/,
+                                                         const std::string& /*inputs_json*/) {
+    std::vector<Selection> out(goal_digests.size());
+    if (goal_digests.empty()) return out;
+    if (menu.items.empty()) {
+        last_backend_ = "CPU";
+        for (auto& s : out) s = parse_selector_output("<NOOP><END>");
+        return out;
+    }
+
+    const size_t dim = parse_dim_env();
+    const size_t g = goal_digests.size();
+
+    // Stack goal vectors into a g x dim matrix: cache hits are copied out,
+    // all misses are embedded in one batch call.
+    std::vector<float> goals(g * dim, 0.0f);
+    std::vector<size_t> miss;
+    std::vector<std::string> miss_texts;
+    {
+        std::lock_guard<std::mutex> lk(g_goal_mu);
+        for (size_t i = 0; i < g; i++) {
+            std::string gk = goal_digests[i] + "|dim=" + std::to_string(dim);
+            auto* v = g_goal_cache.get(gk);
+            if (v && v->size() == dim) {
+                std::copy(v->begin(), v->end(), goals.begin() + i * dim);
+            } else {
+                miss.push_back(i);
+                miss_texts.push_back(goal_digests[i]);
+            }
+        }
+    }
+    if (!miss.empty()) {
+        auto results = embed_texts_batch(miss_texts, dim);
+        std::lock_guard<std::mutex> lk(g_goal_mu);
+        for (size_t m = 0; m < miss.size(); m++) {
+            std::vector<float> vec;
+            if (m < results.size() && results[m].embedding.size() == dim) {
+                vec = std::move(results[m].embedding);
+                l2_normalize(vec);
+            } else {
+                vec = hash_embedding(miss_texts[m], dim);
+            }
+            std::copy(vec.begin(), vec.end(), goals.begin() + miss[m] * dim);
+            g_goal_cache.put(goal_digests[miss[m]] + "|dim=" + std::to_string(dim),
+                             std::move(vec), nullptr);
+        }
+    }
+
+    const std::string ck = cache_key(menu, dim);
+    CentroidCacheEntry entry = get_centroids(menu, dim, ck);
+    if (!entry.centroids || entry.centroids->empty()) {
+        last_backend_ = "CPU";
+        for (auto& s : out) s = parse_selector_output("<NOOP><END>");
+        return out;
+    }
+
+#ifdef MACHINA_USE_CUDA
+    if (want_gpu_for_this_run()) {
+        GpuContext& ctx = GpuContext::shared();
+        if (ctx.available()) {
+            // All goals against the resident centroid matrix in one launch.
+            std::vector<float> scores(g * entry.n, 0.0f);
+            if (machina_cuda_centroid_select_multi(ck.c_str(), goals.data(), (int)g,
+                                                   entry.centroids->data(), (int)entry.n,
+                                                   (int)dim, scores.data()) == 0) {
+                for (size_t j = 0; j < g; j++) {
+                    out[j] = pick_best(menu, &scores[j * entry.n], entry.n);
+                }
+                last_backend_ = "CUDA";
+                return out;
+            }
+        }
+    }
+#endif
+
+    // CPU path: score each goal row against the cached centroids with the
+    // SIMD dot kernel.
+    std::vector<float> scores(entry.n, 0.0f);
+    for (size_t j = 0; j < g; j++) {
+        const float* q = &goals[j * dim];
+        for (size_t i = 0; i < entry.n; i++) {
+            scores[i] = vec::dot_f32(q, &(*entry.centroids)[i * dim], dim);
+        }
+        out[j] = pick_best(menu, scores.data(), entry.n);
+    }
+    last_backend_ = "CPU";
+    return out;
+}
+
 } // namespace machina
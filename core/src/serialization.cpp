@@ -2,6 +2,8 @@
 
 #include <sstream>
 #include <stdexcept>
+#include <unordered_map>
+#include <utility>
 
 namespace machina {
 
@@ -67,6 +69,15 @@ bool artifact_from_json(json_object* o, Artifact* out) {
     return true;
 }
 
+void artifact_write(JsonWriter& w, const Artifact& a) {
+    w.begin_object();
+    w.kv("type", a.type);
+    w.kv("provenance", a.provenance);
+    w.kv("content_json", a.content_json);
+    w.kv("size_bytes", (int64_t)a.size_bytes);
+    w.end_object();
+}
+
 // --- DSState serialization ---
 
 json_object* dsstate_to_json(const DSState& ds) {
@@ -107,6 +118,20 @@ bool dsstate_from_json(json_object* o, DSState* out) {
     return true;
 }
 
+std::string dsstate_to_json_str(const DSState& ds) {
+    JsonWriter w(256);
+    w.begin_object();
+    w.key("slots");
+    w.begin_object();
+    for (const auto& kv : ds.slots) {
+        w.key(std::to_string((int)kv.first));
+        artifact_write(w, kv.second);
+    }
+    w.end_object();
+    w.end_object();
+    return w.take();
+}
+
 // --- DSState delta serialization ---
 
 json_object* dsstate_to_json_delta(const DSState& current, const DSState* base) {
@@ -122,12 +147,14 @@ json_object* dsstate_to_json_delta(const DSState& current, const DSState* base)
         bool changed = (it == base->slots.end());
         if (!changed) {
             // Compare content to detect changes
+            // Cheapest fields first so unchanged large artifacts bail
+            // before the content comparison.
             const Artifact& ba = it->second;
             const Artifact& ca = kv.second;
-            changed = (ca.type != ba.type ||
+            changed = (ca.size_bytes != ba.size_bytes ||
+                       ca.type != ba.type ||
                        ca.provenance != ba.provenance ||
-                       ca.content_json != ba.content_json ||
-                       ca.size_bytes != ba.size_bytes);
+                       ca.content_json != ba.content_json);
         }
         if (changed) {
             std::string key = std::to_string((int)kv.first);
@@ -148,6 +175,44 @@ json_object* dsstate_to_json_delta(const DSState& current, const DSState* base)
     return root;
 }
 
+std::string dsstate_to_json_delta_str(const DSState& current, const DSState* base) {
+    if (!base) return dsstate_to_json_str(current);
+
+    JsonWriter w(256);
+    w.begin_object();
+    w.kv("delta", true);
+    w.key("slots");
+    w.begin_object();
+    for (const auto& kv : current.slots) {
+        auto it = base->slots.find(kv.first);
+        bool changed = (it == base->slots.end());
+        if (!changed) {
+            // Same field order as dsstate_to_json_delta: cheap fields first.
+            const Artifact& ba = it->second;
+            const Artifact& ca = kv.second;
+            changed = (ca.size_bytes != ba.size_bytes ||
+                       ca.type != ba.type ||
+                       ca.provenance != ba.provenance ||
+                       ca.content_json != ba.content_json);
+        }
+        if (changed) {
+            w.key(std::to_string((int)kv.first));
+            artifact_write(w, kv.second);
+        }
+    }
+    w.end_object();
+    w.key("removed_slots");
+    w.begin_array();
+    for (const auto& kv : base->slots) {
+        if (current.slots.find(kv.first) == current.slots.end()) {
+            w.value((int)kv.first);
+        }
+    }
+    w.end_array();
+    w.end_object();
+    return w.take();
+}
+
 bool dsstate_apply_delta(json_object* delta, DSState* state) {
     if (!state || !delta || !json_object_is_type(delta, json_type_object)) return false;
 
@@ -194,54 +259,81 @@ bool dsstate_apply_delta(json_object* delta, DSState* state) {
     return true;
 }
 
-bool dsstate_apply_tx_patch(json_object* patch, DSState* state) {
-    if (!state || !patch || !json_object_is_type(patch, json_type_array)) return false;
-
-    const size_t n = json_object_array_length(patch);
-    for (size_t i = 0; i < n; i++) {
-        json_object* op_obj = json_object_array_get_idx(patch, i);
-        if (!op_obj || !json_object_is_type(op_obj, json_type_object)) return false;
-
-        json_object* op_j = nullptr;
-        json_object* path_j = nullptr;
-        if (!json_object_object_get_ex(op_obj, "op", &op_j) || !json_object_is_type(op_j, json_type_string)) return false;
-        if (!json_object_object_get_ex(op_obj, "path", &path_j) || !json_object_is_type(path_j, json_type_string)) return false;
-
-        std::string op = json_object_get_string(op_j);
-        std::string path = json_object_get_string(path_j);
-        constexpr const char* kPrefix = "/slots/";
-        if (path.rfind(kPrefix, 0) != 0) return false;
-
-        int slot = -1;
-        try {
-            slot = std::stoi(path.substr(7));
-        } catch (...) {
-            return false;
-        }
-        if (slot < 0 || slot > 7) return false;
-        const auto k = static_cast<uint8_t>(slot);
+bool dsstate_apply_tx_patches(const std::vector<json_object*>& patches, DSState* state) {
+    if (!state) return false;
+
+    // Phase 1: validate every op across every patch and stage the net
+    // effect per slot. Later ops on a slot overwrite earlier ones, which
+    // matches applying the patches sequentially.
+    struct StagedOp {
+        bool remove{false};
+        Artifact artifact;
+    };
+    std::unordered_map<uint8_t, StagedOp> staged;
+
+    for (json_object* patch : patches) {
+        if (!patch || !json_object_is_type(patch, json_type_array)) return false;
+
+        const size_t n = json_object_array_length(patch);
+        for (size_t i = 0; i < n; i++) {
+            json_object* op_obj = json_object_array_get_idx(patch, i);
+            if (!op_obj || !json_object_is_type(op_obj, json_type_object)) return false;
+
+            json_object* op_j = nullptr;
+            json_object* path_j = nullptr;
+            if (!json_object_object_get_ex(op_obj, "op", &op_j) || !json_object_is_type(op_j, json_type_string)) return false;
+            if (!json_object_object_get_ex(op_obj, "path", &path_j) || !json_object_is_type(path_j, json_type_string)) return false;
+
+            std::string op = json_object_get_string(op_j);
+            std::string path = json_object_get_string(path_j);
+            constexpr const char* kPrefix = "/slots/";
+            if (path.rfind(kPrefix, 0) != 0) return false;
+
+            int slot = -1;
+            try {
+                slot = std::stoi(path.substr(7));
+            } catch (...) {
+                return false;
+            }
+            if (slot < 0 || slot > 7) return false;
+            const auto k = static_cast<uint8_t>(slot);
 
-        if (op == "remove") {
-            state->slots.erase(k);
-            continue;
-        }
+            if (op == "remove") {
+                staged[k] = StagedOp{true, {}};
+                continue;
+            }
 
-        if (op == "add" || op == "replace") {
-            json_object* value_j = nullptr;
-            if (!json_object_object_get_ex(op_obj, "value", &value_j) || !value_j || !json_object_is_type(value_j, json_type_object)) {
-                return false;
+            if (op == "add" || op == "replace") {
+                json_object* value_j = nullptr;
+                if (!json_object_object_get_ex(op_obj, "value", &value_j) || !value_j || !json_object_is_type(value_j, json_type_object)) {
+                    return false;
+                }
+                StagedOp so;
+                if (!artifact_from_json(value_j, &so.artifact)) return false;
+                staged[k] = std::move(so);
+                continue;
             }
-            Artifact a;
-            if (!artifact_from_json(value_j, &a)) return false;
-            state->slots[k] = std::move(a);
-            continue;
+
+            return false;
         }
+    }
 
-        return false;
+    // Phase 2: one traversal over the staged net effect. Nothing above
+    // touched the state, so a validation failure left it intact.
+    for (auto& kv : staged) {
+        if (kv.second.remove) {
+            state->slots.erase(kv.first);
+        } else {
+            state->slots[kv.first] = std::move(kv.second.artifact);
+        }
     }
     return true;
 }
 
+bool dsstate_apply_tx_patch(json_object* patch, DSState* state) {
+    return dsstate_apply_tx_patches({patch}, state);
+}
+
 // --- StepStatus conversion ---
 
 StepStatus stepstatus_from_str(const std::string& s) {
@@ -0,0 +1,119 @@
+#include "machina/shm_result.h"
+
+#include "machina/fast_rand.h"
+#include "machina/hash.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace machina {
+
+namespace {
+
+constexpr const char* kPrefix = "machina_shm_";
+
+// tmpfs when present so segments never touch a disk; /tmp otherwise.
+const std::string& segment_dir() {
+    static const std::string dir = [] {
+        std::error_code ec;
+        if (std::filesystem::is_directory("/dev/shm", ec)) return std::string("/dev/shm");
+        return std::string("/tmp");
+    }();
+    return dir;
+}
+
+} // namespace
+
+size_t shm_result_threshold() {
+    static const size_t threshold = [] {
+        if (const char* v = std::getenv("MACHINA_SHM_RESULT_MIN")) {
+            try {
+                return (size_t)std::stoull(v);
+            } catch (...) {}
+        }
+        return (size_t)256 * 1024;
+    }();
+    return threshold;
+}
+
+bool shm_result_write(const std::string& payload, std::string* path,
+                      uint64_t* fnv, std::string* err) {
+#ifdef _WIN32
+    (void)payload; (void)path; (void)fnv;
+    if (err) *err = "shm lane unsupported on this platform";
+    return false;
+#else
+    static std::atomic<uint64_t> seq{0};
+    char name[128];
+    std::snprintf(name, sizeof(name), "%s/%s%d_%llu_%016llx", segment_dir().c_str(),
+                  kPrefix, (int)::getpid(),
+                  (unsigned long long)seq.fetch_add(1),
+                  (unsigned long long)fast_rand64());
+    // O_EXCL: the name embeds pid+seq+random, so a collision means someone
+    // is squatting on our namespace — refuse rather than overwrite.
+    int fd = ::open(name, O_CREAT | O_EXCL | O_WRONLY, 0600);
+    if (fd < 0) {
+        if (err) *err = "shm segment create failed";
+        return false;
+    }
+    size_t off = 0;
+    while (off < payload.size()) {
+        ssize_t n = ::write(fd, payload.data() + off, payload.size() - off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ::close(fd);
+            ::unlink(name);
+            if (err) *err = "shm segment write failed";
+            return false;
+        }
+        off += (size_t)n;
+    }
+    ::close(fd);
+    if (path) *path = name;
+    if (fnv) *fnv = hash::fnv1a64(payload);
+    return true;
+#endif
+}
+
+bool shm_result_read(const std::string& path, size_t expect_len,
+                     uint64_t expect_fnv, std::string* out, std::string* err) {
+    // Accept only our own naming scheme in the segment directory: the peer
+    // is same-trust, but a reply must never be able to point the parent at
+    // an arbitrary file.
+    std::string prefix = segment_dir() + "/" + kPrefix;
+    if (path.rfind(prefix, 0) != 0 ||
+        path.find('/', prefix.size()) != std::string::npos ||
+        path.find("..") != std::string::npos) {
+        if (err) *err = "shm path rejected";
+        return false;
+    }
+    std::string body;
+    {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) {
+            if (err) *err = "shm segment missing";
+            return false;
+        }
+        body.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    }
+    if (body.size() != expect_len || hash::fnv1a64(body) != expect_fnv) {
+        if (err) *err = "shm segment verification failed";
+        return false;
+    }
+#ifndef _WIN32
+    ::unlink(path.c_str());
+#endif
+    if (out) *out = std::move(body);
+    return true;
+}
+
+} // namespace machina
@@ -0,0 +1,105 @@
+#include "machina/str_simd.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace machina::str {
+
+namespace {
+
+// A byte needs escaping in a JSON string literal when it is '"', '\\' or a
+// control byte below 0x20. All kernels answer the same question: how many
+// leading bytes are clean?
+
+inline bool needs_escape(unsigned char c) {
+    return c == '"' || c == '\\' || c < 0x20;
+}
+
+size_t scan_scalar(const char* s, size_t n) {
+    size_t i = 0;
+    while (i < n && !needs_escape((unsigned char)s[i])) i++;
+    return i;
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+
+// SSE2 is part of the x86-64 baseline, so this path needs no CPU check.
+size_t scan_sse2(const char* s, size_t n) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i ctl_max = _mm_set1_epi8(0x1F);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        // min_epu8(v, 0x1F) == v  <=>  v <= 0x1F unsigned (control byte).
+        __m128i bad = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(v, ctl_max), v));
+        int mask = _mm_movemask_epi8(bad);
+        if (mask) return i + (size_t)__builtin_ctz((unsigned)mask);
+    }
+    return i + scan_scalar(s + i, n - i);
+}
+
+__attribute__((target("avx2")))
+size_t scan_avx2(const char* s, size_t n) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i bslash = _mm256_set1_epi8('\\');
+    const __m256i ctl_max = _mm256_set1_epi8(0x1F);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i bad = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, bslash)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(v, ctl_max), v));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(bad);
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + scan_sse2(s + i, n - i);
+}
+
+#elif defined(__aarch64__)
+
+size_t scan_neon(const char* s, size_t n) {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t bslash = vdupq_n_u8('\\');
+    const uint8x16_t ctl = vdupq_n_u8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t*)(s + i));
+        uint8x16_t bad = vorrq_u8(
+            vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, bslash)),
+            vcltq_u8(v, ctl));
+        if (vmaxvq_u8(bad)) return i + scan_scalar(s + i, 16);
+    }
+    return i + scan_scalar(s + i, n - i);
+}
+
+#endif
+
+using scan_fn = size_t (*)(const char*, size_t);
+
+scan_fn pick_scan() {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    if (__builtin_cpu_supports("avx2")) return scan_avx2;
+    return scan_sse2;
+#elif defined(__aarch64__)
+    return scan_neon;
+#else
+    return scan_scalar;
+#endif
+}
+
+} // namespace
+
+size_t json_escape_scan(const char* s, size_t n) {
+    static const scan_fn fn = pick_scan();
+    return fn(s, n);
+}
+
+} // namespace machina::str
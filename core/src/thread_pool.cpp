@@ -0,0 +1,111 @@
+#include "machina/thread_pool.h"
+
+#include "machina/numa.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <string>
+
+namespace machina {
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) threads = 1;
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        workers_.emplace_back([this, i] {
+            // Round-robin workers across NUMA nodes when enabled: pinned
+            // workers allocate node-locally via first-touch, so per-worker
+            // scratch (arenas, chunk buffers) stops bouncing across sockets.
+            if (numa_enabled()) {
+                (void)numa_pin_thread((int)(i % (size_t)numa_node_count()));
+            }
+            worker_loop();
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& w : workers_) w.join();
+}
+
+void ThreadPool::submit(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        queue_.push_back(std::move(fn));
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::worker_loop() {
+    for (;;) {
+        std::function<void()> fn;
+        {
+            std::unique_lock<std::mutex> lk(mu_);
+            cv_.wait(lk, [this] { return stop_ || !queue_.empty(); });
+            if (stop_ && queue_.empty()) return;
+            fn = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        fn();
+    }
+}
+
+void ThreadPool::parallel_for(size_t begin, size_t end,
+                              const std::function<void(size_t, size_t)>& fn) {
+    if (begin >= end) return;
+    size_t n = end - begin;
+    size_t chunks = workers_.size() + 1;  // workers plus the calling thread
+    if (chunks > n) chunks = n;
+    size_t per = n / chunks;
+    size_t rem = n % chunks;
+
+    std::atomic<size_t> done{0};
+    std::mutex done_mu;
+    std::condition_variable done_cv;
+
+    size_t at = begin;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    ranges.reserve(chunks);
+    for (size_t c = 0; c < chunks; c++) {
+        size_t len = per + (c < rem ? 1 : 0);
+        ranges.push_back({at, at + len});
+        at += len;
+    }
+
+    // Last chunk runs inline so the caller always makes progress.
+    for (size_t c = 0; c + 1 < ranges.size(); c++) {
+        auto [b, e] = ranges[c];
+        submit([&, b, e] {
+            fn(b, e);
+            if (done.fetch_add(1) + 1 == ranges.size() - 1) {
+                std::lock_guard<std::mutex> lk(done_mu);
+                done_cv.notify_one();
+            }
+        });
+    }
+    fn(ranges.back().first, ranges.back().second);
+
+    std::unique_lock<std::mutex> lk(done_mu);
+    done_cv.wait(lk, [&] { return done.load() == ranges.size() - 1; });
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool([] {
+        if (const char* e = std::getenv("MACHINA_POOL_THREADS")) {
+            try {
+                size_t n = (size_t)std::stoull(e);
+                if (n > 0) return n;
+            } catch (...) {}
+        }
+        size_t hw = std::thread::hardware_concurrency();
+        return hw > 0 ? hw : (size_t)4;
+    }());
+    return pool;
+}
+
+} // namespace machina
@@ -0,0 +1,151 @@
+#include "machina/tool_metrics.h"
+#include "machina/serialization.h"
+
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#ifndef _WIN32
+  #include <sys/resource.h>
+#endif
+
+namespace machina {
+
+namespace {
+
+struct MetricsRegistry {
+    std::mutex mu;
+    std::unordered_map<std::string, std::unique_ptr<ToolMetricsEntry>> entries;
+};
+
+MetricsRegistry& registry() {
+    static MetricsRegistry r;
+    return r;
+}
+
+int latency_bucket(int64_t us) {
+    if (us <= 1) return 0;
+    int b = 0;
+    uint64_t v = (uint64_t)us;
+    while (v > 1 && b < ToolMetricsEntry::kBuckets - 1) {
+        v >>= 1;
+        b++;
+    }
+    return b;
+}
+
+// Upper bound of bucket b in microseconds — reported as the percentile
+// estimate (conservative: the true value is somewhere inside the bucket).
+uint64_t bucket_upper_us(int b) {
+    return 1ULL << (b + 1);
+}
+
+uint64_t percentile_us(const uint64_t* hist, uint64_t total, double q) {
+    if (total == 0) return 0;
+    uint64_t need = (uint64_t)((double)total * q);
+    if (need == 0) need = 1;
+    uint64_t cum = 0;
+    for (int b = 0; b < ToolMetricsEntry::kBuckets; b++) {
+        cum += hist[b];
+        if (cum >= need) return bucket_upper_us(b);
+    }
+    return bucket_upper_us(ToolMetricsEntry::kBuckets - 1);
+}
+
+} // namespace
+
+bool tool_metrics_enabled() {
+    static const bool on = [] {
+        const char* v = std::getenv("MACHINA_TOOL_METRICS");
+        return !(v && std::string(v) == "0");
+    }();
+    return on;
+}
+
+ToolMetricsEntry* tool_metrics_entry(const std::string& aid) {
+    if (!tool_metrics_enabled()) return nullptr;
+    MetricsRegistry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mu);
+    auto it = r.entries.find(aid);
+    if (it != r.entries.end()) return it->second.get();
+    auto e = std::make_unique<ToolMetricsEntry>();
+    ToolMetricsEntry* p = e.get();
+    r.entries[aid] = std::move(e);
+    return p;
+}
+
+void tool_metrics_record(ToolMetricsEntry* e, int64_t us, bool error, bool timeout) {
+    if (!e) return;
+    if (us < 0) us = 0;
+    e->calls.fetch_add(1, std::memory_order_relaxed);
+    if (error) e->errors.fetch_add(1, std::memory_order_relaxed);
+    if (timeout) e->timeouts.fetch_add(1, std::memory_order_relaxed);
+    e->total_us.fetch_add((uint64_t)us, std::memory_order_relaxed);
+    e->hist[latency_bucket(us)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t cur = e->max_us.load(std::memory_order_relaxed);
+    while ((uint64_t)us > cur
+           && !e->max_us.compare_exchange_weak(cur, (uint64_t)us,
+                                               std::memory_order_relaxed)) {
+    }
+}
+
+std::string tool_metrics_json() {
+    std::ostringstream out;
+    out << "{\"ok\":true,\"enabled\":" << (tool_metrics_enabled() ? "true" : "false");
+
+#ifndef _WIN32
+    struct rusage self{};
+    struct rusage kids{};
+    (void)getrusage(RUSAGE_SELF, &self);
+    (void)getrusage(RUSAGE_CHILDREN, &kids);
+    auto cpu_ms = [](const struct timeval& tv) {
+        return (long long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    };
+    out << ",\"self\":{\"max_rss_kb\":" << (long long)self.ru_maxrss
+        << ",\"user_cpu_ms\":" << cpu_ms(self.ru_utime)
+        << ",\"sys_cpu_ms\":" << cpu_ms(self.ru_stime) << "}";
+    out << ",\"children\":{\"max_rss_kb\":" << (long long)kids.ru_maxrss
+        << ",\"user_cpu_ms\":" << cpu_ms(kids.ru_utime)
+        << ",\"sys_cpu_ms\":" << cpu_ms(kids.ru_stime) << "}";
+#endif
+
+    out << ",\"tools\":{";
+    MetricsRegistry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mu);
+    bool first = true;
+    for (const auto& kv : r.entries) {
+        const ToolMetricsEntry& e = *kv.second;
+        uint64_t calls = e.calls.load(std::memory_order_relaxed);
+        uint64_t hist[ToolMetricsEntry::kBuckets];
+        for (int b = 0; b < ToolMetricsEntry::kBuckets; b++) {
+            hist[b] = e.hist[b].load(std::memory_order_relaxed);
+        }
+        if (!first) out << ",";
+        first = false;
+        out << json_quote(kv.first) << ":{";
+        out << "\"calls\":" << calls;
+        out << ",\"errors\":" << e.errors.load(std::memory_order_relaxed);
+        out << ",\"timeouts\":" << e.timeouts.load(std::memory_order_relaxed);
+        uint64_t total_us = e.total_us.load(std::memory_order_relaxed);
+        out << ",\"mean_us\":" << (calls > 0 ? total_us / calls : 0);
+        out << ",\"max_us\":" << e.max_us.load(std::memory_order_relaxed);
+        out << ",\"p50_us\":" << percentile_us(hist, calls, 0.50);
+        out << ",\"p95_us\":" << percentile_us(hist, calls, 0.95);
+        // non-zero buckets only, keyed by their floor in microseconds
+        out << ",\"hist_us\":{";
+        bool hfirst = true;
+        for (int b = 0; b < ToolMetricsEntry::kBuckets; b++) {
+            if (hist[b] == 0) continue;
+            if (!hfirst) out << ",";
+            hfirst = false;
+            out << "\"" << (b == 0 ? 0 : (1ULL << b)) << "\":" << hist[b];
+        }
+        out << "}}";
+    }
+    out << "}}";
+    return out.str();
+}
+
+} // namespace machina
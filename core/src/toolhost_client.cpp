@@ -0,0 +1,231 @@
+#include "machina/toolhost_client.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+
+#ifndef _WIN32
+  #include <unistd.h>
+  #include <fcntl.h>
+  #include <poll.h>
+  #include <signal.h>
+  #include <sys/resource.h>
+  #include <sys/stat.h>
+  #include <sys/wait.h>
+  #ifdef __linux__
+    #include <sys/prctl.h>
+  #endif
+#endif
+
+namespace machina {
+
+bool ToolHostSession::start() {
+#ifdef _WIN32
+    return false;
+#else
+    shutdown(); // clean up any previous session
+
+    // Ignore SIGPIPE so write() to dead child returns EPIPE instead of killing us
+    ::signal(SIGPIPE, SIG_IGN);
+
+    int in_pipe[2], out_pipe[2];
+    if (::pipe(in_pipe) != 0) return false;
+    if (::pipe(out_pipe) != 0) { ::close(in_pipe[0]); ::close(in_pipe[1]); return false; }
+
+    pid_t child = ::fork();
+    if (child < 0) {
+        ::close(in_pipe[0]); ::close(in_pipe[1]);
+        ::close(out_pipe[0]); ::close(out_pipe[1]);
+        return false;
+    }
+
+    if (child == 0) {
+        // New process group for clean group-kill on shutdown
+        ::setpgid(0, 0);
+
+        // child: wire stdin/stdout, leave stderr for debug logging
+        ::dup2(in_pipe[0], STDIN_FILENO);
+        ::dup2(out_pipe[1], STDOUT_FILENO);
+        ::close(in_pipe[0]); ::close(in_pipe[1]);
+        ::close(out_pipe[0]); ::close(out_pipe[1]);
+
+        long maxfd = ::sysconf(_SC_OPEN_MAX);
+        if (maxfd < 256) maxfd = 256;
+        for (int fd = 3; fd < (int)maxfd; fd++) ::close(fd);
+
+        ::umask(077);
+#ifdef __linux__
+        ::prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+        // Apply resource limits (NOT CPU — process is long-lived)
+        const ProcLimits& lim = cfg.limits;
+        if (lim.rlimit_as_mb > 0) {
+            struct rlimit rl;
+            rl.rlim_cur = rl.rlim_max = (rlim_t)lim.rlimit_as_mb * 1024ULL * 1024ULL;
+            ::setrlimit(RLIMIT_AS, &rl);
+        }
+        if (lim.rlimit_fsize_mb > 0) {
+            struct rlimit rl;
+            rl.rlim_cur = rl.rlim_max = (rlim_t)lim.rlimit_fsize_mb * 1024ULL * 1024ULL;
+            ::setrlimit(RLIMIT_FSIZE, &rl);
+        }
+        if (lim.rlimit_nofile > 0) {
+            struct rlimit rl;
+            rl.rlim_cur = rl.rlim_max = (rlim_t)lim.rlimit_nofile;
+            ::setrlimit(RLIMIT_NOFILE, &rl);
+        }
+        if (lim.rlimit_nproc > 0) {
+            struct rlimit rl;
+            rl.rlim_cur = rl.rlim_max = (rlim_t)lim.rlimit_nproc;
+            ::setrlimit(RLIMIT_NPROC, &rl);
+        }
+#ifdef __linux__
+        if (lim.no_new_privs) {
+            ::prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+        }
+#endif
+
+        ::execl(cfg.toolhost_bin.c_str(), cfg.toolhost_bin.c_str(),
+                "--serve", cfg.plugin.c_str(), nullptr);
+        ::_exit(127);
+    }
+
+    // parent
+    ::close(in_pipe[0]);
+    ::close(out_pipe[1]);
+    to_child = in_pipe[1];
+    from_child = out_pipe[0];
+    pid = child;
+    ::setpgid(child, child); // mirror child's setpgid (race safety)
+
+    int flags = ::fcntl(from_child, F_GETFL, 0);
+    if (flags >= 0) ::fcntl(from_child, F_SETFL, flags | O_NONBLOCK);
+
+    fail_count = 0;
+    base_ds = DSState{};
+    return true;
+#endif
+}
+
+std::string ToolHostSession::send_receive(const std::string& request, int timeout_ms) {
+#ifdef _WIN32
+    (void)request; (void)timeout_ms;
+    return "";
+#else
+    if (pid < 0 || to_child < 0 || from_child < 0) return "";
+
+    // Check child alive — if dead, clean up FDs immediately (defense-in-depth)
+    int st = 0;
+    pid_t w = ::waitpid(pid, &st, WNOHANG);
+    if (w == pid) {
+        pid = -1;
+        if (to_child >= 0) { ::close(to_child); to_child = -1; }
+        if (from_child >= 0) { ::close(from_child); from_child = -1; }
+        return "";
+    }
+
+    // Write request + newline
+    std::string line = request;
+    if (line.empty() || line.back() != '\n') line += '\n';
+    size_t off = 0;
+    while (off < line.size()) {
+        ssize_t n = ::write(to_child, line.data() + off, line.size() - off);
+        if (n > 0) { off += (size_t)n; continue; }
+        if (n == -1 && errno == EINTR) continue;
+        return ""; // write error (child likely dead)
+    }
+
+    // Read response line with timeout
+    auto t0 = std::chrono::steady_clock::now();
+    static constexpr size_t MAX_RESPONSE_BYTES = 1024 * 1024; // 1 MB hard cap
+    std::string resp;
+    while (true) {
+        char buf[8192];
+        ssize_t n = ::read(from_child, buf, sizeof(buf));
+        if (n > 0) {
+            if (resp.size() + (size_t)n > MAX_RESPONSE_BYTES) return ""; // response too large
+            resp.append(buf, (size_t)n);
+            auto nl = resp.find('\n');
+            if (nl != std::string::npos) return resp.substr(0, nl);
+            continue;
+        }
+        if (n == 0) return ""; // EOF — child closed stdout
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            auto now = std::chrono::steady_clock::now();
+            int elapsed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(now - t0).count();
+            if (timeout_ms > 0 && elapsed >= timeout_ms) return "";
+            struct pollfd pfd;
+            pfd.fd = from_child;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            int remain = timeout_ms > 0 ? timeout_ms - elapsed : 1000;
+            ::poll(&pfd, 1, std::min(remain, 100));
+            continue;
+        }
+        return ""; // read error
+    }
+#endif
+}
+
+void ToolHostSession::shutdown() {
+#ifndef _WIN32
+    if (to_child >= 0) {
+        ssize_t wr = ::write(to_child, "\n", 1); // graceful shutdown signal
+        (void)wr;
+        ::close(to_child);
+        to_child = -1;
+    }
+    if (pid > 0) {
+        int st = 0;
+        ::usleep(50000); // 50ms grace
+        pid_t w = ::waitpid(pid, &st, WNOHANG);
+        if (w != pid) {
+            ::killpg(pid, SIGTERM); // kill entire process group
+            ::usleep(100000); // 100ms
+            w = ::waitpid(pid, &st, WNOHANG);
+            if (w != pid) {
+                ::killpg(pid, SIGKILL); // force kill entire group
+                ::waitpid(pid, &st, 0);
+            }
+        }
+        pid = -1;
+    }
+    if (from_child >= 0) {
+        ::close(from_child);
+        from_child = -1;
+    }
+#endif
+}
+
+ToolHostPool::ToolHostPool(const ToolHostConfig& cfg)
+    : pool_size_(std::max(cfg.pool_size, 1)) {
+    sessions_.resize((size_t)pool_size_);
+    in_use_.resize((size_t)pool_size_, false);
+    for (int i = 0; i < pool_size_; i++) {
+        sessions_[(size_t)i] = std::make_unique<ToolHostSession>();
+        sessions_[(size_t)i]->cfg = cfg;
+    }
+}
+
+ToolHostPool::Lease ToolHostPool::acquire() {
+    std::unique_lock<std::mutex> lk(mu_);
+    while (true) {
+        for (int i = 0; i < pool_size_; i++) {
+            if (!in_use_[(size_t)i]) {
+                in_use_[(size_t)i] = true;
+                return Lease{this, i, sessions_[(size_t)i].get()};
+            }
+        }
+        cv_.wait(lk);
+    }
+}
+
+void ToolHostPool::release(int idx) {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        in_use_[(size_t)idx] = false;
+    }
+    cv_.notify_one();
+}
+
+} // namespace machina
@@ -2,15 +2,42 @@
 #include "machina/proc.h"
 #include "machina/json_mini.h"
 #include "machina/serialization.h"
+#include "machina/tool_metrics.h"
+#include "machina/trace.h"
 
 #include <json-c/json.h>
 
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <sstream>
 #include <stdexcept>
 
 namespace machina {
 
+namespace {
+std::atomic<int64_t> g_tool_result_copies{0};
+} // namespace
+
+ToolResult::ToolResult(const ToolResult& o)
+    : status(o.status), output_json(o.output_json), error(o.error) {
+    g_tool_result_copies.fetch_add(1, std::memory_order_relaxed);
+}
+
+ToolResult& ToolResult::operator=(const ToolResult& o) {
+    if (this != &o) {
+        status = o.status;
+        output_json = o.output_json;
+        error = o.error;
+        g_tool_result_copies.fetch_add(1, std::memory_order_relaxed);
+    }
+    return *this;
+}
+
+int64_t tool_result_copy_count() {
+    return g_tool_result_copies.load(std::memory_order_relaxed);
+}
+
 void ToolRunner::registerTool(const AID& aid, ToolFn fn) {
     fns_[aid] = std::move(fn);
 }
@@ -23,12 +50,27 @@ ToolResult ToolRunner::run(const AID& aid, const std::string& input_json, DSStat
         return {StepStatus::TOOL_ERROR, "{}", "MISSING_TOOL: " + aid};
     }
 
+    ToolMetricsEntry* metrics = tool_metrics_entry(aid);
+    MACHINA_TRACE_SPAN("tool_run");
+    auto t0 = std::chrono::steady_clock::now();
+
+    ToolResult r;
     // Route isolated tools through toolhost subprocess
     if (isolation_enabled_ && isolated_.count(aid) > 0) {
-        return runViaToolhost(aid, input_json, ds_tmp);
+        r = runViaToolhost(aid, input_json, ds_tmp);
+    } else {
+        r = it->second(input_json, ds_tmp);
     }
 
-    return it->second(input_json, ds_tmp);
+    if (metrics) {
+        int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        // timeouts only surface as an error string; "timed out" covers the
+        // toolhost launcher and the shell/http tools
+        bool timeout = r.error.find("timed out") != std::string::npos;
+        tool_metrics_record(metrics, us, r.status != StepStatus::OK, timeout);
+    }
+    return r;
 }
 
 void ToolRunner::enableIsolation(const std::string& toolhost_bin,
@@ -45,17 +87,14 @@ void ToolRunner::enableIsolation(const std::string& toolhost_bin,
 ToolResult ToolRunner::runViaToolhost(const AID& aid,
                                       const std::string& input_json,
                                       DSState& ds_tmp) const {
-    // Build the request JSON for toolhost --run
-    json_object* reqj = json_object_new_object();
-    json_object_object_add(reqj, "input_json",
-        json_object_new_string_len(input_json.c_str(), (int)input_json.size()));
-
-    // Serialize current DSState for the subprocess
-    json_object* dsj = dsstate_to_json(ds_tmp);
-    json_object_object_add(reqj, "ds_state", dsj);
-
-    std::string req_str = json_object_to_json_string_ext(reqj, JSON_C_TO_STRING_PLAIN);
-    json_object_put(reqj);
+    // Build the request JSON for toolhost --run. Written directly — no
+    // json-c tree for a request we only ever serialize.
+    JsonWriter req(input_json.size() + 256);
+    req.begin_object();
+    req.kv("input_json", input_json);
+    req.kv_raw("ds_state", dsstate_to_json_str(ds_tmp));
+    req.end_object();
+    std::string req_str = req.take();
 
     // Build argv: machina_cli tool_exec <aid>
     // The tool_exec subcommand registers all tier0 tools and executes one
@@ -72,6 +111,9 @@ ToolResult ToolRunner::runViaToolhost(const AID& aid,
     if (const char* v = std::getenv("MACHINA_TOOLHOST_TIMEOUT_MS")) {
         try { lim.timeout_ms = std::stoi(v); } catch (...) {}
     }
+    if (timeout_cap_ms_ > 0 && lim.timeout_ms > timeout_cap_ms_) {
+        lim.timeout_ms = timeout_cap_ms_;
+    }
     lim.stdout_max_bytes = 1024 * 1024;  // 1MB
     lim.rlimit_as_mb = 1024;             // 1GB virtual memory
     lim.rlimit_cpu_sec = 30;
@@ -0,0 +1,184 @@
+#include "machina/trace.h"
+#include "machina/fast_rand.h"
+#include "machina/serialization.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#ifndef _WIN32
+  #include <unistd.h>
+#endif
+
+namespace machina {
+
+namespace {
+
+struct TraceRegistry {
+    std::mutex mu;
+    std::unordered_map<std::string, std::unique_ptr<TraceStage>> stages;
+};
+
+TraceRegistry& registry() {
+    static TraceRegistry r;
+    return r;
+}
+
+int latency_bucket(int64_t us) {
+    if (us <= 1) return 0;
+    int b = 0;
+    uint64_t v = (uint64_t)us;
+    while (v > 1 && b < TraceStage::kBuckets - 1) {
+        v >>= 1;
+        b++;
+    }
+    return b;
+}
+
+uint64_t bucket_upper_us(int b) {
+    return 1ULL << (b + 1);
+}
+
+uint64_t percentile_us(const uint64_t* hist, uint64_t total, double q) {
+    if (total == 0) return 0;
+    uint64_t need = (uint64_t)((double)total * q);
+    if (need == 0) need = 1;
+    uint64_t cum = 0;
+    for (int b = 0; b < TraceStage::kBuckets; b++) {
+        cum += hist[b];
+        if (cum >= need) return bucket_upper_us(b);
+    }
+    return bucket_upper_us(TraceStage::kBuckets - 1);
+}
+
+// Chrome-trace emission: one per-process file of complete ("X") events.
+// chrome://tracing and Perfetto accept an unterminated array, so events
+// are appended as they close and a crash loses nothing already written.
+struct ChromeSink {
+    std::mutex mu;
+    std::ofstream out;
+    std::string path;
+    bool open{false};
+};
+
+ChromeSink& chrome_sink() {
+    static ChromeSink* s = [] {
+        auto* sink = new ChromeSink();
+        const char* v = std::getenv("MACHINA_TRACE_CHROME");
+        if (!trace_enabled() || !v || std::string(v) != "1") return sink;
+        // Sampled fraction of processes: queue workers and pulse runs are
+        // plentiful, a 1-in-N slice is enough to see the shape.
+        long n = 1;
+        if (const char* sv = std::getenv("MACHINA_TRACE_SAMPLE")) {
+            try { n = std::stol(sv); } catch (...) {}
+        }
+        if (n > 1 && (fast_rand64() % (uint64_t)n) != 0) return sink;
+        std::filesystem::path root =
+            std::getenv("MACHINA_ROOT") ? std::getenv("MACHINA_ROOT") : ".";
+        std::error_code ec;
+        std::filesystem::create_directories(root / "work" / "trace", ec);
+#ifdef _WIN32
+        long long pid = 0;
+#else
+        long long pid = (long long)getpid();
+#endif
+        sink->path = (root / "work" / "trace" /
+                      ("chrome_" + std::to_string(pid) + ".json")).string();
+        sink->out.open(sink->path, std::ios::out | std::ios::trunc);
+        if (sink->out) {
+            sink->out << "[\n";
+            sink->open = true;
+        }
+        return sink;
+    }();
+    return *s;
+}
+
+} // namespace
+
+bool trace_enabled() {
+    static const bool on = [] {
+        const char* v = std::getenv("MACHINA_TRACE");
+        return v && std::string(v) == "1";
+    }();
+    return on;
+}
+
+TraceStage* trace_stage(const std::string& name) {
+    if (!trace_enabled()) return nullptr;
+    TraceRegistry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mu);
+    auto it = r.stages.find(name);
+    if (it != r.stages.end()) return it->second.get();
+    auto e = std::make_unique<TraceStage>();
+    TraceStage* p = e.get();
+    r.stages[name] = std::move(e);
+    return p;
+}
+
+int64_t trace_now_us() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - epoch).count();
+}
+
+void trace_record(TraceStage* e, const char* name, int64_t start_us, int64_t dur_us) {
+    if (!e) return;
+    if (dur_us < 0) dur_us = 0;
+    e->calls.fetch_add(1, std::memory_order_relaxed);
+    e->total_us.fetch_add((uint64_t)dur_us, std::memory_order_relaxed);
+    e->hist[latency_bucket(dur_us)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t cur = e->max_us.load(std::memory_order_relaxed);
+    while ((uint64_t)dur_us > cur
+           && !e->max_us.compare_exchange_weak(cur, (uint64_t)dur_us,
+                                               std::memory_order_relaxed)) {
+    }
+
+    ChromeSink& sink = chrome_sink();
+    if (!sink.open) return;
+    uint64_t tid = std::hash<std::thread::id>{}(std::this_thread::get_id()) & 0xFFFF;
+    std::lock_guard<std::mutex> lk(sink.mu);
+    sink.out << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+             << tid << ",\"ts\":" << start_us << ",\"dur\":" << dur_us << "},\n";
+    sink.out.flush();
+}
+
+std::string trace_json() {
+    std::ostringstream out;
+    out << "{\"ok\":true,\"enabled\":" << (trace_enabled() ? "true" : "false");
+    {
+        ChromeSink& sink = chrome_sink();
+        if (sink.open) out << ",\"chrome_trace\":" << json_quote(sink.path);
+    }
+    out << ",\"stages\":{";
+    TraceRegistry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mu);
+    bool first = true;
+    for (const auto& kv : r.stages) {
+        const TraceStage& e = *kv.second;
+        uint64_t calls = e.calls.load(std::memory_order_relaxed);
+        uint64_t hist[TraceStage::kBuckets];
+        for (int b = 0; b < TraceStage::kBuckets; b++) {
+            hist[b] = e.hist[b].load(std::memory_order_relaxed);
+        }
+        if (!first) out << ",";
+        first = false;
+        out << json_quote(kv.first) << ":{";
+        out << "\"calls\":" << calls;
+        uint64_t total_us = e.total_us.load(std::memory_order_relaxed);
+        out << ",\"mean_us\":" << (calls > 0 ? total_us / calls : 0);
+        out << ",\"max_us\":" << e.max_us.load(std::memory_order_relaxed);
+        out << ",\"p50_us\":" << percentile_us(hist, calls, 0.50);
+        out << ",\"p95_us\":" << percentile_us(hist, calls, 0.95);
+        out << "}";
+    }
+    out << "}}";
+    return out.str();
+}
+
+} // namespace machina
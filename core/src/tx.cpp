@@ -1,73 +1,97 @@
 #include "machina/tx.h"
-#include "machina/hash.h"
+#include "machina/trace.h"
+#include "machina/crypto.h"
 #include "machina/serialization.h"
 
 #include <json-c/json.h>
 
 #include <algorithm>
+#include <cstddef>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 namespace machina {
 
 static std::string slot_fingerprint(const Artifact& a) {
     // Stable-ish fingerprint for diff decisions.
-    // Note: content_json could be large; include it for correctness (RC profile).
-    std::string s = a.type + "|" + a.provenance + "|" + std::to_string(a.size_bytes) + "|" + a.content_json;
-    return hash::sha256_hex(s);
+    // Note: content_json could be large; stream it through the hash
+    // context instead of materializing the concatenation (RC profile).
+    Sha256Ctx ctx;
+    ctx.update(a.type);
+    ctx.update("|");
+    ctx.update(a.provenance);
+    ctx.update("|");
+    ctx.update(std::to_string(a.size_bytes));
+    ctx.update("|");
+    ctx.update(a.content_json);
+    return ctx.final_hex();
 }
 
-static std::string compute_patch_json(const DSState& from, const DSState& to) {
-    json_object* arr = json_object_new_array();
+static std::string compute_patch_json(const std::unordered_map<uint8_t, std::string>& base_fps,
+                                      const DSState& to) {
+    // Straight into a JsonWriter buffer; this runs on every commit and
+    // used to build a json-c tree just to serialize and free it.
+    JsonWriter w(256);
+    w.begin_array();
 
-    auto add_op = [&](const char* op, uint8_t slot, json_object* value_or_null) {
-        json_object* o = json_object_new_object();
-        json_object_object_add(o, "op", json_object_new_string(op));
-        std::string path = std::string("/slots/") + std::to_string(slot);
-        json_object_object_add(o, "path", json_object_new_string(path.c_str()));
-        if (value_or_null) {
-            json_object_object_add(o, "value", value_or_null);
+    auto add_op = [&](const char* op, uint8_t slot, const Artifact* value) {
+        w.begin_object();
+        w.kv("op", op);
+        w.kv("path", "/slots/" + std::to_string(slot));
+        if (value) {
+            w.key("value");
+            artifact_write(w, *value);
         }
-        json_object_array_add(arr, o);
+        w.end_object();
     };
 
     for (uint8_t slot = 0; slot < 8; slot++) {
-        auto it_from = from.slots.find(slot);
+        auto it_from = base_fps.find(slot);
         auto it_to = to.slots.find(slot);
-        const bool has_from = (it_from != from.slots.end());
+        const bool has_from = (it_from != base_fps.end());
         const bool has_to = (it_to != to.slots.end());
 
         if (!has_from && has_to) {
-            add_op("add", slot, artifact_to_json(it_to->second));
+            add_op("add", slot, &it_to->second);
         } else if (has_from && !has_to) {
             add_op("remove", slot, nullptr);
         } else if (has_from && has_to) {
-            const auto f1 = slot_fingerprint(it_from->second);
-            const auto f2 = slot_fingerprint(it_to->second);
-            if (f1 != f2) {
-                add_op("replace", slot, artifact_to_json(it_to->second));
+            if (it_from->second != slot_fingerprint(it_to->second)) {
+                add_op("replace", slot, &it_to->second);
             }
         }
     }
 
-    std::string out = json_object_to_json_string_ext(arr, JSON_C_TO_STRING_PLAIN);
-    json_object_put(arr);
-    return out;
+    w.end_array();
+    return w.take();
+}
+
+Tx::Tx(const DSState& base) : tmp_(base), active_(true) {
+    base_fps_.reserve(base.slots.size());
+    for (const auto& kv : base.slots) {
+        base_fps_[kv.first] = slot_fingerprint(kv.second);
+    }
 }
 
-Tx::Tx(const DSState& base) : base_(base), tmp_(base), active_(true) {}
+Tx::Tx(const StateSnapshot& base) : active_(true) {
+    for (uint8_t slot = 0; slot < 8; slot++) {
+        if (!base.slots[slot]) continue;
+        tmp_.slots[slot] = *base.slots[slot];
+        base_fps_[slot] = slot_fingerprint(*base.slots[slot]);
+    }
+}
 
 DSState& Tx::tmp() {
     if (!active_) throw std::runtime_error("tx not active");
     return tmp_;
 }
 
-const DSState& Tx::base() const { return base_; }
-
 void Tx::commit(DSState& target) {
+    MACHINA_TRACE_SPAN("tx_commit");
     if (!active_) throw std::runtime_error("tx not active");
-    patch_json_ = compute_patch_json(base_, tmp_);
-    target = tmp_;
+    patch_json_ = compute_patch_json(base_fps_, tmp_);
+    target = std::move(tmp_);
     active_ = false;
 }
 
@@ -75,4 +99,140 @@ void Tx::rollback() {
     active_ = false;
 }
 
+std::vector<uint8_t> Tx::changed_slots() const {
+    if (!active_) throw std::runtime_error("tx not active");
+    std::vector<uint8_t> out;
+    for (uint8_t slot = 0; slot < 8; slot++) {
+        auto it_from = base_fps_.find(slot);
+        auto it_to = tmp_.slots.find(slot);
+        const bool has_from = (it_from != base_fps_.end());
+        const bool has_to = (it_to != tmp_.slots.end());
+        if (has_from != has_to) {
+            out.push_back(slot);
+        } else if (has_from && has_to &&
+                   it_from->second != slot_fingerprint(it_to->second)) {
+            out.push_back(slot);
+        }
+    }
+    return out;
+}
+
+std::string merge_tx_patches(const std::vector<std::string>& patches) {
+    // Net effect per slot: later ops overwrite earlier ones, same rule
+    // as sequential application. Keep a refcounted handle on each op's
+    // parent array so collapsed ops stay alive until serialization.
+    struct Held {
+        json_object* root;
+        json_object* op;
+    };
+    std::unordered_map<int, Held> last_op;
+    std::vector<json_object*> roots;
+    bool ok = true;
+
+    for (const auto& ps : patches) {
+        if (ps.empty()) continue;
+        json_object* arr = json_tokener_parse(ps.c_str());
+        if (!arr || !json_object_is_type(arr, json_type_array)) {
+            if (arr) json_object_put(arr);
+            ok = false;
+            break;
+        }
+        roots.push_back(arr);
+        const size_t n = json_object_array_length(arr);
+        for (size_t i = 0; i < n; i++) {
+            json_object* op_obj = json_object_array_get_idx(arr, i);
+            json_object* path_j = nullptr;
+            if (!op_obj ||
+                !json_object_object_get_ex(op_obj, "path", &path_j) ||
+                !json_object_is_type(path_j, json_type_string)) {
+                ok = false;
+                break;
+            }
+            std::string path = json_object_get_string(path_j);
+            int slot = -1;
+            if (path.rfind("/slots/", 0) == 0) {
+                try { slot = std::stoi(path.substr(7)); } catch (...) {}
+            }
+            if (slot < 0 || slot > 7) {
+                ok = false;
+                break;
+            }
+            last_op[slot] = Held{arr, op_obj};
+        }
+        if (!ok) break;
+    }
+
+    std::string out;
+    if (ok) {
+        json_object* merged = json_object_new_array();
+        for (uint8_t slot = 0; slot < 8; slot++) {
+            auto it = last_op.find(slot);
+            if (it == last_op.end()) continue;
+            json_object_array_add(merged, json_object_get(it->second.op));
+        }
+        out = json_object_to_json_string_ext(merged, JSON_C_TO_STRING_PLAIN);
+        json_object_put(merged);
+    }
+    for (json_object* r : roots) json_object_put(r);
+    return out;
+}
+
+DSState StateSnapshot::materialize() const {
+    DSState s;
+    for (uint8_t slot = 0; slot < 8; slot++) {
+        if (slots[slot]) s.slots[slot] = *slots[slot];
+    }
+    return s;
+}
+
+StateCell::StateCell(DSState initial) {
+    for (auto& kv : initial.slots) {
+        if (kv.first > 7) continue;
+        slots_[kv.first] = std::make_shared<const Artifact>(std::move(kv.second));
+    }
+}
+
+StateSnapshot StateCell::snapshot() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    StateSnapshot s;
+    s.slots = slots_;
+    s.slot_versions = slot_versions_;
+    s.version = version_;
+    return s;
+}
+
+bool StateCell::try_commit(Tx& tx, const StateSnapshot& base, uint64_t* out_version) {
+    MACHINA_TRACE_SPAN("state_cell_commit");
+    auto changed = tx.changed_slots();
+
+    std::lock_guard<std::mutex> lk(mu_);
+    for (uint8_t slot : changed) {
+        if (slot_versions_[slot] != base.slot_versions[slot]) return false;
+    }
+
+    // Validation passed: finalize the tx (computes its patch) and publish
+    // the written slots as fresh immutable artifacts. Untouched slots keep
+    // their shared nodes, so old snapshots stay intact and nothing large
+    // is copied on the commit path.
+    DSState committed;
+    tx.commit(committed);
+    version_++;
+    for (uint8_t slot : changed) {
+        auto it = committed.slots.find(slot);
+        if (it != committed.slots.end()) {
+            slots_[slot] = std::make_shared<const Artifact>(std::move(it->second));
+        } else {
+            slots_[slot].reset();
+        }
+        slot_versions_[slot] = version_;
+    }
+    if (out_version) *out_version = version_;
+    return true;
+}
+
+uint64_t StateCell::version() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return version_;
+}
+
 } // namespace machina
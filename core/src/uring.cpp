@@ -0,0 +1,298 @@
+#include "machina/uring.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define MACHINA_HAVE_URING 1
+#include <linux/io_uring.h>
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <memory>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace machina {
+
+#ifdef MACHINA_HAVE_URING
+
+namespace {
+
+int sys_io_uring_setup(unsigned entries, struct io_uring_params* p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                        nullptr, (size_t)0);
+}
+
+// EINVAL/EOPNOTSUPP/ENOSYS mean the kernel (or a seccomp filter) does not
+// speak this op — no amount of retrying helps, so the backend latches off.
+std::atomic<bool> g_broken{false};
+
+bool unsupported_errno(int e) {
+    return e == EINVAL || e == EOPNOTSUPP || e == ENOSYS;
+}
+
+// One small ring per thread: rings are single-submitter structures and the
+// chains here are submit-and-wait, so nothing ever outlives a call.
+struct Ring {
+    int fd{-1};
+    unsigned* sq_head{nullptr};
+    unsigned* sq_tail{nullptr};
+    unsigned sq_mask{0};
+    unsigned* sq_array{nullptr};
+    unsigned* cq_head{nullptr};
+    unsigned* cq_tail{nullptr};
+    unsigned cq_mask{0};
+    struct io_uring_sqe* sqes{nullptr};
+    struct io_uring_cqe* cqes{nullptr};
+    void* sq_ptr{nullptr};
+    size_t sq_bytes{0};
+    void* cq_ptr{nullptr};
+    size_t cq_bytes{0};
+    size_t sqe_bytes{0};
+    bool ok{false};
+
+    Ring() {
+        struct io_uring_params p{};
+        fd = sys_io_uring_setup(8, &p);
+        if (fd < 0) return;
+
+        sq_bytes = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_bytes = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+        if (p.features & IORING_FEAT_SINGLE_MMAP) {
+            if (cq_bytes > sq_bytes) sq_bytes = cq_bytes;
+            cq_bytes = sq_bytes;
+        }
+        sq_ptr = mmap(nullptr, sq_bytes, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq_ptr == MAP_FAILED) { sq_ptr = nullptr; return; }
+        if (p.features & IORING_FEAT_SINGLE_MMAP) {
+            cq_ptr = sq_ptr;
+        } else {
+            cq_ptr = mmap(nullptr, cq_bytes, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cq_ptr == MAP_FAILED) { cq_ptr = nullptr; return; }
+        }
+        sqe_bytes = p.sq_entries * sizeof(struct io_uring_sqe);
+        void* sp = mmap(nullptr, sqe_bytes, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sp == MAP_FAILED) return;
+        sqes = (struct io_uring_sqe*)sp;
+
+        char* sq = (char*)sq_ptr;
+        sq_head = (unsigned*)(sq + p.sq_off.head);
+        sq_tail = (unsigned*)(sq + p.sq_off.tail);
+        sq_mask = *(unsigned*)(sq + p.sq_off.ring_mask);
+        sq_array = (unsigned*)(sq + p.sq_off.array);
+        char* cq = (char*)cq_ptr;
+        cq_head = (unsigned*)(cq + p.cq_off.head);
+        cq_tail = (unsigned*)(cq + p.cq_off.tail);
+        cq_mask = *(unsigned*)(cq + p.cq_off.ring_mask);
+        cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+        ok = true;
+    }
+
+    ~Ring() {
+        if (sqes) munmap(sqes, sqe_bytes);
+        if (cq_ptr && cq_ptr != sq_ptr) munmap(cq_ptr, cq_bytes);
+        if (sq_ptr) munmap(sq_ptr, sq_bytes);
+        if (fd >= 0) close(fd);
+    }
+
+    struct io_uring_sqe* next_sqe(unsigned n_queued) {
+        unsigned tail = *sq_tail + n_queued;
+        unsigned idx = tail & sq_mask;
+        struct io_uring_sqe* sqe = &sqes[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array[idx] = idx;
+        return sqe;
+    }
+
+    // Submits n queued SQEs and waits for all their completions. Results
+    // land in res[] in user_data order (user_data = index 0..n-1).
+    bool submit_wait(unsigned n, int* res, std::string* err) {
+        std::atomic_thread_fence(std::memory_order_release);
+        *sq_tail += n;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        unsigned done = 0;
+        while (done < n) {
+            int ret = sys_io_uring_enter(fd, done == 0 ? n : 0, n - done,
+                                         IORING_ENTER_GETEVENTS);
+            if (ret < 0) {
+                if (errno == EINTR) continue;
+                if (unsupported_errno(errno)) g_broken.store(true);
+                if (err) *err = std::string("io_uring_enter: ") + std::strerror(errno);
+                return false;
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            while (*cq_head != *cq_tail && done < n) {
+                struct io_uring_cqe* cqe = &cqes[*cq_head & cq_mask];
+                if (cqe->user_data < n) res[cqe->user_data] = cqe->res;
+                (*cq_head)++;
+                done++;
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+        return true;
+    }
+};
+
+Ring* thread_ring() {
+    thread_local std::unique_ptr<Ring> ring;
+    if (!ring) ring = std::make_unique<Ring>();
+    return ring->ok ? ring.get() : nullptr;
+}
+
+// Core chain: write(+optional short-write completion handled by caller),
+// fsync, optional renameat, all IOSQE_IO_LINK'd. res[] gets one slot per op.
+bool submit_chain(Ring* r, int fd, const void* buf, size_t len,
+                  const char* oldpath, const char* newpath,
+                  int* res, unsigned* nops, std::string* err) {
+    unsigned n = 0;
+    struct io_uring_sqe* w = r->next_sqe(n);
+    w->opcode = IORING_OP_WRITE;
+    w->fd = fd;
+    w->addr = (unsigned long long)(uintptr_t)buf;
+    w->len = (unsigned)len;
+    w->off = (unsigned long long)-1; // current file position (append fds)
+    w->flags = IOSQE_IO_LINK;
+    w->user_data = n++;
+
+    struct io_uring_sqe* f = r->next_sqe(n);
+    f->opcode = IORING_OP_FSYNC;
+    f->fd = fd;
+    f->flags = oldpath ? IOSQE_IO_LINK : 0;
+    f->user_data = n++;
+
+    if (oldpath) {
+        struct io_uring_sqe* rn = r->next_sqe(n);
+        rn->opcode = IORING_OP_RENAMEAT;
+        rn->fd = AT_FDCWD;
+        rn->addr = (unsigned long long)(uintptr_t)oldpath;
+        rn->len = (unsigned)AT_FDCWD;
+        rn->addr2 = (unsigned long long)(uintptr_t)newpath;
+        rn->user_data = n++;
+    }
+
+    *nops = n;
+    for (unsigned i = 0; i < n; i++) res[i] = INT32_MIN;
+    return r->submit_wait(n, res, err);
+}
+
+// Shared tail: interpret the write+fsync results. Returns true when the
+// data is durably written (finishing short writes / failed fsyncs with
+// blocking calls); false only when nothing landed.
+bool settle_write_fsync(int fd, const void* buf, size_t len,
+                        int wres, int fres, std::string* err) {
+    if (wres < 0) {
+        if (unsupported_errno(-wres)) g_broken.store(true);
+        if (err) *err = std::string("uring write: ") + std::strerror(-wres);
+        return false;
+    }
+    size_t written = (size_t)wres;
+    if (written < len) {
+        // Rare for regular files; finish the record with plain write so
+        // the caller never re-submits a half-written payload.
+        const char* p = (const char*)buf;
+        while (written < len) {
+            ssize_t w = ::write(fd, p + written, len - written);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                if (err) *err = std::string("write: ") + std::strerror(errno);
+                return false;
+            }
+            written += (size_t)w;
+        }
+        fres = -ECANCELED; // data changed after the linked fsync ran
+    }
+    if (fres < 0) {
+        if (unsupported_errno(-fres)) g_broken.store(true);
+        if (::fsync(fd) != 0) {
+            if (err) *err = std::string("fsync: ") + std::strerror(errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool uring_enabled() {
+    static const bool requested = [] {
+        const char* v = std::getenv("MACHINA_URING");
+        return v && std::string(v) == "1";
+    }();
+    if (!requested || g_broken.load(std::memory_order_relaxed)) return false;
+    // Probe once with a real linked write+fsync: rings that set up but
+    // cannot run the ops (old kernel, seccomp) latch off here, not on the
+    // WAL path.
+    static const bool probed = [] {
+        Ring* r = thread_ring();
+        if (!r) return false;
+        char tmpl[] = "/tmp/machina_uring_probe_XXXXXX";
+        int fd = mkstemp(tmpl);
+        if (fd < 0) return false;
+        int res[2];
+        unsigned nops = 0;
+        std::string err;
+        bool ok = submit_chain(r, fd, "probe", 5, nullptr, nullptr, res, &nops, &err) &&
+                  res[0] == 5 && res[1] == 0;
+        ::close(fd);
+        ::unlink(tmpl);
+        return ok;
+    }();
+    return probed && !g_broken.load(std::memory_order_relaxed);
+}
+
+bool uring_write_fsync(int fd, const void* buf, size_t len, std::string* err) {
+    Ring* r = thread_ring();
+    if (!r) return false;
+    int res[2];
+    unsigned nops = 0;
+    if (!submit_chain(r, fd, buf, len, nullptr, nullptr, res, &nops, err)) return false;
+    return settle_write_fsync(fd, buf, len, res[0], res[1], err);
+}
+
+bool uring_write_fsync_rename(int tmp_fd, const void* buf, size_t len,
+                              const std::string& tmp_path,
+                              const std::string& dst_path,
+                              std::string* err) {
+    Ring* r = thread_ring();
+    if (!r) return false;
+    int res[3];
+    unsigned nops = 0;
+    if (!submit_chain(r, tmp_fd, buf, len, tmp_path.c_str(), dst_path.c_str(),
+                      res, &nops, err)) {
+        return false;
+    }
+    if (!settle_write_fsync(tmp_fd, buf, len, res[0], res[1], err)) return false;
+    if (res[2] < 0) {
+        if (unsupported_errno(-res[2])) g_broken.store(true);
+        // The tmp file is durable; a plain rename finishes the publish.
+        if (::rename(tmp_path.c_str(), dst_path.c_str()) != 0) {
+            if (err) *err = std::string("rename: ") + std::strerror(errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+#else // !MACHINA_HAVE_URING
+
+bool uring_enabled() { return false; }
+
+bool uring_write_fsync(int, const void*, size_t, std::string*) { return false; }
+
+bool uring_write_fsync_rename(int, const void*, size_t,
+                              const std::string&, const std::string&,
+                              std::string*) { return false; }
+
+#endif
+
+} // namespace machina
@@ -0,0 +1,231 @@
+#include "machina/vec_simd.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace machina::vec {
+
+uint16_t f32_to_f16(float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t exp = (int32_t)((bits >> 23) & 0xFFu) - 127 + 15;
+    uint32_t mant = bits & 0x7FFFFFu;
+    if (exp >= 31) {
+        // Overflow -> inf; NaN keeps a mantissa bit.
+        uint32_t m = ((bits >> 23) & 0xFFu) == 0xFFu && mant ? 0x200u : 0u;
+        return (uint16_t)(sign | 0x7C00u | m);
+    }
+    if (exp <= 0) {
+        if (exp < -10) return (uint16_t)sign;  // underflow to signed zero
+        mant |= 0x800000u;
+        uint32_t shift = (uint32_t)(14 - exp);
+        uint32_t half = (mant >> shift) & 0x3FFu;
+        uint32_t rem = mant & ((1u << shift) - 1u);
+        uint32_t mid = 1u << (shift - 1);
+        if (rem > mid || (rem == mid && (half & 1u))) half++;
+        return (uint16_t)(sign | half);
+    }
+    uint32_t half = (uint32_t)(exp << 10) | (mant >> 13);
+    uint32_t rem = mant & 0x1FFFu;
+    if (rem > 0x1000u || (rem == 0x1000u && (half & 1u))) half++;
+    return (uint16_t)(sign | half);
+}
+
+float f16_to_f32(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+    uint32_t exp = (h >> 10) & 0x1Fu;
+    uint32_t mant = h & 0x3FFu;
+    uint32_t bits;
+    if (exp == 0) {
+        if (mant == 0) {
+            bits = sign;
+        } else {
+            // Subnormal half: renormalize.
+            int e = -1;
+            do { mant <<= 1; e++; } while ((mant & 0x400u) == 0);
+            bits = sign | (uint32_t)((127 - 15 - e) << 23) | ((mant & 0x3FFu) << 13);
+        }
+    } else if (exp == 31) {
+        bits = sign | 0x7F800000u | (mant << 13);
+    } else {
+        bits = sign | ((exp - 15 + 127) << 23) | (mant << 13);
+    }
+    float out;
+    std::memcpy(&out, &bits, sizeof(out));
+    return out;
+}
+
+namespace {
+
+float dot_scalar(const float* a, const float* b, size_t n) {
+    float acc = 0.0f;
+    for (size_t i = 0; i < n; i++) acc += a[i] * b[i];
+    return acc;
+}
+
+float dot_f16_scalar(const float* a, const uint16_t* b, size_t n) {
+    float acc = 0.0f;
+    for (size_t i = 0; i < n; i++) acc += a[i] * f16_to_f32(b[i]);
+    return acc;
+}
+
+float dot_i8_scalar(const float* a, const int8_t* b, size_t n) {
+    float acc = 0.0f;
+    for (size_t i = 0; i < n; i++) acc += a[i] * (float)b[i];
+    return acc;
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+
+__attribute__((target("avx2,fma")))
+float dot_avx2(const float* a, const float* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+    __m128 lo = _mm256_castps256_ps128(acc0);
+    __m128 hi = _mm256_extractf128_ps(acc0, 1);
+    __m128 s = _mm_add_ps(lo, hi);
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    float acc = _mm_cvtss_f32(s);
+    for (; i < n; i++) acc += a[i] * b[i];
+    return acc;
+}
+
+__attribute__((target("avx512f")))
+float dot_avx512(const float* a, const float* b, size_t n) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    }
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+    }
+    float acc = _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+    for (; i < n; i++) acc += a[i] * b[i];
+    return acc;
+}
+
+__attribute__((target("avx2,fma,f16c")))
+float dot_f16_avx2(const float* a, const uint16_t* b, size_t n) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_cvtph_ps(h), acc);
+    }
+    __m128 lo = _mm256_castps256_ps128(acc);
+    __m128 hi = _mm256_extractf128_ps(acc, 1);
+    __m128 s = _mm_add_ps(lo, hi);
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    float out = _mm_cvtss_f32(s);
+    for (; i < n; i++) out += a[i] * f16_to_f32(b[i]);
+    return out;
+}
+
+__attribute__((target("avx2,fma")))
+float dot_i8_avx2(const float* a, const int8_t* b, size_t n) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i q = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(b + i));
+        __m256 bf = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(q));
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), bf, acc);
+    }
+    __m128 lo = _mm256_castps256_ps128(acc);
+    __m128 hi = _mm256_extractf128_ps(acc, 1);
+    __m128 s = _mm_add_ps(lo, hi);
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    float out = _mm_cvtss_f32(s);
+    for (; i < n; i++) out += a[i] * (float)b[i];
+    return out;
+}
+
+#elif defined(__aarch64__)
+
+float dot_neon(const float* a, const float* b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float acc = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; i < n; i++) acc += a[i] * b[i];
+    return acc;
+}
+
+#endif
+
+using dot_fn = float (*)(const float*, const float*, size_t);
+using dot_f16_fn = float (*)(const float*, const uint16_t*, size_t);
+using dot_i8_fn = float (*)(const float*, const int8_t*, size_t);
+
+dot_fn pick_dot() {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    if (__builtin_cpu_supports("avx512f")) return dot_avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return dot_avx2;
+    return dot_scalar;
+#elif defined(__aarch64__)
+    return dot_neon;
+#else
+    return dot_scalar;
+#endif
+}
+
+dot_f16_fn pick_dot_f16() {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+        __builtin_cpu_supports("f16c")) return dot_f16_avx2;
+#endif
+    return dot_f16_scalar;
+}
+
+dot_i8_fn pick_dot_i8() {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return dot_i8_avx2;
+#endif
+    return dot_i8_scalar;
+}
+
+} // namespace
+
+float dot_f32(const float* a, const float* b, size_t n) {
+    static const dot_fn fn = pick_dot();
+    return fn(a, b, n);
+}
+
+float dot_f16(const float* a, const uint16_t* b, size_t n) {
+    static const dot_f16_fn fn = pick_dot_f16();
+    return fn(a, b, n);
+}
+
+float dot_i8(const float* a, const int8_t* b, size_t n) {
+    static const dot_i8_fn fn = pick_dot_i8();
+    return fn(a, b, n);
+}
+
+} // namespace machina::vec
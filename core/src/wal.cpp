@@ -1,4 +1,8 @@
 #include "machina/wal.h"
+#include "machina/trace.h"
+#include "machina/uring.h"
+
+#include "machina/hash.h"
 
 #include <algorithm>
 #include <cerrno>
@@ -15,37 +19,9 @@
 #include <unistd.h>
 #endif
 
-namespace machina {
-
-// ---------- CRC32 (ISO 3309 / zlib polynomial) ----------
-// Used for framed WAL format to detect torn writes.
-static uint32_t g_crc32_table[256];
-static std::once_flag g_crc32_once;
-
-static void crc32_do_init() {
-    for (uint32_t i = 0; i < 256; i++) {
-        uint32_t c = i;
-        for (int j = 0; j < 8; j++) {
-            if (c & 1) c = 0xEDB88320u ^ (c >> 1);
-            else       c = c >> 1;
-        }
-        g_crc32_table[i] = c;
-    }
-}
-
-static void crc32_init_table() {
-    std::call_once(g_crc32_once, crc32_do_init);
-}
+#include <zlib.h>
 
-static uint32_t crc32_compute(const void* data, size_t len) {
-    crc32_init_table();
-    const uint8_t* p = (const uint8_t*)data;
-    uint32_t crc = 0xFFFFFFFFu;
-    for (size_t i = 0; i < len; i++) {
-        crc = g_crc32_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
-    }
-    return crc ^ 0xFFFFFFFFu;
-}
+namespace machina {
 
 static bool wal_framed_enabled() {
     static int cached = -1;
@@ -69,9 +45,12 @@ static int64_t epoch_ms() {
 Wal::Wal(std::filesystem::path path) : path_(std::move(path)) {}
 
 Wal::~Wal() {
+    disable_group_commit();
+    disable_maintenance();
 #if !defined(_WIN32)
     std::lock_guard<std::mutex> lk(mu_);
     if (fd_ >= 0) {
+        (void)flush_block_locked();
         ::close(fd_);
         fd_ = -1;
     }
@@ -103,6 +82,24 @@ std::string Wal::open(bool truncate_file) {
         if (ec) return std::string("create_directories: ") + ec.message();
     }
 
+    // Crash recovery for background rotation: a non-empty <base>.next means
+    // we swapped segments but never renamed. Complete the rotation now; an
+    // empty leftover spare is just removed.
+    auto next = spare_path();
+    if (std::filesystem::exists(next, ec)) {
+        auto sz = std::filesystem::file_size(next, ec);
+        if (!ec && sz > 0) {
+            if (std::filesystem::exists(path_, ec)) {
+                auto stem = path_.stem().string();
+                auto rotated = parent / (stem + "." + std::to_string(epoch_ms()) + ".jsonl");
+                std::filesystem::rename(path_, rotated, ec);
+            }
+            std::filesystem::rename(next, path_, ec);
+        } else {
+            std::filesystem::remove(next, ec);
+        }
+    }
+
     fd_ = ::open(path_.c_str(), O_CREAT | O_WRONLY | O_APPEND, 0644);
     if (fd_ < 0) {
         return std::string("open: ") + std::strerror(errno);
@@ -139,12 +136,33 @@ bool Wal::is_open() const {
 #endif
 }
 
-std::string Wal::append_json_line(const std::string& json) {
+std::string Wal::encode_record(const std::string& json) {
+    std::string line = json;
+    if (line.empty() || line.back() != '\n') line.push_back('\n');
+
+    if (!wal_framed_enabled()) {
+        // Legacy plain-text format (newline-delimited JSON)
+        return line;
+    }
+
+    // Framed format: [uint32_t len][line bytes][uint32_t crc32]
+    // Allows crash detection via length prefix + CRC integrity check.
+    uint32_t len = (uint32_t)line.size();
+    uint32_t crc = hash::crc32(line.data(), line.size());
+
+    std::string payload;
+    payload.reserve(sizeof(len) + line.size() + sizeof(crc));
+    payload.append((const char*)&len, sizeof(len));
+    payload.append(line);
+    payload.append((const char*)&crc, sizeof(crc));
+    return payload;
+}
+
+std::string Wal::write_encoded_locked(const std::string& payload) {
 #if defined(_WIN32)
-    (void)json;
+    (void)payload;
     return "WAL is not supported on Windows build in this snapshot";
 #else
-    std::lock_guard<std::mutex> lk(mu_);
     if (fd_ < 0) {
         std::error_code ec;
         auto parent = path_.parent_path();
@@ -155,58 +173,184 @@ std::string Wal::append_json_line(const std::string& json) {
         current_size_ = 0;
     }
 
-    // Check if rotation is needed before writing
-    if (needs_rotation_locked()) {
-        std::string err = rotate_locked();
-        if (!err.empty()) {
-            // Non-fatal: log rotation failed, continue writing to current segment
+    // Check if rotation is needed before writing. With compression on,
+    // only rotate on block boundaries so blocks never straddle segments.
+    if ((policy_.compress_block_bytes <= 0 || block_buf_.empty()) &&
+        needs_rotation_locked()) {
+        if (mt_enabled_) {
+            // Fast path: flip to the pre-opened spare segment and let the
+            // maintenance thread do the renames and retention sweep.
+            if (spare_fd_ >= 0 && !rotate_pending_) {
+                (void)flush_block_locked();  // block belongs to the old segment
+                old_fd_ = fd_;
+                fd_ = spare_fd_;
+                spare_fd_ = -1;
+                rotate_pending_ = true;
+                segment_open_time_ = epoch_sec();
+                current_size_ = 0;
+                mt_cv_.notify_one();
+            }
+            // No spare yet (thread busy): keep writing to the current
+            // segment rather than paying for a rename inline.
+        } else {
+            std::string err = rotate_locked();
+            if (!err.empty()) {
+                // Non-fatal: log rotation failed, continue writing to current segment
+            }
         }
     }
 
-    std::string line = json;
-    if (line.empty() || line.back() != '\n') line.push_back('\n');
-
-    auto write_all = [&](const void* data, size_t len) -> std::string {
-        const char* p = (const char*)data;
-        ssize_t remaining = (ssize_t)len;
-        ssize_t off = 0;
-        while (off < remaining) {
-            ssize_t w = ::write(fd_, p + off, (size_t)(remaining - off));
-            if (w < 0) {
-                if (errno == EINTR) continue;
-                return std::string("write: ") + std::strerror(errno);
-            }
-            off += w;
+    if (policy_.compress_block_bytes > 0) {
+        block_buf_ += payload;
+        if ((int64_t)block_buf_.size() >= policy_.compress_block_bytes) {
+            return flush_block_locked();
         }
         return "";
-    };
+    }
 
-    ssize_t bytes_written = 0;
+    return write_raw_locked(payload.data(), payload.size());
+#endif
+}
 
-    if (wal_framed_enabled()) {
-        // Framed format: [uint32_t len][line bytes][uint32_t crc32]
-        // Allows crash detection via length prefix + CRC integrity check.
-        uint32_t len = (uint32_t)line.size();
-        uint32_t crc = crc32_compute(line.data(), line.size());
+std::string Wal::write_raw_locked(const void* data, size_t len) {
+#if defined(_WIN32)
+    (void)data; (void)len;
+    return "WAL is not supported on Windows build in this snapshot";
+#else
+    const char* p = (const char*)data;
+    ssize_t remaining = (ssize_t)len;
+    ssize_t off = 0;
+    while (off < remaining) {
+        ssize_t w = ::write(fd_, p + off, (size_t)(remaining - off));
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return std::string("write: ") + std::strerror(errno);
+        }
+        off += w;
+    }
+    current_size_ += (int64_t)len;
+    return "";
+#endif
+}
 
-        std::string err = write_all(&len, sizeof(len));
-        if (!err.empty()) return err;
-        err = write_all(line.data(), line.size());
-        if (!err.empty()) return err;
-        err = write_all(&crc, sizeof(crc));
-        if (!err.empty()) return err;
+// Compressed block: [magic "MWBL"][uint32 raw_len][uint32 comp_len]
+//                   [uint32 crc32 of compressed bytes][compressed bytes]
+static constexpr char kWalBlockMagic[4] = {'M', 'W', 'B', 'L'};
 
-        bytes_written = (ssize_t)(sizeof(len) + line.size() + sizeof(crc));
-    } else {
-        // Legacy plain-text format (newline-delimited JSON)
-        std::string err = write_all(line.data(), line.size());
-        if (!err.empty()) return err;
-        bytes_written = (ssize_t)line.size();
+std::string Wal::flush_block_locked() {
+#if defined(_WIN32)
+    return "WAL is not supported on Windows build in this snapshot";
+#else
+    if (block_buf_.empty()) return "";
+    if (fd_ < 0) return "flush_block: segment not open";
+
+    uLongf comp_len = compressBound((uLong)block_buf_.size());
+    std::string comp(comp_len, '\0');
+    int rc = ::compress2((Bytef*)comp.data(), &comp_len,
+                         (const Bytef*)block_buf_.data(), (uLong)block_buf_.size(),
+                         Z_DEFAULT_COMPRESSION);
+    if (rc != Z_OK) {
+        return "compress2: zlib error " + std::to_string(rc);
+    }
+
+    uint32_t raw_len = (uint32_t)block_buf_.size();
+    uint32_t clen = (uint32_t)comp_len;
+    uint32_t crc = hash::crc32(comp.data(), comp_len);
+
+    std::string out;
+    out.reserve(sizeof(kWalBlockMagic) + 3 * sizeof(uint32_t) + comp_len);
+    out.append(kWalBlockMagic, sizeof(kWalBlockMagic));
+    out.append((const char*)&raw_len, sizeof(raw_len));
+    out.append((const char*)&clen, sizeof(clen));
+    out.append((const char*)&crc, sizeof(crc));
+    out.append(comp.data(), comp_len);
+
+    std::string err = write_raw_locked(out.data(), out.size());
+    if (!err.empty()) return err;
+
+    block_buf_.clear();
+    return "";
+#endif
+}
+
+std::string Wal::write_batch_durable_locked(const std::string& payload) {
+#if defined(_WIN32)
+    (void)payload;
+    return "WAL is not supported on Windows build in this snapshot";
+#else
+    if (payload.empty()) return "";
+    if (fd_ < 0) {
+        std::error_code ec;
+        auto parent = path_.parent_path();
+        if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+        fd_ = ::open(path_.c_str(), O_CREAT | O_WRONLY | O_APPEND, 0644);
+        if (fd_ < 0) return std::string("open: ") + std::strerror(errno);
+        segment_open_time_ = epoch_sec();
+        current_size_ = 0;
+    }
+    // Rotation checked once per batch (batches are gc_max_batch_ records at
+    // most, so a segment overshoots a limit by one batch at worst).
+    if (needs_rotation_locked()) {
+        if (mt_enabled_) {
+            if (spare_fd_ >= 0 && !rotate_pending_) {
+                old_fd_ = fd_;
+                fd_ = spare_fd_;
+                spare_fd_ = -1;
+                rotate_pending_ = true;
+                segment_open_time_ = epoch_sec();
+                current_size_ = 0;
+                mt_cv_.notify_one();
+            }
+        } else {
+            (void)rotate_locked();
+        }
+    }
+
+    std::string uerr;
+    if (uring_enabled() &&
+        uring_write_fsync(fd_, payload.data(), payload.size(), &uerr)) {
+        current_size_ += (int64_t)payload.size();
+        return "";
+    }
+    // Blocking path (also the landing spot when the uring submission wrote
+    // nothing): one gathered write, one fsync.
+    std::string err = write_raw_locked(payload.data(), payload.size());
+    if (!err.empty()) return err;
+    if (::fsync(fd_) != 0) {
+        return std::string("fsync: ") + std::strerror(errno);
+    }
+    return "";
+#endif
+}
+
+std::string Wal::append_json_line(const std::string& json) {
+    MACHINA_TRACE_SPAN("wal_append");
+#if defined(_WIN32)
+    (void)json;
+    return "WAL is not supported on Windows build in this snapshot";
+#else
+    {
+        std::lock_guard<std::mutex> glk(gc_mu_);
+        if (gc_enabled_) {
+            // Buffer only; the commit thread takes care of durability.
+            gc_pending_.push_back(encode_record(json));
+            gc_seq_head_++;
+            // Wake on the first record (starts the delay clock) and on a full batch.
+            if ((int)gc_pending_.size() == 1 || (int)gc_pending_.size() >= gc_max_batch_)
+                gc_cv_.notify_one();
+            tail_ring_push(json);
+            return "";
+        }
     }
 
-    current_size_ += bytes_written;
+    std::lock_guard<std::mutex> lk(mu_);
+    std::string err = write_encoded_locked(encode_record(json));
+    if (!err.empty()) return err;
+    tail_ring_push(json);
 
     if (fsync_) {
+        err = flush_block_locked();
+        if (!err.empty()) return err;
         if (::fsync(fd_) != 0) {
             return std::string("fsync: ") + std::strerror(errno);
         }
@@ -216,6 +360,276 @@ std::string Wal::append_json_line(const std::string& json) {
 #endif
 }
 
+std::string Wal::append_json_line_sync(const std::string& json) {
+#if defined(_WIN32)
+    (void)json;
+    return "WAL is not supported on Windows build in this snapshot";
+#else
+    uint64_t seq = 0;
+    {
+        std::lock_guard<std::mutex> glk(gc_mu_);
+        if (gc_enabled_) {
+            gc_pending_.push_back(encode_record(json));
+            seq = ++gc_seq_head_;
+            if ((int)gc_pending_.size() == 1 || (int)gc_pending_.size() >= gc_max_batch_)
+                gc_cv_.notify_one();
+            tail_ring_push(json);
+        }
+    }
+    if (seq == 0) {
+        // Group commit off: plain append (durability governed by set_fsync).
+        return append_json_line(json);
+    }
+
+    std::unique_lock<std::mutex> glk(gc_mu_);
+    gc_done_cv_.wait(glk, [&] { return gc_seq_durable_ >= seq || !gc_enabled_; });
+    return gc_last_error_;
+#endif
+}
+
+void Wal::set_tail_ring(size_t capacity) {
+    std::lock_guard<std::mutex> lk(ring_mu_);
+    ring_cap_ = capacity;
+    ring_.clear();
+    ring_.reserve(capacity);
+    ring_next_seq_ = 0;
+}
+
+void Wal::tail_ring_push(const std::string& json) {
+    std::lock_guard<std::mutex> lk(ring_mu_);
+    if (ring_cap_ == 0) return;
+    if (ring_.size() < ring_cap_) {
+        ring_.push_back(json);
+    } else {
+        ring_[(size_t)(ring_next_seq_ % ring_cap_)] = json;
+    }
+    ring_next_seq_++;
+}
+
+std::vector<std::string> Wal::tail(size_t n) const {
+    std::lock_guard<std::mutex> lk(ring_mu_);
+    std::vector<std::string> out;
+    if (ring_cap_ == 0 || ring_next_seq_ == 0) return out;
+    uint64_t retained = ring_next_seq_ < ring_cap_ ? ring_next_seq_ : ring_cap_;
+    uint64_t count = n < retained ? n : retained;
+    for (uint64_t seq = ring_next_seq_ - count; seq < ring_next_seq_; seq++) {
+        out.push_back(ring_[(size_t)(seq % ring_cap_)]);
+    }
+    return out;
+}
+
+std::vector<std::string> Wal::tail_since(uint64_t* cursor, size_t max_records) const {
+    std::lock_guard<std::mutex> lk(ring_mu_);
+    std::vector<std::string> out;
+    if (ring_cap_ == 0 || cursor == nullptr) return out;
+    uint64_t oldest = ring_next_seq_ > ring_cap_ ? ring_next_seq_ - ring_cap_ : 0;
+    uint64_t seq = *cursor > oldest ? *cursor : oldest;
+    for (; seq < ring_next_seq_; seq++) {
+        if (max_records > 0 && out.size() >= max_records) break;
+        out.push_back(ring_[(size_t)(seq % ring_cap_)]);
+    }
+    *cursor = seq;
+    return out;
+}
+
+uint64_t Wal::tail_seq() const {
+    std::lock_guard<std::mutex> lk(ring_mu_);
+    return ring_next_seq_;
+}
+
+std::filesystem::path Wal::spare_path() const {
+    return std::filesystem::path(path_.string() + ".next");
+}
+
+void Wal::complete_rotation() {
+#if !defined(_WIN32)
+    int ofd = -1;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (!rotate_pending_) return;
+        ofd = old_fd_;
+        old_fd_ = -1;
+    }
+
+    // Durably close the rotated-out segment, then swap names: the live fd
+    // keeps following its inode, so appends never stall on these renames.
+    if (ofd >= 0) {
+        ::fsync(ofd);
+        ::close(ofd);
+    }
+
+    auto parent = path_.parent_path();
+    if (parent.empty()) parent = ".";
+    auto stem = path_.stem().string();
+    auto rotated = parent / (stem + "." + std::to_string(epoch_ms()) + ".jsonl");
+
+    std::error_code ec;
+    std::filesystem::rename(path_, rotated, ec);
+    std::filesystem::rename(spare_path(), path_, ec);
+
+    int dir_fd = ::open(parent.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir_fd >= 0) { ::fsync(dir_fd); ::close(dir_fd); }
+
+    std::lock_guard<std::mutex> lk(mu_);
+    rotate_pending_ = false;
+#endif
+}
+
+void Wal::maintenance_loop() {
+#if !defined(_WIN32)
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(mt_mu_);
+            mt_cv_.wait_for(lk, std::chrono::milliseconds(mt_interval_ms_));
+            if (mt_stop_) break;
+        }
+
+        complete_rotation();
+
+        // Keep a fresh spare segment pre-opened for the next fast swap.
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            if (spare_fd_ < 0 && !rotate_pending_) {
+                spare_fd_ = ::open(spare_path().c_str(),
+                                   O_CREAT | O_WRONLY | O_APPEND | O_TRUNC, 0644);
+            }
+        }
+
+        enforce_retention();
+    }
+
+    // Drain on shutdown so no segment is left under the .next name.
+    complete_rotation();
+#endif
+}
+
+void Wal::enable_maintenance(int interval_ms) {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (mt_enabled_) return;
+        mt_enabled_ = true;
+#if !defined(_WIN32)
+        if (spare_fd_ < 0) {
+            spare_fd_ = ::open(spare_path().c_str(),
+                               O_CREAT | O_WRONLY | O_APPEND | O_TRUNC, 0644);
+        }
+#endif
+    }
+    {
+        std::lock_guard<std::mutex> lk(mt_mu_);
+        mt_stop_ = false;
+        mt_interval_ms_ = interval_ms > 0 ? interval_ms : 1;
+    }
+    mt_thread_ = std::thread([this] { maintenance_loop(); });
+}
+
+void Wal::disable_maintenance() {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (!mt_enabled_) return;
+        mt_enabled_ = false;
+    }
+    {
+        std::lock_guard<std::mutex> lk(mt_mu_);
+        mt_stop_ = true;
+        mt_cv_.notify_one();
+    }
+    if (mt_thread_.joinable()) mt_thread_.join();
+
+#if !defined(_WIN32)
+    std::lock_guard<std::mutex> lk(mu_);
+    if (spare_fd_ >= 0) {
+        ::close(spare_fd_);
+        spare_fd_ = -1;
+        std::error_code ec;
+        std::filesystem::remove(spare_path(), ec);
+    }
+#endif
+}
+
+void Wal::enable_group_commit(int max_batch_records, int max_delay_ms) {
+    std::lock_guard<std::mutex> glk(gc_mu_);
+    if (gc_enabled_) return;
+    gc_max_batch_ = max_batch_records > 0 ? max_batch_records : 1;
+    gc_max_delay_ms_ = max_delay_ms > 0 ? max_delay_ms : 1;
+    gc_enabled_ = true;
+    gc_stop_ = false;
+    gc_thread_ = std::thread([this] { group_commit_loop(); });
+}
+
+void Wal::disable_group_commit() {
+    {
+        std::lock_guard<std::mutex> glk(gc_mu_);
+        if (!gc_enabled_) return;
+        gc_stop_ = true;
+        gc_cv_.notify_one();
+    }
+    if (gc_thread_.joinable()) gc_thread_.join();
+    std::lock_guard<std::mutex> glk(gc_mu_);
+    gc_enabled_ = false;
+    gc_done_cv_.notify_all();
+}
+
+void Wal::group_commit_loop() {
+    for (;;) {
+        std::vector<std::string> batch;
+        uint64_t batch_head = 0;
+        {
+            std::unique_lock<std::mutex> glk(gc_mu_);
+            gc_cv_.wait(glk, [&] { return gc_stop_ || !gc_pending_.empty(); });
+            if (gc_pending_.empty()) {
+                if (gc_stop_) return;
+                continue;
+            }
+            // Give the batch a chance to fill before paying for the fsync.
+            if ((int)gc_pending_.size() < gc_max_batch_ && !gc_stop_) {
+                gc_cv_.wait_for(glk, std::chrono::milliseconds(gc_max_delay_ms_),
+                                [&] { return gc_stop_ ||
+                                             (int)gc_pending_.size() >= gc_max_batch_; });
+            }
+            batch.swap(gc_pending_);
+            batch_head = gc_seq_head_;
+        }
+
+        std::string err;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            if (fsync_ && policy_.compress_block_bytes <= 0) {
+                // Durable batch: concatenate once and land the whole thing
+                // with a single linked write+fsync (io_uring backend) or one
+                // write + one fsync, instead of a write syscall per record.
+                size_t total = 0;
+                for (const auto& payload : batch) total += payload.size();
+                std::string joined;
+                joined.reserve(total);
+                for (const auto& payload : batch) joined += payload;
+                err = write_batch_durable_locked(joined);
+            } else {
+                for (const auto& payload : batch) {
+                    err = write_encoded_locked(payload);
+                    if (!err.empty()) break;
+                }
+#if !defined(_WIN32)
+                if (err.empty() && fsync_ && fd_ >= 0) {
+                    err = flush_block_locked();
+                    if (err.empty() && ::fsync(fd_) != 0) {
+                        err = std::string("fsync: ") + std::strerror(errno);
+                    }
+                }
+#endif
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> glk(gc_mu_);
+            gc_seq_durable_ = batch_head;
+            gc_last_error_ = err;
+            gc_done_cv_.notify_all();
+            if (gc_stop_ && gc_pending_.empty()) return;
+        }
+    }
+}
+
 std::string Wal::truncate() {
 #if defined(_WIN32)
     return "WAL is not supported on Windows build in this snapshot";
@@ -230,6 +644,7 @@ std::string Wal::truncate() {
     }
     if (::ftruncate(fd_, 0) != 0) return std::string("ftruncate: ") + std::strerror(errno);
     current_size_ = 0;
+    block_buf_.clear();
     return "";
 #endif
 }
@@ -271,6 +686,9 @@ std::string Wal::rotate_locked() {
 #else
     if (fd_ < 0) return "";
 
+    // Pending compressed block belongs to the segment being rotated out
+    (void)flush_block_locked();
+
     // Close current segment
     ::close(fd_);
     fd_ = -1;
@@ -339,7 +757,16 @@ std::vector<std::filesystem::path> Wal::list_segments() const {
 }
 
 int Wal::enforce_retention() {
-    std::lock_guard<std::mutex> lk(mu_);
+    // Snapshot the mutable bits under the lock, then scan and delete
+    // without it: retention only ever touches rotated (immutable) files,
+    // so appenders must not queue behind the directory walk.
+    WalPolicy policy;
+    int64_t active_size = 0;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        policy = policy_;
+        active_size = current_size_;
+    }
     int deleted = 0;
 
     auto parent = path_.parent_path();
@@ -371,22 +798,24 @@ int Wal::enforce_retention() {
               [](const SegInfo& a, const SegInfo& b) { return a.path < b.path; });
 
     // Enforce max_segments (count includes active segment)
-    while (policy_.max_segments > 0 &&
-           (int)(rotated.size() + 1) > policy_.max_segments &&
+    while (policy.max_segments > 0 &&
+           (int)(rotated.size() + 1) > policy.max_segments &&
            !rotated.empty()) {
         std::filesystem::remove(rotated.front().path, ec);
+        std::filesystem::remove(rotated.front().path.string() + ".idx", ec);
         rotated.erase(rotated.begin());
         deleted++;
     }
 
     // Enforce max_total_bytes
-    if (policy_.max_total_bytes > 0) {
-        int64_t total = current_size_;
+    if (policy.max_total_bytes > 0) {
+        int64_t total = active_size;
         for (const auto& s : rotated) total += s.size;
 
-        while (total > policy_.max_total_bytes && !rotated.empty()) {
+        while (total > policy.max_total_bytes && !rotated.empty()) {
             total -= rotated.front().size;
             std::filesystem::remove(rotated.front().path, ec);
+            std::filesystem::remove(rotated.front().path.string() + ".idx", ec);
             rotated.erase(rotated.begin());
             deleted++;
         }
@@ -0,0 +1,291 @@
+#include "machina/wal_reader.h"
+
+#include "machina/hash.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <zlib.h>
+
+namespace machina {
+
+// Mirrors the writer-side switch in wal.cpp.
+static bool reader_framed_enabled() {
+    static int cached = -1;
+    if (cached < 0) {
+        const char* e = std::getenv("MACHINA_WAL_FRAMED");
+        cached = (e && std::string(e) == "1") ? 1 : 0;
+    }
+    return cached == 1;
+}
+
+// Persisted index layout (little-endian, host order — index files are
+// local artifacts, never shipped across machines):
+//   [magic "MWIX"][uint32 version][uint64 segment_size][uint64 record_count]
+//   [uint64 stride][uint64 offsets[]...]
+static constexpr char kIndexMagic[4] = {'M', 'W', 'I', 'X'};
+static constexpr uint32_t kIndexVersion = 1;
+
+WalReader::WalReader(std::filesystem::path segment) : path_(std::move(segment)) {}
+
+WalReader::~WalReader() {
+    close();
+}
+
+std::filesystem::path WalReader::index_path() const {
+    return std::filesystem::path(path_.string() + ".idx");
+}
+
+std::string WalReader::open(bool persist_index) {
+#if defined(_WIN32)
+    (void)persist_index;
+    return "WalReader is not supported on Windows build in this snapshot";
+#else
+    if (open_) return "";
+
+    int fd = ::open(path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return std::string("open: ") + std::strerror(errno);
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        std::string err = std::string("fstat: ") + std::strerror(errno);
+        ::close(fd);
+        return err;
+    }
+
+    framed_ = reader_framed_enabled();
+    map_size_ = (size_t)st.st_size;
+
+    if (map_size_ == 0) {
+        // Empty segment: nothing to map, zero records.
+        ::close(fd);
+        record_count_ = 0;
+        sparse_offsets_.clear();
+        open_ = true;
+        return "";
+    }
+
+    void* m = ::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) {
+        map_size_ = 0;
+        return std::string("mmap: ") + std::strerror(errno);
+    }
+    map_ = (const char*)m;
+    open_ = true;
+
+    decompress_blocks();
+
+    if (!load_index()) {
+        std::string err = build_index();
+        if (!err.empty()) {
+            close();
+            return err;
+        }
+        if (persist_index) save_index();  // best effort
+    }
+
+    return "";
+#endif
+}
+
+bool WalReader::is_open() const {
+    return open_;
+}
+
+// Writer-side block header: [magic "MWBL"][uint32 raw_len][uint32 comp_len]
+//                            [uint32 crc32 of compressed bytes][bytes]
+static constexpr char kWalBlockMagic[4] = {'M', 'W', 'B', 'L'};
+
+void WalReader::decompress_blocks() {
+    compressed_ = false;
+    decompressed_.clear();
+    constexpr size_t kHdr = sizeof(kWalBlockMagic) + 3 * sizeof(uint32_t);
+    if (map_size_ < kHdr || std::memcmp(map_, kWalBlockMagic, 4) != 0) return;
+
+    compressed_ = true;
+    size_t off = 0;
+    while (off + kHdr <= map_size_) {
+        if (std::memcmp(map_ + off, kWalBlockMagic, 4) != 0) break;
+        uint32_t raw_len = 0, comp_len = 0, crc = 0;
+        std::memcpy(&raw_len, map_ + off + 4, sizeof(raw_len));
+        std::memcpy(&comp_len, map_ + off + 8, sizeof(comp_len));
+        std::memcpy(&crc, map_ + off + 12, sizeof(crc));
+        if (off + kHdr + comp_len > map_size_) break;  // torn tail block
+        const char* comp = map_ + off + kHdr;
+        if (hash::crc32(comp, comp_len) != crc) break;  // corrupt block
+
+        size_t old = decompressed_.size();
+        decompressed_.resize(old + raw_len);
+        uLongf dlen = raw_len;
+        int rc = ::uncompress((Bytef*)(decompressed_.data() + old), &dlen,
+                              (const Bytef*)comp, comp_len);
+        if (rc != Z_OK || dlen != raw_len) {
+            decompressed_.resize(old);
+            break;
+        }
+        off += kHdr + comp_len;
+    }
+}
+
+const char* WalReader::data() const {
+    return compressed_ ? decompressed_.data() : map_;
+}
+
+size_t WalReader::data_size() const {
+    return compressed_ ? decompressed_.size() : map_size_;
+}
+
+void WalReader::close() {
+#if !defined(_WIN32)
+    if (map_ && map_size_ > 0) {
+        ::munmap((void*)map_, map_size_);
+    }
+#endif
+    map_ = nullptr;
+    map_size_ = 0;
+    record_count_ = 0;
+    sparse_offsets_.clear();
+    compressed_ = false;
+    decompressed_.clear();
+    open_ = false;
+}
+
+size_t WalReader::record_count() const {
+    return record_count_;
+}
+
+bool WalReader::next_record(size_t& off, std::string_view& out) const {
+    const char* base = data();
+    const size_t size = data_size();
+    if (off >= size) return false;
+
+    if (framed_) {
+        // [uint32 len][line bytes][uint32 crc32]
+        if (size - off < sizeof(uint32_t)) return false;
+        uint32_t len = 0;
+        std::memcpy(&len, base + off, sizeof(len));
+        size_t total = sizeof(uint32_t) + (size_t)len + sizeof(uint32_t);
+        if (len == 0 || size - off < total) return false;  // torn tail
+        const char* rec = base + off + sizeof(uint32_t);
+        size_t rec_len = len;
+        if (rec_len > 0 && rec[rec_len - 1] == '\n') rec_len--;
+        out = std::string_view(rec, rec_len);
+        off += total;
+        return true;
+    }
+
+    // Plain JSONL: records are newline-delimited.
+    const char* start = base + off;
+    const char* nl = (const char*)std::memchr(start, '\n', size - off);
+    if (!nl) return false;  // incomplete trailing line
+    out = std::string_view(start, (size_t)(nl - start));
+    off = (size_t)(nl - base) + 1;
+    return true;
+}
+
+std::string WalReader::build_index() {
+    sparse_offsets_.clear();
+    record_count_ = 0;
+
+    size_t off = 0;
+    std::string_view rec;
+    while (true) {
+        size_t rec_off = off;
+        if (!next_record(off, rec)) break;
+        if (record_count_ % kIndexStride == 0) {
+            sparse_offsets_.push_back((uint64_t)rec_off);
+        }
+        record_count_++;
+    }
+    return "";
+}
+
+bool WalReader::load_index() {
+    std::ifstream in(index_path(), std::ios::binary);
+    if (!in) return false;
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t seg_size = 0, count = 0, stride = 0;
+    in.read(magic, 4);
+    in.read((char*)&version, sizeof(version));
+    in.read((char*)&seg_size, sizeof(seg_size));
+    in.read((char*)&count, sizeof(count));
+    in.read((char*)&stride, sizeof(stride));
+    if (!in || std::memcmp(magic, kIndexMagic, 4) != 0 || version != kIndexVersion) {
+        return false;
+    }
+    // Stale index: segment was appended to, rotated in place, or truncated.
+    if (seg_size != (uint64_t)map_size_ || stride != (uint64_t)kIndexStride) {
+        return false;
+    }
+
+    size_t n_offsets = count == 0 ? 0 : (size_t)((count - 1) / kIndexStride + 1);
+    std::vector<uint64_t> offsets(n_offsets);
+    if (n_offsets > 0) {
+        in.read((char*)offsets.data(), (std::streamsize)(n_offsets * sizeof(uint64_t)));
+        if (!in) return false;
+    }
+
+    record_count_ = (size_t)count;
+    sparse_offsets_ = std::move(offsets);
+    return true;
+}
+
+void WalReader::save_index() const {
+    std::ofstream out(index_path(), std::ios::binary | std::ios::trunc);
+    if (!out) return;
+
+    uint64_t seg_size = (uint64_t)map_size_;
+    uint64_t count = (uint64_t)record_count_;
+    uint64_t stride = (uint64_t)kIndexStride;
+    out.write(kIndexMagic, 4);
+    out.write((const char*)&kIndexVersion, sizeof(kIndexVersion));
+    out.write((const char*)&seg_size, sizeof(seg_size));
+    out.write((const char*)&count, sizeof(count));
+    out.write((const char*)&stride, sizeof(stride));
+    if (!sparse_offsets_.empty()) {
+        out.write((const char*)sparse_offsets_.data(),
+                  (std::streamsize)(sparse_offsets_.size() * sizeof(uint64_t)));
+    }
+}
+
+int64_t WalReader::offset_of(size_t ordinal) const {
+    if (ordinal >= record_count_) return -1;
+
+    size_t bucket = ordinal / kIndexStride;
+    if (bucket >= sparse_offsets_.size()) return -1;
+
+    size_t off = (size_t)sparse_offsets_[bucket];
+    std::string_view rec;
+    for (size_t i = bucket * kIndexStride; i < ordinal; i++) {
+        size_t scan = off;
+        if (!next_record(scan, rec)) return -1;
+        off = scan;
+    }
+    return (int64_t)off;
+}
+
+std::string_view WalReader::record(size_t ordinal) const {
+    int64_t off64 = offset_of(ordinal);
+    if (off64 < 0) return {};
+
+    size_t off = (size_t)off64;
+    std::string_view rec;
+    if (!next_record(off, rec)) return {};
+    return rec;
+}
+
+} // namespace machina
@@ -0,0 +1,121 @@
+#include "machina/wal_sharded.h"
+
+#include "machina/wal_reader.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <queue>
+
+namespace machina {
+
+ShardedWal::ShardedWal(std::filesystem::path base, int shards) : base_(std::move(base)) {
+    if (shards < 1) shards = 1;
+    auto parent = base_.parent_path();
+    auto stem = base_.stem().string();
+    for (int k = 0; k < shards; k++) {
+        auto p = parent / (stem + ".shard" + std::to_string(k) + ".jsonl");
+        shards_.push_back(std::make_unique<Wal>(p));
+    }
+}
+
+void ShardedWal::set_fsync(bool enable) {
+    for (auto& s : shards_) s->set_fsync(enable);
+}
+
+void ShardedWal::set_policy(const WalPolicy& policy) {
+    for (auto& s : shards_) s->set_policy(policy);
+}
+
+std::string ShardedWal::open(bool truncate) {
+    for (auto& s : shards_) {
+        std::string err = s->open(truncate);
+        if (!err.empty()) return err;
+    }
+    return "";
+}
+
+int ShardedWal::shard_count() const {
+    return (int)shards_.size();
+}
+
+Wal& ShardedWal::shard_for_this_thread() {
+    // Each thread gets a shard assigned round-robin on first append and
+    // sticks with it, so a thread's records stay ordered within one shard.
+    thread_local int tl_shard = -1;
+    if (tl_shard < 0) {
+        tl_shard = (int)(next_shard_.fetch_add(1) % (uint32_t)shards_.size());
+    }
+    return *shards_[(size_t)tl_shard % shards_.size()];
+}
+
+std::string ShardedWal::append_json_line(const std::string& json) {
+    uint64_t seq = seq_.fetch_add(1);
+
+    std::string stamped;
+    if (!json.empty() && json.front() == '{') {
+        // Inject the stamp as the first key of the object.
+        stamped.reserve(json.size() + 24);
+        stamped = "{\"_wseq\":" + std::to_string(seq);
+        if (json.size() > 2) stamped += ",";  // non-empty object
+        stamped.append(json, 1, json.size() - 1);
+    } else {
+        stamped = "{\"_wseq\":" + std::to_string(seq) + ",\"rec\":" + json + "}";
+    }
+
+    return shard_for_this_thread().append_json_line(stamped);
+}
+
+std::vector<std::filesystem::path> ShardedWal::list_segments() const {
+    std::vector<std::filesystem::path> out;
+    for (const auto& s : shards_) {
+        auto segs = s->list_segments();
+        out.insert(out.end(), segs.begin(), segs.end());
+    }
+    return out;
+}
+
+std::string ShardedWal::for_each_ordered(
+    const std::function<void(uint64_t seq, std::string_view record)>& fn) const {
+    // Per-shard record streams. Within one shard "_wseq" is ascending
+    // (threads stick to their shard), so a k-way heap merge restores
+    // total order without sorting everything.
+    struct Stream {
+        std::vector<std::pair<uint64_t, std::string>> records;
+        size_t pos{0};
+    };
+    std::vector<Stream> streams(shards_.size());
+
+    for (size_t k = 0; k < shards_.size(); k++) {
+        for (const auto& seg : shards_[k]->list_segments()) {
+            WalReader reader(seg);
+            std::string err = reader.open();
+            if (!err.empty()) return "shard " + std::to_string(k) + ": " + err;
+            for (size_t i = 0; i < reader.record_count(); i++) {
+                std::string_view rec = reader.record(i);
+                uint64_t seq = 0;
+                auto p = rec.find("\"_wseq\":");
+                if (p != std::string_view::npos) {
+                    seq = (uint64_t)std::strtoull(rec.data() + p + 8, nullptr, 10);
+                }
+                streams[k].records.emplace_back(seq, std::string(rec));
+            }
+        }
+    }
+
+    using HeapItem = std::pair<uint64_t, size_t>;  // (seq, stream index)
+    std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<HeapItem>> heap;
+    for (size_t k = 0; k < streams.size(); k++) {
+        if (!streams[k].records.empty()) heap.push({streams[k].records[0].first, k});
+    }
+    while (!heap.empty()) {
+        auto [seq, k] = heap.top();
+        heap.pop();
+        auto& st = streams[k];
+        fn(seq, st.records[st.pos].second);
+        st.pos++;
+        if (st.pos < st.records.size()) heap.push({st.records[st.pos].first, k});
+    }
+    return "";
+}
+
+} // namespace machina
@@ -0,0 +1,437 @@
+#include "machina/zygote.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+#ifndef _WIN32
+  #include <unistd.h>
+  #include <fcntl.h>
+  #include <signal.h>
+  #include <poll.h>
+  #include <sys/stat.h>
+  #include <sys/wait.h>
+  #ifdef __linux__
+    #include <sched.h>
+    #include <sys/prctl.h>
+    #include <sys/socket.h>
+    #include <sys/syscall.h>
+    extern char** environ;
+  #endif
+#endif
+
+namespace machina {
+
+#ifdef __linux__
+
+namespace {
+
+// The master is forked from a potentially multi-threaded caller, so the
+// master and its workers must never allocate: another thread may have held
+// the heap lock at fork time. Everything below the fork runs on fixed
+// buffers and raw syscalls; the caller side is free to allocate.
+
+constexpr int kMaxPool = 16;
+constexpr size_t kMaxArgs = 64;
+constexpr size_t kMaxFrame = 60000;
+
+// ---- frame encoding (caller -> worker) ----
+// u32 nargs, then per string: u32 len + bytes + '\0'. Strings: argv...,
+// resolved exe path, cwd ("" = none). Then u8 has_stdin and ProcLimits raw
+// (same binary on both ends — the worker is a fork of the sender's fork).
+
+void put_u32(std::vector<char>& b, uint32_t v) {
+    const char* p = reinterpret_cast<const char*>(&v);
+    b.insert(b.end(), p, p + 4);
+}
+
+void put_str(std::vector<char>& b, const std::string& s) {
+    put_u32(b, (uint32_t)s.size());
+    b.insert(b.end(), s.begin(), s.end());
+    b.push_back('\0');
+}
+
+bool get_u32(const char*& p, const char* end, uint32_t* v) {
+    if (end - p < 4) return false;
+    std::memcpy(v, p, 4);
+    p += 4;
+    return true;
+}
+
+const char* get_str(const char*& p, const char* end) {
+    uint32_t len = 0;
+    if (!get_u32(p, end, &len)) return nullptr;
+    if ((size_t)(end - p) < (size_t)len + 1) return nullptr;
+    const char* s = p;
+    if (s[len] != '\0') return nullptr;
+    p += (size_t)len + 1;
+    return s;
+}
+
+// ---- worker ----
+
+[[noreturn]] void worker_main(int sock) {
+    static char buf[kMaxFrame];
+    char cbuf[CMSG_SPACE(2 * sizeof(int))];
+
+    struct iovec iov;
+    iov.iov_base = buf;
+    iov.iov_len = sizeof(buf);
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+
+    ssize_t n = recvmsg(sock, &msg, 0);
+    if (n <= 0) _exit(125); // master/caller gone
+
+    int fds[2] = {-1, -1};
+    int nfds = 0;
+    for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS) {
+            size_t cnt = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (size_t i = 0; i < cnt && nfds < 2; i++) {
+                std::memcpy(&fds[nfds++], (char*)CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+            }
+        }
+    }
+
+    const char* p = buf;
+    const char* end = buf + n;
+    uint32_t nargs = 0;
+    if (!get_u32(p, end, &nargs) || nargs == 0 || nargs > kMaxArgs) _exit(125);
+    static char* argvp[kMaxArgs + 1];
+    for (uint32_t i = 0; i < nargs; i++) {
+        const char* s = get_str(p, end);
+        if (!s) _exit(125);
+        argvp[i] = const_cast<char*>(s);
+    }
+    argvp[nargs] = nullptr;
+    const char* path = get_str(p, end);
+    const char* cwd = get_str(p, end);
+    if (!path || !cwd) _exit(125);
+    if (end - p < 1) _exit(125);
+    bool has_stdin = (*p++ != 0);
+    ProcLimits lim;
+    if ((size_t)(end - p) < sizeof(ProcLimits)) _exit(125);
+    std::memcpy(&lim, p, sizeof(ProcLimits));
+
+    int in_fd = has_stdin ? fds[0] : -1;
+    int out_fd = has_stdin ? fds[1] : fds[0];
+    if (out_fd < 0 || (has_stdin && in_fd < 0)) _exit(125);
+
+    if (in_fd >= 0) (void)dup2(in_fd, STDIN_FILENO);
+    (void)dup2(out_fd, STDOUT_FILENO);
+    (void)dup2(out_fd, STDERR_FILENO);
+
+    (void)setpgid(0, 0);
+    (void)umask(077);
+
+#ifdef SYS_close_range
+    if (syscall(SYS_close_range, 3, ~0u, 0) != 0)
+#endif
+    {
+        long maxfd = sysconf(_SC_OPEN_MAX);
+        if (maxfd < 256) maxfd = 256;
+        for (int fd = 3; fd < maxfd; fd++) (void)close(fd);
+    }
+
+    if (*cwd) (void)chdir(cwd);
+
+    if (lim.no_new_privs) {
+        (void)prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+    }
+    // parent is the caller (CLONE_PARENT) — die with it
+    (void)prctl(PR_SET_PDEATHSIG, SIGKILL);
+
+    proc_apply_rlimits(lim);
+
+    execve(path, argvp, environ);
+    _exit(127);
+}
+
+// fork-like clone making the new process a sibling of the master, i.e. a
+// direct child of the caller — waitpid/kill work there unchanged.
+pid_t clone_parent_fork() {
+    return (pid_t)syscall(SYS_clone, CLONE_PARENT | SIGCHLD, 0, 0, 0, 0);
+}
+
+// ---- master ----
+
+struct MasterPool {
+    int sock[kMaxPool];
+    pid_t pid[kMaxPool];
+    int count{0};
+};
+
+bool master_prefork(MasterPool& pool, int ctrl) {
+    if (pool.count >= kMaxPool) return true;
+    int sp[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sp) != 0) return false;
+    pid_t pid = clone_parent_fork();
+    if (pid < 0) {
+        close(sp[0]); close(sp[1]);
+        return false;
+    }
+    if (pid == 0) {
+        // worker: drop every master fd except its own socket
+        close(sp[0]);
+        close(ctrl);
+        for (int i = 0; i < pool.count; i++) close(pool.sock[i]);
+        worker_main(sp[1]);
+    }
+    close(sp[1]);
+    pool.sock[pool.count] = sp[0];
+    pool.pid[pool.count] = pid;
+    pool.count++;
+    return true;
+}
+
+[[noreturn]] void master_main(int ctrl, int pool_n) {
+    (void)signal(SIGPIPE, SIG_IGN);
+    (void)prctl(PR_SET_PDEATHSIG, SIGKILL);
+    unsetenv("LD_PRELOAD");
+    unsetenv("LD_LIBRARY_PATH");
+
+    // detach stdio; keep only the control socket
+    int devnull = open("/dev/null", O_RDWR);
+    if (devnull >= 0) {
+        (void)dup2(devnull, STDIN_FILENO);
+        (void)dup2(devnull, STDOUT_FILENO);
+        (void)dup2(devnull, STDERR_FILENO);
+    }
+    long maxfd = sysconf(_SC_OPEN_MAX);
+    if (maxfd < 256) maxfd = 256;
+    for (int fd = 3; fd < maxfd; fd++) {
+        if (fd != ctrl) (void)close(fd);
+    }
+
+    if (pool_n < 1) pool_n = 1;
+    if (pool_n > kMaxPool) pool_n = kMaxPool;
+    MasterPool pool;
+
+    while (true) {
+        while (pool.count < pool_n) {
+            if (!master_prefork(pool, ctrl)) break;
+        }
+
+        char req = 0;
+        ssize_t n = read(ctrl, &req, 1);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) _exit(0); // caller closed the pool
+
+        if (pool.count == 0 && !master_prefork(pool, ctrl)) {
+            pid_t bad = -1;
+            (void)write(ctrl, &bad, sizeof(bad));
+            continue;
+        }
+        pool.count--;
+        int wsock = pool.sock[pool.count];
+        pid_t wpid = pool.pid[pool.count];
+
+        char cbuf[CMSG_SPACE(sizeof(int))];
+        struct iovec iov;
+        iov.iov_base = &wpid;
+        iov.iov_len = sizeof(wpid);
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = cbuf;
+        msg.msg_controllen = sizeof(cbuf);
+        struct cmsghdr* c = CMSG_FIRSTHDR(&msg);
+        c->cmsg_level = SOL_SOCKET;
+        c->cmsg_type = SCM_RIGHTS;
+        c->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(c), &wsock, sizeof(int));
+        msg.msg_controllen = c->cmsg_len;
+
+        if (sendmsg(ctrl, &msg, 0) < 0) {
+            (void)kill(wpid, SIGKILL);
+        }
+        close(wsock);
+    }
+}
+
+// ---- caller side ----
+
+struct ZygoteClient {
+    std::mutex mu;
+    int ctrl{-1};
+    bool failed{false};
+};
+
+ZygoteClient& client() {
+    static ZygoteClient z;
+    return z;
+}
+
+bool env_true(const char* key) {
+    const char* v = std::getenv(key);
+    if (!v) return false;
+    std::string s = v;
+    for (auto& c : s) c = (char)std::tolower((unsigned char)c);
+    return (s == "1" || s == "true" || s == "yes" || s == "on");
+}
+
+bool start_master(ZygoteClient& z) {
+    int pool_n = 4;
+    if (const char* e = std::getenv("MACHINA_ZYGOTE_POOL")) {
+        pool_n = std::atoi(e);
+    }
+    int sp[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sp) != 0) return false;
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(sp[0]); close(sp[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(sp[0]);
+        master_main(sp[1], pool_n);
+    }
+    close(sp[1]);
+    // the master lives until this end closes at process exit
+    (void)fcntl(sp[0], F_SETFD, FD_CLOEXEC);
+    z.ctrl = sp[0];
+    return true;
+}
+
+void mark_dead(ZygoteClient& z) {
+    if (z.ctrl >= 0) close(z.ctrl);
+    z.ctrl = -1;
+    z.failed = true;
+}
+
+// Ask the master for an idle worker; returns its pid and socket.
+bool checkout_worker(ZygoteClient& z, pid_t* wpid, int* wsock) {
+    if (write(z.ctrl, "G", 1) != 1) {
+        mark_dead(z);
+        return false;
+    }
+    struct pollfd pfd;
+    pfd.fd = z.ctrl;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, 3000) <= 0) {
+        mark_dead(z);
+        return false;
+    }
+    pid_t pid = -1;
+    char cbuf[CMSG_SPACE(sizeof(int))];
+    struct iovec iov;
+    iov.iov_base = &pid;
+    iov.iov_len = sizeof(pid);
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+    ssize_t n = recvmsg(z.ctrl, &msg, 0);
+    if (n <= 0 || pid <= 0) {
+        mark_dead(z);
+        return false;
+    }
+    int fd = -1;
+    for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS) {
+            std::memcpy(&fd, CMSG_DATA(c), sizeof(int));
+        }
+    }
+    if (fd < 0) {
+        mark_dead(z);
+        return false;
+    }
+    *wpid = pid;
+    *wsock = fd;
+    return true;
+}
+
+} // namespace
+
+bool zygote_enabled() {
+    return env_true("MACHINA_ZYGOTE_ENABLE");
+}
+
+pid_t zygote_spawn(const std::vector<std::string>& argv,
+                   const std::string& cwd,
+                   const ProcLimits& lim,
+                   int stdin_fd, int stdout_fd) {
+    if (!zygote_enabled()) return -1;
+    if (argv.empty() || argv.size() > kMaxArgs) return -1;
+    std::string path = proc_resolve_exe_path(argv[0]);
+    if (path.empty()) return -1;
+
+    std::vector<char> frame;
+    frame.reserve(256);
+    put_u32(frame, (uint32_t)argv.size());
+    for (const auto& a : argv) put_str(frame, a);
+    put_str(frame, path);
+    put_str(frame, cwd);
+    frame.push_back(stdin_fd >= 0 ? (char)1 : (char)0);
+    const char* lp = reinterpret_cast<const char*>(&lim);
+    frame.insert(frame.end(), lp, lp + sizeof(ProcLimits));
+    if (frame.size() > kMaxFrame) return -1;
+
+    pid_t wpid = -1;
+    int wsock = -1;
+    {
+        auto& z = client();
+        std::lock_guard<std::mutex> lk(z.mu);
+        if (z.failed) return -1;
+        if (z.ctrl < 0 && !start_master(z)) {
+            z.failed = true;
+            return -1;
+        }
+        if (!checkout_worker(z, &wpid, &wsock)) return -1;
+    }
+
+    // hand the worker its stdio fds and the frame in one message
+    int fds[2];
+    int nfds = 0;
+    if (stdin_fd >= 0) fds[nfds++] = stdin_fd;
+    fds[nfds++] = stdout_fd;
+
+    char cbuf[CMSG_SPACE(2 * sizeof(int))];
+    struct iovec iov;
+    iov.iov_base = frame.data();
+    iov.iov_len = frame.size();
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+    struct cmsghdr* c = CMSG_FIRSTHDR(&msg);
+    c->cmsg_level = SOL_SOCKET;
+    c->cmsg_type = SCM_RIGHTS;
+    c->cmsg_len = CMSG_LEN((size_t)nfds * sizeof(int));
+    std::memcpy(CMSG_DATA(c), fds, (size_t)nfds * sizeof(int));
+    msg.msg_controllen = c->cmsg_len;
+
+    ssize_t sent = sendmsg(wsock, &msg, 0);
+    close(wsock);
+    if (sent != (ssize_t)frame.size()) {
+        (void)kill(wpid, SIGKILL);
+        (void)waitpid(wpid, nullptr, 0);
+        return -1;
+    }
+    return wpid;
+}
+
+#elif !defined(_WIN32)
+
+bool zygote_enabled() { return false; }
+
+pid_t zygote_spawn(const std::vector<std::string>&, const std::string&,
+                   const ProcLimits&, int, int) {
+    return -1;
+}
+
+#endif
+
+} // namespace machina
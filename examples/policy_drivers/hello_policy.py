@@ -16,7 +16,12 @@ def main():
     with open(sys.argv[1], "r") as f:
         payload = json.load(f)
 
+    # The menu is either inline or (by default) in a content-addressed side
+    # file the runner reuses while the menu is unchanged.
     menu = payload.get("menu", [])
+    if not menu and payload.get("menu_file"):
+        with open(payload["menu_file"], "r") as f:
+            menu = json.load(f)
     if not menu:
         print("<NOOP><END>")
         return
@@ -1,19 +1,149 @@
 #include "cmd_autopilot.h"
 #include "cmd_run.h"
 #include "runner_utils.h"
+#include "tool_setup.h"
 
 #include "machina/json_mini.h"
+#include "machina/registry.h"
+#include "machina/selector.h"
+#include "machina/state.h"
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <csignal>
+#include <deque>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <unordered_set>
 #include <vector>
 
 using namespace machina;
 
 static std::atomic<bool> g_autopilot_running{true};
 
+// ---- Lookahead prefetch ----
+//
+// Jobs execute through an in-process cmd_run, so the goal-embedding and
+// centroid caches in the GPU_CENTROID selector (and the embedding provider
+// behind them) are process-wide. While workers run the current jobs, one
+// prefetch thread replays the selection prep for jobs still waiting in the
+// queue: it rebuilds the job's first-step menu (Registry::queryByTags via
+// build_menu_from_registry) and runs a FALLBACK_ONLY select() against it,
+// so by the time a worker reaches the job its goal embedding and centroid
+// matrix are cache hits instead of subprocess round-trips. Selection prep
+// and tool execution overlap instead of serializing.
+//
+// Only active when MACHINA_SELECTOR=GPU_CENTROID — the heuristic selector
+// has nothing to warm. MACHINA_AUTOPILOT_PREFETCH=0 disables it outright.
+class GoalPrefetcher {
+public:
+    explicit GoalPrefetcher(const std::filesystem::path& root) : root_(root) {
+        const char* s = std::getenv("MACHINA_SELECTOR");
+        bool centroid = s && std::string(s) == "GPU_CENTROID";
+        enabled_ = centroid && runner_detail::getenv_int("MACHINA_AUTOPILOT_PREFETCH", 1) != 0;
+        if (enabled_) th_ = std::thread([this]() { run(); });
+    }
+
+    ~GoalPrefetcher() {
+        if (!enabled_) return;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        th_.join();
+    }
+
+    // Non-blocking; drops the oldest pending entry when the queue is full.
+    void offer(const std::filesystem::path& job_file) {
+        if (!enabled_) return;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            if (pending_.size() >= 32) pending_.pop_front();
+            pending_.push_back(job_file);
+        }
+        cv_.notify_one();
+    }
+
+private:
+    void run() {
+        // Descriptor-only registry: enough to reproduce the menu cmd_run
+        // builds (hot-loaded plugin tools may be missing, in which case the
+        // warm lands on a different centroid key and is merely wasted).
+        Registry reg;
+        try {
+            load_tier0_descs(reg, root_);
+        } catch (...) {
+            return;
+        }
+        auto selector = make_selector("GPU_CENTROID", root_);
+
+        for (;;) {
+            std::filesystem::path job;
+            {
+                std::unique_lock<std::mutex> lk(mu_);
+                cv_.wait(lk, [this]() { return stop_ || !pending_.empty(); });
+                if (stop_) return;
+                job = std::move(pending_.front());
+                pending_.pop_front();
+            }
+            try {
+                warm(reg, *selector, job);
+            } catch (...) {
+                // best-effort: a failed warm just means a cold first step
+            }
+        }
+    }
+
+    // Mirrors cmd_run's step-0 setup: fresh DSState, base tags plus
+    // tag.meta (plus the genesis tags for goal.GENESIS*), capability
+    // filtering, and the all-zero FLAGS goal_context — so the cache keys
+    // this computes are exactly the ones the real run asks for first.
+    void warm(const Registry& reg, ISelector& selector, const std::filesystem::path& job) {
+        std::string req = slurp_file(job);
+        std::string goal_id = json_mini::get_string(req, "goal_id").value_or("");
+        if (goal_id.empty()) return;
+
+        auto tags = json_mini::get_array_strings(req, "candidate_tags");
+        if (std::find(tags.begin(), tags.end(), "tag.meta") == tags.end()) tags.push_back("tag.meta");
+        if (goal_id.rfind("goal.GENESIS", 0) == 0) {
+            tags.push_back("tag.genesis");
+            tags.push_back("tag.runtime");
+        }
+        std::sort(tags.begin(), tags.end());
+        tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+
+        std::string goal_context = goal_id + "|FLAGS:DS0=0;DS2=0;DS6=0;DS7=0;DS6_STAGE=;";
+        for (auto& t : tags) goal_context += "|" + t;
+        if (recently_warmed_.count(goal_context)) return;
+        if (recently_warmed_.size() >= 256) recently_warmed_.clear();
+        recently_warmed_.insert(goal_context);
+
+        Menu menu = build_menu_from_registry(reg, tags);
+        auto cap_raw = json_mini::get_object_raw(req, "_capabilities").value_or("");
+        if (!cap_raw.empty()) {
+            menu = filter_menu_by_capabilities(menu,
+                                               json_mini::get_array_strings(cap_raw, "allowed_tools"),
+                                               json_mini::get_array_strings(cap_raw, "blocked_tools"));
+        }
+
+        std::string inputs = json_mini::get_object_raw(req, "inputs").value_or("{}");
+        selector.select(menu, goal_context, DSState{}.digest(), ControlMode::FALLBACK_ONLY, inputs);
+    }
+
+    std::filesystem::path root_;
+    bool enabled_{false};
+    std::thread th_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<std::filesystem::path> pending_;
+    bool stop_{false};
+    std::unordered_set<std::string> recently_warmed_; // prefetch thread only
+};
+
 int cmd_autopilot(int argc, char** argv) {
     // Install signal handlers for graceful shutdown
     g_autopilot_running.store(true);
@@ -47,6 +177,8 @@ int cmd_autopilot(int argc, char** argv) {
 
     std::cerr << "[autopilot] root=" << root << " queue=" << q << " workers=" << workers << "\n";
 
+    GoalPrefetcher prefetcher(root);
+
     auto worker_fn = [&](int wid) -> int {
         (void)wid;
         while (g_autopilot_running.load()) {
@@ -54,26 +186,29 @@ int cmd_autopilot(int argc, char** argv) {
                 move_due_retries(retry, inbox);
             }
 
-            auto jobs = list_inbox_json(inbox);
-            if (jobs.empty()) {
+            // Batch claim: one scan pass moves several due jobs into the
+            // processing dir, instead of every worker re-listing the whole
+            // inbox per job and racing on the same front file.
+            auto claimed = claim_inbox_batch(inbox, processing, 8);
+            if (claimed.empty()) {
                 if (once) return 0;
                 sleep_ms(sleepms);
                 continue;
             }
 
-            auto job = jobs.front();
-            std::string base = job.filename().string();
-            std::filesystem::path proc = processing / (base + ".processing");
-            std::error_code ec;
-            std::filesystem::rename(job, proc, ec);
-            if (ec) {
-                sleep_ms(10);
-                continue;
-            }
+            // Warm selection caches for the jobs behind the one about to
+            // run; the prefetch thread works while this one executes.
+            for (size_t i = 1; i < claimed.size(); i++) prefetcher.offer(claimed[i]);
+
+            for (auto& proc : claimed) {
+                if (!g_autopilot_running.load()) break;
+                std::string base = proc.filename().string();
+                if (ends_with(base, ".processing")) base.resize(base.size() - std::string(".processing").size());
 
-            // Delegate to shared job processing function
-            JobResult jr = process_queue_job(proc, base, argv[0], root, q);
-            (void)jr; // autopilot doesn't need WAL/counters
+                // Delegate to shared job processing function
+                JobResult jr = process_queue_job(proc, base, argv[0], root, q);
+                (void)jr; // autopilot doesn't need WAL/counters
+            }
         }
         return 0;
     };
@@ -82,17 +217,124 @@ int cmd_autopilot(int argc, char** argv) {
         return worker_fn(0);
     }
 
+    // Parallel mode: one claimer feeds per-worker deques, routed by a hash
+    // of the job's goal_id so same-goal jobs land in one deque in claim
+    // order. Idle workers steal from the back of another deque, but only a
+    // job whose goal has nothing queued ahead of it or running — per-goal
+    // ordering survives stealing while independent goals spread across
+    // cores.
+    struct PoolJob {
+        std::filesystem::path proc;
+        std::string base;
+        uint64_t goal_key{0};
+    };
+    std::vector<std::deque<PoolJob>> dq((size_t)workers);
+    std::unordered_set<uint64_t> goal_inflight;
+    std::mutex pool_mu;
+    std::condition_variable pool_cv;
+    bool drained = false;
+
+    auto goal_key_of = [](const std::filesystem::path& p) -> uint64_t {
+        std::string gid = json_mini::get_string(slurp_file(p), "goal_id").value_or("");
+        uint64_t h = 1469598103934665603ull;
+        for (unsigned char c : gid) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    };
+
+    auto pool_worker = [&](int wid) {
+        std::unique_lock<std::mutex> lk(pool_mu);
+        for (;;) {
+            PoolJob job;
+            bool got = false;
+            auto& own = dq[(size_t)wid];
+            for (auto it = own.begin(); it != own.end(); ++it) {
+                if (goal_inflight.count(it->goal_key)) continue;
+                job = std::move(*it);
+                own.erase(it);
+                got = true;
+                break;
+            }
+            for (size_t v = 0; v < dq.size() && !got; v++) {
+                if ((int)v == wid) continue;
+                auto& vd = dq[v];
+                for (auto rit = vd.rbegin(); rit != vd.rend(); ++rit) {
+                    if (goal_inflight.count(rit->goal_key)) continue;
+                    auto fwd = std::prev(rit.base());
+                    bool earlier = false;
+                    for (auto jt = vd.begin(); jt != fwd; ++jt) {
+                        if (jt->goal_key == rit->goal_key) { earlier = true; break; }
+                    }
+                    if (earlier) continue; // stealing would reorder this goal
+                    job = std::move(*rit);
+                    vd.erase(fwd);
+                    got = true;
+                    break;
+                }
+            }
+            if (!got) {
+                if (drained || !g_autopilot_running.load()) return;
+                pool_cv.wait_for(lk, std::chrono::milliseconds(100));
+                continue;
+            }
+            goal_inflight.insert(job.goal_key);
+            lk.unlock();
+            JobResult jr = process_queue_job(job.proc, job.base, argv[0], root, q);
+            (void)jr;
+            lk.lock();
+            goal_inflight.erase(job.goal_key);
+            pool_cv.notify_all();
+        }
+    };
+
     std::vector<std::thread> th;
     th.reserve((size_t)workers);
-    std::atomic<int> first_rc{-999};
-    for (int i = 0; i < workers; i++) {
-        th.emplace_back([&, i]() {
-            int rc = worker_fn(i);
-            int exp = -999;
-            (void)first_rc.compare_exchange_strong(exp, rc);
-        });
+    for (int i = 0; i < workers; i++) th.emplace_back([&, i]() { pool_worker(i); });
+
+    // Claimer (main thread): batch-claims when the deques run low.
+    while (g_autopilot_running.load()) {
+        move_due_retries(retry, inbox);
+        size_t queued = 0;
+        {
+            std::lock_guard<std::mutex> lk(pool_mu);
+            for (auto& d : dq) queued += d.size();
+        }
+        size_t claimed_n = 0;
+        if (queued < (size_t)workers * 2) {
+            auto claimed = claim_inbox_batch(inbox, processing, (size_t)workers * 4);
+            claimed_n = claimed.size();
+            if (!claimed.empty()) {
+                std::lock_guard<std::mutex> lk(pool_mu);
+                for (auto& proc : claimed) {
+                    std::string base = proc.filename().string();
+                    if (ends_with(base, ".processing"))
+                        base.resize(base.size() - std::string(".processing").size());
+                    uint64_t gk = goal_key_of(proc);
+                    dq[(size_t)(gk % (uint64_t)workers)].push_back(PoolJob{proc, base, gk});
+                    prefetcher.offer(proc);
+                }
+                pool_cv.notify_all();
+            }
+        }
+        if (claimed_n == 0) {
+            if (once) {
+                std::unique_lock<std::mutex> lk(pool_mu);
+                size_t left = goal_inflight.size();
+                for (auto& d : dq) left += d.size();
+                if (left == 0) break;
+                pool_cv.wait_for(lk, std::chrono::milliseconds(100));
+                continue;
+            }
+            sleep_ms(sleepms);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lk(pool_mu);
+        drained = true;
     }
+    pool_cv.notify_all();
     for (auto& t : th) t.join();
-    int rc = first_rc.load();
-    return (rc == -999) ? 0 : rc;
+    return 0;
 }
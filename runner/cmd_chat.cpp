@@ -14,15 +14,30 @@
 #include "machina/json_mini.h"
 #include "machina/hash.h"
 #include "machina/goal_registry.h"
+#include "machina/aho_corasick.h"
 #include "machina/proc.h"
 
 #include <algorithm>
 #include <chrono>
+#include <fstream>
+#include <functional>
 #include <iostream>
 #include <sstream>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+#endif
+
 using namespace machina;
 
 // ---- Chat data structures ----
@@ -30,6 +45,21 @@ using namespace machina;
 struct ConvMessage {
     std::string role;     // "user" | "assistant" | "system"
     std::string content;
+    size_t tokens{0};     // rough estimate, fixed at append time
+};
+
+// Conversation plus the bookkeeping the driver protocol and the context
+// manager hang off it. seq counts messages ever appended (folding shortens
+// the vector but not the sequence — the persistent driver's acks anchor to
+// it); epoch changes whenever the existing prefix changes (folding), which
+// invalidates the serialized-prefix cache; summary carries the folded
+// history in compact form.
+struct ConvContext {
+    std::vector<ConvMessage> messages;
+    long long seq{0};
+    long long epoch{0};
+    std::string summary;
+    size_t summary_tokens{0};
 };
 
 struct ChatAction {
@@ -75,18 +105,71 @@ static const std::unordered_set<std::string> CONFIG_ALLOWLIST = {
 
 // ---- Helpers ----
 
-static std::string conv_to_json(const std::vector<ConvMessage>& conv) {
+// ~4 bytes per token is close enough for budget math on chat text.
+static size_t estimate_tokens(const std::string& s) {
+    return s.size() / 4 + 1;
+}
+
+static void conv_msg_append_json(std::string& out, const ConvMessage& m) {
+    out += "{\"role\":\"" + json_escape(m.role) + "\","
+           "\"content\":\"" + json_escape(m.content) + "\"}";
+}
+
+// Serialize messages [from, end). The full-history case keeps its
+// serialized prefix in a single-slot cache keyed by (context, epoch):
+// messages are append-only between folds, so a turn usually just escapes
+// the one or two new messages instead of the whole window.
+static std::string conv_to_json(const ConvContext& ctx, size_t from = 0) {
+    const auto& conv = ctx.messages;
+    if (from == 0) {
+        static thread_local struct {
+            const ConvContext* ctx{nullptr};
+            long long epoch{-1};
+            size_t count{0};
+            std::string body; // "[m0,m1,..." without the closing bracket
+        } cache;
+        if (cache.ctx != &ctx || cache.epoch != ctx.epoch || cache.count > conv.size()) {
+            cache.ctx = &ctx;
+            cache.epoch = ctx.epoch;
+            cache.count = 0;
+            cache.body = "[";
+        }
+        for (size_t i = cache.count; i < conv.size(); i++) {
+            if (i) cache.body += ",";
+            conv_msg_append_json(cache.body, conv[i]);
+        }
+        cache.count = conv.size();
+        return cache.body + "]";
+    }
+
     std::string out = "[";
-    for (size_t i = 0; i < conv.size(); i++) {
-        if (i) out += ",";
-        out += "{\"role\":\"" + json_escape(conv[i].role) + "\","
-               "\"content\":\"" + json_escape(conv[i].content) + "\"}";
+    for (size_t i = from; i < conv.size(); i++) {
+        if (i > from) out += ",";
+        conv_msg_append_json(out, conv[i]);
     }
     out += "]";
     return out;
 }
 
-static std::string tools_to_json(const Registry& reg) {
+// Serialized tool/goal payloads plus their content digest. The registry
+// almost never changes mid-session, so both are cached behind the registry
+// generation counters (same single-slot pattern as the menu cache in
+// runner_utils) and rebuilt only when a registration actually happened —
+// not once per chat turn. The digest travels with every request so a
+// stateful driver can skip re-reading a tool list it has already seen.
+struct CachedPayload {
+    std::string json;
+    std::string digest;
+};
+
+static const CachedPayload& tools_to_json(const Registry& reg) {
+    static thread_local struct {
+        const Registry* reg{nullptr};
+        uint64_t gen{~0ULL};
+        CachedPayload payload;
+    } cache;
+    if (cache.reg == &reg && cache.gen == reg.generation()) return cache.payload;
+
     std::string out = "[";
     bool first = true;
     for (const auto& td : reg.allToolDescs()) {
@@ -102,10 +185,22 @@ static std::string tools_to_json(const Registry& reg) {
         out += "]}";
     }
     out += "]";
-    return out;
+
+    cache.reg = &reg;
+    cache.gen = reg.generation();
+    cache.payload.digest = hash::hex64(hash::fnv1a64(out));
+    cache.payload.json = std::move(out);
+    return cache.payload;
 }
 
-static std::string goals_to_json(const GoalRegistry& goal_reg) {
+static const CachedPayload& goals_to_json(const GoalRegistry& goal_reg) {
+    static thread_local struct {
+        const GoalRegistry* reg{nullptr};
+        uint64_t gen{~0ULL};
+        CachedPayload payload;
+    } cache;
+    if (cache.reg == &goal_reg && cache.gen == goal_reg.generation()) return cache.payload;
+
     auto ids = goal_reg.allGoalIds();
     std::string out = "[";
     for (size_t i = 0; i < ids.size(); i++) {
@@ -113,12 +208,54 @@ static std::string goals_to_json(const GoalRegistry& goal_reg) {
         out += "\"" + json_escape(ids[i]) + "\"";
     }
     out += "]";
-    return out;
+
+    cache.reg = &goal_reg;
+    cache.gen = goal_reg.generation();
+    cache.payload.digest = hash::hex64(hash::fnv1a64(out));
+    cache.payload.json = std::move(out);
+    return cache.payload;
 }
 
-static void trim_conversation(std::vector<ConvMessage>& conv) {
-    while (conv.size() > MAX_HISTORY_TURNS * 2)
-        conv.erase(conv.begin());
+// Context manager: instead of discarding old turns outright, fold them
+// into the running summary once the window exceeds the token budget
+// (MACHINA_CHAT_TOKEN_BUDGET, default 4000) or the turn cap. Each folded
+// message contributes a one-line digest to ctx.summary (sent with every
+// driver request as context_summary) and the folded span is persisted via
+// the memory_append tool, so full history stays searchable even after it
+// leaves the window.
+static void fold_conversation(ConvContext& ctx, ToolRunner& runner) {
+    size_t budget = (size_t)runner_detail::getenv_int("MACHINA_CHAT_TOKEN_BUDGET", 4000);
+    size_t total = ctx.summary_tokens;
+    for (const auto& m : ctx.messages) total += m.tokens;
+
+    std::string folded;
+    while (ctx.messages.size() > 1 &&
+           (ctx.messages.size() > MAX_HISTORY_TURNS * 2 || total > budget)) {
+        const ConvMessage& m = ctx.messages.front();
+        std::string line = m.role + ": " +
+            (m.content.size() > 160 ? m.content.substr(0, 160) + "..." : m.content);
+        folded += line + "\n";
+        if (!ctx.summary.empty()) ctx.summary += "\n";
+        ctx.summary += line;
+        total -= m.tokens;
+        ctx.messages.erase(ctx.messages.begin());
+        ctx.epoch++;
+    }
+    if (folded.empty()) return;
+
+    // The summary itself stays bounded: oldest digests age out first.
+    const size_t kSummaryMax = 8192;
+    if (ctx.summary.size() > kSummaryMax) {
+        auto cut = ctx.summary.find('\n', ctx.summary.size() - kSummaryMax);
+        ctx.summary.erase(0, cut == std::string::npos ? ctx.summary.size() - kSummaryMax : cut + 1);
+    }
+    ctx.summary_tokens = estimate_tokens(ctx.summary);
+
+    // Best-effort archive of the folded span.
+    DSState tmp;
+    (void)runner.run("AID.MEMORY.APPEND.v1",
+                     "{\"stream\":\"chat_summary\",\"text\":\"" + json_escape(folded) + "\"}",
+                     tmp);
 }
 
 static std::string call_chat_driver(const std::string& chat_cmd,
@@ -157,6 +294,214 @@ static std::string call_chat_driver(const std::string& chat_cmd,
     return pr.output;
 }
 
+// ---- Persistent driver sidecar (MACHINA_CHAT_PERSIST=1) ----
+//
+// Mirrors the embed sidecar / toolhost --serve pattern: the chat command is
+// spawned once with a trailing "--serve" argument and kept alive, one JSON
+// request line in, one response line out. On top of that, requests carry a
+// conversation id plus "conv_new" (how many messages in the payload the
+// driver hasn't seen — the conversation array holds exactly those); a
+// driver that maintains per-id state appends them and answers with
+// "conv_ack": <total messages held>, never re-reading the full history.
+// Drivers that omit conv_ack simply get the full history each
+// turn — still saving the interpreter/model startup. Any failure falls back
+// to the one-shot subprocess path.
+
+#ifndef _WIN32
+
+namespace {
+
+struct ChatSidecar {
+    pid_t pid{-1};
+    int in_fd{-1};   // our write end -> child stdin
+    int out_fd{-1};  // our read end  <- child stdout
+    std::string cmd; // command the child was spawned from
+    std::string buf; // bytes past the last complete response line
+    std::string conv_id;
+    long long acked{0}; // messages (by global sequence) the driver holds
+};
+
+ChatSidecar g_chat_sidecar; // REPL is single-threaded; no lock needed
+
+bool chat_persist_enabled() {
+    const char* e = std::getenv("MACHINA_CHAT_PERSIST");
+    return e && (std::string(e) == "1" || std::string(e) == "true");
+}
+
+void chat_sidecar_stop() {
+    if (g_chat_sidecar.in_fd >= 0) ::close(g_chat_sidecar.in_fd);
+    if (g_chat_sidecar.out_fd >= 0) ::close(g_chat_sidecar.out_fd);
+    if (g_chat_sidecar.pid > 0) {
+        (void)::kill(g_chat_sidecar.pid, SIGKILL);
+        (void)::waitpid(g_chat_sidecar.pid, nullptr, 0);
+    }
+    g_chat_sidecar = ChatSidecar{};
+}
+
+bool chat_sidecar_start(const std::string& cmd, const std::filesystem::path& root) {
+    chat_sidecar_stop();
+
+    auto argv = split_argv_quoted(cmd);
+    if (argv.empty()) return false;
+    argv.push_back("--serve");
+
+    (void)::signal(SIGPIPE, SIG_IGN);
+
+    int in_pipe[2], out_pipe[2];
+    if (::pipe(in_pipe) != 0) return false;
+    if (::pipe(out_pipe) != 0) {
+        ::close(in_pipe[0]); ::close(in_pipe[1]);
+        return false;
+    }
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        ::close(in_pipe[0]); ::close(in_pipe[1]);
+        ::close(out_pipe[0]); ::close(out_pipe[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        (void)::dup2(in_pipe[0], STDIN_FILENO);
+        (void)::dup2(out_pipe[1], STDOUT_FILENO);
+        // stderr stays inherited: driver logs bypass the protocol stream.
+        ::close(in_pipe[0]); ::close(in_pipe[1]);
+        ::close(out_pipe[0]); ::close(out_pipe[1]);
+
+        (void)::setpgid(0, 0);
+        long maxfd = ::sysconf(_SC_OPEN_MAX);
+        if (maxfd < 256) maxfd = 256;
+        for (int fd = 3; fd < (int)maxfd; fd++) (void)::close(fd);
+#ifdef __linux__
+        (void)::prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+        // No rlimits, matching the one-shot path's unlimited AS/nproc for
+        // Python/torch drivers; no CPU cap on a long-lived process.
+        (void)::chdir(root.string().c_str());
+
+        std::vector<char*> cargv;
+        cargv.reserve(argv.size() + 1);
+        for (const auto& s : argv) cargv.push_back(const_cast<char*>(s.c_str()));
+        cargv.push_back(nullptr);
+        ::execvp(cargv[0], cargv.data());
+        ::_exit(127);
+    }
+
+    (void)::setpgid(pid, pid);
+    ::close(in_pipe[0]);
+    ::close(out_pipe[1]);
+    g_chat_sidecar.pid = pid;
+    g_chat_sidecar.in_fd = in_pipe[1];
+    g_chat_sidecar.out_fd = out_pipe[0];
+    g_chat_sidecar.cmd = cmd;
+    static int session_seq = 0;
+    g_chat_sidecar.conv_id = "chat_" + std::to_string((long)::getpid()) + "_" +
+                             std::to_string(session_seq++);
+    g_chat_sidecar.acked = 0;
+    return true;
+}
+
+bool chat_sidecar_roundtrip(const std::string& req, int timeout_ms, std::string* line) {
+    std::string payload = req;
+    payload.push_back('\n');
+    size_t off = 0;
+    while (off < payload.size()) {
+        ssize_t n = ::write(g_chat_sidecar.in_fd, payload.data() + off, payload.size() - off);
+        if (n > 0) { off += (size_t)n; continue; }
+        if (n == -1 && errno == EINTR) continue;
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        auto nl = g_chat_sidecar.buf.find('\n');
+        if (nl != std::string::npos) {
+            *line = g_chat_sidecar.buf.substr(0, nl);
+            g_chat_sidecar.buf.erase(0, nl + 1);
+            return true;
+        }
+
+        int elapsed_ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        if (timeout_ms > 0 && elapsed_ms >= timeout_ms) return false;
+
+        struct pollfd pfd;
+        pfd.fd = g_chat_sidecar.out_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int slice = 100;
+        if (timeout_ms > 0) slice = std::min(slice, timeout_ms - elapsed_ms);
+        int pr = ::poll(&pfd, 1, slice);
+        if (pr < 0 && errno == EINTR) continue;
+        if (pr <= 0) continue;
+
+        char buf[4096];
+        ssize_t n = ::read(g_chat_sidecar.out_fd, buf, sizeof(buf));
+        if (n > 0) { g_chat_sidecar.buf.append(buf, buf + (size_t)n); continue; }
+        if (n == -1 && errno == EINTR) continue;
+        return false; // EOF or read error: the child is gone
+    }
+}
+
+} // namespace
+
+#endif // !_WIN32
+
+// Dispatch one driver request. `build` produces the payload given how many
+// trailing messages to include and the conversation id ("" + full history
+// for the one-shot path); the delta math anchors to ctx.seq, which folding
+// never rewinds.
+static std::string call_chat_driver_conv(
+    const std::string& chat_cmd,
+    const std::filesystem::path& root,
+    const ConvContext& ctx,
+    const std::function<std::string(size_t conv_from, const std::string& conv_id)>& build)
+{
+    const std::vector<ConvMessage>& conv = ctx.messages;
+    long long conv_seq = ctx.seq;
+#ifndef _WIN32
+    if (chat_persist_enabled()) {
+        int timeout_ms = runner_detail::getenv_int("MACHINA_CHAT_TIMEOUT_MS", 30000);
+        for (int attempt = 0; attempt < 2; attempt++) {
+            // Reap a child that died between turns so we restart instead of
+            // writing into a broken pipe.
+            if (g_chat_sidecar.pid > 0 &&
+                ::waitpid(g_chat_sidecar.pid, nullptr, WNOHANG) == g_chat_sidecar.pid) {
+                if (g_chat_sidecar.in_fd >= 0) ::close(g_chat_sidecar.in_fd);
+                if (g_chat_sidecar.out_fd >= 0) ::close(g_chat_sidecar.out_fd);
+                g_chat_sidecar = ChatSidecar{};
+            }
+            if (g_chat_sidecar.pid <= 0 || g_chat_sidecar.cmd != chat_cmd) {
+                if (!chat_sidecar_start(chat_cmd, root)) break;
+            }
+            g_chat_sidecar.buf.clear();
+
+            // How many trailing messages the driver is missing. A driver
+            // that acked less than we have trimmed can't be patched up —
+            // resend everything under the current id.
+            long long missing = conv_seq - g_chat_sidecar.acked;
+            if (missing < 0 || missing > (long long)conv.size()) {
+                g_chat_sidecar.acked = 0;
+                missing = (long long)conv.size();
+            }
+            size_t from = conv.size() - (size_t)missing;
+
+            std::string line;
+            if (chat_sidecar_roundtrip(build(from, g_chat_sidecar.conv_id), timeout_ms, &line)) {
+                auto ack = json_mini::get_int(line, "conv_ack");
+                g_chat_sidecar.acked = ack ? std::max<long long>(0, *ack) : 0;
+                return line;
+            }
+            chat_sidecar_stop();
+        }
+        // fall through to one-shot
+    }
+#endif
+    (void)conv;
+    (void)conv_seq;
+    return call_chat_driver(chat_cmd, build(0, std::string()), root);
+}
+
 static ChatIntent parse_intent(const std::string& json_str) {
     ChatIntent intent;
     if (json_str.empty() || json_str == "{}") return intent;
@@ -240,63 +585,173 @@ static ChatIntent parse_intent(const std::string& json_str) {
 
 // ---- Pattern matching fallback (no LLM) ----
 
-static ChatIntent detect_pattern(const std::string& input, const Registry& /*reg*/, const GoalRegistry& /*goal_reg*/) {
-    ChatIntent intent;
-    std::string lower = input;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-
-    // Greeting patterns
-    if (lower == "hi" || lower == "hello" || lower.find("안녕") != std::string::npos ||
-        lower.find("hey") != std::string::npos) {
-        intent.type = "reply";
-        intent.content = "Hi! I'm Machina Trinity agent. I can help with log analysis, GPU monitoring, file operations, memory search, and more. What can I do for you?";
-        return intent;
+// One fallback rule: a prototype intent plus the terms that trigger it.
+// "{{input}}" inside an action's inputs_json is replaced with the escaped
+// user message at match time.
+struct IntentRule {
+    ChatIntent proto;
+    std::vector<std::string> match_exact; // whole-input equality (lower-cased)
+    std::vector<std::string> match_any;   // substring anywhere (lower-cased)
+};
+
+// All rules compiled together: substring terms go into one Aho-Corasick
+// automaton (id = rule index), exact terms into a hash map. Detection is a
+// single pass over the lower-cased input no matter how many rules are
+// loaded; the lowest-index rule with any matching term wins, which
+// preserves the old cascade's first-hit-wins ordering.
+struct IntentMatcher {
+    std::vector<ChatIntent> protos;
+    std::unordered_map<std::string, int> exact;
+    AhoCorasick any;
+};
+
+static std::vector<IntentRule> builtin_intent_rules() {
+    std::vector<IntentRule> rules;
+
+    // Greeting
+    {
+        IntentRule r;
+        r.proto.type = "reply";
+        r.proto.content = "Hi! I'm Machina Trinity agent. I can help with log analysis, GPU monitoring, file operations, memory search, and more. What can I do for you?";
+        r.match_exact = {"hi", "hello"};
+        r.match_any = {"안녕", "hey"};
+        rules.push_back(std::move(r));
     }
 
     // Error scan
-    if (lower.find("error") != std::string::npos || lower.find("log") != std::string::npos ||
-        lower.find("에러") != std::string::npos || lower.find("로그") != std::string::npos) {
-        intent.type = "action";
+    {
+        IntentRule r;
+        r.proto.type = "action";
         ChatAction a;
         a.kind = "goal";
         a.goal_id = "goal.ERROR_SCAN.v1";
         a.inputs_json = "{\"input_path\":\"/var/log/syslog\",\"pattern\":\"ERROR\",\"max_rows\":1000000}";
         a.tags = {"tag.log", "tag.scan", "tag.error", "tag.report"};
-        intent.actions.push_back(std::move(a));
-        intent.assistant_prefix = "Checking logs...";
-        intent.needs_summary = true;
-        return intent;
+        r.proto.actions.push_back(std::move(a));
+        r.proto.assistant_prefix = "Checking logs...";
+        r.proto.needs_summary = true;
+        r.match_any = {"error", "log", "에러", "로그"};
+        rules.push_back(std::move(r));
     }
 
     // GPU
-    if (lower.find("gpu") != std::string::npos || lower.find("그래픽") != std::string::npos) {
-        intent.type = "action";
+    {
+        IntentRule r;
+        r.proto.type = "action";
         ChatAction a;
         a.kind = "goal";
         a.goal_id = "goal.GPU_SMOKE.v1";
         a.inputs_json = "{}";
         a.tags = {"tag.gpu", "tag.meta"};
-        intent.actions.push_back(std::move(a));
-        intent.assistant_prefix = "Checking GPU...";
-        intent.needs_summary = true;
-        return intent;
+        r.proto.actions.push_back(std::move(a));
+        r.proto.assistant_prefix = "Checking GPU...";
+        r.proto.needs_summary = true;
+        r.match_any = {"gpu", "그래픽"};
+        rules.push_back(std::move(r));
     }
 
     // Memory
-    if (lower.find("remember") != std::string::npos || lower.find("기억") != std::string::npos ||
-        lower.find("memo") != std::string::npos) {
-        intent.type = "action";
+    {
+        IntentRule r;
+        r.proto.type = "action";
         ChatAction a;
         a.kind = "tool";
         a.aid = "AID.MEMORY.APPEND.v1";
-        a.inputs_json = "{\"stream\":\"chat\",\"text\":\"" + json_escape(input) + "\"}";
-        intent.actions.push_back(std::move(a));
-        intent.assistant_prefix = "Saving to memory...";
-        intent.needs_summary = false;
+        a.inputs_json = "{\"stream\":\"chat\",\"text\":\"{{input}}\"}";
+        r.proto.actions.push_back(std::move(a));
+        r.proto.assistant_prefix = "Saving to memory...";
+        r.proto.needs_summary = false;
+        r.match_any = {"remember", "기억", "memo"};
+        rules.push_back(std::move(r));
+    }
+
+    return rules;
+}
+
+// Optional extra rules from policies/chat_patterns.json:
+//   {"patterns":[{"type":"reply"|"action","match_exact":[..],"match_any":[..],
+//     "content":..,"assistant_prefix":..,"needs_summary":bool,
+//     "actions":[{"kind":"goal"|"tool","goal_id":..,"aid":..,"inputs":{..},"tags":[..]}]}]}
+// Manifest rules are checked ahead of the built-ins, so a deployment can
+// both extend and override the stock behavior.
+static void load_intent_rules_manifest(const std::filesystem::path& path,
+                                       std::vector<IntentRule>& out) {
+    std::ifstream f(path);
+    if (!f) return;
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    auto arr = json_mini::get_array_raw(ss.str(), "patterns");
+    if (!arr) return;
+    for (const auto& pj : json_mini::parse_array_objects_raw(*arr)) {
+        IntentRule r;
+        r.proto.type = json_mini::get_string(pj, "type").value_or("reply");
+        r.proto.content = json_mini::get_string(pj, "content").value_or("");
+        r.proto.assistant_prefix = json_mini::get_string(pj, "assistant_prefix").value_or("");
+        r.proto.needs_summary = json_mini::get_bool(pj, "needs_summary").value_or(false);
+        r.match_exact = json_mini::get_array_strings(pj, "match_exact");
+        r.match_any = json_mini::get_array_strings(pj, "match_any");
+        if (auto actions = json_mini::get_array_raw(pj, "actions")) {
+            for (const auto& aj : json_mini::parse_array_objects_raw(*actions)) {
+                ChatAction a;
+                a.kind = json_mini::get_string(aj, "kind").value_or("tool");
+                a.goal_id = json_mini::get_string(aj, "goal_id").value_or("");
+                a.aid = json_mini::get_string(aj, "aid").value_or("");
+                a.inputs_json = json_mini::get_object_raw(aj, "inputs").value_or("{}");
+                a.tags = json_mini::get_array_strings(aj, "tags");
+                r.proto.actions.push_back(std::move(a));
+            }
+        }
+        if (r.match_exact.empty() && r.match_any.empty()) continue;
+        out.push_back(std::move(r));
+    }
+}
+
+// Compiled once on first use; rule tables do not change mid-session.
+static const IntentMatcher& intent_matcher(const std::filesystem::path& root) {
+    static IntentMatcher m = [&root]() {
+        IntentMatcher im;
+        std::vector<IntentRule> rules;
+        load_intent_rules_manifest(root / "policies" / "chat_patterns.json", rules);
+        auto builtins = builtin_intent_rules();
+        for (auto& r : builtins) rules.push_back(std::move(r));
+
+        auto lower = [](std::string s) {
+            std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+            return s;
+        };
+        for (size_t i = 0; i < rules.size(); i++) {
+            for (const auto& term : rules[i].match_exact)
+                im.exact.emplace(lower(term), (int)i); // first wins on dup terms
+            for (const auto& term : rules[i].match_any)
+                im.any.add(lower(term), (int)i);
+            im.protos.push_back(std::move(rules[i].proto));
+        }
+        im.any.build();
+        return im;
+    }();
+    return m;
+}
+
+static ChatIntent detect_pattern(const std::string& input, const std::filesystem::path& root) {
+    const IntentMatcher& m = intent_matcher(root);
+    std::string lowered = input;
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+
+    int best = m.any.match_min_id(lowered);
+    auto it = m.exact.find(lowered);
+    if (it != m.exact.end() && (best < 0 || it->second < best)) best = it->second;
+
+    if (best >= 0) {
+        ChatIntent intent = m.protos[(size_t)best];
+        for (auto& a : intent.actions) {
+            auto pos = a.inputs_json.find("{{input}}");
+            if (pos != std::string::npos)
+                a.inputs_json.replace(pos, 9, json_escape(input));
+        }
         return intent;
     }
 
-    // Default: reply
+    ChatIntent intent;
     intent.type = "reply";
     intent.content = "I'm not sure what you mean. Could you be more specific? I can help with: log analysis, GPU monitoring, file operations, memory search.";
     return intent;
@@ -311,6 +766,7 @@ static ActionResult run_goal_action(
     ISelector* selector,
     PluginManager& plugin_mgr,
     RunnerRegistrar& registrar,
+    ManifestHotReload& manifest_reload,
     const std::filesystem::path& root,
     const std::string& goal_id,
     const std::string& inputs_json,
@@ -384,10 +840,11 @@ static ActionResult run_goal_action(
             break;
         }
 
-        // Automatic reload of plugins
+        // Automatic reload of plugins and edited toolpack manifests
         {
             std::string perr;
             plugin_mgr.load_new_from_dir(root / "toolpacks" / "runtime_plugins", &registrar, &perr);
+            manifest_reload.poll(reg, root);
         }
 
         if (goal_reg.isGoalComplete(goal_id, state)) {
@@ -458,31 +915,51 @@ static ActionResult exec_tool_action(
 
 // ---- Build payloads ----
 
+// conv_from/conv_id: persistent-driver delta fields (see
+// call_chat_driver_conv). With an empty conv_id the payload is the classic
+// full-history one, byte-compatible with existing drivers.
 static std::string build_intent_payload(
     const std::string& user_msg,
-    const std::vector<ConvMessage>& conv,
+    const ConvContext& ctx,
+    size_t conv_from,
+    const std::string& conv_id,
     const Registry& reg,
     const GoalRegistry& goal_reg,
     const std::string& selector_backend)
 {
+    const auto& conv = ctx.messages;
     std::string session = "{\"selector\":\"" + json_escape(selector_backend) + "\","
                           "\"ops_count\":" + std::to_string(conv.size() / 2) + "}";
 
-    return std::string("{")
-        + "\"mode\":\"intent\","
-        + "\"user_message\":\"" + json_escape(user_msg) + "\","
-        + "\"conversation\":" + conv_to_json(conv) + ","
-        + "\"available_tools\":" + tools_to_json(reg) + ","
-        + "\"available_goals\":" + goals_to_json(goal_reg) + ","
-        + "\"session\":" + session
-        + "}";
+    std::string out = "{\"mode\":\"intent\",";
+    if (!conv_id.empty()) {
+        out += "\"conv_id\":\"" + json_escape(conv_id) + "\","
+               "\"conv_new\":" + std::to_string(conv.size() - conv_from) + ",";
+    }
+    if (!ctx.summary.empty()) {
+        out += "\"context_summary\":\"" + json_escape(ctx.summary) + "\",";
+    }
+    const CachedPayload& tools = tools_to_json(reg);
+    const CachedPayload& goals = goals_to_json(goal_reg);
+    out += "\"user_message\":\"" + json_escape(user_msg) + "\","
+           "\"conversation\":" + conv_to_json(ctx, conv_from) + ","
+           "\"available_tools\":" + tools.json + ","
+           "\"tools_digest\":\"" + tools.digest + "\","
+           "\"available_goals\":" + goals.json + ","
+           "\"goals_digest\":\"" + goals.digest + "\","
+           "\"session\":" + session
+           + "}";
+    return out;
 }
 
 static std::string build_summary_payload(
     const std::string& user_msg,
-    const std::vector<ConvMessage>& conv,
+    const ConvContext& ctx,
+    size_t conv_from,
+    const std::string& conv_id,
     const std::vector<ActionResult>& results)
 {
+    const auto& conv = ctx.messages;
     std::string action_results = "[";
     for (size_t i = 0; i < results.size(); i++) {
         if (i) action_results += ",";
@@ -495,12 +972,19 @@ static std::string build_summary_payload(
     }
     action_results += "]";
 
-    return std::string("{")
-        + "\"mode\":\"summary\","
-        + "\"user_message\":\"" + json_escape(user_msg) + "\","
-        + "\"conversation\":" + conv_to_json(conv) + ","
-        + "\"action_results\":" + action_results
-        + "}";
+    std::string out = "{\"mode\":\"summary\",";
+    if (!conv_id.empty()) {
+        out += "\"conv_id\":\"" + json_escape(conv_id) + "\","
+               "\"conv_new\":" + std::to_string(conv.size() - conv_from) + ",";
+    }
+    if (!ctx.summary.empty()) {
+        out += "\"context_summary\":\"" + json_escape(ctx.summary) + "\",";
+    }
+    out += "\"user_message\":\"" + json_escape(user_msg) + "\","
+           "\"conversation\":" + conv_to_json(ctx, conv_from) + ","
+           "\"action_results\":" + action_results
+           + "}";
+    return out;
 }
 
 // ---- Main REPL ----
@@ -518,6 +1002,9 @@ int cmd_chat(int argc, char** argv) {
     PluginManager plugin_mgr;
     RunnerRegistrar registrar{reg, runner, false};
     setup_runtime(reg, runner, plugin_mgr, registrar, root);
+    // Session-long process: toolpack manifest edits are picked up between
+    // goal actions instead of requiring a restart.
+    ManifestHotReload manifest_reload;
 
     // GoalRegistry
     GoalRegistry goal_reg;
@@ -553,8 +1040,14 @@ int cmd_chat(int argc, char** argv) {
     const char* chat_cmd_env = std::getenv("MACHINA_CHAT_CMD");
     std::string chat_cmd = chat_cmd_env ? chat_cmd_env : default_chat_cmd;
 
-    // Conversation history
-    std::vector<ConvMessage> conversation;
+    // Conversation history with token accounting; over-budget turns fold
+    // into ctx.summary instead of vanishing (see fold_conversation).
+    ConvContext ctx;
+    auto push_msg = [&](const char* role, const std::string& content) {
+        ctx.messages.push_back({role, content, estimate_tokens(content)});
+        ctx.seq++;
+        fold_conversation(ctx, runner);
+    };
 
     std::cout << "Machina Trinity Chat (type /quit to exit)\n";
     std::cout << "  selector: " << selector_backend << "\n";
@@ -580,24 +1073,26 @@ int cmd_chat(int argc, char** argv) {
         if (line == "/quit" || line == "/exit" || line == "/q") break;
 
         // Add to conversation
-        conversation.push_back({"user", line});
-        trim_conversation(conversation);
+        push_msg("user", line);
 
         // Phase 1: LLM Intent parsing
-        std::string intent_payload = build_intent_payload(
-            line, conversation, reg, goal_reg, selector_backend);
-        std::string intent_response = call_chat_driver(chat_cmd, intent_payload, root);
+        std::string intent_response = call_chat_driver_conv(
+            chat_cmd, root, ctx,
+            [&](size_t conv_from, const std::string& conv_id) {
+                return build_intent_payload(line, ctx, conv_from, conv_id,
+                                            reg, goal_reg, selector_backend);
+            });
         ChatIntent intent = parse_intent(intent_response);
 
         // Fallback if LLM failed
         if (intent.type.empty()) {
-            intent = detect_pattern(line, reg, goal_reg);
+            intent = detect_pattern(line, root);
         }
 
         // Phase 2: Handle by type
         if (intent.type == "reply") {
             std::cout << "\n" << intent.content << "\n\n";
-            conversation.push_back({"assistant", intent.content});
+            push_msg("assistant", intent.content);
             ops++;
             continue;
         }
@@ -621,7 +1116,7 @@ int cmd_chat(int argc, char** argv) {
                 }
             }
             std::cout << "\n" << intent.content << "\n\n";
-            conversation.push_back({"assistant", intent.content});
+            push_msg("assistant", intent.content);
             ops++;
             continue;
         }
@@ -641,7 +1136,7 @@ int cmd_chat(int argc, char** argv) {
                         continue;
                     }
                     auto r = run_goal_action(reg, runner, goal_reg, selector.get(),
-                                             plugin_mgr, registrar, root,
+                                             plugin_mgr, registrar, manifest_reload, root,
                                              action.goal_id, action.inputs_json, action.tags);
                     results.push_back(std::move(r));
                 } else if (action.kind == "tool") {
@@ -656,8 +1151,11 @@ int cmd_chat(int argc, char** argv) {
 
             // Phase 4: Summary
             if (intent.needs_summary && !results.empty()) {
-                std::string summary_payload = build_summary_payload(line, conversation, results);
-                std::string summary_response = call_chat_driver(chat_cmd, summary_payload, root);
+                std::string summary_response = call_chat_driver_conv(
+                    chat_cmd, root, ctx,
+                    [&](size_t conv_from, const std::string& conv_id) {
+                        return build_summary_payload(line, ctx, conv_from, conv_id, results);
+                    });
                 auto summary_content = json_mini::get_string(summary_response, "content");
                 std::string summary = summary_content.value_or("");
                 if (summary.empty()) {
@@ -668,7 +1166,7 @@ int cmd_chat(int argc, char** argv) {
                     }
                 }
                 std::cout << "\n" << summary << "\n\n";
-                conversation.push_back({"assistant", summary});
+                push_msg("assistant", summary);
             } else {
                 // No summary needed — print results directly
                 for (const auto& r : results) {
@@ -680,7 +1178,7 @@ int cmd_chat(int argc, char** argv) {
                 std::string msg;
                 for (const auto& r : results)
                     msg += r.label + ": " + (r.success ? "OK" : "FAIL") + ". ";
-                conversation.push_back({"assistant", msg});
+                push_msg("assistant", msg);
             }
         }
 
@@ -12,33 +12,67 @@
 #include "machina/tx.h"
 #include "machina/tools.h"
 #include "machina/json_mini.h"
+#include "machina/thread_pool.h"
+#include "machina/wal_reader.h"
 
 #include <json-c/json.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <map>
+#include <vector>
 
 using namespace machina;
 
+namespace {
+
+// Shared --jobs parsing for the replay commands. 1 (the default) keeps the
+// historical single-threaded path; 0 means "hardware concurrency".
+int parse_jobs_flag(int argc, char** argv, int first) {
+    int jobs = 1;
+    for (int i = first; i < argc; i++) {
+        if (std::string(argv[i]) == "--jobs" && i + 1 < argc) {
+            jobs = std::atoi(argv[++i]);
+            if (jobs < 0) jobs = 1;
+            if (jobs == 0) jobs = (int)std::thread::hardware_concurrency();
+            if (jobs < 1) jobs = 1;
+            if (jobs > 64) jobs = 64;
+        }
+    }
+    return jobs;
+}
+
+} // namespace
+
 int cmd_replay(int argc, char** argv) {
     if (argc < 3) {
-        std::cerr << "usage: machina_cli replay <run_log.jsonl>\n";
+        std::cerr << "usage: machina_cli replay <run_log.jsonl> [--jobs N]\n";
         std::cerr << "tip: use replay_strict for deterministic re-execution.\n";
         return 2;
     }
     std::string logp = argv[2];
-    std::ifstream f(logp);
-    if (!f) { std::cerr << "cannot open log: " << logp << "\n"; return 2; }
-
-    bool has_menu=false, has_pick=false;
-    std::string line;
-    while (std::getline(f, line)) {
-        if (line.find("\"event\":\"menu_built\"") != std::string::npos) has_menu = true;
-        if (line.find("\"event\":\"selector_chosen\"") != std::string::npos) has_pick = true;
+    const int jobs = parse_jobs_flag(argc, argv, 3);
+    machina::WalReader reader{std::filesystem::path(logp)};
+    std::string rerr = reader.open();
+    if (!rerr.empty()) { std::cerr << "cannot open log: " << logp << " (" << rerr << ")\n"; return 2; }
+
+    std::atomic<bool> has_menu{false}, has_pick{false};
+    auto scan = [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) {
+            std::string_view line = reader.record(i);
+            if (line.find("\"event\":\"menu_built\"") != std::string_view::npos) has_menu.store(true);
+            if (line.find("\"event\":\"selector_chosen\"") != std::string_view::npos) has_pick.store(true);
+        }
+    };
+    if (jobs > 1 && reader.record_count() > 1024) {
+        ThreadPool pool((size_t)jobs);
+        pool.parallel_for(0, reader.record_count(), scan);
+    } else {
+        scan(0, reader.record_count());
     }
-    if (!has_menu || !has_pick) {
+    if (!has_menu.load() || !has_pick.load()) {
         std::cout << "REPLAY FAIL: missing required events\n";
         return 1;
     }
@@ -48,10 +82,11 @@ int cmd_replay(int argc, char** argv) {
 
 int cmd_replay_strict(int argc, char** argv) {
     if (argc < 4) {
-        std::cerr << "usage: machina_cli replay_strict <run_request.json> <run_log.jsonl>\n";
+        std::cerr << "usage: machina_cli replay_strict <run_request.json> <run_log.jsonl> [--jobs N]\n";
         return 2;
     }
 
+    const int jobs = parse_jobs_flag(argc, argv, 4);
     const auto root = resolve_root(argv[0]);
 
     std::filesystem::path req_path = std::filesystem::path(argv[2]);
@@ -103,43 +138,97 @@ int cmd_replay_strict(int argc, char** argv) {
 
     std::map<int, StepLog> steps;
 
-    std::string line;
-    while (std::getline(f, line)) {
-        int step = (int)machina::json_mini::get_int(line, "step").value_or(-1);
-        if (step < 0) continue;
-        auto ev = machina::json_mini::get_string(line, "event").value_or("");
+    // Record decoding splits in two so --jobs can parallelize the JSON
+    // field extraction (the bulk of the parse cost on long logs) while a
+    // sequencer merges events into the step map in original line order —
+    // later events must still win exactly as in the sequential path.
+    struct DecodedEvent {
+        int step{-1};
+        std::string ev;
+        std::string menu_digest, state_digest;                 // menu_built
+        std::string raw, control_mode, selector_backend;       // selector_chosen
+        std::string patched_inputs;                            // inputs_patched
+        std::string aid, ds_digest, tx_patch, rip_fp, rip_gpu; // tool_ok
+        bool det{true};
+        std::string ask_ds_digest;                             // ask_sup
+    };
+
+    auto decode_event = [](const std::string& line) -> DecodedEvent {
+        DecodedEvent d;
+        d.step = (int)machina::json_mini::get_int(line, "step").value_or(-1);
+        if (d.step < 0) return d;
+        d.ev = machina::json_mini::get_string(line, "event").value_or("");
         auto payload = machina::json_mini::get_object_raw(line, "payload").value_or("{}");
+        if (d.ev == "menu_built") {
+            d.menu_digest = machina::json_mini::get_string(payload, "menu_digest").value_or("");
+            d.state_digest = machina::json_mini::get_string(payload, "state_digest").value_or("");
+        } else if (d.ev == "selector_chosen") {
+            d.raw = machina::json_mini::get_string(payload, "raw").value_or("");
+            d.control_mode = machina::json_mini::get_string(payload, "control_mode").value_or("");
+            d.selector_backend = machina::json_mini::get_string(payload, "selector_backend").value_or("");
+        } else if (d.ev == "inputs_patched") {
+            d.patched_inputs = machina::json_mini::get_object_raw(payload, "inputs").value_or("{}");
+        } else if (d.ev == "tool_ok") {
+            d.aid = machina::json_mini::get_string(payload, "aid").value_or("");
+            d.ds_digest = machina::json_mini::get_string(payload, "ds_digest").value_or("");
+            d.tx_patch = machina::json_mini::get_array_raw(payload, "tx_patch").value_or("[]");
+            auto rip = machina::json_mini::get_object_raw(payload, "replay_inputs").value_or("{}");
+            d.rip_fp = machina::json_mini::get_string(rip, "input_path_fingerprint").value_or("");
+            d.rip_gpu = machina::json_mini::get_string(rip, "gpu_signature").value_or("");
+            d.det = machina::json_mini::get_bool(payload, "deterministic").value_or(true);
+        } else if (d.ev == "ask_sup") {
+            d.ask_ds_digest = machina::json_mini::get_string(payload, "ds_digest").value_or("");
+        }
+        return d;
+    };
 
-        StepLog& s = steps[step];
-        if (ev == "menu_built") {
+    auto merge_event = [&](const DecodedEvent& d) {
+        if (d.step < 0) return;
+        StepLog& s = steps[d.step];
+        if (d.ev == "menu_built") {
             s.has_menu = true;
-            s.menu_digest = machina::json_mini::get_string(payload, "menu_digest").value_or("");
-            s.state_digest = machina::json_mini::get_string(payload, "state_digest").value_or("");
-        } else if (ev == "selector_chosen") {
+            s.menu_digest = d.menu_digest;
+            s.state_digest = d.state_digest;
+        } else if (d.ev == "selector_chosen") {
             s.has_choice = true;
-            s.raw = machina::json_mini::get_string(payload, "raw").value_or("");
-            s.control_mode = machina::json_mini::get_string(payload, "control_mode").value_or("");
-            s.selector_backend = machina::json_mini::get_string(payload, "selector_backend").value_or("");
-        } else if (ev == "inputs_patched") {
+            s.raw = d.raw;
+            s.control_mode = d.control_mode;
+            s.selector_backend = d.selector_backend;
+        } else if (d.ev == "inputs_patched") {
             s.has_inputs_patched = true;
-            s.patched_inputs = machina::json_mini::get_object_raw(payload, "inputs").value_or("{}");
-        } else if (ev == "tool_ok") {
+            s.patched_inputs = d.patched_inputs;
+        } else if (d.ev == "tool_ok") {
             s.has_tool_ok = true;
-            s.tool_ok_aid = machina::json_mini::get_string(payload, "aid").value_or("");
-            s.tool_ok_ds_digest = machina::json_mini::get_string(payload, "ds_digest").value_or("");
-            s.tool_ok_tx_patch = machina::json_mini::get_array_raw(payload, "tx_patch").value_or("[]");
-            auto rip = machina::json_mini::get_object_raw(payload, "replay_inputs").value_or("{}");
-            s.tool_ok_replay_input_path_fingerprint = machina::json_mini::get_string(rip, "input_path_fingerprint").value_or("");
-            s.tool_ok_replay_gpu_signature = machina::json_mini::get_string(rip, "gpu_signature").value_or("");
-            s.tool_ok_det = machina::json_mini::get_bool(payload, "deterministic").value_or(true);
-        } else if (ev == "ask_sup") {
+            s.tool_ok_aid = d.aid;
+            s.tool_ok_ds_digest = d.ds_digest;
+            s.tool_ok_tx_patch = d.tx_patch;
+            s.tool_ok_replay_input_path_fingerprint = d.rip_fp;
+            s.tool_ok_replay_gpu_signature = d.rip_gpu;
+            s.tool_ok_det = d.det;
+        } else if (d.ev == "ask_sup") {
             s.has_ask_sup = true;
-            s.ask_ds_digest = machina::json_mini::get_string(payload, "ds_digest").value_or("");
-        } else if (ev == "noop") {
+            s.ask_ds_digest = d.ask_ds_digest;
+        } else if (d.ev == "noop") {
             s.has_noop = true;
-        } else if (ev == "goal_done") {
+        } else if (d.ev == "goal_done") {
             s.has_goal_done = true;
         }
+    };
+
+    {
+        std::string line;
+        if (jobs > 1) {
+            std::vector<std::string> lines;
+            while (std::getline(f, line)) lines.push_back(std::move(line));
+            std::vector<DecodedEvent> decoded(lines.size());
+            ThreadPool pool((size_t)jobs);
+            pool.parallel_for(0, lines.size(), [&](size_t b, size_t e) {
+                for (size_t i = b; i < e; i++) decoded[i] = decode_event(lines[i]);
+            });
+            for (const auto& d : decoded) merge_event(d);
+        } else {
+            while (std::getline(f, line)) merge_event(decode_event(line));
+        }
     }
 
     if (steps.empty()) {
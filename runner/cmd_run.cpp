@@ -15,11 +15,16 @@
 #include "machina/json_mini.h"
 #include "machina/hash.h"
 #include "machina/goal_registry.h"
+#include "machina/pacing.h"
+#include "machina/trace.h"
 
 #include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <unordered_map>
+
+// Short alias for the typed step_event fields used throughout the run loop.
+using LF = machina::LogField;
 #include <unordered_set>
 
 using namespace machina;
@@ -148,6 +153,20 @@ int cmd_run(int argc, char** argv) {
     // Init state
     DSState state;
     Budget budget;
+    {
+        // Per-request budget overrides; MACHINA_BUDGET_MS supplies a wall
+        // clock when the request does not carry one.
+        auto braw = machina::json_mini::get_object_raw(req, "budget").value_or("");
+        if (!braw.empty()) {
+            budget.max_steps = (int)machina::json_mini::get_int(braw, "max_steps").value_or(budget.max_steps);
+            budget.max_invalid_picks = (int)machina::json_mini::get_int(braw, "max_invalid_picks").value_or(budget.max_invalid_picks);
+            budget.max_ms = (int)machina::json_mini::get_int(braw, "max_ms").value_or(budget.max_ms);
+        }
+        if (budget.max_ms <= 0) {
+            budget.max_ms = runner_detail::getenv_int("MACHINA_BUDGET_MS", 0);
+        }
+    }
+    BudgetPacer pacer(budget);
 
     auto has_slot = [&](DSSlot s) -> bool {
         return state.slots.find((uint8_t)s) != state.slots.end();
@@ -181,7 +200,26 @@ int cmd_run(int argc, char** argv) {
     // Loop guard
     std::unordered_map<std::string, int> loop_guard;
 
+    // Menu reused across steps: rebuilding is only needed when the tag set
+    // or the registry changes (plugin reload, in-run genesis load), which
+    // the registry generation counter detects. Reuse also keeps the menu's
+    // memoized digest warm, so steady-state steps skip the rehash entirely.
+    Menu menu;
+    std::string menu_tags_key;
+    uint64_t menu_generation = 0;
+    bool menu_built = false;
+
+    // Toolpack manifest edits land between steps without a restart; the
+    // generation bump from a swap invalidates the cached menu above.
+    ManifestHotReload manifest_reload;
+
     for (int step = 0; step < budget.max_steps; step++) {
+        if (pacer.exhausted()) {
+            log.event(step, "breaker", "{\"reason\":\"budget_ms\"}", /*payload_is_canonical=*/true);
+            std::cout << "RUN END: breaker(budget_ms)\n";
+            std::cout << "log: " << log.path() << "\n";
+            return 1;
+        }
         const bool ds0 = has_slot(DSSlot::DS0);
         const bool ds2 = has_slot(DSSlot::DS2);
         const bool ds6 = has_slot(DSSlot::DS6);
@@ -208,6 +246,15 @@ int cmd_run(int argc, char** argv) {
             }
         }
 
+        // Toolpack manifest hot-reload (content-hash diff per manifest)
+        {
+            size_t swapped = manifest_reload.poll(reg, root);
+            if (swapped > 0) {
+                log.event(step, "toolpack_reload",
+                          "{\"swapped\":" + std::to_string(swapped) + "}");
+            }
+        }
+
         // Expand candidate tags based on current state
         std::vector<std::string> step_tags = tags;
         if (goal_id.rfind("goal.GENESIS", 0) == 0) {
@@ -219,12 +266,18 @@ int cmd_run(int argc, char** argv) {
         step_tags = dedup_tags(std::move(step_tags));
         std::string step_tags_raw = json_array_compact(step_tags);
 
-        // Build menu
-        Menu menu = build_menu_from_registry(reg, step_tags);
+        // Build menu (skipped while tags and registry generation are unchanged)
+        if (!menu_built || menu_tags_key != step_tags_raw || menu_generation != reg.generation()) {
+            MACHINA_TRACE_SPAN("menu_build");
+            menu = build_menu_from_registry(reg, step_tags);
 
-        // Apply per-request capability restrictions
-        if (!cap_allowed.empty() || !cap_blocked.empty()) {
-            menu = filter_menu_by_capabilities(menu, cap_allowed, cap_blocked);
+            // Apply per-request capability restrictions
+            if (!cap_allowed.empty() || !cap_blocked.empty()) {
+                menu = filter_menu_by_capabilities(menu, cap_allowed, cap_blocked);
+            }
+            menu_tags_key = step_tags_raw;
+            menu_generation = reg.generation();
+            menu_built = true;
         }
 
         // Digests
@@ -237,12 +290,11 @@ int cmd_run(int argc, char** argv) {
             std::string lk = menu_digest_fast + "|" + state_digest_fast;
             int c = ++loop_guard[lk];
             if (c > 3) {
-                log.event(step, "loop_guard_triggered",
-                          "{"
-                          "\"count\":" + std::to_string(c) + ","
-                          "\"menu_digest_fast\":\"" + json_escape(menu_digest_fast) + "\","
-                          "\"state_digest_fast\":\"" + json_escape(state_digest_fast) + "\""
-                          "}");
+                log.step_event(step, "loop_guard_triggered", {
+                    LF::i64("count", c),
+                    LF::str("menu_digest_fast", menu_digest_fast),
+                    LF::str("state_digest_fast", state_digest_fast),
+                });
                 break;
             }
         }
@@ -257,25 +309,28 @@ int cmd_run(int argc, char** argv) {
         std::string goal_context = goal_id + "|" + flags;
         for (auto& t : step_tags) goal_context += "|" + t;
 
-        log.event(step, "menu_built",
-                  "{"
-                  "\"goal_id\":\"" + json_escape(goal_id) + "\","
-                  "\"candidate_tags\":" + step_tags_raw + ","
-                  "\"base_candidate_tags\":" + candidate_tags_raw + ","
-                  "\"selector_backend\":\"" + json_escape(selector_backend) + "\","
-                  "\"flags\":\"" + json_escape(flags) + "\","
-                  "\"menu_digest\":\"" + json_escape(menu_digest) + "\","
-                  "\"menu_digest_fast\":\"" + json_escape(menu_digest_fast) + "\","
-                  "\"state_digest\":\"" + json_escape(state_digest) + "\","
-                  "\"state_digest_fast\":\"" + json_escape(state_digest_fast) + "\""
-                  "}");
+        log.step_event(step, "menu_built", {
+            LF::str("goal_id", goal_id),
+            LF::raw("candidate_tags", step_tags_raw),
+            LF::raw("base_candidate_tags", candidate_tags_raw),
+            LF::str("selector_backend", selector_backend),
+            LF::str("flags", flags),
+            LF::str("menu_digest", menu_digest),
+            LF::str("menu_digest_fast", menu_digest_fast),
+            LF::str("state_digest", state_digest),
+            LF::str("state_digest_fast", state_digest_fast),
+        });
 
         // ControlMode plumbing
-        Selection fallback = selector->select(menu, goal_context, state_digest, ControlMode::FALLBACK_ONLY, inputs);
-        Selection policy = selector->select(menu, goal_context, state_digest, ControlMode::POLICY_ONLY, inputs);
+        Selection fallback, policy;
+        {
+            MACHINA_TRACE_SPAN("selector_select");
+            fallback = selector->select(menu, goal_context, state_digest, ControlMode::FALLBACK_ONLY, inputs);
+            policy = selector->select(menu, goal_context, state_digest, ControlMode::POLICY_ONLY, inputs);
+        }
 
-        log.event(step, "selector_fallback_raw", "{\"raw\":\"" + json_escape(fallback.raw) + "\"}");
-        log.event(step, "selector_policy_raw", "{\"raw\":\"" + json_escape(policy.raw) + "\"}");
+        log.step_event(step, "selector_fallback_raw", {LF::str("raw", fallback.raw)});
+        log.step_event(step, "selector_policy_raw", {LF::str("raw", policy.raw)});
 
         Selection picked;
         switch (mode) {
@@ -296,26 +351,28 @@ int cmd_run(int argc, char** argv) {
             if (psel) selector_path = psel->last_backend();
         }
 
-        log.event(step, "selector_chosen",
-                  "{"
-                  "\"control_mode\":\"" + json_escape(machina::json_mini::get_string(req, "control_mode").value_or("FALLBACK_ONLY")) + "\","
-                  "\"selector_backend\":\"" + json_escape(selector_backend) + "\","
-                  "\"selector_path\":\"" + json_escape(selector_path) + "\","
-                  "\"raw\":\"" + json_escape(picked.raw) + "\""
-                  "}");
+        log.step_event(step, "selector_chosen", {
+            LF::str("control_mode", machina::json_mini::get_string(req, "control_mode").value_or("FALLBACK_ONLY")),
+            LF::str("selector_backend", selector_backend),
+            LF::str("selector_path", selector_path),
+            LF::str("raw", picked.raw),
+        });
 
         // Optional input patch from selector (safe: blocks _system/_queue/_meta keys)
         if (picked.kind == Selection::Kind::PICK && picked.input_patch_json) {
             std::string merged = safe_merge_patch(inputs, *picked.input_patch_json);
-            log.event(step, "inputs_patched", "{\"patch\":" + *picked.input_patch_json + ",\"inputs\":" + merged + "}");
+            log.step_event(step, "inputs_patched", {
+                LF::raw("patch", *picked.input_patch_json),
+                LF::raw("inputs", merged),
+            });
             inputs = merged;
         }
 
         if (picked.kind == Selection::Kind::INVALID) {
             invalid++;
-            log.event(step, "invalid_pick", "{\"count\":" + std::to_string(invalid) + "}");
+            log.step_event(step, "invalid_pick", {LF::i64("count", invalid)});
             if (invalid > budget.max_invalid_picks) {
-                log.event(step, "breaker", "{\"reason\":\"max_invalid_picks\"}");
+                log.event(step, "breaker", "{\"reason\":\"max_invalid_picks\"}", /*payload_is_canonical=*/true);
                 std::cout << "RUN END: breaker(max_invalid_picks)\n";
                 std::cout << "log: " << log.path() << "\n";
                 return 1;
@@ -324,7 +381,7 @@ int cmd_run(int argc, char** argv) {
         }
 
         if (picked.kind == Selection::Kind::NOOP) {
-            log.event(step, "noop", "{}");
+            log.event(step, "noop", "{}", /*payload_is_canonical=*/true);
             std::cout << "RUN END: noop\n";
             std::cout << "log: " << log.path() << "\n";
             return 0;
@@ -338,14 +395,13 @@ int cmd_run(int argc, char** argv) {
             auto t1 = std::chrono::steady_clock::now();
             auto dur_ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
             if (res.status == StepStatus::OK) tx.commit(state);
-            log.event(step, "ask_sup",
-                      "{"
-                      "\"status\":\"ok\","
-                      "\"duration_ms\":" + std::to_string(dur_ms) + ","
-                      "\"ds_digest\":\"" + json_escape(state.digest()) + "\","
-                      "\"ds_digest_fast\":\"" + json_escape(state.digest_fast()) + "\","
-                      "\"tx_patch\":" + tx.patch_json() +
-                      "}");
+            log.step_event(step, "ask_sup", {
+                LF::str("status", "ok"),
+                LF::i64("duration_ms", dur_ms),
+                LF::str("ds_digest", state.digest()),
+                LF::str("ds_digest_fast", state.digest_fast()),
+                LF::raw("tx_patch", tx.patch_json()),
+            });
             std::cout << "RUN END: ask_sup (stored)\n";
             std::cout << "log: " << log.path() << "\n";
             return 0;
@@ -357,9 +413,13 @@ int cmd_run(int argc, char** argv) {
         // ---- Phase 3: SID hallucination fallback (Layer 2) ----
         if (!mi) {
             invalid++;
-            log.event(step, "invalid_pick", "{\"reason\":\"sid_not_in_menu\",\"sid\":\"" + json_escape(picked.sid->toString()) + "\",\"count\":" + std::to_string(invalid) + "}");
+            log.step_event(step, "invalid_pick", {
+                LF::str("reason", "sid_not_in_menu"),
+                LF::str("sid", picked.sid->toString()),
+                LF::i64("count", invalid),
+            });
             if (invalid > budget.max_invalid_picks) {
-                log.event(step, "breaker", "{\"reason\":\"max_invalid_picks\"}");
+                log.event(step, "breaker", "{\"reason\":\"max_invalid_picks\"}", /*payload_is_canonical=*/true);
                 std::cout << "RUN END: breaker(max_invalid_picks)\n";
                 std::cout << "log: " << log.path() << "\n";
                 return 1;
@@ -376,24 +436,38 @@ int cmd_run(int argc, char** argv) {
             replay_inputs_json = replay_inputs_to_json(*td, inputs, request_dir, root);
         }
 
+        // Budget pacing: under pressure, cap subprocess timeouts to a share
+        // of the remaining wall clock and hand scan tools a k_scale hint so
+        // late steps run cheaper instead of blowing the budget mid-goal.
+        std::string run_inputs = inputs;
+        {
+            runner.setTimeoutCapMs(pacer.timeout_cap_ms());
+            if (pacer.pressure() >= BudgetPacer::kPressureFloor) {
+                std::string hints = pacer.hints_json();
+                run_inputs = shallow_merge_json_objects(inputs,
+                    "{\"_system_budget\":" + hints + "}");
+                log.event(step, "budget_pacing", hints, /*payload_is_canonical=*/true);
+            }
+        }
+
         // Run tool in transaction
         Tx tx(state);
         auto t0 = std::chrono::steady_clock::now();
-        auto tool_res = runner.run(mi->aid, inputs, tx.tmp());
+        auto tool_res = runner.run(mi->aid, run_inputs, tx.tmp());
         auto t1 = std::chrono::steady_clock::now();
         auto dur_ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+        pacer.note_step(dur_ms);
         if (tool_res.status == StepStatus::OK) {
             tx.commit(state);
-            log.event(step, "tool_ok",
-                      "{"
-                      "\"aid\":\"" + json_escape(mi->aid) + "\","
-                      "\"deterministic\":" + std::string(det ? "true" : "false") + ","
-                      "\"duration_ms\":" + std::to_string(dur_ms) + ","
-                      "\"replay_inputs\":" + replay_inputs_json + ","
-                      "\"ds_digest\":\"" + json_escape(state.digest()) + "\","
-                      "\"ds_digest_fast\":\"" + json_escape(state.digest_fast()) + "\","
-                      "\"tx_patch\":" + tx.patch_json() +
-                      "}");
+            log.step_event(step, "tool_ok", {
+                LF::str("aid", mi->aid),
+                LF::boolean("deterministic", det),
+                LF::i64("duration_ms", dur_ms),
+                LF::raw("replay_inputs", replay_inputs_json),
+                LF::str("ds_digest", state.digest()),
+                LF::str("ds_digest_fast", state.digest_fast()),
+                LF::raw("tx_patch", tx.patch_json()),
+            });
         } else {
             // Capture compile error from tmp state before rollback invalidates it
             std::string compile_error_json;
@@ -404,14 +478,13 @@ int cmd_run(int argc, char** argv) {
                 }
             }
             tx.rollback();
-            log.event(step, "tool_error",
-                      "{"
-                      "\"aid\":\"" + json_escape(mi->aid) + "\","
-                      "\"deterministic\":" + std::string(det ? "true" : "false") + ","
-                      "\"duration_ms\":" + std::to_string(dur_ms) + ","
-                      "\"replay_inputs\":" + replay_inputs_json + ","
-                      "\"err\":\"" + json_escape(tool_res.error) + "\""
-                      "}");
+            log.step_event(step, "tool_error", {
+                LF::str("aid", mi->aid),
+                LF::boolean("deterministic", det),
+                LF::i64("duration_ms", dur_ms),
+                LF::raw("replay_inputs", replay_inputs_json),
+                LF::str("err", tool_res.error),
+            });
 
             // ---- Phase 4: Genesis compile error retry ----
             if (mi->aid == "AID.GENESIS.COMPILE_SHARED.v1") {
@@ -448,7 +521,7 @@ int cmd_run(int argc, char** argv) {
                         + "\"ts_ms\":" + std::to_string(now_ms_i64())
                         + "}";
                     a.size_bytes = a.content_json.size();
-                    tdx.tmp().slots[(uint8_t)DSSlot::DS6] = a;
+                    tdx.tmp().slots[(uint8_t)DSSlot::DS6] = std::move(a);
                     tdx.commit(state);
                 }
 
@@ -539,7 +612,7 @@ int cmd_run(int argc, char** argv) {
 
         // ---- Phase 2: GoalRegistry-based completion check ----
         if (goal_reg.isGoalComplete(goal_id, state)) {
-            log.event(step, "goal_done", "{\"goal_id\":\"" + json_escape(goal_id) + "\"}");
+            log.step_event(step, "goal_done", {LF::str("goal_id", goal_id)});
             std::cout << "RUN END: goal_done " << goal_id << "\n";
             // Print all occupied slot artifacts
             for (const auto& kv : state.slots) {
@@ -552,7 +625,7 @@ int cmd_run(int argc, char** argv) {
         // Continue to next step
     }
 
-    log.event(budget.max_steps, "breaker", "{\"reason\":\"max_steps\"}");
+    log.event(budget.max_steps, "breaker", "{\"reason\":\"max_steps\"}", /*payload_is_canonical=*/true);
     std::cout << "RUN END: breaker(max_steps)\n";
     std::cout << "log: " << log.path() << "\n";
     return 1;
@@ -2,15 +2,32 @@
 #include "cmd_run.h"
 #include "runner_utils.h"
 #include "serve_http.h"
+#include "serve_tool_sock.h"
 #include "tool_setup.h"
 
 #include "machina/types.h"
+#include "machina/embedding_provider.h"
+#include "machina/goal_registry.h"
 #include "machina/json_mini.h"
+#include "machina/selector.h"
+#include "machina/state.h"
 #include "machina/cpq.h"
+#include "machina/fast_rand.h"
+#include "machina/gpu_sampler.h"
+#include "machina/selector_gpu.h"
+#include "machina/notify.h"
+#include "machina/timer_wheel.h"
 #include "machina/wal.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -20,8 +37,151 @@
 
 #ifndef _WIN32
 
+#include <fcntl.h>
+#include <poll.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+#include <sys/uio.h>
+
+#include "tools/tier0/vectordb_tools.h"
+
 using namespace machina;
 
+// Warm-start phase (--warmup): runs the lazy-init chain — tool manifests,
+// plugin preloads, goal registry, selector centroid builds, vecdb stream
+// opens, embed provider spin-up — before the listen socket exists, so the
+// health check only answers once the hot paths are warm instead of the
+// first unlucky requests paying for them. The manifest (default
+// policies/warmup.json, optional) narrows what gets warmed:
+//   {"goals":[{"goal_id":"goal.X","candidate_tags":["tag.a"]}],
+//    "vecdb_streams":["default"],
+//    "embed_texts":["ping"],"embed_dim":384}
+// With no manifest every registered goal's menu is warmed and the embed
+// provider gets one priming call. Always best-effort: a failed stage just
+// stays cold.
+static void run_serve_warmup(const std::filesystem::path& root,
+                             const std::filesystem::path& manifest_path) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    // Tool manifests + tier0 registration + plugin preloads, exactly as a
+    // worker's first job would do them.
+    Registry reg;
+    ToolRunner runner;
+    PluginManager plugin_mgr;
+    RunnerRegistrar registrar(reg, runner);
+    try {
+        setup_runtime(reg, runner, plugin_mgr, registrar, root);
+    } catch (...) {
+        // keep going: the remaining stages warm what they can
+    }
+
+    GoalRegistry goal_reg;
+    {
+        std::error_code ec;
+        auto gp_dir = root / "goalpacks";
+        if (std::filesystem::exists(gp_dir, ec)) {
+            for (auto& entry : std::filesystem::directory_iterator(gp_dir, ec)) {
+                if (ec) break;
+                if (!entry.is_directory(ec)) continue;
+                auto manifest = entry.path() / "manifest.json";
+                if (std::filesystem::exists(manifest, ec)) {
+                    try { goal_reg.loadGoalPackManifest(manifest.string()); } catch (...) {}
+                }
+            }
+        }
+    }
+
+    // Warmup manifest (optional): goals to prebuild centroids for, vecdb
+    // streams to open, texts to push through the embed provider.
+    struct WarmGoal { std::string goal_id; std::vector<std::string> tags; };
+    std::vector<WarmGoal> goals;
+    std::vector<std::string> vecdb_streams;
+    std::vector<std::string> embed_texts;
+    size_t embed_dim = (size_t)runner_detail::getenv_int("MACHINA_VECDB_DIM", 384);
+    {
+        std::error_code ec;
+        if (std::filesystem::exists(manifest_path, ec)) {
+            try {
+                std::string mj = slurp(manifest_path.string());
+                json_mini::Cursor c(mj);
+                auto goals_raw = c.get_array_raw("goals").value_or("");
+                for (const auto& graw : json_mini::parse_array_objects_raw(goals_raw)) {
+                    WarmGoal g;
+                    g.goal_id = json_mini::get_string(graw, "goal_id").value_or("");
+                    g.tags = json_mini::get_array_strings(graw, "candidate_tags");
+                    if (!g.goal_id.empty()) goals.push_back(std::move(g));
+                }
+                vecdb_streams = c.get_array_strings("vecdb_streams");
+                embed_texts = c.get_array_strings("embed_texts");
+                int64_t d = c.get_int("embed_dim").value_or((int64_t)embed_dim);
+                if (d >= 16 && d <= 1024) embed_dim = (size_t)d;
+            } catch (...) {}
+        }
+    }
+    if (goals.empty()) {
+        for (const auto& gid : goal_reg.allGoalIds()) {
+            const GoalDesc* gd = goal_reg.getGoal(gid);
+            if (gd) goals.push_back(WarmGoal{gid, gd->candidate_tags});
+        }
+    }
+
+    // Selector: reproduce the step-0 menu and goal_context (all-zero FLAGS,
+    // tag.meta, genesis tags) so GPU_CENTROID caches land on the keys
+    // cmd_run will ask for. FALLBACK_ONLY never triggers an external
+    // policy process; the heuristic backend warms the menu build path only.
+    std::string selector_backend = "HEURISTIC";
+    if (const char* sv = std::getenv("MACHINA_SELECTOR")) {
+        if (std::string(sv) == "GPU_CENTROID") selector_backend = "GPU_CENTROID";
+    }
+    size_t warmed_goals = 0;
+    try {
+        auto selector = make_selector(selector_backend, root);
+        for (const auto& g : goals) {
+            std::vector<std::string> tags = g.tags;
+            tags.push_back("tag.meta");
+            if (g.goal_id.rfind("goal.GENESIS", 0) == 0) {
+                tags.push_back("tag.genesis");
+                tags.push_back("tag.runtime");
+            }
+            std::sort(tags.begin(), tags.end());
+            tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+            std::string goal_context = g.goal_id + "|FLAGS:DS0=0;DS2=0;DS6=0;DS7=0;DS6_STAGE=;";
+            for (auto& t : tags) goal_context += "|" + t;
+            Menu menu = build_menu_from_registry(reg, tags);
+            if (menu.items.empty()) continue;
+            try {
+                selector->select(menu, goal_context, DSState{}.digest(),
+                                 ControlMode::FALLBACK_ONLY, "{}");
+                warmed_goals++;
+            } catch (...) {}
+        }
+    } catch (...) {}
+
+    // vecdb: one tiny direct query per stream loads its index files into
+    // the process caches (an absent stream is a cheap no-op).
+    size_t warmed_streams = 0;
+    for (const auto& st : vecdb_streams) {
+        std::vector<VecdbHit> hits;
+        std::string verr;
+        if (vectordb_query_direct(st, "warmup", 1, 1, nullptr, &hits,
+                                  nullptr, nullptr, &verr)) {
+            warmed_streams++;
+        }
+    }
+
+    // Embed provider: one batch call spawns the persistent session
+    // (MACHINA_EMBED_PERSIST) and fills the warm caches.
+    if (embed_texts.empty()) embed_texts.push_back("warmup");
+    try { (void)embed_texts_batch(embed_texts, embed_dim); } catch (...) {}
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    std::cerr << "[serve] warmup done in " << ms << "ms (goals=" << warmed_goals
+              << "/" << goals.size() << " vecdb_streams=" << warmed_streams
+              << " selector=" << selector_backend << ")\n";
+}
+
 int cmd_serve(int argc, char** argv) {
     // Ignore SIGPIPE: writing to disconnected clients should not crash the server
     ::signal(SIGPIPE, SIG_IGN);
@@ -33,6 +193,10 @@ int cmd_serve(int argc, char** argv) {
     std::filesystem::path q = default_queue_dir(root);
     int workers = 0;
     int scan_ms = runner_detail::getenv_int("MACHINA_SERVE_SCAN_MS", 150);
+    std::string tool_sock_path;
+    if (const char* e = std::getenv("MACHINA_TOOL_SOCK")) tool_sock_path = e;
+    bool warmup = (runner_detail::getenv_int("MACHINA_SERVE_WARMUP", 0) != 0);
+    std::filesystem::path warmup_manifest = root / "policies" / "warmup.json";
 
     for (int i = 2; i < argc; i++) {
         std::string a = argv[i];
@@ -41,6 +205,12 @@ int cmd_serve(int argc, char** argv) {
         if (a == "--queue" && i + 1 < argc) { q = argv[++i]; continue; }
         if (a == "--workers" && i + 1 < argc) { workers = std::atoi(argv[++i]); if (workers < 0) workers = 0; if (workers > 64) workers = 64; continue; }
         if (a == "--scan_ms" && i + 1 < argc) { scan_ms = std::atoi(argv[++i]); if (scan_ms < 20) scan_ms = 20; if (scan_ms > 5000) scan_ms = 5000; continue; }
+        if (a == "--tool-sock" && i + 1 < argc) { tool_sock_path = argv[++i]; continue; }
+        if (a == "--warmup") {
+            warmup = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') warmup_manifest = argv[++i];
+            continue;
+        }
     }
 
     if (!q.is_absolute()) q = root / q;
@@ -55,12 +225,37 @@ int cmd_serve(int argc, char** argv) {
     auto out = q / "out";
     auto logs = root / "logs";
 
-    machina::ConcurrentPriorityQueue<std::filesystem::path> memq;
+    // One shard per worker keeps claim contention off the feeder's pushes.
+    machina::ConcurrentPriorityQueue<std::filesystem::path> memq{(size_t)(workers > 1 ? workers : 1)};
     std::unordered_set<std::string> memq_seen;
     std::mutex memq_mu;
+
+    // Prefetch bridge: a single stage between memq (paths, priority order)
+    // and the workers. The prefetcher claims the file — the .processing
+    // rename is the crash-safe claim marker, and startup recovery already
+    // re-queues those — and reads the job JSON once, so claim I/O and the
+    // metadata read overlap with execution instead of serializing per job.
+    // The buffer is bounded: at most pref_cap jobs sit claimed-but-
+    // unstarted if the daemon dies.
+    struct PrefetchedJob { std::filesystem::path proc; std::string base; std::string body; };
+    std::deque<PrefetchedJob> prefq;
+    std::mutex pref_mu;
+    std::condition_variable pref_cv;
+    bool pref_closed = false;
+    size_t pref_cap = (size_t)runner_detail::getenv_int("MACHINA_SERVE_PREFETCH", workers > 0 ? workers * 2 : 2);
+    if (pref_cap < 1) pref_cap = 1;
     std::atomic<bool> stop_workers{false};
     std::atomic<uint64_t> jobs_processed{0}, jobs_ok{0}, jobs_fail{0};
 
+    // Webhook notifications for job lifecycle events (MACHINA_NOTIFY_WEBHOOKS).
+    // publish() is non-blocking; a slow endpoint stalls the sender thread's
+    // batches, never a worker.
+    machina::NotifyDispatcher notifier(machina::NotifyDispatcher::urls_from_env());
+
+    // Background GPU sampler: one shared-memory snapshot every interval so
+    // tools and /metrics never pay a per-call NVML query. 0 disables.
+    machina::gpu_sampler_start(runner_detail::getenv_int("MACHINA_GPU_SAMPLER_MS", 5000));
+
     // Per-tool metrics: aid → {ok_count, fail_count, total_duration_ms}
     std::mutex tool_metrics_mu;
     struct ToolMetric { uint64_t ok{0}; uint64_t fail{0}; uint64_t duration_ms{0}; };
@@ -75,9 +270,17 @@ int cmd_serve(int argc, char** argv) {
     std::filesystem::path wal_file = wal_dir / "queue.wal.jsonl";
     std::filesystem::path ckpt_file = wal_dir / "checkpoint.json";
 
+    // Results index: one appended JSONL line per completed attempt
+    // (job → status, rc, attempt, wall ms, result filename), mirrored in an
+    // in-memory map so /jobs lookups never list or stat the out/ directory.
+    std::unique_ptr<machina::Wal> ridx;
+    std::filesystem::path ridx_file = out / "index.jsonl";
+    struct ResultEntry { std::string status; int rc{0}; int attempt{1}; int64_t ms{0}; std::string result_file; };
+    std::unordered_map<std::string, ResultEntry> result_idx;
+    std::mutex result_idx_mu;
+
     struct DelayedItem { int64_t due_ms; std::filesystem::path path; std::string rest; };
-    struct DelayedCmp { bool operator()(const DelayedItem& a, const DelayedItem& b) const { return a.due_ms > b.due_ms; } };
-    std::priority_queue<DelayedItem, std::vector<DelayedItem>, DelayedCmp> delayq;
+    machina::TimerWheel<DelayedItem> delayq{now_ms_i64()};
     std::unordered_set<std::string> delay_seen;
     std::mutex delay_mu;
 
@@ -86,6 +289,10 @@ int cmd_serve(int argc, char** argv) {
     std::mutex dedup_mu;
     const int64_t dedup_ttl_ms = getenv_i64("MACHINA_DEDUP_TTL_MS", 300000); // 5 min default
 
+    // Warm the hot paths before the listen socket exists: a health checker
+    // polling the port sees connection refused until warmup finishes.
+    if (warmup) run_serve_warmup(root, warmup_manifest);
+
     // Create server socket BEFORE starting worker threads, so that failures here
     // don't leave running threads dangling (which would std::terminate on destruction).
     int sfd = ::socket(AF_INET, SOCK_STREAM, 0);
@@ -163,7 +370,7 @@ int cmd_serve(int argc, char** argv) {
             std::lock_guard<std::mutex> lk(delay_mu);
             if (delay_seen.find(key) != delay_seen.end()) return;
             delay_seen.insert(key);
-            delayq.push(DelayedItem{due_ms, pth, rest});
+            delayq.schedule(due_ms, DelayedItem{due_ms, pth, rest});
         }
         wal_emit("SCHED", std::string(",\"due_ms\":") + std::to_string(due_ms)
                         + ",\"name\":\"" + json_escape(key) + "\"");
@@ -180,12 +387,9 @@ int cmd_serve(int argc, char** argv) {
         }
         {
             std::lock_guard<std::mutex> lk(delay_mu);
-            auto tmp = delayq;
-            while (!tmp.empty()) {
-                auto it = tmp.top();
-                tmp.pop();
-                retry_items.push_back({it.due_ms, it.path.filename().string()});
-            }
+            delayq.for_each([&](int64_t due_ms, const DelayedItem& it) {
+                retry_items.push_back({due_ms, it.path.filename().string()});
+            });
         }
 
         std::ostringstream j;
@@ -240,9 +444,41 @@ int cmd_serve(int argc, char** argv) {
         return true;
     };
 
-    auto process_processing_file = [&](const std::filesystem::path& proc, const std::string& base, int wid) {
+    // Canonical job id: the enqueued filename with any ".aN" retry token
+    // stripped, so every attempt of a job lands on one index key.
+    auto job_key_of = [](std::string name) -> std::string {
+        auto a_pos = name.rfind(".a");
+        if (a_pos != std::string::npos) {
+            auto dot = name.find('.', a_pos + 2);
+            if (dot != std::string::npos && dot > a_pos + 2) {
+                bool digits = true;
+                for (size_t i = a_pos + 2; i < dot; i++) digits = digits && (name[i] >= '0' && name[i] <= '9');
+                if (digits) name.erase(a_pos, dot - a_pos);
+            }
+        }
+        return name;
+    };
+
+    auto result_index_append = [&](const std::string& base, const JobResult& jr) {
+        if (!ridx) return;
+        const char* status = (jr.exit_code == 0) ? "done"
+                           : (jr.scheduled_retry ? "retry" : (jr.deadletter ? "dlq" : "failed"));
+        std::string rfile = base + ".attempt" + std::to_string(jr.attempt) + ".result.json";
+        std::string key = job_key_of(base);
+        const int64_t ms = now_ms_wall();
+        std::ostringstream j;
+        j << "{\"job\":\"" << json_escape(key) << "\",\"status\":\"" << status
+          << "\",\"rc\":" << jr.exit_code << ",\"attempt\":" << jr.attempt
+          << ",\"ms\":" << ms << ",\"result\":\"" << json_escape(rfile) << "\"}";
+        (void)ridx->append_json_line(j.str());
+        std::lock_guard<std::mutex> lk(result_idx_mu);
+        result_idx[key] = ResultEntry{status, jr.exit_code, jr.attempt, ms, rfile};
+    };
+
+    auto process_processing_file = [&](const std::filesystem::path& proc, const std::string& base, int wid,
+                                       const std::string* body = nullptr) {
         // Delegate to shared job processing (result metadata + file moves handled there)
-        JobResult jr = process_queue_job(proc, base, argv[0], root, q);
+        JobResult jr = process_queue_job(proc, base, argv[0], root, q, body);
 
         // serve-specific: WAL event + counters
         {
@@ -255,6 +491,31 @@ int cmd_serve(int argc, char** argv) {
                      + ",\"worker\":" + std::to_string(wid));
         }
 
+        result_index_append(base, jr);
+
+        if (notifier.enabled()) {
+            const char* status = (jr.exit_code == 0) ? "done"
+                               : (jr.scheduled_retry ? "retry" : (jr.deadletter ? "dlq" : "failed"));
+            notifier.publish(std::string("{\"event\":\"job\",\"job\":\"")
+                             + json_escape(job_key_of(base))
+                             + "\",\"status\":\"" + status
+                             + "\",\"rc\":" + std::to_string(jr.exit_code)
+                             + ",\"attempt\":" + std::to_string(jr.attempt)
+                             + ",\"ms\":" + std::to_string(now_ms_wall())
+                             + ",\"worker\":" + std::to_string(wid) + "}");
+        }
+
+        // Schedule the retry in-memory right away: the wheel fires it at its
+        // due time without waiting for the next retry-dir scan. The file in
+        // retry/ stays the durable record (delay_seen makes the scan a no-op
+        // for entries already on the wheel).
+        if (jr.scheduled_retry) {
+            int64_t due_val = 0;
+            std::string rest;
+            if (parse_retry_name(jr.final_path.filename().string(), due_val, rest))
+                delayq_schedule(due_val, jr.final_path, rest);
+        }
+
         jobs_processed.fetch_add(1);
         if (jr.exit_code == 0) jobs_ok.fetch_add(1); else jobs_fail.fetch_add(1);
 
@@ -270,6 +531,7 @@ int cmd_serve(int argc, char** argv) {
     };
 
     std::vector<std::thread> worker_threads;
+    std::unique_ptr<std::thread> prefetch_thread;
     std::unique_ptr<std::thread> feeder_thread;
     std::unique_ptr<std::thread> checkpoint_thread;
     if (workers > 0) {
@@ -280,12 +542,58 @@ int cmd_serve(int argc, char** argv) {
             std::filesystem::create_directories(wal_dir, ec);
             wal.reset(new machina::Wal(wal_file));
             wal->set_fsync(wal_fsync);
+            // Group commit amortizes the per-append fsync cost when fsync is on.
+            const int wal_gc_batch = runner_detail::getenv_int("MACHINA_WAL_GROUP_COMMIT", 0);
+            if (wal_gc_batch > 0) {
+                const int wal_gc_ms = runner_detail::getenv_int("MACHINA_WAL_GROUP_COMMIT_MS", 5);
+                wal->enable_group_commit(wal_gc_batch, wal_gc_ms);
+            }
+            // Tail ring serves /events/recent from RAM (dashboards poll it).
+            const int wal_ring = runner_detail::getenv_int("MACHINA_WAL_TAIL_RING", 256);
+            if (wal_ring > 0) wal->set_tail_ring((size_t)wal_ring);
             std::string werr = wal->open(false);
             if (!werr.empty()) {
                 std::cerr << "[serve] wal open failed: " << werr << "\n";
             }
         }
 
+        // Results index: appended once per completed attempt. With fsync on,
+        // group commit batches the index fsyncs across workers — the index
+        // line is the durable commit record for a result (the per-attempt
+        // result file itself is rename-atomic but never individually synced).
+        {
+            ridx.reset(new machina::Wal(ridx_file));
+            ridx->set_fsync(wal_fsync);
+            if (wal_fsync) ridx->enable_group_commit();
+            std::string rerr = ridx->open(false);
+            if (!rerr.empty()) {
+                std::cerr << "[serve] results index open failed: " << rerr << "\n";
+                ridx.reset();
+            } else {
+                // Rebuild the lookup map; later lines win, so replaying
+                // segments oldest-first leaves the latest attempt per job.
+                size_t n = 0;
+                for (auto& seg : ridx->list_segments()) {
+                    std::ifstream in(seg);
+                    std::string line;
+                    while (std::getline(in, line)) {
+                        if (line.empty()) continue;
+                        auto job = machina::json_mini::get_string(line, "job").value_or("");
+                        if (job.empty()) continue;
+                        ResultEntry e;
+                        e.status = machina::json_mini::get_string(line, "status").value_or("");
+                        e.rc = (int)machina::json_mini::get_int(line, "rc").value_or(0);
+                        e.attempt = (int)machina::json_mini::get_int(line, "attempt").value_or(1);
+                        e.ms = machina::json_mini::get_int(line, "ms").value_or(0);
+                        e.result_file = machina::json_mini::get_string(line, "result").value_or("");
+                        result_idx[job] = std::move(e);
+                        n++;
+                    }
+                }
+                if (n > 0) std::cerr << "[serve] results index: " << result_idx.size() << " jobs (" << n << " records)\n";
+            }
+        }
+
         // Crash recovery
         {
             std::error_code ec;
@@ -296,7 +604,7 @@ int cmd_serve(int argc, char** argv) {
                 if (!ends_with(fn, ".processing")) continue;
                 std::string rest = fn;
                 if (ends_with(rest, ".processing")) rest.resize(rest.size() - std::string(".processing").size());
-                std::filesystem::path dst = inbox / rest;
+                std::filesystem::path dst = inbox_shard_path(inbox, rest);
                 std::error_code ec2;
                 std::filesystem::rename(de.path(), dst, ec2);
                 if (!ec2) {
@@ -314,7 +622,7 @@ int cmd_serve(int argc, char** argv) {
             if (ok) {
                 for (auto& name : ck_inbox) {
                     if (name.empty()) continue;
-                    memq_try_enqueue_path(inbox / name);
+                    memq_try_enqueue_path(inbox_locate(inbox, name));
                 }
                 for (auto& it : ck_retry) {
                     int64_t due_val = it.first;
@@ -353,7 +661,7 @@ int cmd_serve(int argc, char** argv) {
                 auto t = machina::json_mini::get_string(line, "t").value_or("");
                 if (t == "ENQ") {
                     auto name = machina::json_mini::get_string(line, "name").value_or("");
-                    if (!name.empty()) memq_try_enqueue_path(inbox / name);
+                    if (!name.empty()) memq_try_enqueue_path(inbox_locate(inbox, name));
                 } else if (t == "SCHED") {
                     auto name = machina::json_mini::get_string(line, "name").value_or("");
                     auto due_val = machina::json_mini::get_int(line, "due_ms").value_or(0);
@@ -364,7 +672,7 @@ int cmd_serve(int argc, char** argv) {
                     if (!rest.empty()) delayq_schedule((int64_t)due_val, retry / name, rest);
                 } else if (t == "PROMOTE" || t == "RECOVER") {
                     auto to = machina::json_mini::get_string(line, "to").value_or("");
-                    if (!to.empty()) memq_try_enqueue_path(inbox / to);
+                    if (!to.empty()) memq_try_enqueue_path(inbox_locate(inbox, to));
                 } else if (t == "DEDUP") {
                     // Restore dedup cache from WAL
                     auto rid = machina::json_mini::get_string(line, "request_id").value_or("");
@@ -385,6 +693,34 @@ int cmd_serve(int argc, char** argv) {
         write_checkpoint();
 
         feeder_thread.reset(new std::thread([&]() {
+#ifdef __linux__
+            // inotify watcher: files arriving in the inbox wake the feeder
+            // immediately instead of waiting out the scan interval.
+            // IN_MOVED_TO covers the rename-into-inbox paths (enqueue,
+            // retry promotion, external producers); IN_CLOSE_WRITE covers
+            // files written in place. The periodic full scan is kept as a
+            // safety net but stretched, since it only has to catch events
+            // lost to queue overflow.
+            int infd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            std::unordered_map<int, std::filesystem::path> in_wds; // watch -> directory
+            if (infd >= 0) {
+                auto add_watch = [&](const std::filesystem::path& d) {
+                    int wd = ::inotify_add_watch(infd, d.c_str(), IN_MOVED_TO | IN_CLOSE_WRITE);
+                    if (wd >= 0) in_wds[wd] = d;
+                };
+                add_watch(inbox); // flat legacy files
+                std::error_code iec;
+                for (auto& de : std::filesystem::directory_iterator(inbox, iec)) {
+                    if (iec) break;
+                    if (de.is_directory(iec)) add_watch(de.path());
+                }
+                if (in_wds.empty()) { ::close(infd); infd = -1; }
+            }
+            const int64_t full_scan_ms = infd >= 0 ? (scan_ms < 5000 ? 5000 : (int64_t)scan_ms)
+                                                   : (int64_t)scan_ms;
+#else
+            const int64_t full_scan_ms = scan_ms;
+#endif
             int64_t last_scan = 0;
             while (!stop_workers.load()) {
                 int64_t now = now_ms_i64();
@@ -392,11 +728,8 @@ int cmd_serve(int argc, char** argv) {
                 std::vector<DelayedItem> promote;
                 {
                     std::lock_guard<std::mutex> lk(delay_mu);
-                    while (!delayq.empty() && delayq.top().due_ms <= now) {
-                        promote.push_back(delayq.top());
-                        delay_seen.erase(delayq.top().path.filename().string());
-                        delayq.pop();
-                    }
+                    delayq.advance(now, promote);
+                    for (auto& it : promote) delay_seen.erase(it.path.filename().string());
                 }
                 for (auto& it : promote) {
                     std::string rest = it.rest;
@@ -405,7 +738,7 @@ int cmd_serve(int argc, char** argv) {
                         parse_retry_name(it.path.filename().string(), dummy, rest);
                     }
                     if (rest.empty()) continue;
-                    std::filesystem::path dst = inbox / rest;
+                    std::filesystem::path dst = inbox_shard_path(inbox, rest);
                     std::error_code ec;
                     std::filesystem::rename(it.path, dst, ec);
                     if (ec) continue;
@@ -413,7 +746,7 @@ int cmd_serve(int argc, char** argv) {
                     memq_try_enqueue_path(dst);
                 }
 
-                if (now - last_scan >= scan_ms) {
+                if (now - last_scan >= full_scan_ms) {
                     last_scan = now;
                     auto jobs_list = list_inbox_json(inbox);
                     for (auto& pth : jobs_list) memq_try_enqueue_path(pth);
@@ -430,18 +763,48 @@ int cmd_serve(int argc, char** argv) {
                     }
                 }
 
-                int64_t sleep_for_ms = scan_ms;
+                int64_t sleep_for_ms = full_scan_ms;
                 {
                     std::lock_guard<std::mutex> lk(delay_mu);
-                    if (!delayq.empty()) {
-                        int64_t d = delayq.top().due_ms - now;
+                    int64_t nd = delayq.next_due_hint();
+                    if (nd >= 0) {
+                        int64_t d = nd - now;
                         if (d < 0) d = 0;
                         if (d < sleep_for_ms) sleep_for_ms = d;
                     }
                 }
                 if (sleep_for_ms < 10) sleep_for_ms = 10;
+                if (sleep_for_ms > 1000) sleep_for_ms = 1000; // bounded stop_workers latency
+#ifdef __linux__
+                if (infd >= 0) {
+                    pollfd pfd{infd, POLLIN, 0};
+                    int pr = ::poll(&pfd, 1, (int)sleep_for_ms);
+                    if (pr > 0 && (pfd.revents & POLLIN)) {
+                        alignas(struct inotify_event) char evbuf[4096];
+                        ssize_t n;
+                        while ((n = ::read(infd, evbuf, sizeof(evbuf))) > 0) {
+                            for (ssize_t off = 0; off < n;) {
+                                const auto* ev = (const struct inotify_event*)(evbuf + off);
+                                auto wit = in_wds.find(ev->wd);
+                                if (ev->len > 0 && wit != in_wds.end()) {
+                                    std::string fn(ev->name);
+                                    if (fn.size() > 5 && fn.rfind(".json") == fn.size() - 5)
+                                        memq_try_enqueue_path(wit->second / fn);
+                                }
+                                off += (ssize_t)(sizeof(struct inotify_event) + ev->len);
+                            }
+                        }
+                    }
+                } else {
+                    sleep_ms((int)sleep_for_ms);
+                }
+#else
                 sleep_ms((int)sleep_for_ms);
+#endif
             }
+#ifdef __linux__
+            if (infd >= 0) ::close(infd);
+#endif
         }));
 
         if (wal_enable && wal_checkpoint_ms > 0) {
@@ -454,24 +817,44 @@ int cmd_serve(int argc, char** argv) {
             }));
         }
 
+        prefetch_thread.reset(new std::thread([&]() {
+            machina::ConcurrentPriorityQueue<std::filesystem::path>::Item qi;
+            while (memq.pop(qi)) {
+                std::filesystem::path p = qi.value;
+                if (stop_workers.load()) break;
+                std::string base = p.filename().string();
+                std::filesystem::path proc = processing / (base + ".processing");
+                std::error_code ec;
+                std::filesystem::rename(p, proc, ec);
+                memq_drop_seen(base);
+                if (ec) continue; // gone or already claimed; scans re-find real stragglers
+                std::string body = slurp_file(proc);
+                std::unique_lock<std::mutex> lk(pref_mu);
+                pref_cv.wait(lk, [&] { return prefq.size() < pref_cap || pref_closed; });
+                if (pref_closed) break;
+                prefq.push_back(PrefetchedJob{std::move(proc), std::move(base), std::move(body)});
+                pref_cv.notify_all();
+            }
+            std::lock_guard<std::mutex> lk(pref_mu);
+            pref_closed = true;
+            pref_cv.notify_all();
+        }));
+
         worker_threads.reserve((size_t)workers);
         for (int wid = 0; wid < workers; wid++) {
             worker_threads.emplace_back([&, wid]() {
-                machina::ConcurrentPriorityQueue<std::filesystem::path>::Item qi;
-                while (memq.pop(qi)) {
-                    std::filesystem::path p = qi.value;
-                    if (stop_workers.load()) break;
-                    std::string base = p.filename().string();
-                    std::filesystem::path proc = processing / (base + ".processing");
-                    std::error_code ec;
-                    std::filesystem::rename(p, proc, ec);
-                    if (ec) {
-                        memq_drop_seen(base);
-                        sleep_ms(5);
-                        continue;
+                for (;;) {
+                    PrefetchedJob job;
+                    {
+                        std::unique_lock<std::mutex> lk(pref_mu);
+                        pref_cv.wait(lk, [&] { return !prefq.empty() || pref_closed; });
+                        if (prefq.empty()) return;
+                        job = std::move(prefq.front());
+                        prefq.pop_front();
+                        pref_cv.notify_all(); // wake the prefetcher to refill
                     }
-                    memq_drop_seen(base);
-                    process_processing_file(proc, base, wid);
+                    if (stop_workers.load()) return;
+                    process_processing_file(job.proc, job.base, wid, &job.body);
                 }
             });
         }
@@ -489,6 +872,9 @@ int cmd_serve(int argc, char** argv) {
         std::cerr << "[WARN] /shutdown, /enqueue, /run_sync will reject all requests (fail-closed).\n";
         std::cerr << "[WARN] Set MACHINA_API_TOKEN or MACHINA_API_HMAC_SECRET to enable authenticated access.\n";
     }
+    // Precompute the HMAC key schedule once; every signed request reuses it.
+    std::unique_ptr<HmacKey> hmac_key;
+    if (!hmac_secret.empty()) hmac_key = std::make_unique<HmacKey>(hmac_secret);
     int hmac_ttl_sec = 60;
     if (const char* e = std::getenv("MACHINA_API_HMAC_TTL_SEC")) { try { hmac_ttl_sec = std::stoi(e); } catch (...) {} }
     if (hmac_ttl_sec <= 0) hmac_ttl_sec = 60;
@@ -503,83 +889,87 @@ int cmd_serve(int argc, char** argv) {
     if (const char* e = std::getenv("MACHINA_API_ENQUEUE_RPM")) { try { rpm_enqueue = std::stoi(e); } catch (...) {} }
     if (const char* e = std::getenv("MACHINA_API_RUNSYNC_RPM")) { try { rpm_run = std::stoi(e); } catch (...) {} }
 
-    TokenBucket tb_enqueue, tb_run;
+    // Per-client (per source IP) rate limiting with a lock-free CAS path —
+    // executors check budgets without contending on http_mu.
+    ShardedRateLimiter tb_enqueue, tb_run;
     tb_enqueue.init(rpm_enqueue, now_ms_wall());
     tb_run.init(rpm_run, now_ms_wall());
 
-    std::unordered_map<std::string, int64_t> nonce_cache;
-    std::mutex http_mu; // protects nonce_cache, tb_enqueue, tb_run
+    NonceCache nonce_cache;
+    std::mutex http_mu; // protects nonce_cache
     constexpr int max_http_conns = 32;
-    std::atomic<int> active_conns{0};
-    std::vector<std::thread> http_threads;
-    std::mutex http_threads_mu;
-    std::string argv0_copy = argv[0]; // copy before threads can outlive stack
-
-    std::cerr << "[serve] http://" << host << ":" << port << " queue=" << q;
-    if (workers > 0) std::cerr << " (integrated workers=" << workers << ")";
-    std::cerr << "\n";
-
-    std::atomic<bool> running{true};
-    while (running.load()) {
-        sockaddr_in caddr{}; socklen_t clen = sizeof(caddr);
-        int cfd = ::accept(sfd, (sockaddr*)&caddr, &clen);
-        if (cfd < 0) continue;
-        if (active_conns.load() >= max_http_conns) {
-            send_json(cfd, 503, "{\"ok\":false,\"error\":\"too many connections\"}");
-            ::close(cfd);
-            continue;
-        }
-        active_conns.fetch_add(1);
-        set_socket_timeouts(cfd, 10); // 10s per-connection timeout (Slowloris defense)
-
-        std::thread t([&, cfd, caddr]() {
-        struct ConnGuard { std::atomic<int>& c; ~ConnGuard() { c.fetch_sub(1); } } cg{active_conns};
-
-        std::string head, body;
-        if (!read_http_request(cfd, head, body, max_body_bytes)) { ::close(cfd); return; }
+    std::string argv0_copy = argv[0];
+
+    // HTTP-layer counters: single relaxed-atomic increments on the hot
+    // path; all aggregation (histogram cumulation, queue/WAL gauges) is
+    // deferred to /metrics scrape time.
+    struct ServeHttpMetrics {
+        enum { kBuckets = 24 }; // log2 us buckets, matches tool_metrics.h
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> bad_requests{0};
+        std::atomic<uint64_t> responses_by_class[6]{};
+        std::atomic<uint64_t> conns_accepted{0};
+        std::atomic<uint64_t> conns_over_cap{0};
+        std::atomic<uint64_t> conns_idle_reaped{0};
+        std::atomic<uint64_t> bytes_in{0};
+        std::atomic<uint64_t> bytes_out{0};
+        std::atomic<uint64_t> hist_us[kBuckets]{}; // queue wait + handler time
+        std::atomic<uint64_t> total_us{0};
+    } hm;
+    std::atomic<int> sse_active{0};
+    // The executor queue is declared after the handler lambda that scrapes
+    // it; bound once the queue exists.
+    std::function<size_t()> http_queue_depth_fn;
+
+    // Routed response: the event loop owns the socket, handlers just
+    // describe what to send back.
+    struct HttpResp {
+        int code;
+        std::string body;
+        std::string content_type;
+        std::string extra_headers;
+        HttpResp(int c, std::string b,
+                 std::string ct = "application/json",
+                 std::string xh = "")
+            : code(c), body(std::move(b)),
+              content_type(std::move(ct)), extra_headers(std::move(xh)) {}
+    };
 
-        std::istringstream iss(head);
-        std::string method, path, ver;
-        iss >> method >> path >> ver;
-        char ipbuf[64] = {0};
-        (void)inet_ntop(AF_INET, &caddr.sin_addr, ipbuf, sizeof(ipbuf));
+    auto handle_http = [&](const HttpRequest& rq, uint64_t client_key, bool& shutdown_req) -> HttpResp {
+        const std::string& method = rq.method;
+        const std::string& path = rq.path;
+        const std::string& head = rq.head;
+        const std::string& body = rq.body;
 
         if (method == "GET" && path == "/health") {
-            send_json(cfd, 200, "{\"ok\":true}");
-            ::close(cfd);
-            return;
+            return {200, "{\"ok\":true}"};
         }
 
         if (method == "POST" && path == "/shutdown") {
             // Fail-closed: if no auth is configured, /shutdown is disabled entirely
             if (api_token.empty() && hmac_secret.empty()) {
-                send_json(cfd, 403, "{\"ok\":false,\"error\":\"shutdown disabled: no auth configured\"}");
-                ::close(cfd);
-                return;
+                return {403, "{\"ok\":false,\"error\":\"shutdown disabled: no auth configured\"}"};
             }
             {
                 bool auth_ok;
                 {
                     std::lock_guard<std::mutex> lk(http_mu);
-                    auth_ok = api_token_ok(head, api_token) && api_hmac_ok(head, method, path, body, hmac_secret, hmac_ttl_sec, nonce_cache);
+                    auth_ok = api_token_ok(head, api_token) && api_hmac_ok(head, method, path, body, hmac_key.get(), hmac_ttl_sec, nonce_cache);
                 }
                 if (!auth_ok) {
-                    send_json(cfd, 401, "{\"ok\":false,\"error\":\"unauthorized\"}");
-                    ::close(cfd);
-                    return;
+                    return {401, "{\"ok\":false,\"error\":\"unauthorized\"}"};
                 }
             }
-            send_json(cfd, 200, "{\"ok\":true,\"message\":\"shutting_down\"}");
-            ::close(cfd);
-            running.store(false);
-            return;
+            shutdown_req = true;
+            return {200, "{\"ok\":true,\"message\":\"shutting_down\"}"};
         }
 
         if (method == "GET" && path == "/stats") {
             auto count = [&](const std::filesystem::path& p) {
                 size_t n = 0; std::error_code ec;
                 if (!std::filesystem::exists(p, ec)) return n;
-                for (auto& e : std::filesystem::directory_iterator(p, ec)) {
+                // recursive: the inbox keeps its pending files in shards
+                for (auto& e : std::filesystem::recursive_directory_iterator(p, ec)) {
                     if (ec) break;
                     if (e.is_regular_file(ec)) n++;
                 }
@@ -598,11 +988,197 @@ int cmd_serve(int argc, char** argv) {
             j << "\"memq\":" << memq.size() << ",";
             j << "\"jobs_processed\":" << jobs_processed.load() << ",";
             j << "\"jobs_ok\":" << jobs_ok.load() << ",";
-            j << "\"jobs_fail\":" << jobs_fail.load();
+            j << "\"jobs_fail\":" << jobs_fail.load() << ",";
+            auto scs = selector_cache_stats();
+            j << "\"selector_cache\":{";
+            j << "\"centroid_hits\":" << scs.centroid_hits << ",";
+            j << "\"centroid_misses\":" << scs.centroid_misses << ",";
+            j << "\"centroid_evictions\":" << scs.centroid_evictions << ",";
+            j << "\"centroid_entries\":" << scs.centroid_entries << ",";
+            j << "\"goal_hits\":" << scs.goal_hits << ",";
+            j << "\"goal_misses\":" << scs.goal_misses << ",";
+            j << "\"goal_evictions\":" << scs.goal_evictions << ",";
+            j << "\"goal_entries\":" << scs.goal_entries;
             j << "}";
-            send_json(cfd, 200, j.str());
-            ::close(cfd);
-            return;
+            j << "}";
+            return {200, j.str()};
+        }
+
+        if (method == "GET" && path.rfind("/jobs/", 0) == 0) {
+            // GET /jobs/{name} — job status from the in-memory results
+            // index (no out/ directory listing or per-file stats). {name}
+            // is the filename /enqueue returned; attempts collapse onto it.
+            std::string name = path.substr(std::string("/jobs/").size());
+            if (name.empty() || name.find('/') != std::string::npos || name.find("..") != std::string::npos) {
+                return {400, "{\"ok\":false,\"error\":\"bad job name\"}"};
+            }
+            std::string key = job_key_of(name);
+            ResultEntry e;
+            bool found = false;
+            {
+                std::lock_guard<std::mutex> lk(result_idx_mu);
+                auto it = result_idx.find(key);
+                if (it != result_idx.end()) { e = it->second; found = true; }
+            }
+            if (!found) {
+                // Not completed yet: report queued work so callers can poll.
+                bool queued;
+                {
+                    std::lock_guard<std::mutex> lk(memq_mu);
+                    queued = memq_seen.count(name) != 0;
+                }
+                if (queued) {
+                    return {200, std::string("{\"ok\":true,\"job\":\"") + json_escape(key) + "\",\"status\":\"queued\"}"};
+                }
+                return {404, "{\"ok\":false,\"error\":\"unknown_job\"}"};
+            }
+            std::ostringstream j;
+            j << "{\"ok\":true,\"job\":\"" << json_escape(key) << "\",\"status\":\"" << e.status
+              << "\",\"rc\":" << e.rc << ",\"attempt\":" << e.attempt
+              << ",\"ms\":" << e.ms << ",\"result\":\"" << json_escape(e.result_file) << "\"}";
+            return {200, j.str()};
+        }
+
+        if (method == "GET" && (path == "/events/recent" || path.rfind("/events/recent?", 0) == 0)) {
+            // Recent WAL events straight from the in-memory tail ring.
+            // Optional query params: cursor=<seq> (polling subscription,
+            // response carries the next cursor) and limit=<n>.
+            uint64_t cursor = 0;
+            bool have_cursor = false;
+            size_t limit = 50;
+            auto qp = path.find('?');
+            if (qp != std::string::npos) {
+                std::istringstream qs(path.substr(qp + 1));
+                std::string kv;
+                while (std::getline(qs, kv, '&')) {
+                    if (kv.rfind("cursor=", 0) == 0) {
+                        cursor = (uint64_t)std::strtoull(kv.c_str() + 7, nullptr, 10);
+                        have_cursor = true;
+                    } else if (kv.rfind("limit=", 0) == 0) {
+                        limit = (size_t)std::strtoull(kv.c_str() + 6, nullptr, 10);
+                    }
+                }
+            }
+
+            std::ostringstream j;
+            j << "{\"ok\":true,\"events\":[";
+            if (workers > 0 && wal) {
+                std::vector<std::string> events;
+                if (have_cursor) {
+                    events = wal->tail_since(&cursor, limit);
+                } else {
+                    events = wal->tail(limit);
+                    cursor = wal->tail_seq();
+                }
+                for (size_t i = 0; i < events.size(); i++) {
+                    if (i) j << ",";
+                    j << events[i];
+                }
+            }
+            j << "],\"cursor\":" << cursor << "}";
+            return {200, j.str()};
+        }
+
+        if (method == "GET" && path == "/wal/segments") {
+            // Follower bootstrap: list replayable segments plus the live
+            // tail cursor to switch to once caught up.
+            std::ostringstream j;
+            j << "{\"ok\":true,\"segments\":[";
+            if (workers > 0 && wal) {
+                auto segs = wal->list_segments();
+                for (size_t i = 0; i < segs.size(); i++) {
+                    std::error_code fec;
+                    auto sz = std::filesystem::file_size(segs[i], fec);
+                    if (i) j << ",";
+                    j << "{\"name\":\"" << json_escape(segs[i].filename().string())
+                      << "\",\"bytes\":" << (fec ? 0 : (long long)sz) << "}";
+                }
+            }
+            j << "],\"cursor\":" << ((workers > 0 && wal) ? wal->tail_seq() : 0) << "}";
+            return {200, j.str()};
+        }
+
+        if (method == "GET" && (path == "/wal/stream" || path.rfind("/wal/stream?", 0) == 0)) {
+            // Streaming replication for warm standbys. Two modes:
+            //   ?segment=<name>&offset=<bytes>  — raw catch-up chunk from a
+            //     segment file (headers carry next offset / eof / cursor)
+            //   ?cursor=<seq>[&wait_ms=..][&limit=..] — long-poll the
+            //     in-memory tail for records appended since <seq>
+            std::string segment;
+            int64_t offset = 0;
+            uint64_t cursor = 0;
+            bool have_cursor = false;
+            int wait_ms = 2000;
+            size_t limit = 500;
+            auto qp = path.find('?');
+            if (qp != std::string::npos) {
+                std::istringstream qs(path.substr(qp + 1));
+                std::string kv;
+                while (std::getline(qs, kv, '&')) {
+                    if (kv.rfind("segment=", 0) == 0) segment = kv.substr(8);
+                    else if (kv.rfind("offset=", 0) == 0) offset = std::atoll(kv.c_str() + 7);
+                    else if (kv.rfind("cursor=", 0) == 0) {
+                        cursor = (uint64_t)std::strtoull(kv.c_str() + 7, nullptr, 10);
+                        have_cursor = true;
+                    }
+                    else if (kv.rfind("wait_ms=", 0) == 0) wait_ms = std::atoi(kv.c_str() + 8);
+                    else if (kv.rfind("limit=", 0) == 0) limit = (size_t)std::strtoull(kv.c_str() + 6, nullptr, 10);
+                }
+            }
+
+            if (!(workers > 0 && wal)) {
+                return {404, "{\"ok\":false,\"error\":\"wal disabled\"}"};
+            }
+
+            if (!segment.empty()) {
+                // Catch-up mode: only names reported by list_segments are
+                // valid (no path components accepted from the client).
+                std::filesystem::path seg_path;
+                for (const auto& sp : wal->list_segments()) {
+                    if (sp.filename().string() == segment) { seg_path = sp; break; }
+                }
+                if (seg_path.empty()) {
+                    return {404, "{\"ok\":false,\"error\":\"unknown segment\"}"};
+                }
+                constexpr int64_t kMaxChunk = 256 * 1024;
+                std::ifstream in(seg_path, std::ios::binary);
+                std::string chunk;
+                bool eof = true;
+                if (in && offset >= 0) {
+                    in.seekg(offset);
+                    chunk.resize((size_t)kMaxChunk);
+                    in.read(chunk.data(), kMaxChunk);
+                    chunk.resize((size_t)in.gcount());
+                    eof = in.eof();
+                }
+                std::ostringstream hdr;
+                hdr << "X-Wal-Segment: " << segment << "\r\n";
+                hdr << "X-Wal-Next-Offset: " << (offset + (int64_t)chunk.size()) << "\r\n";
+                hdr << "X-Wal-Eof: " << (eof ? 1 : 0) << "\r\n";
+                hdr << "X-Wal-Cursor: " << wal->tail_seq() << "\r\n";
+                return {200, chunk, "application/octet-stream", hdr.str()};
+            }
+
+            // Tail mode: long-poll the in-memory ring.
+            if (wait_ms < 0) wait_ms = 0;
+            if (wait_ms > 8000) wait_ms = 8000;  // stay inside the idle timeout
+            if (!have_cursor) cursor = wal->tail_seq();
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait_ms);
+            std::vector<std::string> records;
+            for (;;) {
+                records = wal->tail_since(&cursor, limit);
+                if (!records.empty()) break;
+                if (std::chrono::steady_clock::now() >= deadline) break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(25));
+            }
+            std::ostringstream j;
+            j << "{\"ok\":true,\"records\":[";
+            for (size_t i = 0; i < records.size(); i++) {
+                if (i) j << ",";
+                j << records[i];
+            }
+            j << "],\"cursor\":" << cursor << "}";
+            return {200, j.str()};
         }
 
         if (method == "GET" && path == "/metrics") {
@@ -610,7 +1186,8 @@ int cmd_serve(int argc, char** argv) {
             auto count = [&](const std::filesystem::path& p) {
                 size_t n = 0; std::error_code ec;
                 if (!std::filesystem::exists(p, ec)) return n;
-                for (auto& e : std::filesystem::directory_iterator(p, ec)) {
+                // recursive: the inbox keeps its pending files in shards
+                for (auto& e : std::filesystem::recursive_directory_iterator(p, ec)) {
                     if (ec) break;
                     if (e.is_regular_file(ec)) n++;
                 }
@@ -627,6 +1204,36 @@ int cmd_serve(int argc, char** argv) {
             m << "# HELP machina_jobs_fail_total Failed jobs\n";
             m << "# TYPE machina_jobs_fail_total counter\n";
             m << "machina_jobs_fail_total " << jobs_fail.load() << "\n";
+            if (notifier.enabled()) {
+                m << "# HELP machina_notify_batches_sent_total Delivered webhook batches\n";
+                m << "# TYPE machina_notify_batches_sent_total counter\n";
+                m << "machina_notify_batches_sent_total " << notifier.sent_batches() << "\n";
+                m << "# HELP machina_notify_batches_failed_total Failed webhook batches\n";
+                m << "# TYPE machina_notify_batches_failed_total counter\n";
+                m << "machina_notify_batches_failed_total " << notifier.failed_batches() << "\n";
+                m << "# HELP machina_notify_dropped_total Events dropped under backpressure\n";
+                m << "# TYPE machina_notify_dropped_total counter\n";
+                m << "machina_notify_dropped_total " << notifier.dropped() << "\n";
+            }
+            {
+                machina::GpuSnapshot gs;
+                const int64_t gnow = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                if (machina::gpu_snapshot_read(&gs) && machina::gpu_snapshot_fresh(gs, gnow, 30000)) {
+                    m << "# HELP machina_gpu_available GPU backend usable (1/0)\n";
+                    m << "# TYPE machina_gpu_available gauge\n";
+                    m << "machina_gpu_available " << gs.available << "\n";
+                    m << "# HELP machina_gpu_memory_used_mb GPU memory in use\n";
+                    m << "# TYPE machina_gpu_memory_used_mb gauge\n";
+                    m << "machina_gpu_memory_used_mb " << gs.memory_used_mb << "\n";
+                    m << "# HELP machina_gpu_temp_c GPU temperature\n";
+                    m << "# TYPE machina_gpu_temp_c gauge\n";
+                    m << "machina_gpu_temp_c " << gs.temp_c << "\n";
+                    m << "# HELP machina_gpu_power_mw GPU power draw\n";
+                    m << "# TYPE machina_gpu_power_mw gauge\n";
+                    m << "machina_gpu_power_mw " << gs.power_mw << "\n";
+                }
+            }
             m << "# HELP machina_queue_inbox_size Current inbox queue depth\n";
             m << "# TYPE machina_queue_inbox_size gauge\n";
             m << "machina_queue_inbox_size " << count(q / "inbox") << "\n";
@@ -648,6 +1255,58 @@ int cmd_serve(int argc, char** argv) {
             m << "# HELP machina_workers_configured Number of worker threads\n";
             m << "# TYPE machina_workers_configured gauge\n";
             m << "machina_workers_configured " << workers << "\n";
+            m << "# HELP machina_http_requests_total Parsed HTTP requests\n";
+            m << "# TYPE machina_http_requests_total counter\n";
+            m << "machina_http_requests_total " << hm.requests.load(std::memory_order_relaxed) << "\n";
+            m << "# HELP machina_http_bad_requests_total Requests rejected by the parser\n";
+            m << "# TYPE machina_http_bad_requests_total counter\n";
+            m << "machina_http_bad_requests_total " << hm.bad_requests.load(std::memory_order_relaxed) << "\n";
+            m << "# HELP machina_http_responses_total Responses by status class\n";
+            m << "# TYPE machina_http_responses_total counter\n";
+            for (int cls = 2; cls <= 5; cls++)
+                m << "machina_http_responses_total{class=\"" << cls << "xx\"} "
+                  << hm.responses_by_class[cls].load(std::memory_order_relaxed) << "\n";
+            m << "# HELP machina_http_connections_total Accepted connections\n";
+            m << "# TYPE machina_http_connections_total counter\n";
+            m << "machina_http_connections_total " << hm.conns_accepted.load(std::memory_order_relaxed) << "\n";
+            m << "# HELP machina_http_connections_over_cap_total Connections rejected with 503\n";
+            m << "# TYPE machina_http_connections_over_cap_total counter\n";
+            m << "machina_http_connections_over_cap_total " << hm.conns_over_cap.load(std::memory_order_relaxed) << "\n";
+            m << "# HELP machina_http_connections_reaped_total Idle connections reaped\n";
+            m << "# TYPE machina_http_connections_reaped_total counter\n";
+            m << "machina_http_connections_reaped_total " << hm.conns_idle_reaped.load(std::memory_order_relaxed) << "\n";
+            m << "# HELP machina_http_bytes_in_total Bytes received\n";
+            m << "# TYPE machina_http_bytes_in_total counter\n";
+            m << "machina_http_bytes_in_total " << hm.bytes_in.load(std::memory_order_relaxed) << "\n";
+            m << "# HELP machina_http_bytes_out_total Bytes sent\n";
+            m << "# TYPE machina_http_bytes_out_total counter\n";
+            m << "machina_http_bytes_out_total " << hm.bytes_out.load(std::memory_order_relaxed) << "\n";
+            m << "# HELP machina_http_sse_streams Active SSE subscribers\n";
+            m << "# TYPE machina_http_sse_streams gauge\n";
+            m << "machina_http_sse_streams " << sse_active.load(std::memory_order_relaxed) << "\n";
+            m << "# HELP machina_http_executor_queue_depth Requests waiting for an executor\n";
+            m << "# TYPE machina_http_executor_queue_depth gauge\n";
+            m << "machina_http_executor_queue_depth " << (http_queue_depth_fn ? http_queue_depth_fn() : 0) << "\n";
+            {
+                m << "# HELP machina_http_request_duration_us Queue wait plus handler time for executor-dispatched requests\n";
+                m << "# TYPE machina_http_request_duration_us histogram\n";
+                uint64_t cum = 0;
+                for (int b = 0; b < ServeHttpMetrics::kBuckets; b++) {
+                    cum += hm.hist_us[b].load(std::memory_order_relaxed);
+                    m << "machina_http_request_duration_us_bucket{le=\"" << (1ull << (b + 1)) << "\"} " << cum << "\n";
+                }
+                m << "machina_http_request_duration_us_bucket{le=\"+Inf\"} " << cum << "\n";
+                m << "machina_http_request_duration_us_sum " << hm.total_us.load(std::memory_order_relaxed) << "\n";
+                m << "machina_http_request_duration_us_count " << cum << "\n";
+            }
+            if (workers > 0 && wal) {
+                m << "# HELP machina_wal_bytes Current WAL segment size\n";
+                m << "# TYPE machina_wal_bytes gauge\n";
+                m << "machina_wal_bytes " << wal->size_bytes() << "\n";
+                m << "# HELP machina_wal_records_total Records appended to the WAL tail ring\n";
+                m << "# TYPE machina_wal_records_total counter\n";
+                m << "machina_wal_records_total " << wal->tail_seq() << "\n";
+            }
 
             // Per-tool metrics
             {
@@ -668,29 +1327,13 @@ int cmd_serve(int argc, char** argv) {
                 }
             }
 
-            std::string body_text = m.str();
-            std::ostringstream resp;
-            resp << "HTTP/1.1 200 OK\r\n";
-            resp << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
-            resp << "Content-Length: " << body_text.size() << "\r\n\r\n";
-            resp << body_text;
-            std::string rs = resp.str();
-            size_t ws = 0;
-            while (ws < rs.size()) {
-                ssize_t wn = ::send(cfd, rs.data() + ws, rs.size() - ws, MSG_NOSIGNAL);
-                if (wn <= 0) break;
-                ws += (size_t)wn;
-            }
-            ::close(cfd);
-            return;
+            return {200, m.str(), "text/plain; version=0.0.4; charset=utf-8"};
         }
 
         if (method == "POST" && path == "/enqueue") {
             // Fail-closed: no auth configured → reject
             if (api_token.empty() && hmac_secret.empty()) {
-                send_json(cfd, 403, "{\"ok\":false,\"error\":\"enqueue disabled: no auth configured\"}");
-                ::close(cfd);
-                return;
+                return {403, "{\"ok\":false,\"error\":\"enqueue disabled: no auth configured\"}"};
             }
             {
                 int reject_code = 0;
@@ -699,27 +1342,23 @@ int cmd_serve(int argc, char** argv) {
                     std::lock_guard<std::mutex> lk(http_mu);
                     if (!api_token_ok(head, api_token)) {
                         reject_code = 401; reject_msg = "{\"ok\":false,\"error\":\"unauthorized\"}";
-                    } else if (!api_hmac_ok(head, method, path, body, hmac_secret, hmac_ttl_sec, nonce_cache)) {
+                    } else if (!api_hmac_ok(head, method, path, body, hmac_key.get(), hmac_ttl_sec, nonce_cache)) {
                         reject_code = 401; reject_msg = "{\"ok\":false,\"error\":\"bad_signature\"}";
-                    } else if (!tb_enqueue.allow(1, now_ms_wall())) {
-                        reject_code = 429; reject_msg = "{\"ok\":false,\"error\":\"rate_limited\"}";
                     }
                 }
+                // Lock-free: per-client budget check happens outside http_mu.
+                if (!reject_code && !tb_enqueue.allow(client_key, now_ms_wall())) {
+                    reject_code = 429; reject_msg = "{\"ok\":false,\"error\":\"rate_limited\"}";
+                }
                 if (reject_code) {
-                    send_json(cfd, reject_code, reject_msg);
-                    ::close(cfd);
-                    return;
+                    return {reject_code, reject_msg};
                 }
             }
             if (body.empty() || body.size() > max_body_bytes) {
-                send_json(cfd, 400, "{\"ok\":false,\"error\":\"bad body\"}");
-                ::close(cfd);
-                return;
+                return {400, "{\"ok\":false,\"error\":\"bad body\"}"};
             }
             if (!machina::json_mini::has_key(body, "goal_id")) {
-                send_json(cfd, 400, "{\"ok\":false,\"error\":\"missing goal_id\"}");
-                ::close(cfd);
-                return;
+                return {400, "{\"ok\":false,\"error\":\"missing goal_id\"}"};
             }
             // Idempotency: deduplicate by optional request_id
             auto request_id = machina::json_mini::get_string(body, "request_id");
@@ -745,9 +1384,7 @@ int cmd_serve(int argc, char** argv) {
                     }
                 }
                 if (is_dup) {
-                    send_json(cfd, 200, "{\"ok\":true,\"deduplicated\":true}");
-                    ::close(cfd);
-                    return;
+                    return {200, "{\"ok\":true,\"deduplicated\":true}"};
                 }
                 // Persist dedup entry to WAL for crash-recovery
                 wal_emit("DEDUP", std::string(",\"request_id\":\"") + json_escape(*request_id) + "\"");
@@ -768,34 +1405,28 @@ int cmd_serve(int argc, char** argv) {
             fn.width(4);
             fn.fill('0');
             fn << priority;
-            fn << "_rq_" << ts << "_" << machina::secure_rand32();
+            fn << "_rq_" << ts << "_" << machina::fast_rand32();
             if (request_id && !request_id->empty()) {
                 // Embed a short hash of request_id for traceability
                 fn << "_rid" << (uint32_t)(machina::hash::fnv1a64(*request_id) & 0xFFFFFFFF);
             }
             fn << ".json";
             std::string fname = fn.str();
-            auto dst = q / "inbox" / fname;
+            auto dst = inbox_shard_path(q / "inbox", fname);
             std::string err = write_atomic_json(dst, body);
             if (!err.empty()) {
-                send_json(cfd, 500, std::string("{\"ok\":false,\"error\":\"") + json_escape(err) + "\"}");
-                ::close(cfd);
-                return;
+                return {500, std::string("{\"ok\":false,\"error\":\"") + json_escape(err) + "\"}"};
             }
             wal_emit("ENQ", std::string(",\"name\":\"") + json_escape(fname) + "\",\"prio\":" + std::to_string(priority)
                      + (request_id && !request_id->empty() ? std::string(",\"request_id\":\"") + json_escape(*request_id) + "\"" : ""));
             memq_try_enqueue_path(dst);
-            send_json(cfd, 200, std::string("{\"ok\":true,\"queued\":\"") + json_escape(dst.filename().string()) + "\"}");
-            ::close(cfd);
-            return;
+            return {200, std::string("{\"ok\":true,\"queued\":\"") + json_escape(dst.filename().string()) + "\"}"};
         }
 
         if (method == "POST" && path == "/run_sync") {
             // Fail-closed: no auth configured → reject
             if (api_token.empty() && hmac_secret.empty()) {
-                send_json(cfd, 403, "{\"ok\":false,\"error\":\"run_sync disabled: no auth configured\"}");
-                ::close(cfd);
-                return;
+                return {403, "{\"ok\":false,\"error\":\"run_sync disabled: no auth configured\"}"};
             }
             {
                 int reject_code = 0;
@@ -804,32 +1435,28 @@ int cmd_serve(int argc, char** argv) {
                     std::lock_guard<std::mutex> lk(http_mu);
                     if (!api_token_ok(head, api_token)) {
                         reject_code = 401; reject_msg = "{\"ok\":false,\"error\":\"unauthorized\"}";
-                    } else if (!api_hmac_ok(head, method, path, body, hmac_secret, hmac_ttl_sec, nonce_cache)) {
+                    } else if (!api_hmac_ok(head, method, path, body, hmac_key.get(), hmac_ttl_sec, nonce_cache)) {
                         reject_code = 401; reject_msg = "{\"ok\":false,\"error\":\"bad_signature\"}";
-                    } else if (!tb_run.allow(1, now_ms_wall())) {
-                        reject_code = 429; reject_msg = "{\"ok\":false,\"error\":\"rate_limited\"}";
                     }
                 }
+                // Lock-free: per-client budget check happens outside http_mu.
+                if (!reject_code && !tb_run.allow(client_key, now_ms_wall())) {
+                    reject_code = 429; reject_msg = "{\"ok\":false,\"error\":\"rate_limited\"}";
+                }
                 if (reject_code) {
-                    send_json(cfd, reject_code, reject_msg);
-                    ::close(cfd);
-                    return;
+                    return {reject_code, reject_msg};
                 }
             }
             if (body.empty() || body.size() > max_body_bytes) {
-                send_json(cfd, 400, "{\"ok\":false,\"error\":\"bad body\"}");
-                ::close(cfd);
-                return;
+                return {400, "{\"ok\":false,\"error\":\"bad body\"}"};
             }
             if (!machina::json_mini::has_key(body, "goal_id")) {
-                send_json(cfd, 400, "{\"ok\":false,\"error\":\"missing goal_id\"}");
-                ::close(cfd);
-                return;
+                return {400, "{\"ok\":false,\"error\":\"missing goal_id\"}"};
             }
 
             auto ts = (long long)std::chrono::duration_cast<std::chrono::milliseconds>(
                 std::chrono::system_clock::now().time_since_epoch()).count();
-            std::string fname = "sync_" + std::to_string(ts) + "_" + std::to_string(machina::secure_rand32()) + ".json";
+            std::string fname = "sync_" + std::to_string(ts) + "_" + std::to_string(machina::fast_rand32()) + ".json";
             auto tmp = q / "tmp" / fname;
             (void)write_atomic_json(tmp, body);
 
@@ -859,37 +1486,458 @@ int cmd_serve(int argc, char** argv) {
             j << "\"exit_code\":" << rc << ",";
             j << "\"log\":\"" << json_escape(log_rel) << "\"";
             j << "}";
-            send_json(cfd, 200, j.str());
-            ::close(cfd);
+            return {200, j.str()};
+        }
+
+        return {404, "{\"ok\":false,\"error\":\"not found\"}"};
+    };
+
+    // HTTP executor pool: the network thread parses and validates, then
+    // hands requests to these threads via a priority queue and completes
+    // the responses asynchronously. Only /health is answered inline, so
+    // its latency is flat even while every executor grinds on /run_sync.
+    // Opt-in binary tool dispatch (--tool-sock / MACHINA_TOOL_SOCK): an
+    // in-process tool runtime behind a length-prefixed Unix domain socket,
+    // for localhost callers whose HTTP + JSON round-trip overhead dwarfs
+    // the tools they call. The HTTP queue path is unchanged — queued jobs
+    // still run in cmd_run subprocesses.
+    struct ToolSockRuntime {
+        Registry reg;
+        ToolRunner runner;
+        PluginManager plugin_mgr;
+        RunnerRegistrar registrar{reg, runner, false};
+    };
+    std::unique_ptr<ToolSockRuntime> tool_sock_rt;
+    ToolSockServer tool_sock;
+    if (!tool_sock_path.empty()) {
+        tool_sock_rt.reset(new ToolSockRuntime());
+        setup_runtime(tool_sock_rt->reg, tool_sock_rt->runner,
+                      tool_sock_rt->plugin_mgr, tool_sock_rt->registrar, root);
+        std::string terr;
+        if (!tool_sock.start(tool_sock_path, tool_sock_rt->runner, terr)) {
+            std::cerr << "[serve] tool socket disabled: " << terr << "\n";
+        } else {
+            std::cerr << "[serve] tool socket: " << tool_sock_path << "\n";
+        }
+    }
+
+    const int http_executors = [&] {
+        int n = runner_detail::getenv_int("MACHINA_HTTP_EXECUTORS", 4);
+        if (n < 1) n = 1;
+        if (n > 16) n = 16;
+        return n;
+    }();
+
+    struct HttpWork {
+        uint64_t conn_id{0};
+        uint64_t client_key{0}; // source address hash for per-client limits
+        HttpRequest rq;
+        bool keep{false};
+        int64_t t0_us{0};       // dispatch time, for the latency histogram
+    };
+    struct HttpDone {
+        uint64_t conn_id{0};
+        int code{200};
+        std::string body;
+        std::string content_type;
+        std::string extra_headers;
+        bool keep{false};
+        bool shutdown{false};
+    };
+
+    // Cheap introspection jumps ahead of enqueue/run work (lower value =
+    // higher priority), keeping dashboard polls responsive under load.
+    auto http_work_priority = [](const HttpRequest& rq) -> int32_t {
+        if (rq.method == "GET") return 0;
+        if (rq.path == "/shutdown") return 0;
+        if (rq.path == "/run_sync") return 20;
+        return 10;
+    };
+
+    // Sharded: each executor effectively gets its own lock most of the time.
+    machina::ConcurrentPriorityQueue<HttpWork> httpq{(size_t)http_executors};
+    http_queue_depth_fn = [&httpq]() { return httpq.size(); };
+    std::vector<HttpDone> http_done;
+    std::mutex http_done_mu;
+
+    // Self-pipe: executors wake the poll loop when a completion lands.
+    int wakefd[2] = {-1, -1};
+    if (::pipe(wakefd) == 0) {
+        for (int i = 0; i < 2; i++) {
+            (void)::fcntl(wakefd[i], F_SETFL, ::fcntl(wakefd[i], F_GETFL, 0) | O_NONBLOCK);
+            (void)::fcntl(wakefd[i], F_SETFD, FD_CLOEXEC);
+        }
+    }
+
+    std::vector<std::thread> http_executor_threads;
+    http_executor_threads.reserve((size_t)http_executors);
+    for (int ei = 0; ei < http_executors; ei++) {
+        http_executor_threads.emplace_back([&]() {
+            machina::ConcurrentPriorityQueue<HttpWork>::Item qi;
+            while (httpq.pop(qi)) {
+                HttpWork& w = qi.value;
+                bool shutdown_req = false;
+                HttpResp r = handle_http(w.rq, w.client_key, shutdown_req);
+                int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                 std::chrono::steady_clock::now().time_since_epoch()).count() - w.t0_us;
+                if (us < 0) us = 0;
+                int bkt = 0;
+                while (bkt + 1 < (int)ServeHttpMetrics::kBuckets && (us >> (bkt + 1)) != 0) bkt++;
+                hm.hist_us[bkt].fetch_add(1, std::memory_order_relaxed);
+                hm.total_us.fetch_add((uint64_t)us, std::memory_order_relaxed);
+                {
+                    std::lock_guard<std::mutex> lk(http_done_mu);
+                    http_done.push_back(HttpDone{w.conn_id, r.code, std::move(r.body),
+                                                 std::move(r.content_type), std::move(r.extra_headers),
+                                                 w.keep && !shutdown_req, shutdown_req});
+                }
+                if (wakefd[1] >= 0) { char b = 1; (void)!::write(wakefd[1], &b, 1); }
+            }
+        });
+    }
+
+    // poll() event loop with HTTP keep-alive and pipelining. One network
+    // thread multiplexes all connections on nonblocking sockets; complete
+    // requests are carved out of each receive buffer as they arrive, so
+    // clients may pipeline bursts over a single connection.
+    (void)::fcntl(sfd, F_SETFL, ::fcntl(sfd, F_GETFL, 0) | O_NONBLOCK);
+
+    // Idle connections are reaped after this long, replacing the old
+    // per-recv SO_RCVTIMEO as the Slowloris defense.
+    const int idle_timeout_ms = runner_detail::getenv_int("MACHINA_HTTP_IDLE_MS", 10000);
+
+    struct HttpConn {
+        int fd{-1};
+        uint64_t id{0};                   // completion routing key (fds get reused)
+        uint64_t client_key{0};           // source address, for per-client rate limits
+        std::string in;                   // raw bytes awaiting the parser
+        HttpParser parser;                // incremental header-scan state for `in`
+        std::string out;                  // output arena, reused across keep-alive requests
+        size_t out_off{0};                // bytes of `out` already on the wire
+        int64_t last_ms{0};
+        bool inflight{false};             // request handed to an executor
+        bool close_after_flush{false};
+        bool shutdown_after_flush{false}; // /shutdown acked: stop once flushed
+        bool streaming{false};            // SSE subscriber fed from the WAL tail ring
+        uint64_t stream_cursor{0};        // next tail-ring sequence to deliver
+        std::string stream_match;         // run id filter (record substring), empty = all
+        int64_t stream_last_ms{0};        // last SSE frame or keep-alive comment written
+    };
+    std::vector<std::unique_ptr<HttpConn>> conns;
+    uint64_t next_conn_id = 1;
+    std::atomic<bool> running{true};
+
+    auto conn_close = [&](HttpConn& c) {
+        if (c.fd >= 0) {
+            ::close(c.fd); c.fd = -1;
+            if (c.streaming) sse_active.fetch_add(-1, std::memory_order_relaxed);
+        }
+        if (c.shutdown_after_flush) running.store(false);
+    };
+
+    auto conn_flush = [&](HttpConn& c) {
+        while (c.out_off < c.out.size()) {
+            ssize_t n = ::send(c.fd, c.out.data() + c.out_off, c.out.size() - c.out_off, MSG_NOSIGNAL);
+            if (n > 0) {
+                c.out_off += (size_t)n;
+                c.last_ms = now_ms_i64();
+                hm.bytes_out.fetch_add((uint64_t)n, std::memory_order_relaxed);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            conn_close(c); // peer gone or hard error
+            return;
+        }
+        // Drained: recycle the arena's capacity for the next response on
+        // this connection, but don't let one huge reply pin memory forever.
+        if (c.out.capacity() > 1024 * 1024) std::string().swap(c.out);
+        else c.out.clear();
+        c.out_off = 0;
+        if (c.close_after_flush) conn_close(c);
+    };
+
+    // Zero-copy fast path: when nothing is queued, emit stack-formatted
+    // headers plus the body with a single writev; only an unsent tail is
+    // copied into the connection's arena for POLLOUT to finish.
+    auto conn_send = [&](HttpConn& c, int code, const std::string& body, bool keep,
+                         const std::string& content_type = "application/json",
+                         const std::string& extra_headers = std::string()) {
+        if (code >= 200 && code < 600) hm.responses_by_class[code / 100].fetch_add(1, std::memory_order_relaxed);
+        char hdr[512];
+        size_t hn = http_format_headers(hdr, sizeof(hdr), code, body.size(), keep,
+                                        content_type, extra_headers);
+        if (hn == 0) { // oversized headers: fall back to the string path
+            c.out += format_http_response(code, body, keep, content_type, extra_headers);
+            conn_flush(c);
             return;
         }
+        if (c.out_off < c.out.size()) { // earlier bytes still queued: preserve order
+            c.out.append(hdr, hn);
+            c.out += body;
+            conn_flush(c);
+            return;
+        }
+        struct iovec iov[2];
+        iov[0].iov_base = hdr;
+        iov[0].iov_len = hn;
+        iov[1].iov_base = const_cast<char*>(body.data());
+        iov[1].iov_len = body.size();
+        ssize_t n = ::writev(c.fd, iov, body.empty() ? 1 : 2);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) n = 0;
+            else { conn_close(c); return; }
+        }
+        size_t sent = (size_t)n;
+        c.last_ms = now_ms_i64();
+        hm.bytes_out.fetch_add(sent, std::memory_order_relaxed);
+        if (sent < hn + body.size()) {
+            if (sent < hn) {
+                c.out.append(hdr + sent, hn - sent);
+                c.out += body;
+            } else {
+                c.out.append(body, sent - hn, std::string::npos);
+            }
+            return; // POLLOUT drains the rest
+        }
+        if (c.close_after_flush) conn_close(c);
+    };
 
-        send_json(cfd, 404, "{\"ok\":false,\"error\":\"not found\"}");
-        ::close(cfd);
-        }); // end per-connection thread lambda
+    // Push-based event streaming: append any new tail-ring records as SSE
+    // frames. Runs on the network thread once per loop iteration, so the
+    // delivery latency is bounded by the poll timeout rather than by a
+    // client-side polling interval, and no executor or file I/O is involved.
+    auto conn_stream_pump = [&](HttpConn& c, int64_t now) {
+        if (c.fd < 0 || !c.streaming || !wal) return;
+        // Slow-consumer guard: a client that cannot keep up must not pin
+        // unbounded response memory on the server.
+        if (c.out.size() - c.out_off > 4 * 1024 * 1024) { conn_close(c); return; }
+        auto records = wal->tail_since(&c.stream_cursor, 256);
+        bool wrote = false;
+        for (size_t i = 0; i < records.size(); i++) {
+            if (!c.stream_match.empty() && records[i].find(c.stream_match) == std::string::npos) continue;
+            c.out += "id: ";
+            c.out += std::to_string(c.stream_cursor - records.size() + i);
+            c.out += "\ndata: ";
+            c.out += records[i];
+            c.out += "\n\n";
+            wrote = true;
+        }
+        if (!wrote && now - c.stream_last_ms > 15000) {
+            c.out += ": ping\n\n"; // comment frame; dead peers surface as send errors
+            wrote = true;
+        }
+        if (wrote) { c.stream_last_ms = now; conn_flush(c); }
+    };
+
+    // Parse buffered requests and dispatch them. A connection with a
+    // request in flight stops parsing until its completion arrives, which
+    // keeps pipelined responses in request order without a reorder buffer.
+    auto conn_parse = [&](HttpConn& c) {
+        while (c.fd >= 0 && !c.close_after_flush && !c.inflight && !c.streaming) {
+            HttpRequest rq;
+            int pr = c.parser.parse(c.in, rq, max_body_bytes);
+            if (pr == 0) break;
+            if (pr < 0) {
+                hm.bad_requests.fetch_add(1, std::memory_order_relaxed);
+                c.close_after_flush = true;
+                conn_send(c, 400, "{\"ok\":false,\"error\":\"bad request\"}", false);
+                break;
+            }
+            bool keep = http_keep_alive(rq);
+            hm.requests.fetch_add(1, std::memory_order_relaxed);
+            if (rq.method == "GET" && rq.path == "/health") {
+                // Answered on the network thread: liveness probes must not
+                // queue behind executor work.
+                if (!keep) c.close_after_flush = true;
+                conn_send(c, 200, "{\"ok\":true}", keep);
+                continue;
+            }
+            if (rq.method == "GET" && rq.path.rfind("/runs/", 0) == 0) {
+                // GET /runs/{id}/events[?cursor=N] — SSE push stream fed from
+                // the WAL tail ring. Owned by the network thread: the conn
+                // stays open and new records are appended each loop tick.
+                // WAL records carry job file names rather than a dedicated
+                // run id field, so {id} is matched as a record substring
+                // ("all" streams everything).
+                std::string rest = rq.path.substr(6);
+                auto qp = rest.find('?');
+                std::string query = qp == std::string::npos ? std::string() : rest.substr(qp + 1);
+                if (qp != std::string::npos) rest.resize(qp);
+                if (rest.size() > 7 && rest.compare(rest.size() - 7, 7, "/events") == 0) {
+                    if (workers == 0 || !wal) {
+                        if (!keep) c.close_after_flush = true;
+                        conn_send(c, 404, "{\"ok\":false,\"error\":\"event streaming requires integrated workers\"}", keep);
+                        continue;
+                    }
+                    std::string id = rest.substr(0, rest.size() - 7);
+                    c.streaming = true;
+                    sse_active.fetch_add(1, std::memory_order_relaxed);
+                    c.stream_match = (id == "all") ? std::string() : id;
+                    c.stream_cursor = wal->tail_seq();
+                    std::istringstream qs(query);
+                    std::string kv;
+                    while (std::getline(qs, kv, '&')) {
+                        if (kv.rfind("cursor=", 0) == 0)
+                            c.stream_cursor = (uint64_t)std::strtoull(kv.c_str() + 7, nullptr, 10);
+                    }
+                    // EventSource reconnects resume after the last delivered
+                    // record (our event ids are tail-ring sequences).
+                    auto lei = header_view_ci(rq.head, "last-event-id");
+                    if (!lei.empty())
+                        c.stream_cursor = (uint64_t)std::strtoull(std::string(lei).c_str(), nullptr, 10) + 1;
+                    c.out += "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+                             "Cache-Control: no-cache\r\nConnection: close\r\n\r\n";
+                    c.out += ": stream open cursor=" + std::to_string(c.stream_cursor) + "\n\n";
+                    c.stream_last_ms = now_ms_i64();
+                    conn_flush(c);
+                    break; // streaming conns stop parsing; the pump owns them now
+                }
+            }
+            c.inflight = true;
+            const int64_t t0 = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            httpq.push(http_work_priority(rq), HttpWork{c.id, c.client_key, std::move(rq), keep, t0});
+        }
+    };
+
+    auto conn_read = [&](HttpConn& c) {
+        char buf[8192];
+        for (;;) {
+            ssize_t n = ::recv(c.fd, buf, sizeof(buf), 0);
+            if (n > 0) {
+                hm.bytes_in.fetch_add((uint64_t)n, std::memory_order_relaxed);
+                c.in.append(buf, (size_t)n);
+                if ((size_t)n < sizeof(buf)) break;
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            conn_close(c); // disconnect or error
+            return;
+        }
+        c.last_ms = now_ms_i64();
+        conn_parse(c);
+    };
+
+    std::cerr << "[serve] http://" << host << ":" << port << " queue=" << q;
+    if (workers > 0) std::cerr << " (integrated workers=" << workers << ")";
+    std::cerr << "\n";
+
+    while (running.load()) {
+        std::vector<pollfd> fds;
+        fds.reserve(conns.size() + 2);
+        fds.push_back(pollfd{sfd, POLLIN, 0});
+        fds.push_back(pollfd{wakefd[0], POLLIN, 0});
+        bool have_stream = false;
+        for (auto& c : conns) {
+            short ev = POLLIN;
+            if (c->out_off < c->out.size()) ev = (short)(ev | POLLOUT);
+            if (c->streaming) have_stream = true;
+            fds.push_back(pollfd{c->fd, ev, 0});
+        }
+        const size_t nconns = conns.size();
+
+        // SSE delivery latency is bounded by this timeout; shorten it only
+        // while subscribers exist so the idle loop stays cheap.
+        int pn = ::poll(fds.data(), (nfds_t)fds.size(), have_stream ? 50 : 1000);
+        if (pn < 0 && errno != EINTR) break;
+        const int64_t now = now_ms_i64();
+
+        // Executor completions: route back by connection id, resume the
+        // connection's pipeline, and flush.
+        if (wakefd[0] >= 0 && (fds[1].revents & POLLIN)) {
+            char drain[64];
+            while (::read(wakefd[0], drain, sizeof(drain)) > 0) {}
+        }
         {
-            std::lock_guard<std::mutex> lk(http_threads_mu);
-            http_threads.push_back(std::move(t));
+            std::vector<HttpDone> completed;
+            {
+                std::lock_guard<std::mutex> lk(http_done_mu);
+                completed.swap(http_done);
+            }
+            for (auto& d : completed) {
+                HttpConn* c = nullptr;
+                for (auto& cp : conns) {
+                    if (cp->id == d.conn_id && cp->fd >= 0) { c = cp.get(); break; }
+                }
+                if (!c) continue; // connection went away mid-request
+                c->inflight = false;
+                if (d.shutdown) { c->shutdown_after_flush = true; c->close_after_flush = true; }
+                else if (!d.keep) c->close_after_flush = true;
+                conn_send(*c, d.code, d.body, d.keep, d.content_type, d.extra_headers);
+                if (c->fd >= 0 && !c->close_after_flush) conn_parse(*c);
+            }
         }
-    }
 
-    // graceful shutdown — join all HTTP threads before destroying shared state
-    {
-        std::lock_guard<std::mutex> lk(http_threads_mu);
-        for (auto& t : http_threads) {
-            if (t.joinable()) t.join();
+        // Existing connections (fds[i+2] pairs with conns[i]).
+        for (size_t i = 0; i < nconns; i++) {
+            HttpConn& c = *conns[i];
+            short re = fds[i + 2].revents;
+            if (c.fd < 0) continue;
+            if (re & POLLOUT) conn_flush(c);
+            if (c.fd >= 0 && (re & POLLIN)) conn_read(c);
+            else if (c.fd >= 0 && (re & (POLLERR | POLLHUP | POLLNVAL))) conn_close(c);
+            if (c.fd >= 0 && c.streaming) conn_stream_pump(c, now);
+            // Don't reap a connection that is waiting on an executor (a
+            // long /run_sync can legitimately exceed the idle timeout) or
+            // an SSE subscriber (idle between events by design).
+            if (c.fd >= 0 && !c.inflight && !c.streaming && idle_timeout_ms > 0 && now - c.last_ms > idle_timeout_ms) {
+                hm.conns_idle_reaped.fetch_add(1, std::memory_order_relaxed);
+                conn_close(c);
+            }
+        }
+        conns.erase(std::remove_if(conns.begin(), conns.end(),
+                                   [](const std::unique_ptr<HttpConn>& c) { return c->fd < 0; }),
+                    conns.end());
+
+        if (fds[0].revents & POLLIN) {
+            for (;;) {
+                sockaddr_in caddr{}; socklen_t clen = sizeof(caddr);
+                int cfd = ::accept(sfd, (sockaddr*)&caddr, &clen);
+                if (cfd < 0) break;
+                (void)::fcntl(cfd, F_SETFL, ::fcntl(cfd, F_GETFL, 0) | O_NONBLOCK);
+                auto c = std::make_unique<HttpConn>();
+                c->fd = cfd;
+                c->id = next_conn_id++;
+                c->client_key = (uint64_t)caddr.sin_addr.s_addr;
+                hm.conns_accepted.fetch_add(1, std::memory_order_relaxed);
+                c->last_ms = now;
+                if (conns.size() >= (size_t)max_http_conns) {
+                    hm.conns_over_cap.fetch_add(1, std::memory_order_relaxed);
+                    c->close_after_flush = true;
+                    conn_send(*c, 503, "{\"ok\":false,\"error\":\"too many connections\"}", false);
+                    if (c->fd < 0) continue;
+                }
+                conns.push_back(std::move(c));
+            }
         }
-        http_threads.clear();
     }
+
+    tool_sock.stop();
+    httpq.shutdown();
+    for (auto& t : http_executor_threads) if (t.joinable()) t.join();
+    if (wakefd[0] >= 0) ::close(wakefd[0]);
+    if (wakefd[1] >= 0) ::close(wakefd[1]);
+    for (auto& c : conns) if (c->fd >= 0) ::close(c->fd);
+    conns.clear();
     ::close(sfd);
     if (workers > 0) {
         stop_workers.store(true);
         memq.shutdown();
+        {
+            std::lock_guard<std::mutex> lk(pref_mu);
+            pref_closed = true;
+        }
+        pref_cv.notify_all();
         if (checkpoint_thread && checkpoint_thread->joinable()) checkpoint_thread->join();
         if (feeder_thread && feeder_thread->joinable()) feeder_thread->join();
+        if (prefetch_thread && prefetch_thread->joinable()) prefetch_thread->join();
         for (auto& t : worker_threads) if (t.joinable()) t.join();
         write_checkpoint();
     }
+    machina::gpu_sampler_stop();
+    // Give in-flight notifications a bounded chance to leave before the
+    // dispatcher tears down and drops what's left.
+    notifier.flush();
     return 0;
 }
 
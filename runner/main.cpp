@@ -50,7 +50,7 @@ static int cmd_tool_exec(int argc, char** argv) {
     ToolRunner runner;
     PluginManager plugin_mgr;
     RunnerRegistrar registrar{reg, runner, false};
-    reg.loadToolPackManifest((root / "toolpacks" / "tier0" / "manifest.json").string());
+    load_tier0_descs(reg, root);
     register_all_tier0_tools(runner);
 
     // Read request from stdin (capped at 10MB to prevent OOM)
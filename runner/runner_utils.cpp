@@ -1,8 +1,11 @@
 #include "runner_utils.h"
 #include "cmd_run.h"
+#include "machina/fast_rand.h"
 #include "machina/selector_gpu.h"
 #include "machina/json_mini.h"
 #include "machina/hash.h"
+#include "machina/runlog_index.h"
+#include "machina/uring.h"
 #include "machina/gpu_context.h"
 
 #include <algorithm>
@@ -11,6 +14,11 @@
 #include <random>
 #include <iostream>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace machina {
 
 static void warn_sensitive_root(const std::filesystem::path& root) {
@@ -201,7 +209,11 @@ std::filesystem::path resolve_path_for_replay(const std::string& input_path,
 }
 
 std::string gpu_signature() {
-    auto ctx = machina::GpuContext::create();
+    // shared(): the probe runs once per process instead of per call. The
+    // signature feeds replay_inputs, so it deliberately does not read the
+    // sampler snapshot — its value must not depend on whether a sampler
+    // happens to be running.
+    auto& ctx = machina::GpuContext::shared();
     std::ostringstream oss;
     oss << ctx.backend() << "|avail=" << (ctx.available() ? 1 : 0)
         << "|count=" << ctx.device_count()
@@ -273,30 +285,42 @@ std::string json_array_compact(const std::vector<std::string>& items) {
 std::string gen_run_id() {
     const char* det = std::getenv("MACHINA_DETERMINISTIC_RUN_ID");
 
-    uint64_t seed = 0;
+    uint64_t a, b;
     if (det && std::string(det) == "1") {
-        seed = 1234567ULL;
+        // Deterministic mode keeps the historical mt19937_64 stream so
+        // replay fixtures generated under it stay stable.
+        std::mt19937_64 rng{1234567ULL};
+        a = rng();
+        b = rng();
     } else {
-        uint64_t t = (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
-        uint64_t r = 0;
-        try {
-            std::random_device rd;
-            r = ((uint64_t)rd() << 32) ^ (uint64_t)rd();
-        } catch (...) {
-            r = 0x9e3779b97f4a7c15ULL;
-        }
-        seed = t ^ r;
+        // Thread-local PRNG seeded once: no /dev/urandom read per run id.
+        a = fast_rand64();
+        b = fast_rand64();
     }
-
-    std::mt19937_64 rng{seed};
-    uint64_t a = rng();
-    uint64_t b = rng();
     std::ostringstream oss;
     oss << std::hex << a << b;
     return oss.str();
 }
 
 Menu build_menu_from_registry(const Registry& reg, const std::vector<std::string>& tags) {
+    // Single-slot menu cache: consecutive steps almost always ask for the
+    // same tag set against an unchanged registry, so keying on (registry,
+    // generation, tag set) turns the rebuild into a copy. Thread-local
+    // because serve workers run goals concurrently.
+    struct MenuCache {
+        const Registry* reg{nullptr};
+        uint64_t gen{0};
+        std::string tag_key;
+        Menu menu;
+    };
+    thread_local MenuCache cache;
+
+    std::string tag_key;
+    for (const auto& t : tags) { tag_key += t; tag_key += '\n'; }
+    if (cache.reg == &reg && cache.gen == reg.generation() && cache.tag_key == tag_key) {
+        return cache.menu;
+    }
+
     auto tools = reg.queryByTags(tags);
     Menu menu;
     uint16_t sid = 1;
@@ -318,6 +342,10 @@ Menu build_menu_from_registry(const Registry& reg, const std::vector<std::string
         menu.items.push_back(mi);
     }
     menu.buildIndex();
+    cache.reg = &reg;
+    cache.gen = reg.generation();
+    cache.tag_key = std::move(tag_key);
+    cache.menu = menu;
     return menu;
 }
 
@@ -420,6 +448,9 @@ std::optional<std::filesystem::path> newest_new_log(const std::filesystem::path&
         if (!e.is_regular_file(ec)) continue;
         auto name = e.path().filename().string();
         if (before.find(name) != before.end()) continue;
+        // Sidecar indexes (run_*.jsonl.idx) live next to the logs; never
+        // mistake one for the run log itself.
+        if (ends_with(name, ".idx")) continue;
         auto t = e.last_write_time(ec);
         if (ec) continue;
         if (!best || t > best_t) { best = e.path(); best_t = t; }
@@ -434,6 +465,13 @@ std::filesystem::path default_queue_dir(const std::filesystem::path& root) {
 void ensure_queue_dirs(const std::filesystem::path& q) {
     std::error_code ec;
     std::filesystem::create_directories(q / "inbox", ec);
+    // Inbox shards (see inbox_shard_path). Created up front so enqueue
+    // writers never pay a create_directories check per job.
+    for (int i = 0; i < 256; i++) {
+        char sh[3];
+        std::snprintf(sh, sizeof(sh), "%02x", i);
+        std::filesystem::create_directories(q / "inbox" / sh, ec);
+    }
     std::filesystem::create_directories(q / "processing", ec);
     std::filesystem::create_directories(q / "retry", ec);
     std::filesystem::create_directories(q / "done", ec);
@@ -443,6 +481,50 @@ void ensure_queue_dirs(const std::filesystem::path& q) {
     std::filesystem::create_directories(q / "tmp", ec);
 }
 
+// FNV-1a over the job name; the shard is the low byte. Keep in sync with
+// the producer-side copy in tools/tier0/queue_tools.cpp.
+static uint64_t fnv1a64_str(const std::string& s) {
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+std::filesystem::path inbox_shard_path(const std::filesystem::path& inbox, const std::string& job_name) {
+    char sh[3];
+    std::snprintf(sh, sizeof(sh), "%02x", (unsigned)(fnv1a64_str(job_name) & 0xff));
+    return inbox / sh / job_name;
+}
+
+std::filesystem::path inbox_locate(const std::filesystem::path& inbox, const std::string& job_name) {
+    std::error_code ec;
+    auto sharded = inbox_shard_path(inbox, job_name);
+    if (std::filesystem::exists(sharded, ec)) return sharded;
+    auto flat = inbox / job_name;
+    if (std::filesystem::exists(flat, ec)) return flat;
+    return sharded;
+}
+
+std::vector<std::filesystem::path> claim_inbox_batch(const std::filesystem::path& inbox,
+                                                     const std::filesystem::path& claim_dir,
+                                                     size_t max_n,
+                                                     const std::string& suffix) {
+    std::vector<std::filesystem::path> claimed;
+    if (max_n == 0) return claimed;
+    std::error_code ec;
+    std::filesystem::create_directories(claim_dir, ec);
+    for (auto& p : list_inbox_json(inbox)) {
+        auto dst = claim_dir / (p.filename().string() + suffix);
+        std::filesystem::rename(p, dst, ec);
+        if (ec) { ec.clear(); continue; } // another claimer won this one
+        claimed.push_back(dst);
+        if (claimed.size() >= max_n) break;
+    }
+    return claimed;
+}
+
 std::string slurp_file(const std::filesystem::path& p) {
     std::ifstream f(p.string(), std::ios::binary);
     if (!f) return "";
@@ -522,11 +604,11 @@ void move_due_retries(const std::filesystem::path& retry_dir, const std::filesys
             if (parse_retry_name(fname, due2, rest)) {
                 fname = rest;
             }
-            auto dst = inbox_dir / fname;
+            auto dst = inbox_shard_path(inbox_dir, fname);
             if (std::filesystem::exists(dst, ec)) {
                 auto stem = dst.stem().string();
                 auto ext = dst.extension().string();
-                dst = inbox_dir / (stem + "_" + std::to_string(now_ms_i64()) + ext);
+                dst = inbox_shard_path(inbox_dir, stem + "_" + std::to_string(now_ms_i64()) + ext);
             }
             std::filesystem::rename(p, dst, ec);
             if (ec) {
@@ -611,6 +693,16 @@ std::vector<std::filesystem::path> list_inbox_json(const std::filesystem::path&
     if (!std::filesystem::exists(inbox, ec)) return v;
     for (auto& e : std::filesystem::directory_iterator(inbox, ec)) {
         if (ec) break;
+        if (e.is_directory(ec)) { // inbox shard
+            std::error_code sec;
+            for (auto& se : std::filesystem::directory_iterator(e.path(), sec)) {
+                if (sec) break;
+                if (!se.is_regular_file(sec)) continue;
+                auto sp = se.path();
+                if (sp.extension() == ".json") v.push_back(sp);
+            }
+            continue;
+        }
         if (!e.is_regular_file(ec)) continue;
         auto p = e.path();
         if (p.extension() == ".json") v.push_back(p);
@@ -689,6 +781,21 @@ std::string write_atomic_json(const std::filesystem::path& dst, const std::strin
     std::filesystem::create_directories(dst.parent_path(), ec);
     auto tmp = dst;
     tmp += ".tmp";
+#ifndef _WIN32
+    // io_uring backend: write+fsync+rename as one linked submission — one
+    // syscall instead of three, and the publish is durable. Falls through
+    // to the blocking path when the chain wrote nothing.
+    if (machina::uring_enabled()) {
+        int fd = ::open(tmp.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+        if (fd >= 0) {
+            std::string uerr;
+            bool ok = machina::uring_write_fsync_rename(
+                fd, body.data(), body.size(), tmp.string(), dst.string(), &uerr);
+            ::close(fd);
+            if (ok) return "";
+        }
+    }
+#endif
     {
         std::ofstream f(tmp.string(), std::ios::binary);
         if (!f) return "cannot write";
@@ -706,7 +813,8 @@ JobResult process_queue_job(const std::filesystem::path& proc_file,
                             const std::string& base_name,
                             char* argv0,
                             const std::filesystem::path& root,
-                            const std::filesystem::path& queue_dir) {
+                            const std::filesystem::path& queue_dir,
+                            const std::string* req_json) {
     JobResult jr;
     auto retry_dir  = queue_dir / "retry";
     auto done_dir   = queue_dir / "done";
@@ -732,21 +840,32 @@ JobResult process_queue_job(const std::filesystem::path& proc_file,
         auto rel = std::filesystem::relative(*newlog, root);
         jr.log_path = rel.empty() ? newlog->filename().string() : rel.string();
 
-        // Extract per-tool metrics from run log (tool_ok / tool_error events)
-        std::ifstream logf(newlog->string());
-        if (logf.good()) {
-            std::string line;
-            while (std::getline(logf, line)) {
-                if (line.empty()) continue;
-                auto ev = machina::json_mini::get_string(line, "event").value_or("");
-                if (ev != "tool_ok" && ev != "tool_error") continue;
-                auto payload_raw = machina::json_mini::get_object_raw(line, "payload").value_or("");
-                if (payload_raw.empty()) continue;
-                auto aid = machina::json_mini::get_string(payload_raw, "aid").value_or("");
-                auto dur = (int)machina::json_mini::get_int(payload_raw, "duration_ms").value_or(0);
-                if (!aid.empty()) {
-                    jr.tool_metrics.push_back({aid, ev == "tool_ok", dur});
-                }
+        // Extract per-tool metrics from the run log (tool_ok / tool_error
+        // events). The logger writes a sidecar index, so the common case is
+        // a couple of seeks at the matching lines; logs without a usable
+        // index (pre-index runs) fall back to the full scan.
+        auto consume_line = [&](const std::string& line) {
+            if (line.empty()) return;
+            auto ev = machina::json_mini::get_string(line, "event").value_or("");
+            if (ev != "tool_ok" && ev != "tool_error") return;
+            auto payload_raw = machina::json_mini::get_object_raw(line, "payload").value_or("");
+            if (payload_raw.empty()) return;
+            auto aid = machina::json_mini::get_string(payload_raw, "aid").value_or("");
+            auto dur = (int)machina::json_mini::get_int(payload_raw, "duration_ms").value_or(0);
+            if (!aid.empty()) {
+                jr.tool_metrics.push_back({aid, ev == "tool_ok", dur});
+            }
+        };
+        std::vector<std::string> metric_lines;
+        if (machina::runlog_index::read_event_lines(newlog->string(),
+                                                    {"tool_ok", "tool_error"},
+                                                    &metric_lines)) {
+            for (const auto& line : metric_lines) consume_line(line);
+        } else {
+            std::ifstream logf(newlog->string());
+            if (logf.good()) {
+                std::string line;
+                while (std::getline(logf, line)) consume_line(line);
             }
         }
     } else {
@@ -766,7 +885,7 @@ JobResult process_queue_job(const std::filesystem::path& proc_file,
     int64_t backoff_max_ms = backoff_max_env;
     int64_t backoff_jitter_ms = backoff_jitter_env;
     {
-        auto req_str = slurp_file(proc_file);
+        std::string req_str = req_json ? *req_json : slurp_file(proc_file);
         auto qmeta = machina::json_mini::get_object_raw(req_str, "_queue").value_or("");
         if (!qmeta.empty()) {
             if (auto v = machina::json_mini::get_int(qmeta, "max_attempts")) jr.max_attempts = (int)*v;
@@ -799,7 +918,7 @@ JobResult process_queue_job(const std::filesystem::path& proc_file,
             }
             rest += ".a" + std::to_string(next_attempt) + ".json";
 
-            auto req_str = slurp_file(proc_file);
+            std::string req_str = req_json ? *req_json : slurp_file(proc_file);
             std::string last_error = std::string("exit_code=") + std::to_string(jr.exit_code) + ";log=" + jr.log_path;
             std::string patched = patch_queue_meta_for_retry(req_str, next_attempt, jr.max_attempts, due, last_error);
 
@@ -76,6 +76,24 @@ std::optional<std::filesystem::path> newest_new_log(const std::filesystem::path&
                                                     const std::unordered_set<std::string>& before);
 std::filesystem::path default_queue_dir(const std::filesystem::path& root);
 void ensure_queue_dirs(const std::filesystem::path& q);
+
+// Sharded inbox: pending jobs live under inbox/<xx> (two hex chars of a
+// filename hash) so burst enqueues don't pile tens of thousands of files
+// into one readdir. Flat inbox files remain valid and are still scanned,
+// so pre-sharding queues and hand-dropped jobs keep working.
+std::filesystem::path inbox_shard_path(const std::filesystem::path& inbox, const std::string& job_name);
+
+// Resolve a job name to its current location: shard first, then the flat
+// inbox path. Returns the shard path when the file exists in neither.
+std::filesystem::path inbox_locate(const std::filesystem::path& inbox, const std::string& job_name);
+
+// One scan pass that rename-claims up to max_n pending jobs (in priority
+// order) into claim_dir, appending `suffix` to each name. Racing claimers
+// lose individual renames silently; returns the paths actually claimed.
+std::vector<std::filesystem::path> claim_inbox_batch(const std::filesystem::path& inbox,
+                                                     const std::filesystem::path& claim_dir,
+                                                     size_t max_n,
+                                                     const std::string& suffix = ".processing");
 std::string slurp_file(const std::filesystem::path& p);
 int64_t getenv_i64(const char* k, int64_t defv);
 
@@ -127,11 +145,14 @@ struct JobResult {
 // proc_file: the .processing file (already moved from inbox)
 // base_name: original filename (without .processing suffix)
 // Backoff config from _queue metadata or env defaults.
+// req_json: the job file's content when the caller already has it in
+// memory (prefetch); nullptr re-reads from proc_file.
 // Returns structured result. Caller handles WAL/counters/logging.
 JobResult process_queue_job(const std::filesystem::path& proc_file,
                             const std::string& base_name,
                             char* argv0,
                             const std::filesystem::path& root,
-                            const std::filesystem::path& queue_dir);
+                            const std::filesystem::path& queue_dir,
+                            const std::string* req_json = nullptr);
 
 } // namespace machina
@@ -4,10 +4,15 @@
 
 #ifndef _WIN32
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <cstdio>
+#include <deque>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include <csignal>
@@ -30,6 +35,171 @@ inline void set_socket_timeouts(int fd, int timeout_sec = 10) {
     ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
 }
 
+// Case-insensitive header lookup returning a view into `head` (valid only
+// while the underlying string is alive and unmodified). Single pass, no
+// allocation — the hot auth path calls this several times per request.
+inline std::string_view header_view_ci(std::string_view head, std::string_view key_lower) {
+    size_t pos = head.find("\r\n"); // skip the request line
+    while (pos != std::string_view::npos && pos + 2 < head.size()) {
+        pos += 2;
+        size_t eol = head.find("\r\n", pos);
+        std::string_view line = head.substr(pos, (eol == std::string_view::npos ? head.size() : eol) - pos);
+        if (line.size() > key_lower.size() && line[key_lower.size()] == ':') {
+            bool match = true;
+            for (size_t i = 0; i < key_lower.size(); i++) {
+                char c = line[i];
+                if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+                if (c != key_lower[i]) { match = false; break; }
+            }
+            if (match) {
+                std::string_view v = line.substr(key_lower.size() + 1);
+                while (!v.empty() && (v.front() == ' ' || v.front() == '\t')) v.remove_prefix(1);
+                return v;
+            }
+        }
+        pos = eol;
+    }
+    return {};
+}
+
+// Extract Content-Length from a header block. Returns false on a duplicate
+// Content-Length header (request smuggling vector) — callers must reject.
+inline bool http_content_length(const std::string& head, size_t& cl) {
+    cl = 0;
+    int cl_count = 0;
+    const std::string_view h{head};
+    size_t pos = h.find("\r\n"); // skip the request line
+    while (pos != std::string_view::npos && pos + 2 < h.size()) {
+        pos += 2;
+        size_t eol = h.find("\r\n", pos);
+        std::string_view line = h.substr(pos, (eol == std::string_view::npos ? h.size() : eol) - pos);
+        constexpr std::string_view key = "content-length";
+        if (line.size() > key.size() && line[key.size()] == ':') {
+            bool match = true;
+            for (size_t i = 0; i < key.size(); i++) {
+                char c = line[i];
+                if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+                if (c != key[i]) { match = false; break; }
+            }
+            if (match) {
+                cl_count++;
+                if (cl_count > 1) return false; // duplicate Content-Length: request smuggling
+                std::string_view v = line.substr(key.size() + 1);
+                while (!v.empty() && (v.front() == ' ' || v.front() == '\t')) v.remove_prefix(1);
+                size_t val = 0;
+                for (char c : v) {
+                    if (c < '0' || c > '9') break;
+                    val = val * 10 + (size_t)(c - '0');
+                }
+                cl = val;
+            }
+        }
+        pos = eol;
+    }
+    return true;
+}
+
+// One parsed HTTP request. `head` keeps the raw header block (request line
+// included, terminated by \r\n\r\n) because the auth helpers below operate
+// on it directly.
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::string ver;
+    std::string head;
+    std::string body;
+};
+
+// Incremental parser over a connection's receive buffer. One instance per
+// connection: `scan_off` remembers how far the header-terminator search got,
+// so each feed only scans bytes that arrived since the last call instead of
+// re-walking the whole buffer on every recv. parse() carves exactly one
+// complete request off the front of `inbuf` (so pipelined requests are
+// consumed one at a time) and returns:
+//    1  request parsed into `out` and consumed from `inbuf`
+//    0  need more bytes
+//   -1  malformed / over-limit — caller should 400 and close
+// Enforces the same caps as read_http_request: 1MB header block, duplicate
+// Content-Length rejection, and Content-Length > max_body rejected before
+// the body is buffered.
+struct HttpParser {
+    size_t scan_off{0}; // prefix of inbuf known not to contain "\r\n\r\n"
+
+    int parse(std::string& inbuf, HttpRequest& out, size_t max_body = 0) {
+        if (max_body == 0) max_body = 2 * 1024 * 1024; // default 2MB
+        // Back up 3 bytes so a terminator split across recvs is still found.
+        size_t start = scan_off > 3 ? scan_off - 3 : 0;
+        size_t p = inbuf.find("\r\n\r\n", start);
+        if (p == std::string::npos) {
+            if (inbuf.size() > 1024 * 1024) return -1; // header cap 1MB
+            scan_off = inbuf.size();
+            return 0;
+        }
+        std::string head = inbuf.substr(0, p + 4);
+        size_t cl = 0;
+        if (!http_content_length(head, cl)) return -1;
+        if (cl > max_body) return -1;
+        if (inbuf.size() - (p + 4) < cl) return 0; // body still in flight
+        out.head = std::move(head);
+        out.body = inbuf.substr(p + 4, cl);
+        inbuf.erase(0, p + 4 + cl);
+        scan_off = 0; // next request starts at the buffer front
+        // Request line: METHOD SP PATH SP VERSION — split in place.
+        const std::string& h = out.head;
+        size_t eol = h.find("\r\n");
+        size_t a = h.find(' ');
+        if (a == std::string::npos || a >= eol) return -1;
+        size_t b = h.find(' ', a + 1);
+        if (b == std::string::npos || b >= eol) return -1;
+        out.method = h.substr(0, a);
+        out.path = h.substr(a + 1, b - a - 1);
+        out.ver = h.substr(b + 1, eol - b - 1);
+        return !out.method.empty() && !out.path.empty() ? 1 : -1;
+    }
+};
+
+// Stateless convenience wrapper (rescans from the front each call).
+inline int http_parse_request(std::string& inbuf, HttpRequest& out, size_t max_body = 0) {
+    HttpParser p;
+    return p.parse(inbuf, out, max_body);
+}
+
+// Format response headers into a caller-provided (typically stack) buffer.
+// Returns the header length, or 0 if it doesn't fit — callers fall back to
+// the heap-allocating format_http_response path. Lets the event loop emit
+// header + body with one writev instead of concatenating them first.
+inline size_t http_format_headers(char* dst, size_t cap, int code, size_t body_len,
+                                  bool keep_alive, const std::string& content_type,
+                                  const std::string& extra_headers) {
+    int n = std::snprintf(dst, cap,
+                          "HTTP/1.1 %d %s\r\n"
+                          "Content-Type: %s\r\n"
+                          "Content-Length: %zu\r\n"
+                          "%s"
+                          "Connection: %s\r\n\r\n",
+                          code, code == 200 ? "OK" : "ERR",
+                          content_type.c_str(), body_len,
+                          extra_headers.c_str(),
+                          keep_alive ? "keep-alive" : "close");
+    if (n <= 0 || (size_t)n >= cap) return 0;
+    return (size_t)n;
+}
+
+// Format a full response for queueing on a nonblocking connection. The
+// event loop owns the actual write; this only builds the bytes.
+inline std::string format_http_response(int code, const std::string& body, bool keep_alive,
+                                        const std::string& content_type = "application/json",
+                                        const std::string& extra_headers = "") {
+    std::ostringstream oss;
+    oss << "HTTP/1.1 " << code << " " << (code == 200 ? "OK" : "ERR") << "\r\n";
+    oss << "Content-Type: " << content_type << "\r\n";
+    oss << "Content-Length: " << body.size() << "\r\n";
+    oss << extra_headers;
+    oss << "Connection: " << (keep_alive ? "keep-alive" : "close") << "\r\n\r\n";
+    oss << body;
+    return oss.str();
+}
+
 // max_body: maximum body size in bytes. Content-Length exceeding this is rejected
 // immediately without reading the body. 0 = use default 2MB cap.
 inline bool read_http_request(int fd, std::string& head, std::string& body, size_t max_body = 0) {
@@ -52,23 +222,7 @@ inline bool read_http_request(int fd, std::string& head, std::string& body, size
     std::string rest = all.substr(p + 4);
 
     size_t cl = 0;
-    {
-        int cl_count = 0;
-        std::istringstream iss(head);
-        std::string line;
-        while (std::getline(iss, line)) {
-            if (!line.empty() && line.back() == '\r') line.pop_back();
-            std::string low = line;
-            for (char& c : low) if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
-            if (low.rfind("content-length:", 0) == 0) {
-                cl_count++;
-                if (cl_count > 1) return false; // duplicate Content-Length: request smuggling
-                std::string v = line.substr(15);
-                while (!v.empty() && (v[0] == ' ' || v[0] == '\t')) v.erase(0, 1);
-                try { cl = (size_t)std::stoull(v); } catch (...) { cl = 0; }
-            }
-        }
-    }
+    if (!http_content_length(head, cl)) return false;
 
     // Early reject: Content-Length exceeds configured max — don't read the body
     if (cl > max_body) return false;
@@ -100,24 +254,38 @@ inline void send_json(int fd, int code, const std::string& json) {
     }
 }
 
-inline std::string header_value_ci(const std::string& head, const std::string& key_lower) {
-    std::istringstream iss(head);
-    std::string line;
-    std::getline(iss, line);
-    while (std::getline(iss, line)) {
-        if (!line.empty() && line.back() == '\r') line.pop_back();
-        if (line.empty()) continue;
-        auto c = line.find(':');
-        if (c == std::string::npos) continue;
-        std::string k = line.substr(0, c);
-        for (char& ch : k) if (ch >= 'A' && ch <= 'Z') ch = (char)(ch - 'A' + 'a');
-        if (k == key_lower) {
-            std::string v = line.substr(c + 1);
-            while (!v.empty() && (v[0] == ' ' || v[0] == '\t')) v.erase(0, 1);
-            return v;
-        }
+// Raw octet-stream response with optional extra headers (each terminated
+// by \r\n). Used by the WAL follower stream to ship segment bytes as-is.
+inline void send_raw(int fd, int code, const std::string& body,
+                     const std::string& extra_headers = "") {
+    std::ostringstream oss;
+    oss << "HTTP/1.1 " << code << " " << (code == 200 ? "OK" : "ERR") << "\r\n";
+    oss << "Content-Type: application/octet-stream\r\n";
+    oss << "Content-Length: " << body.size() << "\r\n";
+    oss << extra_headers;
+    oss << "Connection: close\r\n\r\n";
+    oss << body;
+    auto s = oss.str();
+    size_t sent = 0;
+    while (sent < s.size()) {
+        ssize_t n = ::send(fd, s.data() + sent, s.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += (size_t)n;
     }
-    return "";
+}
+
+inline std::string header_value_ci(const std::string& head, const std::string& key_lower) {
+    return std::string(header_view_ci(head, key_lower));
+}
+
+// Connection persistence per RFC 7230: HTTP/1.1 defaults to keep-alive
+// unless the client sends "Connection: close"; HTTP/1.0 must opt in.
+inline bool http_keep_alive(const HttpRequest& rq) {
+    std::string c(header_view_ci(rq.head, "connection"));
+    for (char& ch : c) if (ch >= 'A' && ch <= 'Z') ch = (char)(ch - 'A' + 'a');
+    if (c == "close") return false;
+    if (rq.ver == "HTTP/1.0") return c == "keep-alive";
+    return true;
 }
 
 inline bool api_token_ok(const std::string& head, const std::string& expected_token) {
@@ -162,19 +330,146 @@ struct TokenBucket {
     }
 };
 
+// Lock-free per-client rate limiter. A fixed-size open-addressed table of
+// token buckets keyed by client hash; `allow` is a single CAS loop, so rate
+// checks never serialize executors behind a mutex. Each bucket packs its
+// fill level and last-refill time into one 64-bit word:
+//
+//   [63..38] tokens, fixed point 1/1024   [37..0] ms since limiter init
+//
+// which makes refill-and-spend atomic. Collisions beyond the probe window
+// fall back to sharing the home slot — two clients splitting one budget is
+// the conservative failure mode for a limiter. rpm is clamped to 65535 so
+// the fill level always fits its 26 bits.
+class ShardedRateLimiter {
+public:
+    void init(int rpm, int64_t now_ms) {
+        rpm_ = rpm > 65535 ? 65535 : rpm;
+        epoch_ms_ = now_ms;
+        if (rpm_ > 0) {
+            const uint64_t full = encode((uint64_t)rpm_ << kFpShift, 0);
+            for (auto& s : slots_) { s.key.store(0, std::memory_order_relaxed);
+                                     s.state.store(full, std::memory_order_relaxed); }
+        }
+    }
+
+    // One token per request; `client_key` is any stable per-client value
+    // (e.g. the raw IPv4 address) — it is mixed here before indexing.
+    bool allow(uint64_t client_key, int64_t now_ms) {
+        if (rpm_ <= 0) return true;
+        uint64_t key = mix(client_key);
+        if (key == 0) key = 1; // 0 marks an unclaimed slot
+        Slot& s = find_or_claim(key);
+        const uint64_t now_rel = clamp_rel(now_ms - epoch_ms_);
+        uint64_t cur = s.state.load(std::memory_order_relaxed);
+        for (;;) {
+            uint64_t tokens = cur >> kMsBits;
+            const uint64_t last_rel = cur & kMsMask;
+            if (now_rel > last_rel) {
+                // refill: rpm tokens per 60s, in 1/1024ths
+                uint64_t dt = now_rel - last_rel;
+                if (dt > 60000) dt = 60000;
+                tokens += dt * (uint64_t)rpm_ * 1024 / 60000;
+                const uint64_t cap = (uint64_t)rpm_ << kFpShift;
+                if (tokens > cap) tokens = cap;
+            }
+            if (tokens < (1u << kFpShift)) return false; // no full token: no write needed
+            const uint64_t next = encode(tokens - (1u << kFpShift), now_rel);
+            if (s.state.compare_exchange_weak(cur, next, std::memory_order_relaxed)) return true;
+            // cur reloaded by the failed CAS; re-derive from the fresh word
+        }
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint64_t> state{0};
+    };
+    static constexpr int kFpShift = 10;
+    static constexpr int kMsBits = 38;
+    static constexpr uint64_t kMsMask = ((uint64_t)1 << kMsBits) - 1;
+    static constexpr size_t kSlots = 1024; // power of two
+    static constexpr size_t kProbes = 8;
+
+    static uint64_t encode(uint64_t tokens_fp, uint64_t ms_rel) {
+        return (tokens_fp << kMsBits) | (ms_rel & kMsMask);
+    }
+    static uint64_t clamp_rel(int64_t d) {
+        if (d < 0) return 0;
+        return (uint64_t)d & kMsMask;
+    }
+    static uint64_t mix(uint64_t x) { // splitmix64 finalizer
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    Slot& find_or_claim(uint64_t key) {
+        const size_t home = (size_t)key & (kSlots - 1);
+        for (size_t p = 0; p < kProbes; p++) {
+            Slot& s = slots_[(home + p) & (kSlots - 1)];
+            uint64_t k = s.key.load(std::memory_order_acquire);
+            if (k == key) return s;
+            if (k == 0) {
+                uint64_t expected = 0;
+                if (s.key.compare_exchange_strong(expected, key, std::memory_order_acq_rel)) return s;
+                if (expected == key) return s; // raced with ourselves on another thread
+            }
+        }
+        return slots_[home]; // table region full: share the home bucket
+    }
+
+    int rpm_{0};
+    int64_t epoch_ms_{0};
+    std::array<Slot, kSlots> slots_{};
+};
+
 inline int64_t now_ms_wall() {
     return (int64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::system_clock::now().time_since_epoch()).count();
 }
 
+// Replay cache for api_hmac_ok. Nonces arrive with monotonically
+// non-decreasing timestamps, so the deque front is always the oldest
+// entry: TTL pruning and the hard cap both pop from the front in O(1)
+// amortized, instead of the old full-map sweep plus linear min-scans
+// that stalled signed requests whenever the cache filled. A nonce
+// reused after expiry leaves a stale deque entry behind; the timestamp
+// comparison on pop skips it (lazy deletion).
+struct NonceCache {
+    std::unordered_map<std::string, int64_t> seen;     // nonce → last-seen ms
+    std::deque<std::pair<int64_t, std::string>> order; // (seen ms, nonce), oldest first
+    size_t max_entries{100000}; // ~2min of headroom at 50k nonces/min
+
+    // Returns false if the nonce was already used inside the TTL window.
+    bool check_and_insert(const std::string& nonce, int64_t now_ms, int64_t ttl_ms) {
+        auto it = seen.find(nonce);
+        if (it != seen.end() && now_ms - it->second < ttl_ms) return false;
+        seen[nonce] = now_ms;
+        order.emplace_back(now_ms, nonce);
+        while (!order.empty() &&
+               (now_ms - order.front().first >= ttl_ms || order.size() > max_entries)) {
+            auto mit = seen.find(order.front().second);
+            if (mit != seen.end() && mit->second == order.front().first) seen.erase(mit);
+            order.pop_front();
+        }
+        return true;
+    }
+
+    size_t size() const { return seen.size(); }
+};
+
+// key is the precomputed schedule for the configured secret (built once at
+// startup); nullptr means HMAC auth is not configured.
 inline bool api_hmac_ok(const std::string& head,
                         const std::string& method,
                         const std::string& path,
                         const std::string& body,
-                        const std::string& secret,
+                        const HmacKey* key,
                         int ttl_sec,
-                        std::unordered_map<std::string, int64_t>& nonce_cache) {
-    if (secret.empty()) return true;
+                        NonceCache& nonce_cache) {
+    if (!key) return true;
     if (ttl_sec <= 0) ttl_sec = 60;
 
     std::string ts_s = header_value_ci(head, "x-machina-ts");
@@ -194,32 +489,11 @@ inline bool api_hmac_ok(const std::string& head,
     long long skew = (tsec > now) ? (tsec - now) : (now - tsec);
     if (skew > ttl_sec) return false;
 
-    const int64_t now_wall = now_ms_wall();
-    auto it = nonce_cache.find(nonce);
-    if (it != nonce_cache.end()) {
-        if (now_wall - it->second < (int64_t)ttl_sec * 1000) return false;
-    }
-    nonce_cache[nonce] = now_wall;
-
-    if (nonce_cache.size() > 5000) {
-        // TTL-based pruning first
-        for (auto iter = nonce_cache.begin(); iter != nonce_cache.end(); ) {
-            if (now_wall - iter->second > (int64_t)ttl_sec * 1000) iter = nonce_cache.erase(iter);
-            else ++iter;
-        }
-        // Hard cap: evict oldest entries (not random begin()) to prevent replay
-        while (nonce_cache.size() > 10000) {
-            auto oldest = nonce_cache.begin();
-            for (auto jt = nonce_cache.begin(); jt != nonce_cache.end(); ++jt) {
-                if (jt->second < oldest->second) oldest = jt;
-            }
-            nonce_cache.erase(oldest);
-        }
-    }
+    if (!nonce_cache.check_and_insert(nonce, now_ms_wall(), (int64_t)ttl_sec * 1000)) return false;
 
     std::string body_hash = machina::sha256_hex(body);
     std::string canon = ts_s + "\n" + nonce + "\n" + method + "\n" + path + "\n" + body_hash + "\n";
-    std::string expected = machina::hmac_sha256_hex(secret, canon);
+    std::string expected = key->sign_hex(canon);
 
     std::string got = sig;
     if (got.rfind("v1=", 0) == 0) got = got.substr(3);
@@ -0,0 +1,172 @@
+#pragma once
+
+// Length-prefixed binary tool dispatch over a Unix domain socket.
+//
+// High-frequency localhost callers (the Python autonomic engine) pay more
+// for HTTP parsing and JSON re-serialization than for the tools they call.
+// This transport carries a pre-validated AID and the raw input payload
+// straight to ToolRunner, with no HTTP and no response re-encoding:
+//
+//   request:  u32le aid_len, aid bytes, u32le input_len, input bytes
+//   response: u8 status (StepStatus value), u32le output_len, output bytes,
+//             u32le error_len, error bytes
+//
+// Frames are pipelined over persistent connections; a malformed frame
+// (oversized length, short read) closes the connection. Access control is
+// filesystem permissions on the socket path (created 0700-dir style via
+// chmod 0600), which is why this is only offered on a Unix socket and not
+// a TCP port.
+
+#ifndef _WIN32
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "machina/state.h"
+#include "machina/tools.h"
+
+namespace machina {
+
+class ToolSockServer {
+public:
+    ~ToolSockServer() { stop(); }
+
+    // Binds `path` (replacing any stale socket file) and starts the
+    // acceptor. Returns false with `err` set on failure.
+    bool start(const std::string& path, const ToolRunner& runner, std::string& err) {
+        runner_ = &runner;
+        path_ = path;
+        sockaddr_un addr{};
+        if (path.size() >= sizeof(addr.sun_path)) { err = "socket path too long"; return false; }
+        lfd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (lfd_ < 0) { err = "socket() failed"; return false; }
+        ::unlink(path.c_str());
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        if (::bind(lfd_, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            err = "bind failed: " + path;
+            ::close(lfd_); lfd_ = -1;
+            return false;
+        }
+        ::chmod(path.c_str(), 0600); // owner-only: the socket is the auth boundary
+        if (::listen(lfd_, 16) != 0) {
+            err = "listen failed";
+            ::close(lfd_); lfd_ = -1;
+            return false;
+        }
+        acceptor_ = std::thread([this]() { accept_loop(); });
+        return true;
+    }
+
+    void stop() {
+        if (lfd_ >= 0) { ::shutdown(lfd_, SHUT_RDWR); ::close(lfd_); lfd_ = -1; }
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            for (int fd : conn_fds_) ::shutdown(fd, SHUT_RDWR);
+        }
+        if (acceptor_.joinable()) acceptor_.join();
+        for (auto& t : conn_threads_) if (t.joinable()) t.join();
+        conn_threads_.clear();
+        if (!path_.empty()) ::unlink(path_.c_str());
+    }
+
+private:
+    static constexpr uint32_t kMaxAid = 256;
+    static constexpr uint32_t kMaxInput = 10 * 1024 * 1024; // matches toolhost's stdin cap
+
+    static bool read_exact(int fd, void* buf, size_t n) {
+        char* p = (char*)buf;
+        while (n > 0) {
+            ssize_t r = ::read(fd, p, n);
+            if (r <= 0) return false;
+            p += r; n -= (size_t)r;
+        }
+        return true;
+    }
+
+    static bool write_exact(int fd, const void* buf, size_t n) {
+        const char* p = (const char*)buf;
+        while (n > 0) {
+            ssize_t w = ::write(fd, p, n);
+            if (w <= 0) return false;
+            p += w; n -= (size_t)w;
+        }
+        return true;
+    }
+
+    static uint32_t get_u32(const unsigned char* b) {
+        return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+    }
+    static void put_u32(unsigned char* b, uint32_t v) {
+        b[0] = (unsigned char)v; b[1] = (unsigned char)(v >> 8);
+        b[2] = (unsigned char)(v >> 16); b[3] = (unsigned char)(v >> 24);
+    }
+
+    void accept_loop() {
+        for (;;) {
+            int cfd = ::accept(lfd_, nullptr, nullptr);
+            if (cfd < 0) return; // listener closed by stop()
+            std::lock_guard<std::mutex> lk(mu_);
+            conn_fds_.push_back(cfd);
+            conn_threads_.emplace_back([this, cfd]() { serve_conn(cfd); });
+        }
+    }
+
+    void serve_conn(int fd) {
+        std::string aid, input, out;
+        unsigned char len4[4];
+        for (;;) {
+            if (!read_exact(fd, len4, 4)) break;
+            uint32_t alen = get_u32(len4);
+            if (alen == 0 || alen > kMaxAid) break;
+            aid.resize(alen);
+            if (!read_exact(fd, aid.data(), alen)) break;
+            if (!read_exact(fd, len4, 4)) break;
+            uint32_t ilen = get_u32(len4);
+            if (ilen > kMaxInput) break;
+            input.resize(ilen);
+            if (ilen > 0 && !read_exact(fd, input.data(), ilen)) break;
+
+            DSState ds_tmp;
+            ToolResult r = runner_->run(aid, input, ds_tmp);
+
+            // status byte + the two payloads, header assembled once so the
+            // common small response goes out in a single write
+            out.clear();
+            out.reserve(9 + r.output_json.size() + 4 + r.error.size());
+            out.push_back((char)static_cast<unsigned char>(r.status));
+            unsigned char n4[4];
+            put_u32(n4, (uint32_t)r.output_json.size());
+            out.append((const char*)n4, 4);
+            out += r.output_json;
+            put_u32(n4, (uint32_t)r.error.size());
+            out.append((const char*)n4, 4);
+            out += r.error;
+            if (!write_exact(fd, out.data(), out.size())) break;
+        }
+        ::close(fd);
+        std::lock_guard<std::mutex> lk(mu_);
+        for (auto& f : conn_fds_) if (f == fd) { f = -1; break; }
+    }
+
+    const ToolRunner* runner_{nullptr};
+    std::string path_;
+    int lfd_{-1};
+    std::thread acceptor_;
+    std::mutex mu_;
+    std::vector<int> conn_fds_;
+    std::vector<std::thread> conn_threads_;
+};
+
+} // namespace machina
+
+#endif // _WIN32
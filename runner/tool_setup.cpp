@@ -1,8 +1,14 @@
 #include "tool_setup.h"
 #include "tools/tier0/genesis.h"
+#include "tools/tier0/tier0_descs.h"
 
+#include "machina/hash.h"
+
+#include <algorithm>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <unordered_set>
 
@@ -20,6 +26,7 @@ static const std::unordered_set<std::string> ISOLATED_TOOL_AIDS = {
     "AID.FILE.WRITE.v1",
     "AID.MEMORY.APPEND.v1",
     "AID.VECDB.UPSERT.v1",
+    "AID.VECDB.UPSERT_BATCH.v1",
     // Tier 2: System (shell, network)
     "AID.SHELL.EXEC.v1",
     "AID.NET.HTTP_GET.v1",
@@ -33,21 +40,26 @@ static const std::unordered_set<std::string> ISOLATED_TOOL_AIDS = {
 void register_all_tier0_tools(ToolRunner& runner) {
     runner.registerTool("AID.ERROR_SCAN.v1", tool_error_scan_csv);
     runner.registerTool("AID.FILE.READ.v1", tool_file_read);
+    runner.registerTool("AID.FILE.READ_MANY.v1", tool_file_read_many);
     runner.registerTool("AID.FILE.WRITE.v1", tool_file_write);
     runner.registerTool("AID.SHELL.EXEC.v1", tool_shell_exec);
     runner.registerTool("AID.NET.HTTP_GET.v1", tool_http_get);
+    runner.registerTool("AID.NET.HTTP_GET_MANY.v1", tool_http_get_many);
     runner.registerTool("AID.QUEUE.ENQUEUE.v1", tool_queue_enqueue);
     runner.registerTool("AID.NOOP.v1", tool_noop);
     runner.registerTool("AID.ASK_SUP.v1", tool_ask_sup);
     runner.registerTool("AID.GPU_SMOKE.v1", tool_gpu_smoke);
     runner.registerTool("AID.GPU_METRICS.v1", tool_gpu_metrics);
     runner.registerTool("AID.PROC.SELF_METRICS.v1", tool_proc_self_metrics);
+    runner.registerTool("AID.TOOL.METRICS.v1", tool_tool_metrics);
     runner.registerTool("AID.REPORT_SUMMARY.v1", tool_report_summary);
     runner.registerTool("AID.MEMORY.APPEND.v1", tool_memory_append);
     runner.registerTool("AID.MEMORY.SEARCH.v1", tool_memory_search);
     runner.registerTool("AID.MEMORY.QUERY.v1", tool_memory_query);
     runner.registerTool("AID.EMBED.TEXT.v1", tool_embed_text);
+    runner.registerTool("AID.EMBED.BATCH.v1", tool_embed_batch);
     runner.registerTool("AID.VECDB.UPSERT.v1", tool_vecdb_upsert);
+    runner.registerTool("AID.VECDB.UPSERT_BATCH.v1", tool_vecdb_upsert_batch);
     runner.registerTool("AID.VECDB.QUERY.v1", tool_vecdb_query);
     runner.registerTool("AID.RUN.LOG.SUMMARY.v1", tool_run_log_summary);
 
@@ -57,13 +69,116 @@ void register_all_tier0_tools(ToolRunner& runner) {
     runner.registerTool("AID.GENESIS.LOAD_PLUGIN.v1", tool_genesis_load_plugin);
 }
 
+void load_tier0_descs(Registry& reg, const std::filesystem::path& root) {
+    auto manifest_path = (root / "toolpacks" / "tier0" / "manifest.json").string();
+
+    // Fast path: the manifest still hashes to the value the compile-time
+    // table was generated from, so registering straight from the table is
+    // equivalent to parsing it — one file read, no JSON, no intermediate
+    // descriptor vectors. Any manifest edit flips to the parser until
+    // scripts/gen_tier0_descs.py is re-run.
+    {
+        std::ifstream f(manifest_path);
+        if (f) {
+            std::ostringstream ss;
+            ss << f.rdbuf();
+            if (hash::fnv1a64(ss.str()) == tier0_descs::kManifestFnv1a64) {
+                for (size_t i = 0; i < tier0_descs::kToolCount; i++) {
+                    const auto& s = tier0_descs::kTools[i];
+                    ToolDesc d;
+                    d.aid = std::string(s.aid);
+                    d.name = std::string(s.name);
+                    d.deterministic = s.deterministic;
+                    for (size_t j = 0; j < s.tag_count; j++) d.tags.emplace_back(s.tags[j]);
+                    for (size_t j = 0; j < s.side_effect_count; j++) d.side_effects.emplace_back(s.side_effects[j]);
+                    for (size_t j = 0; j < s.replay_input_count; j++) d.replay_inputs.emplace_back(s.replay_inputs[j]);
+                    reg.registerToolDesc(d, /*allow_override=*/false);
+                }
+                return;
+            }
+        }
+    }
+
+    reg.loadToolPackManifest(manifest_path);
+}
+
+static bool desc_equal(const ToolDesc& a, const ToolDesc& b) {
+    return a.aid == b.aid && a.name == b.name &&
+           a.deterministic == b.deterministic && a.tags == b.tags &&
+           a.side_effects == b.side_effects && a.replay_inputs == b.replay_inputs;
+}
+
+size_t ManifestHotReload::poll(Registry& reg, const std::filesystem::path& root) {
+    size_t swapped = 0;
+    std::error_code ec;
+    auto tp_dir = root / "toolpacks";
+    if (!std::filesystem::exists(tp_dir, ec)) return 0;
+
+    for (auto& entry : std::filesystem::directory_iterator(tp_dir, ec)) {
+        if (ec) break;
+        if (!entry.is_directory(ec)) continue;
+        auto manifest = entry.path() / "manifest.json";
+
+        std::ifstream f(manifest);
+        if (!f) continue;
+        std::ostringstream ss;
+        ss << f.rdbuf();
+        const uint64_t h = hash::fnv1a64(ss.str());
+
+        const std::string key = manifest.string();
+        auto it = packs_.find(key);
+        if (it != packs_.end() && it->second.content_hash == h) continue;
+
+        std::vector<ToolDesc> descs;
+        try {
+            descs = parse_toolpack_manifest(key);
+        } catch (...) {
+            // Half-written or broken manifest: keep serving the previous
+            // descriptors and retry once the bytes change again.
+            continue;
+        }
+
+        PackState next;
+        next.content_hash = h;
+        next.aids.reserve(descs.size());
+        for (const auto& d : descs) next.aids.push_back(d.aid);
+        std::sort(next.aids.begin(), next.aids.end());
+
+        // First sighting of a manifest that setup already loaded: latch the
+        // hash and ownership list without churning the registry.
+        const bool first_sight = (it == packs_.end());
+        for (const auto& d : descs) {
+            const ToolDesc* cur = reg.getTool(d.aid);
+            if (cur && (first_sight || desc_equal(*cur, d))) continue;
+            try {
+                reg.registerToolDesc(d, /*allow_override=*/true);
+                swapped++;
+            } catch (...) {}
+        }
+        if (!first_sight) {
+            for (const auto& aid : it->second.aids) {
+                if (std::binary_search(next.aids.begin(), next.aids.end(), aid)) continue;
+                reg.removeToolDesc(aid);
+                swapped++;
+            }
+        }
+        packs_[key] = std::move(next);
+    }
+    return swapped;
+}
+
 void setup_runtime(Registry& reg,
                    ToolRunner& runner,
                    PluginManager& plugin_mgr,
                    RunnerRegistrar& registrar,
                    const std::filesystem::path& root) {
-    // Load tier0 manifest
-    reg.loadToolPackManifest((root / "toolpacks" / "tier0" / "manifest.json").string());
+    // Start faulting runtime plugin pages in on a worker while the
+    // manifest parse and tool registration below run; by the time
+    // load_new_from_dir dlopens them the files are warm.
+    plugin_mgr.prefault_dir_async(root / "toolpacks" / "runtime_plugins");
+
+    // Load tier0 descriptors (static table fast path, manifest fallback)
+    load_tier0_descs(reg, root);
 
     // Register all tier0 tools
     register_all_tier0_tools(runner);
@@ -5,29 +5,37 @@
 #include "machina/plugin_api.h"
 #include "machina/plugin_loader.h"
 
+#include <cstdint>
 #include <filesystem>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace machina {
 
 // Forward declarations for tier0 tool functions.
 ToolResult tool_error_scan_csv(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_file_read(const std::string& input_json, DSState& ds_tmp);
+ToolResult tool_file_read_many(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_file_write(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_shell_exec(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_http_get(const std::string& input_json, DSState& ds_tmp);
+ToolResult tool_http_get_many(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_queue_enqueue(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_noop(const std::string&, DSState&);
 ToolResult tool_ask_sup(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_gpu_smoke(const std::string&, DSState& ds_tmp);
 ToolResult tool_gpu_metrics(const std::string&, DSState& ds_tmp);
 ToolResult tool_proc_self_metrics(const std::string& input_json, DSState& ds_tmp);
+ToolResult tool_tool_metrics(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_report_summary(const std::string&, DSState& ds_tmp);
 ToolResult tool_memory_append(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_memory_search(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_memory_query(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_embed_text(const std::string& input_json, DSState& ds_tmp);
+ToolResult tool_embed_batch(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_vecdb_upsert(const std::string& input_json, DSState& ds_tmp);
+ToolResult tool_vecdb_upsert_batch(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_vecdb_query(const std::string& input_json, DSState& ds_tmp);
 ToolResult tool_run_log_summary(const std::string& input_json, DSState& ds_tmp);
 
@@ -54,6 +62,34 @@ struct RunnerRegistrar : public IToolRegistrar {
 // Register all tier0 tools + genesis tools on the given runner.
 void register_all_tier0_tools(ToolRunner& runner);
 
+// Populate the registry with the tier0 descriptors. Uses the compile-time
+// table in tools/tier0/tier0_descs.h when the on-disk manifest still
+// matches the bytes the table was generated from (no JSON parse), and
+// falls back to loadToolPackManifest otherwise.
+void load_tier0_descs(Registry& reg, const std::filesystem::path& root);
+
+// Hot-reload for toolpack manifests: poll() rescans toolpacks/*/manifest.json,
+// latches each manifest's content hash, and on change swaps the affected
+// Registry descriptors in place — changed tools re-register with override,
+// vanished tools are removed, untouched descriptors are left alone so their
+// generation stays quiet. Swaps run between steps (the registry has no
+// concurrent readers there) and bump Registry::generation(), so cached
+// menus rebuild on the next step while everything warm — loaded plugins,
+// centroids, the embed provider, vecdb maps — stays resident. A manifest
+// that fails to parse keeps its previous descriptors. Returns the number
+// of descriptors added, replaced, or removed.
+class ManifestHotReload {
+public:
+    size_t poll(Registry& reg, const std::filesystem::path& root);
+
+private:
+    struct PackState {
+        uint64_t content_hash{0};
+        std::vector<std::string> aids; // sorted
+    };
+    std::unordered_map<std::string, PackState> packs_;
+};
+
 // Full setup: load manifests, register tools, init genesis context, preload plugins.
 // Returns the registrar (caller owns lifetime).
 void setup_runtime(Registry& reg,
@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""Regenerate tools/tier0/tier0_descs.h from toolpacks/tier0/manifest.json.
+
+The generated header is a compile-time copy of the tier0 descriptor
+metadata (aid/name/deterministic/tags/side_effects/replay_inputs) plus the
+FNV-1a64 hash of the manifest bytes it was generated from. At startup the
+runner compares that hash against the on-disk manifest and only uses the
+static table when they match, so an edited manifest transparently falls
+back to the JSON parse path. Re-run this script after changing the
+manifest to get the fast path back:
+
+    python3 scripts/gen_tier0_descs.py
+"""
+
+import json
+import os
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+MANIFEST = os.path.join(ROOT, "toolpacks", "tier0", "manifest.json")
+HEADER = os.path.join(ROOT, "tools", "tier0", "tier0_descs.h")
+
+
+def fnv1a64(data: bytes) -> int:
+    h = 0xCBF29CE484222325
+    for b in data:
+        h ^= b
+        h = (h * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+
+def cxx_str(s: str) -> str:
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def main():
+    raw = open(MANIFEST, "rb").read()
+    manifest = json.loads(raw)
+    tools = manifest["tools"]
+
+    lines = []
+    out = lines.append
+    out("#pragma once")
+    out("")
+    out("// Generated by scripts/gen_tier0_descs.py from toolpacks/tier0/manifest.json.")
+    out("// Do not edit by hand; re-run the script after changing the manifest.")
+    out("//")
+    out("// Compile-time copy of the tier0 tool descriptors. The runner uses it")
+    out("// instead of parsing the manifest JSON whenever the on-disk manifest")
+    out("// still hashes to kManifestFnv1a64 below (see load_tier0_descs in")
+    out("// runner/tool_setup.cpp); on mismatch it falls back to the parser, so")
+    out("// the manifest stays the source of truth.")
+    out("")
+    out("#include <cstddef>")
+    out("#include <cstdint>")
+    out("#include <string_view>")
+    out("")
+    out("namespace machina::tier0_descs {")
+    out("")
+    out("struct StaticToolDesc {")
+    out("    std::string_view aid;")
+    out("    std::string_view name;")
+    out("    bool deterministic;")
+    out("    const std::string_view* tags;")
+    out("    size_t tag_count;")
+    out("    const std::string_view* side_effects;")
+    out("    size_t side_effect_count;")
+    out("    const std::string_view* replay_inputs;")
+    out("    size_t replay_input_count;")
+    out("};")
+    out("")
+
+    def emit_list(name, values):
+        if not values:
+            return "nullptr", "0"
+        out("inline constexpr std::string_view %s[] = {%s};"
+            % (name, ", ".join(cxx_str(v) for v in values)))
+        return name, str(len(values))
+
+    entries = []
+    for i, t in enumerate(tools):
+        tags, ntags = emit_list("kTags%d" % i, t.get("tags", []))
+        se, nse = emit_list("kSideEffects%d" % i, t.get("side_effects", []) or ["none"])
+        ri, nri = emit_list("kReplayInputs%d" % i, t.get("replay_inputs", []))
+        entries.append("    {%s, %s, %s, %s, %s, %s, %s, %s, %s},"
+                       % (cxx_str(t["aid"]), cxx_str(t.get("name", "")),
+                          "true" if t.get("deterministic", True) else "false",
+                          tags, ntags, se, nse, ri, nri))
+
+    out("")
+    out("inline constexpr StaticToolDesc kTools[] = {")
+    for e in entries:
+        out(e)
+    out("};")
+    out("")
+    out("inline constexpr size_t kToolCount = sizeof(kTools) / sizeof(kTools[0]);")
+    out("")
+    out("// FNV-1a64 of the manifest bytes this table was generated from.")
+    out("inline constexpr uint64_t kManifestFnv1a64 = 0x%016XULL;" % fnv1a64(raw))
+    out("")
+    out("} // namespace machina::tier0_descs")
+    out("")
+
+    with open(HEADER, "w") as f:
+        f.write("\n".join(lines))
+    print("wrote %s (%d tools, manifest fnv1a64=%016x)"
+          % (HEADER, len(tools), fnv1a64(raw)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,68 @@
+#include "test_common.h"
+
+#include "machina/aho_corasick.h"
+
+#include <string>
+#include <vector>
+
+using machina::AhoCorasick;
+
+int main() {
+    // Basic multi-pattern scan: every occurrence reported with its end.
+    {
+        AhoCorasick ac;
+        ac.add("he", 0);
+        ac.add("she", 1);
+        ac.add("hers", 2);
+        ac.add("his", 3);
+        ac.build();
+        expect_eq_ll((long long)ac.pattern_count(), 4, "pattern count");
+
+        std::vector<std::pair<int, size_t>> hits;
+        ac.scan("ushers", [&](int id, size_t end) { hits.push_back({id, end}); });
+        // "she" ends at 4, its suffix "he" also ends at 4, "hers" ends at 6.
+        expect_eq_ll((long long)hits.size(), 3, "hit count");
+        bool saw_she = false, saw_he = false, saw_hers = false;
+        for (auto& h : hits) {
+            if (h.first == 1 && h.second == 4) saw_she = true;
+            if (h.first == 0 && h.second == 4) saw_he = true;
+            if (h.first == 2 && h.second == 6) saw_hers = true;
+        }
+        expect_true(saw_she && saw_he && saw_hers, "overlapping suffix hits");
+    }
+
+    // match_min_id: lowest id wins regardless of match position.
+    {
+        AhoCorasick ac;
+        ac.add("later", 5);
+        ac.add("first", 2);
+        ac.build();
+        expect_eq_ll(ac.match_min_id("xx later then first yy"), 2, "min id wins");
+        expect_eq_ll(ac.match_min_id("nothing here"), -1, "no match is -1");
+    }
+
+    // UTF-8 patterns match byte-for-byte.
+    {
+        AhoCorasick ac;
+        ac.add("안녕", 0);
+        ac.add("gpu", 1);
+        ac.build();
+        expect_eq_ll(ac.match_min_id("=== 안녕하세요 ==="), 0, "utf-8 substring");
+        expect_eq_ll(ac.match_min_id("check the gpu please"), 1, "ascii substring");
+    }
+
+    // Duplicate patterns under different ids both fire; empty pattern ignored.
+    {
+        AhoCorasick ac;
+        ac.add("", 9);
+        ac.add("ab", 0);
+        ac.add("ab", 1);
+        ac.build();
+        expect_eq_ll((long long)ac.pattern_count(), 2, "empty pattern dropped");
+        int fired = 0;
+        ac.scan("abab", [&](int, size_t) { fired++; });
+        expect_eq_ll(fired, 4, "both ids fire per occurrence");
+    }
+
+    return 0;
+}
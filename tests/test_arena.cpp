@@ -0,0 +1,36 @@
+#include "test_common.h"
+
+#include "machina/arena.h"
+
+#include <cstdint>
+#include <string>
+
+int main() {
+    machina::Arena a(128);
+
+    // Bump allocations stay distinct and respect alignment.
+    void* p1 = a.alloc(10);
+    void* p2 = a.alloc(10);
+    expect_true(p1 != p2, "allocations must not overlap");
+    void* p3 = a.alloc(4, alignof(uint64_t));
+    expect_true(((uintptr_t)p3 % alignof(uint64_t)) == 0, "alignment respected");
+
+    // copy() keeps the bytes alive inside the arena.
+    std::string src = "hello arena";
+    std::string_view v = a.copy(src);
+    src.assign(src.size(), 'x');
+    expect_true(v == "hello arena", "copied bytes independent of the source");
+
+    // Oversized allocations get their own block.
+    void* big = a.alloc(4096);
+    expect_true(big != nullptr, "oversized alloc succeeds");
+    expect_true(a.allocated() >= 4096, "allocated() counts all blocks");
+
+    // reset() reuses the first block.
+    a.reset();
+    expect_true(a.allocated() == 0, "reset drops all usage");
+    void* p4 = a.alloc(10);
+    expect_true(p4 != nullptr, "arena usable after reset");
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "test_common.h"
+
+#include "machina/breaker.h"
+
+#include <cstdlib>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+int main() {
+    // Latch the shared table onto a scratch root before first use.
+    fs::path scratch = fs::temp_directory_path() / "machina_test_breaker";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+    setenv("MACHINA_ROOT", scratch.string().c_str(), 1);
+
+    const std::string key = "test:flaky_tool";
+    machina::BreakerState st;
+
+    // Fresh key: open, zero counters.
+    expect_true(!machina::breaker_is_blocked(key, 1000, &st), "fresh key open");
+    expect_eq_ll(st.fail_count, 0, "fresh count");
+
+    // Two failures inside the window stay under a threshold of three.
+    machina::breaker_record_fail(key, 1000, 3, 10000, 5000);
+    machina::breaker_record_fail(key, 1500, 3, 10000, 5000);
+    expect_true(!machina::breaker_is_blocked(key, 2000, &st), "under threshold");
+    expect_eq_ll(st.fail_count, 2, "two failures counted");
+
+    // Third failure trips the breaker for the cooldown.
+    machina::breaker_record_fail(key, 2000, 3, 10000, 5000);
+    expect_true(machina::breaker_is_blocked(key, 2001, &st), "tripped at threshold");
+    expect_eq_ll(st.block_until_ms, 7000, "block until fail + cooldown");
+    expect_true(!machina::breaker_is_blocked(key, 7001, nullptr), "cooldown expires");
+
+    // Success clears everything.
+    machina::breaker_record_success(key);
+    expect_true(!machina::breaker_is_blocked(key, 2001, &st), "cleared after success");
+    expect_eq_ll(st.fail_count, 0, "count cleared");
+
+    // Failures outside the window restart the count instead of accumulating.
+    machina::breaker_record_fail(key, 1000, 3, 100, 5000);
+    machina::breaker_record_fail(key, 5000, 3, 100, 5000);
+    expect_true(!machina::breaker_is_blocked(key, 5001, &st), "window reset keeps it open");
+    expect_eq_ll(st.fail_count, 1, "stale window restarts count");
+
+    // Keys are independent slots.
+    machina::breaker_record_fail("test:other_tool", 1000, 1, 100, 5000);
+    expect_true(machina::breaker_is_blocked("test:other_tool", 1001, nullptr), "other key trips");
+    expect_true(!machina::breaker_is_blocked(key, 5001, nullptr), "first key unaffected");
+
+    // The table is file-backed for cross-process visibility.
+    expect_true(fs::exists(scratch / "work" / "breaker.shm"), "shared table on disk");
+
+    fs::remove_all(scratch);
+    return 0;
+}
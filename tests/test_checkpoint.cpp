@@ -0,0 +1,80 @@
+#include "test_common.h"
+#include "machina/checkpoint.h"
+#include "machina/wal.h"
+
+#include <filesystem>
+#include <string>
+
+using machina::Artifact;
+using machina::CheckpointInfo;
+using machina::DSState;
+using machina::Wal;
+using machina::WalPolicy;
+
+int main() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "machina_test_checkpoint";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir, ec);
+
+    fs::path snap = dir / "state.snapshot.json";
+
+    DSState ds;
+    Artifact a;
+    a.type = "text";
+    a.content_json = "{\"msg\":\"hello\"}";
+    a.provenance = "test";
+    a.size_bytes = 15;
+    ds.slots[0] = a;
+    a.type = "table";
+    a.content_json = "{\"rows\":3}";
+    ds.slots[5] = a;
+
+    // Write / load roundtrip
+    std::string err = machina::checkpoint_write(snap, ds, 42);
+    expect_true(err.empty(), "checkpoint write should succeed: " + err);
+
+    DSState loaded;
+    CheckpointInfo info;
+    err = machina::checkpoint_load(snap, &loaded, &info);
+    expect_true(err.empty(), "checkpoint load should succeed: " + err);
+    expect_true(info.wal_seq == 42, "wal_seq should roundtrip");
+    expect_true(info.created_ms > 0, "created_ms should be set");
+    expect_true(loaded.slots.size() == 2, "both slots should roundtrip");
+    expect_true(loaded.slots[0].content_json == "{\"msg\":\"hello\"}", "slot 0 content");
+    expect_true(loaded.digest() == ds.digest(), "digests should match after roundtrip");
+
+    // checkpoint_and_truncate: WAL history is dropped once covered
+    {
+        fs::path wp = dir / "wal" / "events.jsonl";
+        Wal wal(wp);
+        WalPolicy pol;
+        pol.max_segment_bytes = 200;
+        pol.max_segment_age_sec = 0;
+        wal.set_policy(pol);
+        wal.set_tail_ring(64);
+        wal.open(true);
+        std::string line = "{\"pad\":\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\"}";
+        for (int i = 0; i < 20; i++) wal.append_json_line(line);
+        expect_true(wal.list_segments().size() > 1, "rotation should have happened");
+
+        err = machina::checkpoint_and_truncate(snap, ds, wal);
+        expect_true(err.empty(), "checkpoint_and_truncate should succeed: " + err);
+        expect_true(wal.list_segments().size() == 1, "rotated segments deleted after checkpoint");
+        expect_true(wal.size_bytes() == 0, "active segment truncated after checkpoint");
+
+        CheckpointInfo info2;
+        DSState loaded2;
+        err = machina::checkpoint_load(snap, &loaded2, &info2);
+        expect_true(err.empty(), "reload after truncate should succeed: " + err);
+        expect_true(info2.wal_seq == 20, "snapshot records the covered WAL position");
+
+        // Post-checkpoint suffix is all that remains to replay
+        wal.append_json_line("{\"after\":1}");
+        expect_true(wal.size_bytes() > 0, "suffix lands in the truncated segment");
+    }
+
+    fs::remove_all(dir, ec);
+    return 0;
+}
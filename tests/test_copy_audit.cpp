@@ -0,0 +1,68 @@
+#include "test_common.h"
+
+#include "machina/state.h"
+#include "machina/tools.h"
+
+#include <string>
+#include <utility>
+
+using machina::Artifact;
+using machina::DSState;
+using machina::DSSlot;
+using machina::StepStatus;
+using machina::ToolResult;
+
+int main() {
+    machina::ToolRunner runner;
+
+    // A tool shaped like the tier0 pattern: big artifact into a slot, same
+    // payload returned as output_json.
+    runner.registerTool("AID.TEST.FAT.v1", [](const std::string&, DSState& ds) -> ToolResult {
+        Artifact a;
+        a.type = "text";
+        a.content_json = std::string(2 * 1024 * 1024, 'z');
+        a.size_bytes = a.content_json.size();
+        ToolResult r{StepStatus::OK, a.content_json, ""};
+        ds.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+        return r;
+    });
+
+    // The dispatch chain (tool return -> runner -> caller) must not copy
+    // the result; only the deliberate artifact/output split inside the tool
+    // duplicates the payload, and that is a string copy, not a ToolResult copy.
+    {
+        int64_t before = machina::tool_result_copy_count();
+        DSState ds;
+        auto res = runner.run("AID.TEST.FAT.v1", "{}", ds);
+        expect_true(res.status == StepStatus::OK, "tool ran");
+        expect_eq_ll((long long)res.output_json.size(), 2 * 1024 * 1024, "payload intact");
+        expect_eq_ll(machina::tool_result_copy_count() - before, 0,
+                     "zero ToolResult copies through dispatch");
+    }
+
+    // The audit counter sees explicit copies and ignores moves.
+    {
+        ToolResult r{StepStatus::OK, "payload", ""};
+        int64_t before = machina::tool_result_copy_count();
+        ToolResult copy = r;
+        expect_eq_ll(machina::tool_result_copy_count() - before, 1, "copy ctor counted");
+        ToolResult assigned;
+        assigned = copy;
+        expect_eq_ll(machina::tool_result_copy_count() - before, 2, "copy assign counted");
+        ToolResult moved = std::move(assigned);
+        expect_true(moved.output_json == "payload", "move carried payload");
+        expect_eq_ll(machina::tool_result_copy_count() - before, 2, "moves not counted");
+    }
+
+    // Missing tool errors still flow without copies.
+    {
+        int64_t before = machina::tool_result_copy_count();
+        DSState ds;
+        auto res = runner.run("AID.TEST.ABSENT.v1", "{}", ds);
+        expect_true(res.status == StepStatus::TOOL_ERROR, "missing tool errors");
+        expect_eq_ll(machina::tool_result_copy_count() - before, 0,
+                     "error path copy-free");
+    }
+
+    return 0;
+}
@@ -47,5 +47,67 @@ int main() {
 
     expect_true(popped == false, "pop should return false after shutdown on empty queue");
 
+    // Sharded mode: pop still returns the globally best item when pushes
+    // and pops don't race (single-threaded here).
+    ConcurrentPriorityQueue<int> q3(4);
+    q3.push(7, 70);
+    q3.push(3, 30);
+    q3.push(5, 50);
+    q3.push(3, 31);
+    ConcurrentPriorityQueue<int>::Item it3;
+    expect_true(q3.pop(it3) && it3.value == 30, "sharded pop picks best priority across shards");
+    expect_true(q3.pop(it3) && it3.value == 31, "sharded pop keeps FIFO within priority");
+    expect_true(q3.pop(it3) && it3.value == 50, "sharded pop order (3rd)");
+    expect_true(q3.pop(it3) && it3.value == 70, "sharded pop order (4th)");
+    expect_eq_ll((long long)q3.size(), 0, "sharded queue drains");
+
+    // Batch pop: drains up to N in priority order, non-blocking variant
+    // returns 0 on empty.
+    {
+        ConcurrentPriorityQueue<int> q5(4);
+        for (int i = 0; i < 10; i++) q5.push(10 - i, i);
+        std::vector<ConcurrentPriorityQueue<int>::Item> batch;
+        expect_eq_ll((long long)q5.pop_batch(batch, 6), 6, "pop_batch drains up to max_n");
+        for (size_t i = 1; i < batch.size(); i++)
+            expect_true(batch[i - 1].priority <= batch[i].priority, "batch is priority-ordered");
+        expect_eq_ll((long long)q5.size(), 4, "remainder stays queued");
+        expect_eq_ll((long long)q5.try_pop_batch(batch, 100), 4, "try_pop_batch takes the rest");
+        expect_eq_ll((long long)q5.try_pop_batch(batch, 100), 0, "try_pop_batch on empty returns 0");
+        ConcurrentPriorityQueue<int>::Item single;
+        expect_true(!q5.try_pop(single), "try_pop on empty returns false");
+    }
+
+    // MPMC stress: every pushed item comes out exactly once and blocked
+    // consumers unblock on shutdown.
+    {
+        ConcurrentPriorityQueue<int> q4(8);
+        const int kProducers = 4, kConsumers = 4, kPerProducer = 2000;
+        std::atomic<long long> sum{0};
+        std::atomic<int> count{0};
+        std::vector<std::thread> threads;
+        for (int c = 0; c < kConsumers; c++) {
+            threads.emplace_back([&] {
+                ConcurrentPriorityQueue<int>::Item item;
+                while (q4.pop(item)) {
+                    sum.fetch_add(item.value);
+                    count.fetch_add(1);
+                }
+            });
+        }
+        for (int p = 0; p < kProducers; p++) {
+            threads.emplace_back([&, p] {
+                for (int i = 0; i < kPerProducer; i++) q4.push(i % 16, p * kPerProducer + i);
+            });
+        }
+        for (int p = 0; p < kProducers; p++) threads[(size_t)(kConsumers + p)].join();
+        while (q4.size() > 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        q4.shutdown();
+        for (int c = 0; c < kConsumers; c++) threads[(size_t)c].join();
+
+        const long long n = (long long)kProducers * kPerProducer;
+        expect_eq_ll(count.load(), n, "MPMC: every item popped exactly once");
+        expect_eq_ll(sum.load(), n * (n - 1) / 2, "MPMC: values intact (sum check)");
+    }
+
     return 0;
 }
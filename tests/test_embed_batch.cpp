@@ -0,0 +1,110 @@
+#include "test_common.h"
+
+#include "machina/json_mini.h"
+#include "machina/tools.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace machina {
+ToolResult tool_embed_batch(const std::string& input_json, DSState& ds_tmp);
+}
+
+using machina::DSState;
+using machina::StepStatus;
+
+namespace fs = std::filesystem;
+
+// Reads the batch artifact header + rows ("MBEB", u32 version/dim/count).
+static void read_artifact(const std::string& path, uint32_t* dim, uint32_t* count,
+                          std::vector<float>* rows) {
+    std::ifstream in(path, std::ios::binary);
+    expect_true(in.good(), "artifact opens: " + path);
+    char magic[4];
+    uint32_t ver = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&ver), sizeof(ver));
+    in.read(reinterpret_cast<char*>(dim), sizeof(*dim));
+    in.read(reinterpret_cast<char*>(count), sizeof(*count));
+    expect_true(std::memcmp(magic, "MBEB", 4) == 0, "artifact magic");
+    expect_eq_ll(ver, 1, "artifact version");
+    rows->resize((size_t)*dim * *count);
+    in.read(reinterpret_cast<char*>(rows->data()),
+            (std::streamsize)(rows->size() * sizeof(float)));
+    expect_true(in.good(), "artifact rows read fully");
+}
+
+static std::string run_batch(const std::string& input) {
+    DSState ds;
+    auto r = machina::tool_embed_batch(input, ds);
+    expect_true(r.status == StepStatus::OK, "embed_batch should succeed: " + r.error);
+    return r.output_json;
+}
+
+int main() {
+    fs::path scratch = fs::temp_directory_path() / "machina_test_embed_batch";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+    setenv("MACHINA_ROOT", scratch.c_str(), 1);
+    unsetenv("MACHINA_EMBED_CMD"); // force the deterministic hash provider
+
+    // Inline texts: one artifact, count x dim f32 rows, unit-normalized.
+    std::string artifact;
+    {
+        std::string out = run_batch("{\"texts\":[\"alpha\",\"beta\",\"gamma\"],\"dim\":32}");
+        expect_eq_ll(machina::json_mini::get_int(out, "count").value_or(-1), 3, "count");
+        expect_eq_ll(machina::json_mini::get_int(out, "dim").value_or(-1), 32, "dim");
+        expect_eq_ll(machina::json_mini::get_int(out, "errors").value_or(-1), 0, "errors");
+        artifact = machina::json_mini::get_string(out, "artifact").value_or("");
+        expect_true(!artifact.empty(), "artifact path present");
+
+        uint32_t dim = 0, count = 0;
+        std::vector<float> rows;
+        read_artifact(artifact, &dim, &count, &rows);
+        expect_eq_ll(dim, 32, "artifact dim");
+        expect_eq_ll(count, 3, "artifact count");
+        for (uint32_t r = 0; r < count; r++) {
+            double norm = 0;
+            for (uint32_t i = 0; i < dim; i++) {
+                float v = rows[(size_t)r * dim + i];
+                norm += (double)v * v;
+            }
+            expect_true(norm > 0.99 && norm < 1.01, "row is l2-normalized");
+        }
+    }
+
+    // Same batch, no explicit out: content-addressed path is stable.
+    {
+        std::string out = run_batch("{\"texts\":[\"alpha\",\"beta\",\"gamma\"],\"dim\":32}");
+        expect_true(machina::json_mini::get_string(out, "artifact").value_or("") == artifact,
+                    "identical batch reuses artifact path");
+    }
+
+    // File-of-lines input with caller-chosen output path.
+    {
+        fs::path corpus = scratch / "corpus.txt";
+        std::ofstream(corpus) << "one\ntwo\n\nthree\n"; // blank line skipped
+        fs::path dst = scratch / "corpus.emb";
+        std::string out = run_batch("{\"file\":\"" + corpus.string() +
+                                    "\",\"dim\":16,\"out\":\"" + dst.string() + "\"}");
+        expect_eq_ll(machina::json_mini::get_int(out, "count").value_or(-1), 3, "file count");
+        uint32_t dim = 0, count = 0;
+        std::vector<float> rows;
+        read_artifact(dst.string(), &dim, &count, &rows);
+        expect_eq_ll(dim, 16, "file artifact dim");
+        expect_eq_ll(count, 3, "file artifact count");
+    }
+
+    // No texts at all is a tool error, not an empty artifact.
+    {
+        DSState ds;
+        auto r = machina::tool_embed_batch("{}", ds);
+        expect_true(r.status == StepStatus::TOOL_ERROR, "empty input rejected");
+    }
+
+    fs::remove_all(scratch);
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "test_common.h"
+
+#include "machina/json_mini.h"
+#include "machina/tools.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace machina {
+ToolResult tool_error_scan_csv(const std::string& input_json, DSState& ds_tmp);
+}
+
+using machina::DSState;
+using machina::StepStatus;
+
+namespace fs = std::filesystem;
+
+static std::string scan(const std::string& path, const std::string& pattern,
+                        bool incremental = false, long long max_rows = 1000000) {
+    std::string in = "{\"input_path\":\"" + path + "\",\"pattern\":\"" + pattern + "\"" +
+                     ",\"max_rows\":" + std::to_string(max_rows) +
+                     (incremental ? ",\"incremental\":true" : "") + "}";
+    DSState ds;
+    auto r = machina::tool_error_scan_csv(in, ds);
+    expect_true(r.status == StepStatus::OK, "scan should succeed: " + r.error);
+    return r.output_json;
+}
+
+int main() {
+    fs::path scratch = fs::temp_directory_path() / "machina_test_error_scan";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+    setenv("MACHINA_ROOT", scratch.c_str(), 1);
+
+    fs::path log = scratch / "events.csv";
+    {
+        std::ofstream f(log);
+        f << "ts,level,msg\n";
+        for (int i = 0; i < 5000; i++) {
+            f << i << "," << (i % 100 == 7 ? "ERROR" : "INFO") << ",row " << i << "\n";
+        }
+    }
+
+    // Full scan: header skipped, 50 ERROR rows, samples carry row indices.
+    {
+        std::string out = scan(log.string(), "ERROR");
+        expect_eq_ll(machina::json_mini::get_int(out, "matches").value_or(-1), 50, "full scan matches");
+        auto samples = machina::json_mini::get_array_raw(out, "sample_rows").value_or("");
+        // first ERROR row is data row 8 (i=7), i.e. file row 9
+        expect_true(samples.find("\"row_index\":9") != std::string::npos, "first sample row index");
+        expect_true(samples.find("row 7") != std::string::npos, "first sample content");
+    }
+
+    // max_rows caps the scan like the sequential version did.
+    {
+        std::string out = scan(log.string(), "ERROR", false, 10);
+        expect_eq_ll(machina::json_mini::get_int(out, "matches").value_or(-1), 1, "max_rows caps matches");
+    }
+
+    // Incremental: second run over an unchanged file scans nothing new but
+    // still reports the cumulative count.
+    {
+        std::string out1 = scan(log.string(), "ERROR", true);
+        expect_eq_ll(machina::json_mini::get_int(out1, "matches").value_or(-1), 50, "incremental first run");
+        std::string out2 = scan(log.string(), "ERROR", true);
+        expect_eq_ll(machina::json_mini::get_int(out2, "matches").value_or(-1), 50, "incremental unchanged cumulative");
+        expect_eq_ll(machina::json_mini::get_int(out2, "scanned_bytes").value_or(-1), 0, "unchanged file scans 0 bytes");
+
+        // Append two rows (one match); only the tail is scanned.
+        {
+            std::ofstream f(log, std::ios::app);
+            f << "5000,ERROR,appended\n5001,INFO,tail\n";
+        }
+        std::string out3 = scan(log.string(), "ERROR", true);
+        expect_eq_ll(machina::json_mini::get_int(out3, "matches").value_or(-1), 51, "appended match counted");
+        auto samples = machina::json_mini::get_array_raw(out3, "sample_rows").value_or("");
+        expect_true(samples.find("appended") != std::string::npos, "sample from appended region");
+
+        // A partial line without newline is left for the next run.
+        {
+            std::ofstream f(log, std::ios::app);
+            f << "5002,ERROR,partial";
+        }
+        std::string out4 = scan(log.string(), "ERROR", true);
+        expect_eq_ll(machina::json_mini::get_int(out4, "matches").value_or(-1), 51, "partial tail not consumed");
+        {
+            std::ofstream f(log, std::ios::app);
+            f << "\n";
+        }
+        std::string out5 = scan(log.string(), "ERROR", true);
+        expect_eq_ll(machina::json_mini::get_int(out5, "matches").value_or(-1), 52, "completed tail counted");
+    }
+
+    fs::remove_all(scratch);
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "test_common.h"
+
+#include "machina/gpu_sampler.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+using machina::GpuSnapshot;
+
+static int64_t now_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+int main() {
+    fs::path scratch = fs::temp_directory_path() / "machina_test_gpu_sampler";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+    // The shm mapping latches on first use, so the root must point at the
+    // scratch dir before any read or publish below.
+    setenv("MACHINA_ROOT", scratch.string().c_str(), 1);
+
+    // Nothing published yet: read reports no snapshot.
+    {
+        GpuSnapshot s;
+        expect_true(!machina::gpu_snapshot_read(&s), "read before publish fails");
+    }
+
+    // Publish/read roundtrip preserves every field.
+    {
+        GpuSnapshot in;
+        in.sample_ms = 123456789;
+        in.available = 1;
+        in.device_count = 2;
+        in.device_index = 1;
+        in.temp_c = 61;
+        in.power_mw = 175500;
+        in.memory_total_mb = 24576;
+        in.memory_used_mb = 1024;
+        in.memory_free_mb = 23552;
+        std::strncpy(in.backend, "NVML", sizeof(in.backend) - 1);
+        std::strncpy(in.name, "Test GPU 9000", sizeof(in.name) - 1);
+        machina::gpu_snapshot_publish(in);
+
+        GpuSnapshot out;
+        expect_true(machina::gpu_snapshot_read(&out), "read after publish succeeds");
+        expect_eq_ll(out.sample_ms, 123456789, "sample_ms roundtrips");
+        expect_eq_ll((long long)out.available, 1, "available roundtrips");
+        expect_eq_ll((long long)out.device_count, 2, "device_count roundtrips");
+        expect_eq_ll((long long)out.device_index, 1, "device_index roundtrips");
+        expect_eq_ll((long long)out.temp_c, 61, "temp_c roundtrips");
+        expect_eq_ll((long long)out.power_mw, 175500, "power_mw roundtrips");
+        expect_eq_ll((long long)out.memory_used_mb, 1024, "memory_used_mb roundtrips");
+        expect_true(std::string(out.backend) == "NVML", "backend string roundtrips");
+        expect_true(std::string(out.name) == "Test GPU 9000", "name string roundtrips");
+    }
+
+    // Freshness window: inside passes, outside fails, zero-sample fails.
+    {
+        GpuSnapshot s;
+        s.sample_ms = 1000;
+        expect_true(machina::gpu_snapshot_fresh(s, 1500, 1000), "within window is fresh");
+        expect_true(machina::gpu_snapshot_fresh(s, 2000, 1000), "boundary is fresh");
+        expect_true(!machina::gpu_snapshot_fresh(s, 2001, 1000), "past window is stale");
+        expect_true(!machina::gpu_snapshot_fresh(s, 900, 1000), "future sample is stale");
+        s.sample_ms = 0;
+        expect_true(!machina::gpu_snapshot_fresh(s, 1000, 1000), "never-sampled is stale");
+    }
+
+    // Direct sample always fills timestamp and backend, even without NVML
+    // (which is the expected case on CI machines).
+    {
+        GpuSnapshot s;
+        machina::gpu_sample_direct(&s);
+        expect_true(s.sample_ms != 0, "direct sample stamps time");
+        expect_true(s.backend[0] != '\0', "direct sample names a backend");
+        if (!s.available) {
+            expect_eq_ll((long long)s.memory_used_mb, 0, "unavailable GPU reports no memory");
+        }
+    }
+
+    // Sampler thread publishes at least once, then stops cleanly; stop is
+    // idempotent.
+    {
+        machina::gpu_sampler_start(25);
+        int64_t deadline = now_ms() + 3000;
+        GpuSnapshot s;
+        bool published = false;
+        while (now_ms() < deadline) {
+            if (machina::gpu_snapshot_read(&s) && s.sample_ms > 123456789) {
+                published = true;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        machina::gpu_sampler_stop();
+        machina::gpu_sampler_stop();
+        expect_true(published, "sampler thread publishes a snapshot");
+        expect_true(machina::gpu_snapshot_fresh(s, now_ms(), 10000), "sampler snapshot is fresh");
+        expect_true(fs::exists(scratch / "work" / "gpu_metrics.shm"), "snapshot file exists under root");
+    }
+
+    fs::remove_all(scratch);
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include "test_common.h"
+
+#include "machina/hugepage.h"
+
+#include <cstring>
+#include <vector>
+
+int main() {
+    // Direct alloc/free round trip above one huge page.
+    if (machina::hugepage_enabled()) {
+        size_t len = machina::kHugePageBytes + 4096;
+        void* p = machina::hugepage_alloc(len);
+        expect_true(p != nullptr, "huge alloc succeeds (THP fallback at worst)");
+        std::memset(p, 0xAB, len);
+        expect_true(((const unsigned char*)p)[len - 1] == 0xAB, "memory usable");
+        expect_true(machina::hugepage_free(p, len), "free owns the pointer");
+        expect_true(!machina::hugepage_free(p, len), "double free rejected");
+    }
+
+    // Foreign pointers are refused so heap fallbacks can try-free safely.
+    {
+        int x = 0;
+        expect_true(!machina::hugepage_free(&x, sizeof(x)), "foreign pointer refused");
+    }
+
+    // The allocator routes small vectors to the heap and big ones to the
+    // mmap path, and both destruct cleanly.
+    {
+        std::vector<float, machina::HugePageAllocator<float>> small(1024, 1.0f);
+        expect_true(small[1023] == 1.0f, "small vector usable");
+
+        size_t n = machina::kHugePageBytes / sizeof(float) + 1;
+        std::vector<float, machina::HugePageAllocator<float>> big(n, 2.0f);
+        expect_true(big[n - 1] == 2.0f, "big vector usable");
+        big.clear();
+        big.shrink_to_fit();
+    }
+
+    // Advise contracts: degenerate inputs rejected.
+    expect_true(!machina::hugepage_advise(nullptr, 4096), "null advise rejected");
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include "test_common.h"
+
+#include "machina/json_mini.h"
+
+#include <string>
+#include <vector>
+
+using namespace machina;
+
+int main() {
+    const std::string doc =
+        "{\"name\":\"alpha\",\"n\":42,\"ratio\":0.5,\"on\":true,"
+        "\"tags\":[\"a\",\"b\"],\"meta\":{\"k\":1},\"xs\":[1,2]}";
+
+    // Cursor: one parse, many lookups.
+    json_mini::Cursor c(doc);
+    expect_true(c.ok(), "cursor parses an object");
+    expect_true(c.get_string("name").value_or("") == "alpha", "get_string via cursor");
+    expect_eq_ll(c.get_int("n").value_or(0), 42, "get_int via cursor");
+    expect_true(c.get_double("ratio").value_or(0) == 0.5, "get_double via cursor");
+    expect_true(c.get_bool("on").value_or(false), "get_bool via cursor");
+    expect_eq_ll((long long)c.get_array_strings("tags").size(), 2, "get_array_strings via cursor");
+    expect_true(c.get_object_raw("meta").value_or("") == "{\"k\":1}", "get_object_raw via cursor");
+    expect_true(c.get_array_raw("xs").value_or("") == "[1,2]", "get_array_raw via cursor");
+    expect_true(c.has_key("meta") && !c.has_key("absent"), "has_key via cursor");
+    expect_true(!c.get_string("n").has_value(), "type mismatch yields nullopt");
+
+    // bind: assigns on match, leaves the default otherwise.
+    std::string name = "unset";
+    int n = -1;
+    double ratio = 0.0;
+    bool on = false;
+    std::string missing = "default";
+    expect_true(c.bind("name", name) && name == "alpha", "bind string");
+    expect_true(c.bind("n", n) && n == 42, "bind int");
+    expect_true(c.bind("ratio", ratio) && ratio == 0.5, "bind double");
+    expect_true(c.bind("on", on) && on, "bind bool");
+    expect_true(!c.bind("absent", missing) && missing == "default", "bind leaves default on miss");
+
+    // Malformed input: cursor reports not-ok, lookups are null.
+    json_mini::Cursor bad("{broken");
+    expect_true(!bad.ok(), "cursor on malformed input is not ok");
+    expect_true(!bad.get_string("name").has_value(), "lookups on bad cursor are null");
+
+    // The free helpers share the cursor implementation; spot-check one.
+    expect_true(json_mini::get_string(doc, "name").value_or("") == "alpha", "free get_string still works");
+
+    // json_escape: clean runs pass through, specials are escaped.
+    expect_true(json_mini::json_escape("plain text") == "plain text", "escape passthrough");
+    expect_true(json_mini::json_escape("a\"b\\c") == "a\\\"b\\\\c", "escape quote and backslash");
+    expect_true(json_mini::json_escape("\b\f\n\r\t") == "\\b\\f\\n\\r\\t", "escape whitespace controls");
+    expect_true(json_mini::json_escape(std::string(1, '\x01')) == "\\u0001", "escape raw control byte");
+    // Long inputs exercise the SIMD runs; the escape may land anywhere
+    // relative to a vector-width boundary.
+    for (size_t len : {size_t{15}, size_t{16}, size_t{31}, size_t{32}, size_t{33}, size_t{200}}) {
+        std::string in(len, 'x');
+        in += '\n';
+        in += std::string(len, 'y');
+        expect_true(json_mini::json_escape(in) ==
+                        std::string(len, 'x') + "\\n" + std::string(len, 'y'),
+                    "escape around vector boundaries");
+    }
+
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include "test_common.h"
+
+#include "machina/json_mini.h"
+#include "machina/json_writer.h"
+
+#include <cmath>
+#include <string>
+
+using namespace machina;
+
+int main() {
+    // Nested structure with automatic commas.
+    JsonWriter w;
+    w.begin_object();
+    w.kv("ok", true);
+    w.kv("name", "alpha");
+    w.key("hits").begin_array();
+    w.begin_object().kv("i", (uint64_t)7).kv_fixed("score", 0.25, 6).end_object();
+    w.begin_object().kv("i", (uint64_t)9).kv_fixed("score", 1.0, 6).end_object();
+    w.end_array();
+    w.kv("count", 2);
+    w.end_object();
+    expect_true(w.str() ==
+                    "{\"ok\":true,\"name\":\"alpha\",\"hits\":["
+                    "{\"i\":7,\"score\":0.250000},{\"i\":9,\"score\":1.000000}"
+                    "],\"count\":2}",
+                "nested object/array with commas");
+
+    // The result parses and round-trips through json_mini.
+    json_mini::Cursor c(w.str());
+    expect_true(c.ok(), "writer output parses");
+    expect_eq_ll(c.get_int("count").value_or(0), 2, "count field readable");
+
+    // Escape-on-write matches json_escape.
+    JsonWriter e;
+    e.begin_object().kv("s", "a\"b\\c\nd").end_object();
+    expect_true(e.str() == "{\"s\":\"a\\\"b\\\\c\\nd\"}", "strings escaped on write");
+
+    // Numbers: to_chars formatting, negative ints, shortest floats.
+    JsonWriter n;
+    n.begin_array();
+    n.value((int64_t)-42).value(0.5).value(1.5f);
+    n.end_array();
+    expect_true(n.str() == "[-42,0.5,1.5]", "to_chars number formatting");
+
+    // Non-finite doubles become null (JSON has no inf/nan).
+    JsonWriter f;
+    f.begin_array().value(std::nan("")).value(1.0 / 0.0).end_array();
+    expect_true(f.str() == "[null,null]", "non-finite serializes as null");
+
+    // raw() splices pre-serialized JSON verbatim.
+    JsonWriter r;
+    r.begin_object().kv_raw("meta", "{\"k\":1}").kv("i", 3).end_object();
+    expect_true(r.str() == "{\"meta\":{\"k\":1},\"i\":3}", "raw splice");
+
+    // Empty containers.
+    JsonWriter z;
+    z.begin_object().key("matches").begin_array().end_array().kv("count", 0).end_object();
+    expect_true(z.str() == "{\"matches\":[],\"count\":0}", "empty array inside object");
+
+    return 0;
+}
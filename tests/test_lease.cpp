@@ -1,8 +1,9 @@
 #include "test_common.h"
 #include "machina/lease.h"
 
-#include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <thread>
 
 int main() {
     using namespace machina;
@@ -125,6 +126,63 @@ int main() {
         expect_true(lm.total_rejected() == 1, "total rejected should be 1");
     }
 
+    // Test 11: Concurrent issue/consume across shards keeps counters exact
+    {
+        LeaseManager lm;
+        const int kThreads = 4;
+        const int kPerThread = 200;
+        std::vector<std::thread> workers;
+        for (int w = 0; w < kThreads; w++) {
+            workers.emplace_back([&lm] {
+                for (int i = 0; i < kPerThread; i++) {
+                    auto tok = lm.issue_lease("AID.SHELL.EXEC.v1", 2, 60000);
+                    lm.verify_and_consume(tok.token_id, "AID.SHELL.EXEC.v1");
+                }
+            });
+        }
+        for (auto& t : workers) t.join();
+        expect_true(lm.total_issued() == (size_t)(kThreads * kPerThread),
+                    "all concurrent issues counted");
+        expect_true(lm.total_consumed() == (size_t)(kThreads * kPerThread),
+                    "all concurrent consumes counted");
+        expect_true(lm.active_count() == 0, "no active leases after consuming all");
+    }
+
+    // Test 12: Stateless HMAC leases — verify, single-use, tamper rejection
+    {
+        unsetenv("MACHINA_LEASE_SECRET");  // force distinct per-process secrets
+        LeaseManager lm;
+        auto tok = lm.issue_lease_stateless("AID.SHELL.EXEC.v1", 2, 10000, "test");
+        expect_true(tok.token_id.rfind("slease1|", 0) == 0, "stateless token carries prefix");
+        expect_true(lm.active_count() == 0, "stateless issue writes no table entry");
+
+        std::string reason;
+        expect_true(lm.verify_and_consume(tok.token_id, "AID.SHELL.EXEC.v1", &reason),
+                    "stateless verify succeeds: " + reason);
+        expect_true(!lm.verify_and_consume(tok.token_id, "AID.SHELL.EXEC.v1", &reason),
+                    "stateless replay rejected");
+        expect_true(reason.find("consumed") != std::string::npos,
+                    "replay reason mentions consumed");
+
+        auto tok2 = lm.issue_lease_stateless("AID.SHELL.EXEC.v1", 2, 10000);
+        expect_true(!lm.verify_and_consume(tok2.token_id, "AID.FILE.WRITE.v1", &reason),
+                    "stateless tool mismatch rejected");
+
+        // Flipping a byte in the embedded expiry breaks the signature.
+        std::string forged = tok2.token_id;
+        auto pos = forged.find('|', forged.find('|', forged.find('|') + 1) + 1) + 1;
+        forged[pos] = (forged[pos] == '9') ? '8' : '9';
+        expect_true(!lm.verify_and_consume(forged, "AID.SHELL.EXEC.v1", &reason),
+                    "tampered stateless token rejected");
+        expect_true(reason.find("signature") != std::string::npos,
+                    "tamper reason mentions signature");
+
+        // A second manager with a different per-process secret rejects it.
+        LeaseManager other;
+        expect_true(!other.verify_and_consume(tok2.token_id, "AID.SHELL.EXEC.v1", &reason),
+                    "foreign secret rejects token");
+    }
+
     std::cerr << "test_lease: ALL PASSED" << std::endl;
     return 0;
 }
@@ -0,0 +1,62 @@
+#include "test_common.h"
+
+#include "machina/json_mini.h"
+#include "machina/log.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static std::vector<std::string> read_lines(const fs::path& p) {
+    std::vector<std::string> lines;
+    std::ifstream f(p);
+    std::string line;
+    while (std::getline(f, line)) lines.push_back(line);
+    return lines;
+}
+
+int main() {
+    fs::path scratch = fs::temp_directory_path() / "machina_test_log_async";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+    fs::path log = scratch / "run_async.jsonl";
+
+    machina::RunHeader hdr;
+    hdr.run_id = "run-async-test";
+    {
+        machina::JsonlLogger lg(hdr, log.string());
+        // Burst of events lands through the writer thread; flush() makes
+        // them visible while the logger is still alive.
+        for (int i = 0; i < 200; i++) {
+            lg.event(i, "tool_ok", "{\"n\":" + std::to_string(i) + "}");
+        }
+        lg.flush();
+        expect_eq_ll((long long)read_lines(log).size(), 200, "flush drains the queue");
+
+        lg.event(200, "run_end", "{}");
+    }
+
+    // Destruction drains the remainder; lines are in submission order and
+    // the hash chain is intact (each prev equals the previous hash).
+    auto lines = read_lines(log);
+    expect_eq_ll((long long)lines.size(), 201, "all events persisted");
+    std::string prev(64, '0');
+    for (size_t i = 0; i < lines.size(); i++) {
+        auto ph = machina::json_mini::get_string(lines[i], "chain_prev").value_or("");
+        auto h = machina::json_mini::get_string(lines[i], "chain_hash").value_or("");
+        expect_true(ph == prev, "chain links line " + std::to_string(i));
+        prev = h;
+    }
+    expect_eq_ll(machina::json_mini::get_int(lines[200], "step").value_or(-1), 200,
+                 "final event ordered last");
+
+    // Sidecar index rows stay in step with the lines.
+    auto idx = read_lines(log.string() + ".idx");
+    expect_eq_ll((long long)idx.size(), 202, "header plus one row per line");
+
+    fs::remove_all(scratch);
+    return 0;
+}
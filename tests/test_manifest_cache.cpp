@@ -0,0 +1,96 @@
+#include "test_common.h"
+#include "machina/manifest_cache.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+int main() {
+    namespace fs = std::filesystem;
+    namespace mc = machina::manifest_cache;
+
+    // Point the cache at a scratch root so runs don't interfere.
+    fs::path root = fs::temp_directory_path() / "machina_test_mfc";
+    fs::remove_all(root);
+    fs::create_directories(root);
+    setenv("MACHINA_ROOT", root.string().c_str(), 1);
+    unsetenv("MACHINA_MANIFEST_CACHE");
+
+    // ToolDesc round trip preserves every field.
+    {
+        machina::ToolDesc a;
+        a.aid = "AID.X.v1";
+        a.name = "x tool";
+        a.deterministic = false;
+        a.tags = {"fs", "read"};
+        a.side_effects = {"none"};
+        a.replay_inputs = {"fence-1"};
+        machina::ToolDesc b;
+        b.aid = "AID.Y.v1";
+        b.name = "y tool";
+
+        std::string key = mc::content_key("{\"toolpack_id\":\"t\"}");
+        std::vector<machina::ToolDesc> missing;
+        expect_true(!mc::load_tooldescs(key, &missing), "miss before save");
+
+        mc::save_tooldescs(key, {a, b});
+        std::vector<machina::ToolDesc> got;
+        expect_true(mc::load_tooldescs(key, &got), "hit after save");
+        expect_true(got.size() == 2, "both descriptors round-trip");
+        expect_true(got[0].aid == "AID.X.v1" && got[0].name == "x tool", "aid/name preserved");
+        expect_true(!got[0].deterministic, "deterministic flag preserved");
+        expect_true(got[0].tags == a.tags && got[0].side_effects == a.side_effects &&
+                        got[0].replay_inputs == a.replay_inputs,
+                    "string vectors preserved");
+
+        // A different content key must not hit the same blob.
+        std::vector<machina::ToolDesc> other;
+        expect_true(!mc::load_tooldescs(mc::content_key("different bytes"), &other),
+                    "different content key misses");
+    }
+
+    // GoalDesc round trip, including slots and the OR flag.
+    {
+        machina::GoalDesc g;
+        g.goal_id = "GOAL.DEMO.v1";
+        g.candidate_tags = {"fs"};
+        g.required_tools = {"AID.X.v1"};
+        g.required_slots = {0, 2};
+        g.any_slot_sufficient = true;
+
+        std::string key = mc::content_key("{\"goalpack_id\":\"g\"}");
+        mc::save_goaldescs(key, {g});
+        std::vector<machina::GoalDesc> got;
+        expect_true(mc::load_goaldescs(key, &got) && got.size() == 1, "goal blob hit");
+        expect_true(got[0].goal_id == g.goal_id && got[0].required_slots == g.required_slots &&
+                        got[0].any_slot_sufficient,
+                    "goal fields preserved");
+    }
+
+    // CTS issue lists: empty lists cache too (a clean manifest stays clean),
+    // and the tp/gp namespaces do not cross-hit.
+    {
+        std::string key = mc::content_key("{\"toolpack_id\":\"t2\"}");
+        mc::save_issues("tp", key, {});
+        std::vector<machina::CtsIssue> got{{"junk", "junk"}};
+        expect_true(mc::load_issues("tp", key, &got) && got.empty(), "empty issue list cached");
+        expect_true(!mc::load_issues("gp", key, &got), "gp namespace does not see tp blob");
+
+        mc::save_issues("gp", key, {{"GP-01", "missing goalpack_id"}});
+        expect_true(mc::load_issues("gp", key, &got) && got.size() == 1 && got[0].code == "GP-01",
+                    "issue contents preserved");
+    }
+
+    // Kill switch disables both directions.
+    {
+        setenv("MACHINA_MANIFEST_CACHE", "0", 1);
+        expect_true(!mc::enabled(), "env kill switch recognized");
+        std::string key = mc::content_key("{\"toolpack_id\":\"t\"}");
+        std::vector<machina::ToolDesc> got;
+        expect_true(!mc::load_tooldescs(key, &got), "disabled cache never hits");
+        unsetenv("MACHINA_MANIFEST_CACHE");
+    }
+
+    fs::remove_all(root);
+    return 0;
+}
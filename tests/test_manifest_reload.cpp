@@ -0,0 +1,80 @@
+#include "test_common.h"
+
+#include "tool_setup.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+using machina::ManifestHotReload;
+using machina::Registry;
+
+static void write_manifest(const fs::path& p, const std::string& tools_json) {
+    std::ofstream f(p);
+    f << "{\"toolpack_id\":\"pack.test\",\"tools\":[" << tools_json << "]}";
+}
+
+static std::string tool_json(const std::string& aid, const std::string& tag) {
+    return "{\"aid\":\"" + aid + "\",\"name\":\"t\",\"tags\":[\"" + tag + "\"]}";
+}
+
+int main() {
+    fs::path scratch = fs::temp_directory_path() / "machina_test_manifest_reload";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch / "toolpacks" / "packa");
+    setenv("MACHINA_ROOT", scratch.string().c_str(), 1);
+
+    fs::path manifest = scratch / "toolpacks" / "packa" / "manifest.json";
+    write_manifest(manifest, tool_json("AID.T1.v1", "tag.x"));
+
+    // Hot-added pack: the first poll registers it.
+    Registry reg;
+    ManifestHotReload hr;
+    expect_true(hr.poll(reg, scratch) == 1, "new pack registers its tool");
+    expect_true(reg.getTool("AID.T1.v1") != nullptr, "T1 registered");
+    uint64_t gen = reg.generation();
+
+    // Unchanged bytes: nothing swaps, generation stays quiet.
+    expect_true(hr.poll(reg, scratch) == 0, "unchanged manifest is a no-op");
+    expect_true(reg.generation() == gen, "no generation churn without edits");
+
+    // Edit: T1 changes tag, T2 appears.
+    write_manifest(manifest,
+                   tool_json("AID.T1.v1", "tag.y") + "," + tool_json("AID.T2.v1", "tag.x"));
+    expect_true(hr.poll(reg, scratch) == 2, "changed + added tools swap");
+    expect_true(reg.getTool("AID.T2.v1") != nullptr, "T2 registered");
+    expect_true(reg.generation() > gen, "swap bumps generation");
+    expect_true(reg.queryByTags({"tag.y"}).size() == 1, "T1 reindexed under new tag");
+    expect_true(reg.queryByTags({"tag.x"}).size() == 1, "old T1 posting dropped");
+
+    // Edit: T1 vanishes from the manifest.
+    write_manifest(manifest, tool_json("AID.T2.v1", "tag.x"));
+    expect_true(hr.poll(reg, scratch) == 1, "removal counts as a swap");
+    expect_true(reg.getTool("AID.T1.v1") == nullptr, "T1 removed");
+    expect_true(reg.queryByTags({"tag.y"}).empty(), "removed tool leaves no postings");
+
+    // Broken manifest: previous descriptors keep serving.
+    {
+        std::ofstream f(manifest);
+        f << "{not json";
+    }
+    expect_true(hr.poll(reg, scratch) == 0, "broken manifest swaps nothing");
+    expect_true(reg.getTool("AID.T2.v1") != nullptr, "old descriptors survive a bad write");
+
+    // A pack already loaded at setup latches without churning the registry.
+    {
+        write_manifest(manifest, tool_json("AID.T2.v1", "tag.x"));
+        Registry reg2;
+        reg2.loadToolPackManifest(manifest.string());
+        uint64_t gen2 = reg2.generation();
+        ManifestHotReload hr2;
+        expect_true(hr2.poll(reg2, scratch) == 0, "first sight of loaded pack is quiet");
+        expect_true(reg2.generation() == gen2, "no re-registration at seed time");
+    }
+
+    fs::remove_all(scratch);
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "test_common.h"
+
+#include "machina/tools.h"
+
+#include <json-c/json.h>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+using machina::DSState;
+using machina::ToolResult;
+
+// from tools/tier0/memory_append.cpp and memory_query.cpp
+namespace machina {
+ToolResult tool_memory_append(const std::string& input_json, DSState& ds_tmp);
+ToolResult tool_memory_query(const std::string& input_json, DSState& ds_tmp);
+}
+
+static void setenv_str(const char* k, const std::string& v) {
+#ifdef _WIN32
+    (void)k; (void)v;
+#else
+    setenv(k, v.c_str(), 1);
+#endif
+}
+
+static int count_matches(const ToolResult& r, std::string* first_text) {
+    json_object* rootj = json_tokener_parse(r.output_json.c_str());
+    expect_true(rootj != nullptr, "output json parse failed");
+    json_object* matches = nullptr;
+    expect_true(json_object_object_get_ex(rootj, "matches", &matches), "missing matches");
+    int n = (int)json_object_array_length(matches);
+    if (n > 0 && first_text) {
+        json_object* m0 = json_object_array_get_idx(matches, 0);
+        json_object* t = nullptr;
+        expect_true(json_object_object_get_ex(m0, "text", &t), "match missing text");
+        *first_text = json_object_get_string(t);
+    }
+    json_object_put(rootj);
+    return n;
+}
+
+int main() {
+    namespace fs = std::filesystem;
+    fs::path root = fs::temp_directory_path() / "machina_test_memory_index";
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    fs::create_directories(root);
+
+    setenv_str("MACHINA_ROOT", root.string());
+    setenv_str("MACHINA_MEMORY_ROOT", root.string());
+    setenv_str("MACHINA_MEMORY_RECENCY_TAU_SEC", "100000000");
+
+    DSState tmp;
+
+    // Pre-existing corpus written outside tool_memory_append: the query-side
+    // acquire must index the backlog from the jsonl itself.
+    {
+        std::ofstream out(root / "idx.jsonl");
+        out << "{\"ts_ms\":1000,\"stream\":\"idx\",\"text\":\"kumquat harvest report\"}\n";
+        out << "{\"ts_ms\":2000,\"stream\":\"idx\",\"text\":\"quarterly revenue numbers\"}\n";
+        out << "{\"ts_ms\":3000,\"stream\":\"idx\",\"text\":\"kumquat pricing update\"}\n";
+    }
+
+    ToolResult r1 = machina::tool_memory_query(
+        "{\"stream\":\"idx\",\"query\":\"kumquat\",\"top_k\":5,\"rerank\":\"none\"}", tmp);
+    expect_true(r1.status == machina::StepStatus::OK, "query over backlog should succeed");
+    std::string t1;
+    expect_true(count_matches(r1, &t1) == 3, "backlog docs should all be in the window");
+    expect_true(t1.find("kumquat") != std::string::npos, "kumquat docs should rank first");
+    expect_true(fs::exists(root / "idx.jsonl.midx"), "sidecar index should be persisted");
+    expect_true(fs::exists(root / "idx.jsonl.emb"), "sidecar embeddings should be persisted");
+
+    // Incremental path: the append keeps the index in step, so the new line
+    // is queryable without a rebuild.
+    machina::tool_memory_append(
+        "{\"stream\":\"idx\",\"text\":\"persimmon shipment delayed\"}", tmp);
+    ToolResult r2 = machina::tool_memory_query(
+        "{\"stream\":\"idx\",\"query\":\"persimmon shipment\",\"top_k\":1,\"rerank\":\"none\"}", tmp);
+    expect_true(r2.status == machina::StepStatus::OK, "query after append should succeed");
+    std::string t2;
+    expect_true(count_matches(r2, &t2) == 1, "appended doc should be returned");
+    expect_true(t2.find("persimmon") != std::string::npos, "appended doc should rank first");
+
+    fs::remove_all(root, ec);
+    return 0;
+}
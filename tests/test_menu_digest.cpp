@@ -0,0 +1,66 @@
+#include "test_common.h"
+
+#include "machina/ids.h"
+
+#include <string>
+
+using machina::Menu;
+using machina::MenuItem;
+using machina::SID;
+
+static MenuItem make_item(uint16_t sid, const std::string& aid) {
+    MenuItem mi;
+    mi.sid.value = sid;
+    mi.aid = aid;
+    mi.name = aid;
+    mi.tags = {"b", "a"};
+    return mi;
+}
+
+int main() {
+    // Memoized digest matches a from-scratch computation on an equal menu.
+    Menu menu;
+    menu.items.push_back(make_item(2, "AID.TWO.v1"));
+    menu.items.push_back(make_item(1, "AID.ONE.v1"));
+    menu.buildIndex();
+
+    Menu fresh = menu;
+    std::string d1 = menu.digest();
+    expect_true(d1 == menu.digest(), "repeat digest stable");
+    expect_true(d1 == fresh.digest(), "digest independent of memo state");
+    expect_true(menu.digest_raw().find("SID0001=") == 0, "pieces sorted by sid");
+
+    // Incremental add lands in sid order and matches a full rebuild.
+    menu.addItem(make_item(3, "AID.THREE.v1"));
+    expect_true(menu.digest() != d1, "add invalidates digest");
+    {
+        Menu rebuilt;
+        rebuilt.items = menu.items;
+        rebuilt.buildIndex();
+        expect_true(menu.digest() == rebuilt.digest(), "incremental add matches rebuild");
+        expect_true(menu.resolve(SID{3}) != nullptr, "added item resolves");
+    }
+
+    // Incremental remove keeps the digest and index in step.
+    expect_true(menu.removeItem(SID{2}), "remove existing");
+    expect_true(!menu.removeItem(SID{2}), "second remove reports absence");
+    {
+        Menu rebuilt;
+        rebuilt.items = menu.items;
+        rebuilt.buildIndex();
+        expect_true(menu.digest() == rebuilt.digest(), "incremental remove matches rebuild");
+        expect_true(menu.resolve(SID{2}) == nullptr, "removed item gone");
+        expect_true(menu.resolve(SID{3}) != nullptr, "survivor still resolves");
+        expect_eq_ll((long long)menu.items.size(), 2, "item count after remove");
+    }
+
+    // Direct edits to items are still honored once buildIndex runs.
+    menu.items[0].aid = "AID.PATCHED.v1";
+    std::string before = menu.digest();
+    menu.buildIndex();
+    expect_true(menu.digest() != before, "buildIndex drops the memo");
+    expect_true(menu.digest_raw().find("AID.PATCHED.v1") != std::string::npos,
+                "direct edit visible after rebuild");
+
+    return 0;
+}
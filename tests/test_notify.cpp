@@ -0,0 +1,91 @@
+#include "test_common.h"
+
+#include "machina/notify.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using machina::NotifyDispatcher;
+
+static std::vector<std::string> read_lines(const fs::path& p) {
+    std::vector<std::string> lines;
+    std::ifstream f(p);
+    std::string line;
+    while (std::getline(f, line)) lines.push_back(line);
+    return lines;
+}
+
+int main() {
+    fs::path scratch = fs::temp_directory_path() / "machina_test_notify";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+
+    // Disabled dispatcher: publish is a no-op, flush returns immediately.
+    {
+        NotifyDispatcher off;
+        expect_true(!off.enabled(), "no destinations disables dispatch");
+        off.publish("{\"e\":1}");
+        off.flush();
+        expect_eq_ll((long long)off.dropped(), 0, "disabled dispatcher drops nothing");
+    }
+
+    // env parsing
+    setenv("MACHINA_NOTIFY_WEBHOOKS", " file:///tmp/a , ,file:///tmp/b", 1);
+    {
+        auto urls = NotifyDispatcher::urls_from_env();
+        expect_eq_ll((long long)urls.size(), 2, "two destinations parsed");
+        expect_true(urls[0] == "file:///tmp/a" && urls[1] == "file:///tmp/b",
+                    "whitespace and empty tokens trimmed");
+    }
+    unsetenv("MACHINA_NOTIFY_WEBHOOKS");
+
+    // Batched delivery to both destinations; events stay in publish order.
+    fs::path sink_a = scratch / "a.jsonl";
+    fs::path sink_b = scratch / "b.jsonl";
+    {
+        NotifyDispatcher d({"file://" + sink_a.string(), "file://" + sink_b.string()});
+        expect_true(d.enabled(), "dispatcher enabled");
+        for (int i = 0; i < 10; i++) {
+            d.publish("{\"i\":" + std::to_string(i) + "}");
+        }
+        d.flush();
+        expect_true(d.sent_batches() >= 2, "each destination got at least one batch");
+        expect_eq_ll((long long)d.failed_batches(), 0, "file sink deliveries succeed");
+    }
+    for (const auto& sink : {sink_a, sink_b}) {
+        auto lines = read_lines(sink);
+        expect_true(!lines.empty(), "batches landed in " + sink.string());
+        std::string joined;
+        for (const auto& l : lines) joined += l;
+        for (int i = 0; i < 10; i++) {
+            expect_true(joined.find("{\"i\":" + std::to_string(i) + "}") != std::string::npos,
+                        "event " + std::to_string(i) + " delivered");
+        }
+        expect_true(joined.find("{\"i\":0}") < joined.find("{\"i\":9}"),
+                    "publish order preserved");
+        expect_true(lines[0].front() == '[' && lines[0].back() == ']',
+                    "batch is a JSON array");
+    }
+
+    // Backpressure: a tiny ring drops the oldest events instead of blocking.
+    {
+        setenv("MACHINA_NOTIFY_RING", "8", 1);
+        fs::path blocked = scratch / "missing_dir" / "sink.jsonl"; // unwritable
+        NotifyDispatcher d({"file://" + blocked.string()});
+        for (int i = 0; i < 200; i++) {
+            d.publish("{\"i\":" + std::to_string(i) + "}");
+        }
+        d.flush(500);
+        expect_true(d.dropped() > 0, "overflow drops oldest events");
+        expect_true(d.failed_batches() > 0, "unwritable sink counts failures");
+        unsetenv("MACHINA_NOTIFY_RING");
+    }
+
+    fs::remove_all(scratch);
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "test_common.h"
+
+#include "machina/numa.h"
+#include "machina/thread_pool.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+int main() {
+    // Must land before the first call: enablement latches once per process.
+    setenv("MACHINA_NUMA", "1", 1);
+
+    int nodes = machina::numa_node_count();
+    expect_true(nodes >= 1, "at least one node reported");
+
+    if (!machina::numa_enabled()) {
+        // Single-node box (or non-Linux): the helpers must stay inert.
+        std::cout << "single NUMA node; placement stays off\n";
+        expect_true(nodes == 1 || !machina::numa_enabled(), "disabled on one node");
+    }
+
+    // Best-effort contract: pinning to any node index never faults, and an
+    // out-of-range index wraps instead of failing.
+    (void)machina::numa_pin_thread(0);
+    (void)machina::numa_pin_thread(nodes + 3);
+
+    // A touched heap page reports a valid node where the syscall exists.
+    {
+        void* p = std::malloc(4096);
+        std::memset(p, 1, 4096);
+        int node = machina::numa_node_of(p);
+        expect_true(node == -1 || (node >= 0 && node < nodes), "node id in range");
+        std::free(p);
+    }
+
+    // Degenerate sizes are rejected, not bound.
+    expect_true(!machina::numa_interleave_memory(nullptr, 4096), "null addr rejected");
+    expect_true(!machina::numa_bind_memory(nullptr, 4096, 0), "null addr rejected");
+
+    // The shared pool still runs work with NUMA requested (pins are
+    // best-effort inside the workers).
+    {
+        std::atomic<int> hits{0};
+        machina::ThreadPool::shared().parallel_for(0, 64, [&](size_t b, size_t e) {
+            hits.fetch_add((int)(e - b));
+        });
+        expect_eq_ll(hits.load(), 64, "pool ran all chunks");
+    }
+
+    return 0;
+}
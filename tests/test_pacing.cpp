@@ -0,0 +1,64 @@
+#include "test_common.h"
+
+#include "machina/json_mini.h"
+#include "machina/pacing.h"
+
+#include <chrono>
+#include <thread>
+
+using machina::Budget;
+using machina::BudgetPacer;
+
+int main() {
+    // Fresh pacer with room to spare: every knob is identity.
+    {
+        Budget b;
+        BudgetPacer p(b);
+        expect_true(!p.exhausted(), "fresh pacer not exhausted");
+        expect_true(p.pressure() < 0.1, "fresh pacer has no pressure");
+        expect_eq_ll(p.timeout_cap_ms(), 0, "no cap without pressure");
+        expect_true(p.k_scale() == 1.0, "full k without pressure");
+    }
+
+    // Step depletion raises pressure and shrinks k monotonically.
+    {
+        Budget b;
+        b.max_steps = 10;
+        BudgetPacer p(b);
+        double last_scale = 1.0;
+        for (int i = 0; i < 9; i++) {
+            p.note_step(1);
+            double s = p.k_scale();
+            expect_true(s <= last_scale, "k_scale never grows");
+            last_scale = s;
+        }
+        expect_true(p.pressure() >= 0.9, "nine of ten steps used");
+        expect_true(p.k_scale() < 1.0 && p.k_scale() >= BudgetPacer::kMinKScale,
+                    "k_scale in degraded band");
+        expect_true(!p.exhausted(), "step pressure alone never exhausts");
+    }
+
+    // Wall-clock budget: caps engage under pressure, exhaustion after.
+    {
+        Budget b;
+        b.max_ms = 120;
+        BudgetPacer p(b);
+        std::this_thread::sleep_for(std::chrono::milliseconds(80));
+        p.note_step(80);
+        expect_true(p.pressure() >= BudgetPacer::kPressureFloor, "time pressure built");
+        int cap = p.timeout_cap_ms();
+        expect_true(cap >= BudgetPacer::kMinTimeoutMs, "cap floored");
+        std::this_thread::sleep_for(std::chrono::milliseconds(60));
+        expect_true(p.exhausted(), "budget spent");
+
+        std::string js = p.hints_json();
+        expect_true(machina::json_mini::get_double(js, "pressure").value_or(0) >= 0.99,
+                    "hints report full pressure");
+        expect_eq_ll(machina::json_mini::get_int(js, "remaining_ms").value_or(-2), 0,
+                     "remaining clamped at zero");
+        expect_true(machina::json_mini::get_int(js, "remaining_steps").value_or(-1) >= 0,
+                    "remaining steps reported");
+    }
+
+    return 0;
+}
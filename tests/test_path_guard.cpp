@@ -0,0 +1,73 @@
+#include "test_common.h"
+
+#include "machina/path_guard.h"
+
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+int main() {
+    fs::path scratch = fs::temp_directory_path() / "machina_test_path_guard";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch / "root" / "sub");
+    fs::create_directories(scratch / "outside");
+    fs::path root = scratch / "root";
+
+    { std::ofstream f(root / "a.txt"); f << "x"; }
+    { std::ofstream f(scratch / "outside" / "b.txt"); f << "y"; }
+
+    // Containment basics.
+    expect_true(machina::path_is_under(root / "a.txt", root), "file under root");
+    expect_true(machina::path_is_under(root / "sub", root), "subdir under root");
+    expect_true(machina::path_is_under(root, root), "root is under itself");
+    expect_true(!machina::path_is_under(scratch / "outside" / "b.txt", root),
+                "sibling not under root");
+
+    // ".." traversal is normalized away before the check.
+    expect_true(!machina::path_is_under(root / ".." / "outside" / "b.txt", root),
+                "dot-dot escape rejected");
+    expect_true(machina::path_is_under(root / "sub" / ".." / "a.txt", root),
+                "dot-dot that stays inside accepted");
+
+    // Prefix lookalikes: /x/root2 is not under /x/root.
+    fs::create_directories(scratch / "rootx");
+    expect_true(!machina::path_is_under(scratch / "rootx", root),
+                "sibling with root as string prefix rejected");
+
+#ifndef _WIN32
+    // A symlink leaf pointing outside the root must not pass: leaves are
+    // resolved fresh, bypassing the parent cache.
+    fs::create_symlink(scratch / "outside" / "b.txt", root / "link_out");
+    expect_true(!machina::path_is_under(root / "link_out", root),
+                "symlink leaf escaping root rejected");
+    fs::create_symlink(root / "a.txt", root / "link_in");
+    expect_true(machina::path_is_under(root / "link_in", root),
+                "symlink leaf staying inside accepted");
+#endif
+
+    // Cached parent entries keep answering correctly as the directory grows.
+    { std::ofstream f(root / "later.txt"); f << "z"; }
+    expect_true(machina::path_is_under(root / "later.txt", root),
+                "file created after cache warmup resolves");
+    expect_true(machina::path_canon_cached(root / "later.txt") ==
+                    fs::weakly_canonical(root / "later.txt"),
+                "cached canon matches weakly_canonical");
+
+    // Canonicalization of a nonexistent leaf under an existing parent works
+    // (weakly_canonical semantics).
+    expect_true(!machina::path_canon_cached(root / "missing.txt").empty(),
+                "missing leaf still canonicalizes");
+
+    // Basename allowlist: case-insensitive, compiled once.
+    machina::BasenameAllowlist allow({"python3", "SH", "node"});
+    expect_true(allow.contains("python3"), "exact match");
+    expect_true(allow.contains("sh"), "entry lowered at construction");
+    expect_true(allow.contains("NODE"), "probe lowered at lookup");
+    expect_true(!allow.contains("perl"), "absent entry rejected");
+    expect_true(!allow.empty(), "populated allowlist not empty");
+    expect_true(machina::BasenameAllowlist{}.empty(), "default allowlist empty");
+
+    fs::remove_all(scratch);
+    return 0;
+}
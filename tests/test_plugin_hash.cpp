@@ -31,7 +31,59 @@ int main() {
         expect_true(hash.empty(), "nonexistent file should return empty hash");
     }
 
-    // Test 3: PluginManager hash mismatch rejection
+    // Test 3: tree hash — memory and file paths agree, format is self-describing,
+    // and sha256_hex_file_matching recomputes in whichever format it is handed
+    {
+        fs::path tmp = fs::temp_directory_path() / "machina_test_tree.bin";
+        std::string data;
+        for (int i = 0; i < 100000; i++) data.push_back((char)(i * 31 + 7));
+        {
+            std::ofstream f(tmp, std::ios::binary);
+            f.write(data.data(), (std::streamsize)data.size());
+        }
+
+        // Small chunk size forces multiple chunks (and the parallel path).
+        std::string mem = machina::sha256_tree_hex(
+            reinterpret_cast<const uint8_t*>(data.data()), data.size(), 4096);
+        std::string file = machina::sha256_tree_hex_file(tmp, 4096);
+        expect_true(mem == file, "tree hash: memory and file agree");
+        expect_true(mem.rfind("tree:v1:4096:", 0) == 0, "tree hash carries its chunk size");
+        expect_true(mem == machina::sha256_tree_hex(
+                               reinterpret_cast<const uint8_t*>(data.data()), data.size(), 4096),
+                    "tree hash is deterministic");
+        expect_true(mem != machina::sha256_tree_hex(
+                               reinterpret_cast<const uint8_t*>(data.data()), data.size(), 8192),
+                    "different chunk size yields a different digest");
+
+        // Matching recompute: tree expectation → tree recompute, plain → flat.
+        expect_true(machina::sha256_hex_file_matching(tmp, mem) == mem,
+                    "matching recompute reproduces the tree digest");
+        std::string flat = machina::sha256_hex_file(tmp);
+        expect_true(machina::sha256_hex_file_matching(tmp, flat) == flat,
+                    "matching recompute falls back to flat sha256");
+        expect_true(machina::sha256_hex_file_matching(tmp, "tree:v1:bogus:ff").empty(),
+                    "malformed tree spec yields empty");
+
+        fs::remove(tmp);
+    }
+
+    // Test 4: PluginManager rejects a wrong tree-format expectation too
+    {
+        machina::PluginManager pm;
+        fs::path tmp = fs::temp_directory_path() / "fake_plugin_tree.so";
+        {
+            std::ofstream f(tmp);
+            f << "still not a real plugin";
+        }
+        pm.set_expected_hash(
+            fs::weakly_canonical(tmp).string(),
+            "tree:v1:4096:0000000000000000000000000000000000000000000000000000000000000000");
+        std::string err;
+        expect_true(!pm.load_plugin(tmp, nullptr, &err), "should fail with wrong tree hash");
+        fs::remove(tmp);
+    }
+
+    // Test 5: PluginManager hash mismatch rejection
     {
         machina::PluginManager pm;
         fs::path tmp = fs::temp_directory_path() / "fake_plugin.so";
@@ -0,0 +1,105 @@
+#include "test_common.h"
+
+#include "machina/selector.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+#ifndef _WIN32
+
+static std::vector<std::string> read_lines(const fs::path& p) {
+    std::vector<std::string> lines;
+    std::ifstream f(p);
+    std::string line;
+    while (std::getline(f, line)) lines.push_back(line);
+    return lines;
+}
+
+int main() {
+    fs::path scratch = fs::temp_directory_path() / "machina_test_policy_payload";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+    setenv("MACHINA_POLICY_ALLOWED_SCRIPT_ROOT", scratch.string().c_str(), 1);
+    // Keep the shared breaker table on scratch so stale trips from other
+    // runs cannot leak in.
+    setenv("MACHINA_ROOT", scratch.string().c_str(), 1);
+
+    // Policy that records the menu_file it was handed, verifies it holds the
+    // menu, and picks the first tool.
+    fs::path script = scratch / "policy.sh";
+    fs::path seen = scratch / "seen.txt";
+    {
+        std::ofstream f(script);
+        f << "#!/bin/sh\n"
+          << "mf=$(sed -n 's/.*\"menu_file\":\"\\([^\"]*\\)\".*/\\1/p' \"$1\" | tr -d '\\\\')\n"
+          << "echo \"$mf\" >> " << seen.string() << "\n"
+          << "[ -n \"$mf\" ] && [ -f \"$mf\" ] || { echo '<NOOP><END>'; exit 0; }\n"
+          << "grep -q 'AID.NOOP.v1' \"$mf\" || { echo '<NOOP><END>'; exit 0; }\n"
+          << "echo '<PICK><SID0001><END>'\n";
+    }
+
+    machina::Menu menu;
+    {
+        machina::MenuItem mi;
+        mi.sid.value = 1;
+        mi.aid = "AID.NOOP.v1";
+        mi.name = "noop";
+        mi.tags = {"tag.meta"};
+        menu.items.push_back(mi);
+        menu.buildIndex();
+    }
+
+    fs::path menu_file_first, menu_file_third;
+    {
+        machina::ExternalProcessSelector sel(
+            std::make_unique<machina::HeuristicSelector>(), scratch,
+            "sh " + script.string());
+
+        auto s1 = sel.select(menu, "goal.TEST|FLAGS:;", "d", machina::ControlMode::POLICY_ONLY, "{}");
+        expect_true(s1.kind == machina::Selection::Kind::PICK, "policy picked: " + s1.raw);
+        expect_true(s1.sid && s1.sid->value == 1, "picked SID0001");
+
+        auto s2 = sel.select(menu, "goal.TEST|FLAGS:;", "d", machina::ControlMode::POLICY_ONLY, "{}");
+        expect_true(s2.kind == machina::Selection::Kind::PICK, "second pick");
+
+        // Same menu digest: both steps were handed the same side file.
+        auto lines = read_lines(seen);
+        expect_eq_ll((long long)lines.size(), 2, "two policy calls recorded");
+        expect_true(!lines[0].empty(), "menu_file present in payload");
+        expect_true(lines[0] == lines[1], "menu file reused while digest unchanged");
+        menu_file_first = lines[0];
+        expect_true(fs::exists(menu_file_first), "cached menu file on disk");
+
+        // Menu change rotates the content-addressed file.
+        machina::MenuItem mi2;
+        mi2.sid.value = 2;
+        mi2.aid = "AID.ERROR_SCAN.v1";
+        mi2.name = "error_scan";
+        menu.addItem(std::move(mi2));
+        auto s3 = sel.select(menu, "goal.TEST|FLAGS:;", "d", machina::ControlMode::POLICY_ONLY, "{}");
+        expect_true(s3.kind == machina::Selection::Kind::PICK, "third pick");
+        lines = read_lines(seen);
+        expect_eq_ll((long long)lines.size(), 3, "three policy calls recorded");
+        expect_true(lines[2] != lines[0], "new digest gets a new menu file");
+        menu_file_third = lines[2];
+        expect_true(!fs::exists(menu_file_first), "stale menu file removed");
+        expect_true(fs::exists(menu_file_third), "current menu file on disk");
+    }
+    // Destruction cleans up the last cached file.
+    expect_true(!fs::exists(menu_file_third), "menu file removed on teardown");
+
+    fs::remove_all(scratch);
+    return 0;
+}
+
+#else
+
+int main() { return 0; }
+
+#endif
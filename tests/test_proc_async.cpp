@@ -0,0 +1,118 @@
+#include "machina/proc.h"
+#include "test_common.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace machina;
+
+#ifndef _WIN32
+
+static ProcLimits test_limits() {
+    ProcLimits lim;
+    lim.timeout_ms = 5000;
+    lim.rlimit_cpu_sec = 4;
+    lim.rlimit_as_mb = 512;
+    lim.rlimit_fsize_mb = 8;
+    lim.rlimit_nofile = 64;
+    lim.rlimit_nproc = 64;
+    return lim;
+}
+
+int main() {
+    ProcLimits lim = test_limits();
+
+    // single child: spawn, wait, capture
+    {
+        std::string err;
+        ProcAsyncHandle h = proc_spawn_async({"echo", "async-hello"}, "", lim, "", &err);
+        expect_true(h != 0, "spawn returns handle");
+        ProcResult pr;
+        expect_true(proc_async_wait(h, &pr), "wait returns result");
+        expect_eq_ll(pr.exit_code, 0, "echo exit code");
+        expect_true(pr.output.find("async-hello") != std::string::npos, "echo output captured");
+        // handle is consumed — second wait must fail
+        expect_true(!proc_async_wait(h, &pr), "consumed handle rejected");
+    }
+
+    // unknown handle
+    {
+        ProcResult pr;
+        expect_true(!proc_async_wait(0, &pr), "zero handle rejected");
+        expect_true(!proc_async_poll(9999999, &pr), "unknown handle rejected");
+    }
+
+    // stdin round-trips through the reactor's write multiplexing
+    {
+        ProcAsyncHandle h = proc_spawn_async({"cat"}, "", lim, "fan-out payload\n");
+        expect_true(h != 0, "cat spawned");
+        ProcResult pr;
+        expect_true(proc_async_wait(h, &pr), "cat finished");
+        expect_eq_ll(pr.exit_code, 0, "cat exit code");
+        expect_true(pr.output.find("fan-out payload") != std::string::npos, "stdin echoed back");
+    }
+
+    // fan-out: N sleeps run concurrently, not serially
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<ProcAsyncHandle> hs;
+        for (int i = 0; i < 8; i++) {
+            hs.push_back(proc_spawn_async({"sleep", "0.3"}, "", lim));
+            expect_true(hs.back() != 0, "sleep spawned");
+        }
+        for (auto h : hs) {
+            ProcResult pr;
+            expect_true(proc_async_wait(h, &pr), "sleep awaited");
+            expect_eq_ll(pr.exit_code, 0, "sleep exit code");
+        }
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        // serial execution would take ~2400ms; allow generous slack for CI
+        expect_true(ms < 1500, "8 sleeps overlapped");
+    }
+
+    // poll: false while running, true (exactly once) after completion
+    {
+        ProcAsyncHandle h = proc_spawn_async({"sleep", "0.2"}, "", lim);
+        expect_true(h != 0, "sleep spawned for poll");
+        ProcResult pr;
+        expect_true(!proc_async_poll(h, &pr), "poll false while running");
+        bool got = false;
+        for (int i = 0; i < 200 && !got; i++) {
+            got = proc_async_poll(h, &pr);
+            if (!got) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        expect_true(got, "poll eventually true");
+        expect_eq_ll(pr.exit_code, 0, "polled exit code");
+    }
+
+    // timeout kills a stuck child
+    {
+        ProcLimits fast = lim;
+        fast.timeout_ms = 200;
+        ProcAsyncHandle h = proc_spawn_async({"sleep", "5"}, "", fast);
+        expect_true(h != 0, "sleep 5 spawned");
+        ProcResult pr;
+        expect_true(proc_async_wait(h, &pr), "timed-out child awaited");
+        expect_true(pr.timed_out, "timeout flagged");
+    }
+
+    // cwd honored (fork fallback and fast paths both chdir)
+    {
+        ProcAsyncHandle h = proc_spawn_async({"pwd"}, "/tmp", lim);
+        expect_true(h != 0, "pwd spawned");
+        ProcResult pr;
+        expect_true(proc_async_wait(h, &pr), "pwd finished");
+        expect_true(pr.output.find("/tmp") != std::string::npos, "cwd applied");
+    }
+
+    return 0;
+}
+
+#else
+
+int main() { return 0; }
+
+#endif
@@ -0,0 +1,74 @@
+#include "test_common.h"
+#include "machina/registry.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static machina::ToolDesc mk(const std::string& aid, std::vector<std::string> tags) {
+    machina::ToolDesc d;
+    d.aid = aid;
+    d.name = "tool " + aid;
+    d.tags = std::move(tags);
+    return d;
+}
+
+int main() {
+    machina::Registry reg;
+    reg.registerToolDesc(mk("AID.C.v1", {"fs", "read"}));
+    reg.registerToolDesc(mk("AID.A.v1", {"fs", "write"}));
+    reg.registerToolDesc(mk("AID.B.v1", {"net"}));
+    reg.registerToolDesc(mk("AID.D.v1", {}));
+
+    // Empty tag list returns everything, sorted by AID.
+    {
+        auto all = reg.queryByTags({});
+        expect_true(all.size() == 4, "empty query returns all tools");
+        expect_true(std::is_sorted(all.begin(), all.end(),
+                                   [](const machina::ToolDesc& a, const machina::ToolDesc& b) {
+                                       return a.aid < b.aid;
+                                   }),
+                    "empty query sorted by aid");
+    }
+
+    // Single tag hits exactly the carriers, in AID order.
+    {
+        auto fs = reg.queryByTags({"fs"});
+        expect_true(fs.size() == 2, "fs tag matches two tools");
+        expect_true(fs[0].aid == "AID.A.v1" && fs[1].aid == "AID.C.v1",
+                    "fs postings sorted by aid");
+    }
+
+    // Multi-tag queries are a UNION (RC2+ semantics), deduplicated.
+    {
+        auto u = reg.queryByTags({"fs", "net", "write"});
+        expect_true(u.size() == 3, "union of fs/net/write is three tools");
+        expect_true(u[0].aid == "AID.A.v1" && u[1].aid == "AID.B.v1" && u[2].aid == "AID.C.v1",
+                    "union stays sorted and deduplicated");
+    }
+
+    // Unknown tags match nothing.
+    expect_true(reg.queryByTags({"nope"}).empty(), "unknown tag matches nothing");
+
+    // Overriding a tool rewrites its postings: old tags drop it, new ones gain it.
+    {
+        uint64_t gen_before = reg.generation();
+        reg.registerToolDesc(mk("AID.B.v1", {"fs"}), /*allow_override=*/true);
+        expect_true(reg.generation() > gen_before, "override bumps generation");
+        expect_true(reg.queryByTags({"net"}).empty(), "old tag no longer matches");
+        expect_true(reg.queryByTags({"fs"}).size() == 3, "new tag picks up override");
+    }
+
+    // Duplicate registration without override still throws.
+    {
+        bool threw = false;
+        try {
+            reg.registerToolDesc(mk("AID.A.v1", {"fs"}));
+        } catch (const std::exception&) {
+            threw = true;
+        }
+        expect_true(threw, "duplicate aid without override throws");
+    }
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "test_common.h"
+
+#include "machina/json_mini.h"
+#include "machina/log.h"
+#include "machina/runlog_index.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+int main() {
+    fs::path scratch = fs::temp_directory_path() / "machina_test_runlog_index";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+
+    fs::path log = scratch / "run_idx.jsonl";
+
+    machina::RunHeader hdr;
+    hdr.run_id = "run-idx-test";
+    {
+        machina::JsonlLogger lg(hdr, log.string());
+        lg.event(0, "run_start", "{}");
+        lg.event(1, "tool_ok", "{\"aid\":\"AID.NOOP.v1\",\"duration_ms\":3}");
+        lg.event(2, "tool_error", "{\"aid\":\"AID.FAIL.v1\",\"duration_ms\":7}");
+        lg.event(3, "tool_ok", "{\"aid\":\"AID.NOOP.v1\",\"duration_ms\":1}");
+        lg.event(4, "run_end", "{}");
+    }
+
+    // The logger wrote a sidecar with one entry per line, in order.
+    {
+        std::vector<machina::runlog_index::Entry> entries;
+        expect_true(machina::runlog_index::load(log.string(), &entries), "index loads");
+        expect_eq_ll((long long)entries.size(), 5, "one entry per event");
+        expect_true(entries[0].event == "run_start", "first entry event");
+        expect_eq_ll(entries[0].offset, 0, "first entry offset");
+        expect_eq_ll(entries[2].step, 2, "entry carries step");
+        expect_eq_ll(entries[1].offset + entries[1].len, entries[2].offset,
+                     "entries tile the log");
+    }
+
+    // Indexed reads return exactly the matching lines, in log order,
+    // identical to what a full scan would have seen.
+    {
+        std::vector<std::string> lines;
+        expect_true(machina::runlog_index::read_event_lines(
+                        log.string(), {"tool_ok", "tool_error"}, &lines),
+                    "indexed read succeeds");
+        expect_eq_ll((long long)lines.size(), 3, "three tool events");
+
+        std::vector<std::string> scanned;
+        std::ifstream f(log.string());
+        std::string line;
+        while (std::getline(f, line)) {
+            auto ev = machina::json_mini::get_string(line, "event").value_or("");
+            if (ev == "tool_ok" || ev == "tool_error") scanned.push_back(line);
+        }
+        expect_true(lines == scanned, "indexed lines match full scan");
+
+        auto payload = machina::json_mini::get_object_raw(lines[1], "payload").value_or("");
+        expect_true(machina::json_mini::get_string(payload, "aid").value_or("") == "AID.FAIL.v1",
+                    "payload survives round trip");
+    }
+
+    // No matching events is still a usable index (true + empty).
+    {
+        std::vector<std::string> lines{"sentinel"};
+        expect_true(machina::runlog_index::read_event_lines(log.string(), {"breaker"}, &lines),
+                    "index usable for absent event");
+        expect_true(lines.empty(), "no breaker events");
+    }
+
+    // A truncated log invalidates the index: entries point past EOF, so
+    // consumers must fall back to scanning what is left.
+    {
+        fs::resize_file(log, fs::file_size(log) / 2);
+        std::vector<std::string> lines;
+        expect_true(!machina::runlog_index::read_event_lines(
+                        log.string(), {"tool_ok"}, &lines),
+                    "stale index rejected after truncation");
+    }
+
+    // Missing sidecar: plain fallback signal, not an error.
+    {
+        fs::path bare = scratch / "run_bare.jsonl";
+        std::ofstream(bare) << "{\"event\":\"tool_ok\"}\n";
+        std::vector<std::string> lines;
+        expect_true(!machina::runlog_index::read_event_lines(bare.string(), {"tool_ok"}, &lines),
+                    "no sidecar means no index");
+    }
+
+    fs::remove_all(scratch);
+    return 0;
+}
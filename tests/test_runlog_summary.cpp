@@ -0,0 +1,94 @@
+#include "test_common.h"
+
+#include "machina/json_mini.h"
+#include "machina/tools.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace machina {
+ToolResult tool_run_log_summary(const std::string& input_json, DSState& ds_tmp);
+}
+
+using machina::DSState;
+using machina::StepStatus;
+
+namespace fs = std::filesystem;
+
+static void append_events(const fs::path& log, int from, int count) {
+    std::ofstream f(log, std::ios::app);
+    for (int i = from; i < from + count; i++) {
+        f << "{\"event\":\"tool_ok\",\"ts\":\"t" << i << "\",\"run_id\":\"r1\","
+          << "\"payload\":{\"aid\":\"AID.NOOP.v1\",\"duration_ms\":" << (i % 7) << "}}\n";
+    }
+}
+
+static std::string summarize(const std::string& path, const std::string& extra = "") {
+    std::string in = "{\"path\":\"" + path + "\"" + extra + "}";
+    DSState ds;
+    auto r = machina::tool_run_log_summary(in, ds);
+    expect_true(r.status == StepStatus::OK, "summary should succeed: " + r.error);
+    return r.output_json;
+}
+
+int main() {
+    fs::path scratch = fs::temp_directory_path() / "machina_test_runlog_summary";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch / "logs");
+    setenv("MACHINA_ROOT", scratch.c_str(), 1);
+
+    fs::path log = scratch / "logs" / "run_test.jsonl";
+    append_events(log, 0, 100);
+
+    // Full scan counts every event and reports tool aggregates.
+    {
+        std::string out = summarize(log.string());
+        expect_eq_ll(machina::json_mini::get_int(out, "lines").value_or(-1), 100, "full scan lines");
+        auto tools = machina::json_mini::get_array_raw(out, "tools").value_or("");
+        expect_true(tools.find("\"ok\":100") != std::string::npos, "tool ok count");
+    }
+
+    // Incremental: unchanged file scans nothing but reports cumulative totals.
+    {
+        std::string out1 = summarize(log.string(), ",\"incremental\":true");
+        expect_eq_ll(machina::json_mini::get_int(out1, "lines").value_or(-1), 100, "incremental first run");
+        std::string out2 = summarize(log.string(), ",\"incremental\":true");
+        expect_eq_ll(machina::json_mini::get_int(out2, "lines").value_or(-1), 100, "unchanged cumulative lines");
+        expect_eq_ll(machina::json_mini::get_int(out2, "scanned_bytes").value_or(-1), 0, "unchanged scans 0 bytes");
+
+        // Appended events fold into the running totals.
+        append_events(log, 100, 10);
+        std::string out3 = summarize(log.string(), ",\"incremental\":true");
+        expect_eq_ll(machina::json_mini::get_int(out3, "lines").value_or(-1), 110, "appended events counted");
+        expect_true(machina::json_mini::get_string(out3, "last_ts").value_or("") == "t109", "last_ts advances");
+        auto tools = machina::json_mini::get_array_raw(out3, "tools").value_or("");
+        expect_true(tools.find("\"ok\":110") != std::string::npos, "cumulative tool ok count");
+
+        // A partial line without newline is left for the next run.
+        {
+            std::ofstream f(log, std::ios::app);
+            f << "{\"event\":\"tool_ok\",\"ts\":\"t110\"";
+        }
+        std::string out4 = summarize(log.string(), ",\"incremental\":true");
+        expect_eq_ll(machina::json_mini::get_int(out4, "lines").value_or(-1), 110, "partial tail not consumed");
+        {
+            std::ofstream f(log, std::ios::app);
+            f << "}\n";
+        }
+        std::string out5 = summarize(log.string(), ",\"incremental\":true");
+        expect_eq_ll(machina::json_mini::get_int(out5, "lines").value_or(-1), 111, "completed tail counted");
+    }
+
+    // full:true rescans from scratch and resets the state.
+    {
+        std::string out = summarize(log.string(), ",\"full\":true");
+        expect_eq_ll(machina::json_mini::get_int(out, "lines").value_or(-1), 111, "full rescan lines");
+        std::string out2 = summarize(log.string(), ",\"incremental\":true");
+        expect_eq_ll(machina::json_mini::get_int(out2, "scanned_bytes").value_or(-1), 0, "state refreshed by full");
+    }
+
+    fs::remove_all(scratch);
+    return 0;
+}
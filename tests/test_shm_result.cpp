@@ -0,0 +1,60 @@
+#include "test_common.h"
+
+#include "machina/hash.h"
+#include "machina/shm_result.h"
+
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+int main() {
+    // Round trip: write, read back verified, segment unlinked.
+    {
+        std::string payload(512 * 1024, 'x');
+        payload += "tail";
+        std::string path, err;
+        uint64_t fnv = 0;
+        expect_true(machina::shm_result_write(payload, &path, &fnv, &err),
+                    "write: " + err);
+        expect_true(fs::exists(path), "segment exists before read");
+        expect_true(fnv == machina::hash::fnv1a64(payload), "checksum matches payload");
+
+        std::string back;
+        expect_true(machina::shm_result_read(path, payload.size(), fnv, &back, &err),
+                    "read: " + err);
+        expect_true(back == payload, "payload round trips");
+        expect_true(!fs::exists(path), "segment unlinked after read");
+    }
+
+    // Length and checksum mismatches are rejected and leave out untouched.
+    {
+        std::string payload = "small payload";
+        std::string path, err;
+        uint64_t fnv = 0;
+        expect_true(machina::shm_result_write(payload, &path, &fnv, &err), "write small");
+        std::string back = "sentinel";
+        expect_true(!machina::shm_result_read(path, payload.size() + 1, fnv, &back, &err),
+                    "wrong length rejected");
+        expect_true(!machina::shm_result_read(path, payload.size(), fnv ^ 1, &back, &err),
+                    "wrong checksum rejected");
+        expect_true(back == "sentinel", "out untouched on failure");
+        expect_true(machina::shm_result_read(path, payload.size(), fnv, &back, &err),
+                    "clean read still works");
+    }
+
+    // Foreign paths never reach the filesystem read.
+    {
+        std::string back, err;
+        expect_true(!machina::shm_result_read("/etc/hostname", 1, 0, &back, &err),
+                    "path outside segment dir rejected");
+        expect_true(!machina::shm_result_read("/dev/shm/other_prefix", 1, 0, &back, &err),
+                    "foreign prefix rejected");
+        expect_true(!machina::shm_result_read("/dev/shm/machina_shm_x/../../etc/passwd", 1, 0, &back, &err),
+                    "traversal rejected");
+    }
+
+    expect_true(machina::shm_result_threshold() > 0, "lane enabled by default");
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include "test_common.h"
+
+#include "machina/tx.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using machina::Artifact;
+using machina::DSState;
+using machina::StateCell;
+using machina::Tx;
+
+static Artifact text_artifact(const std::string& content) {
+    Artifact a;
+    a.type = "text";
+    a.provenance = "test";
+    a.content_json = content;
+    a.size_bytes = content.size();
+    return a;
+}
+
+int main() {
+    DSState initial;
+    initial.slots[0] = text_artifact("{\"v\":0}");
+    StateCell cell(std::move(initial));
+
+    // Basic commit: the new snapshot sees the write, the old one does not.
+    auto s1 = cell.snapshot();
+    {
+        Tx tx(s1);
+        tx.tmp().slots[0] = text_artifact("{\"v\":1}");
+        tx.tmp().slots[1] = text_artifact("{\"w\":1}");
+        uint64_t v = 0;
+        expect_true(cell.try_commit(tx, s1, &v), "uncontended commit succeeds");
+        expect_true(v == 1, "first commit is version 1");
+        expect_true(!tx.patch_json().empty(), "commit produced a patch");
+    }
+    auto s2 = cell.snapshot();
+    expect_true(s2.slots[1] != nullptr, "new snapshot sees added slot");
+    expect_true(s1.slots[1] == nullptr, "old snapshot unaffected by commit");
+    expect_true(s1.slots[0]->content_json.find("\"v\":0") != std::string::npos,
+                "old snapshot keeps its artifact");
+    expect_true(s2.slots[0].get() != s1.slots[0].get(), "written slot republished");
+
+    // Disjoint writers from the same snapshot both commit.
+    {
+        Tx ta(s2), tb(s2);
+        ta.tmp().slots[2] = text_artifact("{\"a\":1}");
+        tb.tmp().slots[3] = text_artifact("{\"b\":1}");
+        expect_true(cell.try_commit(ta, s2), "writer A (slot 2) commits");
+        expect_true(cell.try_commit(tb, s2), "writer B (slot 3) commits after A");
+        auto s = cell.snapshot();
+        expect_true(s.slots[2] && s.slots[3], "both disjoint writes visible");
+        expect_true(s.slots[0].get() == s2.slots[0].get(),
+                    "untouched slot shared across versions, not copied");
+    }
+
+    // Conflicting writers: second commit fails, succeeds after rebase.
+    {
+        auto base = cell.snapshot();
+        Tx ta(base), tb(base);
+        ta.tmp().slots[4] = text_artifact("{\"c\":\"first\"}");
+        tb.tmp().slots[4] = text_artifact("{\"c\":\"second\"}");
+        expect_true(cell.try_commit(ta, base), "first writer commits");
+        expect_true(!cell.try_commit(tb, base), "conflicting writer rejected");
+        auto fresh = cell.snapshot();
+        Tx tc(fresh);
+        tc.tmp().slots[4] = text_artifact("{\"c\":\"second\"}");
+        expect_true(cell.try_commit(tc, fresh), "rebased writer commits");
+        expect_true(cell.snapshot().slots[4]->content_json.find("second") !=
+                        std::string::npos,
+                    "rebased write is current");
+    }
+
+    // Removal is a versioned write like any other.
+    {
+        auto base = cell.snapshot();
+        Tx tx(base);
+        tx.tmp().slots.erase(1);
+        expect_true(cell.try_commit(tx, base), "removal commits");
+        expect_true(cell.snapshot().slots[1] == nullptr, "slot removed");
+        Tx stale(base);
+        stale.tmp().slots[1] = text_artifact("{\"w\":2}");
+        expect_true(!cell.try_commit(stale, base), "write racing a removal rejected");
+    }
+
+    // materialize() round-trips into the plain-DSState world.
+    {
+        auto s = cell.snapshot();
+        DSState plain = s.materialize();
+        expect_true(plain.slots.count(0) == 1 && plain.slots.count(1) == 0,
+                    "materialized state mirrors snapshot occupancy");
+        expect_true(!plain.digest().empty(), "materialized state digests");
+    }
+
+    // Contended counter across threads: every increment must land exactly
+    // once, with losers re-snapshotting and retrying.
+    {
+        StateCell counter(DSState{});
+        constexpr int kThreads = 4;
+        constexpr int kIncrements = 50;
+        std::vector<std::thread> th;
+        for (int t = 0; t < kThreads; t++) {
+            th.emplace_back([&counter]() {
+                for (int i = 0; i < kIncrements; i++) {
+                    for (;;) {
+                        auto base = counter.snapshot();
+                        long long cur = 0;
+                        if (base.slots[0]) {
+                            const std::string& c = base.slots[0]->content_json;
+                            cur = std::stoll(c.substr(c.find(':') + 1));
+                        }
+                        Tx tx(base);
+                        tx.tmp().slots[0] =
+                            text_artifact("{\"n\":" + std::to_string(cur + 1) + "}");
+                        if (counter.try_commit(tx, base)) break;
+                    }
+                }
+            });
+        }
+        for (auto& t : th) t.join();
+        auto s = counter.snapshot();
+        const std::string& c = s.slots[0]->content_json;
+        expect_eq_ll(std::stoll(c.substr(c.find(':') + 1)),
+                     kThreads * kIncrements, "no lost increments under contention");
+        expect_true(counter.version() >= (uint64_t)(kThreads * kIncrements),
+                    "every successful commit got its own version");
+    }
+
+    return 0;
+}
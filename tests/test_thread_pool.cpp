@@ -0,0 +1,57 @@
+#include "test_common.h"
+#include "machina/thread_pool.h"
+
+#include <atomic>
+#include <numeric>
+#include <vector>
+
+using machina::ThreadPool;
+
+int main() {
+    // submit: all tasks run exactly once.
+    {
+        ThreadPool pool(4);
+        std::atomic<int> ran{0};
+        std::mutex mu;
+        std::condition_variable cv;
+        for (int i = 0; i < 100; i++) {
+            pool.submit([&] {
+                if (ran.fetch_add(1) + 1 == 100) {
+                    std::lock_guard<std::mutex> lk(mu);
+                    cv.notify_one();
+                }
+            });
+        }
+        std::unique_lock<std::mutex> lk(mu);
+        cv.wait(lk, [&] { return ran.load() == 100; });
+        expect_true(ran.load() == 100, "all submitted tasks should run");
+    }
+
+    // parallel_for: covers every index exactly once, works on tiny ranges.
+    {
+        ThreadPool pool(3);
+        const size_t n = 100000;
+        std::vector<std::atomic<int>> hits(n);
+        pool.parallel_for(0, n, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++) hits[i].fetch_add(1);
+        });
+        bool all_once = true;
+        for (size_t i = 0; i < n; i++) all_once = all_once && hits[i].load() == 1;
+        expect_true(all_once, "parallel_for should visit each index exactly once");
+
+        std::atomic<int> tiny{0};
+        pool.parallel_for(5, 7, [&](size_t b, size_t e) {
+            tiny.fetch_add((int)(e - b));
+        });
+        expect_true(tiny.load() == 2, "parallel_for handles ranges smaller than the pool");
+
+        pool.parallel_for(9, 9, [&](size_t, size_t) { tiny.fetch_add(100); });
+        expect_true(tiny.load() == 2, "empty range runs nothing");
+    }
+
+    // shared(): same instance every time.
+    expect_true(&ThreadPool::shared() == &ThreadPool::shared(),
+                "shared pool should be a process-wide singleton");
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "test_common.h"
+
+#include "machina/timer_wheel.h"
+
+#include <string>
+#include <vector>
+
+using machina::TimerWheel;
+
+int main() {
+    // Basic firing order against the tick grid.
+    TimerWheel<std::string> w(1000, 10, 16);
+    w.schedule(1025, "a");
+    w.schedule(1300, "b");
+    w.schedule(900, "past"); // already due: fires on the next advance
+
+    expect_eq_ll((long long)w.size(), 3, "size after three schedules");
+
+    std::vector<std::string> out;
+    w.advance(1000, out);
+    expect_eq_ll((long long)out.size(), 1, "only the past-due entry fires at t=1000");
+    expect_true(out[0] == "past", "past-due entry fires first");
+
+    out.clear();
+    w.advance(1030, out);
+    expect_eq_ll((long long)out.size(), 1, "entry a fires by t=1030");
+    expect_true(out[0] == "a", "entry a value");
+
+    // Not early: b is due at 1300.
+    out.clear();
+    w.advance(1299, out);
+    expect_eq_ll((long long)out.size(), 0, "b must not fire before its due time");
+    w.advance(1300, out);
+    expect_eq_ll((long long)out.size(), 1, "b fires at its due time");
+    expect_true(w.empty(), "wheel drains to empty");
+
+    // Overflow: due beyond the horizon (16 slots * 10ms = 160ms) parks and
+    // cascades back in, firing at the right time.
+    w.schedule(5000, "far");
+    w.schedule(1400, "near");
+    int64_t hint = w.next_due_hint();
+    expect_true(hint >= 0 && hint <= 1400, "hint not later than earliest entry");
+
+    out.clear();
+    w.advance(1400, out);
+    expect_eq_ll((long long)out.size(), 1, "near fires, far still parked");
+    expect_true(out[0] == "near", "near entry value");
+
+    out.clear();
+    w.advance(4999, out);
+    expect_eq_ll((long long)out.size(), 0, "far must not fire early");
+    w.advance(5005, out);
+    expect_eq_ll((long long)out.size(), 1, "far fires after cascading in");
+    expect_true(out[0] == "far", "far entry value");
+
+    // A large jump (many revolutions) sweeps every slot once.
+    TimerWheel<int> w2(0, 10, 8);
+    for (int i = 0; i < 20; i++) w2.schedule(i * 37, i);
+    std::vector<int> iout;
+    w2.advance(100000, iout);
+    expect_eq_ll((long long)iout.size(), 20, "all entries fire across a long jump");
+    expect_true(w2.next_due_hint() == -1, "empty wheel has no due hint");
+
+    // for_each sees pending entries with their due times.
+    TimerWheel<int> w3(0, 10, 8);
+    w3.schedule(55, 1);
+    w3.schedule(2000, 2); // overflow
+    long long seen = 0, due_sum = 0;
+    w3.for_each([&](int64_t due, int v) { seen += v; due_sum += due; });
+    expect_eq_ll(seen, 3, "for_each visits wheel and overflow entries");
+    expect_eq_ll(due_sum, 2055, "for_each reports due times");
+
+    return 0;
+}
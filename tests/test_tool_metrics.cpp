@@ -0,0 +1,54 @@
+#include "machina/tool_metrics.h"
+#include "machina/tools.h"
+#include "test_common.h"
+
+#include <string>
+
+using namespace machina;
+
+int main() {
+    expect_true(tool_metrics_enabled(), "metrics enabled by default");
+
+    // entries are stable and deduplicated per AID
+    ToolMetricsEntry* e = tool_metrics_entry("AID.TEST.FAKE.v1");
+    expect_true(e != nullptr, "entry created");
+    expect_true(e == tool_metrics_entry("AID.TEST.FAKE.v1"), "entry stable");
+
+    tool_metrics_record(e, 100, false, false);
+    tool_metrics_record(e, 5000, true, false);
+    tool_metrics_record(e, 2'000'000, true, true);
+    expect_eq_ll((long long)e->calls.load(), 3, "calls counted");
+    expect_eq_ll((long long)e->errors.load(), 2, "errors counted");
+    expect_eq_ll((long long)e->timeouts.load(), 1, "timeouts counted");
+    expect_eq_ll((long long)e->max_us.load(), 2'000'000, "max tracked");
+
+    // ToolRunner records through the same registry
+    ToolRunner runner;
+    runner.registerTool("AID.TEST.OK.v1", [](const std::string&, DSState&) -> ToolResult {
+        return {StepStatus::OK, "{}", ""};
+    });
+    runner.registerTool("AID.TEST.ERR.v1", [](const std::string&, DSState&) -> ToolResult {
+        return {StepStatus::TOOL_ERROR, "{}", "boom"};
+    });
+    DSState ds;
+    (void)runner.run("AID.TEST.OK.v1", "{}", ds);
+    (void)runner.run("AID.TEST.OK.v1", "{}", ds);
+    (void)runner.run("AID.TEST.ERR.v1", "{}", ds);
+    ToolMetricsEntry* ok = tool_metrics_entry("AID.TEST.OK.v1");
+    ToolMetricsEntry* err = tool_metrics_entry("AID.TEST.ERR.v1");
+    expect_eq_ll((long long)ok->calls.load(), 2, "runner calls recorded");
+    expect_eq_ll((long long)ok->errors.load(), 0, "ok tool has no errors");
+    expect_eq_ll((long long)err->errors.load(), 1, "error recorded");
+
+    // snapshot shape
+    std::string js = tool_metrics_json();
+    expect_true(js.find("\"AID.TEST.FAKE.v1\"") != std::string::npos, "aid in snapshot");
+    expect_true(js.find("\"calls\":3") != std::string::npos, "calls in snapshot");
+    expect_true(js.find("\"p95_us\":") != std::string::npos, "percentiles in snapshot");
+    expect_true(js.find("\"hist_us\":{") != std::string::npos, "histogram in snapshot");
+#ifndef _WIN32
+    expect_true(js.find("\"children\":{") != std::string::npos, "child rusage in snapshot");
+#endif
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "test_common.h"
+#include "machina/topk.h"
+
+#include <cstdint>
+#include <vector>
+
+int main() {
+    // Default comparator: keeps the k largest ints, sorted best first.
+    {
+        machina::TopK<int> tk(3);
+        for (int v : {5, 1, 9, 3, 7, 2, 8}) tk.offer(v);
+        auto out = tk.take_sorted();
+        expect_true(out.size() == 3, "keeps exactly k items");
+        expect_true(out[0] == 9 && out[1] == 8 && out[2] == 7, "keeps the largest, best first");
+    }
+
+    // Fewer offers than k, and k == 0.
+    {
+        machina::TopK<int> tk(10);
+        tk.offer(4);
+        tk.offer(2);
+        expect_true(tk.size() == 2 && !tk.full(), "partial fill tracked");
+        auto out = tk.take_sorted();
+        expect_true(out.size() == 2 && out[0] == 4, "partial selection sorted");
+
+        machina::TopK<int> zero(0);
+        expect_true(!zero.offer(1) && zero.size() == 0, "k=0 keeps nothing");
+    }
+
+    // Custom comparator over a struct, worst() tracks the eviction bar.
+    {
+        struct Cand { float s; uint64_t i; };
+        auto better = [](const Cand& a, const Cand& b) { return a.s > b.s; };
+        machina::TopK<Cand, decltype(better)> tk(2, better);
+        tk.offer({0.5f, 0});
+        tk.offer({0.9f, 1});
+        expect_true(tk.worst().s == 0.5f, "worst is the eviction bar");
+        expect_true(!tk.offer({0.1f, 2}), "below the bar is rejected");
+        expect_true(tk.offer({0.7f, 3}), "above the bar evicts the worst");
+        auto out = tk.take_sorted();
+        expect_true(out[0].i == 1 && out[1].i == 3, "selection survives eviction");
+    }
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "test_common.h"
+
+#include "machina/json_mini.h"
+#include "machina/trace.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+int main() {
+    fs::path scratch = fs::temp_directory_path() / "machina_test_trace";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+    // Must land before the first trace call: enablement and the Chrome
+    // sink are latched once per process.
+    setenv("MACHINA_ROOT", scratch.c_str(), 1);
+    setenv("MACHINA_TRACE", "1", 1);
+    setenv("MACHINA_TRACE_CHROME", "1", 1);
+    unsetenv("MACHINA_TRACE_SAMPLE");
+
+    expect_true(machina::trace_enabled(), "tracing enabled via env");
+
+    // Spans accumulate into the stage histogram.
+    for (int i = 0; i < 5; i++) {
+        MACHINA_TRACE_SPAN("test_stage");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    {
+        std::string js = machina::trace_json();
+        expect_true(machina::json_mini::get_bool(js, "enabled").value_or(false), "snapshot enabled");
+        auto stages = machina::json_mini::get_object_raw(js, "stages").value_or("");
+        auto stage = machina::json_mini::get_object_raw(stages, "test_stage").value_or("");
+        expect_true(!stage.empty(), "test_stage present in snapshot");
+        expect_eq_ll(machina::json_mini::get_int(stage, "calls").value_or(-1), 5, "span count");
+        expect_true(machina::json_mini::get_int(stage, "mean_us").value_or(0) >= 1000,
+                    "mean covers the sleep");
+        expect_true(machina::json_mini::get_int(stage, "p95_us").value_or(0) >=
+                        machina::json_mini::get_int(stage, "p50_us").value_or(0),
+                    "p95 >= p50");
+    }
+
+    // Chrome events went to the per-process file named in the snapshot.
+    {
+        std::string js = machina::trace_json();
+        std::string path = machina::json_mini::get_string(js, "chrome_trace").value_or("");
+        expect_true(!path.empty(), "chrome trace path reported");
+        std::ifstream f(path);
+        expect_true(f.good(), "chrome trace file exists");
+        std::stringstream ss; ss << f.rdbuf();
+        std::string body = ss.str();
+        expect_true(body.rfind("[", 0) == 0, "chrome trace starts as array");
+        expect_true(body.find("\"name\":\"test_stage\"") != std::string::npos,
+                    "chrome trace has span events");
+        expect_true(body.find("\"ph\":\"X\"") != std::string::npos, "complete events");
+    }
+
+    // A disabled-stage pointer records nothing and costs a null check.
+    {
+        machina::TraceSpan nop(nullptr, "never");
+        (void)nop;
+    }
+
+    fs::remove_all(scratch);
+    return 0;
+}
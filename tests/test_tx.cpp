@@ -64,5 +64,23 @@ int main() {
     expect_true(target.slots.count(1) == 1, "target should have slot1");
     expect_true(target.slots.at(0).content_json.find("world") != std::string::npos, "slot0 should be updated");
 
+    // merge_tx_patches collapses sequential patches to their net effect
+    {
+        std::vector<std::string> patches = {
+            "[{\"op\":\"add\",\"path\":\"/slots/2\",\"value\":{\"type\":\"text\",\"provenance\":\"t\",\"content_json\":\"{\\\"a\\\":1}\",\"size_bytes\":7}}]",
+            "[{\"op\":\"replace\",\"path\":\"/slots/2\",\"value\":{\"type\":\"text\",\"provenance\":\"t\",\"content_json\":\"{\\\"a\\\":2}\",\"size_bytes\":7}},"
+            "{\"op\":\"remove\",\"path\":\"/slots/5\"}]",
+        };
+        std::string merged = machina::merge_tx_patches(patches);
+        expect_true(!merged.empty(), "merge should succeed");
+        expect_true(count_ops(merged, "replace") == 1, "merged keeps last op on slot 2");
+        expect_true(count_ops(merged, "add") == 0, "superseded add dropped");
+        expect_true(count_ops(merged, "remove") == 1, "remove survives merge");
+        expect_true(merged.find("\\\"a\\\":2") != std::string::npos, "merged carries final value");
+
+        expect_true(machina::merge_tx_patches({}) == "[]", "empty input merges to empty patch");
+        expect_true(machina::merge_tx_patches({"not json"}).empty(), "unparseable patch yields empty");
+    }
+
     return 0;
 }
@@ -47,5 +47,62 @@ int main() {
     expect_true(!machina::dsstate_apply_tx_patch(bad, &s), "invalid op should fail");
     json_object_put(bad);
 
+    // batched apply: two patches, later patch wins on the shared slot
+    {
+        DSState b;
+        b.slots[0] = mk_art("{\"v\":1}");
+        json_object* p1 = json_tokener_parse(
+            "[{\"op\":\"replace\",\"path\":\"/slots/0\",\"value\":{\"type\":\"text\",\"provenance\":\"t\",\"content_json\":\"{\\\"v\\\":2}\",\"size_bytes\":7}},"
+            "{\"op\":\"add\",\"path\":\"/slots/3\",\"value\":{\"type\":\"text\",\"provenance\":\"t\",\"content_json\":\"{\\\"a\\\":1}\",\"size_bytes\":7}}]");
+        json_object* p2 = json_tokener_parse(
+            "[{\"op\":\"replace\",\"path\":\"/slots/0\",\"value\":{\"type\":\"text\",\"provenance\":\"t\",\"content_json\":\"{\\\"v\\\":3}\",\"size_bytes\":7}}]");
+        expect_true(machina::dsstate_apply_tx_patches({p1, p2}, &b), "batched apply should succeed");
+        json_object_put(p1);
+        json_object_put(p2);
+        expect_true(b.slots[0].content_json == "{\"v\":3}", "later patch wins on slot 0");
+        expect_true(b.slots.count(3) == 1, "earlier patch still applied slot 3");
+    }
+
+    // batched apply is all-or-nothing: a bad op in the second patch must
+    // leave the first patch unapplied too
+    {
+        DSState b;
+        b.slots[0] = mk_art("{\"v\":1}");
+        json_object* good = json_tokener_parse("[{\"op\":\"remove\",\"path\":\"/slots/0\"}]");
+        json_object* badp = json_tokener_parse("[{\"op\":\"move\",\"path\":\"/slots/1\"}]");
+        expect_true(!machina::dsstate_apply_tx_patches({good, badp}, &b), "batch with bad op fails");
+        json_object_put(good);
+        json_object_put(badp);
+        expect_true(b.slots.count(0) == 1, "failed batch left state untouched");
+    }
+
+    // JsonWriter state serializers round-trip through the json-c parsers
+    {
+        DSState b;
+        b.slots[1] = mk_art("{\"msg\":\"quote \\\" and \\n newline\"}");
+        b.slots[4] = mk_art("{\"n\":42}");
+
+        json_object* full = json_tokener_parse(machina::dsstate_to_json_str(b).c_str());
+        expect_true(full != nullptr, "dsstate_to_json_str parses");
+        DSState back;
+        expect_true(machina::dsstate_from_json(full, &back), "full state round-trips");
+        json_object_put(full);
+        expect_true(back.slots.size() == 2 &&
+                        back.slots[1].content_json == b.slots[1].content_json,
+                    "escaped content survives round trip");
+
+        DSState cur = b;
+        cur.slots[4] = mk_art("{\"n\":43}");
+        cur.slots.erase(1);
+        json_object* delta = json_tokener_parse(
+            machina::dsstate_to_json_delta_str(cur, &b).c_str());
+        expect_true(delta != nullptr, "dsstate_to_json_delta_str parses");
+        DSState applied = b;
+        expect_true(machina::dsstate_apply_delta(delta, &applied), "delta applies");
+        json_object_put(delta);
+        expect_true(applied.slots.count(1) == 0, "delta removal applied");
+        expect_true(applied.slots[4].content_json == "{\"n\":43}", "delta replace applied");
+    }
+
     return 0;
 }
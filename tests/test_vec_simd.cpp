@@ -0,0 +1,61 @@
+#include "test_common.h"
+#include "machina/vec_simd.h"
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+int main() {
+    // Compare the dispatched kernel against a double-accumulating reference
+    // across sizes that exercise full SIMD lanes, remainders, and tiny inputs.
+    const size_t sizes[] = {0, 1, 3, 4, 7, 8, 15, 16, 31, 32, 64, 127, 384, 1000};
+    uint32_t rng = 42;
+    auto next = [&rng]() {
+        rng = rng * 1664525u + 1013904223u;
+        return ((float)(rng >> 8) / 16777216.0f) - 0.5f;
+    };
+
+    for (size_t n : sizes) {
+        std::vector<float> a(n), b(n);
+        for (size_t i = 0; i < n; i++) { a[i] = next(); b[i] = next(); }
+
+        double ref = 0.0;
+        for (size_t i = 0; i < n; i++) ref += (double)a[i] * (double)b[i];
+
+        float got = machina::vec::dot_f32(a.data(), b.data(), n);
+        double tol = 1e-4 * ((double)n + 1.0);
+        expect_true(std::fabs((double)got - ref) <= tol,
+                    "dot_f32 should match scalar reference at n=" + std::to_string(n));
+    }
+
+    // Half-precision conversions roundtrip within fp16 resolution.
+    const float vals[] = {0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 3.14159f, -65504.0f, 1e-5f};
+    for (float v : vals) {
+        float back = machina::vec::f16_to_f32(machina::vec::f32_to_f16(v));
+        expect_true(std::fabs(back - v) <= std::fabs(v) * 1e-3 + 1e-7,
+                    "f16 roundtrip near " + std::to_string(v));
+    }
+
+    // Quantized kernels against their scalar definitions.
+    {
+        const size_t n = 384;
+        std::vector<float> a(n), v(n);
+        for (size_t i = 0; i < n; i++) { a[i] = next(); v[i] = next(); }
+
+        std::vector<uint16_t> h(n);
+        for (size_t i = 0; i < n; i++) h[i] = machina::vec::f32_to_f16(v[i]);
+        double ref16 = 0.0;
+        for (size_t i = 0; i < n; i++) ref16 += (double)a[i] * (double)machina::vec::f16_to_f32(h[i]);
+        float got16 = machina::vec::dot_f16(a.data(), h.data(), n);
+        expect_true(std::fabs((double)got16 - ref16) <= 1e-3, "dot_f16 matches scalar reference");
+
+        std::vector<int8_t> q(n);
+        for (size_t i = 0; i < n; i++) q[i] = (int8_t)(i % 255 - 127);
+        double ref8 = 0.0;
+        for (size_t i = 0; i < n; i++) ref8 += (double)a[i] * (double)q[i];
+        float got8 = machina::vec::dot_i8(a.data(), q.data(), n);
+        expect_true(std::fabs((double)got8 - ref8) <= 1e-2, "dot_i8 matches scalar reference");
+    }
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "test_common.h"
+
+#include "vectordb_tools.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+int main() {
+    auto root = fs::temp_directory_path() / "machina_test_vecdb_prealloc";
+    fs::remove_all(root);
+    fs::create_directories(root);
+    setenv("MACHINA_ROOT", root.string().c_str(), 1);
+    setenv("MACHINA_VECDB_DIM", "8", 1);
+    // Small step so the test exercises preallocation without big files.
+    setenv("MACHINA_VECDB_PREALLOC_MB", "1", 1);
+
+    std::string err;
+    expect_true(machina::vectordb_upsert_text("pre", "first vector", "", &err),
+                "upsert: " + err);
+
+    auto sd = root / "work" / "vectordb" / "pre";
+    auto ep = sd / "embeddings.f32";
+    expect_true(fs::exists(ep), "embeddings file exists");
+    expect_true(fs::exists(sd / "commit.hdr"), "commit header written");
+
+#ifndef _WIN32
+    // Physical size runs ahead of the data; committed bytes stay exact.
+    expect_eq_ll((long long)fs::file_size(ep), 1024 * 1024, "file fallocated to step");
+    expect_eq_ll((long long)machina::vectordb_committed_bytes(sd, ep),
+                 8 * (long long)sizeof(float), "one committed vector");
+
+    // A batch advances the counter by the whole batch.
+    std::vector<std::string> texts = {"second", "third", "fourth"};
+    size_t count = 0;
+    expect_true(machina::vectordb_upsert_batch("pre", texts, &count, &err),
+                "batch: " + err);
+    expect_eq_ll((long long)count, 3, "batch count");
+    expect_eq_ll((long long)machina::vectordb_committed_bytes(sd, ep),
+                 4 * 8 * (long long)sizeof(float), "four committed vectors");
+
+    // Queries size their scan from committed bytes, so the zero tail never
+    // surfaces as phantom hits.
+    std::vector<machina::VecdbHit> hits;
+    expect_true(machina::vectordb_query_direct("pre", "third", 16, 0, nullptr,
+                                               &hits, nullptr, nullptr, &err),
+                "query: " + err);
+    expect_eq_ll((long long)hits.size(), 4, "hits bounded by committed vectors");
+#endif
+
+    // A legacy stream without the sidecar reports its plain file size.
+    auto legacy = root / "legacy";
+    fs::create_directories(legacy);
+    auto lep = legacy / "embeddings.f32";
+    {
+        std::ofstream out(lep, std::ios::binary);
+        std::string bytes(64, '\1');
+        out.write(bytes.data(), (std::streamsize)bytes.size());
+    }
+    expect_eq_ll((long long)machina::vectordb_committed_bytes(legacy, lep), 64,
+                 "legacy stream sized by file length");
+    expect_eq_ll((long long)machina::vectordb_committed_bytes(legacy, legacy / "absent"),
+                 0, "missing file reports zero");
+
+    fs::remove_all(root);
+    return 0;
+}
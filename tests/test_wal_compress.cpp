@@ -0,0 +1,79 @@
+#include "test_common.h"
+#include "machina/wal.h"
+#include "machina/wal_reader.h"
+
+#include <filesystem>
+#include <string>
+
+using machina::Wal;
+using machina::WalPolicy;
+using machina::WalReader;
+
+int main() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "machina_test_wal_compress";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir, ec);
+
+    fs::path p = dir / "comp.jsonl";
+
+    // Repetitive JSON payloads (the workload compression is meant for)
+    const std::string pad(120, 'x');
+    int64_t raw_bytes = 0;
+    {
+        Wal wal(p);
+        WalPolicy pol;
+        pol.compress_block_bytes = 8 * 1024;
+        pol.max_segment_age_sec = 0;
+        wal.set_policy(pol);
+        wal.open(true);
+        for (int i = 0; i < 500; i++) {
+            std::string rec = "{\"i\":" + std::to_string(i) + ",\"pad\":\"" + pad + "\"}";
+            raw_bytes += (int64_t)rec.size() + 1;
+            std::string err = wal.append_json_line(rec);
+            expect_true(err.empty(), "compressed append should succeed: " + err);
+        }
+        // Destructor flushes the final partial block
+    }
+
+    int64_t file_bytes = (int64_t)fs::file_size(p, ec);
+    expect_true(file_bytes > 0, "compressed segment should be non-empty");
+    expect_true(file_bytes * 4 < raw_bytes, "compressed segment should be much smaller than raw");
+
+    // Transparent decompression in the reader
+    {
+        WalReader reader(p);
+        std::string err = reader.open();
+        expect_true(err.empty(), "compressed open should succeed: " + err);
+        expect_true(reader.record_count() == 500, "all records readable after decompression");
+        expect_true(reader.record(0).find("\"i\":0,") != std::string_view::npos, "first record content");
+        expect_true(reader.record(499).find("\"i\":499,") != std::string_view::npos, "last record content");
+    }
+
+    // Compression combined with group commit (fsync per batch, not per record)
+    {
+        fs::path g = dir / "comp_gc.jsonl";
+        Wal wal(g);
+        WalPolicy pol;
+        pol.compress_block_bytes = 4 * 1024;
+        pol.max_segment_age_sec = 0;
+        wal.set_policy(pol);
+        wal.set_fsync(true);
+        wal.open(true);
+        wal.enable_group_commit(32, 2);
+        for (int i = 0; i < 100; i++) {
+            std::string err = wal.append_json_line_sync("{\"g\":" + std::to_string(i) + ",\"pad\":\"" + pad + "\"}");
+            expect_true(err.empty(), "gc+compress append should succeed: " + err);
+        }
+        wal.disable_group_commit();
+
+        WalReader reader(g);
+        std::string err = reader.open();
+        expect_true(err.empty(), "gc+compress open should succeed: " + err);
+        expect_true(reader.record_count() == 100, "gc+compress records all durable");
+    }
+
+    fs::remove_all(dir, ec);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "test_common.h"
+#include "machina/wal.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+using machina::Wal;
+using machina::WalPolicy;
+
+int main() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "machina_test_wal_maint";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir, ec);
+
+    fs::path p = dir / "maint.jsonl";
+    {
+        Wal wal(p);
+        WalPolicy pol;
+        pol.max_segment_bytes = 300;
+        pol.max_segment_age_sec = 0;
+        pol.max_segments = 3;
+        wal.set_policy(pol);
+        wal.open(true);
+        wal.enable_maintenance(20);
+
+        // Cross the segment limit several times; swaps happen on the append
+        // path, renames and retention on the maintenance thread.
+        std::string line = "{\"pad\":\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\"}";
+        for (int i = 0; i < 60; i++) {
+            std::string err = wal.append_json_line(line);
+            expect_true(err.empty(), "append should succeed: " + err);
+            if (i % 10 == 9) std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(120));
+
+        auto segments = wal.list_segments();
+        expect_true(segments.size() > 1, "background rotation should produce segments");
+        expect_true((int)segments.size() <= pol.max_segments,
+                    "background retention should respect max_segments");
+
+        wal.disable_maintenance();
+        expect_true(!fs::exists(fs::path(p.string() + ".next"), ec),
+                    "spare segment should be cleaned up on disable");
+    }
+
+    // Crash-recovery path: a non-empty .next left behind is adopted on open
+    {
+        fs::path q = dir / "recover.jsonl";
+        {
+            std::ofstream base(q);
+            base << "{\"old\":1}\n";
+            std::ofstream next(q.string() + ".next");
+            next << "{\"new\":1}\n";
+        }
+        Wal wal(q);
+        std::string err = wal.open(false);
+        expect_true(err.empty(), "open should recover from leftover .next: " + err);
+        expect_true(!fs::exists(fs::path(q.string() + ".next"), ec),
+                    ".next should be renamed onto the base path");
+        expect_true(wal.list_segments().size() == 2,
+                    "old segment should be preserved as a rotated segment");
+    }
+
+    fs::remove_all(dir, ec);
+    return 0;
+}
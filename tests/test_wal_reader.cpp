@@ -0,0 +1,83 @@
+#include "test_common.h"
+#include "machina/wal.h"
+#include "machina/wal_reader.h"
+
+#include <filesystem>
+#include <string>
+
+using machina::Wal;
+using machina::WalReader;
+
+int main() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "machina_test_wal_reader";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir, ec);
+
+    fs::path p = dir / "seg.jsonl";
+
+    // Write a few hundred records (crosses several index stride buckets)
+    {
+        Wal wal(p);
+        wal.open(true);
+        for (int i = 0; i < 300; i++) {
+            wal.append_json_line("{\"i\":" + std::to_string(i) + "}");
+        }
+    }
+
+    // First open: builds and persists the index
+    {
+        WalReader reader(p);
+        std::string err = reader.open();
+        expect_true(err.empty(), "reader open should succeed: " + err);
+        expect_true(reader.record_count() == 300, "should see all 300 records");
+
+        expect_true(reader.record(0) == "{\"i\":0}", "record 0 content");
+        expect_true(reader.record(123) == "{\"i\":123}", "record 123 content");
+        expect_true(reader.record(299) == "{\"i\":299}", "last record content");
+        expect_true(reader.record(300).empty(), "out-of-range record is empty");
+        expect_true(reader.offset_of(0) == 0, "record 0 offset");
+        expect_true(reader.offset_of(300) == -1, "out-of-range offset is -1");
+
+        expect_true(fs::exists(fs::path(p.string() + ".idx")),
+                    "index should be persisted next to segment");
+    }
+
+    // Second open: loads the persisted index, same answers
+    {
+        WalReader reader(p);
+        std::string err = reader.open();
+        expect_true(err.empty(), "reader reopen should succeed: " + err);
+        expect_true(reader.record_count() == 300, "index-loaded count matches");
+        expect_true(reader.record(64) == "{\"i\":64}", "stride-boundary record");
+    }
+
+    // Segment grows after indexing: stale index is rebuilt
+    {
+        Wal wal(p);
+        wal.open(false);
+        wal.append_json_line("{\"i\":300}");
+    }
+    {
+        WalReader reader(p);
+        std::string err = reader.open();
+        expect_true(err.empty(), "reader open after append should succeed: " + err);
+        expect_true(reader.record_count() == 301, "stale index should be rebuilt");
+        expect_true(reader.record(300) == "{\"i\":300}", "new record readable");
+    }
+
+    // Empty segment
+    {
+        fs::path e = dir / "empty.jsonl";
+        Wal wal(e);
+        wal.open(true);
+        WalReader reader(e);
+        std::string err = reader.open();
+        expect_true(err.empty(), "empty segment open should succeed: " + err);
+        expect_true(reader.record_count() == 0, "empty segment has no records");
+    }
+
+    fs::remove_all(dir, ec);
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "test_common.h"
+#include "machina/wal.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using machina::Wal;
+
+int main() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "machina_test_wal_ring";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir, ec);
+
+    fs::path p = dir / "ring.jsonl";
+    Wal wal(p);
+    wal.set_tail_ring(8);
+    wal.open(true);
+
+    // Fewer records than capacity
+    for (int i = 0; i < 5; i++) {
+        wal.append_json_line("{\"i\":" + std::to_string(i) + "}");
+    }
+    auto t = wal.tail(10);
+    expect_true(t.size() == 5, "tail returns all records when under capacity");
+    expect_true(t.front() == "{\"i\":0}", "tail is oldest-first");
+    expect_true(t.back() == "{\"i\":4}", "tail ends with newest");
+    expect_true(wal.tail_seq() == 5, "tail_seq counts appends");
+
+    // Overflow: ring keeps only the newest 8
+    for (int i = 5; i < 20; i++) {
+        wal.append_json_line("{\"i\":" + std::to_string(i) + "}");
+    }
+    t = wal.tail(100);
+    expect_true(t.size() == 8, "ring caps retained records at capacity");
+    expect_true(t.front() == "{\"i\":12}", "oldest retained record after overflow");
+    expect_true(t.back() == "{\"i\":19}", "newest record after overflow");
+    expect_true(wal.tail(3).size() == 3, "tail(n) limits result size");
+
+    // Polling cursor subscription
+    uint64_t cursor = wal.tail_seq();
+    expect_true(wal.tail_since(&cursor).empty(), "cursor at head sees nothing new");
+    wal.append_json_line("{\"i\":20}");
+    wal.append_json_line("{\"i\":21}");
+    auto fresh = wal.tail_since(&cursor);
+    expect_true(fresh.size() == 2, "cursor picks up exactly the new records");
+    expect_true(fresh[0] == "{\"i\":20}" && fresh[1] == "{\"i\":21}", "cursor order");
+    expect_true(wal.tail_since(&cursor).empty(), "cursor is advanced past delivered records");
+
+    // Stale cursor (fell off the ring) resumes from oldest retained
+    uint64_t stale = 0;
+    auto resumed = wal.tail_since(&stale, 100);
+    expect_true(resumed.size() == 8, "stale cursor resumes from oldest retained");
+    expect_true(stale == wal.tail_seq(), "cursor lands on head after catch-up");
+
+    // Ring also tracks appends under group commit
+    {
+        Wal g(dir / "ring_gc.jsonl");
+        g.set_tail_ring(16);
+        g.open(true);
+        g.enable_group_commit(4, 2);
+        for (int i = 0; i < 10; i++) {
+            g.append_json_line("{\"g\":" + std::to_string(i) + "}");
+        }
+        expect_true(g.tail_seq() == 10, "ring sees batched appends immediately");
+        g.disable_group_commit();
+    }
+
+    fs::remove_all(dir, ec);
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "machina/proc.h"
+#include "machina/zygote.h"
+#include "test_common.h"
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace machina;
+
+#ifdef __linux__
+
+static ProcLimits test_limits() {
+    ProcLimits lim;
+    lim.timeout_ms = 5000;
+    lim.rlimit_cpu_sec = 4;
+    lim.rlimit_as_mb = 512;
+    lim.rlimit_fsize_mb = 8;
+    lim.rlimit_nofile = 64;
+    lim.rlimit_nproc = 32;
+    return lim;
+}
+
+int main() {
+    setenv("MACHINA_ZYGOTE_ENABLE", "1", 1);
+    setenv("MACHINA_ZYGOTE_POOL", "2", 1);
+    expect_true(zygote_enabled(), "zygote enabled via env");
+
+    ProcLimits lim = test_limits();
+
+    // capture through the pool
+    {
+        ProcResult pr;
+        std::vector<std::string> av = {"echo", "zygote-hello"};
+        expect_true(proc_run_capture_sandboxed(av, "", lim, &pr), "capture started");
+        expect_eq_ll(pr.exit_code, 0, "echo exit code");
+        expect_true(pr.output.find("zygote-hello") != std::string::npos, "echo output captured");
+    }
+
+    // stdin round-trips through the worker's fd wiring
+    {
+        ProcResult pr;
+        std::vector<std::string> av = {"cat"};
+        expect_true(proc_run_capture_sandboxed_stdin(av, "", "pooled stdin\n", lim, &pr),
+                    "stdin capture started");
+        expect_eq_ll(pr.exit_code, 0, "cat exit code");
+        expect_true(pr.output == "pooled stdin\n", "cat echoed stdin");
+    }
+
+    // nonzero exit codes survive CLONE_PARENT reparenting
+    {
+        ProcResult pr;
+        std::vector<std::string> av = {"sh", "-c", "exit 7"};
+        expect_true(proc_run_capture_sandboxed(av, "", lim, &pr), "exit-code run started");
+        expect_eq_ll(pr.exit_code, 7, "exit code propagated");
+    }
+
+    // timeout kill works on pooled children (the caller is the real parent)
+    {
+        ProcResult pr;
+        ProcLimits fast = lim;
+        fast.timeout_ms = 200;
+        std::vector<std::string> av = {"sleep", "5"};
+        expect_true(proc_run_capture_sandboxed(av, "", fast, &pr), "timeout run started");
+        expect_true(pr.timed_out, "sleep timed out");
+    }
+
+    // cwd is applied by the worker
+    {
+        ProcResult pr;
+        std::vector<std::string> av = {"pwd"};
+        expect_true(proc_run_capture_sandboxed(av, "/tmp", lim, &pr), "cwd run started");
+        expect_true(pr.output.find("/tmp") == 0, "pwd ran in /tmp, got: " + pr.output);
+    }
+
+    // unknown binaries fall back cleanly (pool returns -1, fork path gives 127)
+    {
+        ProcResult pr;
+        std::vector<std::string> av = {"definitely-not-a-binary-zyg"};
+        expect_true(proc_run_capture_sandboxed(av, "", lim, &pr), "missing binary run started");
+        expect_eq_ll(pr.exit_code, 127, "missing binary exit code");
+    }
+
+    // many sequential spawns exercise pool replenishment
+    for (int i = 0; i < 12; i++) {
+        ProcResult pr;
+        std::vector<std::string> av = {"true"};
+        expect_true(proc_run_capture_sandboxed(av, "", lim, &pr), "replenish run started");
+        expect_eq_ll(pr.exit_code, 0, "replenish exit code");
+    }
+
+    return 0;
+}
+
+#else
+
+int main() { return 0; }
+
+#endif
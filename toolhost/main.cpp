@@ -3,12 +3,20 @@
 #include "machina/state.h"
 #include "machina/tools.h"
 #include "machina/serialization.h"
+#include "machina/shm_result.h"
 #include "machina/lease.h"
+#include "machina/thread_pool.h"
+#include "machina/tool_metrics.h"
 
 #include <json-c/json.h>
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -39,7 +47,6 @@ struct IdempotencyCacheEntry {
     int64_t expiry_ms;
 };
 
-static std::unordered_map<std::string, IdempotencyCacheEntry> g_idemp_cache;
 static constexpr int64_t IDEMP_DEFAULT_TTL_MS = 60000; // 60 seconds
 static constexpr size_t IDEMP_MAX_ENTRIES = 1024;
 
@@ -48,46 +55,204 @@ static int64_t now_ms() {
     return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
 }
 
-static void idemp_gc() {
-    // Evict expired entries (lazy, on each check)
-    if (g_idemp_cache.size() < IDEMP_MAX_ENTRIES / 2) return;
-    int64_t now = now_ms();
-    for (auto it = g_idemp_cache.begin(); it != g_idemp_cache.end(); ) {
-        if (it->second.expiry_ms < now) {
-            it = g_idemp_cache.erase(it);
-        } else {
-            ++it;
+// Sharded by key hash with per-shard locks, so pipelined serve requests
+// don't serialize on one map and eviction never stops the world: each
+// store walks at most a few entries of its own shard, with a full sweep
+// of that shard only when it hits its size cap.
+//
+// Optional persistence: MACHINA_IDEMP_PERSIST=<path> appends each stored
+// entry as one NDJSON line and replays unexpired lines on startup, so the
+// dedup window survives a toolhost restart. The file is compacted (live
+// entries rewritten, then renamed into place) once appends pile up.
+class IdempotencyCache {
+public:
+    IdempotencyCache() {
+        const char* p = std::getenv("MACHINA_IDEMP_PERSIST");
+        if (p && *p) {
+            persist_path_ = p;
+            load_persisted();
         }
     }
-}
 
-// Returns true if this key was already processed (cache hit), filling result.
-// Returns false if this is a new request (cache miss).
-static bool idemp_check(const std::string& key, IdempotencyCacheEntry* out) {
-    if (key.empty()) return false;
-    int64_t now = now_ms();
-    auto it = g_idemp_cache.find(key);
-    if (it != g_idemp_cache.end()) {
-        if (it->second.expiry_ms > now) {
-            if (out) *out = it->second;
-            return true;
+    // Returns true if this key was already processed (cache hit), filling result.
+    // Returns false if this is a new request (cache miss).
+    bool check(const std::string& key, IdempotencyCacheEntry* out) {
+        if (key.empty()) return false;
+        int64_t now = now_ms();
+        Shard& sh = shard_for(key);
+        std::lock_guard<std::mutex> lk(sh.mu);
+        auto it = sh.map.find(key);
+        if (it != sh.map.end()) {
+            if (it->second.expiry_ms > now) {
+                if (out) *out = it->second;
+                return true;
+            }
+            // Expired
+            sh.map.erase(it);
+        }
+        return false;
+    }
+
+    void store(const std::string& key, const IdempotencyCacheEntry& e) {
+        if (key.empty()) return;
+        {
+            Shard& sh = shard_for(key);
+            std::lock_guard<std::mutex> lk(sh.mu);
+            evict_some(sh, e.expiry_ms - IDEMP_DEFAULT_TTL_MS);
+            sh.map[key] = e;
         }
-        // Expired
-        g_idemp_cache.erase(it);
+        if (!persist_path_.empty()) append_persisted(key, e);
     }
-    return false;
+
+private:
+    static constexpr size_t kShards = 16;
+    static constexpr size_t kShardCap = IDEMP_MAX_ENTRIES / kShards;
+    static constexpr size_t kEvictSteps = 4; // amortized per store
+
+    struct Shard {
+        std::mutex mu;
+        std::unordered_map<std::string, IdempotencyCacheEntry> map;
+    };
+
+    Shard& shard_for(const std::string& key) {
+        return shards_[std::hash<std::string>{}(key) % kShards];
+    }
+
+    // Caller holds sh.mu. Walks a few entries per store; falls back to a
+    // full sweep of this shard (1/16th of the cache) only at the cap, and
+    // drops arbitrary entries if the shard is full of live keys — losing a
+    // dedup entry is safe, it just allows one re-execution.
+    static void evict_some(Shard& sh, int64_t now) {
+        size_t steps = 0;
+        for (auto it = sh.map.begin(); it != sh.map.end() && steps < kEvictSteps; steps++) {
+            if (it->second.expiry_ms < now) it = sh.map.erase(it);
+            else ++it;
+        }
+        if (sh.map.size() < kShardCap) return;
+        for (auto it = sh.map.begin(); it != sh.map.end(); ) {
+            if (it->second.expiry_ms < now) it = sh.map.erase(it);
+            else ++it;
+        }
+        while (sh.map.size() >= kShardCap) sh.map.erase(sh.map.begin());
+    }
+
+    void load_persisted() {
+        std::ifstream in(persist_path_);
+        if (!in) return;
+        int64_t now = now_ms();
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty()) continue;
+            json_object* j = json_tokener_parse(line.c_str());
+            if (!j) continue;
+            json_object* v = nullptr;
+            IdempotencyCacheEntry e;
+            std::string key;
+            if (json_object_object_get_ex(j, "k", &v) && json_object_is_type(v, json_type_string))
+                key = json_object_get_string(v);
+            if (json_object_object_get_ex(j, "s", &v) && json_object_is_type(v, json_type_string))
+                e.status = json_object_get_string(v);
+            if (json_object_object_get_ex(j, "o", &v) && json_object_is_type(v, json_type_string))
+                e.output_json = json_object_get_string(v);
+            if (json_object_object_get_ex(j, "x", &v) && json_object_is_type(v, json_type_string))
+                e.error = json_object_get_string(v);
+            e.expiry_ms = 0;
+            if (json_object_object_get_ex(j, "e", &v))
+                e.expiry_ms = json_object_get_int64(v);
+            json_object_put(j);
+            if (key.empty() || e.expiry_ms <= now) continue;
+            Shard& sh = shard_for(key);
+            std::lock_guard<std::mutex> lk(sh.mu);
+            if (sh.map.size() < kShardCap) sh.map[key] = e;
+        }
+    }
+
+    static std::string persist_line(const std::string& key, const IdempotencyCacheEntry& e) {
+        json_object* j = json_object_new_object();
+        json_object_object_add(j, "k", json_object_new_string(key.c_str()));
+        json_object_object_add(j, "s", json_object_new_string(e.status.c_str()));
+        json_object_object_add(j, "o", json_object_new_string_len(e.output_json.c_str(), (int)e.output_json.size()));
+        json_object_object_add(j, "x", json_object_new_string_len(e.error.c_str(), (int)e.error.size()));
+        json_object_object_add(j, "e", json_object_new_int64(e.expiry_ms));
+        std::string line = json_object_to_json_string_ext(j, JSON_C_TO_STRING_PLAIN);
+        json_object_put(j);
+        return line;
+    }
+
+    void append_persisted(const std::string& key, const IdempotencyCacheEntry& e) {
+        std::lock_guard<std::mutex> lk(file_mu_);
+        {
+            std::ofstream out(persist_path_, std::ios::app);
+            if (!out) return;
+            out << persist_line(key, e) << "\n";
+        }
+        if (++appended_ >= 4 * IDEMP_MAX_ENTRIES) compact_locked();
+    }
+
+    // Caller holds file_mu_. Rewrites the file with only live entries and
+    // renames it into place so a crash mid-compaction leaves the old file.
+    void compact_locked() {
+        appended_ = 0;
+        std::string tmp = persist_path_ + ".tmp";
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) return;
+        int64_t now = now_ms();
+        for (auto& sh : shards_) {
+            std::lock_guard<std::mutex> lk(sh.mu);
+            for (auto& kv : sh.map) {
+                if (kv.second.expiry_ms > now) out << persist_line(kv.first, kv.second) << "\n";
+            }
+        }
+        out.close();
+        std::error_code ec;
+        std::filesystem::rename(tmp, persist_path_, ec);
+    }
+
+    Shard shards_[kShards];
+    std::mutex file_mu_;
+    std::string persist_path_;
+    size_t appended_{0};
+};
+
+static IdempotencyCache g_idemp_cache;
+
+static bool idemp_check(const std::string& key, IdempotencyCacheEntry* out) {
+    return g_idemp_cache.check(key, out);
 }
 
-static void idemp_store(const std::string& key, const ToolResult& r, int64_t ttl_ms = 0) {
-    if (key.empty()) return;
+// Takes ownership: the stored entry is the result's last consumer, so the
+// payload moves into the cache instead of copying (copy-audited path).
+static void idemp_store(const std::string& key, ToolResult&& r, int64_t ttl_ms = 0) {
     if (ttl_ms <= 0) ttl_ms = IDEMP_DEFAULT_TTL_MS;
-    idemp_gc();
-    g_idemp_cache[key] = {
+    g_idemp_cache.store(key, IdempotencyCacheEntry{
         stepstatus_to_str(r.status),
-        r.output_json,
-        r.error,
+        std::move(r.output_json),
+        std::move(r.error),
         now_ms() + ttl_ms,
-    };
+    });
+}
+
+// Attaches a tool output to a reply: inline as output_json, or — past the
+// shared-memory threshold — spilled to a tmpfs segment referenced by an
+// output_shm descriptor, keeping multi-MB payloads off the NDJSON pipe.
+static void attach_output_json(json_object* out, const std::string& output) {
+    size_t min = shm_result_threshold();
+    if (min > 0 && output.size() >= min) {
+        std::string path, serr;
+        uint64_t fnv = 0;
+        if (shm_result_write(output, &path, &fnv, &serr)) {
+            char hex[17];
+            std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)fnv);
+            json_object* shm = json_object_new_object();
+            json_object_object_add(shm, "path", json_object_new_string(path.c_str()));
+            json_object_object_add(shm, "len", json_object_new_int64((int64_t)output.size()));
+            json_object_object_add(shm, "fnv", json_object_new_string(hex));
+            json_object_object_add(out, "output_shm", shm);
+            json_object_object_add(out, "output_json", json_object_new_string(""));
+            return;
+        }
+    }
+    json_object_object_add(out, "output_json", json_object_new_string_len(output.c_str(), (int)output.size()));
 }
 
 static std::string slurp_stdin() {
@@ -191,7 +356,7 @@ int main(int argc, char** argv) {
         json_object* out = json_object_new_object();
         json_object_object_add(out, "ok", json_object_new_boolean(1));
         json_object_object_add(out, "status", json_object_new_string(stepstatus_to_str(r.status)));
-        json_object_object_add(out, "output_json", json_object_new_string_len(r.output_json.c_str(), (int)r.output_json.size()));
+        attach_output_json(out, r.output_json);
         json_object_object_add(out, "error", json_object_new_string_len(r.error.c_str(), (int)r.error.size()));
 
         json_object* dsj = dsstate_to_json(ds);
@@ -211,6 +376,15 @@ int main(int argc, char** argv) {
         // Supports delta serialization: incoming ds_state with "delta":true is applied
         // incrementally to the session state; responses also use delta encoding.
         //
+        // Pipelining: requests carrying an "id" field are dispatched to a small
+        // internal thread pool and their replies (tagged with the same "id")
+        // are written as they complete, possibly out of order — a slow tool no
+        // longer head-of-line-blocks the rest of the plugin. Untagged requests
+        // keep the strict one-in-one-out ordering existing clients rely on.
+        // Tools run on a private copy of the session state; their slot delta is
+        // merged back under the state lock, so the reply delta matches what the
+        // session absorbed.
+        //
         // Idempotency: if "idempotency_key" is present in the request, the result
         // is cached. Duplicate keys within the TTL window return the cached result
         // without re-executing the tool.
@@ -218,7 +392,7 @@ int main(int argc, char** argv) {
         // Lease verification: if MACHINA_LEASE_ENFORCE=1, tools with tier>0
         // require a "_lease_token" in the request. Tokens are single-use and TTL-bound.
         //
-        // An empty line or EOF terminates the server.
+        // An empty line or EOF terminates the server (after in-flight requests drain).
         DSState session_ds; // maintained across requests for delta tracking
         LeaseManager lease_mgr;
         bool enforce_leases = false;
@@ -227,16 +401,39 @@ int main(int argc, char** argv) {
             if (el && (std::string(el) == "1" || std::string(el) == "true")) enforce_leases = true;
         }
 
-        std::string line;
-        while (std::getline(std::cin, line)) {
-            if (line.empty()) break; // graceful shutdown
+        std::mutex state_mu; // session_ds, lease_mgr (idempotency cache locks per-shard)
+        std::mutex out_mu;   // one response line at a time
 
-            json_object* reqj = json_tokener_parse(line.c_str());
-            if (!reqj) {
-                std::cout << "{\"ok\":false,\"error\":\"invalid JSON\"}\n";
-                std::cout.flush();
-                continue;
+        auto write_line = [&](const std::string& l) {
+            std::lock_guard<std::mutex> lk(out_mu);
+            std::cout << l << "\n";
+            std::cout.flush();
+        };
+
+        // Mirror the request "id" (any JSON type) onto the reply so
+        // pipelined clients can match out-of-order responses.
+        auto attach_id = [](json_object* reqj, json_object* out) {
+            json_object* idv = nullptr;
+            if (json_object_object_get_ex(reqj, "id", &idv) && idv) {
+                json_object_object_add(out, "id", json_object_get(idv));
             }
+        };
+
+        // Consumes reqj; returns the serialized reply line.
+        auto handle_request = [&](json_object* reqj) -> std::string {
+            auto finish = [&](json_object* out) {
+                attach_id(reqj, out);
+                std::string l = json_object_to_json_string_ext(out, JSON_C_TO_STRING_PLAIN);
+                json_object_put(out);
+                json_object_put(reqj);
+                return l;
+            };
+            auto fail = [&](const std::string& msg) {
+                json_object* out = json_object_new_object();
+                json_object_object_add(out, "ok", json_object_new_boolean(0));
+                json_object_object_add(out, "error", json_object_new_string(msg.c_str()));
+                return finish(out);
+            };
 
             std::string aid;
             json_object* av = nullptr;
@@ -244,10 +441,7 @@ int main(int argc, char** argv) {
                 aid = json_object_get_string(av);
             }
             if (aid.empty()) {
-                std::cout << "{\"ok\":false,\"error\":\"missing aid\"}\n";
-                std::cout.flush();
-                json_object_put(reqj);
-                continue;
+                return fail("missing aid");
             }
 
             // Internal lease management commands (aid="_lease.issue" / "_lease.gc")
@@ -262,31 +456,46 @@ int main(int argc, char** argv) {
                     tier_val = json_object_get_int(tv);
                 if (json_object_object_get_ex(reqj, "ttl_ms", &tv) && json_object_is_type(tv, json_type_int))
                     ttl_ms_val = json_object_get_int64(tv);
-                auto tok = lease_mgr.issue_lease(tool_aid, tier_val, ttl_ms_val, "serve");
-                std::cout << "{\"ok\":true,\"token_id\":" << json_quote(tok.token_id)
-                          << ",\"tool_aid\":" << json_quote(tok.tool_aid)
-                          << ",\"tier\":" << tok.tier << "}\n";
-                std::cout.flush();
-                json_object_put(reqj);
-                continue;
+                LeaseToken tok;
+                {
+                    std::lock_guard<std::mutex> lk(state_mu);
+                    tok = lease_mgr.issue_lease(tool_aid, tier_val, ttl_ms_val, "serve");
+                }
+                json_object* out = json_object_new_object();
+                json_object_object_add(out, "ok", json_object_new_boolean(1));
+                json_object_object_add(out, "token_id", json_object_new_string(tok.token_id.c_str()));
+                json_object_object_add(out, "tool_aid", json_object_new_string(tok.tool_aid.c_str()));
+                json_object_object_add(out, "tier", json_object_new_int(tok.tier));
+                return finish(out);
             }
             if (aid == "_lease.gc") {
-                lease_mgr.gc();
-                std::cout << "{\"ok\":true,\"active\":" << lease_mgr.active_count()
-                          << ",\"issued\":" << lease_mgr.total_issued()
-                          << ",\"consumed\":" << lease_mgr.total_consumed()
-                          << ",\"rejected\":" << lease_mgr.total_rejected() << "}\n";
-                std::cout.flush();
-                json_object_put(reqj);
-                continue;
+                json_object* out = json_object_new_object();
+                {
+                    std::lock_guard<std::mutex> lk(state_mu);
+                    lease_mgr.gc();
+                    json_object_object_add(out, "ok", json_object_new_boolean(1));
+                    json_object_object_add(out, "active", json_object_new_int64((int64_t)lease_mgr.active_count()));
+                    json_object_object_add(out, "issued", json_object_new_int64((int64_t)lease_mgr.total_issued()));
+                    json_object_object_add(out, "consumed", json_object_new_int64((int64_t)lease_mgr.total_consumed()));
+                    json_object_object_add(out, "rejected", json_object_new_int64((int64_t)lease_mgr.total_rejected()));
+                }
+                return finish(out);
+            }
+
+            // Per-tool metrics snapshot (aid="_metrics")
+            if (aid == "_metrics") {
+                json_object* out = json_tokener_parse(tool_metrics_json().c_str());
+                if (!out) {
+                    out = json_object_new_object();
+                    json_object_object_add(out, "ok", json_object_new_boolean(0));
+                    json_object_object_add(out, "error", json_object_new_string("metrics snapshot failed"));
+                }
+                return finish(out);
             }
 
             auto it = registrar.tools.find(aid);
             if (it == registrar.tools.end() || !it->second.fn) {
-                std::cout << "{\"ok\":false,\"error\":" << json_quote("tool not found: " + aid) << "}\n";
-                std::cout.flush();
-                json_object_put(reqj);
-                continue;
+                return fail("tool not found: " + aid);
             }
 
             // Check idempotency key
@@ -302,77 +511,137 @@ int main(int argc, char** argv) {
                 json_object* out = json_object_new_object();
                 json_object_object_add(out, "ok", json_object_new_boolean(1));
                 json_object_object_add(out, "status", json_object_new_string(cached.status.c_str()));
-                json_object_object_add(out, "output_json", json_object_new_string_len(cached.output_json.c_str(), (int)cached.output_json.size()));
+                attach_output_json(out, cached.output_json);
                 json_object_object_add(out, "error", json_object_new_string_len(cached.error.c_str(), (int)cached.error.size()));
                 json_object_object_add(out, "idempotent_hit", json_object_new_boolean(1));
                 json_object_object_add(out, "ds_state", json_object_new_object()); // empty delta
-
-                std::cout << json_object_to_json_string_ext(out, JSON_C_TO_STRING_PLAIN) << "\n";
-                std::cout.flush();
-
-                json_object_put(out);
-                json_object_put(reqj);
-                continue;
+                return finish(out);
             }
 
             // Lease verification gate (opt-in via MACHINA_LEASE_ENFORCE=1)
             if (enforce_leases) {
                 const auto& td = it->second.desc;
                 auto tier = classify_tool_tier(aid, td.side_effects);
-                if (lease_mgr.requires_lease(aid, td.side_effects)) {
+                bool needs_lease;
+                {
+                    std::lock_guard<std::mutex> lk(state_mu);
+                    needs_lease = lease_mgr.requires_lease(aid, td.side_effects);
+                }
+                if (needs_lease) {
                     std::string lease_token;
                     json_object* lt = nullptr;
                     if (json_object_object_get_ex(reqj, "_lease_token", &lt) && json_object_is_type(lt, json_type_string)) {
                         lease_token = json_object_get_string(lt);
                     }
                     if (lease_token.empty()) {
-                        std::cout << "{\"ok\":false,\"error\":\"lease_required\",\"tier\":" << (int)tier << ",\"aid\":" << json_quote(aid) << "}\n";
-                        std::cout.flush();
-                        json_object_put(reqj);
-                        continue;
+                        json_object* out = json_object_new_object();
+                        json_object_object_add(out, "ok", json_object_new_boolean(0));
+                        json_object_object_add(out, "error", json_object_new_string("lease_required"));
+                        json_object_object_add(out, "tier", json_object_new_int((int)tier));
+                        json_object_object_add(out, "aid", json_object_new_string(aid.c_str()));
+                        return finish(out);
                     }
                     std::string reason;
-                    if (!lease_mgr.verify_and_consume(lease_token, aid, &reason)) {
-                        std::cout << "{\"ok\":false,\"error\":\"lease_rejected\",\"reason\":" << json_quote(reason) << "}\n";
-                        std::cout.flush();
-                        json_object_put(reqj);
-                        continue;
+                    bool lease_ok;
+                    {
+                        std::lock_guard<std::mutex> lk(state_mu);
+                        lease_ok = lease_mgr.verify_and_consume(lease_token, aid, &reason);
+                    }
+                    if (!lease_ok) {
+                        json_object* out = json_object_new_object();
+                        json_object_object_add(out, "ok", json_object_new_boolean(0));
+                        json_object_object_add(out, "error", json_object_new_string("lease_rejected"));
+                        json_object_object_add(out, "reason", json_object_new_string(reason.c_str()));
+                        return finish(out);
                     }
                 }
             }
 
             std::string input_json = "{}";
-
             json_object* v = nullptr;
             if (json_object_object_get_ex(reqj, "input_json", &v) && json_object_is_type(v, json_type_string)) {
                 input_json = json_object_get_string(v);
             }
-            // Apply incoming state (handles both delta and full replacement transparently)
-            if (json_object_object_get_ex(reqj, "ds_state", &v)) {
-                (void)dsstate_apply_delta(v, &session_ds);
-            }
 
-            DSState pre_call = session_ds; // snapshot for delta computation
-            ToolResult r = it->second.fn(input_json, session_ds);
+            DSState pre_call;
+            {
+                std::lock_guard<std::mutex> lk(state_mu);
+                // Apply incoming state (handles both delta and full replacement transparently)
+                if (json_object_object_get_ex(reqj, "ds_state", &v)) {
+                    (void)dsstate_apply_delta(v, &session_ds);
+                }
+                pre_call = session_ds; // snapshot for delta computation
+            }
 
-            // Store in idempotency cache
-            idemp_store(idemp_key, r);
+            // Run the tool on a private copy so concurrent requests never
+            // race on the session state.
+            DSState local = pre_call;
+            ToolMetricsEntry* metrics = tool_metrics_entry(aid);
+            auto call_t0 = std::chrono::steady_clock::now();
+            ToolResult r = it->second.fn(input_json, local);
+            if (metrics) {
+                int64_t call_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - call_t0).count();
+                tool_metrics_record(metrics, call_us, r.status != StepStatus::OK,
+                                    r.error.find("timed out") != std::string::npos);
+            }
 
+            // Emit only changed slots (delta serialization); the same delta
+            // is merged back into the shared session state.
+            json_object* dsj = dsstate_to_json_delta(local, &pre_call);
+            {
+                std::lock_guard<std::mutex> lk(state_mu);
+                (void)dsstate_apply_delta(dsj, &session_ds);
+            }
             json_object* out = json_object_new_object();
             json_object_object_add(out, "ok", json_object_new_boolean(1));
             json_object_object_add(out, "status", json_object_new_string(stepstatus_to_str(r.status)));
-            json_object_object_add(out, "output_json", json_object_new_string_len(r.output_json.c_str(), (int)r.output_json.size()));
+            attach_output_json(out, r.output_json);
             json_object_object_add(out, "error", json_object_new_string_len(r.error.c_str(), (int)r.error.size()));
-
-            // Emit only changed slots (delta serialization)
-            json_object* dsj = dsstate_to_json_delta(session_ds, &pre_call);
             json_object_object_add(out, "ds_state", dsj);
+            idemp_store(idemp_key, std::move(r));
+            return finish(out);
+        };
+
+        int serve_threads = 4;
+        if (const char* e = std::getenv("MACHINA_TOOLHOST_SERVE_THREADS")) serve_threads = std::atoi(e);
+        if (serve_threads < 1) serve_threads = 1;
+        if (serve_threads > 32) serve_threads = 32;
+        ThreadPool pool((size_t)serve_threads);
+        std::atomic<size_t> pending{0};
+        std::mutex done_mu;
+        std::condition_variable done_cv;
 
-            std::cout << json_object_to_json_string_ext(out, JSON_C_TO_STRING_PLAIN) << "\n";
-            std::cout.flush();
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (line.empty()) break; // graceful shutdown
+
+            json_object* reqj = json_tokener_parse(line.c_str());
+            if (!reqj) {
+                write_line("{\"ok\":false,\"error\":\"invalid JSON\"}");
+                continue;
+            }
 
-            json_object_put(out);
-            json_object_put(reqj);
+            json_object* idv = nullptr;
+            if (!json_object_object_get_ex(reqj, "id", &idv)) {
+                // untagged clients rely on in-order replies
+                write_line(handle_request(reqj));
+                continue;
+            }
+            pending.fetch_add(1, std::memory_order_relaxed);
+            pool.submit([&, reqj]() {
+                write_line(handle_request(reqj));
+                if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lk(done_mu);
+                    done_cv.notify_all();
+                }
+            });
+        }
+
+        // drain in-flight pipelined requests before exiting
+        {
+            std::unique_lock<std::mutex> lk(done_mu);
+            done_cv.wait(lk, [&] { return pending.load(std::memory_order_acquire) == 0; });
         }
         return 0;
     }
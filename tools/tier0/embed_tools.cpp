@@ -1,9 +1,12 @@
 #include "machina/tools.h"
 
 #include "machina/embedding_provider.h"
+#include "machina/hash.h"
 #include "machina/json_mini.h"
 
 #include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iomanip>
 #include <sstream>
 
@@ -50,4 +53,112 @@ ToolResult tool_embed_text(const std::string& input_json, DSState& /*ds_tmp*/) {
     }
 }
 
+// Embedding batch artifact: "MBEB" magic, u32 version, u32 dim, u32 count,
+// then count*dim f32s row-major, in input order. Failed texts (provider
+// error) are written as zero vectors and counted in the "errors" output so
+// downstream consumers keep row i aligned with text i. Binary keeps the
+// tool output small: at dim=384 the inline JSON float form is ~10x the
+// f32 payload and would dominate run-log and toolhost I/O.
+static constexpr char kBatchMagic[4] = {'M', 'B', 'E', 'B'};
+static constexpr uint32_t kBatchVersion = 1;
+
+ToolResult tool_embed_batch(const std::string& input_json, DSState& /*ds_tmp*/) {
+    namespace fs = std::filesystem;
+    try {
+        json_mini::Cursor in(input_json);
+
+        // Texts come inline or from a file of lines (goalpack scripts feed
+        // corpora that way); inline wins when both are given.
+        std::vector<std::string> texts = in.get_array_strings("texts");
+        std::string src_file = in.get_string("file").value_or("");
+        if (texts.empty() && !src_file.empty()) {
+            fs::path p = src_file;
+            if (p.is_relative()) {
+                if (const char* root = std::getenv("MACHINA_ROOT")) {
+                    fs::path cand = fs::path(root) / p;
+                    if (fs::exists(cand)) p = cand;
+                }
+            }
+            std::ifstream f(p);
+            if (!f) return {StepStatus::TOOL_ERROR, "{}", "cannot open file: " + src_file};
+            std::string line;
+            while (std::getline(f, line)) {
+                if (!line.empty()) texts.push_back(line);
+            }
+        }
+        if (texts.empty()) {
+            return {StepStatus::TOOL_ERROR, "{}", "missing texts (array) or file"};
+        }
+
+        size_t dim = (size_t)in.get_int("dim")
+            .value_or((int64_t)getenv_size_t("MACHINA_VECDB_DIM", 384));
+        bool normalize = in.get_bool("normalize").value_or(true);
+        if (dim == 0) dim = 384;
+        if (dim > 1024) dim = 1024;
+
+        // One provider round trip for the whole batch (persistent session
+        // when MACHINA_EMBED_PERSIST=1) instead of a subprocess per text.
+        auto results = embed_texts_batch(texts, dim);
+
+        // Artifact path: caller-supplied "out", else content-addressed under
+        // work/embed_batch so identical batches land on the same file.
+        std::string out_path = in.get_string("out").value_or("");
+        if (out_path.empty()) {
+            uint64_t h = 1469598103934665603ULL;
+            for (const auto& t : texts) {
+                for (unsigned char c : t) { h ^= c; h *= 1099511628211ULL; }
+                h ^= (unsigned char)'\n'; h *= 1099511628211ULL;
+            }
+            fs::path root = std::getenv("MACHINA_ROOT") ? std::getenv("MACHINA_ROOT") : ".";
+            fs::path dir = root / "work" / "embed_batch";
+            fs::create_directories(dir);
+            out_path = (dir / (hash::hex64(h) + "_d" + std::to_string(dim) + ".emb")).string();
+        }
+
+        std::string provider = results.empty() ? "" : results.front().provider;
+        size_t errors = 0;
+        std::vector<float> zero(dim, 0.0f);
+        {
+            // tmp + rename so readers never see a half-written artifact.
+            std::string tmp = out_path + ".tmp";
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) return {StepStatus::TOOL_ERROR, "{}", "cannot write artifact: " + out_path};
+            out.write(kBatchMagic, sizeof(kBatchMagic));
+            uint32_t ver = kBatchVersion, fdim = (uint32_t)dim, count = (uint32_t)results.size();
+            out.write(reinterpret_cast<const char*>(&ver), sizeof(ver));
+            out.write(reinterpret_cast<const char*>(&fdim), sizeof(fdim));
+            out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+            for (auto& r : results) {
+                if (!r.error.empty() || r.embedding.size() != dim) {
+                    errors++;
+                    out.write(reinterpret_cast<const char*>(zero.data()),
+                              (std::streamsize)(dim * sizeof(float)));
+                    continue;
+                }
+                if (normalize) l2_normalize(r.embedding);
+                out.write(reinterpret_cast<const char*>(r.embedding.data()),
+                          (std::streamsize)(dim * sizeof(float)));
+            }
+            if (!out.good()) return {StepStatus::TOOL_ERROR, "{}", "short write: " + tmp};
+            out.close();
+            fs::rename(tmp, out_path);
+        }
+
+        std::error_code ec;
+        auto bytes = (long long)fs::file_size(out_path, ec);
+        std::ostringstream out;
+        out << "{";
+        out << "\"provider\":\"" << json_mini::json_escape(provider) << "\",";
+        out << "\"dim\":" << dim << ",";
+        out << "\"count\":" << results.size() << ",";
+        out << "\"errors\":" << errors << ",";
+        out << "\"artifact\":\"" << json_mini::json_escape(out_path) << "\",";
+        out << "\"bytes\":" << (ec ? 0 : bytes);
+        out << "}";
+        return {StepStatus::OK, out.str(), ""};
+    } catch (const std::exception& e) {
+        return {StepStatus::TOOL_ERROR, "{}", e.what()};
+    }
+}
+
 } // namespace machina
@@ -1,6 +1,8 @@
 #include "machina/tools.h"
 #include "machina/json_mini.h"
+#include "machina/path_guard.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <cstdio>
 #include <filesystem>
@@ -12,6 +14,7 @@
 
 #ifndef _WIN32
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #endif
@@ -62,28 +65,94 @@ static std::string resolve_file_best_effort(const std::string& input_path) {
 }
 
 static bool is_path_under(const std::filesystem::path& p, const std::filesystem::path& root) {
-    std::error_code ec;
-    auto rp = std::filesystem::weakly_canonical(p, ec);
-    if (ec) return false;
-    auto rr = std::filesystem::weakly_canonical(root, ec);
-    if (ec) return false;
-    auto ps = rp.generic_string();
-    auto rs = rr.generic_string();
-    if (ps == rs) return true;
-    if (!rs.empty() && rs.back() != '/') rs.push_back('/');
-    return ps.rfind(rs, 0) == 0;
+    // Cached canonicalization; see machina/path_guard.h.
+    return machina::path_is_under(p, root);
 }
 
 } // namespace
 
 namespace machina {
 
+// Open a file for reading with the TOCTOU hardening shared by the read
+// tools: O_NOFOLLOW open, fstat, then /proc/self/fd re-check that the
+// opened file still lives under root. Returns the fd (caller closes) or
+// -1 with *err filled.
+static int open_read_checked(const std::string& resolved,
+                             const std::filesystem::path& root,
+                             const std::string& display,
+                             struct stat* st,
+                             std::string* err) {
+    namespace fs = std::filesystem;
+    int fd = ::open(resolved.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) { *err = "cannot open file: " + display; return -1; }
+
+    if (::fstat(fd, st) != 0 || S_ISLNK(st->st_mode)) {
+        ::close(fd);
+        *err = "fstat failed or symlink detected: " + display;
+        return -1;
+    }
+    char proc_path[64];
+    snprintf(proc_path, sizeof(proc_path), "/proc/self/fd/%d", fd);
+    char real_target[4096];
+    ssize_t len = ::readlink(proc_path, real_target, sizeof(real_target) - 1);
+    if (len > 0) {
+        real_target[len] = '\0';
+        if (!is_path_under(fs::path(real_target), root)) {
+            ::close(fd);
+            *err = "TOCTOU: file escaped sandbox after open: " + display;
+            return -1;
+        }
+    }
+    return fd;
+}
+
+// Copy [offset, offset+want) of a regular file into *out via mmap: a
+// ranged read of a large file touches only the pages inside the window
+// instead of streaming the whole prefix, and a full read is a single
+// page-table walk plus one copy with kernel readahead. pread() fallback
+// covers whatever mmap refuses (empty files, special filesystems).
+static bool read_range(int fd, const struct stat& st, size_t offset, size_t want, std::string* out) {
+    out->clear();
+    if (st.st_size <= 0 || offset >= (size_t)st.st_size || want == 0) return true;
+    want = std::min(want, (size_t)st.st_size - offset);
+
+    if (S_ISREG(st.st_mode)) {
+        const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t map_off = offset & ~(page - 1);
+        size_t lead = offset - map_off;
+        void* m = ::mmap(nullptr, lead + want, PROT_READ, MAP_PRIVATE, fd, (off_t)map_off);
+        if (m != MAP_FAILED) {
+            out->assign((const char*)m + lead, want);
+            ::munmap(m, lead + want);
+            return true;
+        }
+    }
+
+    out->resize(want);
+    size_t got = 0;
+    while (got < want) {
+        ssize_t n = ::pread(fd, out->data() + got, want - got, (off_t)(offset + got));
+        if (n < 0) { out->clear(); return false; }
+        if (n == 0) break;
+        got += (size_t)n;
+    }
+    out->resize(got);
+    return true;
+}
+
 // AID.FILE.READ.v1
 ToolResult tool_file_read(const std::string& input_json, DSState& ds_tmp) {
-    auto path_raw = json_mini::get_string(input_json, "path").value_or("");
-    size_t max_bytes = (size_t)json_mini::get_int(input_json, "max_bytes").value_or(262144);
+    json_mini::Cursor in(input_json);
+    auto path_raw = in.get_string("path").value_or("");
+    size_t max_bytes = (size_t)in.get_int("max_bytes").value_or(262144);
+    size_t offset = (size_t)std::max<int64_t>(0, in.get_int("offset").value_or(0));
     constexpr size_t MAX_BYTES_CAP = 10ULL * 1024 * 1024; // 10MB hard upper limit
     if (max_bytes > MAX_BYTES_CAP) max_bytes = MAX_BYTES_CAP;
+    // "length" requests an exact window (still capped); otherwise max_bytes
+    // caps a read from offset.
+    if (auto length = in.get_int("length"); length && *length >= 0) {
+        max_bytes = std::min((size_t)*length, MAX_BYTES_CAP);
+    }
     if (path_raw.empty()) return {StepStatus::TOOL_ERROR, "{}", "missing path"};
 
     std::string resolved = resolve_file_best_effort(path_raw);
@@ -96,39 +165,16 @@ ToolResult tool_file_read(const std::string& input_json, DSState& ds_tmp) {
         return {StepStatus::TOOL_ERROR, "{}", "read path not allowed (outside MACHINA_ROOT): " + path_raw};
     }
 
-    // TOCTOU hardening: open with O_NOFOLLOW, then fstat to verify path didn't change
-    int fd = ::open(resolved.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
-    if (fd < 0) return {StepStatus::TOOL_ERROR, "{}", "cannot open file: " + path_raw};
-
-    // Post-open verification: fstat + re-check canonical path matches
     struct stat st;
-    if (::fstat(fd, &st) != 0 || S_ISLNK(st.st_mode)) {
-        ::close(fd);
-        return {StepStatus::TOOL_ERROR, "{}", "fstat failed or symlink detected: " + path_raw};
-    }
-    // Verify the opened file is still under MACHINA_ROOT by checking /proc/self/fd
-    {
-        char proc_path[64];
-        snprintf(proc_path, sizeof(proc_path), "/proc/self/fd/%d", fd);
-        char real_target[4096];
-        ssize_t len = ::readlink(proc_path, real_target, sizeof(real_target) - 1);
-        if (len > 0) {
-            real_target[len] = '\0';
-            fs::path actual_path(real_target);
-            if (!is_path_under(actual_path, root)) {
-                ::close(fd);
-                return {StepStatus::TOOL_ERROR, "{}", "TOCTOU: file escaped sandbox after open: " + path_raw};
-            }
-        }
-    }
+    std::string err;
+    int fd = open_read_checked(resolved, root, path_raw, &st, &err);
+    if (fd < 0) return {StepStatus::TOOL_ERROR, "{}", err};
 
     std::string buf;
-    buf.resize(max_bytes);
-    ssize_t n = ::read(fd, buf.data(), max_bytes);
-    if (n < 0) { ::close(fd); return {StepStatus::TOOL_ERROR, "{}", "read error: " + path_raw}; }
-    bool truncated = ((size_t)n == max_bytes && st.st_size > (off_t)max_bytes);
-    buf.resize((size_t)n);
+    bool ok = read_range(fd, st, offset, max_bytes, &buf);
     ::close(fd);
+    if (!ok) return {StepStatus::TOOL_ERROR, "{}", "read error: " + path_raw};
+    bool truncated = (offset + buf.size() < (size_t)st.st_size);
 
     Artifact a;
     a.type = "file_read";
@@ -141,13 +187,88 @@ ToolResult tool_file_read(const std::string& input_json, DSState& ds_tmp) {
     payload << "\"path\":\"" << json_mini::json_escape(path_raw) << "\",";
     payload << "\"resolved\":\"" << json_mini::json_escape(resolved) << "\",";
     payload << "\"bytes\":" << buf.size() << ",";
+    payload << "\"offset\":" << offset << ",";
+    payload << "\"file_size\":" << (long long)st.st_size << ",";
     payload << "\"truncated\":" << (truncated ? "true" : "false") << ",";
     payload << "\"content_b64\":\"" << b64 << "\"";
     payload << "}";
 
     a.content_json = payload.str();
-    ds_tmp.slots[(uint8_t)DSSlot::DS0] = a;
-    return {StepStatus::OK, a.content_json, ""};
+    ToolResult r{StepStatus::OK, a.content_json, ""};
+    ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+    return r;
+}
+
+// AID.FILE.READ_MANY.v1
+//
+// Batched stat/read for fan-out inspection (error_scan preprocessing,
+// genesis source assembly): one call stats — and optionally reads — a
+// list of files, so N files cost N open/mmap pairs instead of N tool
+// dispatches with full ifstream setup each. A failing path fails its own
+// entry, not the batch. With "stat_only":true no content is returned.
+ToolResult tool_file_read_many(const std::string& input_json, DSState& ds_tmp) {
+    json_mini::Cursor in(input_json);
+    auto paths = in.get_array_strings("paths");
+    if (paths.empty()) return {StepStatus::TOOL_ERROR, "{}", "missing paths"};
+    const size_t max_files = 256;
+    if (paths.size() > max_files) {
+        return {StepStatus::TOOL_ERROR, "{}",
+                "too many paths (" + std::to_string(paths.size()) + " > " + std::to_string(max_files) + ")"};
+    }
+    bool stat_only = in.get_bool("stat_only").value_or(false);
+    size_t max_bytes = (size_t)in.get_int("max_bytes").value_or(65536);
+    constexpr size_t MAX_BYTES_CAP = 1ULL * 1024 * 1024; // 1MB per file in batch mode
+    if (max_bytes > MAX_BYTES_CAP) max_bytes = MAX_BYTES_CAP;
+
+    namespace fs = std::filesystem;
+    fs::path root = fs::path(std::getenv("MACHINA_ROOT") ? std::getenv("MACHINA_ROOT") : ".");
+
+    size_t ok_count = 0;
+    std::ostringstream payload;
+    payload << "{\"results\":[";
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (i) payload << ",";
+        payload << "{\"path\":\"" << json_mini::json_escape(paths[i]) << "\",";
+
+        std::string resolved = resolve_file_best_effort(paths[i]);
+        if (!is_path_under(fs::path(resolved), root)) {
+            payload << "\"ok\":false,\"error\":\"read path not allowed (outside MACHINA_ROOT)\"}";
+            continue;
+        }
+        struct stat st;
+        std::string err;
+        int fd = open_read_checked(resolved, root, paths[i], &st, &err);
+        if (fd < 0) {
+            payload << "\"ok\":false,\"error\":\"" << json_mini::json_escape(err) << "\"}";
+            continue;
+        }
+        payload << "\"ok\":true,";
+        payload << "\"file_size\":" << (long long)st.st_size << ",";
+        payload << "\"mtime\":" << (long long)st.st_mtime;
+        if (!stat_only) {
+            std::string buf;
+            if (read_range(fd, st, 0, max_bytes, &buf)) {
+                payload << ",\"bytes\":" << buf.size();
+                payload << ",\"truncated\":" << (buf.size() < (size_t)st.st_size ? "true" : "false");
+                payload << ",\"content_b64\":\"" << b64_encode(buf) << "\"";
+            } else {
+                payload << ",\"bytes\":0,\"read_error\":true";
+            }
+        }
+        payload << "}";
+        ::close(fd);
+        ok_count++;
+    }
+    payload << "],\"ok_count\":" << ok_count << ",\"count\":" << paths.size() << "}";
+
+    Artifact a;
+    a.type = "file_read_many";
+    a.provenance = "fs:read_many";
+    a.content_json = payload.str();
+    a.size_bytes = a.content_json.size();
+    ToolResult r{StepStatus::OK, a.content_json, ""};
+    ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+    return r;
 }
 
 // AID.FILE.WRITE.v1
@@ -251,9 +372,9 @@ ToolResult tool_file_write(const std::string& input_json, DSState& ds_tmp) {
     payload << "\"bytes\":" << content.size();
     payload << "}";
     a.content_json = payload.str();
-    ds_tmp.slots[(uint8_t)DSSlot::DS0] = a;
-
-    return {StepStatus::OK, a.content_json, ""};
+    ToolResult r{StepStatus::OK, a.content_json, ""};
+    ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+    return r;
 }
 
 } // namespace machina
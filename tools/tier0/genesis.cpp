@@ -4,9 +4,14 @@
 #include "machina/json_mini.h"
 #include "machina/state.h"
 #include "machina/proc.h"
+#include "machina/toolhost_client.h"
+#include "machina/plugin_loader.h"
+#include "machina/breaker.h"
 #include "machina/hash.h"
+#include "machina/path_guard.h"
 #include "machina/crypto.h"
 #include "machina/serialization.h"
+#include "machina/shm_result.h"
 
 #include <json-c/json.h>
 
@@ -63,102 +68,41 @@ static int env_int(const char* name, int def) {
 
 
 
-struct GenesisBreakerState {
-    int fail_count{0};
-    int64_t first_fail_ms{0};
-    int64_t last_fail_ms{0};
-    int64_t block_until_ms{0};
-};
+// Genesis breaker state rides the shared core breaker table (machina/breaker.h):
+// checks are a few relaxed atomic loads on a memory-mapped slot instead of a
+// JSON file read per generated-tool call, and a trip is visible to every
+// process sharing MACHINA_ROOT.
+using GenesisBreakerState = BreakerState;
 
 static int64_t now_ms() {
     using namespace std::chrono;
     return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
 }
 
-static std::filesystem::path breaker_base_dir() {
-    auto d = g_root / "toolpacks" / "runtime_genesis" / "breakers";
-    std::filesystem::create_directories(d);
-    return d;
-}
-
-static std::filesystem::path breaker_file_for(const std::string& key) {
-    auto fname = key.substr(0, 40) + std::string(".json");
-    return breaker_base_dir() / fname;
-}
-
 static bool breaker_enabled() {
     return env_true("MACHINA_GENESIS_BREAKER_ENABLE", true);
 }
 
-static GenesisBreakerState breaker_load(const std::filesystem::path& p) {
-    GenesisBreakerState st;
-    std::ifstream f(p);
-    if (!f) return st;
-    std::stringstream buf;
-    buf << f.rdbuf();
-    const std::string js = buf.str();
-    if (auto v = json_mini::get_int(js, "fail_count")) st.fail_count = (int)*v;
-    if (auto v = json_mini::get_int(js, "first_fail_ms")) st.first_fail_ms = *v;
-    if (auto v = json_mini::get_int(js, "last_fail_ms")) st.last_fail_ms = *v;
-    if (auto v = json_mini::get_int(js, "block_until_ms")) st.block_until_ms = *v;
-    return st;
-}
-
-static void breaker_store(const std::filesystem::path& p, const GenesisBreakerState& st) {
-    std::ofstream f(p, std::ios::binary | std::ios::trunc);
-    if (!f) return;
-    f << "{\"fail_count\":" << st.fail_count
-      << ",\"first_fail_ms\":" << st.first_fail_ms
-      << ",\"last_fail_ms\":" << st.last_fail_ms
-      << ",\"block_until_ms\":" << st.block_until_ms
-      << "}";
-    f.close();
-}
-
 static std::string breaker_key(const std::string& kind, const std::string& name) {
-    return hash::sha256_hex(kind + ":" + name);
+    return "genesis:" + kind + ":" + name;
 }
 
 static bool breaker_is_blocked(const std::string& kind, const std::string& name, GenesisBreakerState* out) {
     if (!breaker_enabled()) return false;
-    const std::string key = breaker_key(kind, name);
-    const auto fp = breaker_file_for(key);
-    GenesisBreakerState st = breaker_load(fp);
-    if (out) *out = st;
-    const int64_t now = now_ms();
-    return (st.block_until_ms > 0 && now < st.block_until_ms);
+    return machina::breaker_is_blocked(breaker_key(kind, name), now_ms(), out);
 }
 
 static void breaker_record_fail(const std::string& kind, const std::string& name) {
     if (!breaker_enabled()) return;
-    const std::string key = breaker_key(kind, name);
-    const auto fp = breaker_file_for(key);
-    GenesisBreakerState st = breaker_load(fp);
-
     const int threshold = std::max(1, env_int("MACHINA_GENESIS_BREAKER_THRESHOLD", 3));
     const int64_t window_ms = (int64_t)std::max(1, env_int("MACHINA_GENESIS_BREAKER_WINDOW_SEC", 300)) * 1000LL;
     const int64_t cooldown_ms = (int64_t)std::max(1, env_int("MACHINA_GENESIS_BREAKER_COOLDOWN_SEC", 600)) * 1000LL;
-
-    const int64_t now = now_ms();
-    if (st.first_fail_ms == 0 || (now - st.first_fail_ms) > window_ms) {
-        st.fail_count = 1;
-        st.first_fail_ms = now;
-    } else {
-        st.fail_count += 1;
-    }
-    st.last_fail_ms = now;
-    if (st.fail_count >= threshold) {
-        st.block_until_ms = now + cooldown_ms;
-    }
-    breaker_store(fp, st);
+    machina::breaker_record_fail(breaker_key(kind, name), now_ms(), threshold, window_ms, cooldown_ms);
 }
 
 static void breaker_record_success(const std::string& kind, const std::string& name) {
     if (!breaker_enabled()) return;
-    const std::string key = breaker_key(kind, name);
-    const auto fp = breaker_file_for(key);
-    std::error_code ec;
-    std::filesystem::remove(fp, ec);
+    machina::breaker_record_success(breaker_key(kind, name));
 }
 
 static std::filesystem::path ensure_under(const std::filesystem::path& base,
@@ -166,8 +110,13 @@ static std::filesystem::path ensure_under(const std::filesystem::path& base,
     auto p = (base / rel).lexically_normal();
 
     // Canonicalize best-effort (base should exist; p's parents should exist).
-    auto p_weak = std::filesystem::weakly_canonical(p);
-    auto base_weak = std::filesystem::weakly_canonical(base.lexically_normal());
+    // Both sides ride the path_guard caches: the base resolves once per
+    // process, the candidate reuses its parent's canonical form.
+    auto p_weak = machina::path_canon_cached(p);
+    auto base_weak = machina::path_canon_cached(base.lexically_normal());
+    if (p_weak.empty() || base_weak.empty()) {
+        throw std::runtime_error("path canonicalization failed");
+    }
 
     auto ps = p_weak.generic_string();
     auto bs = base_weak.generic_string();
@@ -203,7 +152,7 @@ static void write_artifact(DSState& ds_tmp, const std::string& type, const std::
     a.provenance = "genesis";
     a.content_json = content_json;
     a.size_bytes = content_json.size();
-    ds_tmp.slots[(uint8_t)DSSlot::DS7] = a;
+    ds_tmp.slots[(uint8_t)DSSlot::DS7] = std::move(a);
 }
 
 static void set_stage(DSState& ds_tmp, const std::string& /*stage*/, const std::string& payload_json) {
@@ -212,7 +161,7 @@ static void set_stage(DSState& ds_tmp, const std::string& /*stage*/, const std::
     a.provenance = "genesis";
     a.content_json = payload_json;
     a.size_bytes = payload_json.size();
-    ds_tmp.slots[(uint8_t)DSSlot::DS6] = a;
+    ds_tmp.slots[(uint8_t)DSSlot::DS6] = std::move(a);
 }
 
 static std::string slurp_file(const std::filesystem::path& p, size_t max_bytes = 512 * 1024) {
@@ -257,272 +206,17 @@ static ProcLimits toolhost_proc_limits() {
     return lim;
 }
 
-// ---- Persistent toolhost session for --serve NDJSON mode ----
-// Avoids forking a new process per tool invocation in OOP plugin mode.
-// Falls back to --run (fork-per-call) if the session cannot be started or dies.
-
-struct ToolHostSession {
-    std::string plugin_str;
-    pid_t pid{-1};
-    int to_child{-1};     // write end: parent -> child stdin
-    int from_child{-1};   // read end:  child stdout -> parent
-    DSState base_ds;       // delta tracking base
-    int fail_count{0};     // (no per-session mutex; pool Lease provides exclusive access)
-
-    bool start() {
-#ifdef _WIN32
-        return false;
-#else
-        shutdown(); // clean up any previous session
-
-        // Ignore SIGPIPE so write() to dead child returns EPIPE instead of killing us
-        ::signal(SIGPIPE, SIG_IGN);
-
-        int in_pipe[2], out_pipe[2];
-        if (::pipe(in_pipe) != 0) return false;
-        if (::pipe(out_pipe) != 0) { ::close(in_pipe[0]); ::close(in_pipe[1]); return false; }
-
-        pid_t child = ::fork();
-        if (child < 0) {
-            ::close(in_pipe[0]); ::close(in_pipe[1]);
-            ::close(out_pipe[0]); ::close(out_pipe[1]);
-            return false;
-        }
-
-        if (child == 0) {
-            // New process group for clean group-kill on shutdown
-            ::setpgid(0, 0);
-
-            // child: wire stdin/stdout, leave stderr for debug logging
-            ::dup2(in_pipe[0], STDIN_FILENO);
-            ::dup2(out_pipe[1], STDOUT_FILENO);
-            ::close(in_pipe[0]); ::close(in_pipe[1]);
-            ::close(out_pipe[0]); ::close(out_pipe[1]);
-
-            long maxfd = ::sysconf(_SC_OPEN_MAX);
-            if (maxfd < 256) maxfd = 256;
-            for (int fd = 3; fd < (int)maxfd; fd++) ::close(fd);
-
-            ::umask(077);
-#ifdef __linux__
-            ::prctl(PR_SET_PDEATHSIG, SIGKILL);
-#endif
-            // Apply resource limits (NOT CPU — process is long-lived)
-            ProcLimits lim = toolhost_proc_limits();
-            if (lim.rlimit_as_mb > 0) {
-                struct rlimit rl;
-                rl.rlim_cur = rl.rlim_max = (rlim_t)lim.rlimit_as_mb * 1024ULL * 1024ULL;
-                ::setrlimit(RLIMIT_AS, &rl);
-            }
-            if (lim.rlimit_fsize_mb > 0) {
-                struct rlimit rl;
-                rl.rlim_cur = rl.rlim_max = (rlim_t)lim.rlimit_fsize_mb * 1024ULL * 1024ULL;
-                ::setrlimit(RLIMIT_FSIZE, &rl);
-            }
-            if (lim.rlimit_nofile > 0) {
-                struct rlimit rl;
-                rl.rlim_cur = rl.rlim_max = (rlim_t)lim.rlimit_nofile;
-                ::setrlimit(RLIMIT_NOFILE, &rl);
-            }
-            if (lim.rlimit_nproc > 0) {
-                struct rlimit rl;
-                rl.rlim_cur = rl.rlim_max = (rlim_t)lim.rlimit_nproc;
-                ::setrlimit(RLIMIT_NPROC, &rl);
-            }
-#ifdef __linux__
-            if (lim.no_new_privs) {
-                ::prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
-            }
-#endif
-
-            std::string th = toolhost_bin();
-            ::execl(th.c_str(), th.c_str(), "--serve", plugin_str.c_str(), nullptr);
-            ::_exit(127);
-        }
-
-        // parent
-        ::close(in_pipe[0]);
-        ::close(out_pipe[1]);
-        to_child = in_pipe[1];
-        from_child = out_pipe[0];
-        pid = child;
-        ::setpgid(child, child); // mirror child's setpgid (race safety)
-
-        int flags = ::fcntl(from_child, F_GETFL, 0);
-        if (flags >= 0) ::fcntl(from_child, F_SETFL, flags | O_NONBLOCK);
-
-        fail_count = 0;
-        base_ds = DSState{};
-        return true;
-#endif
-    }
-
-    // Send NDJSON request line, read one response line. Returns empty on error.
-    std::string send_receive(const std::string& request, int timeout_ms) {
-#ifdef _WIN32
-        return "";
-#else
-        if (pid < 0 || to_child < 0 || from_child < 0) return "";
-
-        // Check child alive — if dead, clean up FDs immediately (defense-in-depth)
-        int st = 0;
-        pid_t w = ::waitpid(pid, &st, WNOHANG);
-        if (w == pid) {
-            pid = -1;
-            if (to_child >= 0) { ::close(to_child); to_child = -1; }
-            if (from_child >= 0) { ::close(from_child); from_child = -1; }
-            return "";
-        }
-
-        // Write request + newline
-        std::string line = request;
-        if (line.empty() || line.back() != '\n') line += '\n';
-        size_t off = 0;
-        while (off < line.size()) {
-            ssize_t n = ::write(to_child, line.data() + off, line.size() - off);
-            if (n > 0) { off += (size_t)n; continue; }
-            if (n == -1 && errno == EINTR) continue;
-            return ""; // write error (child likely dead)
-        }
-
-        // Read response line with timeout
-        auto t0 = std::chrono::steady_clock::now();
-        static constexpr size_t MAX_RESPONSE_BYTES = 1024 * 1024; // 1 MB hard cap
-        std::string resp;
-        while (true) {
-            char buf[8192];
-            ssize_t n = ::read(from_child, buf, sizeof(buf));
-            if (n > 0) {
-                if (resp.size() + (size_t)n > MAX_RESPONSE_BYTES) return ""; // response too large
-                resp.append(buf, (size_t)n);
-                auto nl = resp.find('\n');
-                if (nl != std::string::npos) return resp.substr(0, nl);
-                continue;
-            }
-            if (n == 0) return ""; // EOF — child closed stdout
-            if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-                auto now = std::chrono::steady_clock::now();
-                int elapsed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(now - t0).count();
-                if (timeout_ms > 0 && elapsed >= timeout_ms) return "";
-                struct pollfd pfd;
-                pfd.fd = from_child;
-                pfd.events = POLLIN;
-                pfd.revents = 0;
-                int remain = timeout_ms > 0 ? timeout_ms - elapsed : 1000;
-                ::poll(&pfd, 1, std::min(remain, 100));
-                continue;
-            }
-            return ""; // read error
-        }
-#endif
-    }
-
-    void shutdown() {
-#ifndef _WIN32
-        if (to_child >= 0) {
-            ssize_t wr = ::write(to_child, "\n", 1); // graceful shutdown signal
-            (void)wr;
-            ::close(to_child);
-            to_child = -1;
-        }
-        if (pid > 0) {
-            int st = 0;
-            ::usleep(50000); // 50ms grace
-            pid_t w = ::waitpid(pid, &st, WNOHANG);
-            if (w != pid) {
-                ::killpg(pid, SIGTERM); // kill entire process group
-                ::usleep(100000); // 100ms
-                w = ::waitpid(pid, &st, WNOHANG);
-                if (w != pid) {
-                    ::killpg(pid, SIGKILL); // force kill entire group
-                    ::waitpid(pid, &st, 0);
-                }
-            }
-            pid = -1;
-        }
-        if (from_child >= 0) {
-            ::close(from_child);
-            from_child = -1;
-        }
-#endif
-    }
-
-    ~ToolHostSession() { shutdown(); }
-
-    ToolHostSession() = default;
-    ToolHostSession(const ToolHostSession&) = delete;
-    ToolHostSession& operator=(const ToolHostSession&) = delete;
-};
-
-// ---- Session pool for concurrent OOP tool execution ----
-// Maintains N persistent toolhost sessions per plugin.
-// Lease-based: acquire() returns an exclusive Lease; released on destruction.
-struct ToolHostPool {
-    struct Lease {
-        ToolHostPool* pool{nullptr};
-        int idx{-1};
-        ToolHostSession* session{nullptr};
-
-        Lease() = default;
-        Lease(ToolHostPool* p, int i, ToolHostSession* s) : pool(p), idx(i), session(s) {}
-        ~Lease() { if (pool && idx >= 0) pool->release(idx); }
-
-        Lease(const Lease&) = delete;
-        Lease& operator=(const Lease&) = delete;
-        Lease(Lease&& o) noexcept : pool(o.pool), idx(o.idx), session(o.session) {
-            o.pool = nullptr; o.idx = -1; o.session = nullptr;
-        }
-        Lease& operator=(Lease&& o) noexcept {
-            if (this != &o) {
-                if (pool && idx >= 0) pool->release(idx);
-                pool = o.pool; idx = o.idx; session = o.session;
-                o.pool = nullptr; o.idx = -1; o.session = nullptr;
-            }
-            return *this;
-        }
-    };
-
-    int pool_size;
-    std::vector<std::unique_ptr<ToolHostSession>> sessions;
-    std::vector<bool> in_use;
-    std::mutex mu;
-    std::condition_variable cv;
-
-    explicit ToolHostPool(const std::string& plugin, int size)
-        : pool_size(std::max(size, 1)) {
-        sessions.resize(pool_size);
-        in_use.resize(pool_size, false);
-        for (int i = 0; i < pool_size; i++) {
-            sessions[i] = std::make_unique<ToolHostSession>();
-            sessions[i]->plugin_str = plugin;
-        }
-    }
-
-    // Block until a session is available, then return exclusive lease.
-    Lease acquire() {
-        std::unique_lock<std::mutex> lk(mu);
-        while (true) {
-            for (int i = 0; i < pool_size; i++) {
-                if (!in_use[i]) {
-                    in_use[i] = true;
-                    return Lease{this, i, sessions[i].get()};
-                }
-            }
-            cv.wait(lk);
-        }
-    }
-
-    void release(int idx) {
-        {
-            std::lock_guard<std::mutex> lk(mu);
-            in_use[idx] = false;
-        }
-        cv.notify_one();
-    }
-
-    ToolHostPool(const ToolHostPool&) = delete;
-    ToolHostPool& operator=(const ToolHostPool&) = delete;
-};
+// Persistent toolhost sessions/pools live in core now
+// (machina/toolhost_client.h); genesis builds the config from its env knobs
+// and borrows the pool from the PluginManager when one is wired in.
+static ToolHostConfig toolhost_config(const std::string& plugin) {
+    ToolHostConfig cfg;
+    cfg.toolhost_bin = toolhost_bin();
+    cfg.plugin = plugin;
+    cfg.limits = toolhost_proc_limits();
+    cfg.pool_size = env_int("MACHINA_TOOLHOST_POOL_SIZE", 2);
+    return cfg;
+}
 
 static bool toolhost_list(const std::filesystem::path& toolhost, const std::filesystem::path& plugin_path, std::vector<ToolDesc>* out_tools, std::string* out_err) {
     if (!out_tools) return false;
@@ -1005,6 +699,27 @@ ToolResult tool_genesis_compile_shared(const std::string& input_json, DSState& d
     }
 }
 
+// Large toolhost outputs arrive via the shared-memory lane instead of the
+// NDJSON line: an output_shm descriptor names a tmpfs segment which is
+// read back, verified, and unlinked here. Returns false (with *err) when
+// the descriptor is present but the segment cannot be absorbed.
+static bool absorb_shm_output(json_object* out, std::string* output_json, std::string* err) {
+    json_object* shmv = nullptr;
+    if (!json_object_object_get_ex(out, "output_shm", &shmv)) return true;
+    std::string path, fnv_hex;
+    (void)json_get_string(shmv, "path", &path);
+    (void)json_get_string(shmv, "fnv", &fnv_hex);
+    int64_t len = 0;
+    json_object* lv = nullptr;
+    if (json_object_object_get_ex(shmv, "len", &lv)) len = json_object_get_int64(lv);
+    uint64_t fnv = std::strtoull(fnv_hex.c_str(), nullptr, 16);
+    if (path.empty() || len < 0) {
+        if (err) *err = "toolhost: malformed output_shm descriptor";
+        return false;
+    }
+    return shm_result_read(path, (size_t)len, fnv, output_json, err);
+}
+
 ToolResult tool_genesis_load_plugin(const std::string& input_json, DSState& ds_tmp) {
     try {
         if (!tool_allowed()) {
@@ -1062,12 +777,19 @@ ToolResult tool_genesis_load_plugin(const std::string& input_json, DSState& ds_t
             }
         }
 
-        // In-proc mode: also register hash with PluginManager for future loads
+        // In-proc mode: also register hash with PluginManager for future loads.
+        // Large binaries get the chunked tree format so load-time verification
+        // recomputes the digest in parallel instead of one serial pass.
         if (g_pm) {
+            std::string reg_hash = sha;
+            if (bin.size() > (4u << 20)) {
+                reg_hash = machina::sha256_tree_hex(
+                    reinterpret_cast<const uint8_t*>(bin.data()), bin.size());
+            }
             try {
-                g_pm->set_expected_hash(std::filesystem::weakly_canonical(p).string(), sha);
+                g_pm->set_expected_hash(std::filesystem::weakly_canonical(p).string(), reg_hash);
             } catch (...) {
-                g_pm->set_expected_hash(p.string(), sha);
+                g_pm->set_expected_hash(p.string(), reg_hash);
             }
         }
 
@@ -1084,10 +806,12 @@ ToolResult tool_genesis_load_plugin(const std::string& input_json, DSState& ds_t
                 return {StepStatus::TOOL_ERROR, "{}", terr};
             }
 
-            // Create persistent toolhost session pool.
-            // Uses --serve NDJSON mode. Pool size: MACHINA_TOOLHOST_POOL_SIZE (default 2).
-            int pool_sz = env_int("MACHINA_TOOLHOST_POOL_SIZE", 2);
-            auto pool = std::make_shared<ToolHostPool>(p.string(), pool_sz);
+            // Persistent toolhost session pool (--serve NDJSON mode). The
+            // PluginManager owns pools per plugin so reloads reuse the live
+            // serve children; without a manager the pool is per-load.
+            ToolHostConfig th_cfg = toolhost_config(p.string());
+            std::shared_ptr<ToolHostPool> pool =
+                g_pm ? g_pm->serve_pool(th_cfg) : std::make_shared<ToolHostPool>(th_cfg);
 
             for (const auto& desc : tool_list) {
                 g_core_reg->registerToolDesc(desc, g_allow_override);
@@ -1110,17 +834,22 @@ ToolResult tool_genesis_load_plugin(const std::string& input_json, DSState& ds_t
                         if (!resp.empty()) {
                             json_object* out = json_tokener_parse(resp.c_str());
                             if (out) {
-                                std::string status_s, output_json, error;
+                                std::string status_s, output_json, error, shm_err;
                                 (void)json_get_string(out, "status", &status_s);
                                 (void)json_get_string(out, "output_json", &output_json);
                                 (void)json_get_string(out, "error", &error);
+                                bool shm_ok = absorb_shm_output(out, &output_json, &shm_err);
                                 json_object* dsv = nullptr;
                                 if (json_object_object_get_ex(out, "ds_state", &dsv)) {
                                     (void)dsstate_apply_delta(dsv, &ds);
                                 }
                                 session->base_ds = ds; // update base for next delta
                                 json_object_put(out);
-                                return {stepstatus_from_str(status_s), output_json.empty() ? "{}" : output_json, error};
+                                if (!shm_ok) {
+                                    return {StepStatus::TOOL_ERROR, "{}", std::move(shm_err)};
+                                }
+                                if (output_json.empty()) output_json = "{}";
+                                return {stepstatus_from_str(status_s), std::move(output_json), std::move(error)};
                             }
                         }
                         // Session failed — shutdown and increment fail counter
@@ -1138,7 +867,7 @@ ToolResult tool_genesis_load_plugin(const std::string& input_json, DSState& ds_t
 
                     ProcResult pr;
                     ProcLimits lim = toolhost_proc_limits();
-                    std::vector<std::string> argv = {toolhost_bin(), "--run", session->plugin_str, aid};
+                    std::vector<std::string> argv = {toolhost_bin(), "--run", session->cfg.plugin, aid};
                     if (!proc_run_capture_sandboxed_stdin(argv, "", stdin_data, lim, &pr)) {
                         return {StepStatus::TOOL_ERROR, "{}", pr.error.empty() ? "toolhost: proc failed" : pr.error};
                     }
@@ -1149,10 +878,11 @@ ToolResult tool_genesis_load_plugin(const std::string& input_json, DSState& ds_t
                     if (!out) {
                         return {StepStatus::TOOL_ERROR, "{}", "toolhost: invalid JSON output"};
                     }
-                    std::string status_s, output_json, error;
+                    std::string status_s, output_json, error, shm_err;
                     (void)json_get_string(out, "status", &status_s);
                     (void)json_get_string(out, "output_json", &output_json);
                     (void)json_get_string(out, "error", &error);
+                    bool shm_ok = absorb_shm_output(out, &output_json, &shm_err);
                     json_object* dsv = nullptr;
                     if (json_object_object_get_ex(out, "ds_state", &dsv)) {
                         DSState parsed;
@@ -1160,7 +890,11 @@ ToolResult tool_genesis_load_plugin(const std::string& input_json, DSState& ds_t
                         ds = std::move(parsed);
                     }
                     json_object_put(out);
-                    return {stepstatus_from_str(status_s), output_json.empty() ? "{}" : output_json, error};
+                    if (!shm_ok) {
+                        return {StepStatus::TOOL_ERROR, "{}", std::move(shm_err)};
+                    }
+                    if (output_json.empty()) output_json = "{}";
+                    return {stepstatus_from_str(status_s), std::move(output_json), std::move(error)};
                 });
             }
 
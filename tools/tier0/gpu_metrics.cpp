@@ -1,7 +1,10 @@
 #include "machina/tools.h"
 #include "machina/gpu_context.h"
+#include "machina/gpu_sampler.h"
 #include "machina/hash.h"
 
+#include <chrono>
+#include <cstdlib>
 #include <sstream>
 #include <string>
 #include <cstdio>
@@ -51,6 +54,40 @@ ToolResult tool_gpu_metrics(const std::string&, DSState& ds_tmp) {
     a.provenance = "gpu_metrics";
     a.size_bytes = 0;
 
+    // Fast path: a fresh shared snapshot from the background sampler
+    // answers without touching NVML (or paying its dlopen/init).
+    {
+        int64_t ttl_ms = 10000;
+        if (const char* v = std::getenv("MACHINA_GPU_SNAPSHOT_TTL_MS")) {
+            try { ttl_ms = std::stoll(v); } catch (...) {}
+        }
+        const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        GpuSnapshot s;
+        if (ttl_ms > 0 && gpu_snapshot_read(&s) && gpu_snapshot_fresh(s, now, ttl_ms)) {
+            std::ostringstream payload;
+            payload << "{"
+                    << "\"backend\":" << jquote(std::string(s.backend)) << ","
+                    << "\"available\":" << (s.available ? "true" : "false") << ","
+                    << "\"device_count\":" << s.device_count << ","
+                    << "\"device_index\":" << s.device_index << ","
+                    << "\"name\":" << jquote(std::string(s.name)) << ","
+                    << "\"memory_total_mb\":" << s.memory_total_mb << ","
+                    << "\"memory_used_mb\":" << s.memory_used_mb << ","
+                    << "\"memory_free_mb\":" << s.memory_free_mb << ","
+                    << "\"temp_c\":" << s.temp_c << ","
+                    << "\"power_w\":" << (s.power_mw / 1000.0) << ","
+                    << "\"source\":\"sampler\","
+                    << "\"sample_age_ms\":" << (now - s.sample_ms)
+                    << "}";
+            a.content_json = payload.str();
+            a.size_bytes = a.content_json.size();
+            ToolResult r{StepStatus::OK, a.content_json, ""};
+            ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+            return r;
+        }
+    }
+
     GpuContext ctx = GpuContext::create();
 
 #ifdef _WIN32
@@ -62,8 +99,9 @@ ToolResult tool_gpu_metrics(const std::string&, DSState& ds_tmp) {
             << "\"device_index\":" << ctx.device_index()
             << "}";
     a.content_json = payload.str();
-    ds_tmp.slots[(uint8_t)DSSlot::DS0] = a;
-    return {StepStatus::OK, a.content_json, ""};
+    ToolResult r{StepStatus::OK, a.content_json, ""};
+    ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+    return r;
 #else
     // Try dlopen NVML dynamically (so build doesn't require NVML headers/libs).
     void* h = dlopen("libnvidia-ml.so.1", RTLD_NOW | RTLD_LOCAL);
@@ -79,8 +117,9 @@ ToolResult tool_gpu_metrics(const std::string&, DSState& ds_tmp) {
                 << "\"note\":\"dlopen(libnvidia-ml) failed\""
                 << "}";
         a.content_json = payload.str();
-        ds_tmp.slots[(uint8_t)DSSlot::DS0] = a;
-        return {StepStatus::OK, a.content_json, ""};
+        ToolResult r{StepStatus::OK, a.content_json, ""};
+        ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+        return r;
     }
 
     // Minimal NVML ABI surface
@@ -127,8 +166,9 @@ ToolResult tool_gpu_metrics(const std::string&, DSState& ds_tmp) {
                 << "\"note\":\"missing NVML symbols\""
                 << "}";
         a.content_json = payload.str();
-        ds_tmp.slots[(uint8_t)DSSlot::DS0] = a;
-        return {StepStatus::OK, a.content_json, ""};
+        ToolResult r{StepStatus::OK, a.content_json, ""};
+        ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+        return r;
     }
 
     nvmlReturn_t rc = nvmlInit_v2();
@@ -143,8 +183,9 @@ ToolResult tool_gpu_metrics(const std::string&, DSState& ds_tmp) {
                 << "\"rc\":" << rc
                 << "}";
         a.content_json = payload.str();
-        ds_tmp.slots[(uint8_t)DSSlot::DS0] = a;
-        return {StepStatus::OK, a.content_json, ""};
+        ToolResult r{StepStatus::OK, a.content_json, ""};
+        ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+        return r;
     }
 
     unsigned int count = 0;
@@ -189,8 +230,9 @@ ToolResult tool_gpu_metrics(const std::string&, DSState& ds_tmp) {
 
     a.content_json = payload.str();
     a.size_bytes = a.content_json.size();
-    ds_tmp.slots[(uint8_t)DSSlot::DS0] = a;
-    return {StepStatus::OK, a.content_json, ""};
+    ToolResult r{StepStatus::OK, a.content_json, ""};
+    ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+    return r;
 #endif
 }
 
@@ -84,8 +84,9 @@ ToolResult tool_gpu_smoke(const std::string&, DSState& ds_tmp) {
 
             a.content_json = payload.str();
             a.size_bytes = a.content_json.size();
-            ds_tmp.slots[(uint8_t)DSSlot::DS0] = a;
-            return {StepStatus::OK, a.content_json, ""};
+            ToolResult r{StepStatus::OK, a.content_json, ""};
+            ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+            return r;
         }
 
         dlclose(h);
@@ -104,8 +105,9 @@ ToolResult tool_gpu_smoke(const std::string&, DSState& ds_tmp) {
     payload << "}";
 
     a.content_json = payload.str();
-    ds_tmp.slots[(uint8_t)DSSlot::DS0] = a;
-    return {StepStatus::OK, a.content_json, ""};
+    ToolResult r{StepStatus::OK, a.content_json, ""};
+    ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+    return r;
 }
 
 } // namespace machina
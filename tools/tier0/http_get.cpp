@@ -1,9 +1,14 @@
 #include "machina/tools.h"
+#include "machina/crypto.h"
 #include "machina/json_mini.h"
 #include "machina/proc.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -12,6 +17,7 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <sys/socket.h>
+#include <unistd.h>
 #endif
 
 namespace {
@@ -207,14 +213,129 @@ static SsrfResult ssrf_check_host(const std::string& host) {
 
 namespace machina {
 
+#ifndef _WIN32
+// Streaming fetch for tool_http_get's "stream":true mode. The body never
+// lives in memory: curl's stdout is streamed chunk-by-chunk into a temp
+// file while a Sha256Ctx absorbs the same bytes, then the file is
+// published content-addressed as work/http_fetch/<sha256>.bin (tmp +
+// rename, same publish discipline as the cache blobs). The tool output
+// carries path + digest + size instead of a JSON-escaped body, so a 50MB
+// fetch costs one sequential write rather than buffer + escape + copy.
+static ToolResult http_get_stream(const std::string& url,
+                                  const std::string& host,
+                                  const std::string& resolved_ip,
+                                  DSState& ds_tmp) {
+    namespace fs = std::filesystem;
+
+    fs::path root = fs::path(std::getenv("MACHINA_ROOT") ? std::getenv("MACHINA_ROOT") : ".");
+    fs::path dir = root / "work" / "http_fetch";
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) return {StepStatus::TOOL_ERROR, "{}", "cannot create " + dir.string()};
+
+    static std::atomic<uint64_t> fetch_seq{0};
+    fs::path tmp = dir / (std::to_string((long)getpid()) + "_" +
+                          std::to_string(fetch_seq.fetch_add(1)) + ".tmp");
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out) return {StepStatus::TOOL_ERROR, "{}", "cannot open " + tmp.string()};
+
+    ProcLimits lim;
+    lim.timeout_ms = getenv_int("MACHINA_HTTP_STREAM_TIMEOUT_MS", 30000);
+    lim.rlimit_cpu_sec = getenv_int("MACHINA_HTTP_RLIMIT_CPU_SEC", 2) + 28;
+    lim.rlimit_as_mb = getenv_size_t("MACHINA_HTTP_RLIMIT_AS_MB", 512);
+    lim.rlimit_fsize_mb = getenv_size_t("MACHINA_HTTP_RLIMIT_FSIZE_MB", 1);
+    lim.rlimit_nofile = getenv_int("MACHINA_HTTP_RLIMIT_NOFILE", 32);
+    lim.rlimit_nproc = getenv_int("MACHINA_HTTP_RLIMIT_NPROC", 16);
+
+    // -s without -S: the stream variant merges stderr into the stdout
+    // callback, so curl must not write diagnostics there. Failure surfaces
+    // through the exit code.
+    std::vector<std::string> argv = {
+        "curl",
+        "-s",
+        "--max-time", std::to_string(std::max(1, lim.timeout_ms / 1000)),
+        "--max-redirs", "0",
+    };
+    if (!resolved_ip.empty()) {
+        argv.push_back("--resolve");
+        argv.push_back(host + ":" + extract_port(url) + ":" + resolved_ip);
+    }
+    argv.push_back("--");
+    argv.push_back(url);
+
+    const size_t max_bytes = getenv_size_t("MACHINA_HTTP_STREAM_MAX_MB", 256) * 1024 * 1024;
+    Sha256Ctx sha;
+    size_t written = 0;
+    bool truncated = false;
+    bool write_err = false;
+
+    ProcResult pr;
+    bool started = proc_run_stream_sandboxed(
+        argv, ".",
+        [](std::string*) { return false; }, // no stdin
+        [&](const char* data, size_t n) {
+            if (truncated || write_err) return;
+            size_t take = std::min(n, max_bytes - written);
+            if (take) {
+                out.write(data, (std::streamsize)take);
+                if (!out) { write_err = true; return; }
+                sha.update(reinterpret_cast<const uint8_t*>(data), take);
+                written += take;
+            }
+            if (take < n) truncated = true;
+        },
+        lim, &pr);
+    out.close();
+
+    if (!started || pr.timed_out || pr.exit_code != 0 || write_err) {
+        fs::remove(tmp, ec);
+        std::string why = !started ? pr.error
+                        : pr.timed_out ? "timed out"
+                        : write_err ? "write failed: " + tmp.string()
+                        : "curl exit " + std::to_string(pr.exit_code);
+        return {StepStatus::TOOL_ERROR, "{}", "http_get stream failed: " + why};
+    }
+
+    std::string digest = sha.final_hex();
+    fs::path final_path = dir / (digest + ".bin");
+    fs::rename(tmp, final_path, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        return {StepStatus::TOOL_ERROR, "{}", "cannot publish " + final_path.string()};
+    }
+
+    std::ostringstream payload;
+    payload << "{";
+    payload << "\"ok\":true,";
+    payload << "\"truncated\":" << (truncated ? "true" : "false") << ",";
+    payload << "\"host\":\"" << json_mini::json_escape(host) << "\",";
+    payload << "\"url\":\"" << json_mini::json_escape(url) << "\",";
+    payload << "\"path\":\"" << json_mini::json_escape(final_path.string()) << "\",";
+    payload << "\"sha256\":\"" << digest << "\",";
+    payload << "\"size_bytes\":" << written;
+    payload << "}";
+
+    Artifact a;
+    a.type = "http_get";
+    a.provenance = "http:get:stream";
+    a.content_json = payload.str();
+    a.size_bytes = written;
+    ToolResult r{StepStatus::OK, a.content_json, ""};
+    ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+    return r;
+}
+#endif
+
 // Tool: AID.NET.HTTP_GET.v1
 ToolResult tool_http_get(const std::string& input_json, DSState& ds_tmp) {
 #ifdef _WIN32
     (void)input_json; (void)ds_tmp;
     return {StepStatus::TOOL_ERROR, "{}", "http_get not supported on Windows in this build"};
 #else
-    auto url = json_mini::get_string(input_json, "url").value_or("");
+    json_mini::Cursor in(input_json);
+    auto url = in.get_string("url").value_or("");
     if (url.empty()) return {StepStatus::TOOL_ERROR, "{}", "missing url"};
+    const bool stream = in.get_bool("stream").value_or(false);
 
     // Scheme allowlist
     if (!(url.rfind("http://", 0) == 0 || url.rfind("https://", 0) == 0)) {
@@ -232,6 +353,10 @@ ToolResult tool_http_get(const std::string& input_json, DSState& ds_tmp) {
         return {StepStatus::TOOL_ERROR, "{}", "SSRF blocked: " + ssrf.error};
     }
 
+    // "stream":true — body goes to a content-addressed file under work/
+    // instead of an in-memory, JSON-escaped string.
+    if (stream) return http_get_stream(url, host, ssrf.resolved_ip, ds_tmp);
+
     ProcLimits lim;
     lim.timeout_ms = getenv_int("MACHINA_HTTP_TIMEOUT_MS", 3000);
     lim.stdout_max_bytes = getenv_size_t("MACHINA_HTTP_STDOUT_MAX", 128 * 1024);
@@ -277,9 +402,197 @@ ToolResult tool_http_get(const std::string& input_json, DSState& ds_tmp) {
     payload << "}";
 
     a.content_json = payload.str();
-    ds_tmp.slots[(uint8_t)DSSlot::DS0] = a;
+    ToolResult r{StepStatus::OK, a.content_json, ""};
+    ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+    return r;
+#endif
+}
+
+// Tool: AID.NET.HTTP_GET_MANY.v1
+//
+// Batch fetch. URLs are grouped by host:port and each group is handed to
+// one curl child with all of the group's URLs on its command line, so
+// same-host requests ride a single keep-alive connection instead of paying
+// a TCP (and TLS) handshake each. Host groups run concurrently through the
+// async proc reactor, so the batch's wall time is roughly the slowest
+// host, not the sum. Bodies land in per-URL temp files under
+// MACHINA_ROOT/work (curl -o), which keeps the child's stdout tiny and
+// gives us per-URL success signals via the files themselves.
+//
+// A cross-call connection pool is deliberately NOT attempted: every fetch
+// runs in a fresh sandboxed curl child, and keeping sockets alive across
+// calls would mean holding them in the trusted parent. Batching is where
+// the reuse win actually is for the crawling goalpacks.
+ToolResult tool_http_get_many(const std::string& input_json, DSState& ds_tmp) {
+#ifdef _WIN32
+    (void)input_json; (void)ds_tmp;
+    return {StepStatus::TOOL_ERROR, "{}", "http_get_many not supported on Windows in this build"};
+#else
+    namespace fs = std::filesystem;
+
+    auto urls = json_mini::get_array_strings(input_json, "urls");
+    if (urls.empty()) return {StepStatus::TOOL_ERROR, "{}", "missing urls"};
+    const size_t max_urls = getenv_size_t("MACHINA_HTTP_MANY_MAX", 64);
+    if (urls.size() > max_urls) {
+        return {StepStatus::TOOL_ERROR, "{}",
+                "too many urls (" + std::to_string(urls.size()) + " > " + std::to_string(max_urls) + ")"};
+    }
+
+    struct Entry {
+        std::string url;
+        std::string host;
+        bool ok{false};
+        bool truncated{false};
+        std::string error;
+        std::string body;
+        fs::path body_file;
+    };
+    std::vector<Entry> entries(urls.size());
+
+    // Validate every URL up front; a bad URL fails its own entry, not the
+    // batch. Valid entries are grouped by host:port for connection reuse.
+    struct HostGroup {
+        std::string host;
+        std::string port;
+        std::string resolved_ip;
+        std::vector<size_t> idx; // indices into entries
+    };
+    std::map<std::string, HostGroup> groups;
+
+    for (size_t i = 0; i < urls.size(); i++) {
+        Entry& e = entries[i];
+        e.url = urls[i];
+        if (!(e.url.rfind("http://", 0) == 0 || e.url.rfind("https://", 0) == 0)) {
+            e.error = "only http/https allowed";
+            continue;
+        }
+        e.host = extract_host(e.url);
+        if (e.host.empty()) { e.error = "cannot parse host"; continue; }
+        if (!host_allowed(e.host)) { e.error = "host not allowed: " + e.host; continue; }
+
+        std::string port = extract_port(e.url);
+        std::string key = lower_ascii(e.host) + ":" + port;
+        auto it = groups.find(key);
+        if (it == groups.end()) {
+            auto ssrf = ssrf_check_host(e.host);
+            if (!ssrf.error.empty()) { e.error = "SSRF blocked: " + ssrf.error; continue; }
+            HostGroup g;
+            g.host = e.host;
+            g.port = port;
+            g.resolved_ip = ssrf.resolved_ip;
+            it = groups.emplace(key, std::move(g)).first;
+        }
+        it->second.idx.push_back(i);
+    }
 
-    return {StepStatus::OK, a.content_json, ""};
+    // Scratch dir for bodies; removed before returning.
+    fs::path root = fs::path(std::getenv("MACHINA_ROOT") ? std::getenv("MACHINA_ROOT") : ".");
+    static std::atomic<uint64_t> batch_seq{0};
+    fs::path scratch = root / "work" / "http_many" /
+        (std::to_string((long)getpid()) + "_" + std::to_string(batch_seq.fetch_add(1)));
+    std::error_code ec;
+    fs::create_directories(scratch, ec);
+    if (ec) return {StepStatus::TOOL_ERROR, "{}", "cannot create scratch dir: " + scratch.string()};
+
+    const size_t body_max = getenv_size_t("MACHINA_HTTP_STDOUT_MAX", 128 * 1024);
+    const int per_url_sec = 2;
+
+    // One async curl per host group. The reactor multiplexes their pipes
+    // and timeouts on a single thread, so this does not spawn N waiters.
+    struct Pending {
+        ProcAsyncHandle h{0};
+        const HostGroup* group{nullptr};
+    };
+    std::vector<Pending> pending;
+    for (auto& [key, g] : groups) {
+        (void)key;
+        ProcLimits lim;
+        lim.timeout_ms = getenv_int("MACHINA_HTTP_TIMEOUT_MS", 3000) +
+                         (int)(g.idx.size() - 1) * per_url_sec * 1000;
+        lim.stdout_max_bytes = 16 * 1024; // bodies go to files; stdout is errors only
+        lim.rlimit_cpu_sec = getenv_int("MACHINA_HTTP_RLIMIT_CPU_SEC", 2) + (int)g.idx.size();
+        lim.rlimit_as_mb = getenv_size_t("MACHINA_HTTP_RLIMIT_AS_MB", 512);
+        lim.rlimit_fsize_mb = getenv_size_t("MACHINA_HTTP_RLIMIT_FSIZE_MB", 1);
+        lim.rlimit_nofile = getenv_int("MACHINA_HTTP_RLIMIT_NOFILE", 32);
+        lim.rlimit_nproc = getenv_int("MACHINA_HTTP_RLIMIT_NPROC", 16);
+
+        std::vector<std::string> argv = {
+            "curl",
+            "-sS",
+            "--max-time", std::to_string(per_url_sec * (int)g.idx.size()),
+            "--max-redirs", "0",
+        };
+        if (!g.resolved_ip.empty()) {
+            argv.push_back("--resolve");
+            argv.push_back(g.host + ":" + g.port + ":" + g.resolved_ip);
+        }
+        for (size_t i : g.idx) {
+            entries[i].body_file = scratch / ("u" + std::to_string(i) + ".body");
+            argv.push_back(entries[i].url);
+            argv.push_back("-o");
+            argv.push_back(entries[i].body_file.string());
+        }
+
+        std::string err;
+        ProcAsyncHandle h = proc_spawn_async(argv, ".", lim, std::string(), &err);
+        if (h == 0) {
+            for (size_t i : g.idx) entries[i].error = "curl spawn failed: " + err;
+            continue;
+        }
+        pending.push_back({h, &g});
+    }
+
+    for (auto& p : pending) {
+        ProcResult pr;
+        if (!proc_async_wait(p.h, &pr)) continue;
+        for (size_t i : p.group->idx) {
+            Entry& e = entries[i];
+            if (pr.timed_out) { e.error = "timed out"; continue; }
+            std::ifstream f(e.body_file, std::ios::binary);
+            if (!f) {
+                e.error = pr.exit_code != 0
+                    ? "curl exit " + std::to_string(pr.exit_code) + ": " + trim_ws(pr.output)
+                    : "no body";
+                continue;
+            }
+            char buf[64 * 1024];
+            while (f && e.body.size() < body_max) {
+                f.read(buf, sizeof(buf));
+                size_t got = (size_t)f.gcount();
+                size_t take = std::min(got, body_max - e.body.size());
+                e.body.append(buf, take);
+                if (take < got) { e.truncated = true; break; }
+            }
+            if (!e.truncated && f.peek() != std::ifstream::traits_type::eof()) e.truncated = true;
+            e.ok = true;
+        }
+    }
+    fs::remove_all(scratch, ec);
+
+    size_t ok_count = 0;
+    std::ostringstream payload;
+    payload << "{\"results\":[";
+    for (size_t i = 0; i < entries.size(); i++) {
+        const Entry& e = entries[i];
+        if (e.ok) ok_count++;
+        if (i) payload << ",";
+        payload << "{\"url\":\"" << json_mini::json_escape(e.url) << "\",";
+        payload << "\"ok\":" << (e.ok ? "true" : "false") << ",";
+        payload << "\"truncated\":" << (e.truncated ? "true" : "false") << ",";
+        if (!e.error.empty()) payload << "\"error\":\"" << json_mini::json_escape(e.error) << "\",";
+        payload << "\"body\":\"" << json_mini::json_escape(e.body) << "\"}";
+    }
+    payload << "],\"ok\":" << (ok_count == entries.size() ? "true" : "false");
+    payload << ",\"ok_count\":" << ok_count << ",\"count\":" << entries.size() << "}";
+
+    Artifact a;
+    a.type = "http_get_many";
+    a.provenance = "http:get_many";
+    a.content_json = payload.str();
+    a.size_bytes = a.content_json.size();
+    ToolResult r{StepStatus::OK, a.content_json, ""};
+    ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+    return r;
 #endif
 }
 
@@ -2,6 +2,7 @@
 #include "machina/json_mini.h"
 #include "vectordb_tools.h"
 #include "memory_tools_base.h"
+#include "memory_index.h"
 
 #include <cstdlib>
 #include <fstream>
@@ -45,15 +46,23 @@ ToolResult tool_memory_append(const std::string& input_json, DSState& /*ds_tmp*/
     }
 
     int64_t ts = memtools::now_ms();
-    out << "{\"ts_ms\":" << ts << ",\"stream\":\"" << memtools::json_escape(stream) << "\",";
+    std::ostringstream rec;
+    rec << "{\"ts_ms\":" << ts << ",\"stream\":\"" << memtools::json_escape(stream) << "\",";
     if (!event_raw.empty()) {
-        out << "\"event\":" << event_raw;
+        rec << "\"event\":" << event_raw;
     } else {
-        out << "\"text\":\"" << memtools::json_escape(text) << "\"";
+        rec << "\"text\":\"" << memtools::json_escape(text) << "\"";
     }
-    out << "}\n";
+    rec << "}";
+    std::string line = rec.str();
+    uint64_t off = (uint64_t)out.tellp();
+    out << line << "\n";
     out.flush();
 
+    // Keep the per-stream inverted index in step so memory_query does not
+    // have to re-tokenize this line (memory_index.h).
+    memtools::mem_index_append(file, stream, off, line);
+
 #if !defined(_WIN32)
     // Optional durability: fsync the file to ensure data reaches disk.
     // Opt-in via MACHINA_WAL_FSYNC=1 to avoid performance penalty by default.
@@ -0,0 +1,367 @@
+#include "memory_index.h"
+#include "memory_tools_base.h"
+#include "machina/embedding.h"
+#include "machina/embedding_provider.h"
+#include "machina/json_mini.h"
+
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace machina::memtools {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Sidecar format: "MMIX" magic, u32 version, then one record per indexed doc:
+//   u64 off, u32 line_bytes, i64 ts_ms, i32 toks, u32 nterms,
+//   nterms x { u16 term_len, term bytes, u32 tf }
+// Records are appended as lines land, so the sidecar grows with the jsonl and
+// never needs a rewrite. A torn trailing record (crash mid-append) makes the
+// load fail, which triggers a rebuild from the jsonl.
+constexpr char kMagic[4] = {'M', 'M', 'I', 'X'};
+constexpr uint32_t kVersion = 1;
+
+std::mutex g_idx_mu;
+std::unordered_map<std::string, std::shared_ptr<MemIndex>> g_idx_cache;
+
+template <typename T>
+void put_raw(std::string* out, T v) {
+    out->append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+template <typename T>
+bool get_raw(const std::string& buf, size_t* pos, T* v) {
+    if (*pos + sizeof(T) > buf.size()) return false;
+    std::memcpy(v, buf.data() + *pos, sizeof(T));
+    *pos += sizeof(T);
+    return true;
+}
+
+// Tokenizes one line and, if it belongs to the stream, appends it to the
+// index as the next doc. Tokens live in the caller's arena (reset per line),
+// so indexing makes no per-token heap allocations beyond the postings
+// themselves. Returns the per-term frequencies for sidecar serialization
+// (empty map does not mean "skipped" — check the bool).
+bool add_doc(MemIndex* ix, const std::string& stream_needle, uint64_t off,
+             const std::string& line, Arena* arena,
+             std::unordered_map<std::string_view, uint32_t>* tf_out) {
+    if (!stream_needle.empty() && line.find(stream_needle) == std::string::npos) {
+        return false;
+    }
+    std::string text = extract_text_best_effort(line);
+    auto toks = tokenize_lower_arena(text, arena);
+    tf_out->clear();
+    for (const auto& t : toks) (*tf_out)[t]++;
+
+    uint32_t id = (uint32_t)ix->doc_off.size();
+    ix->doc_off.push_back(off);
+    ix->doc_bytes.push_back((uint32_t)line.size());
+    ix->doc_toks.push_back((int32_t)toks.size());
+    ix->doc_ts.push_back(json_mini::get_int(line, "ts_ms").value_or(0));
+    for (const auto& kv : *tf_out) {
+        ix->postings[std::string(kv.first)].push_back(MemPosting{id, kv.second});
+    }
+    return true;
+}
+
+void serialize_record(std::string* out, uint64_t off, uint32_t line_bytes,
+                      int64_t ts, int32_t toks,
+                      const std::unordered_map<std::string_view, uint32_t>& tf) {
+    put_raw(out, off);
+    put_raw(out, line_bytes);
+    put_raw(out, ts);
+    put_raw(out, toks);
+    put_raw(out, (uint32_t)tf.size());
+    for (const auto& kv : tf) {
+        put_raw(out, (uint16_t)kv.first.size());
+        out->append(kv.first);
+        put_raw(out, kv.second);
+    }
+}
+
+// Appends pre-serialized records to the sidecar, writing the header first if
+// the file is new. Failures are non-fatal: the in-memory index stays valid
+// and a later load just falls back to a rebuild.
+void sidecar_append(const fs::path& sp, const std::string& records) {
+    if (records.empty()) return;
+    std::error_code ec;
+    bool fresh = !fs::exists(sp, ec) || fs::file_size(sp, ec) == 0;
+    std::ofstream out(sp, std::ios::binary | std::ios::app);
+    if (!out.good()) return;
+    if (fresh) {
+        out.write(kMagic, sizeof(kMagic));
+        uint32_t ver = kVersion;
+        out.write(reinterpret_cast<const char*>(&ver), sizeof(ver));
+    }
+    out.write(records.data(), (std::streamsize)records.size());
+}
+
+bool sidecar_load(const fs::path& sp, MemIndex* ix) {
+    std::ifstream in(sp, std::ios::binary);
+    if (!in.good()) return false;
+    std::string buf((std::istreambuf_iterator<char>(in)),
+                    std::istreambuf_iterator<char>());
+    size_t pos = 0;
+    if (buf.size() < sizeof(kMagic) + sizeof(uint32_t)) return false;
+    if (std::memcmp(buf.data(), kMagic, sizeof(kMagic)) != 0) return false;
+    pos += sizeof(kMagic);
+    uint32_t ver = 0;
+    if (!get_raw(buf, &pos, &ver) || ver != kVersion) return false;
+
+    while (pos < buf.size()) {
+        uint64_t off = 0;
+        uint32_t line_bytes = 0, nterms = 0;
+        int64_t ts = 0;
+        int32_t toks = 0;
+        if (!get_raw(buf, &pos, &off) || !get_raw(buf, &pos, &line_bytes) ||
+            !get_raw(buf, &pos, &ts) || !get_raw(buf, &pos, &toks) ||
+            !get_raw(buf, &pos, &nterms)) {
+            return false;
+        }
+        uint32_t id = (uint32_t)ix->doc_off.size();
+        ix->doc_off.push_back(off);
+        ix->doc_bytes.push_back(line_bytes);
+        ix->doc_toks.push_back(toks);
+        ix->doc_ts.push_back(ts);
+        for (uint32_t t = 0; t < nterms; t++) {
+            uint16_t tlen = 0;
+            if (!get_raw(buf, &pos, &tlen)) return false;
+            if (pos + tlen > buf.size()) return false;
+            std::string term(buf.data() + pos, tlen);
+            pos += tlen;
+            uint32_t tf = 0;
+            if (!get_raw(buf, &pos, &tf)) return false;
+            ix->postings[term].push_back(MemPosting{id, tf});
+        }
+        ix->indexed_bytes = off + line_bytes + 1;
+    }
+    return true;
+}
+
+// Tokenizes jsonl content from indexed_bytes to EOF, extending the index and
+// batching the new sidecar records into a single append.
+void extend_from_file(const fs::path& file, const std::string& stream,
+                      MemIndex* ix) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in.good()) return;
+    in.seekg((std::streamoff)ix->indexed_bytes, std::ios::beg);
+    std::string buf((std::istreambuf_iterator<char>(in)),
+                    std::istreambuf_iterator<char>());
+
+    const std::string needle = "\"stream\":\"" + stream + "\"";
+    std::string records;
+    Arena arena;
+    std::unordered_map<std::string_view, uint32_t> tf;
+    size_t start = 0;
+    while (start < buf.size()) {
+        size_t nl = buf.find('\n', start);
+        if (nl == std::string::npos) break;  // torn tail, index it next time
+        std::string line = buf.substr(start, nl - start);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        uint64_t off = ix->indexed_bytes + start;
+        arena.reset();
+        if (add_doc(ix, needle, off, line, &arena, &tf)) {
+            serialize_record(&records, off, (uint32_t)line.size(),
+                             ix->doc_ts.back(), ix->doc_toks.back(), tf);
+        }
+        start = nl + 1;
+    }
+    ix->indexed_bytes += start;
+    sidecar_append(mem_index_path(file), records);
+}
+
+// Embedding sidecar: "MEMB" magic, u32 version, u32 dim, then emb_dim
+// l2-normalized f32s per indexed doc, appended in doc-id order. The dim is
+// fixed at write time (MACHINA_MEMORY_EMBED_DIM, default matches the
+// memory_query embed_dim default); a query with a different dim falls back
+// to hashing candidates itself.
+constexpr char kEmbMagic[4] = {'M', 'E', 'M', 'B'};
+constexpr uint32_t kEmbVersion = 1;
+constexpr size_t kEmbHeader = sizeof(kEmbMagic) + 2 * sizeof(uint32_t);
+
+size_t emb_dim_env() {
+    size_t dim = getenv_size_t("MACHINA_MEMORY_EMBED_DIM", 256);
+    if (dim < 16) dim = 16;
+    if (dim > 1024) dim = 1024;
+    return dim;
+}
+
+// Checks the sidecar header and returns the number of whole vectors stored;
+// false means missing/foreign dim/corrupt (caller removes and rebuilds).
+bool emb_sidecar_stat(const fs::path& ep, size_t dim, size_t* count) {
+    std::ifstream in(ep, std::ios::binary);
+    if (!in.good()) return false;
+    char magic[4];
+    uint32_t ver = 0, fdim = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&ver), sizeof(ver));
+    in.read(reinterpret_cast<char*>(&fdim), sizeof(fdim));
+    if (!in.good() || std::memcmp(magic, kEmbMagic, sizeof(magic)) != 0 ||
+        ver != kEmbVersion || fdim != dim) {
+        return false;
+    }
+    std::error_code ec;
+    uint64_t sz = (uint64_t)fs::file_size(ep, ec);
+    if (ec || sz < kEmbHeader) return false;
+    *count = (size_t)((sz - kEmbHeader) / (dim * sizeof(float)));
+    return true;
+}
+
+// Brings the .emb sidecar level with the index, hashing only the docs that
+// landed since the last write. Non-fatal on failure: queries just re-embed.
+void emb_sidecar_ensure(const fs::path& file, MemIndex* ix) {
+    size_t dim = emb_dim_env();
+    fs::path ep = mem_emb_path(file);
+    size_t have = 0;
+    std::error_code ec;
+    if (!emb_sidecar_stat(ep, dim, &have) || have > ix->doc_off.size()) {
+        fs::remove(ep, ec);
+        have = 0;
+    }
+    if (have == ix->doc_off.size()) return;
+
+    std::vector<std::string> texts;
+    texts.reserve(ix->doc_off.size() - have);
+    for (size_t i = have; i < ix->doc_off.size(); i++) {
+        std::string line;
+        if (!mem_read_line_at(file, ix->doc_off[i], ix->doc_bytes[i], &line)) return;
+        texts.push_back(extract_text_best_effort(line));
+    }
+    auto embs = hash_embedding_many(texts, dim);
+    for (auto& e : embs) l2_normalize(e);
+
+    bool fresh = !fs::exists(ep, ec) || fs::file_size(ep, ec) < kEmbHeader;
+    std::ofstream out(ep, std::ios::binary | std::ios::app);
+    if (!out.good()) return;
+    if (fresh) {
+        out.write(kEmbMagic, sizeof(kEmbMagic));
+        uint32_t ver = kEmbVersion, fdim = (uint32_t)dim;
+        out.write(reinterpret_cast<const char*>(&ver), sizeof(ver));
+        out.write(reinterpret_cast<const char*>(&fdim), sizeof(fdim));
+    }
+    for (const auto& e : embs) {
+        out.write(reinterpret_cast<const char*>(e.data()),
+                  (std::streamsize)(e.size() * sizeof(float)));
+    }
+}
+
+// (Re)maps the sidecar read-only so query-time scoring dots straight into
+// page cache instead of re-hashing every candidate.
+void emb_sidecar_map(const fs::path& file, MemIndex* ix) {
+#if defined(_WIN32)
+    (void)file; (void)ix;
+#else
+    size_t dim = emb_dim_env();
+    fs::path ep = mem_emb_path(file);
+    size_t have = 0;
+    if (!emb_sidecar_stat(ep, dim, &have)) return;
+    std::error_code ec;
+    size_t want_bytes = (size_t)fs::file_size(ep, ec);
+    if (ec) return;
+    if (ix->emb_map && ix->emb_map_bytes == want_bytes && ix->emb_dim == dim) return;
+    if (ix->emb_map) {
+        ::munmap(ix->emb_map, ix->emb_map_bytes);
+        ix->emb_map = nullptr;
+        ix->emb = nullptr;
+        ix->emb_count = 0;
+        ix->emb_map_bytes = 0;
+    }
+    int fd = ::open(ep.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    void* map = ::mmap(nullptr, want_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return;
+    ix->emb_map = map;
+    ix->emb_map_bytes = want_bytes;
+    ix->emb_dim = (uint32_t)dim;
+    ix->emb_count = have;
+    ix->emb = reinterpret_cast<const float*>((const char*)map + kEmbHeader);
+#endif
+}
+
+} // namespace
+
+MemIndex::~MemIndex() {
+#if !defined(_WIN32)
+    if (emb_map) ::munmap(emb_map, emb_map_bytes);
+#endif
+}
+
+std::shared_ptr<const MemIndex> mem_index_acquire(const fs::path& file,
+                                                  const std::string& stream) {
+    std::lock_guard<std::mutex> lk(g_idx_mu);
+    auto& slot = g_idx_cache[file.string()];
+
+    std::error_code ec;
+    uint64_t fsize = fs::exists(file, ec) ? (uint64_t)fs::file_size(file, ec) : 0;
+    if (ec) fsize = 0;
+
+    if (!slot) {
+        slot = std::make_shared<MemIndex>();
+        if (!sidecar_load(mem_index_path(file), slot.get())) {
+            slot = std::make_shared<MemIndex>();
+        }
+    }
+    if (slot->indexed_bytes > fsize) {
+        // Rotated or truncated under us: the sidecars describe stale bytes.
+        slot = std::make_shared<MemIndex>();
+        fs::remove(mem_index_path(file), ec);
+        fs::remove(mem_emb_path(file), ec);
+    }
+    if (slot->indexed_bytes < fsize) {
+        extend_from_file(file, stream, slot.get());
+    }
+    emb_sidecar_ensure(file, slot.get());
+    emb_sidecar_map(file, slot.get());
+    return slot;
+}
+
+void mem_index_append(const fs::path& file, const std::string& stream,
+                      uint64_t off, const std::string& line) {
+    std::lock_guard<std::mutex> lk(g_idx_mu);
+    auto& slot = g_idx_cache[file.string()];
+    if (!slot) {
+        slot = std::make_shared<MemIndex>();
+        if (!sidecar_load(mem_index_path(file), slot.get())) {
+            slot = std::make_shared<MemIndex>();
+        }
+    }
+    if (slot->indexed_bytes != off) {
+        // Out of step (pre-index backlog, external writer): leave the gap for
+        // the next acquire to scan rather than indexing out of order.
+        return;
+    }
+    const std::string needle = "\"stream\":\"" + stream + "\"";
+    Arena arena;
+    std::unordered_map<std::string_view, uint32_t> tf;
+    if (add_doc(slot.get(), needle, off, line, &arena, &tf)) {
+        std::string rec;
+        serialize_record(&rec, off, (uint32_t)line.size(),
+                         slot->doc_ts.back(), slot->doc_toks.back(), tf);
+        sidecar_append(mem_index_path(file), rec);
+    }
+    slot->indexed_bytes = off + line.size() + 1;
+    // Embed the new doc now so the query path never has to; remapping is
+    // deferred to the next acquire.
+    emb_sidecar_ensure(file, slot.get());
+}
+
+bool mem_read_line_at(const fs::path& file, uint64_t off, uint32_t len,
+                      std::string* out) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in.good()) return false;
+    in.seekg((std::streamoff)off, std::ios::beg);
+    out->resize(len);
+    in.read(out->data(), (std::streamsize)len);
+    return in.gcount() == (std::streamsize)len;
+}
+
+} // namespace machina::memtools
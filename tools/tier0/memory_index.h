@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace machina::memtools {
+
+// Inverted index over one memory jsonl file: term -> postings (doc id, term
+// frequency), plus per-doc byte offsets, token counts and timestamps. Doc ids
+// are positions in append order, so "the most recent K docs" is a suffix.
+//
+// The index is incremental: tool_memory_append extends it line-by-line as
+// entries land, and it is persisted in an append-only sidecar next to the
+// jsonl (see mem_index_path in memory_tools_base.h) so a fresh process does
+// not re-tokenize the whole corpus. BM25 candidate generation then touches
+// only the postings for the query terms instead of every line.
+
+struct MemPosting {
+    uint32_t doc{0};
+    uint32_t tf{0};
+};
+
+struct MemIndex {
+    uint64_t indexed_bytes{0};   // prefix of the jsonl covered by the index
+    std::vector<uint64_t> doc_off;    // byte offset of each indexed line
+    std::vector<uint32_t> doc_bytes;  // line length, excluding the newline
+    std::vector<int32_t> doc_toks;    // token count (BM25 doc length)
+    std::vector<int64_t> doc_ts;      // ts_ms from the line (0 if absent)
+    std::unordered_map<std::string, std::vector<MemPosting>> postings;
+
+    // Doc embeddings, mmapped from the .emb sidecar: emb_dim floats per doc,
+    // hash embeddings l2-normalized at write time. emb is null when the
+    // sidecar is unavailable (Windows, write failure); callers then hash the
+    // doc text themselves.
+    uint32_t emb_dim{0};
+    size_t emb_count{0};
+    const float* emb{nullptr};
+    void* emb_map{nullptr};       // internal: mmap base/length for unmap
+    size_t emb_map_bytes{0};
+
+    MemIndex() = default;
+    MemIndex(const MemIndex&) = delete;
+    MemIndex& operator=(const MemIndex&) = delete;
+    ~MemIndex();
+};
+
+// Returns the shared in-process index for one memory jsonl, loading the
+// sidecar and tokenizing only the unindexed tail (or rebuilding after a
+// rotation/truncate). Never returns nullptr; an unreadable file yields an
+// empty index. Callers must hold memtools::g_mem_mu.
+std::shared_ptr<const MemIndex> mem_index_acquire(const std::filesystem::path& file,
+                                                  const std::string& stream);
+
+// Fast path for tool_memory_append: extends the cached index and sidecar with
+// one just-written line (at byte offset `off`, newline not included) without
+// re-reading the file. Callers must hold memtools::g_mem_mu.
+void mem_index_append(const std::filesystem::path& file,
+                      const std::string& stream,
+                      uint64_t off,
+                      const std::string& line);
+
+// Reads one line back by byte offset/length (candidate fetch after postings
+// ranking). Returns false if the file cannot be read at that range.
+bool mem_read_line_at(const std::filesystem::path& file,
+                      uint64_t off,
+                      uint32_t len,
+                      std::string* out);
+
+} // namespace machina::memtools
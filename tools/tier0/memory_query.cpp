@@ -1,8 +1,14 @@
 #include "machina/tools.h"
 #include "machina/json_mini.h"
+#include "machina/json_writer.h"
+#include "machina/thread_pool.h"
+#include "machina/topk.h"
 #include "machina/embedding.h"
 #include "machina/embedding_provider.h"
+#include "machina/vec_simd.h"
 #include "memory_tools_base.h"
+#include "memory_index.h"
+#include "vectordb_tools.h"
 
 #include <algorithm>
 #include <cmath>
@@ -11,22 +17,24 @@
 
 namespace machina {
 
-// Optional semantic backend (vectordb). Implemented in vectordb_tools.cpp.
-ToolResult tool_vecdb_query(const std::string& input_json, DSState& ds_tmp);
-
-struct MemDoc {
-    std::string file;
-    std::string line;
-    std::string text;
-    int64_t ts_ms{0};
-    float overlap{0.0f};
-    std::vector<float> emb;
-    float mmr_max_sim{0.0f};
-    int doc_len{0};
-    std::unordered_map<std::string, int> tfq;
-    float score_bm25{0.0f};
-    float score_emb{0.0f};
-    float score{0.0f};
+// Candidate columns (struct-of-arrays): the scoring and rerank loops walk
+// the hot float columns contiguously and sort 4-byte indices instead of
+// moving string-bearing structs. Embeddings live in one flat n*dim buffer so
+// similarity dots read consecutive rows.
+struct CandCols {
+    std::vector<std::string> file;
+    std::vector<std::string> line;
+    std::vector<std::string> text;
+    std::vector<int64_t> ts_ms;
+    std::vector<float> overlap;
+    std::vector<float> bm25;
+    std::vector<float> recency;
+    std::vector<float> emb_score;
+    std::vector<float> score;
+    std::vector<float> mmr_max_sim;
+    std::vector<float> emb; // row i at emb.data() + i * dim
+
+    size_t size() const { return file.size(); }
 };
 
 static double getenv_double(const char* k, double defv) {
@@ -37,22 +45,25 @@ static double getenv_double(const char* k, double defv) {
 }
 
 ToolResult tool_memory_query(const std::string& input_json, DSState& /*ds_tmp*/) {
-    auto stream = memtools::sanitize_stream(json_mini::get_string(input_json, "stream").value_or("default"));
-    auto query = json_mini::get_string(input_json, "query").value_or("");
-    auto mode = json_mini::get_string(input_json, "mode").value_or("hybrid");
-    auto rerank = json_mini::get_string(input_json, "rerank").value_or("mmr");
-
-    int top_k = (int)json_mini::get_int(input_json, "top_k").value_or(10);
-    int candidate_k = (int)json_mini::get_int(input_json, "candidate_k").value_or(0);
-    int max_entries = (int)json_mini::get_int(input_json, "max_entries").value_or(2000);
-    size_t max_bytes = (size_t)json_mini::get_int(input_json, "max_bytes").value_or((int64_t)(2 * 1024 * 1024));
-    size_t max_files = (size_t)json_mini::get_int(input_json, "max_files").value_or(4);
-    bool debug = json_mini::get_bool(input_json, "debug").value_or(false);
-
+    // One parse for the whole input instead of one per field.
+    json_mini::Cursor in(input_json);
+    std::string stream_raw = "default", query, mode = "hybrid", rerank = "mmr";
+    int top_k = 10, candidate_k = 0, max_entries = 2000;
+    size_t max_bytes = 2 * 1024 * 1024, max_files = 4;
+    bool debug = false;
     double mmr_lambda = 0.72;
-    if (auto mv = json_mini::get_double(input_json, "mmr_lambda")) {
-        mmr_lambda = *mv;
-    }
+    in.bind("stream", stream_raw);
+    in.bind("query", query);
+    in.bind("mode", mode);
+    in.bind("rerank", rerank);
+    in.bind("top_k", top_k);
+    in.bind("candidate_k", candidate_k);
+    in.bind("max_entries", max_entries);
+    in.bind("max_bytes", max_bytes);
+    in.bind("max_files", max_files);
+    in.bind("debug", debug);
+    in.bind("mmr_lambda", mmr_lambda);
+    auto stream = memtools::sanitize_stream(stream_raw);
 
     if (top_k < 1) top_k = 1;
     if (top_k > 50) top_k = 50;
@@ -71,216 +82,370 @@ ToolResult tool_memory_query(const std::string& input_json, DSState& /*ds_tmp*/)
     if (candidate_k < top_k) candidate_k = top_k;
     if (candidate_k > 500) candidate_k = 500;
 
-    // Tokenize query for overlap/BM25-ish scoring
+    // Budget pacing hint from the runner: shrink result and candidate
+    // counts proportionally when the run is close to its budget.
+    if (auto braw = in.get_object_raw("_system_budget")) {
+        double ks = json_mini::get_double(*braw, "k_scale").value_or(1.0);
+        if (ks > 0.0 && ks < 1.0) {
+            top_k = std::max(1, (int)((double)top_k * ks));
+            candidate_k = std::max(top_k, (int)((double)candidate_k * ks));
+        }
+    }
+
+    // Tokenize query for overlap/BM25-ish scoring, then compile it into an
+    // indexed term table: term qi gets slot qi in flat per-doc count rows,
+    // so the scoring loop below never hashes a string. Duplicate query
+    // tokens become a multiplicity so BM25 weighs them as the token list
+    // would have.
     auto q_tokens = memtools::tokenize_lower(query);
-    std::unordered_set<std::string> q_set(q_tokens.begin(), q_tokens.end());
+    std::vector<std::string> q_terms;
+    std::vector<uint32_t> q_mult;
+    {
+        std::unordered_map<std::string, uint32_t> seen;
+        for (const auto& t : q_tokens) {
+            auto ins = seen.emplace(t, (uint32_t)q_terms.size());
+            if (ins.second) {
+                q_terms.push_back(t);
+                q_mult.push_back(1);
+            } else {
+                q_mult[ins.first->second]++;
+            }
+        }
+    }
+    const size_t Q = q_terms.size();
+
+    // Scoring weights (also drive index-side candidate generation)
+    double w_overlap = getenv_double("MACHINA_MEMORY_W_OVERLAP", 0.55);
+    double w_emb = getenv_double("MACHINA_MEMORY_W_EMB", 0.35);
+    double w_bm25 = getenv_double("MACHINA_MEMORY_W_BM25", 0.20);
+    double w_recency = getenv_double("MACHINA_MEMORY_W_RECENCY", 0.10);
+    double tau_sec = getenv_double("MACHINA_MEMORY_RECENCY_TAU_SEC", 6 * 3600.0);
 
-    // Load docs from recent memory files (hold lock only for file I/O)
-    std::vector<MemDoc> docs;
+    int64_t tnow = memtools::now_ms();
+    (void)max_bytes; // retained input; the index replaces bounded tail reads
+
+    // Embedding dim (hash for now); when it matches the append-time dim the
+    // candidate embeddings come straight from the mmapped sidecar.
+    size_t dim = 256;
+    in.bind("embed_dim", dim);
+    if (dim < 16) dim = 16;
+    if (dim > 1024) dim = 1024;
+
+    // Candidate generation from the per-file inverted indexes: BM25, overlap
+    // and recency come straight from postings for the query terms instead of
+    // re-tokenizing the corpus (memory_index.h). Only the candidate_k best
+    // docs are read back from disk and embedded below.
+    CandCols cc;
+    std::vector<size_t> emb_miss; // rows whose sidecar embedding was unusable
     {
         std::lock_guard<std::mutex> lk(memtools::g_mem_mu);
         namespace fs = std::filesystem;
         fs::path mr = memtools::memory_root();
         auto files = memtools::list_memory_files(mr, stream, max_files);
 
-        docs.reserve((size_t)max_entries);
-
+        // Window: the most recent max_entries docs, newest files first.
+        struct FileWin {
+            std::shared_ptr<const memtools::MemIndex> ix;
+            size_t start{0};
+            const fs::path* path{nullptr};
+        };
+        std::vector<FileWin> wins;
+        size_t remaining = (size_t)max_entries;
+        size_t n_total = 0;
         for (const auto& file : files) {
-            auto lines = memtools::tail_lines_matching(file, "\"stream\":\"" + stream + "\"", (size_t)max_entries, max_bytes);
-            for (const auto& line : lines) {
-                if ((int)docs.size() >= max_entries) break;
-                MemDoc d;
-                d.file = file.string();
-                d.line = line;
-                d.text = memtools::extract_text_best_effort(line);
-                d.ts_ms = json_mini::get_int(line, "ts_ms").value_or(0);
-
-                // Compute overlap
-                auto dtoks = memtools::tokenize_lower(d.text);
-                d.doc_len = (int)dtoks.size();
-                int hit = 0;
-                for (const auto& t : dtoks) {
-                    if (!q_set.empty() && q_set.count(t)) hit++;
-                    d.tfq[t]++;
-                }
-                if (!q_tokens.empty()) d.overlap = (float)hit / (float)q_tokens.size();
-                docs.push_back(std::move(d));
-            }
-            if ((int)docs.size() >= max_entries) break;
+            if (remaining == 0) break;
+            auto ix = memtools::mem_index_acquire(file, stream);
+            size_t n = ix->doc_off.size();
+            size_t take = std::min(n, remaining);
+            if (take == 0) continue;
+            wins.push_back(FileWin{ix, n - take, &file});
+            remaining -= take;
+            n_total += take;
         }
-    } // lock released — remaining computation is on local copies
 
-    if (docs.empty()) {
-        std::ostringstream j;
-        j << "{\"ok\":true,\"stream\":\"" << memtools::json_escape(stream) << "\",\"matches\":[],\"count\":0}";
-        return {StepStatus::OK, j.str(), ""};
-    }
+        if (n_total > 0) {
+            double avgdl = 0.0;
+            for (const auto& w : wins) {
+                for (size_t i = w.start; i < w.ix->doc_toks.size(); i++) {
+                    avgdl += (double)std::max(1, (int)w.ix->doc_toks[i]);
+                }
+            }
+            avgdl /= (double)n_total;
+            double k1 = 1.2;
+            double b = 0.75;
+
+            // df and per-doc tf over the window, touching only query-term
+            // postings. A doc's frequencies are one row of Q counts in a
+            // flat per-window buffer (slot map doc -> row), not a
+            // string-keyed map per document.
+            std::vector<int> df(Q, 0);
+            struct WinTf {
+                std::unordered_map<uint32_t, uint32_t> slot;
+                std::vector<uint32_t> tf; // row r for its doc at tf[r*Q..r*Q+Q)
+            };
+            std::vector<WinTf> tf_by_doc(wins.size());
+            for (size_t wi = 0; wi < wins.size(); wi++) {
+                WinTf& wt = tf_by_doc[wi];
+                for (size_t qi = 0; qi < Q; qi++) {
+                    auto it = wins[wi].ix->postings.find(q_terms[qi]);
+                    if (it == wins[wi].ix->postings.end()) continue;
+                    for (const auto& p : it->second) {
+                        if ((size_t)p.doc < wins[wi].start) continue;
+                        auto ins = wt.slot.emplace(p.doc, (uint32_t)(wt.tf.size() / Q));
+                        if (ins.second) wt.tf.resize(wt.tf.size() + Q, 0);
+                        wt.tf[(size_t)ins.first->second * Q + qi] = p.tf;
+                        df[qi]++;
+                    }
+                }
+            }
+            double N = (double)n_total;
+            auto idf = [&](size_t qi)->double{
+                // +1 smoothing
+                return std::log((N + 1.0) / (df[qi] + 1.0)) + 1.0;
+            };
+
+            struct Cand {
+                size_t win{0};
+                uint32_t doc{0};
+                float prelim{0.0f};
+                float overlap{0.0f};
+                float bm25{0.0f};
+                float rec{0.0f};
+            };
+            auto score_doc = [&](size_t wi, size_t i) -> Cand {
+                const auto& ix = *wins[wi].ix;
+                Cand c;
+                c.win = wi;
+                c.doc = (uint32_t)i;
+                auto sit = tf_by_doc[wi].slot.find((uint32_t)i);
+                if (sit != tf_by_doc[wi].slot.end()) {
+                    const uint32_t* tfrow =
+                        tf_by_doc[wi].tf.data() + (size_t)sit->second * Q;
+                    uint32_t occ = 0;
+                    for (size_t qi = 0; qi < Q; qi++) occ += tfrow[qi];
+                    if (!q_tokens.empty()) c.overlap = (float)occ / (float)q_tokens.size();
+                    double bm25 = 0.0;
+                    int dl = std::max(1, (int)ix.doc_toks[i]);
+                    for (size_t qi = 0; qi < Q; qi++) {
+                        if (tfrow[qi] == 0) continue;
+                        double tf = (double)tfrow[qi];
+                        double denom = tf + k1 * (1.0 - b + b * ((double)dl / avgdl));
+                        bm25 += q_mult[qi] * idf(qi) * (tf * (k1 + 1.0)) / denom;
+                    }
+                    c.bm25 = (float)bm25;
+                }
+                if (ix.doc_ts[i] > 0) {
+                    double age_sec = std::max(0.0, (double)(tnow - ix.doc_ts[i]) / 1000.0);
+                    c.rec = (float)std::exp(-age_sec / std::max(1.0, tau_sec));
+                }
+                c.prelim = (float)((w_overlap * c.overlap) + (w_bm25 * c.bm25) + (w_recency * c.rec));
+                return c;
+            };
+
+            auto better = [](const Cand& x, const Cand& y) { return x.prelim > y.prelim; };
+            TopK<Cand, decltype(better)> topc((size_t)candidate_k, better);
+
+            // Flat (window, doc) ids so the scan partitions evenly across
+            // the shared worker pool; each chunk keeps its own TopK and the
+            // merge is candidate_k offers under a mutex. Small windows stay
+            // serial — chunk overhead beats the scan below this size.
+            std::vector<std::pair<uint32_t, uint32_t>> flat;
+            flat.reserve(n_total);
+            for (size_t wi = 0; wi < wins.size(); wi++) {
+                for (size_t i = wins[wi].start; i < wins[wi].ix->doc_off.size(); i++) {
+                    flat.emplace_back((uint32_t)wi, (uint32_t)i);
+                }
+            }
+            constexpr size_t kParallelScoreMin = 512;
+            if (flat.size() >= kParallelScoreMin) {
+                std::mutex merge_mu;
+                ThreadPool::shared().parallel_for(0, flat.size(), [&](size_t cb, size_t ce) {
+                    TopK<Cand, decltype(better)> local((size_t)candidate_k, better);
+                    for (size_t f = cb; f < ce; f++) {
+                        local.offer(score_doc(flat[f].first, flat[f].second));
+                    }
+                    auto part = local.take_sorted();
+                    std::lock_guard<std::mutex> mlk(merge_mu);
+                    for (auto& pc : part) topc.offer(std::move(pc));
+                });
+            } else {
+                for (const auto& fd : flat) topc.offer(score_doc(fd.first, fd.second));
+            }
 
-    // Optional semantic candidate set via vectordb
-    std::unordered_set<std::string> sem_lines;
-    if ((mode == "semantic" || mode == "hybrid") && !query.empty()) {
-        // Call vecdb tool by crafting a minimal input
-        std::ostringstream in;
-        in << "{\"stream\":\"" << memtools::json_escape(stream) << "\",\"query\":\"" << memtools::json_escape(query) << "\",\"top_k\":" << candidate_k << "}";
-        DSState dummy;
-        auto vr = tool_vecdb_query(in.str(), dummy);
-        if (vr.status == StepStatus::OK) {
-            auto arr = json_mini::get_array_raw(vr.output_json, "matches");
-            if (arr) {
-                auto objs = json_mini::parse_array_objects_raw(*arr);
-                for (const auto& o : objs) {
-                    auto raw = json_mini::get_string(o, "raw");
-                    if (raw) sem_lines.insert(*raw);
+            // Fetch candidate lines by byte offset (one seek each), filling
+            // the columns in candidate order.
+            auto cands = topc.take_sorted();
+            cc.file.reserve(cands.size());
+            cc.emb.reserve(cands.size() * dim);
+            for (const auto& c : cands) {
+                const auto& ix = *wins[c.win].ix;
+                std::string line;
+                if (!memtools::mem_read_line_at(*wins[c.win].path, ix.doc_off[c.doc],
+                                                ix.doc_bytes[c.doc], &line)) {
+                    continue;
+                }
+                size_t row = cc.size();
+                cc.file.push_back(wins[c.win].path->string());
+                cc.line.push_back(std::move(line));
+                cc.text.push_back(memtools::extract_text_best_effort(cc.line.back()));
+                cc.ts_ms.push_back(ix.doc_ts[c.doc]);
+                cc.overlap.push_back(c.overlap);
+                cc.bm25.push_back(c.bm25);
+                cc.recency.push_back(c.rec);
+                if (ix.emb && ix.emb_dim == dim && (size_t)c.doc < ix.emb_count) {
+                    const float* e = ix.emb + (size_t)c.doc * dim;
+                    cc.emb.insert(cc.emb.end(), e, e + dim);
+                } else {
+                    cc.emb.insert(cc.emb.end(), dim, 0.0f);
+                    emb_miss.push_back(row);
                 }
             }
         }
-    }
+    } // lock released — remaining computation is on local copies
 
-    // Embedding for query (hash for now)
-    size_t dim = (size_t)json_mini::get_int(input_json, "embed_dim").value_or(256);
-    if (dim < 16) dim = 16;
-    if (dim > 1024) dim = 1024;
+    cc.emb_score.resize(cc.size(), 0.0f);
+    cc.score.resize(cc.size(), 0.0f);
+    cc.mmr_max_sim.resize(cc.size(), 0.0f);
+
+    if (cc.size() == 0) {
+        JsonWriter j;
+        j.begin_object();
+        j.kv("ok", true);
+        j.kv("stream", stream);
+        j.key("matches").begin_array().end_array();
+        j.kv("count", 0);
+        j.end_object();
+        return {StepStatus::OK, j.take(), ""};
+    }
 
     auto qemb = hash_embedding(query, dim);
     l2_normalize(qemb);
 
-    // Scoring: combine overlap, semantic embedding, BM25-ish and recency
-    double w_overlap = getenv_double("MACHINA_MEMORY_W_OVERLAP", 0.55);
-    double w_emb = getenv_double("MACHINA_MEMORY_W_EMB", 0.35);
-    double w_bm25 = getenv_double("MACHINA_MEMORY_W_BM25", 0.20);
-    double w_recency = getenv_double("MACHINA_MEMORY_W_RECENCY", 0.10);
-    double tau_sec = getenv_double("MACHINA_MEMORY_RECENCY_TAU_SEC", 6 * 3600.0);
-
-    // Build IDF from local corpus
-    std::unordered_map<std::string, int> df;
-    df.reserve(1024);
-    for (const auto& d : docs) {
-        std::unordered_set<std::string> seen;
-        for (const auto& kv : d.tfq) seen.insert(kv.first);
-        for (const auto& t : seen) df[t]++;
+    // Optional semantic candidate set via the direct vecdb API: shares qemb
+    // when the stream dim matches (one embedding pass for hybrid mode) and
+    // returns meta lines with no JSON round-trip. Gate by stored text, which
+    // is what the memory mirror upserts carry.
+    std::unordered_set<std::string> sem_texts;
+    if ((mode == "semantic" || mode == "hybrid") && !query.empty()) {
+        std::vector<VecdbHit> hits;
+        std::string verr;
+        if (vectordb_query_direct(stream, query, (size_t)candidate_k, 8, &qemb,
+                                  &hits, nullptr, nullptr, &verr)) {
+            for (const auto& h : hits) {
+                if (auto t = json_mini::get_string(h.meta_line, "text")) {
+                    sem_texts.insert(*t);
+                }
+            }
+        }
     }
-    auto idf = [&](const std::string& t)->double{
-        auto it = df.find(t);
-        int dfi = (it==df.end()) ? 0 : it->second;
-        double N = (double)docs.size();
-        // +1 smoothing
-        return std::log((N + 1.0) / (dfi + 1.0)) + 1.0;
-    };
-
-    // Precompute avgdl for BM25
-    double avgdl = 0.0;
-    for (auto& d : docs) avgdl += (double)std::max(1, d.doc_len);
-    avgdl = avgdl / std::max(1.0, (double)docs.size());
-    double k1 = 1.2;
-    double b = 0.75;
 
-    int64_t tnow = memtools::now_ms();
-
-    for (auto& d : docs) {
-        // Emb score
-        d.emb = hash_embedding(d.text, dim);
-        l2_normalize(d.emb);
-        d.score_emb = (float)dot(qemb, d.emb);
-
-        // BM25-ish over query tokens
-        double bm25 = 0.0;
-        for (const auto& qt : q_tokens) {
-            int tf = 0;
-            auto it = d.tfq.find(qt);
-            if (it != d.tfq.end()) tf = it->second;
-            if (tf == 0) continue;
-            double denom = tf + k1 * (1.0 - b + b * ((double)std::max(1, d.doc_len) / avgdl));
-            bm25 += idf(qt) * (tf * (k1 + 1.0)) / denom;
+    // Most candidates carry their embedding from the sidecar; batch-hash
+    // only the rows that missed (dim mismatch, sidecar unavailable).
+    if (!emb_miss.empty()) {
+        std::vector<std::string> miss_texts;
+        miss_texts.reserve(emb_miss.size());
+        for (size_t i : emb_miss) miss_texts.push_back(cc.text[i]);
+        auto doc_embs = hash_embedding_many(miss_texts, dim);
+        for (size_t m = 0; m < emb_miss.size(); m++) {
+            std::copy(doc_embs[m].begin(), doc_embs[m].end(),
+                      cc.emb.begin() + (ptrdiff_t)(emb_miss[m] * dim));
         }
-        d.score_bm25 = (float)bm25;
+    }
 
-        // Recency in [0,1]
-        double rec = 0.0;
-        if (d.ts_ms > 0) {
-            double age_sec = std::max(0.0, (double)(tnow - d.ts_ms) / 1000.0);
-            rec = std::exp(-age_sec / std::max(1.0, tau_sec));
+    // Full score: overlap/BM25/recency from the index pass, plus embedding
+    // similarity computed on the candidates only. One pass over the float
+    // columns and the flat embedding rows.
+    for (size_t i = 0; i < cc.size(); i++) {
+        float* e = cc.emb.data() + i * dim;
+        float norm = std::sqrt(vec::dot_f32(e, e, dim));
+        if (norm > 0.0f) {
+            for (size_t k = 0; k < dim; k++) e[k] /= norm;
         }
+        cc.emb_score[i] = vec::dot_f32(qemb.data(), e, dim);
 
-        // Optional semantic filter: if semantic mode and no line match, down-weight
+        // Optional semantic filter: if semantic mode and no text match, down-weight
         double sem_gate = 1.0;
-        if ((mode == "semantic" || mode == "hybrid") && !sem_lines.empty()) {
-            if (sem_lines.count(d.line) == 0) sem_gate = 0.5;
+        if ((mode == "semantic" || mode == "hybrid") && !sem_texts.empty()) {
+            if (sem_texts.count(cc.text[i]) == 0) sem_gate = 0.5;
         }
 
-        double base = (w_overlap * d.overlap) + (w_emb * d.score_emb) + (w_bm25 * d.score_bm25) + (w_recency * rec);
-        d.score = (float)(base * sem_gate);
+        double base = (w_overlap * cc.overlap[i]) + (w_emb * cc.emb_score[i]) +
+                      (w_bm25 * cc.bm25[i]) + (w_recency * cc.recency[i]);
+        cc.score[i] = (float)(base * sem_gate);
     }
 
-    // Candidate set by score
-    std::sort(docs.begin(), docs.end(), [](const MemDoc& a, const MemDoc& b){
-        return a.score > b.score;
+    // Order candidates by score: sort 4-byte indices over the score column
+    // rather than moving rows.
+    std::vector<uint32_t> order(cc.size());
+    for (uint32_t i = 0; i < (uint32_t)cc.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t x, uint32_t y) {
+        return cc.score[x] > cc.score[y];
     });
-    if ((int)docs.size() > candidate_k) docs.resize((size_t)candidate_k);
 
-    // Rerank
-    std::vector<MemDoc> sel;
+    // Rerank — sel holds row indices into cc.
+    std::vector<uint32_t> sel;
     sel.reserve((size_t)top_k);
 
     if (rerank == "mmr") {
-        while ((int)sel.size() < top_k && !docs.empty()) {
-            int best = -1;
+        // Each candidate carries its running max similarity against the
+        // selected set, updated only against the single doc picked per
+        // iteration — O(n·k) dot products total instead of O(k²·n) — and
+        // removal is swap-remove on the index list.
+        while ((int)sel.size() < top_k && !order.empty()) {
+            size_t best = 0;
             double best_score = -1e18;
-
-            for (int i = 0; i < (int)docs.size(); i++) {
-                double redundancy = 0.0;
-                double max_sim = 0.0;
-                for (const auto& s : sel) {
-                    double sim = dot(docs[i].emb, s.emb);
-                    if (sim > max_sim) max_sim = sim;
-                }
-                redundancy = max_sim;
-
-                double mmr = mmr_lambda * docs[i].score - (1.0 - mmr_lambda) * redundancy;
+            for (size_t i = 0; i < order.size(); i++) {
+                uint32_t id = order[i];
+                double mmr = mmr_lambda * cc.score[id] -
+                             (1.0 - mmr_lambda) * (double)cc.mmr_max_sim[id];
                 if (mmr > best_score) {
                     best_score = mmr;
                     best = i;
                 }
             }
 
-            if (best < 0) break;
-            // annotate max_sim for debug
-            double max_sim = 0.0;
-            for (const auto& s : sel) {
-                double sim = dot(docs[best].emb, s.emb);
-                if (sim > max_sim) max_sim = sim;
+            uint32_t picked = order[best];
+            order[best] = order.back();
+            order.pop_back();
+            const float* pe = cc.emb.data() + (size_t)picked * dim;
+            for (uint32_t id : order) {
+                float sim = vec::dot_f32(cc.emb.data() + (size_t)id * dim, pe, dim);
+                if (sim > cc.mmr_max_sim[id]) cc.mmr_max_sim[id] = sim;
             }
-            docs[best].mmr_max_sim = (float)max_sim;
-
-            sel.push_back(std::move(docs[best]));
-            docs.erase(docs.begin() + best);
+            sel.push_back(picked);
         }
     } else {
-        if ((int)docs.size() > top_k) docs.resize((size_t)top_k);
-        sel = std::move(docs);
+        if ((int)order.size() > top_k) order.resize((size_t)top_k);
+        sel = std::move(order);
     }
 
-    std::ostringstream out;
-    out << "{\"ok\":true,\"stream\":\"" << memtools::json_escape(stream) << "\",\"count\":" << sel.size() << ",\"matches\":[";
+    JsonWriter out(sel.size() * 256 + 64);
+    out.begin_object();
+    out.kv("ok", true);
+    out.kv("stream", stream);
+    out.kv("count", sel.size());
+    out.key("matches").begin_array();
     for (size_t i = 0; i < sel.size(); i++) {
-        if (i) out << ",";
-        out << "{";
-        out << "\"file\":\"" << memtools::json_escape(sel[i].file) << "\",";
-        out << "\"ts_ms\":" << sel[i].ts_ms << ",";
-        out << "\"score\":" << sel[i].score << ",";
-        out << "\"overlap\":" << sel[i].overlap << ",";
-        out << "\"emb\":" << sel[i].score_emb << ",";
-        out << "\"bm25\":" << sel[i].score_bm25 << ",";
+        uint32_t id = sel[i];
+        out.begin_object();
+        out.kv("file", cc.file[id]);
+        out.kv("ts_ms", cc.ts_ms[id]);
+        out.kv("score", cc.score[id]);
+        out.kv("overlap", cc.overlap[id]);
+        out.kv("emb", cc.emb_score[id]);
+        out.kv("bm25", cc.bm25[id]);
         if (debug) {
-            out << "\"mmr_max_sim\":" << sel[i].mmr_max_sim << ",";
-            out << "\"raw\":\"" << memtools::json_escape(sel[i].line) << "\",";
+            out.kv("mmr_max_sim", cc.mmr_max_sim[id]);
+            out.kv("raw", cc.line[id]);
         }
         // always include text for downstream use
-        out << "\"text\":\"" << memtools::json_escape(sel[i].text) << "\"";
-        out << "}";
+        out.kv("text", cc.text[id]);
+        out.end_object();
     }
-    out << "]}";
+    out.end_array();
+    out.end_object();
 
-    return {StepStatus::OK, out.str(), ""};
+    return {StepStatus::OK, out.take(), ""};
 }
 
 } // namespace machina
@@ -1,18 +1,27 @@
 #pragma once
 
+#include "machina/arena.h"
 #include "machina/json_mini.h"
+#include "machina/path_guard.h"
 
 #include <algorithm>
 #include <cctype>
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace machina::memtools {
 
 inline std::mutex g_mem_mu;
@@ -38,16 +47,8 @@ inline std::filesystem::path memory_root() {
 }
 
 inline bool is_path_under(const std::filesystem::path& p, const std::filesystem::path& root) {
-    std::error_code ec;
-    auto rp = std::filesystem::weakly_canonical(p, ec);
-    if (ec) return false;
-    auto rr = std::filesystem::weakly_canonical(root, ec);
-    if (ec) return false;
-    auto ps = rp.generic_string();
-    auto rs = rr.generic_string();
-    if (ps == rs) return true;
-    if (!rs.empty() && rs.back() != '/') rs.push_back('/');
-    return ps.rfind(rs, 0) == 0;
+    // Cached canonicalization; see machina/path_guard.h.
+    return machina::path_is_under(p, root);
 }
 
 inline std::string sanitize_stream(const std::string& s) {
@@ -68,6 +69,16 @@ inline size_t getenv_size_t(const char* k, size_t defv) {
     return defv;
 }
 
+// Sidecar inverted index for one memory jsonl (see memory_index.h).
+inline std::filesystem::path mem_index_path(const std::filesystem::path& file) {
+    return std::filesystem::path(file.string() + ".midx");
+}
+
+// Sidecar doc embeddings aligned with the index doc ids (see memory_index.h).
+inline std::filesystem::path mem_emb_path(const std::filesystem::path& file) {
+    return std::filesystem::path(file.string() + ".emb");
+}
+
 inline void maybe_rotate(const std::filesystem::path& file) {
     namespace fs = std::filesystem;
     std::error_code ec;
@@ -85,8 +96,27 @@ inline void maybe_rotate(const std::filesystem::path& file) {
     int64_t ts = now_ms();
     fs::path rotated = dir / (stem + "." + std::to_string(ts) + ".rotated");
     fs::rename(file, rotated, ec);
+    // Keep the sidecars attached to the rotated file so they are not
+    // rebuilt from scratch the next time a query touches the rotation.
+    if (!ec) {
+        fs::rename(mem_index_path(file), mem_index_path(rotated), ec);
+        std::error_code ec2;
+        fs::rename(mem_emb_path(file), mem_emb_path(rotated), ec2);
+    }
 }
 
+// Per-file tail cursor: remembers the byte offset of the last complete line
+// parsed plus the parsed window, validated by file size, so repeated calls
+// over an append-only jsonl only parse newly appended bytes. A shrunk file
+// (rotation/truncate) or a window reaching further back than the cursor
+// triggers a full re-read. Callers must hold g_mem_mu.
+struct TailCursor {
+    uint64_t start_off{0};  // window start honored by the cached lines
+    uint64_t end_off{0};    // byte after the last complete line parsed
+    std::deque<std::pair<uint64_t, std::string>> lines;  // (offset, line)
+};
+inline std::unordered_map<std::string, TailCursor> g_tail_cursors;
+
 inline std::vector<std::string> tail_lines_matching(const std::filesystem::path& file,
                                                     const std::string& needle,
                                                     size_t limit,
@@ -95,60 +125,165 @@ inline std::vector<std::string> tail_lines_matching(const std::filesystem::path&
     std::vector<std::string> out;
     std::error_code ec;
     if (!fs::exists(file, ec)) return out;
+    uint64_t fsize = (uint64_t)fs::file_size(file, ec);
+    if (ec) return out;
+    uint64_t desired_start = fsize > max_bytes ? fsize - max_bytes : 0;
 
-    std::ifstream in(file, std::ios::binary);
-    if (!in) return out;
-
-    in.seekg(0, std::ios::end);
-    std::streamoff end = in.tellg();
-    std::streamoff start = end - (std::streamoff)max_bytes;
-    if (start < 0) start = 0;
-    in.seekg(start, std::ios::beg);
-
-    std::string buf;
-    buf.assign((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
-
-    std::vector<std::string> lines;
-    std::string cur;
-    for (char c : buf) {
-        if (c == '\n') {
-            lines.push_back(cur);
-            cur.clear();
-        } else if (c != '\r') {
-            cur.push_back(c);
+    if (g_tail_cursors.size() > 64) g_tail_cursors.clear();  // crude cap
+    TailCursor& cur = g_tail_cursors[file.string()];
+    if (cur.end_off > fsize || desired_start < cur.start_off) {
+        // Stale (rotated/truncated) or the caller wants a wider window than
+        // the cursor covers: start over from the window edge.
+        cur.lines.clear();
+        cur.start_off = desired_start;
+        cur.end_off = desired_start;
+    }
+    if (cur.lines.empty() && cur.end_off < desired_start) {
+        // Fresh cursor on a large file: skip straight to the window.
+        cur.start_off = desired_start;
+        cur.end_off = desired_start;
+    }
+
+    // Parse only the bytes appended since the last call. The trailing
+    // partial line (no newline yet) is returned but never cached.
+    std::string tailpart;
+    if (cur.end_off < fsize) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in) return out;
+        in.seekg((std::streamoff)cur.end_off, std::ios::beg);
+        std::string buf((std::istreambuf_iterator<char>(in)),
+                        std::istreambuf_iterator<char>());
+        size_t s = 0;
+        while (s < buf.size()) {
+            size_t nl = buf.find('\n', s);
+            if (nl == std::string::npos) {
+                tailpart = buf.substr(s);
+                if (!tailpart.empty() && tailpart.back() == '\r') tailpart.pop_back();
+                break;
+            }
+            std::string line = buf.substr(s, nl - s);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            cur.lines.emplace_back(cur.end_off + s, std::move(line));
+            s = nl + 1;
         }
+        cur.end_off += (uint64_t)s;
     }
-    if (!cur.empty()) lines.push_back(cur);
 
-    for (auto it = lines.rbegin(); it != lines.rend(); ++it) {
-        if (!needle.empty() && it->find(needle) == std::string::npos) continue;
-        out.push_back(*it);
+    // Age lines out of the window as the file grows past max_bytes.
+    while (!cur.lines.empty() && cur.lines.front().first < desired_start) {
+        cur.lines.pop_front();
+    }
+    cur.start_off = desired_start;
+
+    if (!tailpart.empty() &&
+        (needle.empty() || tailpart.find(needle) != std::string::npos)) {
+        out.push_back(tailpart);
+    }
+    for (auto it = cur.lines.rbegin(); it != cur.lines.rend(); ++it) {
         if (out.size() >= limit) break;
+        if (!needle.empty() && it->second.find(needle) == std::string::npos) continue;
+        out.push_back(it->second);
     }
 
     return out;
 }
 
-inline std::vector<std::string> tokenize_lower(const std::string& s) {
-    std::vector<std::string> out;
-    std::string cur;
-    cur.reserve(32);
-    auto flush = [&]() {
-        if (cur.size() >= 2) out.push_back(cur);
-        cur.clear();
-    };
-    for (unsigned char uc : s) {
-        char c = (char)uc;
-        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
-            cur.push_back((char)std::tolower(uc));
-        } else if (c >= '0' && c <= '9') {
-            cur.push_back(c);
-        } else {
-            flush();
+inline bool is_token_byte(unsigned char c) {
+    return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+}
+
+#if defined(__SSE2__)
+// Bitmask of token bytes (alnum) for 16 input bytes. Bytes >= 0x80 are
+// negative in the signed compares and classify as separators, matching the
+// scalar path.
+inline uint32_t token_mask16(const char* p) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                  _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), lower));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), v));
+    return (uint32_t)_mm_movemask_epi8(_mm_or_si128(alpha, digit));
+}
+#endif
+
+// Calls fn(start, end) for every maximal alnum run in [p, p+n). On x86 the
+// separator skip and run scan advance 16 bytes per compare via SSE2 byte
+// masks; elsewhere it falls back to the scalar classifier.
+template <typename Fn>
+inline void for_each_token_run(const char* p, size_t n, const Fn& fn) {
+    size_t i = 0;
+    while (i < n) {
+        // Skip separators to the next token byte.
+#if defined(__SSE2__)
+        while (i + 16 <= n) {
+            uint32_t m = token_mask16(p + i);
+            if (m) { i += (size_t)__builtin_ctz(m); break; }
+            i += 16;
         }
-        if (cur.size() > 64) flush();
+#endif
+        while (i < n && !is_token_byte((unsigned char)p[i])) i++;
+        if (i >= n) break;
+        size_t start = i;
+        // Scan to the end of the run.
+#if defined(__SSE2__)
+        while (i + 16 <= n) {
+            uint32_t m = token_mask16(p + i);
+            if (m != 0xFFFFu) { i += (size_t)__builtin_ctz(~m); goto run_end; }
+            i += 16;
+        }
+#endif
+        while (i < n && is_token_byte((unsigned char)p[i])) i++;
+#if defined(__SSE2__)
+    run_end:
+#endif
+        fn(start, i);
+    }
+}
+
+// Lowercases [start, end) of src into dst (letters only; digits unchanged).
+inline void lower_into(const char* src, size_t start, size_t end, char* dst) {
+    for (size_t j = start; j < end; j++) {
+        char c = src[j];
+        dst[j - start] = (c >= 'A' && c <= 'Z') ? (char)(c | 0x20) : c;
+    }
+}
+
+// Splits one alnum run into tokens under the historical rules: chunks of 65
+// bytes, final piece dropped when shorter than 2.
+template <typename Emit>
+inline void emit_token_chunks(size_t start, size_t end, const Emit& emit) {
+    while (start < end) {
+        size_t len = std::min<size_t>(end - start, 65);
+        if (len >= 2) emit(start, start + len);
+        start += len;
     }
-    flush();
+}
+
+inline std::vector<std::string> tokenize_lower(const std::string& s) {
+    std::vector<std::string> out;
+    for_each_token_run(s.data(), s.size(), [&](size_t b, size_t e) {
+        emit_token_chunks(b, e, [&](size_t tb, size_t te) {
+            std::string tok(te - tb, '\0');
+            lower_into(s.data(), tb, te, tok.data());
+            out.push_back(std::move(tok));
+        });
+    });
+    return out;
+}
+
+// Like tokenize_lower, but tokens are views into arena storage so a line
+// scan makes no per-token heap allocations. Same token rules (alnum runs,
+// lowercased, length 2..65).
+inline std::vector<std::string_view> tokenize_lower_arena(const std::string& s, Arena* arena) {
+    std::vector<std::string_view> out;
+    for_each_token_run(s.data(), s.size(), [&](size_t b, size_t e) {
+        emit_token_chunks(b, e, [&](size_t tb, size_t te) {
+            char* dst = static_cast<char*>(arena->alloc(te - tb, 1));
+            lower_into(s.data(), tb, te, dst);
+            out.push_back(std::string_view(dst, te - tb));
+        });
+    });
     return out;
 }
 
@@ -13,7 +13,7 @@ ToolResult tool_ask_sup(const std::string& input_json, DSState& ds_tmp) {
     a.provenance = "ask_sup";
     a.content_json = input_json;
     a.size_bytes = input_json.size();
-    ds_tmp.slots[(uint8_t)DSSlot::DS1] = a;
+    ds_tmp.slots[(uint8_t)DSSlot::DS1] = std::move(a);
     return {StepStatus::OK, input_json, ""};
 }
 
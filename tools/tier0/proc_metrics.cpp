@@ -1,8 +1,14 @@
 #include "tools/tier0/proc_metrics.h"
 
+#include "machina/gpu_sampler.h"
+#include "machina/json_mini.h"
+#include "machina/tool_metrics.h"
 #include "machina/tools.h"
+#include "machina/trace.h"
 
+#include <chrono>
 #include <cstdint>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
@@ -65,6 +71,28 @@ ToolResult tool_proc_self_metrics(const std::string& input_json, DSState& ds_tmp
     out << "\"vmsize_kb\":" << vmsize_kb << ",";
     out << "\"threads\":" << threads << ",";
     out << "\"open_fds\":" << open_fds;
+
+    // When the background GPU sampler is publishing, fold its latest
+    // snapshot in so one probe covers both host and device health.
+    {
+        int64_t ttl_ms = 10000;
+        if (const char* v = std::getenv("MACHINA_GPU_SNAPSHOT_TTL_MS")) {
+            try { ttl_ms = std::stoll(v); } catch (...) {}
+        }
+        const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        GpuSnapshot s;
+        if (ttl_ms > 0 && gpu_snapshot_read(&s) && gpu_snapshot_fresh(s, now, ttl_ms)) {
+            out << ",\"gpu\":{";
+            out << "\"available\":" << (s.available ? "true" : "false") << ",";
+            out << "\"memory_used_mb\":" << s.memory_used_mb << ",";
+            out << "\"memory_total_mb\":" << s.memory_total_mb << ",";
+            out << "\"temp_c\":" << s.temp_c << ",";
+            out << "\"power_w\":" << (s.power_mw / 1000.0) << ",";
+            out << "\"sample_age_ms\":" << (now - s.sample_ms);
+            out << "}";
+        }
+    }
     out << "}";
     return {StepStatus::OK, out.str(), ""};
 #else
@@ -72,4 +100,14 @@ ToolResult tool_proc_self_metrics(const std::string& input_json, DSState& ds_tmp
 #endif
 }
 
+ToolResult tool_tool_metrics(const std::string& input_json, DSState& ds_tmp) {
+    (void)ds_tmp;
+    // {"trace":true} snapshots the step-path span histograms instead of the
+    // per-tool counters (see machina/trace.h).
+    if (json_mini::get_bool(input_json, "trace").value_or(false)) {
+        return {StepStatus::OK, trace_json(), ""};
+    }
+    return {StepStatus::OK, tool_metrics_json(), ""};
+}
+
 } // namespace machina
@@ -10,4 +10,8 @@ struct ToolResult;
 // Linux-only: returns process RSS/open_fds/threads to help spot leaks.
 ToolResult tool_proc_self_metrics(const std::string& input_json, DSState& ds_tmp);
 
+// Snapshot of the per-tool execution metrics (counters, latency histograms,
+// process rusage) collected by ToolRunner — see machina/tool_metrics.h.
+ToolResult tool_tool_metrics(const std::string& input_json, DSState& ds_tmp);
+
 } // namespace machina
@@ -1,27 +1,22 @@
 #include "machina/tools.h"
+#include "machina/fast_rand.h"
 #include "machina/json_mini.h"
+#include "machina/path_guard.h"
 
 #include <chrono>
 #include <cctype>
+#include <cstdint>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
-#include <random>
 #include <sstream>
 #include <string>
 
 namespace {
 
 static bool is_path_under(const std::filesystem::path& p, const std::filesystem::path& root) {
-    std::error_code ec;
-    auto rp = std::filesystem::weakly_canonical(p, ec);
-    if (ec) return false;
-    auto rr = std::filesystem::weakly_canonical(root, ec);
-    if (ec) return false;
-    auto ps = rp.generic_string();
-    auto rs = rr.generic_string();
-    if (ps == rs) return true;
-    if (!rs.empty() && rs.back() != '/') rs.push_back('/');
-    return ps.rfind(rs, 0) == 0;
+    // Cached canonicalization; see machina/path_guard.h.
+    return machina::path_is_under(p, root);
 }
 
 static int64_t now_ms() {
@@ -40,16 +35,7 @@ static std::string pad4(int v) {
 }
 
 static std::string rand_hex8() {
-    std::random_device rd;
-    std::mt19937 rng(rd());
-    std::uniform_int_distribution<uint32_t> dist(0, 0xffffffffu);
-    uint32_t v = dist(rng);
-    std::ostringstream oss;
-    oss << std::hex;
-    oss.width(8);
-    oss.fill('0');
-    oss << v;
-    return oss.str();
+    return machina::fast_rand_hex(4);
 }
 
 static std::string patch_queue_meta(const std::string& req_json,
@@ -73,6 +59,20 @@ static std::string patch_queue_meta(const std::string& req_json,
     return out;
 }
 
+// Inbox shard subdirectory for a job file: two hex chars of an FNV-1a
+// hash of the name. Keep in sync with inbox_shard_path in
+// runner/runner_utils.cpp, which is what the consumers scan.
+static std::filesystem::path inbox_shard(const std::filesystem::path& inbox, const std::string& fname) {
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : fname) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    char sh[3];
+    std::snprintf(sh, sizeof(sh), "%02x", (unsigned)(h & 0xff));
+    return inbox / sh / fname;
+}
+
 static std::filesystem::path default_queue_root() {
     std::filesystem::path root = std::filesystem::current_path();
     if (const char* e = std::getenv("MACHINA_ROOT")) root = std::filesystem::path(e);
@@ -160,7 +160,7 @@ ToolResult tool_queue_enqueue(const std::string& input_json, DSState& ds_tmp) {
         fname = std::string("p") + pad4(priority) + "_" + fname;
     }
 
-    std::filesystem::path outp = inbox / fname;
+    std::filesystem::path outp = inbox_shard(inbox, fname);
     if (delay_ms > 0) {
         std::string pf = std::string("retry_") + std::to_string(*next_run_at_ms) + "_" + fname;
         outp = retry / pf;
@@ -191,8 +191,9 @@ ToolResult tool_queue_enqueue(const std::string& input_json, DSState& ds_tmp) {
     payload << "}";
     a.content_json = payload.str();
     a.size_bytes = a.content_json.size();
-    ds_tmp.slots[(uint8_t)DSSlot::DS0] = a;
-    return {StepStatus::OK, a.content_json, ""};
+    ToolResult r{StepStatus::OK, a.content_json, ""};
+    ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+    return r;
 }
 
 } // namespace machina
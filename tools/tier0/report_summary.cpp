@@ -42,9 +42,9 @@ ToolResult tool_report_summary(const std::string& input_json, DSState& ds_tmp) {
 
     a.content_json = payload.str();
     a.size_bytes = a.content_json.size();
-    ds_tmp.slots[(uint8_t)DSSlot::DS2] = a;
-
-    return {StepStatus::OK, a.content_json, ""};
+    ToolResult r{StepStatus::OK, a.content_json, ""};
+    ds_tmp.slots[(uint8_t)DSSlot::DS2] = std::move(a);
+    return r;
 }
 
 } // namespace machina
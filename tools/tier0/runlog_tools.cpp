@@ -1,5 +1,7 @@
 #include "machina/tools.h"
+#include "machina/hash.h"
 #include "machina/json_mini.h"
+#include "machina/path_guard.h"
 
 #include <filesystem>
 #include <fstream>
@@ -28,16 +30,8 @@ static std::string resolve_file_best_effort(const std::string& input_path) {
 }
 
 static bool is_path_under(const std::filesystem::path& p, const std::filesystem::path& root) {
-    std::error_code ec;
-    auto rp = std::filesystem::weakly_canonical(p, ec);
-    if (ec) return false;
-    auto rr = std::filesystem::weakly_canonical(root, ec);
-    if (ec) return false;
-    auto ps = rp.generic_string();
-    auto rs = rr.generic_string();
-    if (ps == rs) return true;
-    if (!rs.empty() && rs.back() != '/') rs.push_back('/');
-    return ps.rfind(rs, 0) == 0;
+    // Cached canonicalization; see machina/path_guard.h.
+    return machina::path_is_under(p, root);
 }
 
 struct ToolAgg {
@@ -47,15 +41,129 @@ struct ToolAgg {
     int max_ms{0};
 };
 
+// Aggregation state for incremental summaries: everything the payload is
+// rendered from, plus the byte offset of the first unconsumed line.
+// Persisted as JSON under work/runlog_summary_state/ keyed by resolved
+// path, same publish discipline as the error_scan offsets (tmp + rename).
+struct SummaryState {
+    long long offset{0};
+    long long lines{0};
+    long long bytes{0};
+    std::string run_id;
+    std::string spec_version;
+    std::string first_ts, last_ts;
+    std::string prev_chain_hash;
+    bool chain_links_ok{true};
+    int chain_link_errors{0};
+    std::unordered_map<std::string, int> event_counts;
+    std::unordered_map<std::string, ToolAgg> tool_agg;
+};
+
+static std::filesystem::path summary_state_path(const std::string& resolved) {
+    namespace fs = std::filesystem;
+    fs::path root = fs::path(std::getenv("MACHINA_ROOT") ? std::getenv("MACHINA_ROOT") : ".");
+    return root / "work" / "runlog_summary_state" /
+        (machina::hash::hex64(machina::hash::fnv1a64(resolved)) + ".json");
+}
+
+static bool summary_state_load(const std::filesystem::path& p, SummaryState* st) {
+    using namespace machina;
+    std::ifstream f(p);
+    if (!f) return false;
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    std::string j = ss.str();
+    json_mini::Cursor c(j);
+    if (c.get_int("v").value_or(0) != 1) return false;
+    st->offset = c.get_int("offset").value_or(0);
+    st->lines = c.get_int("lines").value_or(0);
+    st->bytes = c.get_int("bytes").value_or(0);
+    st->run_id = c.get_string("run_id").value_or("");
+    st->spec_version = c.get_string("spec_version").value_or("");
+    st->first_ts = c.get_string("first_ts").value_or("");
+    st->last_ts = c.get_string("last_ts").value_or("");
+    st->prev_chain_hash = c.get_string("prev_chain_hash").value_or("");
+    st->chain_links_ok = c.get_bool("chain_links_ok").value_or(true);
+    st->chain_link_errors = (int)c.get_int("chain_link_errors").value_or(0);
+    for (const auto& ej : json_mini::parse_array_objects_raw(c.get_array_raw("events").value_or("[]"))) {
+        auto ev = json_mini::get_string(ej, "event").value_or("");
+        if (!ev.empty()) st->event_counts[ev] = (int)json_mini::get_int(ej, "count").value_or(0);
+    }
+    for (const auto& tj : json_mini::parse_array_objects_raw(c.get_array_raw("tools").value_or("[]"))) {
+        auto aid = json_mini::get_string(tj, "aid").value_or("");
+        if (aid.empty()) continue;
+        ToolAgg& a = st->tool_agg[aid];
+        a.ok = (int)json_mini::get_int(tj, "ok").value_or(0);
+        a.err = (int)json_mini::get_int(tj, "error").value_or(0);
+        a.total_ms = (long long)json_mini::get_int(tj, "total_ms").value_or(0);
+        a.max_ms = (int)json_mini::get_int(tj, "max_ms").value_or(0);
+    }
+    return true;
+}
+
+static void summary_state_save(const std::filesystem::path& p, const SummaryState& st) {
+    using namespace machina;
+    std::error_code ec;
+    std::filesystem::create_directories(p.parent_path(), ec);
+    std::filesystem::path tmp = p;
+    tmp += ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::trunc);
+        if (!f) return;
+        f << "{\"v\":1,"
+          << "\"offset\":" << st.offset << ","
+          << "\"lines\":" << st.lines << ","
+          << "\"bytes\":" << st.bytes << ","
+          << "\"run_id\":\"" << json_mini::json_escape(st.run_id) << "\","
+          << "\"spec_version\":\"" << json_mini::json_escape(st.spec_version) << "\","
+          << "\"first_ts\":\"" << json_mini::json_escape(st.first_ts) << "\","
+          << "\"last_ts\":\"" << json_mini::json_escape(st.last_ts) << "\","
+          << "\"prev_chain_hash\":\"" << json_mini::json_escape(st.prev_chain_hash) << "\","
+          << "\"chain_links_ok\":" << (st.chain_links_ok ? "true" : "false") << ","
+          << "\"chain_link_errors\":" << st.chain_link_errors << ","
+          << "\"events\":[";
+        bool first = true;
+        for (const auto& kv : st.event_counts) {
+            if (!first) f << ",";
+            first = false;
+            f << "{\"event\":\"" << json_mini::json_escape(kv.first) << "\",\"count\":" << kv.second << "}";
+        }
+        f << "],\"tools\":[";
+        first = true;
+        for (const auto& kv : st.tool_agg) {
+            if (!first) f << ",";
+            first = false;
+            f << "{\"aid\":\"" << json_mini::json_escape(kv.first) << "\","
+              << "\"ok\":" << kv.second.ok << ","
+              << "\"error\":" << kv.second.err << ","
+              << "\"total_ms\":" << kv.second.total_ms << ","
+              << "\"max_ms\":" << kv.second.max_ms << "}";
+        }
+        f << "]}";
+    }
+    std::filesystem::rename(tmp, p, ec);
+}
+
 } // namespace
 
 namespace machina {
 
 // AID.RUN.LOG.SUMMARY.v1
+//
+// "incremental":true persists the full aggregation state per resolved
+// path under work/runlog_summary_state/ and folds in only lines appended
+// since the previous call, so a cron that summarizes a growing log every
+// minute pays for the new events instead of the whole history. Only
+// complete lines are consumed in that mode (a partial tail waits for its
+// newline) and the reported lines/bytes/counts are cumulative.
+// "full":true rescans from byte zero and rewrites the state.
 ToolResult tool_run_log_summary(const std::string& input_json, DSState& ds_tmp) {
-    auto path_raw = json_mini::get_string(input_json, "path").value_or("");
-    int max_lines = (int)json_mini::get_int(input_json, "max_lines").value_or(200000);
-    long long max_bytes = (long long)json_mini::get_int(input_json, "max_bytes").value_or(8ll * 1024ll * 1024ll);
+    json_mini::Cursor in(input_json);
+    auto path_raw = in.get_string("path").value_or("");
+    int max_lines = (int)in.get_int("max_lines").value_or(200000);
+    long long max_bytes = (long long)in.get_int("max_bytes").value_or(8ll * 1024ll * 1024ll);
+    bool full = in.get_bool("full").value_or(false);
+    bool incremental = in.get_bool("incremental").value_or(false) && !full;
 
     if (path_raw.empty()) return {StepStatus::TOOL_ERROR, "{}", "missing path"};
     if (max_lines < 1) max_lines = 1;
@@ -76,51 +184,57 @@ ToolResult tool_run_log_summary(const std::string& input_json, DSState& ds_tmp)
     std::ifstream f(resolved);
     if (!f) return {StepStatus::TOOL_ERROR, "{}", "cannot open log file: " + path_raw};
 
-    std::unordered_map<std::string, int> event_counts;
-    std::unordered_map<std::string, ToolAgg> tool_agg;
-
-    std::string run_id;
-    std::string spec_version;
-    std::string first_ts, last_ts;
-
-    std::string prev_chain_hash;
-    bool chain_links_ok = true;
-    int chain_link_errors = 0;
+    SummaryState st;
+    fs::path spath = summary_state_path(resolved);
+    if (incremental && summary_state_load(spath, &st)) {
+        std::error_code ec;
+        auto fsize = fs::file_size(rp, ec);
+        // Truncated or rotated file: the saved offset no longer points at
+        // line starts, so start the aggregation over.
+        if (ec || st.offset > (long long)fsize) st = SummaryState{};
+    }
+    if (st.offset > 0) f.seekg(st.offset);
 
     std::string line;
-    int lines = 0;
-    long long bytes = 0;
+    int call_lines = 0;
+    long long call_bytes = 0;
 
     while (std::getline(f, line)) {
-        lines++;
-        bytes += (long long)line.size() + 1;
-        if (lines > max_lines) break;
-        if (bytes > max_bytes) break;
+        // getline hitting EOF means the line had no trailing newline yet;
+        // in incremental mode leave it for the call that sees it complete.
+        if (incremental && f.eof()) break;
+        if (call_lines + 1 > max_lines) break;
+        if (call_bytes + (long long)line.size() + 1 > max_bytes) break;
+        call_lines++;
+        call_bytes += (long long)line.size() + 1;
+        st.lines++;
+        st.bytes += (long long)line.size() + 1;
+        st.offset += (long long)line.size() + 1;
         if (line.empty()) continue;
 
         auto ev = json_mini::get_string(line, "event").value_or("");
-        if (!ev.empty()) event_counts[ev]++;
+        if (!ev.empty()) st.event_counts[ev]++;
 
         auto rid = json_mini::get_string(line, "run_id");
-        if (rid && run_id.empty()) run_id = *rid;
+        if (rid && st.run_id.empty()) st.run_id = *rid;
 
         auto sv = json_mini::get_string(line, "spec_version");
-        if (sv && spec_version.empty()) spec_version = *sv;
+        if (sv && st.spec_version.empty()) st.spec_version = *sv;
 
         auto ts = json_mini::get_string(line, "ts");
         if (ts) {
-            if (first_ts.empty()) first_ts = *ts;
-            last_ts = *ts;
+            if (st.first_ts.empty()) st.first_ts = *ts;
+            st.last_ts = *ts;
         }
 
         auto chain_prev = json_mini::get_string(line, "chain_prev").value_or("");
         auto chain_hash = json_mini::get_string(line, "chain_hash").value_or("");
         if (!chain_hash.empty()) {
-            if (!prev_chain_hash.empty() && chain_prev != prev_chain_hash) {
-                chain_links_ok = false;
-                chain_link_errors++;
+            if (!st.prev_chain_hash.empty() && chain_prev != st.prev_chain_hash) {
+                st.chain_links_ok = false;
+                st.chain_link_errors++;
             }
-            prev_chain_hash = chain_hash;
+            st.prev_chain_hash = chain_hash;
         }
 
         if (ev == "tool_ok" || ev == "tool_error") {
@@ -128,7 +242,7 @@ ToolResult tool_run_log_summary(const std::string& input_json, DSState& ds_tmp)
             auto aid = json_mini::get_string(payload_raw, "aid").value_or("");
             int dur = (int)json_mini::get_int(payload_raw, "duration_ms").value_or(0);
             if (!aid.empty()) {
-                auto& a = tool_agg[aid];
+                auto& a = st.tool_agg[aid];
                 if (ev == "tool_ok") a.ok++; else a.err++;
                 a.total_ms += dur;
                 if (dur > a.max_ms) a.max_ms = dur;
@@ -136,10 +250,12 @@ ToolResult tool_run_log_summary(const std::string& input_json, DSState& ds_tmp)
         }
     }
 
+    if (incremental || full) summary_state_save(spath, st);
+
     // Render event counts as array (stable-ish order)
     std::vector<std::pair<std::string,int>> evs;
-    evs.reserve(event_counts.size());
-    for (const auto& kv : event_counts) evs.push_back(kv);
+    evs.reserve(st.event_counts.size());
+    for (const auto& kv : st.event_counts) evs.push_back(kv);
     std::sort(evs.begin(), evs.end(), [](auto& a, auto& b){
         if (a.second != b.second) return a.second > b.second;
         return a.first < b.first;
@@ -147,8 +263,8 @@ ToolResult tool_run_log_summary(const std::string& input_json, DSState& ds_tmp)
 
     struct ToolRow { std::string aid; ToolAgg agg; };
     std::vector<ToolRow> tools;
-    tools.reserve(tool_agg.size());
-    for (const auto& kv : tool_agg) tools.push_back({kv.first, kv.second});
+    tools.reserve(st.tool_agg.size());
+    for (const auto& kv : st.tool_agg) tools.push_back({kv.first, kv.second});
     std::sort(tools.begin(), tools.end(), [](const ToolRow& a, const ToolRow& b){
         if (a.agg.total_ms != b.agg.total_ms) return a.agg.total_ms > b.agg.total_ms;
         if (a.agg.err != b.agg.err) return a.agg.err > b.agg.err;
@@ -160,14 +276,16 @@ ToolResult tool_run_log_summary(const std::string& input_json, DSState& ds_tmp)
     payload << "\"ok\":true,";
     payload << "\"path\":\"" << json_mini::json_escape(path_raw) << "\",";
     payload << "\"resolved\":\"" << json_mini::json_escape(resolved) << "\",";
-    payload << "\"run_id\":\"" << json_mini::json_escape(run_id) << "\",";
-    payload << "\"spec_version\":\"" << json_mini::json_escape(spec_version) << "\",";
-    payload << "\"first_ts\":\"" << json_mini::json_escape(first_ts) << "\",";
-    payload << "\"last_ts\":\"" << json_mini::json_escape(last_ts) << "\",";
-    payload << "\"lines\":" << lines << ",";
-    payload << "\"bytes\":" << bytes << ",";
-    payload << "\"chain_links_ok\":" << (chain_links_ok ? "true" : "false") << ",";
-    payload << "\"chain_link_errors\":" << chain_link_errors << ",";
+    payload << "\"run_id\":\"" << json_mini::json_escape(st.run_id) << "\",";
+    payload << "\"spec_version\":\"" << json_mini::json_escape(st.spec_version) << "\",";
+    payload << "\"first_ts\":\"" << json_mini::json_escape(st.first_ts) << "\",";
+    payload << "\"last_ts\":\"" << json_mini::json_escape(st.last_ts) << "\",";
+    payload << "\"lines\":" << st.lines << ",";
+    payload << "\"bytes\":" << st.bytes << ",";
+    payload << "\"incremental\":" << (incremental ? "true" : "false") << ",";
+    payload << "\"scanned_bytes\":" << call_bytes << ",";
+    payload << "\"chain_links_ok\":" << (st.chain_links_ok ? "true" : "false") << ",";
+    payload << "\"chain_link_errors\":" << st.chain_link_errors << ",";
     payload << "\"events\":[";
     for (size_t i=0;i<evs.size();i++){
         if (i) payload << ",";
@@ -197,8 +315,9 @@ ToolResult tool_run_log_summary(const std::string& input_json, DSState& ds_tmp)
     a.content_json = payload.str();
     a.size_bytes = a.content_json.size();
 
-    ds_tmp.slots[(uint8_t)DSSlot::DS0] = a;
-    return {StepStatus::OK, a.content_json, ""};
+    ToolResult r{StepStatus::OK, a.content_json, ""};
+    ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+    return r;
 }
 
 } // namespace machina
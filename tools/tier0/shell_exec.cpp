@@ -1,5 +1,6 @@
 #include "machina/tools.h"
 #include "machina/json_mini.h"
+#include "machina/path_guard.h"
 #include "machina/proc.h"
 
 #include <algorithm>
@@ -42,16 +43,8 @@ static std::vector<std::string> split_csv(const std::string& s) {
 }
 
 static bool is_path_under(const std::filesystem::path& p, const std::filesystem::path& root) {
-    std::error_code ec;
-    auto rp = std::filesystem::weakly_canonical(p, ec);
-    if (ec) return false;
-    auto rr = std::filesystem::weakly_canonical(root, ec);
-    if (ec) return false;
-    auto ps = rp.generic_string();
-    auto rs = rr.generic_string();
-    if (ps == rs) return true;
-    if (!rs.empty() && rs.back() != '/') rs.push_back('/');
-    return ps.rfind(rs, 0) == 0;
+    // Cached canonicalization; see machina/path_guard.h.
+    return machina::path_is_under(p, root);
 }
 
 static int getenv_int(const char* name, int defv) {
@@ -146,9 +139,9 @@ ToolResult tool_shell_exec(const std::string& input_json, DSState& ds_tmp) {
     payload << "}";
 
     a.content_json = payload.str();
-    ds_tmp.slots[(uint8_t)DSSlot::DS0] = a;
-
-    return {StepStatus::OK, a.content_json, ""};
+    ToolResult r{StepStatus::OK, a.content_json, ""};
+    ds_tmp.slots[(uint8_t)DSSlot::DS0] = std::move(a);
+    return r;
 #endif
 }
 
@@ -0,0 +1,122 @@
+#pragma once
+
+// Generated by scripts/gen_tier0_descs.py from toolpacks/tier0/manifest.json.
+// Do not edit by hand; re-run the script after changing the manifest.
+//
+// Compile-time copy of the tier0 tool descriptors. The runner uses it
+// instead of parsing the manifest JSON whenever the on-disk manifest
+// still hashes to kManifestFnv1a64 below (see load_tier0_descs in
+// runner/tool_setup.cpp); on mismatch it falls back to the parser, so
+// the manifest stays the source of truth.
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace machina::tier0_descs {
+
+struct StaticToolDesc {
+    std::string_view aid;
+    std::string_view name;
+    bool deterministic;
+    const std::string_view* tags;
+    size_t tag_count;
+    const std::string_view* side_effects;
+    size_t side_effect_count;
+    const std::string_view* replay_inputs;
+    size_t replay_input_count;
+};
+
+inline constexpr std::string_view kTags0[] = {"tag.log", "tag.scan", "tag.error"};
+inline constexpr std::string_view kSideEffects0[] = {"filesystem_read"};
+inline constexpr std::string_view kReplayInputs0[] = {"input_path_fingerprint"};
+inline constexpr std::string_view kTags1[] = {"tag.fs", "tag.meta"};
+inline constexpr std::string_view kSideEffects1[] = {"filesystem_read"};
+inline constexpr std::string_view kReplayInputs1[] = {"path_fingerprint"};
+inline constexpr std::string_view kTags2[] = {"tag.fs", "tag.meta"};
+inline constexpr std::string_view kSideEffects2[] = {"filesystem_write"};
+inline constexpr std::string_view kTags3[] = {"tag.shell", "tag.meta"};
+inline constexpr std::string_view kSideEffects3[] = {"process_spawn"};
+inline constexpr std::string_view kTags4[] = {"tag.net", "tag.meta"};
+inline constexpr std::string_view kSideEffects4[] = {"process_spawn", "network_io"};
+inline constexpr std::string_view kTags5[] = {"tag.meta"};
+inline constexpr std::string_view kSideEffects5[] = {"none"};
+inline constexpr std::string_view kTags6[] = {"tag.meta", "tag.gpu"};
+inline constexpr std::string_view kSideEffects6[] = {"gpu_probe"};
+inline constexpr std::string_view kReplayInputs6[] = {"gpu_signature"};
+inline constexpr std::string_view kTags7[] = {"tag.meta", "tag.gpu"};
+inline constexpr std::string_view kSideEffects7[] = {"gpu_probe"};
+inline constexpr std::string_view kReplayInputs7[] = {"gpu_signature"};
+inline constexpr std::string_view kTags8[] = {"tag.meta", "tag.debug", "tag.ops"};
+inline constexpr std::string_view kSideEffects8[] = {"process_introspection"};
+inline constexpr std::string_view kTags9[] = {"tag.meta", "tag.debug", "tag.ops"};
+inline constexpr std::string_view kSideEffects9[] = {"process_introspection"};
+inline constexpr std::string_view kTags10[] = {"tag.report", "tag.error"};
+inline constexpr std::string_view kSideEffects10[] = {"none"};
+inline constexpr std::string_view kTags11[] = {"tag.memory", "tag.fs", "tag.meta"};
+inline constexpr std::string_view kSideEffects11[] = {"filesystem_write"};
+inline constexpr std::string_view kTags12[] = {"tag.memory", "tag.fs", "tag.meta"};
+inline constexpr std::string_view kSideEffects12[] = {"filesystem_read"};
+inline constexpr std::string_view kTags13[] = {"tag.memory", "tag.fs", "tag.meta"};
+inline constexpr std::string_view kSideEffects13[] = {"filesystem_read"};
+inline constexpr std::string_view kTags14[] = {"tag.embed", "tag.meta"};
+inline constexpr std::string_view kSideEffects14[] = {"proc_exec"};
+inline constexpr std::string_view kTags15[] = {"tag.embed", "tag.meta"};
+inline constexpr std::string_view kSideEffects15[] = {"proc_exec", "filesystem_write"};
+inline constexpr std::string_view kTags16[] = {"tag.vectordb", "tag.memory", "tag.fs"};
+inline constexpr std::string_view kSideEffects16[] = {"filesystem_write", "proc_exec"};
+inline constexpr std::string_view kTags17[] = {"tag.vectordb", "tag.memory", "tag.fs"};
+inline constexpr std::string_view kSideEffects17[] = {"filesystem_write", "proc_exec"};
+inline constexpr std::string_view kTags18[] = {"tag.vectordb", "tag.memory", "tag.fs"};
+inline constexpr std::string_view kSideEffects18[] = {"filesystem_read", "proc_exec"};
+inline constexpr std::string_view kTags19[] = {"tag.meta", "tag.genesis"};
+inline constexpr std::string_view kSideEffects19[] = {"filesystem_write"};
+inline constexpr std::string_view kTags20[] = {"tag.meta", "tag.genesis"};
+inline constexpr std::string_view kSideEffects20[] = {"process_spawn", "filesystem_write"};
+inline constexpr std::string_view kTags21[] = {"tag.meta", "tag.genesis"};
+inline constexpr std::string_view kSideEffects21[] = {"dynamic_library_load"};
+inline constexpr std::string_view kTags22[] = {"tag.meta", "tag.queue"};
+inline constexpr std::string_view kSideEffects22[] = {"filesystem_write"};
+inline constexpr std::string_view kTags23[] = {"tag.meta"};
+inline constexpr std::string_view kSideEffects23[] = {"none"};
+inline constexpr std::string_view kTags24[] = {"tag.meta", "tag.fs", "tag.debug"};
+inline constexpr std::string_view kSideEffects24[] = {"filesystem_read"};
+inline constexpr std::string_view kReplayInputs24[] = {"path_fingerprint"};
+inline constexpr std::string_view kTags25[] = {"tag.demo", "tag.meta", "tag.missing"};
+inline constexpr std::string_view kSideEffects25[] = {"none"};
+
+inline constexpr StaticToolDesc kTools[] = {
+    {"AID.ERROR_SCAN.v1", "error_scan_csv", true, kTags0, 3, kSideEffects0, 1, kReplayInputs0, 1},
+    {"AID.FILE.READ.v1", "file_read", true, kTags1, 2, kSideEffects1, 1, kReplayInputs1, 1},
+    {"AID.FILE.WRITE.v1", "file_write", false, kTags2, 2, kSideEffects2, 1, nullptr, 0},
+    {"AID.SHELL.EXEC.v1", "shell_exec", false, kTags3, 2, kSideEffects3, 1, nullptr, 0},
+    {"AID.NET.HTTP_GET.v1", "http_get", false, kTags4, 2, kSideEffects4, 2, nullptr, 0},
+    {"AID.ASK_SUP.v1", "ask_user_for_clarification", true, kTags5, 1, kSideEffects5, 1, nullptr, 0},
+    {"AID.GPU_SMOKE.v1", "gpu_smoke", true, kTags6, 2, kSideEffects6, 1, kReplayInputs6, 1},
+    {"AID.GPU_METRICS.v1", "gpu_metrics", true, kTags7, 2, kSideEffects7, 1, kReplayInputs7, 1},
+    {"AID.PROC.SELF_METRICS.v1", "proc_self_metrics", false, kTags8, 3, kSideEffects8, 1, nullptr, 0},
+    {"AID.TOOL.METRICS.v1", "tool_metrics", false, kTags9, 3, kSideEffects9, 1, nullptr, 0},
+    {"AID.REPORT_SUMMARY.v1", "report_summary", true, kTags10, 2, kSideEffects10, 1, nullptr, 0},
+    {"AID.MEMORY.APPEND.v1", "memory_append", false, kTags11, 3, kSideEffects11, 1, nullptr, 0},
+    {"AID.MEMORY.SEARCH.v1", "memory_search", false, kTags12, 3, kSideEffects12, 1, nullptr, 0},
+    {"AID.MEMORY.QUERY.v1", "memory_query", false, kTags13, 3, kSideEffects13, 1, nullptr, 0},
+    {"AID.EMBED.TEXT.v1", "embed_text", false, kTags14, 2, kSideEffects14, 1, nullptr, 0},
+    {"AID.EMBED.BATCH.v1", "embed_batch", false, kTags15, 2, kSideEffects15, 2, nullptr, 0},
+    {"AID.VECDB.UPSERT.v1", "vectordb_upsert", false, kTags16, 3, kSideEffects16, 2, nullptr, 0},
+    {"AID.VECDB.UPSERT_BATCH.v1", "vectordb_upsert_batch", false, kTags17, 3, kSideEffects17, 2, nullptr, 0},
+    {"AID.VECDB.QUERY.v1", "vectordb_query", false, kTags18, 3, kSideEffects18, 2, nullptr, 0},
+    {"AID.GENESIS.WRITE_FILE.v1", "genesis_write_file", false, kTags19, 2, kSideEffects19, 1, nullptr, 0},
+    {"AID.GENESIS.COMPILE_SHARED.v1", "genesis_compile_shared", false, kTags20, 2, kSideEffects20, 2, nullptr, 0},
+    {"AID.GENESIS.LOAD_PLUGIN.v1", "genesis_load_plugin", false, kTags21, 2, kSideEffects21, 1, nullptr, 0},
+    {"AID.QUEUE.ENQUEUE.v1", "queue_enqueue", false, kTags22, 2, kSideEffects22, 1, nullptr, 0},
+    {"AID.NOOP.v1", "noop", true, kTags23, 1, kSideEffects23, 1, nullptr, 0},
+    {"AID.RUN.LOG.SUMMARY.v1", "run_log_summary", true, kTags24, 3, kSideEffects24, 1, kReplayInputs24, 1},
+    {"AID.DEMO.MISSING_TOOL.v1", "demo_missing_tool", true, kTags25, 3, kSideEffects25, 1, nullptr, 0},
+};
+
+inline constexpr size_t kToolCount = sizeof(kTools) / sizeof(kTools[0]);
+
+// FNV-1a64 of the manifest bytes this table was generated from.
+inline constexpr uint64_t kManifestFnv1a64 = 0xAD8C6290184D2676ULL;
+
+} // namespace machina::tier0_descs
@@ -0,0 +1,239 @@
+#include "vectordb_ivf.h"
+#include "vectordb_tools.h"
+
+#include "machina/vec_simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace machina {
+
+namespace {
+
+const char kIvfMagic[4] = {'M', 'I', 'V', 'F'};
+constexpr uint32_t kIvfVersion = 1;
+constexpr size_t kTrainSampleMax = 20000;
+constexpr int kKmeansIters = 6;
+
+std::filesystem::path emb_path(const std::filesystem::path& stream_dir) {
+    return stream_dir / "embeddings.f32";
+}
+
+size_t ivf_min_vecs() {
+    if (const char* e = std::getenv("MACHINA_VECDB_IVF_MIN")) {
+        try { return (size_t)std::stoull(e); } catch (...) {}
+    }
+    return 4096;
+}
+
+template <typename T>
+bool read_pod(std::ifstream& in, T* v) {
+    in.read(reinterpret_cast<char*>(v), (std::streamsize)sizeof(T));
+    return in.gcount() == (std::streamsize)sizeof(T);
+}
+
+bool ivf_save(const std::filesystem::path& stream_dir, const IvfIndex& ivf) {
+    auto final_path = ivf_index_path(stream_dir);
+    auto tmp = std::filesystem::path(final_path.string() + ".tmp");
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.good()) return false;
+        out.write(kIvfMagic, 4);
+        uint32_t version = kIvfVersion;
+        uint32_t dim32 = (uint32_t)ivf.dim;
+        uint32_t k32 = (uint32_t)ivf.k;
+        uint64_t nvecs = ivf.nvecs;
+        out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char*>(&dim32), sizeof(dim32));
+        out.write(reinterpret_cast<const char*>(&k32), sizeof(k32));
+        out.write(reinterpret_cast<const char*>(&nvecs), sizeof(nvecs));
+        out.write(reinterpret_cast<const char*>(ivf.centroids.data()),
+                  (std::streamsize)(ivf.centroids.size() * sizeof(float)));
+        for (const auto& list : ivf.lists) {
+            uint32_t count = (uint32_t)list.size();
+            out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+            out.write(reinterpret_cast<const char*>(list.data()),
+                      (std::streamsize)(list.size() * sizeof(uint32_t)));
+        }
+        if (!out.good()) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, final_path, ec);
+    return !ec;
+}
+
+void l2_normalize_inplace(float* v, size_t dim) {
+    double s = 0.0;
+    for (size_t j = 0; j < dim; j++) s += (double)v[j] * (double)v[j];
+    if (s <= 0.0) return;
+    float inv = (float)(1.0 / std::sqrt(s));
+    for (size_t j = 0; j < dim; j++) v[j] *= inv;
+}
+
+size_t nearest_centroid(const IvfIndex& ivf, const float* v) {
+    size_t best = 0;
+    float best_dot = -1e30f;
+    for (size_t c = 0; c < ivf.k; c++) {
+        float d = vec::dot_f32(v, &ivf.centroids[c * ivf.dim], ivf.dim);
+        if (d > best_dot) { best_dot = d; best = c; }
+    }
+    return best;
+}
+
+// Visits vector idx..: chunked sequential read, calls fn(idx, vec_ptr).
+template <typename Fn>
+bool scan_embeddings(const std::filesystem::path& file, size_t dim,
+                     uint64_t max_vecs, Fn&& fn) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in.good()) return false;
+    const size_t chunk_vecs = 1024;
+    std::vector<float> buf(chunk_vecs * dim);
+    uint64_t idx = 0;
+    while (in.good() && idx < max_vecs) {
+        in.read(reinterpret_cast<char*>(buf.data()),
+                (std::streamsize)(buf.size() * sizeof(float)));
+        std::streamsize got = in.gcount();
+        if (got <= 0) break;
+        size_t vecs = (size_t)(got / (std::streamsize)sizeof(float)) / dim;
+        for (size_t vi = 0; vi < vecs && idx < max_vecs; vi++, idx++) {
+            fn(idx, &buf[vi * dim]);
+        }
+    }
+    return true;
+}
+
+void ivf_train(const std::filesystem::path& stream_dir, size_t dim) {
+    auto ep = emb_path(stream_dir);
+    // Size from committed bytes, not the file length: a preallocated stream
+    // carries a zero tail that must not be trained as vectors.
+    uint64_t fsize = vectordb_committed_bytes(stream_dir, ep);
+    if (fsize == 0 || dim == 0) return;
+    uint64_t nvecs = fsize / (dim * sizeof(float));
+    if (nvecs < ivf_min_vecs()) return;
+
+    IvfIndex ivf;
+    ivf.dim = dim;
+    ivf.nvecs = nvecs;
+    ivf.k = (size_t)std::sqrt((double)nvecs);
+    ivf.k = std::clamp(ivf.k, (size_t)16, (size_t)1024);
+    if (ivf.k > nvecs) ivf.k = (size_t)nvecs;
+
+    // Sample every stride-th vector for training.
+    uint64_t stride = nvecs / kTrainSampleMax;
+    if (stride == 0) stride = 1;
+    std::vector<float> sample;
+    sample.reserve((size_t)(nvecs / stride + 1) * dim);
+    scan_embeddings(ep, dim, nvecs, [&](uint64_t idx, const float* v) {
+        if (idx % stride == 0) sample.insert(sample.end(), v, v + dim);
+    });
+    size_t sample_n = sample.size() / dim;
+    if (sample_n < ivf.k) return;
+
+    // Init centroids from evenly spaced sample vectors.
+    ivf.centroids.resize(ivf.k * dim);
+    for (size_t c = 0; c < ivf.k; c++) {
+        size_t src = c * sample_n / ivf.k;
+        std::memcpy(&ivf.centroids[c * dim], &sample[src * dim], dim * sizeof(float));
+    }
+
+    // Spherical k-means on the sample: assign by max dot, recenter, renormalize.
+    std::vector<double> sums(ivf.k * dim);
+    std::vector<uint32_t> counts(ivf.k);
+    for (int it = 0; it < kKmeansIters; it++) {
+        std::fill(sums.begin(), sums.end(), 0.0);
+        std::fill(counts.begin(), counts.end(), 0u);
+        for (size_t s = 0; s < sample_n; s++) {
+            const float* v = &sample[s * dim];
+            size_t c = nearest_centroid(ivf, v);
+            counts[c]++;
+            double* sum = &sums[c * dim];
+            for (size_t j = 0; j < dim; j++) sum[j] += (double)v[j];
+        }
+        for (size_t c = 0; c < ivf.k; c++) {
+            if (counts[c] == 0) continue;  // keep the old centroid
+            float* ctr = &ivf.centroids[c * dim];
+            for (size_t j = 0; j < dim; j++) {
+                ctr[j] = (float)(sums[c * dim + j] / (double)counts[c]);
+            }
+            l2_normalize_inplace(ctr, dim);
+        }
+    }
+
+    // Full assignment pass builds the posting lists.
+    ivf.lists.assign(ivf.k, {});
+    scan_embeddings(ep, dim, nvecs, [&](uint64_t idx, const float* v) {
+        ivf.lists[nearest_centroid(ivf, v)].push_back((uint32_t)idx);
+    });
+
+    ivf_save(stream_dir, ivf);
+}
+
+std::mutex g_train_mu;
+std::set<std::string> g_training;  // stream dirs with a run in flight
+
+} // namespace
+
+std::filesystem::path ivf_index_path(const std::filesystem::path& stream_dir) {
+    return stream_dir / "ivf.index";
+}
+
+bool ivf_load(const std::filesystem::path& stream_dir, size_t dim, IvfIndex* out) {
+    std::ifstream in(ivf_index_path(stream_dir), std::ios::binary);
+    if (!in.good() || !out) return false;
+
+    char magic[4];
+    in.read(magic, 4);
+    if (in.gcount() != 4 || std::memcmp(magic, kIvfMagic, 4) != 0) return false;
+    uint32_t version = 0, dim32 = 0, k32 = 0;
+    uint64_t nvecs = 0;
+    if (!read_pod(in, &version) || version != kIvfVersion) return false;
+    if (!read_pod(in, &dim32) || (size_t)dim32 != dim) return false;
+    if (!read_pod(in, &k32) || k32 == 0 || k32 > 65536) return false;
+    if (!read_pod(in, &nvecs)) return false;
+
+    out->dim = dim;
+    out->k = k32;
+    out->nvecs = nvecs;
+    out->centroids.resize((size_t)k32 * dim);
+    in.read(reinterpret_cast<char*>(out->centroids.data()),
+            (std::streamsize)(out->centroids.size() * sizeof(float)));
+    if (in.gcount() != (std::streamsize)(out->centroids.size() * sizeof(float))) return false;
+
+    out->lists.assign(out->k, {});
+    for (size_t c = 0; c < out->k; c++) {
+        uint32_t count = 0;
+        if (!read_pod(in, &count)) return false;
+        if ((uint64_t)count > nvecs) return false;
+        out->lists[c].resize(count);
+        in.read(reinterpret_cast<char*>(out->lists[c].data()),
+                (std::streamsize)((size_t)count * sizeof(uint32_t)));
+        if (in.gcount() != (std::streamsize)((size_t)count * sizeof(uint32_t))) return false;
+    }
+    return true;
+}
+
+void ivf_maybe_train_async(const std::filesystem::path& stream_dir, size_t dim,
+                           uint64_t nvecs, uint64_t indexed_nvecs) {
+    if (dim == 0 || nvecs < ivf_min_vecs()) return;
+    if (indexed_nvecs > 0 && nvecs <= indexed_nvecs + indexed_nvecs / 5) return;
+
+    std::string key = stream_dir.string();
+    {
+        std::lock_guard<std::mutex> lk(g_train_mu);
+        if (!g_training.insert(key).second) return;  // already in flight
+    }
+    std::thread([stream_dir, dim, key] {
+        ivf_train(stream_dir, dim);
+        std::lock_guard<std::mutex> lk(g_train_mu);
+        g_training.erase(key);
+    }).detach();
+}
+
+} // namespace machina
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace machina {
+
+// Optional IVF (inverted-file) coarse index for a vectordb stream.
+//
+// Lives as ivf.index next to schema.json: k-means centroids plus per-cluster
+// posting lists of vector indices into embeddings.f32. Queries probe the
+// nprobe closest clusters instead of brute-forcing the whole stream; vectors
+// appended after the index was built (idx >= nvecs) are scanned exactly.
+// Training runs on a detached background thread so neither upserts nor the
+// triggering query pay for it.
+
+struct IvfIndex {
+    size_t dim{0};
+    size_t k{0};          // number of clusters
+    uint64_t nvecs{0};    // vectors covered when the index was built
+    std::vector<float> centroids;             // k * dim, L2-normalized
+    std::vector<std::vector<uint32_t>> lists; // k posting lists of vector indices
+};
+
+// Location of the index file inside a stream directory (for staleness
+// checks by callers that cache loaded indexes).
+std::filesystem::path ivf_index_path(const std::filesystem::path& stream_dir);
+
+// Loads ivf.index from a stream directory. Returns false (out untouched
+// beyond partial reads) when missing, corrupt, or built for another dim.
+bool ivf_load(const std::filesystem::path& stream_dir, size_t dim, IvfIndex* out);
+
+// Kicks off background (re)training when the stream is large enough and the
+// existing index (indexed_nvecs, 0 = none) has fallen behind by >20%.
+// At most one training run per stream directory is in flight at a time.
+void ivf_maybe_train_async(const std::filesystem::path& stream_dir, size_t dim,
+                           uint64_t nvecs, uint64_t indexed_nvecs);
+
+} // namespace machina
@@ -1,27 +1,63 @@
 #include "vectordb_tools.h"
+#include "vectordb_ivf.h"
 #include "machina/tools.h"
 
 
 #include "machina/embedding_provider.h"
 #include "machina/hash.h"
 #include "machina/json_mini.h"
+#include "machina/json_writer.h"
+#include "machina/hugepage.h"
+#include "machina/numa.h"
+#include "machina/thread_pool.h"
+#include "machina/topk.h"
+#include "machina/vec_simd.h"
 
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
-#include <iomanip>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef MACHINA_USE_CUDA
+// GPU scan backend; build only when CUDA is enabled in CMake.
+extern "C" int machina_cuda_vecdb_scan(const char* stream_key, const float* host_vecs,
+                                       long long n, int dim, const float* query,
+                                       float* out_scores);
+extern "C" void machina_cuda_vecdb_invalidate(const char* stream_key);
+#endif
+
 namespace machina {
 
-static std::mutex g_vecdb_mu;
+// Per-stream locks: queries on one stream no longer block upserts on
+// another, and readers of the same stream run concurrently. Entries are
+// never erased, so returned references stay valid for the process lifetime.
+static std::shared_mutex& stream_mu(const std::string& sname) {
+    static std::mutex map_mu;
+    static std::unordered_map<std::string, std::unique_ptr<std::shared_mutex>> locks;
+    std::lock_guard<std::mutex> lk(map_mu);
+    auto& p = locks[sname];
+    if (!p) p = std::make_unique<std::shared_mutex>();
+    return *p;
+}
 
 static int64_t now_ms() {
     using namespace std::chrono;
@@ -55,10 +91,43 @@ static std::filesystem::path vecdb_root() {
     return root / "work" / "vectordb";
 }
 
+// Storage precision for a stream's embeddings. Fixed at stream creation and
+// recorded in schema.json; f16 halves and i8 quarters the footprint so hot
+// streams stay resident in page cache.
+enum class Precision { F32, F16, I8 };
+
+static const char* precision_name(Precision p) {
+    switch (p) {
+        case Precision::F16: return "f16";
+        case Precision::I8: return "i8";
+        default: return "f32";
+    }
+}
+
+static Precision precision_from_name(const std::string& s) {
+    if (s == "f16") return Precision::F16;
+    if (s == "i8") return Precision::I8;
+    return Precision::F32;
+}
+
+// Bytes per stored vector. i8 records carry a per-vector float scale.
+static size_t record_bytes(Precision p, size_t dim) {
+    switch (p) {
+        case Precision::F16: return dim * sizeof(uint16_t);
+        case Precision::I8: return sizeof(float) + dim;
+        default: return dim * sizeof(float);
+    }
+}
+
 struct Schema {
     size_t dim{0};
+    Precision precision{Precision::F32};
 };
 
+// Streams below this size are scanned on the calling thread; above it the
+// brute-force scan fans out over the shared worker pool.
+static constexpr size_t kParallelScanMin = 16384;
+
 static std::filesystem::path schema_path(const std::filesystem::path& stream_dir) {
     return stream_dir / "schema.json";
 }
@@ -79,14 +148,20 @@ static Schema load_or_init_schema(const std::filesystem::path& stream_dir, size_
         if (auto d = json_mini::get_int(raw, "dim")) {
             if (*d > 0) s.dim = (size_t)*d;
         }
+        s.precision = precision_from_name(
+            json_mini::get_string(raw, "precision").value_or("f32"));
     }
     if (s.dim == 0) {
         s.dim = dim_hint;
         if (s.dim == 0) s.dim = getenv_size_t("MACHINA_VECDB_DIM", 384);
         if (s.dim == 0) s.dim = 384;
+        if (const char* e = std::getenv("MACHINA_VECDB_PRECISION")) {
+            s.precision = precision_from_name(e);
+        }
         std::ostringstream out;
         out << "{";
-        out << "\"dim\":" << s.dim;
+        out << "\"dim\":" << s.dim << ",";
+        out << "\"precision\":\"" << precision_name(s.precision) << "\"";
         out << "}";
         std::ofstream o(sp);
         o << out.str();
@@ -94,22 +169,81 @@ static Schema load_or_init_schema(const std::filesystem::path& stream_dir, size_
     return s;
 }
 
-static std::filesystem::path emb_path(const std::filesystem::path& stream_dir) { return stream_dir / "embeddings.f32"; }
+static std::filesystem::path emb_path_p(const std::filesystem::path& stream_dir, Precision p) {
+    switch (p) {
+        case Precision::F16: return stream_dir / "embeddings.f16";
+        case Precision::I8: return stream_dir / "embeddings.i8";
+        default: return stream_dir / "embeddings.f32";
+    }
+}
 static std::filesystem::path meta_path(const std::filesystem::path& stream_dir) { return stream_dir / "meta.jsonl"; }
+// Sidecar offset index: one uint64 byte offset into meta.jsonl per vector
+// index, so query hits are fetched with a seek per hit instead of a full scan.
+static std::filesystem::path meta_idx_path(const std::filesystem::path& stream_dir) { return stream_dir / "meta.idx"; }
+
+// Encodes one vector as stored bytes for the stream's precision.
+// i8 is symmetric with a per-vector float scale prepended to the record.
+static std::string encode_vec(Precision p, const std::vector<float>& v) {
+    std::string out;
+    switch (p) {
+        case Precision::F16: {
+            out.resize(v.size() * sizeof(uint16_t));
+            uint16_t* h = reinterpret_cast<uint16_t*>(out.data());
+            for (size_t j = 0; j < v.size(); j++) h[j] = vec::f32_to_f16(v[j]);
+            break;
+        }
+        case Precision::I8: {
+            float maxabs = 0.0f;
+            for (float f : v) maxabs = std::max(maxabs, std::fabs(f));
+            float scale = maxabs > 0.0f ? maxabs : 1.0f;
+            out.resize(sizeof(float) + v.size());
+            std::memcpy(out.data(), &scale, sizeof(scale));
+            int8_t* q = reinterpret_cast<int8_t*>(out.data() + sizeof(float));
+            for (size_t j = 0; j < v.size(); j++) {
+                float r = std::round(v[j] / scale * 127.0f);
+                q[j] = (int8_t)std::clamp(r, -127.0f, 127.0f);
+            }
+            break;
+        }
+        default:
+            out.assign(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(float));
+            break;
+    }
+    return out;
+}
+
+// Scores the query against one stored record, dequantizing in the kernel.
+static float score_record(Precision p, const float* q, const uint8_t* rec, size_t dim) {
+    switch (p) {
+        case Precision::F16:
+            return vec::dot_f16(q, reinterpret_cast<const uint16_t*>(rec), dim);
+        case Precision::I8: {
+            float scale = 0.0f;
+            std::memcpy(&scale, rec, sizeof(scale));
+            return vec::dot_i8(q, reinterpret_cast<const int8_t*>(rec + sizeof(float)), dim)
+                   * scale / 127.0f;
+        }
+        default:
+            return vec::dot_f32(q, reinterpret_cast<const float*>(rec), dim);
+    }
+}
 
-static bool append_f32_vec(const std::filesystem::path& p, const std::vector<float>& v, std::string* err) {
+#if defined(_WIN32)
+// Windows never preallocates, so plain appends stay correct there.
+static bool append_encoded_vec(const std::filesystem::path& p, const std::string& bytes, std::string* err) {
     std::ofstream out(p, std::ios::binary | std::ios::app);
     if (!out.good()) {
         if (err) *err = "failed to open embeddings";
         return false;
     }
-    out.write(reinterpret_cast<const char*>(v.data()), (std::streamsize)(v.size() * sizeof(float)));
+    out.write(bytes.data(), (std::streamsize)bytes.size());
     if (!out.good()) {
         if (err) *err = "failed to write embeddings";
         return false;
     }
     return true;
 }
+#endif
 
 static bool append_line(const std::filesystem::path& p, const std::string& line, std::string* err) {
     std::ofstream out(p, std::ios::app);
@@ -125,11 +259,187 @@ static bool append_line(const std::filesystem::path& p, const std::string& line,
     return true;
 }
 
+// ---- Preallocated mmap writer with a committed-count header ----
+//
+// Growing embeddings one ofstream append at a time updates file-size
+// metadata per vector and fragments extents, which degrades sequential
+// scan throughput as streams age. The writer instead fallocates the file
+// in large steps, lands vectors through a shared mapping, and advances a
+// commit.hdr sidecar only after the bytes are in place — so the physical
+// file runs ahead of the data and readers size their scans from the
+// header, never seeing the zero tail or a torn vector. The header advance
+// is ordered after the data write; like the rest of the store there are no
+// fsync barriers, so a crash can hide fully written tail vectors but never
+// expose partial ones.
+
+static const char kCommitMagic[8] = {'m','v','c','w','h','d','r','1'};
+
+static std::filesystem::path commit_hdr_path(const std::filesystem::path& stream_dir) {
+    return stream_dir / "commit.hdr";
+}
+
+static bool read_commit_hdr(const std::filesystem::path& stream_dir, uint64_t* bytes) {
+    std::ifstream in(commit_hdr_path(stream_dir), std::ios::binary);
+    if (!in.good()) return false;
+    char buf[16];
+    in.read(buf, sizeof(buf));
+    if (in.gcount() != (std::streamsize)sizeof(buf)) return false;
+    if (std::memcmp(buf, kCommitMagic, sizeof(kCommitMagic)) != 0) return false;
+    uint64_t v = 0;
+    std::memcpy(&v, buf + sizeof(kCommitMagic), sizeof(v));
+    if (bytes) *bytes = v;
+    return true;
+}
+
+uint64_t vectordb_committed_bytes(const std::filesystem::path& stream_dir,
+                                  const std::filesystem::path& emb_file) {
+    std::error_code ec;
+    auto sz = std::filesystem::file_size(emb_file, ec);
+    if (ec) return 0;
+    uint64_t committed = 0;
+    if (read_commit_hdr(stream_dir, &committed)) {
+        return committed < (uint64_t)sz ? committed : (uint64_t)sz;
+    }
+    return (uint64_t)sz;
+}
+
+#if !defined(_WIN32)
+// Fallocation step; MACHINA_VECDB_PREALLOC_MB overrides, 0 grows exactly.
+static size_t prealloc_step_bytes() {
+    static const size_t step = getenv_size_t("MACHINA_VECDB_PREALLOC_MB", 64) * 1024 * 1024;
+    return step;
+}
+
+// One writer per embeddings file, cached like the query-side StreamHandle.
+// Callers hold the stream's unique lock, so members need no further locking;
+// only the cache map itself is guarded.
+struct VecWriter {
+    int fd{-1};
+    int hdr_fd{-1};
+    uint8_t* map{nullptr};
+    size_t map_len{0};      // physical (fallocated) file size
+    uint64_t committed{0};  // bytes of real data
+
+    ~VecWriter() {
+        if (map) ::munmap(map, map_len);
+        if (fd >= 0) ::close(fd);
+        if (hdr_fd >= 0) ::close(hdr_fd);
+    }
+};
+
+static std::mutex g_writer_mu;
+static std::unordered_map<std::string, std::shared_ptr<VecWriter>> g_writers;
+
+static bool writer_publish_committed(VecWriter& w) {
+    char buf[16];
+    std::memcpy(buf, kCommitMagic, sizeof(kCommitMagic));
+    std::memcpy(buf + sizeof(kCommitMagic), &w.committed, sizeof(w.committed));
+    return ::pwrite(w.hdr_fd, buf, sizeof(buf), 0) == (ssize_t)sizeof(buf);
+}
+
+// Grows the file (and remaps) so at least `need` more bytes fit.
+static bool writer_reserve(VecWriter& w, size_t need, std::string* err) {
+    if ((size_t)w.committed + need <= w.map_len) return true;
+    size_t step = prealloc_step_bytes();
+    size_t want = (size_t)w.committed + need;
+    size_t new_len = step > 0 ? ((want + step - 1) / step) * step : want;
+#if defined(__linux__)
+    if (::fallocate(w.fd, 0, 0, (off_t)new_len) != 0)
+#endif
+    {
+        if (::ftruncate(w.fd, (off_t)new_len) != 0) {
+            if (err) *err = "failed to grow embeddings";
+            return false;
+        }
+    }
+    if (w.map) ::munmap(w.map, w.map_len);
+    w.map = nullptr;
+    void* m = ::mmap(nullptr, new_len, PROT_READ | PROT_WRITE, MAP_SHARED, w.fd, 0);
+    if (m == MAP_FAILED) {
+        if (err) *err = "mmap embeddings for write failed";
+        return false;
+    }
+    w.map = (uint8_t*)m;
+    w.map_len = new_len;
+    return true;
+}
+
+static std::shared_ptr<VecWriter> acquire_vec_writer(const std::filesystem::path& sd,
+                                                     const std::filesystem::path& ep,
+                                                     std::string* err) {
+    std::lock_guard<std::mutex> lk(g_writer_mu);
+    std::string key = ep.string();
+    auto it = g_writers.find(key);
+    if (it != g_writers.end()) {
+        auto& w = it->second;
+        struct stat st{};
+        // Revalidate against external truncation/replacement; the common
+        // path is one fstat.
+        if (w->fd >= 0 && ::fstat(w->fd, &st) == 0 && (size_t)st.st_size == w->map_len) {
+            return w;
+        }
+        g_writers.erase(it);
+    }
+
+    auto w = std::make_shared<VecWriter>();
+    w->fd = ::open(ep.c_str(), O_RDWR | O_CREAT, 0644);
+    if (w->fd < 0) {
+        if (err) *err = "failed to open embeddings";
+        return nullptr;
+    }
+    struct stat st{};
+    if (::fstat(w->fd, &st) != 0) {
+        if (err) *err = "stat embeddings failed";
+        return nullptr;
+    }
+    w->map_len = (size_t)st.st_size;
+    w->committed = (uint64_t)st.st_size;
+    uint64_t hdr = 0;
+    if (read_commit_hdr(sd, &hdr) && hdr <= w->committed) w->committed = hdr;
+    w->hdr_fd = ::open(commit_hdr_path(sd).c_str(), O_RDWR | O_CREAT, 0644);
+    if (w->hdr_fd < 0) {
+        if (err) *err = "failed to open commit header";
+        return nullptr;
+    }
+    if (w->map_len > 0) {
+        void* m = ::mmap(nullptr, w->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, w->fd, 0);
+        if (m == MAP_FAILED) {
+            if (err) *err = "mmap embeddings for write failed";
+            return nullptr;
+        }
+        w->map = (uint8_t*)m;
+    }
+    // A legacy stream gains its header on first write-open, so readers can
+    // rely on it from the first preallocated extent onward.
+    if (!writer_publish_committed(*w)) {
+        if (err) *err = "failed to write commit header";
+        return nullptr;
+    }
+
+    if (g_writers.size() > 64) g_writers.erase(g_writers.begin());
+    g_writers[key] = w;
+    return w;
+}
+
+static bool writer_append(VecWriter& w, const char* data, size_t n, std::string* err) {
+    if (n == 0) return true;
+    if (!writer_reserve(w, n, err)) return false;
+    std::memcpy(w.map + w.committed, data, n);
+    w.committed += n;
+    if (!writer_publish_committed(w)) {
+        w.committed -= n; // never advertise bytes the header does not cover
+        if (err) *err = "failed to write commit header";
+        return false;
+    }
+    return true;
+}
+#endif // !_WIN32
+
 bool vectordb_upsert_text(const std::string& stream, const std::string& text, const std::string& meta_json_raw, std::string* err) {
-    std::lock_guard<std::mutex> lk(g_vecdb_mu);
     auto root = vecdb_root();
     std::filesystem::create_directories(root);
     std::string sname = sanitize_stream(stream);
+    std::unique_lock<std::shared_mutex> lk(stream_mu(sname));
     auto sd = root / sname;
     std::filesystem::create_directories(sd);
 
@@ -139,46 +449,193 @@ bool vectordb_upsert_text(const std::string& stream, const std::string& text, co
     l2_normalize(er.embedding);
 
     std::string werr;
-    if (!append_f32_vec(emb_path(sd), er.embedding, &werr)) {
+    std::string enc = encode_vec(sc.precision, er.embedding);
+    uint64_t idx = 0;
+#if !defined(_WIN32)
+    {
+        auto w = acquire_vec_writer(sd, emb_path_p(sd, sc.precision), &werr);
+        if (!w || !writer_append(*w, enc.data(), enc.size(), &werr)) {
+            if (err) *err = werr;
+            return false;
+        }
+        if (sc.dim > 0) idx = w->committed / record_bytes(sc.precision, sc.dim) - 1ULL;
+    }
+#else
+    if (!append_encoded_vec(emb_path_p(sd, sc.precision), enc, &werr)) {
         if (err) *err = werr;
         return false;
     }
-
     // Determine index by file size.
-    uint64_t idx = 0;
     {
         std::error_code ec;
-        auto sz = std::filesystem::file_size(emb_path(sd), ec);
+        auto sz = std::filesystem::file_size(emb_path_p(sd, sc.precision), ec);
         if (!ec && sc.dim > 0) {
-            idx = (uint64_t)(sz / (sc.dim * sizeof(float))) - 1ULL;
+            idx = (uint64_t)sz / record_bytes(sc.precision, sc.dim) - 1ULL;
         }
     }
+#endif
 
-    std::ostringstream ml;
-    ml << "{";
-    ml << "\"i\":" << idx << ",";
-    ml << "\"ts_ms\":" << now_ms() << ",";
-    ml << "\"provider\":\"" << json_mini::json_escape(er.provider) << "\"";
-    if (!er.error.empty()) {
-        ml << ",\"warn\":\"" << json_mini::json_escape(er.error) << "\"";
-    }
-    if (!meta_json_raw.empty()) {
-        // meta_json_raw is expected to be an object raw.
-        ml << ",\"meta\":" << meta_json_raw;
-    }
+    JsonWriter ml(text.size() + 128);
+    ml.begin_object();
+    ml.kv("i", idx);
+    ml.kv("ts_ms", now_ms());
+    ml.kv("provider", er.provider);
+    if (!er.error.empty()) ml.kv("warn", er.error);
+    // meta_json_raw is expected to be an object raw.
+    if (!meta_json_raw.empty()) ml.kv_raw("meta", meta_json_raw);
     // Keep text (useful for small stores; for large, rely on meta pointers)
-    ml << ",\"text\":\"" << json_mini::json_escape(text) << "\"";
-    ml << "}";
+    ml.kv("text", text);
+    ml.end_object();
+
+    // Byte offset this line will start at, recorded in the sidecar index.
+    uint64_t meta_off = 0;
+    {
+        std::error_code ec;
+        auto msz = std::filesystem::file_size(meta_path(sd), ec);
+        if (!ec) meta_off = (uint64_t)msz;
+    }
 
     if (!append_line(meta_path(sd), ml.str(), &werr)) {
         if (err) *err = werr;
         return false;
     }
 
+    // Only append when the index is exactly in step with the vector index;
+    // a stream created before the sidecar existed stays on the scan path.
+    {
+        std::error_code ec;
+        auto isz = std::filesystem::file_size(meta_idx_path(sd), ec);
+        uint64_t have = ec ? 0 : (uint64_t)isz;
+        if (have == idx * sizeof(uint64_t)) {
+            std::ofstream ix(meta_idx_path(sd), std::ios::binary | std::ios::app);
+            if (ix.good()) {
+                ix.write(reinterpret_cast<const char*>(&meta_off), sizeof(meta_off));
+            }
+        }
+    }
+
+#ifdef MACHINA_USE_CUDA
+    machina_cuda_vecdb_invalidate(sname.c_str());
+#endif
     return true;
 }
 
-static bool load_schema_and_dim(const std::filesystem::path& sd, size_t* dim_out, std::string* err) {
+bool vectordb_upsert_batch(const std::string& stream, const std::vector<std::string>& texts,
+                           size_t* count_out, std::string* err) {
+    if (count_out) *count_out = 0;
+    if (texts.empty()) return true;
+
+    auto root = vecdb_root();
+    std::filesystem::create_directories(root);
+    std::string sname = sanitize_stream(stream);
+    std::unique_lock<std::shared_mutex> lk(stream_mu(sname));
+    auto sd = root / sname;
+    std::filesystem::create_directories(sd);
+
+    Schema sc = load_or_init_schema(sd, 0);
+    // One subprocess call for the whole batch instead of one per document.
+    auto ers = embed_texts_batch(texts, sc.dim);
+    if (ers.size() != texts.size()) {
+        if (err) *err = "batch embed returned wrong count";
+        return false;
+    }
+    for (auto& er : ers) l2_normalize(er.embedding);
+
+    // Base index and meta offset before this batch lands.
+    std::string werr;
+    uint64_t idx = 0;
+    uint64_t meta_off = 0;
+    bool idx_in_step = false;
+#if !defined(_WIN32)
+    auto w = acquire_vec_writer(sd, emb_path_p(sd, sc.precision), &werr);
+    if (!w) {
+        if (err) *err = werr;
+        return false;
+    }
+    if (sc.dim > 0) idx = w->committed / record_bytes(sc.precision, sc.dim);
+#endif
+    {
+        std::error_code ec;
+#if defined(_WIN32)
+        auto esz = std::filesystem::file_size(emb_path_p(sd, sc.precision), ec);
+        if (!ec && sc.dim > 0) idx = (uint64_t)esz / record_bytes(sc.precision, sc.dim);
+#endif
+        auto msz = std::filesystem::file_size(meta_path(sd), ec);
+        if (!ec) meta_off = (uint64_t)msz;
+        auto isz = std::filesystem::file_size(meta_idx_path(sd), ec);
+        uint64_t have = ec ? 0 : (uint64_t)isz;
+        idx_in_step = (have == idx * sizeof(uint64_t));
+    }
+
+    // One open + one streamed write per file for the entire batch; on POSIX
+    // the vectors gather into a single writer_append so the commit header
+    // advances once per batch, not once per vector.
+#if defined(_WIN32)
+    std::ofstream eo(emb_path_p(sd, sc.precision), std::ios::binary | std::ios::app);
+    if (!eo.good()) {
+        if (err) *err = "failed to open embeddings";
+        return false;
+    }
+#else
+    std::string blob;
+    blob.reserve(texts.size() * record_bytes(sc.precision, sc.dim));
+#endif
+    std::ofstream mo(meta_path(sd), std::ios::app);
+    if (!mo.good()) {
+        if (err) *err = "failed to open meta";
+        return false;
+    }
+    std::ofstream ix;
+    if (idx_in_step) ix.open(meta_idx_path(sd), std::ios::binary | std::ios::app);
+
+    int64_t ts = now_ms();
+    for (size_t n = 0; n < texts.size(); n++) {
+        std::string enc = encode_vec(sc.precision, ers[n].embedding);
+#if defined(_WIN32)
+        eo.write(enc.data(), (std::streamsize)enc.size());
+#else
+        blob += enc;
+#endif
+
+        JsonWriter ml(texts[n].size() + 128);
+        ml.begin_object();
+        ml.kv("i", idx + n);
+        ml.kv("ts_ms", ts);
+        ml.kv("provider", ers[n].provider);
+        if (!ers[n].error.empty()) ml.kv("warn", ers[n].error);
+        ml.kv("text", texts[n]);
+        ml.end_object();
+        std::string line = ml.take();
+        mo << line << "\n";
+
+        if (ix.is_open() && ix.good()) {
+            ix.write(reinterpret_cast<const char*>(&meta_off), sizeof(meta_off));
+        }
+        meta_off += line.size() + 1;
+    }
+#if defined(_WIN32)
+    if (!eo.good() || !mo.good()) {
+        if (err) *err = "failed to write embeddings/meta";
+        return false;
+    }
+#else
+    if (!mo.good()) {
+        if (err) *err = "failed to write meta";
+        return false;
+    }
+    if (!writer_append(*w, blob.data(), blob.size(), &werr)) {
+        if (err) *err = werr;
+        return false;
+    }
+#endif
+#ifdef MACHINA_USE_CUDA
+    machina_cuda_vecdb_invalidate(sname.c_str());
+#endif
+    if (count_out) *count_out = texts.size();
+    return true;
+}
+
+static bool load_schema(const std::filesystem::path& sd, Schema* out, std::string* err) {
     auto sp = schema_path(sd);
     std::ifstream in(sp);
     if (!in.good()) {
@@ -193,10 +650,119 @@ static bool load_schema_and_dim(const std::filesystem::path& sd, size_t* dim_out
         if (err) *err = "invalid schema.dim";
         return false;
     }
-    *dim_out = (size_t)d;
+    out->dim = (size_t)d;
+    out->precision = precision_from_name(
+        json_mini::get_string(raw, "precision").value_or("f32"));
     return true;
 }
 
+#if !defined(_WIN32)
+// Persistent per-stream query handle: schema, embeddings mmap, vector count,
+// and the loaded IVF index, keyed by stream directory. Revalidated by the
+// committed byte count of the embeddings file and the mtime of the IVF
+// index, so upserts and background training invalidate it naturally. (The
+// mmap writer lands bytes without a reliable mtime bump, so size — committed
+// bytes, not the fallocated file length — is the growth signal.) Queries
+// copy the shared_ptr under a short lock and scan lock-free; the mapping is
+// unmapped when the last in-flight query using a stale handle drops it.
+struct StreamHandle {
+    Schema schema;
+    void* map{nullptr};
+    size_t map_size{0};
+    size_t vecs{0};
+    IvfIndex ivf;
+    bool has_ivf{false};
+    int64_t emb_size{-1};  // committed bytes at map time
+    int64_t ivf_mtime{0};
+
+    ~StreamHandle() {
+        if (map) ::munmap(map, map_size);
+    }
+};
+
+static std::mutex g_handle_mu;
+static std::unordered_map<std::string, std::shared_ptr<StreamHandle>> g_handles;
+
+static int64_t mtime_of(const std::filesystem::path& p) {
+    std::error_code ec;
+    auto t = std::filesystem::last_write_time(p, ec);
+    if (ec) return 0;
+    return (int64_t)t.time_since_epoch().count();
+}
+
+static std::shared_ptr<StreamHandle> acquire_stream_handle(const std::filesystem::path& sd,
+                                                           std::string* err) {
+    std::lock_guard<std::mutex> lk(g_handle_mu);
+    std::string key = sd.string();
+
+    auto it = g_handles.find(key);
+    if (it != g_handles.end()) {
+        auto& h = it->second;
+        auto ep = emb_path_p(sd, h->schema.precision);
+        uint64_t cb = vectordb_committed_bytes(sd, ep);
+        if (cb > 0 && (int64_t)cb == h->emb_size &&
+            mtime_of(ivf_index_path(sd)) == h->ivf_mtime) {
+            return h;
+        }
+        g_handles.erase(it);
+    }
+
+    auto h = std::make_shared<StreamHandle>();
+    if (!load_schema(sd, &h->schema, err)) return nullptr;
+
+    auto ep = emb_path_p(sd, h->schema.precision);
+    int fd = ::open(ep.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (err) *err = "missing embeddings";
+        return nullptr;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        if (err) *err = "stat embeddings failed";
+        return nullptr;
+    }
+    // The map covers the physical file (including any preallocated tail);
+    // only committed bytes count as vectors.
+    uint64_t cb = vectordb_committed_bytes(sd, ep);
+    if (cb > (uint64_t)st.st_size) cb = (uint64_t)st.st_size;
+    h->emb_size = (int64_t)cb;
+    h->vecs = (size_t)cb / record_bytes(h->schema.precision, h->schema.dim);
+    if (st.st_size > 0) {
+        void* map = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            if (err) *err = "mmap embeddings failed";
+            return nullptr;
+        }
+        ::madvise(map, (size_t)st.st_size, MADV_WILLNEED);
+        // Sequential full scans: huge-page promotion (where the kernel
+        // supports file-backed THP) cuts TLB misses on the hot loop.
+        (void)hugepage_advise(map, (size_t)st.st_size);
+        // Scan workers are spread across sockets, so a map that faulted in
+        // on one node makes remote workers eat the cross-node penalty for
+        // the whole stream. Interleaving evens that out.
+        if (numa_enabled()) {
+            (void)numa_interleave_memory(map, (size_t)st.st_size);
+        }
+        h->map = map;
+        h->map_size = (size_t)st.st_size;
+    }
+    ::close(fd);  // mapping outlives the fd
+
+    if (h->schema.precision == Precision::F32) {
+        h->has_ivf = ivf_load(sd, h->schema.dim, &h->ivf);
+        h->ivf_mtime = mtime_of(ivf_index_path(sd));
+    }
+
+    // Cap for long-running daemons; drop an arbitrary entry like the
+    // selector's centroid cache does.
+    if (g_handles.size() > 64) g_handles.erase(g_handles.begin());
+    g_handles[key] = h;
+    return h;
+}
+#endif // !_WIN32
+
 ToolResult tool_vecdb_upsert(const std::string& input_json, DSState& /*ds_tmp*/) {
     try {
         std::string stream = json_mini::get_string(input_json, "stream").value_or("default");
@@ -218,73 +784,220 @@ ToolResult tool_vecdb_upsert(const std::string& input_json, DSState& /*ds_tmp*/)
     }
 }
 
-ToolResult tool_vecdb_query(const std::string& input_json, DSState& /*ds_tmp*/) {
+ToolResult tool_vecdb_upsert_batch(const std::string& input_json, DSState& /*ds_tmp*/) {
     try {
         std::string stream = json_mini::get_string(input_json, "stream").value_or("default");
-        std::string query = json_mini::get_string(input_json, "query").value_or("");
-        int64_t top_k = json_mini::get_int(input_json, "top_k").value_or(8);
-        if (top_k <= 0) top_k = 8;
+        auto texts = json_mini::get_array_strings(input_json, "texts");
+        if (texts.empty()) {
+            return {StepStatus::TOOL_ERROR, "{}", "missing texts"};
+        }
+
+        std::string err;
+        size_t count = 0;
+        bool ok = vectordb_upsert_batch(stream, texts, &count, &err);
+        if (!ok) return {StepStatus::TOOL_ERROR, "{}", err};
+
+        std::ostringstream out;
+        out << "{\"ok\":true,\"stream\":\"" << json_mini::json_escape(sanitize_stream(stream))
+            << "\",\"count\":" << count << "}";
+        return {StepStatus::OK, out.str(), ""};
+    } catch (const std::exception& e) {
+        return {StepStatus::TOOL_ERROR, "{}", e.what()};
+    }
+}
+
+bool vectordb_query_direct(const std::string& stream, const std::string& query,
+                           size_t top_k, size_t nprobe,
+                           const std::vector<float>* qemb_hint,
+                           std::vector<VecdbHit>* hits,
+                           std::string* provider, std::string* warn,
+                           std::string* err) {
+    try {
+        hits->clear();
+        if (query.empty()) {
+            if (err) *err = "missing query";
+            return false;
+        }
+        if (top_k == 0) top_k = 8;
         if (top_k > 50) top_k = 50;
-        if (query.empty()) return {StepStatus::TOOL_ERROR, "{}", "missing query"};
+        if (nprobe == 0) nprobe = 8;
 
-        std::lock_guard<std::mutex> lk(g_vecdb_mu);
         auto root = vecdb_root();
-        auto sd = root / sanitize_stream(stream);
-        if (!std::filesystem::exists(sd)) return {StepStatus::OK, "{\"ok\":true,\"hits\":[]}", ""};
+        std::string sname = sanitize_stream(stream);
+        std::shared_lock<std::shared_mutex> lk(stream_mu(sname));
+        auto sd = root / sname;
+        if (!std::filesystem::exists(sd)) return true;
 
-        size_t dim = 0;
-        std::string err;
-        if (!load_schema_and_dim(sd, &dim, &err)) return {StepStatus::TOOL_ERROR, "{}", err};
-
-        auto er = embed_text_best_effort(query, dim);
-        l2_normalize(er.embedding);
+        std::string herr;
+#if !defined(_WIN32)
+        auto h = acquire_stream_handle(sd, &herr);
+        if (!h) {
+            if (err) *err = herr;
+            return false;
+        }
+        const Schema sc = h->schema;
+#else
+        Schema sc;
+        if (!load_schema(sd, &sc, &herr)) {
+            if (err) *err = herr;
+            return false;
+        }
+#endif
+        const size_t dim = sc.dim;
+        const size_t rec = record_bytes(sc.precision, dim);
 
-        auto ep = emb_path(sd);
-        std::ifstream in(ep, std::ios::binary);
-        if (!in.good()) return {StepStatus::TOOL_ERROR, "{}", "missing embeddings"};
+        EmbedResult er;
+        if (qemb_hint && qemb_hint->size() == dim && std::getenv("MACHINA_EMBED_CMD") == nullptr) {
+            // The caller already hashed the query at this dim; skip the
+            // second embedding pass entirely.
+            er.embedding = *qemb_hint;
+            er.provider = "hash";
+        } else {
+            er = embed_text_best_effort(query, dim);
+            l2_normalize(er.embedding);
+        }
 
-        // Candidate heap (score, index)
+        // Candidate selection: bounded min-heap of the top_k best scores.
         struct Cand { float s; uint64_t i; };
-        std::vector<Cand> best;
-        best.reserve((size_t)top_k + 1);
-
-        const size_t chunk_vecs = 1024;
-        std::vector<float> buf(chunk_vecs * dim);
-        uint64_t idx = 0;
-        while (in.good()) {
-            in.read(reinterpret_cast<char*>(buf.data()), (std::streamsize)(buf.size() * sizeof(float)));
-            std::streamsize got = in.gcount();
-            if (got <= 0) break;
-            size_t floats = (size_t)(got / (std::streamsize)sizeof(float));
-            size_t vecs = floats / dim;
-            for (size_t vi = 0; vi < vecs; vi++, idx++) {
-                const float* v = &buf[vi * dim];
-                double dot = 0.0;
-                for (size_t j = 0; j < dim; j++) dot += (double)er.embedding[j] * (double)v[j];
-                float sc = (float)dot;
-
-                if (best.size() < (size_t)top_k) {
-                    best.push_back({sc, idx});
-                    if (best.size() == (size_t)top_k) {
-                        std::nth_element(best.begin(), best.begin(), best.end(), [](const Cand& a, const Cand& b){return a.s > b.s;});
+        auto better = [](const Cand& a, const Cand& b) { return a.s > b.s; };
+        using CandTopK = TopK<Cand, decltype(better)>;
+        CandTopK topk((size_t)top_k, better);
+
+        auto consider = [&](float score, uint64_t idx) { topk.offer({score, idx}); };
+
+#if !defined(_WIN32)
+        // Scan the cached mmap in place: the handle survives across queries,
+        // so schema parsing, open, mmap, and IVF load are all paid once per
+        // stream until an upsert or retrain invalidates it.
+        {
+            size_t vecs = h->vecs;
+
+            // IVF coarse index from the handle: probe the nprobe closest
+            // clusters instead of the whole stream, and kick off background
+            // (re)training when the index is missing or has fallen behind.
+            // The index reads embeddings.f32 directly, so it only applies to
+            // full-precision streams.
+            const IvfIndex& ivf = h->ivf;
+            bool use_ivf = h->has_ivf && ivf.nvecs <= (uint64_t)vecs;
+            if (sc.precision == Precision::F32) {
+                ivf_maybe_train_async(sd, dim, (uint64_t)vecs, use_ivf ? ivf.nvecs : 0);
+            }
+
+            if (vecs > 0 && h->map) {
+                const uint8_t* base = reinterpret_cast<const uint8_t*>(h->map);
+                const float* q = er.embedding.data();
+                bool scanned = false;
+#ifdef MACHINA_USE_CUDA
+                // GPU brute force beats IVF here: the resident device copy
+                // makes the full scan exact and fast. Falls through to the
+                // CPU paths when no device fits the stream.
+                if (sc.precision == Precision::F32) {
+                    std::vector<float> scores(vecs);
+                    if (machina_cuda_vecdb_scan(sname.c_str(),
+                                                reinterpret_cast<const float*>(base),
+                                                (long long)vecs, (int)dim, q,
+                                                scores.data()) == 0) {
+                        for (size_t i = 0; i < vecs; i++) consider(scores[i], (uint64_t)i);
+                        scanned = true;
+                    }
+                }
+#endif
+                if (scanned) {
+                    // handled on the GPU
+                } else if (use_ivf) {
+                    // Rank clusters by centroid similarity, scan the best nprobe.
+                    size_t np = std::min((size_t)nprobe, ivf.k);
+                    std::vector<std::pair<float, size_t>> cs;
+                    cs.reserve(ivf.k);
+                    for (size_t c = 0; c < ivf.k; c++) {
+                        cs.push_back({vec::dot_f32(q, &ivf.centroids[c * dim], dim), c});
                     }
+                    std::partial_sort(cs.begin(), cs.begin() + (long)np, cs.end(),
+                                      [](const auto& a, const auto& b) { return a.first > b.first; });
+                    for (size_t p = 0; p < np; p++) {
+                        for (uint32_t id : ivf.lists[cs[p].second]) {
+                            if ((size_t)id >= vecs) continue;
+                            consider(score_record(sc.precision, q, base + (size_t)id * rec, dim), id);
+                        }
+                    }
+                    // Vectors appended after the index was built are scanned exactly.
+                    for (uint64_t idx = ivf.nvecs; idx < (uint64_t)vecs; idx++) {
+                        consider(score_record(sc.precision, q, base + (size_t)idx * rec, dim), idx);
+                    }
+                } else if (vecs >= kParallelScanMin) {
+                    // Large stream: split the range across the shared worker
+                    // pool, each chunk keeping a local top-k merged at the end.
+                    std::mutex merge_mu;
+                    ThreadPool::shared().parallel_for(0, vecs, [&](size_t cb, size_t ce) {
+                        CandTopK local((size_t)top_k, better);
+                        for (size_t idx = cb; idx < ce; idx++) {
+                            local.offer({score_record(sc.precision, q, base + idx * rec, dim),
+                                         (uint64_t)idx});
+                        }
+                        std::lock_guard<std::mutex> mlk(merge_mu);
+                        for (auto& c : local.take_sorted()) topk.offer(c);
+                    });
                 } else {
-                    // Maintain min of best[0] after partial ordering? Simpler: find worst.
-                    size_t worst = 0;
-                    for (size_t k = 1; k < best.size(); k++) {
-                        if (best[k].s < best[worst].s) worst = k;
+                    for (uint64_t idx = 0; idx < (uint64_t)vecs; idx++) {
+                        consider(score_record(sc.precision, q, base + (size_t)idx * rec, dim), idx);
                     }
-                    if (sc > best[worst].s) best[worst] = {sc, idx};
                 }
             }
         }
+#else
+        // Windows build: chunked read fallback.
+        {
+            auto ep = emb_path_p(sd, sc.precision);
+            std::ifstream in(ep, std::ios::binary);
+            if (!in.good()) {
+                if (err) *err = "missing embeddings";
+                return false;
+            }
+            const size_t chunk_vecs = 1024;
+            std::vector<uint8_t> buf(chunk_vecs * rec);
+            uint64_t idx = 0;
+            while (in.good()) {
+                in.read(reinterpret_cast<char*>(buf.data()), (std::streamsize)buf.size());
+                std::streamsize got = in.gcount();
+                if (got <= 0) break;
+                size_t vecs = (size_t)got / rec;
+                for (size_t vi = 0; vi < vecs; vi++, idx++) {
+                    consider(score_record(sc.precision, er.embedding.data(), &buf[vi * rec], dim), idx);
+                }
+            }
+        }
+#endif
 
-        std::sort(best.begin(), best.end(), [](const Cand& a, const Cand& b){ return a.s > b.s; });
+        std::vector<Cand> best = topk.take_sorted();
 
-        // Map indices to meta lines (simple: scan meta.jsonl once, keep requested indices)
+        // Map indices to meta lines: seek via the sidecar offset index when
+        // it covers the hit (validated against the line's own "i"), falling
+        // back to a single scan of meta.jsonl for anything it misses.
         std::vector<std::string> meta_lines;
         meta_lines.resize(best.size());
+        size_t missing = best.size();
         {
+            std::ifstream ix(meta_idx_path(sd), std::ios::binary);
+            std::ifstream mi(meta_path(sd));
+            if (ix.good() && mi.good()) {
+                for (size_t k = 0; k < best.size(); k++) {
+                    uint64_t off = 0;
+                    ix.clear();
+                    ix.seekg((std::streamoff)(best[k].i * sizeof(uint64_t)));
+                    ix.read(reinterpret_cast<char*>(&off), sizeof(off));
+                    if (ix.gcount() != (std::streamsize)sizeof(off)) continue;
+                    mi.clear();
+                    mi.seekg((std::streamoff)off);
+                    std::string line;
+                    if (!std::getline(mi, line) || line.empty()) continue;
+                    auto ii = json_mini::get_int(line, "i").value_or(-1);
+                    if (ii < 0 || (uint64_t)ii != best[k].i) continue;
+                    meta_lines[k] = line;
+                    missing--;
+                }
+            }
+        }
+        if (missing > 0) {
             std::ifstream mi(meta_path(sd));
             if (mi.good()) {
                 std::string line;
@@ -293,34 +1006,67 @@ ToolResult tool_vecdb_query(const std::string& input_json, DSState& /*ds_tmp*/)
                     auto ii = json_mini::get_int(line, "i").value_or(-1);
                     if (ii < 0) continue;
                     for (size_t k = 0; k < best.size(); k++) {
-                        if ((uint64_t)ii == best[k].i) { meta_lines[k] = line; }
+                        if (meta_lines[k].empty() && (uint64_t)ii == best[k].i) { meta_lines[k] = line; }
                     }
                 }
             }
         }
 
-        std::ostringstream out;
-        out << "{";
-        out << "\"ok\":true,";
-        out << "\"provider\":\"" << json_mini::json_escape(er.provider) << "\",";
-        if (!er.error.empty()) out << "\"warn\":\"" << json_mini::json_escape(er.error) << "\",";
-        out << "\"hits\":[";
+        hits->reserve(best.size());
         for (size_t k = 0; k < best.size(); k++) {
-            if (k) out << ",";
-            out << "{";
-            out << "\"i\":" << best[k].i << ",";
-            out << "\"score\":" << std::fixed << std::setprecision(6) << best[k].s;
-            if (!meta_lines[k].empty()) {
-                out << ",\"meta_line\":" << "\"" << json_mini::json_escape(meta_lines[k]) << "\"";
-            }
-            out << "}";
+            hits->push_back(VecdbHit{best[k].i, best[k].s, std::move(meta_lines[k])});
         }
-        out << "]}";
-
-        return {StepStatus::OK, out.str(), ""};
+        if (provider) *provider = er.provider;
+        if (warn) *warn = er.error;
+        return true;
     } catch (const std::exception& e) {
-        return {StepStatus::TOOL_ERROR, "{}", e.what()};
+        if (err) *err = e.what();
+        return false;
     }
 }
 
+ToolResult tool_vecdb_query(const std::string& input_json, DSState& /*ds_tmp*/) {
+    std::string stream = json_mini::get_string(input_json, "stream").value_or("default");
+    std::string query = json_mini::get_string(input_json, "query").value_or("");
+    int64_t top_k = json_mini::get_int(input_json, "top_k").value_or(8);
+    if (top_k <= 0) top_k = 8;
+    int64_t nprobe = json_mini::get_int(input_json, "nprobe").value_or(8);
+    if (nprobe <= 0) nprobe = 8;
+    // Budget pacing hint from the runner: probe fewer lists and return
+    // fewer hits when the run is close to its budget.
+    if (auto braw = json_mini::get_object_raw(input_json, "_system_budget")) {
+        double ks = json_mini::get_double(*braw, "k_scale").value_or(1.0);
+        if (ks > 0.0 && ks < 1.0) {
+            top_k = std::max<int64_t>(1, (int64_t)((double)top_k * ks));
+            nprobe = std::max<int64_t>(1, (int64_t)((double)nprobe * ks));
+        }
+    }
+    if (query.empty()) return {StepStatus::TOOL_ERROR, "{}", "missing query"};
+
+    std::vector<VecdbHit> hits;
+    std::string provider, warn, err;
+    if (!vectordb_query_direct(stream, query, (size_t)top_k, (size_t)nprobe,
+                               nullptr, &hits, &provider, &warn, &err)) {
+        return {StepStatus::TOOL_ERROR, "{}", err};
+    }
+
+    JsonWriter out(hits.size() * 128 + 64);
+    out.begin_object();
+    out.kv("ok", true);
+    if (!provider.empty()) out.kv("provider", provider);
+    if (!warn.empty()) out.kv("warn", warn);
+    out.key("hits").begin_array();
+    for (size_t k = 0; k < hits.size(); k++) {
+        out.begin_object();
+        out.kv("i", hits[k].index);
+        out.kv_fixed("score", hits[k].score, 6);
+        if (!hits[k].meta_line.empty()) out.kv("meta_line", hits[k].meta_line);
+        out.end_object();
+    }
+    out.end_array();
+    out.end_object();
+
+    return {StepStatus::OK, out.take(), ""};
+}
+
 } // namespace machina
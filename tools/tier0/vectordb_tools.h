@@ -1,16 +1,56 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <string>
+#include <vector>
 
 namespace machina {
 
 // Lightweight persistent vector store under $MACHINA_ROOT/work/vectordb.
 // Exposed via tools:
 //  - AID.VECDB.UPSERT.v1
+//  - AID.VECDB.UPSERT_BATCH.v1
 //  - AID.VECDB.QUERY.v1
 
+// Committed data size of a stream's embeddings file. Streams written by
+// the preallocated mmap writer carry a commit.hdr sidecar whose counter
+// trails the physical (fallocated) file size; readers must size their
+// scans from this, never from the file length. Streams without the header
+// report the plain file size. Returns 0 for a missing file.
+uint64_t vectordb_committed_bytes(const std::filesystem::path& stream_dir,
+                                  const std::filesystem::path& emb_file);
+
 // Helper for Memory subsystem: append a single text item into vectordb.
 // Returns true on success; err (if provided) contains short reason.
 bool vectordb_upsert_text(const std::string& stream, const std::string& text, const std::string& meta_json_raw, std::string* err);
 
+// Batch ingestion: embeds all texts in one embed_texts_batch call and lands
+// the vectors/meta lines with a single open+write per file. count_out (if
+// provided) receives the number of items written.
+bool vectordb_upsert_batch(const std::string& stream, const std::vector<std::string>& texts,
+                           size_t* count_out, std::string* err);
+
+// One query hit from the direct API below.
+struct VecdbHit {
+    uint64_t index{0};
+    float score{0.0f};
+    std::string meta_line;  // raw meta.jsonl line ("" when unresolved)
+};
+
+// Direct in-process query (hybrid memory retrieval): same scan as
+// AID.VECDB.QUERY.v1 without the JSON round-trip. qemb_hint, when non-null,
+// l2-normalized and matching the stream dim, is reused as the query
+// embedding if the stream would be hash-embedded anyway (no
+// MACHINA_EMBED_CMD), so hybrid callers embed once. provider/warn mirror the
+// tool output fields and may be null. Returns false with err on failure; an
+// absent stream yields true with zero hits.
+bool vectordb_query_direct(const std::string& stream, const std::string& query,
+                           size_t top_k, size_t nprobe,
+                           const std::vector<float>* qemb_hint,
+                           std::vector<VecdbHit>* hits,
+                           std::string* provider, std::string* warn,
+                           std::string* err);
+
 } // namespace machina